@@ -50,8 +50,27 @@
 #define WORD_LEN             0x02
 #define DWORD_LEN            0x04
 
+/* Chip select framing of a TPS command                                      */
+/*---------------------------------------------------------------------------*/
+#define SPI_FRAMING_PER_BYTE 0x00   /* HOST_SFRN toggled around every byte   */
+#define SPI_FRAMING_BURST    0x01   /* HOST_SFRN asserted once per command   */
+
+/* Boards of the SPI timing table (see SPI_BOARD_TIMING)                     */
+/*---------------------------------------------------------------------------*/
+#define SPI_BOARD_STM32F103_TPS1   0   /* SCK 18 MHz, short traces          */
+#define SPI_BOARD_LONG_WIRING      1   /* evaluation setup with cables      */
+#define SPI_NUMBER_OF_BOARDS       2
+
 USIGN32   TPS_SPI_ReadData(USIGN8* pbyReadBuffer, USIGN32 dwBufferLength);
 USIGN32   TPS_SPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength);
+#ifdef SPI_DMA_TRANSFER
+USIGN32   TPS_SPI_InitDma(VOID);
+#endif
+USIGN32   TPS_SPI_SetFraming(USIGN8 byFraming);
+USIGN8    TPS_SPI_GetFraming(VOID);
+#ifdef SPI_BENCHMARK
+VOID      TPS_SPI_Benchmark(VOID);
+#endif
 
 USIGN32   TPS_SetValue8(USIGN8* pbyMemory, USIGN8 byValue);
 USIGN32   TPS_SetValue16(USIGN8* pbyMemory, USIGN16 wValue);
@@ -37,6 +37,8 @@
 /*---------------------------------------------------------------------------*/
 #include <TPS_1_user.h>
 #include <SPI1_Master.h>
+#include <TPS_Profile.h>
+#include <TPS_Benchmark.h>
 #include <stdio.h>
 
 /*---------------------------------------------------------------------------*/
@@ -49,10 +51,6 @@
   #define __packed __attribute__ ((packed,aligned(1)))
 #endif
 
-#define PRIVATE_MALLOC
-
-#define t_malloc(x) lib_malloc(x)
-
 /* Align pointer p to Double-Word boundaries. */
 #define DWORD_ALIGN(p)   p += (4 - ((USIGN32)p % 4))
 
@@ -82,6 +80,19 @@
 #define USE_AUTOCONF_MODULE
 #endif
 
+#ifndef DIAGNOSIS_ENABLE
+#undef USE_DIAG_INDEX
+#endif
+
+#ifndef USE_ETHERNET_INTERFACE
+#undef USE_ETHERNET_RX_FILTER
+#undef USE_ETHERNET_TX_QUEUE
+#endif
+
+#ifndef FW_UPDATE_OVER_HOST
+#undef USE_FW_UPDATE_STREAM
+#endif
+
 #define CHANPROP_TYPE_MAX               0x07
 #define CHANPROP_ACCUMULATIVE_MAX       0x01
 #define CHANPROP_MAINTENANCE_MAX        0x03
@@ -205,6 +216,8 @@
 /* Same address as EVENT_REGISTER_APP_ACKN, Acknowledge is the same for Polling and IRQ mode. */
 #define HOST_IRQ_ACK_HIGH          (BASE_ADDRESS_DPRAM+0x24)
 #define HOST_EOI                   (BASE_ADDRESS_DPRAM+0x28)
+#define HOST_IRQ_MASK_ALL_ENABLED  0x00000000 /* a cleared mask bit enables the event */
+#define HOST_EOI_REPEAT_TIME       0x0003FFFF /* IRQ is raised again after this time if events are pending */
 #define EVENT_PN_IRO_MASK_HIGH     (BASE_ADDRESS_DPRAM+0x38)
 #define PN_EVENT_LOW               (BASE_ADDRESS_DPRAM+0x3C)
 #define PN_EVENT_HIGH              (BASE_ADDRESS_DPRAM+0x40)
@@ -238,6 +251,14 @@
 /*---------------------------------------------------------------------------*/
 #define OWNED_BY_AR(x)        (0x0001<<x)
 
+/*---------------------------------------------------------------------------*/
+/* State of a buffer change, see TPS_PollBufferChange()                      */
+/*---------------------------------------------------------------------------*/
+#define BUFFER_CHANGE_IDLE    0x00  /* no buffer change was requested        */
+#define BUFFER_CHANGE_PENDING 0x01  /* waiting for the TPS-1                 */
+#define BUFFER_CHANGE_DONE    0x02  /* last buffer change was successful     */
+#define BUFFER_CHANGE_TIMEOUT 0x03  /* TPS-1 did not answer in time          */
+
 /*---------------------------------------------------------------------------*/
 /*  SUBSLOT properties  ( ok -> removed -> removed ok -> returned -> ok)     */
 /*---------------------------------------------------------------------------*/
@@ -370,12 +391,18 @@
 #define ERR_AACK         0x08
 #define RTA_WAAK_TIMEOUT 0x09
 
+/* Response of the alarm acknowledge callback for a queued alarm that was   */
+/* discarded without being sent (USE_ALARM_QUEUE).                           */
+/*---------------------------------------------------------------------------*/
+#define ALARM_QUEUE_DROPPED  0x10
+
 /* ALARM ChannelProperties.Specifier and diagnosis alarm specifier          */
 /*--------------------------------------------------------------------------*/
 #define ALL_DISAPPEAR                   0x00
 #define APPEARS                         0x01
 #define DISAPPEARS                      0x02
 #define DISAPPEARS_BUT_OTHER_REMAIN     0x03
+#define DIAG_BATCH_NO_ALARM             0x00
 
 /* ChannelProperties.Maintenance                                            */
 /*--------------------------------------------------------------------------*/
@@ -641,6 +668,43 @@ enum StackEvents
         TPS_EVENT_ON_FSUDATA_CHANGE = 29       /*!< \brief FSU-Parameter was written or changed by TPS-1 firmware */
 };
 
+#define NUMBER_OF_TPS_EVENTS       32
+#define TPS_EVENT_MASK(x)          ((USIGN32)0x1 << (x))
+
+/*---------------------------------------------------------------------------*/
+/* Events dispatched first by TPS_CheckEvents(): ConnectDone, PrmEnd, Abort  */
+/* and Connect of all ARs. Within a priority the lower event bit is handled  */
+/* first. May be defined in TPS_1_user.h.                                    */
+/*---------------------------------------------------------------------------*/
+#ifndef TPS_EVENT_PRIO_HIGH_MASK
+#define TPS_EVENT_PRIO_HIGH_MASK   (TPS_EVENT_MASK(TPS_EVENT_ONCONNECTDONE_IOAR0)   | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONCONNECTDONE_IOAR1)   | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONCONNECTDONE_IOSAR)   | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ON_PRM_END_DONE_IOAR0) | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ON_PRM_END_DONE_IOAR1) | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ON_PRM_END_DONE_IOSAR) | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONABORT_IOAR0)         | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONABORT_IOAR1)         | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONABORT_IOSAR)         | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONCONNECT_REQ_REC_0)   | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONCONNECT_REQ_REC_1)   | \
+                                    TPS_EVENT_MASK(TPS_EVENT_ONCONNECT_REQ_REC_2))
+#endif
+
+/* Acknowledge of a TPS event by TPS_CheckEvents()                           */
+/*---------------------------------------------------------------------------*/
+#define EVENT_ACK_NONE             0x00    /* not acknowledged or by the handler itself */
+#define EVENT_ACK_BEFORE           0x01    /* acknowledged before the handler is called */
+#define EVENT_ACK_AFTER            0x02    /* acknowledged after the handler was called */
+
+/*! \brief Entry of the event handler table, indexed by the event bit (enum StackEvents) */
+typedef struct _event_handler
+{
+    VOID    (*pfnHandler)(USIGN32 dwParam);     /*!< \brief handler, NULL if the event is ignored */
+    USIGN32 dwParam;                            /*!< \brief parameter of the handler (e.g. the AR number) */
+    USIGN8  byAckMode;                          /*!< \brief EVENT_ACK_NONE, EVENT_ACK_BEFORE or EVENT_ACK_AFTER */
+} T_EVENT_HANDLER;
+
 #ifdef FW_UPDATE_OVER_HOST
 /*---------------------------------------------------------------------------*/
 /* Events for updating of fw over host interface                             */
@@ -679,6 +743,80 @@ POST_PACKED
 #define ETH_MBX_INUSE  0x01
 #define MBX_ERROR      0x10
 
+#ifdef USE_ETHERNET_RX_FILTER
+/* Fields compared by a rule of the ethernet receive filter (byMatch)         */
+/*----------------------------------------------------------------------------*/
+#define ETH_RX_MATCH_ETHERTYPE    0x01   /* wEtherType (behind a VLAN tag)     */
+#define ETH_RX_MATCH_DST_MAC      0x02   /* byDstMac                           */
+#define ETH_RX_MATCH_OWN_MAC      0x04   /* interface MAC of the TPS-1         */
+#define ETH_RX_MATCH_VLAN         0x08   /* wVlanId, 0: untagged or priority   */
+#define ETH_RX_MATCH_PORT         0x10   /* dwPortNumber                       */
+
+#define ETH_VLAN_TPID             0x8100
+#define ETH_VLAN_TAG_SIZE         4
+#define ETH_RX_NO_RULE            0xFF
+
+/*! \brief A rule of the ethernet receive filter. A frame is accepted by the rule
+ *  if all fields selected by byMatch are equal. */
+typedef struct _eth_rx_filter_rule
+{
+    USIGN8       byMatch;                       /*!< \brief ETH_RX_MATCH_ETHERTYPE, ... */
+    USIGN8       byDstMac[MAC_ADDRESS_SIZE];
+    USIGN16      wEtherType;
+    USIGN16      wVlanId;
+    USIGN32      dwPortNumber;
+} T_ETH_RX_FILTER_RULE;
+
+/*! \brief Header of the received frame, read by the receive filter */
+typedef struct _eth_rx_header
+{
+    USIGN32      dwLength;                      /*!< \brief frame length as in the mailbox (with FCS) */
+    USIGN32      dwPortNumber;                  /*!< \brief receiving port */
+    USIGN8       byDstMac[MAC_ADDRESS_SIZE];
+    USIGN8       bySrcMac[MAC_ADDRESS_SIZE];
+    USIGN16      wEtherType;                    /*!< \brief EtherType behind a VLAN tag */
+    USIGN16      wVlanTci;                      /*!< \brief tag control information, 0: untagged */
+    USIGN16      wPayloadOffset;                /*!< \brief offset of the payload in byFrame */
+    USIGN8       byRule;                        /*!< \brief accepting rule, ETH_RX_NO_RULE: no rules set */
+    BOOL         bToOwnMac;                     /*!< \brief sent to the interface MAC of the TPS-1 */
+} T_ETH_RX_HEADER;
+
+/*! \brief Statistics of the ethernet receive filter */
+typedef struct _eth_rx_filter_statistics
+{
+    USIGN32      dwAccepted;                    /*!< \brief frames passed to the receive callback */
+    USIGN32      dwDropped;                     /*!< \brief frames released after the header read */
+} T_ETH_RX_FILTER_STATISTICS;
+#endif
+
+#ifdef USE_ETHERNET_TX_QUEUE
+/* Queues of TPS_QueueEthernetFrame(), one per TX mailbox                     */
+/*----------------------------------------------------------------------------*/
+#define ETH_TX_QUEUE_ETHERNET     0      /* PORT_ANY, PORT_NR_1, ...           */
+#define ETH_TX_QUEUE_INTERNAL     1      /* PORT_NR_INTERNAL                   */
+#define ETH_TX_QUEUES             2
+
+/*! \brief Statistics of a TX queue */
+typedef struct _eth_tx_queue_statistics
+{
+    USIGN32      dwFrames;                      /*!< \brief frames completely written to the TPS-1 */
+    USIGN32      dwBytes;                       /*!< \brief frame bytes written to the TPS-1 */
+    USIGN32      dwFragments;                   /*!< \brief SPI writes of frame data */
+    USIGN32      dwRetries;                     /*!< \brief service calls that found the TX mailbox busy */
+    USIGN32      dwMaxWait;                     /*!< \brief maximum TPS_ServiceEthernetTxQueue() calls (not time) from queueing to sending */
+} T_ETH_TX_QUEUE_STATISTICS;
+
+/*! \brief A frame in a TX queue */
+typedef struct _eth_tx_queue_entry
+{
+    USIGN16      wOffset;                       /*!< \brief offset of the copy of the frame in the ring of the queue */
+    USIGN16      wLength;
+    USIGN16      wPortNr;
+    USIGN16      wBytesSent;                    /*!< \brief bytes already written to the TX mailbox */
+    USIGN32      dwQueuedAt;                    /*!< \brief service call counter when queued */
+} T_ETH_TX_QUEUE_ENTRY;
+#endif
+
 enum api_states
 {
     STATE_INITIAL=0,
@@ -869,6 +1007,19 @@ typedef struct _dpr_header
     FW_UPD_MAILBOX pbFwStartAddr;
 } DPR_HOST_HEADER;
 
+#ifdef USE_FW_UPDATE_STREAM
+/*! \brief Statistics of the streamed firmware update */
+typedef struct _fw_update_statistics
+{
+    USIGN32 dwBytes;            /*!< \brief image bytes written to the TPS-1 */
+    USIGN32 dwFragments;        /*!< \brief fragments written to the TPS-1 */
+    USIGN32 dwSourceStalls;     /*!< \brief service calls with a free mailbox but no full fragment */
+    USIGN32 dwMailboxBusy;      /*!< \brief service calls with a full fragment but a busy mailbox */
+    USIGN32 dwTotalTimeMs;      /*!< \brief time since TPS_FwUpdateBegin(), final after the update */
+    USIGN32 dwBytesPerSecond;   /*!< \brief dwBytes / dwTotalTimeMs */
+} T_FW_UPDATE_STATISTICS;
+#endif
+
 #endif
 
 /*****************************************************************************/
@@ -899,8 +1050,16 @@ typedef struct mail_box_info
     USIGN16     wSubSlotNumber;
     USIGN16     wIndex;
     USIGN32     dwRecordDataLen;
+    USIGN16     wSeqNumber;
 } RECORD_BOX_INFO;
 
+/*! \brief Chunk handler of TPS_ReadMailboxDataStream() and TPS_WriteMailboxDataStream().
+ *  pbyChunk holds (read) or takes (write) the record data at dwOffset. The read handler
+ *  returns 0 to get the next chunk, the write handler the number of bytes it has put into
+ *  pbyChunk; less than dwLength ends the record. A negative return value aborts the transfer. */
+typedef SIGN32 (*T_RECORD_STREAM_HANDLER)(USIGN8 byMBNumber, USIGN32 dwOffset, USIGN8* pbyChunk,
+                                          USIGN32 dwLength, VOID* pParam);
+
 typedef struct _req_header
 {
   USIGN8 request_header[SIZE_OF_REQ_HEADER];
@@ -951,9 +1110,275 @@ typedef struct __packed slot
     USIGN16*            pt_module_state;	/*!< \brief <b>!DO NOT CHANGE!</b> (Module OK=0, Substitute=1, Wrong=2, NoSubmodule=3) */
     USIGN16             wProperties;		/*!< \brief <b>!DO NOT CHANGE!</b> Pointer to some properties of this slot. This tracks for example the pull and plug status */
     struct api_list*    poApi;				/*!< \brief <b>!DO NOT CHANGE!</b> Pointer to the API in which this slot is plugged. */
+#ifdef USE_HANDLE_INDEX
+    USIGN16             wSlotNumber;		/*!< \brief <b>!DO NOT CHANGE!</b> host side copy of the slot number */
+#endif
 } SLOT;
 POST_PACKED
 
+#ifdef USE_SUBSLOT_IO_CACHE
+/*! \brief Host side copy of the IO descriptor of a subslot. Filled when an AR
+ *         reaches ConnectDone / PrmEnd and invalidated on connect, abort,
+ *         pull / plug and submodule state changes. */
+typedef struct _subslot_io_cache
+{
+    BOOL         bValid;                    /*!< \brief TPS_TRUE if the values below are valid */
+    USIGN8       byOperationalState;        /*!< \brief copy of pt_operational_state */
+    USIGN16      wUsedInCr;                 /*!< \brief copy of pt_used_in_cr (contains the SUBSLOT_FOR_AR bits) */
+    USIGN16      wProperties;               /*!< \brief copy of pt_properties */
+    USIGN16      wSizeInputData;            /*!< \brief copy of pt_size_input_data */
+    USIGN16      wOffsetInputData;          /*!< \brief copy of pt_offset_input_data */
+    USIGN16      wOffsetInputIops;          /*!< \brief copy of pt_offset_input_iops */
+    USIGN16      wOffsetInputIocs;          /*!< \brief copy of pt_offset_input_iocs */
+    USIGN16      wSizeOutputData;           /*!< \brief copy of pt_size_output_data */
+    USIGN16      wOffsetOutputData;         /*!< \brief copy of pt_offset_output_data */
+    USIGN8*      pbyInputMemory;            /*!< \brief start of the input frame buffer */
+    USIGN8*      pbyOutputMemory;           /*!< \brief start of the output frame buffer */
+} T_SUBSLOT_IO_CACHE;
+#endif
+
+PRE_PACKED
+typedef struct __packed
+{
+    USIGN16   wChannelNumber;
+    USIGN16   wChannelProperties;
+    USIGN16   wChannelErrortype;
+    USIGN16   wExtchannelErrortype;
+    USIGN32   dwExtchannelAddval;
+    USIGN32   dwQualifiedChannelQualifier;  /* API >= 0x15 */
+    USIGN8    byFlags; /* 1 appear; 2 appear ack; 3 disappear; 4 disappear ack; 5 changed; 0-empty */
+
+} DPR_DIAG_ENTRY;
+POST_PACKED
+
+#ifdef USE_DIAG_INDEX
+/*! \brief Host side copy of one entry of a diagnosis buffer (pt_chan_diag).
+ *         A used entry is linked into the chain of its key (subslot, channel
+ *         number, error type), a free entry into the free list of its subslot. */
+typedef struct _diag_index_entry
+{
+    DPR_DIAG_ENTRY  zEntry;                 /*!< \brief copy of the entry, written after the TPS-1 */
+    USIGN16         wNext;                  /*!< \brief next entry of the key chain or free list, DIAG_INDEX_END at the end */
+} T_DIAG_INDEX_ENTRY;
+
+/*! \brief Diagnosis index of a subslot. The entries are written by the driver only;
+ *         only the TPS-1 moves DISAPPEAR_FLAG to DISAPPEAR_ACK_FLAG, so the flags of
+ *         the entries counted in wPendingDisappear are read back when a free entry is needed. */
+typedef struct _subslot_diag_index
+{
+    USIGN16         wFirstEntry;            /*!< \brief first entry of the subslot in the host RAM pool */
+    USIGN16         wNumberOfEntries;       /*!< \brief number of entries of pt_chan_diag */
+    USIGN16         wFreeList;              /*!< \brief first free entry (pool index), DIAG_INDEX_END if none */
+    USIGN16         wPendingDisappear;      /*!< \brief removed entries not yet acknowledged by the TPS-1 */
+} T_SUBSLOT_DIAG_INDEX;
+
+/*! \brief One change of a diagnosis batch and the alarm that belongs to it */
+typedef struct _diag_batch_entry
+{
+    USIGN32         dwDiagAddress;          /*!< \brief address of the changed entry */
+    USIGN8          byAlarmType;            /*!< \brief APPEARS, DISAPPEARS, ... or DIAG_BATCH_NO_ALARM */
+} T_DIAG_BATCH_ENTRY;
+#endif
+
+/*! \brief Statistics of the buffer changes of one AR and direction */
+typedef struct _buffer_change_statistics
+{
+    USIGN32      dwChanges;                     /*!< \brief number of successful buffer changes */
+    USIGN32      dwTimeouts;                    /*!< \brief number of timed out buffer changes */
+    USIGN32      dwLastPolls;                   /*!< \brief status reads of the last buffer change */
+    USIGN32      dwMaxPolls;                    /*!< \brief maximum status reads of a buffer change */
+    USIGN32      dwTotalPolls;                  /*!< \brief sum of all status reads */
+} T_BUFFER_CHANGE_STATISTICS;
+
+#ifdef USE_ALARM_QUEUE
+/*! \brief An alarm waiting in the queue of its alarm mailbox */
+typedef struct _alarm_queue_entry
+{
+    USIGN32      dwAPINumber;
+    USIGN16      wSlotNumber;
+    USIGN16      wSubslotNumber;
+    USIGN16      wUsi;
+    USIGN16      wUserHandle;
+    USIGN16      wDataLength;
+    USIGN8       byAlarmType;
+    USIGN8       byData[ALARM_QUEUE_DATA_SIZE];
+} T_ALARM_QUEUE_ENTRY;
+
+/*! \brief Statistics of the alarm queue of one alarm mailbox (AR and priority) */
+typedef struct _alarm_queue_statistics
+{
+    USIGN32      dwSent;                        /*!< \brief alarms written to the alarm mailbox */
+    USIGN32      dwQueued;                      /*!< \brief alarms that had to wait in the queue */
+    USIGN32      dwCoalesced;                   /*!< \brief alarms merged into an identical queued alarm */
+    USIGN32      dwOverflows;                   /*!< \brief alarms rejected because the queue was full */
+    USIGN32      dwDropped;                     /*!< \brief queued alarms discarded (abort of the AR, send error) */
+    USIGN32      dwAcks;                        /*!< \brief alarm acknowledges */
+    USIGN16      wDepth;                        /*!< \brief alarms in the queue */
+    USIGN16      wMaxDepth;                     /*!< \brief maximum of wDepth */
+    USIGN32      dwLastAckPolls;                /*!< \brief event register reads (TPS_CheckEvents()) from sending to the acknowledge of the last alarm */
+    USIGN32      dwMaxAckPolls;                 /*!< \brief maximum of dwLastAckPolls */
+    USIGN32      dwLastAckCycles;               /*!< \brief CPU cycles from sending to the acknowledge of the last alarm (TPS_PROFILING) */
+    USIGN32      dwMaxAckCycles;                /*!< \brief maximum of dwLastAckCycles */
+    USIGN64      qwTotalAckCycles;              /*!< \brief sum of all acknowledge latencies */
+} T_ALARM_QUEUE_STATISTICS;
+#endif
+
+#ifdef USE_RECORD_REGISTRY
+/* Wildcard for the slot and subslot number of TPS_RegisterRecordHandler()   */
+/* and TPS_InvalidateRecordCache()                                           */
+/*---------------------------------------------------------------------------*/
+#define RECORD_REGISTRY_ANY           0xFFFF
+
+/* Negative return values of a record handler                                */
+/*---------------------------------------------------------------------------*/
+#define RECORD_HANDLER_INVALID_INDEX  -1   /* PNIORW ErrorCode1 0xB0 */
+#define RECORD_HANDLER_ACCESS_ERROR   -2   /* PNIORW ErrorCode1 0xA0 (read), 0xA1 (write) */
+
+/*! \brief Handler of a registered record. A read handler writes the response
+ *  to pbyData (dwLength bytes available) and returns its length. A write handler
+ *  gets the dwLength bytes of the request in pbyData and returns 0. A negative
+ *  return value rejects the request. */
+typedef SIGN32 (*T_RECORD_HANDLER)(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                   USIGN8* pbyData, USIGN32 dwLength);
+
+/*! \brief A registered record and its cached read response */
+typedef struct _record_handler_entry
+{
+    USIGN32           dwAPINumber;
+    USIGN16           wSlotNumber;
+    USIGN16           wSubslotNumber;
+    USIGN16           wIndex;
+    USIGN16           wCacheOffset;             /*!< \brief start of the response in the cache */
+    USIGN16           wCacheSize;               /*!< \brief 0: the response is not cached */
+    USIGN16           wCacheLength;             /*!< \brief length of the cached response */
+    BOOL              bCacheValid;
+    T_RECORD_HANDLER  pfnRead;
+    T_RECORD_HANDLER  pfnWrite;
+} T_RECORD_HANDLER_ENTRY;
+
+/*! \brief Statistics of the record registry */
+typedef struct _record_registry_statistics
+{
+    USIGN32      dwReads;                       /*!< \brief read requests answered by a registered handler */
+    USIGN32      dwCacheHits;                   /*!< \brief read requests answered from the cache */
+    USIGN32      dwWrites;                      /*!< \brief write requests passed to a registered handler */
+    USIGN32      dwInvalidations;               /*!< \brief cached responses discarded */
+} T_RECORD_REGISTRY_STATISTICS;
+#endif
+
+/* byPool of TPS_GetObjectPoolStatistics() */
+#define OBJECT_POOL_API_LIST          0x00        /* USED_NUMBER_OF_API API handles */
+#define OBJECT_POOL_SLOT              0x01        /* USED_NUMBER_SLOT slot handles */
+#define OBJECT_POOL_SUBSLOT           0x02        /* USED_NUMBER_SUBSLOT subslot handles */
+#define OBJECT_POOL_NUMBER            0x03
+
+/*! \brief Statistics of an object pool of the API, slot or subslot handles */
+typedef struct _object_pool_statistics
+{
+    USIGN16      wCapacity;                     /*!< \brief objects of the pool */
+    USIGN16      wInUse;                        /*!< \brief objects allocated */
+    USIGN16      wMaxInUse;                     /*!< \brief maximum of wInUse (high water mark) */
+    USIGN32      dwAllocs;                      /*!< \brief objects handed out */
+    USIGN32      dwFrees;                       /*!< \brief objects given back */
+    USIGN32      dwFailures;                    /*!< \brief requests without a free object */
+} T_OBJECT_POOL_STATISTICS;
+
+#ifdef USE_BUFFER_POOL
+#define BUFFER_POOL_BLOCK_SIZE        MAX_LEN_ETHERNET_FRAME
+
+/*! \brief Statistics of the buffer pool */
+typedef struct _buffer_pool_statistics
+{
+    USIGN32      dwAllocs;                      /*!< \brief blocks handed out */
+    USIGN32      dwFailures;                    /*!< \brief requests without a free block or longer than a block */
+    USIGN32      dwMaxLength;                   /*!< \brief longest request */
+    USIGN16      wInUse;                        /*!< \brief blocks in use */
+    USIGN16      wMaxInUse;                     /*!< \brief maximum of wInUse (high water mark) */
+} T_BUFFER_POOL_STATISTICS;
+#endif
+
+#ifdef USE_CONFIG_IMAGE
+#define CONFIG_IMAGE_MAGIC            0x43464749  /* "CFGI" */
+
+/* The run records follow the header. A record starts with a USIGN16 (little */
+/* endian): CONFIG_IMAGE_ZERO_RUN set -> the count bytes are 0x00, else the  */
+/* count bytes follow the record head. A data run is written with one burst. */
+#define CONFIG_IMAGE_ZERO_RUN         0x8000
+#define CONFIG_IMAGE_RUN_COUNT        0x7FFF
+#define CONFIG_IMAGE_RUN_HEAD_SIZE    2
+#define CONFIG_IMAGE_MIN_ZERO_RUN     16          /* shorter zero runs stay in the data run */
+
+/* byState of T_CONFIG_IMAGE_STATISTICS */
+#define CONFIG_IMAGE_NOT_LOADED       0x00        /* no image loaded, configDevice() uses SPI */
+#define CONFIG_IMAGE_REPLAY           0x01        /* image loaded, configDevice() matches it so far */
+#define CONFIG_IMAGE_MISMATCH         0x02        /* configDevice() differs from the loaded image */
+#define CONFIG_IMAGE_REPLAYED         0x03        /* TPS_StartDevice(): whole configuration was in the image */
+
+/*! \brief Header of a configuration image (TPS_BuildConfigImage()) */
+typedef struct _config_image_header
+{
+    USIGN32      dwMagic;                       /*!< \brief CONFIG_IMAGE_MAGIC */
+    USIGN32      dwApiVersion;                  /*!< \brief API_VERSION of the driver that built the image */
+    USIGN32      dwStart;                       /*!< \brief DPRAM address of the first byte (behind NRT_APP_CONFIG_HEAD) */
+    USIGN32      dwLength;                      /*!< \brief DPRAM bytes in the image */
+    USIGN32      dwRunSize;                     /*!< \brief bytes of the run records behind the header */
+    USIGN32      dwChecksum;                    /*!< \brief checksum of the run records */
+} T_CONFIG_IMAGE_HEADER;
+
+/*! \brief Statistics of the configuration image */
+typedef struct _config_image_statistics
+{
+    USIGN8       byState;                       /*!< \brief CONFIG_IMAGE_NOT_LOADED, ... */
+    USIGN32      dwImageSize;                   /*!< \brief size of the loaded image including the header */
+    USIGN32      dwDpramBytes;                  /*!< \brief DPRAM bytes written by TPS_LoadConfigImage() */
+    USIGN32      dwBursts;                      /*!< \brief SPI bursts of TPS_LoadConfigImage() */
+    USIGN32      dwWritesSuppressed;            /*!< \brief writes of configDevice() found in the image */
+    USIGN32      dwReadsServed;                 /*!< \brief reads of configDevice() answered from the image */
+} T_CONFIG_IMAGE_STATISTICS;
+#endif
+
+#ifdef USE_STARTUP_SERVICE
+/* byPhase of T_STARTUP_TIMES */
+#define STARTUP_IDLE                  0x00        /* TPS_StartupBegin() not called */
+#define STARTUP_WAIT_STACK            0x01        /* polling TPS_CheckStackStart() */
+#define STARTUP_CONFIGURE             0x02        /* configuration callback */
+#define STARTUP_WAIT_START            0x03        /* polling TPS_StartDevice() */
+#define STARTUP_RUNNING               0x04        /* device started, no AR so far */
+#define STARTUP_DONE                  0x05        /* first AR established */
+#define STARTUP_FAILED                0x06        /* dwResult is the error */
+
+#define STARTUP_TIME_NONE             0xFFFFFFFF  /* phase not reached */
+
+/*! \brief Times of the startup phases in ms since TPS_StartupBegin() */
+typedef struct _startup_times
+{
+    USIGN8       byPhase;                       /*!< \brief STARTUP_IDLE, ... */
+    USIGN32      dwStackUpMs;                   /*!< \brief TPS_CheckStackStart() successful */
+    USIGN32      dwConfigWrittenMs;             /*!< \brief configuration callback returned */
+    USIGN32      dwStartAckMs;                  /*!< \brief TPS_StartDevice() successful */
+    USIGN32      dwFirstArMs;                   /*!< \brief first AR established */
+    USIGN32      dwStackPolls;                  /*!< \brief calls of TPS_CheckStackStart() */
+    USIGN32      dwStartPolls;                  /*!< \brief calls of TPS_StartDevice() */
+    USIGN32      dwResult;                      /*!< \brief error of STARTUP_FAILED */
+} T_STARTUP_TIMES;
+#endif
+
+#ifdef USE_IO_FRAME_IMAGE
+/*! \brief Host side image of the input and output frame buffer of one IO-AR.
+ *         The images start at offset 0 of the frame buffers, so the subslot
+ *         offsets (pt_offset_input_data, ...) can be used as index. */
+typedef struct _io_frame_image
+{
+    BOOL         bValid;                        /*!< \brief TPS_TRUE if the layout below is valid */
+    USIGN8*      pbyInputMemory;                /*!< \brief start of the input frame buffer in the IO RAM */
+    USIGN16      wInputLength;                  /*!< \brief used length of the input frame (data, IOPS and IOCS) */
+    USIGN8*      pbyOutputMemory;               /*!< \brief start of the output frame buffer in the IO RAM */
+    USIGN16      wOutputLength;                 /*!< \brief used length of the output frame (data and IOPS) */
+    USIGN8       byInput[IO_FRAME_IMAGE_SIZE];  /*!< \brief staged input frame */
+    USIGN8       byOutput[IO_FRAME_IMAGE_SIZE]; /*!< \brief copy of the output frame */
+} T_IO_FRAME_IMAGE;
+#endif
+
 typedef struct subslot
 {
     USIGN16*     pt_subslot_number;			/*!< \brief <b>!DO NOT CHANGE!</b> Pointer to subslot number */
@@ -1008,6 +1433,15 @@ typedef struct subslot
 
     USIGN16*     pt_submodule_state;		/*!< \brief <b>!DO NOT CHANGE!</b> (Module OK=0, Substitute=1, Wrong=2, NoSubmodule=3) */
     SLOT*        pzSlot;					/*!< \brief <b>!DO NOT CHANGE!</b> Pointer to the slot this subslot belongs to */
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE zIoCache;			/*!< \brief <b>!DO NOT CHANGE!</b> host side copy of the IO descriptor */
+#endif
+#ifdef USE_DIAG_INDEX
+    T_SUBSLOT_DIAG_INDEX zDiagIndex;		/*!< \brief <b>!DO NOT CHANGE!</b> diagnosis index of the subslot */
+#endif
+#ifdef USE_HANDLE_INDEX
+    USIGN16      wSubslotNumber;			/*!< \brief <b>!DO NOT CHANGE!</b> host side copy of the subslot number */
+#endif
 } SUBSLOT;
 
 typedef struct api_list
@@ -1033,6 +1467,7 @@ typedef struct _api_ctx
                                            USIGN8* bIocs, USIGN8* bIops, USIGN8* pbyData, USIGN16 wDatalength, USIGN16* wSubstituteActiveFlag);
     VOID      (*OnReset_CB)(USIGN32 dwDummy);
     VOID      (*OnFSUParamChange_CB)(USIGN32 dwDummy);
+    VOID      (*OnBufferChange_CB)(USIGN8 byARNumber, USIGN8 byCrType, USIGN8 byState);
 
     API_LIST  *api_list;
     RECORD_MB record_mb[MAX_NUMBER_RECORDS];
@@ -1059,20 +1494,6 @@ typedef struct _tps_message_ctx
     VOID (*OnTpsMessageRX_CB)(T_ETHERNET_MAILBOX*);
 } T_API_TPS_MSG_CTX;
 
-PRE_PACKED
-typedef struct __packed
-{
-    USIGN16   wChannelNumber;
-    USIGN16   wChannelProperties;
-    USIGN16   wChannelErrortype;
-    USIGN16   wExtchannelErrortype;
-    USIGN32   dwExtchannelAddval;
-    USIGN32   dwQualifiedChannelQualifier;  /* API >= 0x15 */
-    USIGN8    byFlags; /* 1 appear; 2 appear ack; 3 disappear; 4 disappear ack; 5 changed; 0-empty */
-
-} DPR_DIAG_ENTRY;
-POST_PACKED
-
 
 typedef struct softwareVersion
 {
@@ -1195,6 +1616,22 @@ typedef struct __packed RWRecordBlockReq
 } RW_RECORD_REQ_BLOCK;
 POST_PACKED
 
+/* Position of RW_RECORD_REQ_BLOCK in the request header of a record mailbox */
+/* and the byte offsets of its fields (network byte order). The fields from  */
+/* seq_number to record_data_len are RECORD_REQ_HEADER_LEN bytes long, see   */
+/* TPS_RecordReqHeaderDecode() / TPS_RecordReqHeaderEncode().                */
+/*---------------------------------------------------------------------------*/
+#define RECORD_REQ_BLOCK_OFFSET    (sizeof(ETH_HEADER) + sizeof(UDP_IP_HEADER) + sizeof(RPC_HEADER) + \
+                                    sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER))
+#define RECORD_REQ_SEQ_NUMBER      0
+#define RECORD_REQ_API             (2 + sizeof(UUID_TAG))
+#define RECORD_REQ_SLOT_NUMBER     (RECORD_REQ_API + 4)
+#define RECORD_REQ_SUBSLOT_NUMBER  (RECORD_REQ_API + 6)
+#define RECORD_REQ_PADDING         (RECORD_REQ_API + 8)
+#define RECORD_REQ_INDEX           (RECORD_REQ_API + 10)
+#define RECORD_REQ_DATA_LEN        (RECORD_REQ_API + 12)
+#define RECORD_REQ_HEADER_LEN      (RECORD_REQ_DATA_LEN + 4)
+
 PRE_PACKED
 typedef struct __packed FsParamBlk
 {
@@ -1309,6 +1746,16 @@ SUBSLOT*  TPS_PlugSubmodule(SLOT*       pzSlotHandle,
                             T_IM0_DATA* pzIM0Data,
                             BOOL        bIM0Carrier);
 USIGN32 TPS_CheckEvents(VOID);
+#ifdef TPS_EVENT_IRQ_MODE
+USIGN32 TPS_EnableEventIrq(VOID);
+VOID    TPS_EventIrqHandler(VOID);
+USIGN32 TPS_DispatchEvents(VOID);
+#endif
+#ifdef USE_STARTUP_SERVICE
+USIGN32 TPS_StartupBegin(USIGN32 (*pfnConfigure)(VOID), USIGN32 (*pfnGetTimeMs)(VOID));
+USIGN32 TPS_StartupService(VOID);
+USIGN32 TPS_GetStartupTimes(T_STARTUP_TIMES* pzTimes);
+#endif
 USIGN32 TPS_GetArEstablished(USIGN32 dwARNumber);
 USIGN32 TPS_RegisterRpcCallback(USIGN8 byWhich, VOID (*pfnFunction)(USIGN32));
 USIGN32 TPS_RegisterDcpCallbackPara(USIGN8 byWhich, VOID (*pfnFunction)(USIGN32));
@@ -1323,6 +1770,11 @@ USIGN32 TPS_PrintSlotSubslotConfiguration(VOID);
 USIGN32 TPS_GetDriverVersionInfo(T_PNIO_VERSION_STRUCT* pzVersionInfo);
 USIGN32 TPS_UpdateInputData(USIGN8 byARNumber);
 USIGN32 TPS_UpdateOutputData(USIGN8 byARNumber);
+USIGN32 TPS_StartUpdateInputData(USIGN8 byARNumber);
+USIGN32 TPS_StartUpdateOutputData(USIGN8 byARNumber);
+USIGN8  TPS_PollBufferChange(VOID);
+USIGN32 TPS_RegisterBufferChangeCallback(VOID (*pfnFunction)(USIGN8 byARNumber, USIGN8 byCrType, USIGN8 byState));
+USIGN32 TPS_GetBufferChangeStatistics(USIGN8 byARNumber, USIGN8 byCrType, T_BUFFER_CHANGE_STATISTICS* pzStatistics);
 USIGN32 TPS_RegisterIMDataForSubslot(SUBSLOT* pzSubslot, T_IM0_DATA* pzIM0Data, T_IM1_DATA* pzIM1Data,  T_IM2_DATA* pzIM2Data, T_IM3_DATA* pzIM3Data, T_IM4_DATA* pzIM4Data);
 USIGN32 TPS_GetNameOfStation(USIGN8* pbyName, USIGN32 dwBufferLength);
 USIGN32 TPS_GetSerialnumber( USIGN8 *pbySerialnumber, USIGN32 dwSerialLength );
@@ -1351,6 +1803,12 @@ VOID    TPS_SetUpdaterTimeout(USIGN32 dwTimeout);
 USIGN32 TPS_GetUpdaterTimeout(VOID);
 USIGN32 TPS_WriteFWImageFragmentToFlash(USIGN8* pbyImageFrag, USIGN32 dwFragLen, USIGN8 byLastFrag);
 #endif
+#ifdef USE_FW_UPDATE_STREAM
+USIGN32 TPS_FwUpdateBegin(USIGN32 dwLengthOfImage, USIGN32 dwTimeMs);
+USIGN32 TPS_FwUpdatePush(const USIGN8* pbyData, USIGN32 dwLength);
+USIGN32 TPS_FwUpdateService(USIGN32 dwTimeMs);
+USIGN32 TPS_GetFwUpdateStatistics(T_FW_UPDATE_STATISTICS* pzStatistics);
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* Functions for Pull&Plug                                                   */
@@ -1407,6 +1865,16 @@ USIGN32 TPS_DiagChannelQualifiedAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber,
                                     USIGN16 wChannelErrortype, USIGN16 wExtchannelErrortype, USIGN32 dwExtchannelAddval,
                                     USIGN32 dwQualifiedChannelQualifier);
 USIGN32 TPS_DiagManufactorSpecdAdd(SUBSLOT* pzSubslot, USIGN16 wUsi, USIGN16 wLen, USIGN8* pbDiagData);
+#ifdef USE_DIAG_INDEX
+USIGN32 TPS_DiagBatchBegin(VOID);
+USIGN32 TPS_DiagBatchCommit(VOID);
+USIGN32 TPS_DiagBatchSendAlarms(USIGN32 dwARNumber, USIGN8 byAlarmPrio, USIGN16 wUserHandle);
+#endif
+#ifdef USE_ALARM_QUEUE
+USIGN32 TPS_QueueDiagAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
+                           USIGN16 wSubSlotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
+                           USIGN32 dwDiagAddress, USIGN16 wUserHandle);
+#endif
 
 #endif
 
@@ -1414,13 +1882,59 @@ USIGN32 TPS_DiagManufactorSpecdAdd(SUBSLOT* pzSubslot, USIGN16 wUsi, USIGN16 wLe
 /* Functions for mailbox and alarm handling                                  */
 /*---------------------------------------------------------------------------*/
 USIGN32 TPS_GetMailboxInfo(USIGN32 dwMailboxNumber, RECORD_BOX_INFO* pzMailBoxInfo);
+VOID    TPS_RecordReqHeaderDecode(const USIGN8* pbyHeader, RECORD_BOX_INFO* pzMailBoxInfo);
+VOID    TPS_RecordReqHeaderEncode(const RECORD_BOX_INFO* pzMailBoxInfo, USIGN8* pbyHeader);
 USIGN32 TPS_ReadMailboxData(USIGN8 byMBNumber, USIGN8* pbyData, USIGN32 dwLength);
 USIGN32 TPS_RecordReadDone(USIGN32 dwARNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2);
 USIGN32 TPS_WriteMailboxData(USIGN8 byMBNumber, USIGN8 *pbyData, USIGN32 dwLength);
+USIGN32 TPS_ReadMailboxDataStream(USIGN8 byMBNumber, USIGN8* pbyChunk, USIGN32 dwChunkSize,
+                                  T_RECORD_STREAM_HANDLER pfnConsume, VOID* pParam);
+USIGN32 TPS_WriteMailboxDataStream(USIGN8 byMBNumber, USIGN8* pbyChunk, USIGN32 dwChunkSize,
+                                   T_RECORD_STREAM_HANDLER pfnProduce, VOID* pParam);
 USIGN32 TPS_RecordWriteDone(USIGN32 dwMailboxNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2);
 USIGN32 TPS_SendAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
                       USIGN16 wSubSlotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
                       USIGN32 dwDataLength, USIGN8 *pbyAlarmData, USIGN16 wUsi, USIGN16 wUserHandle);
+#ifdef USE_ALARM_QUEUE
+USIGN32 TPS_QueueAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
+                       USIGN16 wSubSlotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
+                       USIGN32 dwDataLength, USIGN8 *pbyAlarmData, USIGN16 wUsi, USIGN16 wUserHandle);
+USIGN32 TPS_GetAlarmQueueStatistics(USIGN8 byARNumber, USIGN8 byAlarmPrio, T_ALARM_QUEUE_STATISTICS* pzStatistics);
+#endif
+#ifdef USE_RECORD_REGISTRY
+USIGN32 TPS_RegisterRecordHandler(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, USIGN16 wIndex,
+                                  T_RECORD_HANDLER pfnRead, T_RECORD_HANDLER pfnWrite, USIGN16 wCacheSize);
+USIGN32 TPS_InvalidateRecordCache(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, USIGN16 wIndex);
+USIGN32 TPS_GetRecordRegistryStatistics(T_RECORD_REGISTRY_STATISTICS* pzStatistics);
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Functions of the object pools                                             */
+/*---------------------------------------------------------------------------*/
+USIGN32 TPS_GetObjectPoolStatistics(USIGN8 byPool, T_OBJECT_POOL_STATISTICS* pzStatistics);
+
+/*---------------------------------------------------------------------------*/
+/* Functions of the buffer pool                                              */
+/*---------------------------------------------------------------------------*/
+#ifdef USE_BUFFER_POOL
+USIGN8* TPS_BufferPoolAlloc(USIGN32 dwLength);
+USIGN32 TPS_BufferPoolFree(USIGN8* pbyBuffer);
+USIGN32 TPS_GetBufferPoolStatistics(T_BUFFER_POOL_STATISTICS* pzStatistics);
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Functions of the configuration image                                      */
+/*---------------------------------------------------------------------------*/
+#ifdef USE_CONFIG_IMAGE
+USIGN32 TPS_LoadConfigImage(const USIGN8* pbyImage);
+USIGN32 TPS_BuildConfigImage(USIGN8* pbyImage, USIGN32 dwImageSize, USIGN32* pdwImageLength);
+USIGN32 TPS_GetConfigImageStatistics(T_CONFIG_IMAGE_STATISTICS* pzStatistics);
+/* DPRAM access of the configuration phase, used by SPI1_Master.c */
+BOOL    TPS_ConfigImageWriteFilter(USIGN8* pbyMemory, const USIGN8* pbyData, USIGN8 byFill, USIGN32 dwLength);
+BOOL    TPS_ConfigImageReadFilter(USIGN8* pbyMemory, USIGN8* pbyData, USIGN32 dwLength);
+/* Replay on / off, implemented in SPI1_Master.c */
+VOID    TPS_ConfigImageReplay(BOOL bReplay);
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* Functions for reset handling                                              */
@@ -1436,6 +1950,13 @@ USIGN32 TPS_ReadOutputData(SUBSLOT* pzSubslot, USIGN8* pbyData, USIGN16 wDataLen
 USIGN32 TPS_WriteInputData(SUBSLOT* pzSubslot, USIGN8* pbyData, USIGN16 wDataLength, USIGN8 byState);
 USIGN32 TPS_SetOutputIocs(SUBSLOT* pzSubslot, USIGN8 byState);
 USIGN32 TPS_SetInputIops(SUBSLOT* pzSubslot, USIGN8 byState);
+USIGN32 TPS_GetSubslotIoInfo(SUBSLOT* pzSubslot, USIGN16* pwUsedInCr, USIGN16* pwSizeInputData, USIGN16* pwSizeOutputData);
+#ifdef USE_IO_FRAME_IMAGE
+USIGN32 TPS_ReadOutputFrame(USIGN8 byARNumber);
+USIGN32 TPS_WriteInputFrame(USIGN8 byARNumber);
+USIGN8* TPS_GetOutputFrameImage(USIGN8 byARNumber, USIGN16* pwLength);
+USIGN8* TPS_GetInputFrameImage(USIGN8 byARNumber, USIGN16* pwLength);
+#endif
 /*---------------------------------------------------------------------------*/
 /* Functions for the ethernet interface                                      */
 /*---------------------------------------------------------------------------*/
@@ -1448,6 +1969,17 @@ USIGN32 TPS_SendEthernetFrame(USIGN8* pbyPacket, USIGN16 wLength, USIGN16 wPortN
 USIGN32 TPS_GetEthernetTXStatus(USIGN8* pzTXMailBox);
 USIGN32 TPS_SendEthernetFrameFragmented(USIGN8* pbyPacket, USIGN16 wLength, USIGN16 wPortNr, USIGN16 wMaxFragLen);
 #endif
+#ifdef USE_ETHERNET_RX_FILTER
+USIGN32 TPS_AddEthernetRxFilterRule(const T_ETH_RX_FILTER_RULE* pzRule);
+VOID    TPS_ClearEthernetRxFilter(VOID);
+const T_ETH_RX_HEADER* TPS_GetEthernetRxHeader(VOID);
+USIGN32 TPS_GetEthernetRxFilterStatistics(T_ETH_RX_FILTER_STATISTICS* pzStatistics);
+#endif
+#ifdef USE_ETHERNET_TX_QUEUE
+USIGN32 TPS_QueueEthernetFrame(USIGN8* pbyPacket, USIGN16 wLength, USIGN16 wPortNr);
+USIGN32 TPS_ServiceEthernetTxQueue(USIGN32 dwByteBudget);
+USIGN32 TPS_GetEthernetTxQueueStatistics(USIGN8 byQueue, T_ETH_TX_QUEUE_STATISTICS* pzStatistics);
+#endif
 
 USIGN32 TPS_ForwardProtocolsToHost(USIGN32 dwProtoSelector);
 USIGN32 TPS_DisableExternalFwUpdate(VOID);
@@ -1510,6 +2042,7 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define PLUG_SUB_MISSING_IM0_DATA_FOR_DAP       0x00000462
 #define PLUG_SUB_MISSING_IM0_CARRIER_FOR_DAP    0x00000463
 #define PLUG_SUB_MISSING_IM0_DATA               0x00000464
+#define PLUG_SUB_DIAG_INDEX_FULL                0x00000465
 
 /*---------------------------------------------------------------------------*/
 /* TPS_PullSubmodule()                                                       */
@@ -1548,6 +2081,19 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define ETH_FRAME_CAN_NOT_BE_SEND         0x00000610
 #define ETH_INVALID_PORT                  0x00000620
 
+/*---------------------------------------------------------------------------*/
+/* TPS_AddEthernetRxFilterRule(), TPS_GetEthernetRxFilterStatistics()        */
+/*---------------------------------------------------------------------------*/
+#define ETH_RX_FILTER_FULL                0x00000630
+#define ETH_RX_FILTER_NULL_POINTER        0x00000631
+
+/*---------------------------------------------------------------------------*/
+/* TPS_QueueEthernetFrame(), TPS_GetEthernetTxQueueStatistics()              */
+/*---------------------------------------------------------------------------*/
+#define ETH_TX_QUEUE_FULL                 0x00000640
+#define ETH_TX_QUEUE_INVALID              0x00000641
+#define ETH_TX_QUEUE_INVALID_PARAM        0x00000642
+
 /*---------------------------------------------------------------------------*/
 /* TPS_RegisterRpcCallback / TPS_RegisterDcpCallback /                       */
 /* TPS_RegisterAlarmDiagCallback                                             */
@@ -1594,18 +2140,23 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define API_RECORD_READ_INVALID_MAILBOX     0x00000937
 
 /*---------------------------------------------------------------------------*/
-/* ErrorCodes for TPS_ReadMailboxData()                                      */
+/* ErrorCodes for TPS_ReadMailboxData(), TPS_ReadMailboxDataStream()         */
 /*---------------------------------------------------------------------------*/
 #define API_READ_MB_BUFFER_TOO_SMALL        0x00000940
 #define API_READ_MB_INVALID_MAILBOX         0x00000941
 #define API_READ_MB_WRONG_FLAG              0x00000942
+#define API_READ_MB_NULL_POINTER            0x00000943
+#define API_READ_MB_STREAM_ABORTED          0x00000944
+#define API_READ_MB_RECORD_TOO_LONG         0x00000945
 
 /*---------------------------------------------------------------------------*/
-/* ErrorCodes for TPS_WriteMailboxData()                                     */
+/* ErrorCodes for TPS_WriteMailboxData(), TPS_WriteMailboxDataStream()       */
 /*---------------------------------------------------------------------------*/
 #define API_WRITE_MB_TOO_MUCH_DATA          0x00000950
 #define API_WRITE_MB_INVALID_MAILBOX        0x00000951
 #define API_WRITE_MB_WRONG_FLAG             0x00000952
+#define API_WRITE_MB_NULL_POINTER           0x00000953
+#define API_WRITE_MB_STREAM_ABORTED         0x00000954
 
 /*---------------------------------------------------------------------------*/
 /* ErrorCode for TPS_OnRecordWriteCallback()                                 */
@@ -1640,6 +2191,15 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define API_DIAG_CHANGE_NO_ACK             0x00000992
 #define API_DIAG_CHANGE_EVENT_IN_USE       0x00000993
 
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_DiagBatchBegin() / Commit() / SendAlarms()             */
+/*---------------------------------------------------------------------------*/
+#define API_DIAG_BATCH_ALREADY_OPEN        0x000009A0
+#define API_DIAG_BATCH_NOT_OPEN            0x000009A1
+#define API_DIAG_BATCH_EVENT_IN_USE        0x000009A2
+#define API_DIAG_BATCH_FULL                0x000009A3
+#define API_DIAG_BATCH_STILL_OPEN          0x000009A4
+
 /*---------------------------------------------------------------------------*/
 /* ErrorCodes for AppPullPlugSubmodule()                                     */
 /*---------------------------------------------------------------------------*/
@@ -1674,6 +2234,14 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define API_ALARM_SUBSLOT_NOT_USED_BY_AR   0x00002060
 #define API_ALARM_DATA_TOO_LONG            0x00002070
 
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_QueueAlarm() and TPS_GetAlarmQueueStatistics()         */
+/*---------------------------------------------------------------------------*/
+#define API_ALARM_QUEUE_FULL               0x00002080
+#define API_ALARM_QUEUE_COALESCED          0x00002081
+#define API_ALARM_QUEUE_DATA_TOO_LONG      0x00002082
+#define API_ALARM_QUEUE_NULL_POINTER       0x00002083
+
 /*---------------------------------------------------------------------------*/
 /* ErrorCodes for TPS_ReadOutputData() and TPS_WriteInputData()              */
 /*---------------------------------------------------------------------------*/
@@ -1683,6 +2251,7 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define API_IODATA_WRONG_MODULE_PROJECTED  0x00002120
 #define API_IODATA_MODULE_HAS_NO_OUTPUTS   0x00002130
 #define API_IODATA_NOT_USED_IN_CR          0x00002140
+#define API_IODATA_FRAME_IMAGE_LAYOUT      0x00002150
 
 /*---------------------------------------------------------------------------*/
 /* ErrorCodes for TPS_DiagChannelAdd()                                       */
@@ -1777,6 +2346,8 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 /* ErrorCodes for TPS_UpdateOutputData(), TPS_UpdateInputData()              */
 /*---------------------------------------------------------------------------*/
 #define API_WRONG_AR_NUMBER                0x00004400
+#define API_BUFFER_CHANGE_BUSY             0x00004401
+#define API_BUFFER_CHANGE_TIMEOUT          0x00004402
 
 /*---------------------------------------------------------------------------*/
 /* ErrorCodes for TPS_SetOutputIocs()                                        */
@@ -1789,5 +2360,54 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
 #define REGISTER_IM_SUBSLOT_NOT_FOUND      0x00004600
 #define REGISTER_IM_SUBSLOT_NOT_DAP        0x00004601
 
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_RegisterRecordHandler(), TPS_InvalidateRecordCache()   */
+/*---------------------------------------------------------------------------*/
+#define API_RECORD_REGISTRY_FULL           0x00004700
+#define API_RECORD_REGISTRY_EXISTS         0x00004701
+#define API_RECORD_REGISTRY_NULL_POINTER   0x00004702
+#define API_RECORD_REGISTRY_CACHE_FULL     0x00004703
+#define API_RECORD_REGISTRY_NOT_FOUND      0x00004704
+#define API_RECORD_REGISTRY_INVALID_PARAM  0x00004705
+
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_BufferPoolFree(), TPS_GetBufferPoolStatistics()        */
+/*---------------------------------------------------------------------------*/
+#define API_BUFFER_POOL_INVALID_BUFFER     0x00004800
+#define API_BUFFER_POOL_NULL_POINTER       0x00004801
+
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_FwUpdateBegin(), TPS_FwUpdateService()                 */
+/*---------------------------------------------------------------------------*/
+#define API_FW_STREAM_NOT_STARTED          0x00004900
+#define API_FW_STREAM_BUSY                 0x00004901
+#define API_FW_STREAM_TIMEOUT              0x00004902
+#define API_FW_STREAM_UPDATER_ERROR        0x00004903
+#define API_FW_STREAM_INVALID_PARAM        0x00004904
+#define API_FW_STREAM_SOURCE_TIMEOUT       0x00004905
+
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_LoadConfigImage(), TPS_BuildConfigImage()              */
+/*---------------------------------------------------------------------------*/
+#define API_CONFIG_IMAGE_INVALID           0x00004A00
+#define API_CONFIG_IMAGE_VERSION           0x00004A01
+#define API_CONFIG_IMAGE_CHECKSUM          0x00004A02
+#define API_CONFIG_IMAGE_TOO_SMALL         0x00004A03
+#define API_CONFIG_IMAGE_NULL_POINTER      0x00004A04
+
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_StartupBegin(), TPS_StartupService()                   */
+/*---------------------------------------------------------------------------*/
+#define API_STARTUP_NOT_STARTED            0x00004B00
+#define API_STARTUP_BUSY                   0x00004B01
+#define API_STARTUP_NULL_POINTER           0x00004B02
+
+/*---------------------------------------------------------------------------*/
+/* ErrorCodes for TPS_GetObjectPoolStatistics()                              */
+/*---------------------------------------------------------------------------*/
+#define API_OBJECT_POOL_INVALID_POOL       0x00004C00
+#define API_OBJECT_POOL_NULL_POINTER       0x00004C01
+#define API_OBJECT_POOL_INVALID_OBJECT     0x00004C02
+
 
 #endif /* _API_NEW_H_ */
@@ -0,0 +1,132 @@
+/*
++-----------------------------------------------------------------------------+
+| ****************************** TPS_1_Sim.h *******************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Header of TPS_1_Sim.c (host model of the TPS-1 DPRAM).                      |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_1_Sim.h
+ *  \brief header defintion for TPS_1_Sim.c (host model of the TPS-1 DPRAM)
+ */
+
+#ifndef _TPS_1_SIM_H_
+#define _TPS_1_SIM_H_
+
+#include <TPS_1_user.h>
+
+#ifdef TPS_HOST_SIMULATION
+
+/* Size of the modelled DPRAM: register area and NRT area, 16 bit address.   */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_DPRAM_SIZE          0x10000
+
+/* Model clock: cycles per SPI byte (SCK 18 MHz at 72 MHz core clock) and   */
+/* per millisecond of HAL_Delay(). The model clock is the cycle source of    */
+/* the profiling (TPS_Profile.c).                                            */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_CYCLES_PER_SPI_BYTE 32
+#define TPS_SIM_CYCLES_PER_MS       72000
+
+/* Number of status reads that still return "pending" after an IO buffer     */
+/* change was requested. Can be changed by TPS_SimSetBufferChangeLatency().  */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_BUFFER_CHANGE_LATENCY  1
+
+/* Actions of a replay step                                                  */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_STEP_RAISE_EVENT    0x00  /* set TPS event dwParam           */
+#define TPS_SIM_STEP_WRITE_MEM      0x01  /* copy pbyData to address dwParam */
+#define TPS_SIM_STEP_RECORD_REQ     0x02  /* pbyData: T_TPS_SIM_RECORD_REQ   */
+#define TPS_SIM_STEP_CALL           0x03  /* call pfnCall(dwParam)           */
+#define TPS_SIM_STEP_STOP           0x04  /* print the counters and exit     */
+
+/* Record mailboxes: 0/1 IO-AR, SUPERVISOR_MB_NUM, IMPLICITE_MB_NUM          */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_NUMBER_RECORD_MB    4
+
+/* Offsets in a record mailbox, see APP_AddDevice()                          */
+/*---------------------------------------------------------------------------*/
+#define TPS_SIM_RECORD_MB_FLAGS        4
+#define TPS_SIM_RECORD_MB_ERRORCODE1   8
+#define TPS_SIM_RECORD_MB_REQ_HEADER   12
+#define TPS_SIM_RECORD_MB_DATA         (TPS_SIM_RECORD_MB_REQ_HEADER + SIZE_OF_REQ_HEADER)
+
+/*! One step of a replay. The steps are executed by TPS_SimIdle() in the main
+ *  loop of the application: a step is executed when the driver has
+ *  acknowledged all events of the previous steps and the main loop has run
+ *  at least dwDelayLoops times since the previous step. So the replay does
+ *  not depend on the number of SPI commands of the driver. */
+typedef struct _T_TPS_SIM_STEP
+{
+    USIGN32        dwDelayLoops;            /*!< minimum main loop passes since the previous step */
+    USIGN8         byAction;                /*!< TPS_SIM_STEP_RAISE_EVENT, ... */
+    USIGN32        dwParam;                 /*!< event bit, DPRAM address or parameter of pfnCall */
+    const USIGN8*  pbyData;                 /*!< TPS_SIM_STEP_WRITE_MEM: data */
+    USIGN16        wLength;                 /*!< TPS_SIM_STEP_WRITE_MEM: length of pbyData */
+    VOID           (*pfnCall)(USIGN32);     /*!< TPS_SIM_STEP_CALL: function */
+    const CHAR*    pszName;                 /*!< printed with the SPI counters of the step */
+}T_TPS_SIM_STEP;
+
+/*! Parameters of TPS_SIM_STEP_RECORD_REQ, pointed to by pbyData. */
+typedef struct _T_TPS_SIM_RECORD_REQ
+{
+    USIGN8         byMailbox;               /*!< record mailbox 0 .. 3 */
+    USIGN8         byFlag;                  /*!< RECORD_FLAG_READ or RECORD_FLAG_WRITE */
+    USIGN32        dwApi;
+    USIGN16        wSlot;
+    USIGN16        wSubslot;
+    USIGN16        wIndex;
+    USIGN32        dwDataLength;            /*!< requested length (read) or length of pbyData (write) */
+    const USIGN8*  pbyData;                 /*!< write data or NULL */
+}T_TPS_SIM_RECORD_REQ;
+
+/*! SPI traffic counted by the model */
+typedef struct _T_TPS_SIM_COUNTERS
+{
+    USIGN32        dwReadCommands;          /*!< direct and block reads */
+    USIGN32        dwWriteCommands;         /*!< direct and block writes */
+    USIGN32        dwBytes;                 /*!< all SPI bytes including the command */
+    USIGN32        dwPayloadBytes;          /*!< data bytes without the command */
+    USIGN32        dwBufferChanges;         /*!< IO buffer change requests */
+    USIGN32        dwEventsRaised;          /*!< TPS events set by the model */
+    USIGN32        dwAppEvents;             /*!< events of the driver to the TPS-1 */
+    USIGN32        dwRecordsDone;           /*!< record requests finished by the driver */
+    USIGN32        dwAlarmsAcked;           /*!< alarms acknowledged by the model */
+    USIGN32        dwDmaTransfers;          /*!< transfers of the DMA model */
+}T_TPS_SIM_COUNTERS;
+
+VOID      TPS_SimInit(const T_TPS_SIM_STEP* pzSteps, USIGN32 dwNumberOfSteps);
+USIGN8    TPS_SimSpiByte(USIGN8 byMosi);
+VOID      TPS_SimDmaTransfer(const USIGN8* pbyTxSource, BOOL bTxIncrement, USIGN8* pbyRxData, USIGN32 dwLength);
+VOID      TPS_SimTraceStart(USIGN8* pbyTrace, USIGN32 dwSize);
+USIGN32   TPS_SimTraceStop(VOID);
+VOID      TPS_SimIdle(VOID);
+VOID      TPS_SimRaiseEvent(USIGN32 dwEventBit);
+VOID      TPS_SimRecordRequest(const T_TPS_SIM_RECORD_REQ* pzRequest);
+VOID      TPS_SimWriteMem(USIGN32 dwAddress, const USIGN8* pbyData, USIGN32 dwLength);
+VOID      TPS_SimReadMem(USIGN32 dwAddress, USIGN8* pbyData, USIGN32 dwLength);
+USIGN32   TPS_SimGetRecordMailbox(USIGN8 byMailbox);
+USIGN32   TPS_SimGetAlarmMailbox(USIGN8 byMailbox);
+VOID      TPS_SimSetBufferChangeLatency(USIGN32 dwPolls);
+VOID      TPS_SimSetStartupTimes(USIGN32 dwStackUpMs, USIGN32 dwStartAckMs);
+VOID      TPS_SimGetCounters(T_TPS_SIM_COUNTERS* pzCounters);
+VOID      TPS_SimResetCounters(VOID);
+USIGN32   TPS_SimGetCycles(VOID);
+VOID      TPS_SimDelay(USIGN32 dwMilliseconds);
+
+/* Replacements of the HAL functions used by the example application       */
+/* TPSDriver.c. The LEDs are not modelled.                                   */
+/*---------------------------------------------------------------------------*/
+#define GPIO_PIN_RESET                    0
+#define GPIO_PIN_SET                      1
+#define HAL_GPIO_WritePin(port, pin, val)
+#define HAL_Delay(ms)                     TPS_SimDelay(ms)
+#define HAL_GetTick()                     (TPS_SimGetCycles() / TPS_SIM_CYCLES_PER_MS)
+#define __nop()
+
+#endif /* TPS_HOST_SIMULATION */
+
+#endif /* #ifndef _TPS_1_SIM_H_ */
@@ -81,6 +81,19 @@
 /*---------------------------------------------------------------------------*/
 #define LITTLE_ENDIAN_FORMAT
 
+/* Number of trailing zero bits of a 32 bit value != 0. Used to step        */
+/* through the set bits of the event register. Without a definition a      */
+/* portable C version is used.                                              */
+/*---------------------------------------------------------------------------*/
+#if defined(__ICCARM__)
+  #include <intrinsics.h>
+  #define TPS_COUNT_TRAILING_ZEROS(x)   ((USIGN32)__CLZ(__RBIT(x)))
+#elif defined(__CC_ARM)
+  #define TPS_COUNT_TRAILING_ZEROS(x)   ((USIGN32)__clz(__rbit(x)))
+#elif defined(__GNUC__)
+  #define TPS_COUNT_TRAILING_ZEROS(x)   ((USIGN32)__builtin_ctz(x))
+#endif
+
 /* Serial or parallel interface for data wrapping.                           */
 /*---------------------------------------------------------------------------*/
 //#define PARALLEL_INTERFACE
@@ -109,6 +122,7 @@ typedef  unsigned short USIGN16;   /* 16 bits, 0 to 65535                    */
 typedef  signed short   SIGN16;    /* 16 bits, -32768 to 32767               */
 typedef  unsigned int   USIGN32;   /* 32 bits, 0 to 2exp32-1                 */
 typedef  signed int     SIGN32;    /* 32 bits, -2exp31 to 2exp31-1           */
+typedef  unsigned long long USIGN64; /* 64 bits, 0 to 2exp64-1               */
 typedef  unsigned char  CHAR;      /* character (8-bit)                      */
 typedef  unsigned char  BOOL;      /* Bool (TPS_TRUE or TPS_FALSE)           */
 
@@ -116,6 +130,7 @@ typedef  unsigned char  BOOL;      /* Bool (TPS_TRUE or TPS_FALSE)           */
 
 #define USIGN32 unsigned int
 #define SIGN32 int
+#define USIGN64 unsigned long long
 #define USIGN16 unsigned short
 #define SIGN16 short
 #define USIGN8 unsigned char
@@ -165,6 +180,31 @@ typedef  unsigned char  BOOL;      /* Bool (TPS_TRUE or TPS_FALSE)           */
 /*---------------------------------------------------------------------------*/
 #undef USE_ETHERNET_MIRROR_APPLICATION
 
+/* If active, received ethernet frames are checked against the rules of      */
+/* TPS_AddEthernetRxFilterRule() (EtherType, destination MAC, VLAN, port)    */
+/* with one short SPI read of the frame header. Frames no rule accepts are   */
+/* released without calling the receive callback. As long as no rule is     */
+/* set, every frame is accepted. ETH_RX_FILTER_RULES is the size of the      */
+/* rule table. Only used with USE_ETHERNET_INTERFACE.                        */
+/*---------------------------------------------------------------------------*/
+#define USE_ETHERNET_RX_FILTER
+#define ETH_RX_FILTER_RULES         4
+
+/* If active, TPS_QueueEthernetFrame() copies frames into a queue per TX     */
+/* mailbox (ethernet and TPS communication channel) and                      */
+/* TPS_ServiceEthernetTxQueue() writes them to the TPS-1 in fragments of at  */
+/* most ETH_TX_BUDGET_PER_CYCLE bytes per call. The example application      */
+/* calls it once per main loop pass after the cyclic IO data update.         */
+/* ETH_TX_QUEUE_DEPTH is the number of frames per queue. The frames are      */
+/* copied into a ring of ETH_TX_QUEUE_SIZE bytes per queue, which must be    */
+/* larger than MAX_LEN_ETHERNET_FRAME. Costs 2 * ETH_TX_QUEUE_SIZE bytes of  */
+/* RAM (3 kB with the value below). Only used with USE_ETHERNET_INTERFACE.   */
+/*---------------------------------------------------------------------------*/
+#define USE_ETHERNET_TX_QUEUE
+#define ETH_TX_QUEUE_DEPTH          4
+#define ETH_TX_QUEUE_SIZE           1536
+#define ETH_TX_BUDGET_PER_CYCLE     256
+
 /* If active, the driver will enable the autoconfiguration of modules.       */
 /* This will allow the TPS-1 to accept the Slot/Subslot configuration given  */
 /* by the PROFINET controller.                                               */
@@ -188,10 +228,199 @@ typedef  unsigned char  BOOL;      /* Bool (TPS_TRUE or TPS_FALSE)           */
 /*---------------------------------------------------------------------------*/
 #undef FW_UPDATE_OVER_HOST
 
+/* If active, the firmware image can be streamed to the TPS-1 without having */
+/* it in host memory: TPS_FwUpdatePush() takes the bytes from the source     */
+/* (e.g. the debug UART) into two fragment buffers, TPS_FwUpdateService()    */
+/* writes a full fragment when the TPS-1 has taken the previous one. Both    */
+/* return at once, so the next fragment is received while the TPS-1 programs */
+/* the current one. TPS_FwUpdateService() ends the update if no fragment    */
+/* was written for FW_STREAM_TIMEOUT_MS, because the source stalled or the   */
+/* TPS-1 did not take a fragment. Only used with FW_UPDATE_OVER_HOST.        */
+/*---------------------------------------------------------------------------*/
+#define USE_FW_UPDATE_STREAM
+#define FW_STREAM_TIMEOUT_MS        5000
+
 /* This define activates code for usage of pull and plug-submodule functions */
 /*---------------------------------------------------------------------------*/
 #undef PLUG_RETURN_SUBMODULE_ENABLE
 
+/* If active, the IO descriptor of each subslot (used in CR, sizes, offsets */
+/* and frame buffer addresses) is cached in host RAM. The cyclic IO          */
+/* functions then transfer only the payload and the IOXS over SPI.           */
+/*---------------------------------------------------------------------------*/
+#define USE_SUBSLOT_IO_CACHE
+
+/* If active, the cyclic IO data of each IO-AR is kept as a whole frame     */
+/* image in host RAM. TPS_ReadOutputFrame() and TPS_WriteInputFrame() move   */
+/* the frame with a single SPI burst, the per subslot IO functions only      */
+/* access the image. IO_FRAME_IMAGE_SIZE is the maximum frame length (input  */
+/* and output) per IO-AR. Requires USE_SUBSLOT_IO_CACHE. Costs two images   */
+/* of IO_FRAME_IMAGE_SIZE bytes per IO-AR in RAM, off by default.            */
+/*---------------------------------------------------------------------------*/
+#undef USE_IO_FRAME_IMAGE
+#define IO_FRAME_IMAGE_SIZE         256
+
+/* If active, the diagnosis entries of all subslots are kept in a host RAM   */
+/* index keyed by subslot, channel number and error type, with a list of the */
+/* free entries of each subslot. Adding, removing and changing a diagnosis   */
+/* then writes only the affected entry over SPI. DIAG_INDEX_SIZE is the      */
+/* number of entries of all subslots together (see wNumberOfChannelDiag of   */
+/* TPS_PlugSubmodule()), DIAG_INDEX_HASH_SIZE the number of key chains (a    */
+/* power of two). Only used with DIAGNOSIS_ENABLE.                           */
+/* The diagnosis batch (TPS_DiagBatchBegin()) needs the index. It takes up   */
+/* to DIAG_BATCH_SIZE changes.                                               */
+/*---------------------------------------------------------------------------*/
+#define USE_DIAG_INDEX
+#define DIAG_INDEX_SIZE             64
+#define DIAG_INDEX_HASH_SIZE        16
+#define DIAG_BATCH_SIZE             16
+
+/* If active, TPS_QueueAlarm() and TPS_QueueDiagAlarm() keep alarms whose    */
+/* alarm mailbox (AR and priority) is busy in a host RAM queue. The queue of */
+/* a mailbox is sent by the alarm acknowledge event. If the queue is full,   */
+/* an alarm identical to a queued one is merged into it. ALARM_QUEUE_DEPTH   */
+/* is the number of alarms per mailbox, ALARM_QUEUE_DATA_SIZE the maximum    */
+/* data length of a queued alarm (a diagnosis alarm needs 16 bytes). The     */
+/* acknowledge latency is counted in reads of the event register, in CPU     */
+/* cycles with TPS_PROFILING only. Costs 4 queues of ALARM_QUEUE_DEPTH *     */
+/* (ALARM_QUEUE_DATA_SIZE + 16) bytes in RAM (768 bytes with the values      */
+/* below), off by default.                                                   */
+/*---------------------------------------------------------------------------*/
+#undef USE_ALARM_QUEUE
+#define ALARM_QUEUE_DEPTH           4
+#define ALARM_QUEUE_DATA_SIZE       32
+
+/* If active, the application can register handlers for its records with    */
+/* TPS_RegisterRecordHandler(). The driver answers these records itself,     */
+/* the OnReadRecord / OnWriteRecord callbacks only get the other indexes.    */
+/* The responses of read handlers registered with a cache size are kept in   */
+/* host RAM until the record is written or TPS_InvalidateRecordCache() is    */
+/* called. RECORD_REGISTRY_SIZE is the number of handlers, RECORD_CACHE_SIZE */
+/* the size of the response cache of all handlers together.                  */
+/*---------------------------------------------------------------------------*/
+#define USE_RECORD_REGISTRY
+#define RECORD_REGISTRY_SIZE        8
+#define RECORD_CACHE_SIZE           64
+
+/* If active, the packet buffers of the TPS communication channel and of     */
+/* the DCP requests to the TPS-1 and the record buffers of the example       */
+/* application are taken from a static pool instead of the heap              */
+/* (TPS_BufferPoolAlloc()). The pool has BUFFER_POOL_BLOCKS blocks of        */
+/* MAX_LEN_ETHERNET_FRAME bytes. A request for more bytes fails like a       */
+/* failed malloc(). Costs BUFFER_POOL_BLOCKS * 1524 bytes of RAM (about 3 kB */
+/* with the value below). On by default: the heap of the example projects    */
+/* is 0x200 bytes and cannot hold one of these buffers, without the pool it  */
+/* must be raised by more than the pool costs.                               */
+/*---------------------------------------------------------------------------*/
+#define USE_BUFFER_POOL
+#define BUFFER_POOL_BLOCKS          2
+
+/* If active, the slot and subslot handles of an API, slot and subslot       */
+/* number are found by a hash index in the host RAM instead of walking the   */
+/* handle lists and reading each slot and subslot number from the DPRAM.     */
+/* The index is filled by TPS_PlugModule() / TPS_PlugSubmodule(), the        */
+/* numbers are kept in the handles. HANDLE_INDEX_SIZE is a power of two and  */
+/* at least twice USED_NUMBER_SLOT + USED_NUMBER_SUBSLOT.                    */
+/*---------------------------------------------------------------------------*/
+#define USE_HANDLE_INDEX
+#define HANDLE_INDEX_SIZE           32
+
+/* If active, the configuration of the NRT area written by configDevice()    */
+/* can be kept as an image (TPS_BuildConfigImage()), e.g. in the flash of    */
+/* the host. With a valid image TPS_LoadConfigImage() writes the whole       */
+/* configuration with a few SPI bursts, configDevice() then only builds the  */
+/* API, slot and subslot handles: its writes equal to the image are not      */
+/* sent, its reads are answered from the image. If the configuration         */
+/* differs from the image, the driver goes back to SPI access and the image  */
+/* is built again. The DPRAM accesses are only checked against the image     */
+/* while it is replayed. CONFIG_IMAGE_FLASH_ADDRESS / CONFIG_IMAGE_MAX_SIZE  */
+/* is the flash area used by the example application: the last page of the   */
+/* 64 kB flash (HOST_FLASH_SIZE), reserved in EWARM/stm32f103xb_flash.icf    */
+/* and in the IROM1 size of the MDK-ARM project. The example builds the      */
+/* image in a static buffer of CONFIG_IMAGE_MAX_SIZE bytes of RAM.           */
+/*---------------------------------------------------------------------------*/
+#define USE_CONFIG_IMAGE
+#define HOST_FLASH_BASE             0x08000000
+#define HOST_FLASH_SIZE             0x10000
+#define CONFIG_IMAGE_MAX_SIZE       0x400
+#define CONFIG_IMAGE_FLASH_ADDRESS  (HOST_FLASH_BASE + HOST_FLASH_SIZE - CONFIG_IMAGE_MAX_SIZE)
+
+/* Maximum number of status reads while waiting for the TPS-1 to change an  */
+/* IO buffer (TPS_UpdateInputData / TPS_UpdateOutputData). Each read is one  */
+/* SPI transfer. After that the buffer change is reported as timed out.      */
+/*---------------------------------------------------------------------------*/
+#define BUFFER_CHANGE_TIMEOUT_POLLS 10000
+
+/* If active, the events of the TPS-1 are signalled by the host interrupt   */
+/* line (EXTI, see TPS_HOST_IRQ_Pin in main.h). The ISR only latches the     */
+/* interrupt, TPS_DispatchEvents() reads the event register and calls the    */
+/* callbacks in the main loop. Without pending interrupt it does no SPI      */
+/* access. Otherwise the event register is polled by TPS_CheckEvents().      */
+/*---------------------------------------------------------------------------*/
+#undef TPS_EVENT_IRQ_MODE
+
+/* If active, the startup of the example application is done by the state    */
+/* machine TPS_StartupService(): TPS_CheckStackStart() and TPS_StartDevice() */
+/* are polled with a backoff from STARTUP_POLL_MIN_MS to STARTUP_POLL_MAX_MS */
+/* (doubled per poll). With TPS_EVENT_IRQ_MODE the host interrupt is         */
+/* enabled when the stack is up and triggers the next poll at once. The      */
+/* times of the startup phases are reported by TPS_GetStartupTimes().        */
+/*---------------------------------------------------------------------------*/
+#define USE_STARTUP_SERVICE
+#define STARTUP_POLL_MIN_MS         1
+#define STARTUP_POLL_MAX_MS         8
+
+/* If active, HOST_SFRN is asserted once per TPS command (burst framing).   */
+/* Otherwise it is toggled around every byte. The inter-byte timing of both  */
+/* modes is taken from the timing table entry SPI_BOARD_TIMING.              */
+/*---------------------------------------------------------------------------*/
+#undef SPI_BURST_FRAMING
+#define SPI_BOARD_TIMING    SPI_BOARD_STM32F103_TPS1
+
+/* If active, SPI transfers with at least SPI_DMA_MIN_TRANSFER_LEN bytes are */
+/* done by DMA1 (channel 2: SPI1_RX, channel 3: SPI1_TX). The end of the     */
+/* transfer is signalled by the SPI DMA interrupt. DMA is only used while    */
+/* burst framing is selected. Shorter transfers use the polled path.         */
+/* The accessors still return after the transfer: the core sleeps until the  */
+/* DMA interrupt instead of running the byte loop, it does not run other     */
+/* code of the application meanwhile.                                        */
+/*---------------------------------------------------------------------------*/
+#undef SPI_DMA_TRANSFER
+#define SPI_DMA_MIN_TRANSFER_LEN    16
+#define SPI_DMA_TIMEOUT_MS          10
+
+/* If active, TPS_SPI_Benchmark() is called after the stack start. It prints */
+/* the SPI throughput for both framing modes over the debug UART.            */
+/*---------------------------------------------------------------------------*/
+#undef SPI_BENCHMARK
+
+/* If active, the SPI/DPRAM accesses, the event handling and the IO buffer   */
+/* changes are measured with the DWT cycle counter (see TPS_Profile.h).     */
+/* Send 'p' over the debug UART to print the table, 'r' to clear it.        */
+/* For a PC build of TPS_Profile.c additionally define                      */
+/* TPS_PROFILE_HOST_BUILD, the cycles then come from a function set by       */
+/* TPS_ProfileSetCycleSource().                                              */
+/*---------------------------------------------------------------------------*/
+#undef TPS_PROFILING
+
+/* If active, TPS_AccessorBenchmark() is called after the stack start. It    */
+/* measures the TPS_* DPRAM accessors for several data sizes and alignments  */
+/* and prints SPI commands, bytes and cycles per call (see TPS_Benchmark.h). */
+/* Needs TPS_PROFILING.                                                      */
+/*---------------------------------------------------------------------------*/
+#undef TPS_ACCESSOR_BENCHMARK
+
+/* Host simulation: TPS_HOST_SIMULATION is set on the compiler command line, */
+/* not here. The driver then runs on a PC against the TPS-1 model of         */
+/* TPS_1_Sim.c instead of SPI1 (build command see there). The options that   */
+/* need the STM32 HAL are switched off. SPI_DMA_TRANSFER uses the DMA model  */
+/* of TPS_1_Sim.c.                                                           */
+/*---------------------------------------------------------------------------*/
+#ifdef TPS_HOST_SIMULATION
+#undef SPI_BENCHMARK
+#define TPS_PROFILE_HOST_BUILD
+#endif
+
 
 /* This define activates code for usage of api fuctions for getting of fast   */
 /* startup parameters                                                         */
@@ -0,0 +1,38 @@
+/*
++-----------------------------------------------------------------------------+
+| ***************************** TPS_Benchmark.h ****************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Header of TPS_Benchmark.c (DPRAM accessor micro-benchmark).                 |
++-----------------------------------------------------------------------------+
+*/
+
+
+/*! \file TPS_Benchmark.h
+ *  \brief header defintion for TPS_Benchmark.c (benchmark of the DPRAM accessors)
+ */
+
+#ifndef _TPS_BENCHMARK_H_
+#define _TPS_BENCHMARK_H_
+
+#include <TPS_1_user.h>
+
+#ifdef TPS_ACCESSOR_BENCHMARK
+
+/* Calls of the accessor per measured case                                   */
+/*---------------------------------------------------------------------------*/
+#define TPS_BENCHMARK_RUNS          16
+
+/* Scratch area of the benchmark in the NRT area. It is used before the     */
+/* device configuration is written, which overwrites it afterwards. The area */
+/* lies within one 4 kB page.                                                */
+/*---------------------------------------------------------------------------*/
+#define TPS_BENCHMARK_AREA          (BASE_ADDRESS_NRT_AREA + 0x1000)
+#define TPS_BENCHMARK_AREA_SIZE     0x0800
+
+VOID      TPS_AccessorBenchmark(VOID);
+
+#endif /* TPS_ACCESSOR_BENCHMARK */
+
+#endif /* #ifndef _TPS_BENCHMARK_H_ */
@@ -0,0 +1,69 @@
+/*
++-----------------------------------------------------------------------------+
+| ****************************** TPS_Profile.h *****************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Header of TPS_Profile.c (cycle counter profiling).                          |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_Profile.h
+ *  \brief header defintion for TPS_Profile.c (cycle counter profiling)
+ */
+
+#ifndef _TPS_PROFILE_H_
+#define _TPS_PROFILE_H_
+
+#include <TPS_1_user.h>
+
+/* Measuring points of the profiling table                                   */
+/*---------------------------------------------------------------------------*/
+#define TPS_PROFILE_SPI_READ          0   /* TPS_SPI_ReadData()              */
+#define TPS_PROFILE_SPI_WRITE         1   /* TPS_SPI_WriteData()             */
+#define TPS_PROFILE_CHECK_EVENTS      2   /* TPS_CheckEvents()               */
+#define TPS_PROFILE_UPDATE_INPUT      3   /* TPS_UpdateInputData()           */
+#define TPS_PROFILE_UPDATE_OUTPUT     4   /* TPS_UpdateOutputData()          */
+#define TPS_PROFILE_READ_RECORD       5   /* read record event + callback    */
+#define TPS_PROFILE_WRITE_RECORD      6   /* write record event + callback   */
+#define TPS_PROFILE_ALARM_ACK         7   /* alarm ack event + callback      */
+#define TPS_PROFILE_NUMBER_OF_POINTS  8
+
+#ifdef TPS_PROFILING
+
+/*! Statistics of one measuring point. The mean value is
+ *  qwTotalCycles / dwCount, see TPS_ProfileGetMeanCycles(). */
+typedef struct _T_TPS_PROFILE_ENTRY
+{
+    USIGN32      dwCount;        /*!< number of measured calls                */
+    USIGN32      dwMinCycles;    /*!< shortest call in CPU cycles             */
+    USIGN32      dwMaxCycles;    /*!< longest call in CPU cycles              */
+    USIGN32      dwTotalBytes;   /*!< transferred bytes of all calls          */
+    USIGN64      qwTotalCycles;  /*!< sum of all calls in CPU cycles          */
+}T_TPS_PROFILE_ENTRY;
+
+VOID      TPS_ProfileInit(VOID);
+VOID      TPS_ProfileReset(VOID);
+USIGN32   TPS_ProfileGetCycles(VOID);
+VOID      TPS_ProfileAdd(USIGN8 byPoint, USIGN32 dwStartCycles, USIGN32 dwBytes);
+USIGN32   TPS_ProfileGetEntry(USIGN8 byPoint, T_TPS_PROFILE_ENTRY* pzEntry);
+USIGN32   TPS_ProfileGetMeanCycles(const T_TPS_PROFILE_ENTRY* pzEntry);
+VOID      TPS_ProfileDump(VOID);
+#ifdef TPS_PROFILE_HOST_BUILD
+VOID      TPS_ProfileSetCycleSource(USIGN32 (*pfnGetCycles)(VOID));
+#endif
+
+/* TPS_PROFILE_ENTER() declares the start variable and must be the last     */
+/* declaration of the block.                                                 */
+/*---------------------------------------------------------------------------*/
+#define TPS_PROFILE_ENTER(dwStart)                    USIGN32 dwStart = TPS_ProfileGetCycles()
+#define TPS_PROFILE_LEAVE(byPoint, dwStart, dwBytes)  TPS_ProfileAdd((byPoint), (dwStart), (dwBytes))
+
+#else
+
+#define TPS_PROFILE_ENTER(dwStart)
+#define TPS_PROFILE_LEAVE(byPoint, dwStart, dwBytes)
+
+#endif /* TPS_PROFILING */
+
+#endif /* #ifndef _TPS_PROFILE_H_ */
@@ -74,6 +74,10 @@
 /* #define USE_FULL_ASSERT    1U */
 
 /* USER CODE BEGIN Private defines */
+/* Host interrupt line of the TPS-1 (low active), used with TPS_EVENT_IRQ_MODE */
+#define TPS_HOST_IRQ_Pin GPIO_PIN_0
+#define TPS_HOST_IRQ_GPIO_Port GPIOB
+#define TPS_HOST_IRQ_EXTI_IRQn EXTI0_IRQn
 int StartTPS1 (void);
 void ResetTPS1(void);
 /* USER CODE END Private defines */
@@ -34,16 +34,15 @@
 /*===========================================================================*/
 #include <TPS_1_API.h>
 #include "main.h"
+#ifndef TPS_HOST_SIMULATION
 #include "stm32f1xx_hal.h"
+#else
+#include <TPS_1_Sim.h>
+#endif
 
 #ifndef USE_INT_APP
 //    #include <low_level_initialization.h>
 #endif
-/* Write buffer incluxsive the comannd!                                      */
-/*---------------------------------------------------------------------------*/
-#ifdef SPI_INTERFACE
-static USIGN8 g_byMEMDirect[MAX_BUFFER_LEN_SPI_DATA];
-#endif
 
 #if !defined(PARALLEL_INTERFACE) && !defined(SPI_INTERFACE)
 #error Please define TPS access mode: PARALLEL_INTERFACE or SPI_INTERFACE.
@@ -65,13 +64,84 @@ static USIGN32 locCalculate4kPageAddress(USIGN8* pbyAddress, USIGN8** ppbyCorrec
 #define ADDRESS_MASK     0x0FFF
 #endif
 
-/* Transmit and receive buffer for TPS_ReadData() and TPS_WriteData()        */
+#ifndef TPS_HOST_SIMULATION
+extern SPI_HandleTypeDef hspi1;
+#endif
+
+/* DMA transport for SPI1. The handles are linked to hspi1 and serviced by   */
+/* the DMA1 channel 2/3 interrupt handlers in stm32f1xx_it.c. In the host    */
+/* simulation the DMA model of TPS_1_Sim.c does the transfers.               */
+/*---------------------------------------------------------------------------*/
+#ifdef SPI_DMA_TRANSFER
+#define SPI_DMA_STATE_IDLE   0x00
+#define SPI_DMA_STATE_BUSY   0x01
+#define SPI_DMA_STATE_ERROR  0x02
+
+#ifndef TPS_HOST_SIMULATION
+DMA_HandleTypeDef hdma_spi1_rx;
+DMA_HandleTypeDef hdma_spi1_tx;
+#endif
+
+static volatile USIGN8 g_bySpiDmaState = SPI_DMA_STATE_IDLE;
+
+static USIGN32 locSPI_DmaTransfer(USIGN8* pbyCommand, const USIGN8* pbyTxData, USIGN8 byFill,
+                                  USIGN8* pbyRxData, USIGN32 dwDataLength);
+#endif
+
+/* Set by TPS_ConfigImageReplay() while configDevice() is checked against    */
+/* the loaded configuration image, the accessors call the filters of         */
+/* TPS_1_API.c only then.                                                    */
+/*---------------------------------------------------------------------------*/
+#ifdef USE_CONFIG_IMAGE
+static BOOL g_bConfigImageReplay = TPS_FALSE;
+#endif
+
+/* SPI timing per board. All delays are given in __nop() cycles.             */
 /*---------------------------------------------------------------------------*/
 #ifdef SPI_INTERFACE
-static USIGN8 g_byRxTxBuffer[MAX_BUFFER_LEN_SPI_DATA];
+typedef struct _SPI_BOARD_TIMING_T
+{
+    USIGN8 bySetupDelay;      /* HOST_SFRN low until first SCK edge          */
+    USIGN8 byBurstByteDelay;  /* between two bytes inside a burst            */
+    USIGN8 byFrameGapDelay;   /* HOST_SFRN high until next assertion         */
+}SPI_BOARD_TIMING_T;
+
+static const SPI_BOARD_TIMING_T g_zSpiBoardTiming[SPI_NUMBER_OF_BOARDS] =
+{
+    /* SPI_BOARD_STM32F103_TPS1 */ { 0, 0, 4 },
+    /* SPI_BOARD_LONG_WIRING    */ { 4, 2, 8 }
+};
+
+#define SPI_DELAY(byNops)   { USIGN8 byDelayCnt; for(byDelayCnt = 0; byDelayCnt < (byNops); byDelayCnt++){ __nop(); } }
+#ifdef TPS_HOST_SIMULATION
+#define SPI_EXCHANGE(byTx, byRx)  { (byRx) = TPS_SimSpiByte(byTx); }
+#else
+#define SPI_EXCHANGE(byTx, byRx)  { hspi1.Instance->DR = (byTx); while(!__HAL_SPI_GET_FLAG(&hspi1, SPI_FLAG_RXNE)){ } (byRx) = hspi1.Instance->DR; }
 #endif
+#define SPI_BENCHMARK_RUNS  16
 
-extern SPI_HandleTypeDef hspi1;
+#ifdef SPI_BURST_FRAMING
+static USIGN8 g_bySpiFraming = SPI_FRAMING_BURST;
+#else
+static USIGN8 g_bySpiFraming = SPI_FRAMING_PER_BYTE;
+#endif
+
+/* Block commands (TPS_SetValueData(), TPS_GetValueData(), TPS_MemSet())     */
+/* send the command header and stream the data directly from/to the buffer   */
+/* of the caller, no staging buffer is used.                                 */
+/*---------------------------------------------------------------------------*/
+#define SPI_CMD_MEM_WRITE   0x40
+#define SPI_CMD_MEM_READ    0x80
+
+static VOID    locSPI_PolledBytes(const USIGN8* pbyTxData, USIGN8 byFill, USIGN8* pbyRxData, USIGN32 dwLength);
+static USIGN32 locSPI_PolledTransfer(USIGN8* pbyTxBuffer, USIGN8* pbyRxBuffer, USIGN32 dwBufferLength);
+static USIGN32 locSPI_PolledBlock(USIGN8* pbyCommand, const USIGN8* pbyTxData, USIGN8 byFill,
+                                  USIGN8* pbyRxData, USIGN32 dwDataLength);
+static USIGN32 locSPI_BlockTransfer(USIGN8 byCommand, USIGN8* pbyMemory, const USIGN8* pbyTxData,
+                                    USIGN8 byFill, USIGN8* pbyRxData, USIGN32 dwDataLength);
+static USIGN32 locSPI_ReadData(USIGN8* pbyReadBuffer, USIGN32 dwBufferLength);
+static USIGN32 locSPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength);
+#endif
 
 /*****************************************************************************
 **
@@ -93,6 +163,15 @@ extern SPI_HandleTypeDef hspi1;
 */
 USIGN32 TPS_SetValue8(USIGN8* pbyMemory, USIGN8 byValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the write is already done.        */
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageWriteFilter(pbyMemory, &byValue, 0x00, 1) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
     USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -163,6 +242,15 @@ USIGN32 TPS_SetValue8(USIGN8* pbyMemory, USIGN8 byValue)
 */
 USIGN32 TPS_SetValue16(USIGN8* pbyMemory, USIGN16 wValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the write is already done.        */
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageWriteFilter(pbyMemory, (USIGN8*)&wValue, 0x00, 2) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
     USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -238,6 +326,15 @@ USIGN32 TPS_SetValue16(USIGN8* pbyMemory, USIGN16 wValue)
 */
 USIGN32 TPS_SetValue32(USIGN8* pbyMemory, USIGN32 dwValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the write is already done.        */
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageWriteFilter(pbyMemory, (USIGN8*)&dwValue, 0x00, 4) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
     USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -311,6 +408,15 @@ USIGN32 TPS_SetValue32(USIGN8* pbyMemory, USIGN32 dwValue)
 */
 USIGN32 TPS_SetValueData(USIGN8* pbyMemory, USIGN8* pbySourceMemory, USIGN32 dwBufferLength)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the write is already done.        */
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageWriteFilter(pbyMemory, pbySourceMemory, 0x00, dwBufferLength) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
     USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -324,8 +430,6 @@ USIGN32 TPS_SetValueData(USIGN8* pbyMemory, USIGN8* pbySourceMemory, USIGN32 dwB
 
 #ifdef SPI_INTERFACE
     USIGN32 dwErrorCode = TPS_ACTION_OK;
-    USIGN8 *pbyBufferLen = NULL;
-    USIGN8 byPointer[4]  = { 0x00, 0x00, 0x00, 0x00 };
 #endif
 
     /* If 0, no data to be transfered!                                      */
@@ -346,34 +450,9 @@ USIGN32 TPS_SetValueData(USIGN8* pbyMemory, USIGN8* pbySourceMemory, USIGN32 dwB
 #endif
 
 #ifdef SPI_INTERFACE
-    /* Delete send-buffer.                                                  */
+    /* Send SPI write command, the data is sent out of the source buffer.   */
     /*----------------------------------------------------------------------*/
-    memset(&g_byMEMDirect[0], 0x00, MAX_BUFFER_LEN_SPI_DATA);
-
-    /* Set SPI Command (Write MEM!)                                         */
-    /*----------------------------------------------------------------------*/
-    g_byMEMDirect[0] = 0x40;
-
-    /* Extract the memory address and copy it to the Send Buffer!           */
-    /*----------------------------------------------------------------------*/
-    memcpy(&byPointer[0], &pbyMemory, 4);
-    g_byMEMDirect[1] = byPointer[0];
-    g_byMEMDirect[2] = byPointer[1];
-
-    /* Copy the data length                                                 */
-    /*----------------------------------------------------------------------*/
-    pbyBufferLen = (USIGN8*)&dwBufferLength;
-    g_byMEMDirect[3] = *pbyBufferLen;
-    pbyBufferLen++;
-    g_byMEMDirect[4] = *pbyBufferLen;
-
-    /* Copy Source Buffer into the "send buffer".                           */
-    /*----------------------------------------------------------------------*/
-    memcpy(&g_byMEMDirect[CMD_MEM_LEN], pbySourceMemory, dwBufferLength);
-
-    /* Send SPI write command (Buffer length + command length)              */
-    /*----------------------------------------------------------------------*/
-    dwErrorCode = TPS_SPI_WriteData(g_byMEMDirect, dwBufferLength + CMD_MEM_LEN);
+    dwErrorCode = locSPI_BlockTransfer(SPI_CMD_MEM_WRITE, pbyMemory, pbySourceMemory, 0x00, NULL, dwBufferLength);
     if (dwErrorCode != TPS_ACTION_OK)
     {
         return (SPI_INTERFACE_WRITE_FAULT);
@@ -404,6 +483,15 @@ USIGN32 TPS_SetValueData(USIGN8* pbyMemory, USIGN8* pbySourceMemory, USIGN32 dwB
 */
 USIGN32 TPS_GetValue8(USIGN8 *pbyMemory, USIGN8 *pbyValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the value is taken from the image.*/
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageReadFilter(pbyMemory, pbyValue, 1) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
     USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -468,6 +556,15 @@ USIGN32 TPS_GetValue8(USIGN8 *pbyMemory, USIGN8 *pbyValue)
 */
 USIGN32 TPS_GetValue16(USIGN8* pbyMemory, USIGN16* pwValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the value is taken from the image.*/
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageReadFilter(pbyMemory, (USIGN8*)pwValue, 2) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_INT_APP
     *pwValue = ((U16P*)(pbyMemory))->value;
     return TPS_ACTION_OK ;
@@ -538,6 +635,15 @@ USIGN32 TPS_GetValue16(USIGN8* pbyMemory, USIGN16* pwValue)
 */
 USIGN32 TPS_GetValue32(USIGN8* pbyMemory, USIGN32* pdwValue)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the value is taken from the image.*/
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageReadFilter(pbyMemory, (USIGN8*)pdwValue, 4) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_INT_APP
     *pdwValue = ((U32P*)(pbyMemory))->value;
     return(TPS_ACTION_OK);
@@ -685,6 +791,15 @@ USIGN32 TPS_GetIOAddress(USIGN8* pbyMemory, USIGN8** pdwValue)
 */
 USIGN32 TPS_GetValueData(USIGN8* pbyMemory, USIGN8* pbyDestMemory, USIGN32 dwBufferLength)
 {
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the value is taken from the image.*/
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageReadFilter(pbyMemory, pbyDestMemory, dwBufferLength) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
+
 #ifdef USE_4KB_PAGES
   /* Calculate the correct address if 4 kB Pages are used. */
   USIGN32 dwErrorCode = TPS_ACTION_OK;
@@ -697,7 +812,6 @@ USIGN32 TPS_GetValueData(USIGN8* pbyMemory, USIGN8* pbyDestMemory, USIGN32 dwBuf
 #endif
 
 #ifdef SPI_INTERFACE
-  USIGN8 byPointer[4] = { 0x00, 0x00, 0x00, 0x00 };
   USIGN32 dwErrorCode = TPS_ACTION_OK;
 #endif
 
@@ -723,37 +837,222 @@ USIGN32 TPS_GetValueData(USIGN8* pbyMemory, USIGN8* pbyDestMemory, USIGN32 dwBuf
 
 #ifdef SPI_INTERFACE
 
-  /* Initialize send buffer.                                               */
+  /* Send read command, the data is received into the destination buffer.  */
   /*-----------------------------------------------------------------------*/
-  memset(&g_byMEMDirect[0], 0x00, MAX_BUFFER_LEN_SPI_DATA);
-  g_byMEMDirect[0] = 0x80;              /* MEM_READ command.               */
-
-  /* Extract the memory address!                                     -     */
-  /*-----------------------------------------------------------------------*/
-  memcpy(&byPointer[0], &pbyMemory, 4);
-  g_byMEMDirect[1] = byPointer[0];
-  g_byMEMDirect[2] = byPointer[1];
-  /* Copy the data length                                                  */
-  /*-----------------------------------------------------------------------*/
-  g_byMEMDirect[3] =(USIGN8)(dwBufferLength & 0xFF);
-  g_byMEMDirect[4] =(USIGN8)(dwBufferLength >> 0x08);
-
-  /* Send read command!                                                    */
-  /*-----------------------------------------------------------------------*/
-  dwErrorCode = TPS_SPI_ReadData(g_byMEMDirect, dwBufferLength + CMD_MEM_LEN);
+  dwErrorCode = locSPI_BlockTransfer(SPI_CMD_MEM_READ, pbyMemory, NULL, 0x00, pbyDestMemory, dwBufferLength);
   if ( dwErrorCode != TPS_ACTION_OK)
   {
     return (dwErrorCode);
   }
-  /* Copy value into the variable!                                         */
-  /*-----------------------------------------------------------------------*/
-  memcpy(pbyDestMemory, &g_byMEMDirect[CMD_MEM_LEN], dwBufferLength);
 #endif
 
   return(TPS_ACTION_OK);
 }
 
 #ifdef SPI_INTERFACE
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_PolledBytes()
+**
+** DESCRIPTION:   Clocks dwLength bytes by polling the SPI data register.
+**                The bytes are sent out of pbyTxData or, if pbyTxData is
+**                NULL, byFill is sent. The received bytes are stored in
+**                pbyRxData or discarded if pbyRxData is NULL.
+**                With SPI_FRAMING_PER_BYTE HOST_SFRN is toggled around every
+**                byte, with SPI_FRAMING_BURST the caller holds HOST_SFRN.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     const USIGN8* pbyTxData
+**                USIGN8  byFill
+**                USIGN8* pbyRxData
+**                USIGN32 dwLength
+**
+*******************************************************************************
+*/
+static VOID locSPI_PolledBytes(const USIGN8* pbyTxData, USIGN8 byFill, USIGN8* pbyRxData, USIGN32 dwLength)
+{
+    USIGN32 idx;
+    USIGN8  byRxValue;
+    const SPI_BOARD_TIMING_T* pzTiming = &g_zSpiBoardTiming[SPI_BOARD_TIMING];
+
+    if (g_bySpiFraming == SPI_FRAMING_BURST)
+    {
+        for(idx = 0 ; idx < dwLength ; idx ++)
+        {
+            SPI_EXCHANGE((pbyTxData != NULL) ? pbyTxData[idx] : byFill, byRxValue);
+            if (pbyRxData != NULL)
+            {
+                pbyRxData[idx] = byRxValue;
+            }
+            SPI_DELAY(pzTiming->byBurstByteDelay);
+        }
+    }
+    else
+    {
+        for(idx = 0 ; idx < dwLength ; idx ++)
+        {
+            HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_RESET);
+            SPI_DELAY(pzTiming->bySetupDelay);
+            SPI_EXCHANGE((pbyTxData != NULL) ? pbyTxData[idx] : byFill, byRxValue);
+            if (pbyRxData != NULL)
+            {
+                pbyRxData[idx] = byRxValue;
+            }
+            HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_SET);
+            SPI_DELAY(pzTiming->byFrameGapDelay);
+        }
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_PolledTransfer()
+**
+** DESCRIPTION:   Sends pbyTxBuffer and receives into pbyRxBuffer by polling
+**                the SPI data register. Depending on the selected framing
+**                HOST_SFRN is toggled around every byte or held low for the
+**                whole command. The delays are taken from the timing table.
+**                pbyTxBuffer and pbyRxBuffer may be the same buffer,
+**                pbyRxBuffer may be NULL to discard the received bytes.
+**                In the host simulation the TPS-1 model answers instead.
+**
+** RETURN:        TPS_ACTION_OK
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8* pbyTxBuffer
+**                USIGN8* pbyRxBuffer
+**                USIGN32 dwBufferLength
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_PolledTransfer(USIGN8* pbyTxBuffer, USIGN8* pbyRxBuffer, USIGN32 dwBufferLength)
+{
+    return locSPI_PolledBlock(NULL, pbyTxBuffer, 0x00, pbyRxBuffer, dwBufferLength);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_PolledBlock()
+**
+** DESCRIPTION:   Polled transfer of a block command: the CMD_MEM_LEN bytes
+**                of pbyCommand are sent first, then dwDataLength bytes are
+**                streamed in the same frame, see locSPI_PolledBytes().
+**                Without pbyCommand only the data is transferred.
+**
+** RETURN:        TPS_ACTION_OK
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8* pbyCommand
+**                const USIGN8* pbyTxData
+**                USIGN8  byFill
+**                USIGN8* pbyRxData
+**                USIGN32 dwDataLength
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_PolledBlock(USIGN8* pbyCommand, const USIGN8* pbyTxData, USIGN8 byFill,
+                                  USIGN8* pbyRxData, USIGN32 dwDataLength)
+{
+    const SPI_BOARD_TIMING_T* pzTiming = &g_zSpiBoardTiming[SPI_BOARD_TIMING];
+
+    if (g_bySpiFraming == SPI_FRAMING_BURST)
+    {
+        HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_RESET);
+        SPI_DELAY(pzTiming->bySetupDelay);
+    }
+
+    if (pbyCommand != NULL)
+    {
+        locSPI_PolledBytes(pbyCommand, 0x00, NULL, CMD_MEM_LEN);
+    }
+    locSPI_PolledBytes(pbyTxData, byFill, pbyRxData, dwDataLength);
+
+    if (g_bySpiFraming == SPI_FRAMING_BURST)
+    {
+        HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_SET);
+        SPI_DELAY(pzTiming->byFrameGapDelay);
+    }
+
+    return(TPS_ACTION_OK);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_BlockTransfer()
+**
+** DESCRIPTION:   Block read or write of dwDataLength bytes at pbyMemory.
+**                The command header is built on the stack, the data is
+**                streamed directly from pbyTxData (write; byFill is sent if
+**                pbyTxData is NULL) or into pbyRxData (read; the data is
+**                discarded if pbyRxData is NULL). The transfer is profiled
+**                like TPS_SPI_ReadData() / TPS_SPI_WriteData().
+**
+** RETURN:        TPS_ACTION_OK
+**                ErrorCode        SPI_INTERFACE_READ_FAULT
+**                                 SPI_INTERFACE_READ_PARAM_FAULT
+**                                 SPI_INTERFACE_WRITE_FAULT
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8  byCommand (SPI_CMD_MEM_WRITE, SPI_CMD_MEM_READ)
+**                USIGN8* pbyMemory (pointer into the DPRAM)
+**                const USIGN8* pbyTxData
+**                USIGN8  byFill
+**                USIGN8* pbyRxData
+**                USIGN32 dwDataLength
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_BlockTransfer(USIGN8 byCommand, USIGN8* pbyMemory, const USIGN8* pbyTxData,
+                                    USIGN8 byFill, USIGN8* pbyRxData, USIGN32 dwDataLength)
+{
+    USIGN8  byHeader[CMD_MEM_LEN];
+    USIGN8  byPointer[4] = { 0x00, 0x00, 0x00, 0x00 };
+    USIGN32 dwRetval;
+    USIGN32 dwFault = (byCommand == SPI_CMD_MEM_READ) ? SPI_INTERFACE_READ_FAULT : SPI_INTERFACE_WRITE_FAULT;
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    if ( (dwDataLength == 0) || (dwDataLength > (MAX_BUFFER_LEN_SPI_DATA - CMD_MEM_LEN)) )
+    {
+        return (byCommand == SPI_CMD_MEM_READ) ? SPI_INTERFACE_READ_PARAM_FAULT : SPI_INTERFACE_WRITE_FAULT;
+    }
+
+    /* Command, address and data length.                                    */
+    /*----------------------------------------------------------------------*/
+    memcpy(&byPointer[0], &pbyMemory, 4);
+    byHeader[0] = byCommand;
+    byHeader[1] = byPointer[0];
+    byHeader[2] = byPointer[1];
+    byHeader[3] = (USIGN8)(dwDataLength & 0xFF);
+    byHeader[4] = (USIGN8)(dwDataLength >> 0x08);
+
+#ifdef SPI_DMA_TRANSFER
+    if ((g_bySpiFraming == SPI_FRAMING_BURST) &&
+        ((dwDataLength + CMD_MEM_LEN) >= SPI_DMA_MIN_TRANSFER_LEN))
+    {
+        dwRetval = locSPI_DmaTransfer(byHeader, pbyTxData, byFill, pbyRxData, dwDataLength);
+    }
+    else
+#endif
+    {
+        dwRetval = locSPI_PolledBlock(byHeader, pbyTxData, byFill, pbyRxData, dwDataLength);
+    }
+
+    if (byCommand == SPI_CMD_MEM_READ)
+    {
+        TPS_PROFILE_LEAVE(TPS_PROFILE_SPI_READ, dwProfileStart, dwDataLength + CMD_MEM_LEN);
+    }
+    else
+    {
+        TPS_PROFILE_LEAVE(TPS_PROFILE_SPI_WRITE, dwProfileStart, dwDataLength + CMD_MEM_LEN);
+    }
+
+    return (dwRetval == TPS_ACTION_OK) ? TPS_ACTION_OK : dwFault;
+}
+
 /*****************************************************************************
 **
 ** FUNCTION NAME: TPS_SPI_ReadData()
@@ -776,9 +1075,59 @@ USIGN32 TPS_GetValueData(USIGN8* pbyMemory, USIGN8* pbyDestMemory, USIGN32 dwBuf
 */
 USIGN32 TPS_SPI_ReadData(USIGN8* pbyReadBuffer, USIGN32 dwBufferLength)
 {
-    USIGN32 idx;
-    HAL_StatusTypeDef dwErrorCode = HAL_OK;
+    USIGN32 dwRetval;
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    dwRetval = locSPI_ReadData(pbyReadBuffer, dwBufferLength);
+
+    TPS_PROFILE_LEAVE(TPS_PROFILE_SPI_READ, dwProfileStart, dwBufferLength);
+
+    return dwRetval;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SPI_WriteData()
+**
+** DESCRIPTION:   This function writes data into the DPRAM.
+**
+** RETURN:        TPS_ACTION_OK
+**                ErrorCode        SPI_INTERFACE_WRITE_FAULT
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8* pWriteBuffer
+**                USIGN32 dwBufferLength
+**
+** This function is CPU dependent!
+**
+*******************************************************************************
+*/
+USIGN32 TPS_SPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength)
+{
+    USIGN32 dwRetval;
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    dwRetval = locSPI_WriteData(pbyWriteBuffer, dwBufferLength);
 
+    TPS_PROFILE_LEAVE(TPS_PROFILE_SPI_WRITE, dwProfileStart, dwBufferLength);
+
+    return dwRetval;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_ReadData()
+**
+** DESCRIPTION:   Transfer of TPS_SPI_ReadData(). The received data
+**                overwrites the command in pbyReadBuffer.
+**
+** Return_Type:   USIGN32
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_ReadData(USIGN8* pbyReadBuffer, USIGN32 dwBufferLength)
+{
     /* Check length of data buffer. If 0, no data to be transfered!          */
     /*-----------------------------------------------------------------------*/
     if( (dwBufferLength == 0) || (dwBufferLength > MAX_BUFFER_LEN_SPI_DATA) )
@@ -786,101 +1135,424 @@ USIGN32 TPS_SPI_ReadData(USIGN8* pbyReadBuffer, USIGN32 dwBufferLength)
         return (SPI_INTERFACE_READ_PARAM_FAULT);
     }
 
-    /* Clear buffer                                                          */
+#ifdef SPI_DMA_TRANSFER
+    /* Large burst transfers are done by DMA, the received data overwrites   */
+    /* the send buffer in place.                                             */
+    /*-----------------------------------------------------------------------*/
+    if ((g_bySpiFraming == SPI_FRAMING_BURST) &&
+        (dwBufferLength >= SPI_DMA_MIN_TRANSFER_LEN))
+    {
+        if (locSPI_DmaTransfer(NULL, pbyReadBuffer, 0x00, pbyReadBuffer, dwBufferLength) != TPS_ACTION_OK)
+        {
+            return (SPI_INTERFACE_READ_FAULT);
+        }
+        return(TPS_ACTION_OK);
+    }
+#endif
+
+    /* The received data overwrites the send buffer.                         */
     /*-----------------------------------------------------------------------*/
-    //memset(g_byRxTxBuffer, 0x00, dwBufferLength);
+    return locSPI_PolledTransfer(pbyReadBuffer, pbyReadBuffer, dwBufferLength);
+}
 
-    /* send buffer, buffer length, receive buffer                            */
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_WriteData()
+**
+** DESCRIPTION:   Transfer of TPS_SPI_WriteData(). The received bytes are
+**                discarded.
+**
+** Return_Type:   USIGN32
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength)
+{
+    /* If 0, no data to be transfered!                                       */
     /*-----------------------------------------------------------------------*/
-    //dwErrorCode = HAL_SPI_TransmitReceive(&hspi1,pbyReadBuffer,g_byRxTxBuffer,dwBufferLength,100);
-    for(idx = 0 ; idx < dwBufferLength ; idx ++)
+    if ( (dwBufferLength == 0) || (dwBufferLength > MAX_BUFFER_LEN_SPI_DATA) )
     {
-      HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_RESET);
-      hspi1.Instance->DR = pbyReadBuffer[idx];
-      while(1)
-      {
-        if(__HAL_SPI_GET_FLAG(&hspi1, SPI_FLAG_RXNE))break;
-      }
-      pbyReadBuffer[idx] = hspi1.Instance->DR;
-      HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_SET);
-      for(int delay_cnt = 0 ; delay_cnt < 4 ; delay_cnt ++){ __nop();}
+        return(SPI_INTERFACE_WRITE_FAULT);
     }
-    if ( dwErrorCode != HAL_OK )
+
+#ifdef SPI_DMA_TRANSFER
+    if ((g_bySpiFraming == SPI_FRAMING_BURST) &&
+        (dwBufferLength >= SPI_DMA_MIN_TRANSFER_LEN))
     {
-        return (SPI_INTERFACE_READ_FAULT);
+        if (locSPI_DmaTransfer(NULL, pbyWriteBuffer, 0x00, NULL, dwBufferLength) != TPS_ACTION_OK)
+        {
+            return(SPI_INTERFACE_WRITE_FAULT);
+        }
+        return(TPS_ACTION_OK);
     }
+#endif
 
-    //memcpy(pbyReadBuffer, g_byRxTxBuffer, dwBufferLength);
+    return locSPI_PolledTransfer(pbyWriteBuffer, NULL, dwBufferLength);
+}
 
-    return(dwErrorCode);
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SPI_SetFraming()
+**
+** DESCRIPTION:   Selects the chip select framing of the following TPS
+**                commands.
+**
+** RETURN:        TPS_ACTION_OK
+**                ErrorCode        SPI_INTERFACE_PARAM_FAULT
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8 byFraming (SPI_FRAMING_PER_BYTE, SPI_FRAMING_BURST)
+**
+*******************************************************************************
+*/
+USIGN32 TPS_SPI_SetFraming(USIGN8 byFraming)
+{
+    if ((byFraming != SPI_FRAMING_PER_BYTE) && (byFraming != SPI_FRAMING_BURST))
+    {
+        return (SPI_INTERFACE_PARAM_FAULT);
+    }
+
+    g_bySpiFraming = byFraming;
+
+    return(TPS_ACTION_OK);
 }
 
 /*****************************************************************************
 **
-** FUNCTION NAME: TPS_SPI_WriteData()
+** FUNCTION NAME: TPS_SPI_GetFraming()
 **
-** DESCRIPTION:   This function writes data into the DPRAM.
+** DESCRIPTION:   Returns the selected chip select framing.
+**
+** Return_Type:   USIGN8 (SPI_FRAMING_PER_BYTE, SPI_FRAMING_BURST)
+**
+*******************************************************************************
+*/
+USIGN8 TPS_SPI_GetFraming(VOID)
+{
+    return g_bySpiFraming;
+}
+
+#ifdef SPI_BENCHMARK
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SPI_Benchmark()
+**
+** DESCRIPTION:   Measures the throughput of block reads out of the NRT area
+**                with the DWT cycle counter and prints bytes/second for
+**                4, 64, 512 and 1522 byte transfers in both framing modes.
+**                The read data is discarded, so no receive buffer is needed.
+**                The selected framing is restored afterwards.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_SPI_Benchmark(VOID)
+{
+    static const USIGN16 wBenchLength[] = { 4, 64, 512, MAX_LEN_ETHERNET_FRAME };
+    USIGN8  byFramingSave = g_bySpiFraming;
+    USIGN8  byFraming;
+    USIGN32 dwLenIdx;
+    USIGN32 dwRun;
+    USIGN32 dwCycles;
+    USIGN32 dwStart;
+    USIGN32 dwBytesPerSec;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (byFraming = SPI_FRAMING_PER_BYTE; byFraming <= SPI_FRAMING_BURST; byFraming++)
+    {
+        g_bySpiFraming = byFraming;
+
+        for (dwLenIdx = 0; dwLenIdx < (sizeof(wBenchLength) / sizeof(wBenchLength[0])); dwLenIdx++)
+        {
+            dwCycles = 0;
+            for (dwRun = 0; dwRun < SPI_BENCHMARK_RUNS; dwRun++)
+            {
+                /* Block read of the NRT area header.                       */
+                /* The counter is not reset, it is shared with TPS_Profile.c */
+                /*-----------------------------------------------------------*/
+                dwStart = DWT->CYCCNT;
+                locSPI_BlockTransfer(SPI_CMD_MEM_READ, (USIGN8*)BASE_ADDRESS_NRT_AREA, NULL, 0x00, NULL, wBenchLength[dwLenIdx]);
+                dwCycles += DWT->CYCCNT - dwStart;
+            }
+            dwCycles /= SPI_BENCHMARK_RUNS;
+
+            dwBytesPerSec = (USIGN32)(((USIGN64)wBenchLength[dwLenIdx] * SystemCoreClock) / dwCycles);
+            printf("SPI %s %4lu bytes: %7lu cycles, %7lu bytes/s\r\n",
+                (byFraming == SPI_FRAMING_BURST) ? "burst   " : "per-byte",
+                (unsigned long)wBenchLength[dwLenIdx], (unsigned long)dwCycles, (unsigned long)dwBytesPerSec);
+        }
+    }
+
+    g_bySpiFraming = byFramingSave;
+}
+#endif /* SPI_BENCHMARK */
+
+#ifdef SPI_DMA_TRANSFER
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SPI_InitDma()
+**
+** DESCRIPTION:   Configures DMA1 channel 2 (SPI1_RX) and channel 3 (SPI1_TX)
+**                and links them to hspi1. Must be called after
+**                MX_SPI1_Init() and before the first DPRAM access.
 **
 ** RETURN:        TPS_ACTION_OK
-**                ErrorCode        SPI_INTERFACE_WRITE_FAULT
+**                ErrorCode        SPI_INTERFACE_PARAM_FAULT
 **
 ** Return_Type:   USIGN32
 **
-** PARAMETER:     USIGN8* pWriteBuffer
-**                USIGN32 dwBufferLength
+** PARAMETER:     VOID
 **
 ** This function is CPU dependent!
 **
 *******************************************************************************
 */
-USIGN32 TPS_SPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength)
+USIGN32 TPS_SPI_InitDma(VOID)
 {
-    USIGN32 idx;
-    HAL_StatusTypeDef dwErrorCode = HAL_OK;
+#ifndef TPS_HOST_SIMULATION
+    __HAL_RCC_DMA1_CLK_ENABLE();
 
-    /* If 0, no data to be transfered!                                       */
+    /* SPI1_RX: peripheral to memory                                         */
     /*-----------------------------------------------------------------------*/
-    if ( (dwBufferLength == 0) || (dwBufferLength > MAX_BUFFER_LEN_SPI_DATA) )
+    hdma_spi1_rx.Instance = DMA1_Channel2;
+    hdma_spi1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_spi1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_spi1_rx) != HAL_OK)
     {
-        return(SPI_INTERFACE_WRITE_FAULT);
+        return (SPI_INTERFACE_PARAM_FAULT);
     }
+    __HAL_LINKDMA(&hspi1, hdmarx, hdma_spi1_rx);
 
-    /* Initialize the receive Buffer                                        */
+    /* SPI1_TX: memory to peripheral                                         */
     /*-----------------------------------------------------------------------*/
-    memset(g_byRxTxBuffer, 0x00, dwBufferLength);
-    
-    for(idx = 0 ; idx < dwBufferLength ; idx ++)
-    {
-      HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_RESET);
-      hspi1.Instance->DR = pbyWriteBuffer[idx];
-      while(1)
-      {
-        if(__HAL_SPI_GET_FLAG(&hspi1, SPI_FLAG_RXNE))break;
-      }
-      g_byRxTxBuffer[idx] = hspi1.Instance->DR;
-      HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_SET);
-      for(int delay_cnt = 0 ; delay_cnt < 4 ; delay_cnt ++){ __nop();}
-    }
-
-    /* Start transmission!                                                   */
-    /*-----------------------------------------------------------------------*/
-    //dwErrorCode = HAL_SPI_TransmitReceive(&hspi1,pbyWriteBuffer, g_byRxTxBuffer,dwBufferLength,100);
-    if (dwErrorCode != HAL_OK)
+    hdma_spi1_tx.Instance = DMA1_Channel3;
+    hdma_spi1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_tx.Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(&hdma_spi1_tx) != HAL_OK)
     {
-       return(SPI_INTERFACE_WRITE_FAULT);
+        return (SPI_INTERFACE_PARAM_FAULT);
     }
+    __HAL_LINKDMA(&hspi1, hdmatx, hdma_spi1_tx);
+
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+#endif
+
+    g_bySpiDmaState = SPI_DMA_STATE_IDLE;
 
     return(TPS_ACTION_OK);
 }
 
+/*****************************************************************************
+**
+** FUNCTION NAME: locSPI_DmaTransfer()
+**
+** DESCRIPTION:   Sends pbyTxData and receives into pbyRxData by DMA.
+**                HOST_SFRN is held low for the whole command. If pbyCommand
+**                is given, its CMD_MEM_LEN bytes are sent by polling first.
+**                Without pbyTxData byFill is sent (the TX channel does not
+**                increment), without pbyRxData the received bytes are not
+**                stored (transmit only). The function returns when the SPI
+**                DMA complete interrupt has fired.
+**                pbyTxData and pbyRxData may be the same buffer: the RX
+**                channel never overtakes the TX channel.
+**                The transfer is blocking like the polled one: the core
+**                sleeps (__WFI) until the DMA interrupt and only runs other
+**                interrupt handlers meanwhile. The gain is the byte loop
+**                the CPU no longer executes, not overlap with the caller.
+**                In the host simulation the DMA model of TPS_1_Sim.c
+**                transfers the data at once.
+**
+** RETURN:        TPS_ACTION_OK
+**                ErrorCode        SPI_INTERFACE_READ_FAULT
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8* pbyCommand
+**                const USIGN8* pbyTxData
+**                USIGN8  byFill
+**                USIGN8* pbyRxData
+**                USIGN32 dwDataLength
+**
+*******************************************************************************
+*/
+static USIGN32 locSPI_DmaTransfer(USIGN8* pbyCommand, const USIGN8* pbyTxData, USIGN8 byFill,
+                                  USIGN8* pbyRxData, USIGN32 dwDataLength)
+{
+    USIGN32 dwErrorCode = TPS_ACTION_OK;
+    USIGN8* pbyTxSource = (USIGN8*)pbyTxData;
+#ifndef TPS_HOST_SIMULATION
+    USIGN32 dwStartTick = 0;
+    HAL_StatusTypeDef zStatus;
+#endif
+
+    g_bySpiDmaState = SPI_DMA_STATE_BUSY;
+
+    HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_RESET);
+
+    if (pbyCommand != NULL)
+    {
+        locSPI_PolledBytes(pbyCommand, 0x00, NULL, CMD_MEM_LEN);
+    }
+
+    /* Fill data: the TX channel sends byFill dwDataLength times.            */
+    /*-----------------------------------------------------------------------*/
+    if (pbyTxData == NULL)
+    {
+        pbyTxSource = &byFill;
+    }
+
+#ifdef TPS_HOST_SIMULATION
+    TPS_SimDmaTransfer(pbyTxSource, (pbyTxData != NULL) ? TPS_TRUE : TPS_FALSE, pbyRxData, dwDataLength);
+    g_bySpiDmaState = SPI_DMA_STATE_IDLE;
+#else
+    if (pbyTxData == NULL)
+    {
+        __HAL_DMA_DISABLE(&hdma_spi1_tx);
+        hdma_spi1_tx.Instance->CCR &= ~DMA_CCR_MINC;
+    }
+
+    if (pbyRxData == NULL)
+    {
+        zStatus = HAL_SPI_Transmit_DMA(&hspi1, pbyTxSource, (USIGN16)dwDataLength);
+    }
+    else
+    {
+        zStatus = HAL_SPI_TransmitReceive_DMA(&hspi1, pbyTxSource, pbyRxData, (USIGN16)dwDataLength);
+    }
+    if (zStatus != HAL_OK)
+    {
+        g_bySpiDmaState = SPI_DMA_STATE_ERROR;
+    }
+
+    /* Sleep until the transfer complete interrupt. The interrupts are     */
+    /* masked around the check, so a completion between the check and      */
+    /* __WFI() still wakes the core. The SysTick wakes it for the timeout.   */
+    /*-----------------------------------------------------------------------*/
+    dwStartTick = HAL_GetTick();
+    __disable_irq();
+    while (g_bySpiDmaState == SPI_DMA_STATE_BUSY)
+    {
+        __WFI();
+        __enable_irq();
+        if ((HAL_GetTick() - dwStartTick) > SPI_DMA_TIMEOUT_MS)
+        {
+            HAL_SPI_DMAStop(&hspi1);
+            g_bySpiDmaState = SPI_DMA_STATE_ERROR;
+        }
+        __disable_irq();
+    }
+    __enable_irq();
+
+    if (pbyTxData == NULL)
+    {
+        __HAL_DMA_DISABLE(&hdma_spi1_tx);
+        hdma_spi1_tx.Instance->CCR |= DMA_CCR_MINC;
+    }
+#endif
+
+    HAL_GPIO_WritePin(HOST_SFRN_GPIO_Port,HOST_SFRN_Pin,GPIO_PIN_SET);
+
+    if (g_bySpiDmaState != SPI_DMA_STATE_IDLE)
+    {
+        dwErrorCode = SPI_INTERFACE_READ_FAULT;
+    }
+    g_bySpiDmaState = SPI_DMA_STATE_IDLE;
+
+    return(dwErrorCode);
+}
+
+#ifndef TPS_HOST_SIMULATION
+/*****************************************************************************
+**
+** FUNCTION NAME: HAL_SPI_TxRxCpltCallback()
+**
+** DESCRIPTION:   Called by the HAL from the DMA interrupt when the DMA
+**                transfer of SPI1 has finished.
+**
+** Return_Type:   void
+**
+** PARAMETER:     SPI_HandleTypeDef* hspi
+**
+*******************************************************************************
+*/
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi)
+{
+    if (hspi->Instance == SPI1)
+    {
+        g_bySpiDmaState = SPI_DMA_STATE_IDLE;
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: HAL_SPI_TxCpltCallback()
+**
+** DESCRIPTION:   Called by the HAL from the DMA interrupt when a transmit
+**                only DMA transfer of SPI1 has finished.
+**
+** Return_Type:   void
+**
+** PARAMETER:     SPI_HandleTypeDef* hspi
+**
+*******************************************************************************
+*/
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi)
+{
+    if (hspi->Instance == SPI1)
+    {
+        g_bySpiDmaState = SPI_DMA_STATE_IDLE;
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: HAL_SPI_ErrorCallback()
+**
+** DESCRIPTION:   Called by the HAL from the DMA interrupt when the DMA
+**                transfer of SPI1 has failed.
+**
+** Return_Type:   void
+**
+** PARAMETER:     SPI_HandleTypeDef* hspi
+**
+*******************************************************************************
+*/
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi)
+{
+    if (hspi->Instance == SPI1)
+    {
+        g_bySpiDmaState = SPI_DMA_STATE_ERROR;
+    }
+}
+#endif /* TPS_HOST_SIMULATION */
+#endif /* SPI_DMA_TRANSFER */
+
 #endif
 /*****************************************************************************
 **
 ** FUNCTION NAME: TPS_MemSet()
 **
 ** DESCRIPTION:   Initialize memory with special values.
-**                This function uses no data buffer to save memory Space.
-**                If it is possible TPS_SetValueData() can also be used.
+**                The value is written with bursts of up to
+**                MAX_BUFFER_LEN_SPI_DATA - CMD_MEM_LEN bytes, the value is
+**                streamed after the command, so no data buffer is used.
 **
 ** RETURN:        TPS_ACTION_OK
 **
@@ -897,7 +1569,25 @@ USIGN32 TPS_SPI_WriteData(USIGN8* pbyWriteBuffer, USIGN32 dwBufferLength)
 USIGN32 TPS_MemSet(USIGN8* pbyTarget, USIGN8 byValue, USIGN16 wLength)
 {
     USIGN32 dwErrorCode = TPS_ACTION_OK;
-    USIGN16 wCount;
+#ifdef SPI_INTERFACE
+    USIGN16 wChunk;
+#endif
+
+    /* No data to be transfered!                                             */
+    /*-----------------------------------------------------------------------*/
+    if (wLength == 0)
+    {
+        return (SPI_INTERFACE_PARAM_FAULT);
+    }
+
+#ifdef USE_CONFIG_IMAGE
+    /* Replay of the configuration image: the write is already done.        */
+    if((g_bConfigImageReplay == TPS_TRUE) &&
+       (TPS_ConfigImageWriteFilter(pbyTarget, NULL, byValue, wLength) == TPS_TRUE))
+    {
+        return(TPS_ACTION_OK);
+    }
+#endif
 
 #ifdef USE_4KB_PAGES
     /* Calculate the correct address if 4 kB Pages are used. */
@@ -909,26 +1599,59 @@ USIGN32 TPS_MemSet(USIGN8* pbyTarget, USIGN8 byValue, USIGN16 wLength)
     }
 #endif
 
-    /* No data to be transfered!                                             */
-    /*-----------------------------------------------------------------------*/
-    if (wLength == 0)
-    {
-        return (SPI_INTERFACE_PARAM_FAULT);
-    }
+#ifdef PARALLEL_INTERFACE
+    pbyTarget += BASE_ADDRESS_OFFSET_DPRAM;
+    memset(pbyTarget, byValue, wLength);
+#endif
 
-    for(wCount = 0; wCount < wLength; wCount++)
+#ifdef SPI_INTERFACE
+    while(wLength > 0)
     {
-        dwErrorCode = TPS_SetValue8(pbyTarget, byValue);
+        wChunk = wLength;
+        if(wChunk > (MAX_BUFFER_LEN_SPI_DATA - CMD_MEM_LEN))
+        {
+            wChunk = MAX_BUFFER_LEN_SPI_DATA - CMD_MEM_LEN;
+        }
+
+        /* Write MEM command with address and length, data = byValue        */
+        /*-------------------------------------------------------------------*/
+        dwErrorCode = locSPI_BlockTransfer(SPI_CMD_MEM_WRITE, pbyTarget, NULL, byValue, NULL, wChunk);
         if (dwErrorCode != TPS_ACTION_OK)
         {
             return(SPI_INTERFACE_WRITE_FAULT);
         }
-        pbyTarget++;
+        pbyTarget += wChunk;
+        wLength -= wChunk;
     }
+#endif
 
     return(dwErrorCode);
 }
 
+#ifdef USE_CONFIG_IMAGE
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ConfigImageReplay()
+**
+** DESCRIPTION:   Switches the DPRAM accessors to the filters of the
+**                configuration image (TPS_ConfigImageWriteFilter(),
+**                TPS_ConfigImageReadFilter()). Called by TPS_1_API.c when
+**                the replay of a loaded image starts and ends.
+**
+** RETURN:        none
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     BOOL bReplay (TPS_TRUE while the image is replayed)
+**
+*******************************************************************************
+*/
+VOID TPS_ConfigImageReplay(BOOL bReplay)
+{
+    g_bConfigImageReplay = bReplay;
+}
+#endif
+
 
 #ifdef USE_4KB_PAGES
 /*****************************************************************************
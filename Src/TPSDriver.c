@@ -3,7 +3,11 @@
 /*---------------------------------------------------------------------------*/
 #include <TPS_1_API.h>
 #include "main.h"
+#ifndef TPS_HOST_SIMULATION
 #include "stm32f1xx_hal.h"
+#else
+#include <TPS_1_Sim.h>
+#endif
 /*---------------------------------------------------------------------------*/
 /* Defines                                                                   */
 /*---------------------------------------------------------------------------*/
@@ -12,6 +16,7 @@
 #define INIT_PARAMETER_SUBSTITUTE_CONFIG_SIZE 7
 #define EXAMPLE_RECORD_INDEX 1234
 #define SUBSTITUTE_CONFIG_RECORD_INDEX 0x0022
+#define RECORD_CHUNK_SIZE    32
 
 #define MODULE_ID1     0x02 /* ID of Module 1 */
 #define SUBMODULE_ID1  0x02 /* ID of Submodule 1 in Slot 1. */
@@ -19,6 +24,27 @@
 
 #define SAMPLE_ORDER_ID       "1234567" /* max. 20 byte */
 
+/* The alarms of the examples are queued if the alarm mailbox is busy.       */
+#ifdef USE_ALARM_QUEUE
+#define APP_SEND_ALARM        TPS_QueueAlarm
+#define APP_SEND_DIAG_ALARM   TPS_QueueDiagAlarm
+#else
+#define APP_SEND_ALARM        TPS_SendAlarm
+#define APP_SEND_DIAG_ALARM   TPS_SendDiagAlarm
+#endif
+
+/* The record buffers of the examples are taken from the buffer pool.        */
+#ifdef USE_BUFFER_POOL
+#define APP_BUFFER_ALLOC      TPS_BufferPoolAlloc
+#define APP_BUFFER_FREE       TPS_BufferPoolFree
+#else
+#define APP_BUFFER_ALLOC      malloc
+#define APP_BUFFER_FREE       free
+#endif
+
+/* The ethernet mirror only answers frames received on an ethernet port.     */
+#define MIRROR_PORT(dwPortNr) (((dwPortNr) == PORT_NR_1) || ((dwPortNr) == PORT_NR_2))
+
 /*---------------------------------------------------------------------------*/
 /* Global variables.                                                         */
 /*---------------------------------------------------------------------------*/
@@ -26,6 +52,27 @@
  * Used for the alarm or diagnosis example. */
 extern USIGN8 g_byDoContinue;
 
+#if (defined(TPS_PROFILING) || (defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM))) && \
+    !defined(TPS_HOST_SIMULATION)
+/* Debug UART, also used for the commands of the profiling and as source of */
+/* the streamed firmware update.                                            */
+extern UART_HandleTypeDef huart3;
+#define APP_DEBUG_COMMANDS
+#endif
+
+#if defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM) && !defined(TPS_HOST_SIMULATION)
+/* Receive ring of the debug UART during the streamed firmware update,      */
+/* filled by onFwUpdateUartIrq(). FW_UART_RING_SIZE is a power of two and   */
+/* holds the bytes received while a fragment is written to the TPS-1.       */
+#define FW_UART_RING_SIZE           256
+#define FW_UART_LENGTH_TIMEOUT_MS   10000
+
+static volatile USIGN8  g_byFwUartRing[FW_UART_RING_SIZE];
+static volatile USIGN16 g_wFwUartHead = 0;      /* written by the interrupt */
+static volatile USIGN16 g_wFwUartTail = 0;      /* written by the main loop */
+static volatile USIGN32 g_dwFwUartOverruns = 0;
+#endif
+
 #ifdef DIAGNOSIS_ENABLE
 /* Stores the information wether a diagnosis was added. */
 static USIGN8 g_bDiagnosisAdded = TPS_FALSE;
@@ -57,6 +104,35 @@ static T_IM4_DATA* g_pIM4_Data;
 #ifdef DIAGNOSIS_ENABLE
 static USIGN8 g_bAlarmAckReceived = TPS_FALSE;
 #endif
+
+#ifdef USE_RECORD_REGISTRY
+/* Value of the example parameter (EXAMPLE_RECORD_INDEX) of the submodules  */
+/* 1/1 and 1/2.                                                              */
+/*---------------------------------------------------------------------------*/
+static USIGN8 g_byExampleParameter[2][INIT_PARAMETER_EXAMPLE_SIZE] = {{0x12, 0x34}, {0x12, 0x34}};
+#endif
+
+#ifdef USE_CONFIG_IMAGE
+/* Configuration image of the previous start in the flash. The simulation   */
+/* has no flash, the image is kept in RAM. The area is only used if it is    */
+/* inside of the flash of the device (flash size register).                  */
+/* A new image is built in g_byConfigImageBuffer, the heap is too small.     */
+/*---------------------------------------------------------------------------*/
+#ifdef TPS_HOST_SIMULATION
+static USIGN8 g_byConfigImageFlash[CONFIG_IMAGE_MAX_SIZE];
+#define APP_CONFIG_IMAGE      g_byConfigImageFlash
+#define APP_CONFIG_IMAGE_IN_FLASH()   (TPS_TRUE)
+#else
+#define APP_CONFIG_IMAGE      ((const USIGN8*)CONFIG_IMAGE_FLASH_ADDRESS)
+#define APP_CONFIG_IMAGE_IN_FLASH()   ((CONFIG_IMAGE_FLASH_ADDRESS + CONFIG_IMAGE_MAX_SIZE) <= \
+                                       (FLASH_BASE + ((USIGN32)(*(__IO USIGN16*)FLASHSIZE_BASE) << 10)))
+
+#if (CONFIG_IMAGE_MAX_SIZE % FLASH_PAGE_SIZE) != 0
+#error CONFIG_IMAGE_MAX_SIZE has to be a multiple of the flash page size.
+#endif
+#endif
+static USIGN8 g_byConfigImageBuffer[CONFIG_IMAGE_MAX_SIZE];
+#endif
 /*---------------------------------------------------------------------------*/
 /* Functions                                                                 */
 /*---------------------------------------------------------------------------*/
@@ -67,10 +143,19 @@ VOID    onPrmEndReq(USIGN32 dwARNumber);
 VOID    onAbortReq(USIGN32 dwARNumber);
 VOID    onRecordReadReq(USIGN32 dwARNumber);
 VOID    onRecordWriteReq(USIGN32 dwARNumber);
+SIGN32  onRecordWriteChunk(USIGN8 byMBNumber, USIGN32 dwOffset, USIGN8* pbyChunk, USIGN32 dwLength, VOID* pParam);
+#ifdef USE_RECORD_REGISTRY
+SIGN32  onExampleRecordRead(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength);
+SIGN32  onExampleRecordWrite(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength);
+SIGN32  onEmptyRecordRead(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength);
+#endif
 USIGN32 onReadRecordDataObjectElement(T_RECORD_DATA_OBJECT_TYPE oObjectToRead, SUBSLOT* poSubslot,
                                    USIGN8* bIocs, USIGN8* bIops, USIGN8* pbyData, USIGN16 wDatalength, USIGN16* wSubstituteActiveFlag);
 VOID    onAlarmAck(USIGN16 wAlarmHandler, USIGN32 dwResponseMsg);
 VOID    onDiagAlarmAck(USIGN16 wAlarmHandler, USIGN32 dwResponseMsg);
+#if defined(TPS_HOST_SIMULATION) && defined(USE_ALARM_QUEUE)
+VOID    simQueueAlarms(USIGN32 dwARNumber);
+#endif
 VOID    onDcpSetStationName(VOID);
 VOID    onDcpSetIpSuite(USIGN32 dwMode);
 VOID    onDcpSignalReq(VOID);
@@ -84,6 +169,23 @@ VOID    onLedChanged(USIGN16 wLedState);
 VOID    checkSendAlarmButton(VOID);
 VOID    initImData(VOID);
 VOID    printHexData(USIGN8* pbyData, USIGN32 dwDataLength);
+#ifdef APP_DEBUG_COMMANDS
+VOID    checkDebugCommand(VOID);
+#endif
+#if defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM) && !defined(TPS_HOST_SIMULATION)
+USIGN32 updateFirmwareFromUart(VOID);
+VOID    onFwUpdateUartIrq(VOID);
+#endif
+#ifdef USE_CONFIG_IMAGE
+VOID    loadConfigImage(VOID);
+VOID    storeConfigImage(VOID);
+USIGN32 writeConfigImageToFlash(const USIGN8* pbyImage, USIGN32 dwImageLength);
+#endif
+USIGN32 configureDevice(VOID);
+#ifdef USE_STARTUP_SERVICE
+USIGN32 getTimeMs(VOID);
+VOID    waitForTps(VOID);
+#endif
 
 
 /*****************************************************************************
@@ -289,6 +391,19 @@ VOID registerCallbacks(VOID)
    TPS_RegisterRpcCallback(ONWRITERECORD_CB, &onRecordWriteReq);
    TPS_RegisterRpcCallback(ONRESET_CB, &onRebootTpsReq);
 
+#ifdef USE_RECORD_REGISTRY
+   /*----------------------------------------------------------------------*/
+   /*  Register the records of the application!                            */
+   /*  The example parameter is cached, it only changes by a record write. */
+   /*----------------------------------------------------------------------*/
+   TPS_RegisterRecordHandler(API_0, 1, 1, EXAMPLE_RECORD_INDEX, &onExampleRecordRead,
+                             &onExampleRecordWrite, INIT_PARAMETER_EXAMPLE_SIZE);
+   TPS_RegisterRecordHandler(API_0, 1, 2, EXAMPLE_RECORD_INDEX, &onExampleRecordRead,
+                             &onExampleRecordWrite, INIT_PARAMETER_EXAMPLE_SIZE);
+   TPS_RegisterRecordHandler(API_0, RECORD_REGISTRY_ANY, RECORD_REGISTRY_ANY, 0x8030,
+                             &onEmptyRecordRead, NULL, 0);
+#endif
+
    /*----------------------------------------------------------------------*/
    /*  Register Alarm callback function!                                   */
    /*----------------------------------------------------------------------*/
@@ -318,6 +433,20 @@ VOID registerCallbacks(VOID)
 #ifdef USE_ETHERNET_INTERFACE
    TPS_InitEthernetChannel();
    TPS_RegisterEthernetReceiveCallback(onEthPacketReceived);
+#if defined(USE_ETHERNET_MIRROR_APPLICATION) && defined(USE_ETHERNET_RX_FILTER)
+   {
+       /* The mirror only returns frames sent to the interface MAC on an    */
+       /* ethernet port, all others are released by the API after the      */
+       /* header read.                                                     */
+       T_ETH_RX_FILTER_RULE zRule = {0};
+
+       zRule.byMatch = ETH_RX_MATCH_OWN_MAC | ETH_RX_MATCH_PORT;
+       zRule.dwPortNumber = PORT_NR_1;
+       TPS_AddEthernetRxFilterRule(&zRule);
+       zRule.dwPortNumber = PORT_NR_2;
+       TPS_AddEthernetRxFilterRule(&zRule);
+   }
+#endif
 #endif
 
    TPS_RegisterLedStateCallback(&onLedChanged);
@@ -325,6 +454,129 @@ VOID registerCallbacks(VOID)
 }
 
 
+/*****************************************************************************
+**
+** FUNCTION NAME: configureDevice
+**
+** DESCRIPTION:   Configuration of the device after the start of the TPS-1
+**                stack: the benchmarks, TPS_InitApplicationInterface(),
+**                configDevice() (from the configuration image if possible)
+**                and the registration of the callbacks.
+**
+** RETURN:        TPS_ACTION_OK or the error of
+**                TPS_InitApplicationInterface() / configDevice()
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     no
+**
+*******************************************************************************
+*/
+USIGN32 configureDevice(VOID)
+{
+    USIGN32 dwResult = 0;
+
+#ifdef SPI_BENCHMARK
+    TPS_SPI_Benchmark();
+#endif
+
+#ifdef TPS_ACCESSOR_BENCHMARK
+    TPS_AccessorBenchmark();
+#endif
+
+    /*----------------------------------------------------------------------
+     * Initialize TPS-1 API
+     *----------------------------------------------------------------------*/
+    dwResult = TPS_InitApplicationInterface();
+
+    #ifdef DEBUG_MAIN
+    if (dwResult != TPS_ACTION_OK)
+    {
+        printf("DEBUG_API > API: TPS_InitApplicationInterface failed!\n!");
+    }
+    else
+    {
+        printf("DEBUG_API > API: TPS_InitApplicationInterface OK!\r\n");
+    }
+    #endif
+
+    if(TPS_ACTION_OK != dwResult)
+    {
+        return dwResult;
+    }
+
+    /*----------------------------------------------------------------------
+     *  Configure the modules and submodules of the device.
+     *----------------------------------------------------------------------*/
+#ifdef USE_CONFIG_IMAGE
+    loadConfigImage();
+#endif
+    dwResult = configDevice();
+    if(TPS_ACTION_OK != dwResult)
+    {
+        printf("ERROR: configDevice() returned: 0x%08X\n", dwResult);
+    }
+#ifdef USE_CONFIG_IMAGE
+    else
+    {
+        storeConfigImage();
+    }
+#endif
+
+    /*----------------------------------------------------------------------*/
+    /*  Register Callback functions!                                        */
+    /*----------------------------------------------------------------------*/
+    registerCallbacks();
+
+    return dwResult;
+}
+
+#ifdef USE_STARTUP_SERVICE
+/*****************************************************************************
+**
+** FUNCTION NAME: getTimeMs
+**
+** DESCRIPTION:   Time source of the startup state machine.
+**
+** RETURN:        system time in ms
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     no
+**
+*******************************************************************************
+*/
+USIGN32 getTimeMs(VOID)
+{
+    return (USIGN32)HAL_GetTick();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: waitForTps
+**
+** DESCRIPTION:   Idle time of the startup: the CPU sleeps until the next
+**                system tick or the host interrupt of the TPS-1.
+**
+** RETURN:        none
+**
+** Return_Type:   none
+**
+** PARAMETER:     no
+**
+*******************************************************************************
+*/
+VOID waitForTps(VOID)
+{
+#ifdef TPS_HOST_SIMULATION
+    HAL_Delay(1);
+#else
+    __WFI();
+#endif
+}
+#endif
+
+
 /*****************************************************************************
 **
 ** FUNCTION NAME: main
@@ -352,15 +604,50 @@ int StartTPS1 (void)
     USIGN16 wSubModuleNr = 0;
     //JM:__enable_interrupt();
 
+#ifdef TPS_PROFILING
+    TPS_ProfileInit();
+#endif
+
     /* All TPS-PN events are signalized by an interrupt. The interrupt 1
      * of the V850 processes it.
      *----------------------------------------------------------------------*/
     /* enableIODataInterrupt(); */
     
-    /* Check if the TPS Stack was started correctly by calling
-     * TPS_CheckStackStart() until successful                               */
     printf("Waiting for initialization of the TPS...\r\n");
     //ResetTPS1();
+#ifdef USE_STARTUP_SERVICE
+    /* The startup state machine polls the TPS-1 with a backoff, calls
+     * configureDevice() when the stack is up and finishes the hand shake
+     * of TPS_StartDevice(). The CPU sleeps between the polls.              */
+    TPS_StartupBegin(configureDevice, getTimeMs);
+    while((dwResult = TPS_StartupService()) == API_STARTUP_BUSY)
+    {
+        waitForTps();
+    }
+
+    if(dwResult == TPS_ERROR_STACK_VERSION_FAILED)
+    {
+        printf("ERROR: TPS Driver and TPS Firmware are not compatible!\n");
+        return -1;
+    }
+    else if(dwResult != TPS_ACTION_OK)
+    {
+        printf("ERROR: startup failed: 0x%08X\n", dwResult);
+        return -1;
+    }
+    else
+    {
+        T_STARTUP_TIMES zStartupTimes;
+
+        TPS_GetStartupTimes(&zStartupTimes);
+        printf("TPS started: stack %lu ms, config %lu ms, start %lu ms (%lu/%lu polls)\r\n",
+               (unsigned long)zStartupTimes.dwStackUpMs, (unsigned long)zStartupTimes.dwConfigWrittenMs,
+               (unsigned long)zStartupTimes.dwStartAckMs, (unsigned long)zStartupTimes.dwStackPolls,
+               (unsigned long)zStartupTimes.dwStartPolls);
+    }
+#else
+    /* Check if the TPS Stack was started correctly by calling
+     * TPS_CheckStackStart() until successful                               */
     do
     {
         dwResult = TPS_CheckStackStart();
@@ -375,35 +662,7 @@ int StartTPS1 (void)
 
     printf("TPS started\r\n");
 
-    /*----------------------------------------------------------------------
-     * Initialize TPS-1 API
-     *----------------------------------------------------------------------*/
-    dwResult = TPS_InitApplicationInterface();
-
-    #ifdef DEBUG_MAIN
-    if (dwResult != TPS_ACTION_OK)
-    {
-        printf("DEBUG_API > API: TPS_InitApplicationInterface failed!\n!");
-    }
-    else
-    {
-        printf("DEBUG_API > API: TPS_InitApplicationInterface OK!\r\n");
-    }
-    #endif
-
-    /*----------------------------------------------------------------------
-     *  Configure the modules and submodules of the device.
-     *----------------------------------------------------------------------*/
-    dwResult = configDevice();
-    if(TPS_ACTION_OK != dwResult)
-    {
-        printf("ERROR: configDevice() returned: 0x%08X\n", dwResult);
-    }
-
-    /*----------------------------------------------------------------------*/
-    /*  Register Callback functions!                                        */
-    /*----------------------------------------------------------------------*/
-    registerCallbacks();
+    configureDevice();
 
     /*----------------------------------------------------------------------
      * Call TPS_StartDevice() to finish device configuration. Multiple calls
@@ -415,6 +674,13 @@ int StartTPS1 (void)
         dwResult = TPS_StartDevice();
     }
     while(TPS_ACTION_OK != dwResult);
+#endif
+
+#if defined(TPS_EVENT_IRQ_MODE) && !defined(USE_STARTUP_SERVICE)
+    /* From now on the events are signalled by the host interrupt. The      */
+    /* startup state machine enables it as soon as the stack is up.         */
+    TPS_EnableEventIrq();
+#endif
 
     memset(&g_byIOData[0], 0x00, sizeof(g_byIOData));
     /* Get the TPS firmware version by using the internal record mailbox.
@@ -428,12 +694,31 @@ int StartTPS1 (void)
     /*----------------------------------------------------------------------*/
     while(1)
     {
+#ifdef TPS_HOST_SIMULATION
+        /* next step of the replay of the TPS-1 model */
+        TPS_SimIdle();
+#endif
+
         /* check if the hardware button was pressed */
         checkSendAlarmButton();
 
+#ifdef APP_DEBUG_COMMANDS
+        /* profiling table or firmware update on request of the debug UART */
+        checkDebugCommand();
+#endif
+
         /* Cyclic check for new events. If an event occured the previously
          * registered callback function for this event is called            */
+#ifdef TPS_EVENT_IRQ_MODE
+        TPS_DispatchEvents();
+#else
         TPS_CheckEvents();
+#endif
+
+#ifdef USE_STARTUP_SERVICE
+        /* records the time of the first AR, no access to the TPS-1 */
+        TPS_StartupService();
+#endif
 
         /* When an AR was established start reading output data
          * and mirror them as input data
@@ -445,6 +730,11 @@ int StartTPS1 (void)
                 /* update the output buffer to receive the latest output data */
                 TPS_UpdateOutputData(bActiveIOAR);
 
+#ifdef USE_IO_FRAME_IMAGE
+                /* read the whole output frame with one SPI transfer */
+                TPS_ReadOutputFrame(bActiveIOAR);
+#endif
+
                 /* Iterate over each configured submodule */
                 for( wSubModuleNr = 0; wSubModuleNr < 3; wSubModuleNr++)
                 {
@@ -465,14 +755,12 @@ int StartTPS1 (void)
                         break;
                     }
 
-                    TPS_GetValue16((USIGN8*)pzSubmodule->pt_used_in_cr, &wSubslotUsedInCr);
+                    /* get usage and IO data size of the current submodule */
+                    TPS_GetSubslotIoInfo(pzSubmodule, &wSubslotUsedInCr, &wSizeInputData, &wSizeOutputData);
 
                     /* if the current submodule is used and has input data */
                     if( (wSubslotUsedInCr & INPUT_USED) != SUBSLOT_NOT_USED)
                     {
-                        /* get IO data size of the current submodule */
-                        TPS_GetValue16((USIGN8*)(pzSubmodule->pt_size_output_data), &wSizeOutputData);
-                        TPS_GetValue16((USIGN8*)(pzSubmodule->pt_size_input_data), &wSizeInputData);
 
                         /* Read the output data out of the output buffer */
                         TPS_ReadOutputData(pzSubmodule, g_byIOData, wSizeOutputData, &byDataStatus);
@@ -502,12 +790,21 @@ int StartTPS1 (void)
                 /* When the data of each submodule were written into the input
                  * buffer, call TPS_UpdateInputData to send the input
                  * frame to the PLC */
+#ifdef USE_IO_FRAME_IMAGE
+                TPS_WriteInputFrame(bActiveIOAR);
+#endif
                 TPS_UpdateInputData(bActiveIOAR);
 
             } /* if TPS_GetArEstablished(bActiveIOAR) */
 
         } /* for bActiveIOAR < MAX_NUMBER_IOAR */
 
+#ifdef USE_ETHERNET_TX_QUEUE
+        /* Write queued ethernet frames between the IO data updates, at most
+         * ETH_TX_BUDGET_PER_CYCLE bytes per pass                            */
+        TPS_ServiceEthernetTxQueue(ETH_TX_BUDGET_PER_CYCLE);
+#endif
+
     } /* while (1) */
 }
 
@@ -608,8 +905,8 @@ VOID checkSendAlarmButton(VOID)
             {
                 wModuleRemoved = 1;
 
-                dwRetval = TPS_SendAlarm(AR_0, /* API */0x00, /* Slot */1, /* Subslot */0,
-                                         ALARM_LOW, PULL_ALARM, 0, NULL, 0x100, 0xABCD);
+                dwRetval = APP_SEND_ALARM(AR_0, /* API */0x00, /* Slot */1, /* Subslot */0,
+                                          ALARM_LOW, PULL_ALARM, 0, NULL, 0x100, 0xABCD);
 
                 if(dwRetval != TPS_ACTION_OK)
                 {
@@ -631,8 +928,8 @@ VOID checkSendAlarmButton(VOID)
 
             if(dwRetval == TPS_ACTION_OK)
             {
-                dwRetval = TPS_SendAlarm(AR_0, /* API */0x00, /* Slot */1, /* Subslot */1,
-                                         ALARM_LOW, PLUG_ALARM, 0, NULL, 0x100, 0xABCD);
+                dwRetval = APP_SEND_ALARM(AR_0, /* API */0x00, /* Slot */1, /* Subslot */1,
+                                          ALARM_LOW, PLUG_ALARM, 0, NULL, 0x100, 0xABCD);
                 if(dwRetval != TPS_ACTION_OK)
                 {
                     printf("  Error: Plug Alarm not sent!\n");
@@ -678,7 +975,7 @@ VOID checkSendAlarmButton(VOID)
             }
 
             /* Send the diagnosis alarm. */
-            dwRetval = TPS_SendDiagAlarm(0, 0, 1, 1, ALARM_LOW, APPEARS, g_dwDiagnosisHandle_11, 0x0000);
+            dwRetval = APP_SEND_DIAG_ALARM(0, 0, 1, 1, ALARM_LOW, APPEARS, g_dwDiagnosisHandle_11, 0x0000);
             if(dwRetval != TPS_ACTION_OK)
             {
                 printf("TPS_SendDiagAlarm Appears -> ERROR: %x\n", dwRetval);
@@ -687,7 +984,12 @@ VOID checkSendAlarmButton(VOID)
 
             g_bDiagnosisAdded = TPS_TRUE;
         }
+#ifdef USE_ALARM_QUEUE
+        /* The disappears alarm waits in the queue for the appears acknowledge. */
+        else
+#else
         else if(g_bAlarmAckReceived)
+#endif
         {
             /* Remove the previously added diagnosis entry. */
             printf("Removing the diagnosis entry from the slot...\n");
@@ -699,7 +1001,7 @@ VOID checkSendAlarmButton(VOID)
             }
 
             /* Send the disappears alarm. */
-            dwRetval = TPS_SendDiagAlarm(0, 0, 1, 1, ALARM_LOW, DISAPPEARS, g_dwDiagnosisHandle_11, 0x0000);
+            dwRetval = APP_SEND_DIAG_ALARM(0, 0, 1, 1, ALARM_LOW, DISAPPEARS, g_dwDiagnosisHandle_11, 0x0000);
             if(dwRetval != TPS_ACTION_OK)
 	        {
                 /* Error can be ignored, it is ok if there is no AR. */
@@ -1065,6 +1367,9 @@ VOID onRecordReadReq(USIGN32 dwARNumber)
         case 0xXXXX:
             break;  */
 
+#ifndef USE_RECORD_REGISTRY
+        /* With USE_RECORD_REGISTRY these records are registered, see       */
+        /* registerCallbacks().                                              */
         case EXAMPLE_RECORD_INDEX:
             /* The example startup parameter as defined in the GSDML. */
             dwDataLen = 0x02;
@@ -1076,6 +1381,7 @@ VOID onRecordReadReq(USIGN32 dwARNumber)
             /* The example startup parameter as defined in the GSDML. */
             dwDataLen = 0x00;
             break;    
+#endif
 
         default:
             dwDataLen = 0;
@@ -1245,7 +1551,8 @@ VOID onRecordWriteReq(USIGN32 dwMbNr)
     RECORD_BOX_INFO oMailBoxInfo;
     USIGN16 wErrorCode1 = 0x00;
     USIGN16 wErrorCode2 = 0x00;
-    USIGN8* byArrMailboxData = 0;
+    USIGN8  byChunk[RECORD_CHUNK_SIZE];
+    USIGN32 dwRetval = TPS_ACTION_OK;
 
     TPS_GetMailboxInfo(dwMbNr, &oMailBoxInfo);
 
@@ -1256,15 +1563,14 @@ VOID onRecordWriteReq(USIGN32 dwMbNr)
                oMailBoxInfo.wSubSlotNumber, oMailBoxInfo.wIndex, oMailBoxInfo.dwRecordDataLen);
     #endif
 
-    byArrMailboxData = malloc(oMailBoxInfo.dwRecordDataLen);
-
-    if(byArrMailboxData == NULL)
-    {
-        /*ERROR*/
-    }
-    else
+    /* The record data is passed in chunks to onRecordWriteChunk(), so no    */
+    /* buffer for the whole record is needed.                                */
+    dwRetval = TPS_ReadMailboxDataStream((USIGN8)dwMbNr, byChunk, sizeof(byChunk), &onRecordWriteChunk, &oMailBoxInfo);
+    if (dwRetval == API_READ_MB_RECORD_TOO_LONG)
     {
-        TPS_ReadMailboxData(dwMbNr, byArrMailboxData, oMailBoxInfo.dwRecordDataLen);
+        /* PNIORW-ErrorClass: Access, ErrorCode: Write Length Error */
+        TPS_RecordWriteDone(dwMbNr, 0xB1, 0);
+        return;
     }
 
     switch(oMailBoxInfo.wIndex)
@@ -1277,11 +1583,13 @@ VOID onRecordWriteReq(USIGN32 dwMbNr)
             then indicated to the registered IMData Callback function.*/
          break;
 
+#ifndef USE_RECORD_REGISTRY
         case EXAMPLE_RECORD_INDEX:
             /* The example startup parameter as defined in the GSDML. */
             wErrorCode1 = 0x00;
             wErrorCode2 = 0x00;
             break;
+#endif
 
        /* Add your own record indexes here*/
 
@@ -1292,9 +1600,118 @@ VOID onRecordWriteReq(USIGN32 dwMbNr)
     }
 
     TPS_RecordWriteDone(dwMbNr, wErrorCode1, wErrorCode2);
-    free(byArrMailboxData);
 }
 
+/*****************************************************************************
+**
+** FUNCTION NAME: onRecordWriteChunk()
+**
+** DESCRIPTION:   Gets the data of a record write request in chunks of
+**                RECORD_CHUNK_SIZE bytes, see TPS_ReadMailboxDataStream().
+**                Place here the code that parses the record data.
+**
+** RETURN:        0 to get the next chunk, negative to stop
+**
+** Return_Type:   SIGN32
+**
+** PARAMETER:     USIGN8 byMBNumber  mail box number
+**                USIGN32 dwOffset  offset of the chunk in the record
+**                USIGN8* pbyChunk  record data
+**                USIGN32 dwLength  length of the chunk
+**                VOID* pParam  RECORD_BOX_INFO of the request
+**
+*******************************************************************************
+*/
+SIGN32 onRecordWriteChunk(USIGN8 byMBNumber, USIGN32 dwOffset, USIGN8* pbyChunk, USIGN32 dwLength, VOID* pParam)
+{
+    #ifdef DEBUG_MAIN
+        printf("DEBUG_API > API: RecordWrite data (Index 0x%X) offset %lu: ",
+               ((RECORD_BOX_INFO*)pParam)->wIndex, (unsigned long)dwOffset);
+        printHexData(pbyChunk, dwLength);
+    #endif
+
+    return 0;
+}
+
+#ifdef USE_RECORD_REGISTRY
+/*****************************************************************************
+**
+** FUNCTION NAME: onExampleRecordRead()
+**
+** DESCRIPTION:   Read handler of the example parameter (EXAMPLE_RECORD_INDEX)
+**                of the submodules 1/1 and 1/2.
+**
+**                This function is registered with the function
+**                TPS_RegisterRecordHandler. The response is cached by the
+**                driver until the parameter is written.
+**
+** RETURN:        length of the response
+**
+** Return_Type:   SIGN32
+**
+** PARAMETER:     USIGN32 dwMbNr  mail box number
+**                const RECORD_BOX_INFO* pzRecord  request header
+**                USIGN8* pbyData  response buffer
+**                USIGN32 dwLength  size of the response buffer
+**
+*******************************************************************************
+*/
+SIGN32 onExampleRecordRead(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength)
+{
+    memcpy(pbyData, g_byExampleParameter[pzRecord->wSubSlotNumber - 1], INIT_PARAMETER_EXAMPLE_SIZE);
+
+    return INIT_PARAMETER_EXAMPLE_SIZE;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: onExampleRecordWrite()
+**
+** DESCRIPTION:   Write handler of the example parameter (EXAMPLE_RECORD_INDEX)
+**                of the submodules 1/1 and 1/2. Also receives the startup
+**                parameter as defined in the GSDML.
+**
+** RETURN:        0, RECORD_HANDLER_ACCESS_ERROR for a wrong length
+**
+** Return_Type:   SIGN32
+**
+** PARAMETER:     USIGN32 dwMbNr  mail box number
+**                const RECORD_BOX_INFO* pzRecord  request header
+**                USIGN8* pbyData  record data
+**                USIGN32 dwLength  length of the record data
+**
+*******************************************************************************
+*/
+SIGN32 onExampleRecordWrite(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength)
+{
+    if(dwLength != INIT_PARAMETER_EXAMPLE_SIZE)
+    {
+        return RECORD_HANDLER_ACCESS_ERROR;
+    }
+
+    memcpy(g_byExampleParameter[pzRecord->wSubSlotNumber - 1], pbyData, INIT_PARAMETER_EXAMPLE_SIZE);
+
+    return 0;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: onEmptyRecordRead()
+**
+** DESCRIPTION:   Read handler of records without data (index 0x8030).
+**
+** RETURN:        0
+**
+** Return_Type:   SIGN32
+**
+*******************************************************************************
+*/
+SIGN32 onEmptyRecordRead(USIGN32 dwMbNr, const RECORD_BOX_INFO* pzRecord, USIGN8* pbyData, USIGN32 dwLength)
+{
+    return 0;
+}
+#endif
+
 /*****************************************************************************
 **
 ** FUNCTION NAME: onAlarmAck()
@@ -1318,11 +1735,66 @@ VOID onAlarmAck(USIGN16 wAlarmHandler, USIGN32 dwResponseMsg)
     #ifdef DEBUG_MAIN
         printf("APP: ALARM_ACKN was received\n");
     #endif
+#ifdef USE_ALARM_QUEUE
+    if(dwResponseMsg == ALARM_QUEUE_DROPPED)
+    {
+        printf("Queued alarm 0x%lX discarded\n", (unsigned long)wAlarmHandler);
+        return;
+    }
+#endif
 #ifdef DIAGNOSIS_ENABLE
     g_bAlarmAckReceived = TPS_TRUE;
 #endif
 }
 
+#if defined(TPS_HOST_SIMULATION) && defined(USE_ALARM_QUEUE)
+/*****************************************************************************
+**
+** FUNCTION NAME: simQueueAlarms()
+**
+** DESCRIPTION:   Replay step of the host simulation. The TPS-1 model has no
+**                PROFINET controller, so the AR is made the owner of the
+**                submodules of slot 1 as the TPS-1 does for the submodules
+**                of a connect request. Then one process alarm more than
+**                the queue depth is queued in the low priority mailbox;
+**                the queue sends them with the acknowledges of the model.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwARNumber (AR_0 or AR_1)
+**
+*******************************************************************************
+*/
+VOID simQueueAlarms(USIGN32 dwARNumber)
+{
+    T_ALARM_QUEUE_STATISTICS zStatistics;
+    USIGN8  byAlarmData[4] = {0};
+    USIGN16 wAlarm;
+    USIGN32 dwRetval;
+
+    TPS_SetValue16((USIGN8*)g_pzSubmodule_11->pt_wSubslotOwnedByAr, OWNED_BY_AR(dwARNumber));
+    TPS_SetValue16((USIGN8*)g_pzSubmodule_12->pt_wSubslotOwnedByAr, OWNED_BY_AR(dwARNumber));
+
+    for(wAlarm = 0; wAlarm <= ALARM_QUEUE_DEPTH; wAlarm++)
+    {
+        byAlarmData[0] = (USIGN8)wAlarm;
+
+        dwRetval = TPS_QueueAlarm(dwARNumber, 0x00, 1, 1, ALARM_LOW, PROCESS_ALARM,
+                                  sizeof(byAlarmData), byAlarmData, 0x0001, (USIGN16)(0x0100 + wAlarm));
+        if(dwRetval != TPS_ACTION_OK)
+        {
+            printf("TPS_QueueAlarm %lu -> ERROR: 0x%lX\n", (unsigned long)wAlarm, (unsigned long)dwRetval);
+        }
+    }
+
+    if(TPS_GetAlarmQueueStatistics((USIGN8)dwARNumber, ALARM_LOW, &zStatistics) == TPS_ACTION_OK)
+    {
+        printf("Alarm queue: %lu sent, %lu queued\n",
+               (unsigned long)zStatistics.dwSent, (unsigned long)zStatistics.dwQueued);
+    }
+}
+#endif
+
 /******************************************************************************
 **
 ** FUNCTION NAME: onDiagAlarmAck()
@@ -1541,7 +2013,7 @@ VOID onTpsMessageReceived(T_ETHERNET_MAILBOX* poEthernetMailbox)
         dwOffset += 28;
         if(dwDataLength > 0)
         {
-            pbyRecordReadData = malloc(dwDataLength);
+            pbyRecordReadData = APP_BUFFER_ALLOC(dwDataLength);
             if(pbyRecordReadData != NULL)
             {
                 TPS_GetValueData(poEthernetMailbox->byFrame + dwOffset,
@@ -1613,7 +2085,7 @@ VOID onTpsMessageReceived(T_ETHERNET_MAILBOX* poEthernetMailbox)
     /* Free the memory again. */
     if(pbyRecordReadData != NULL)
     {
-        free(pbyRecordReadData);
+        APP_BUFFER_FREE(pbyRecordReadData);
         pbyRecordReadData = NULL;
     }
 }
@@ -1643,9 +2115,16 @@ VOID onEthPacketReceived(T_ETHERNET_MAILBOX* poRXMailbox)
         USIGN8 byTpsInterfaceMac[MAC_ADDRESS_SIZE];
         USIGN8 byReceivedFrame[MAX_LEN_ETHERNET_FRAME];
     #endif
-
-    TPS_GetValue32((USIGN8*)&poRXMailbox->dwLength, &dwLength);
-    TPS_GetValue32((USIGN8*)&poRXMailbox->dwPortnumber, &dwPortNr);
+    #ifdef USE_ETHERNET_RX_FILTER
+        /* Length, port and MAC addresses were read by the receive filter. */
+        const T_ETH_RX_HEADER* pzHeader = TPS_GetEthernetRxHeader();
+
+        dwLength = pzHeader->dwLength;
+        dwPortNr = pzHeader->dwPortNumber;
+    #else
+        TPS_GetValue32((USIGN8*)&poRXMailbox->dwLength, &dwLength);
+        TPS_GetValue32((USIGN8*)&poRXMailbox->dwPortnumber, &dwPortNr);
+    #endif
 
     #ifdef DEBUG_API_ETH_FRAME
         printf("DEBUG_API > API: Ethernet frame received at LAN port 0x%X, Length: 0x%X\n",
@@ -1658,11 +2137,20 @@ VOID onEthPacketReceived(T_ETHERNET_MAILBOX* poRXMailbox)
         /* But only return packages which are directly send to the interface,  */
         /* not broadcasts.                                                     */
         /*---------------------------------------------------------------------*/
+    #ifdef USE_ETHERNET_RX_FILTER
+        /* Only frames to the interface MAC pass the rule of registerCallbacks(). */
+        memcpy(byTargetMac, pzHeader->byDstMac, MAC_ADDRESS_SIZE);
+        memcpy(byTpsInterfaceMac, pzHeader->byDstMac, MAC_ADDRESS_SIZE);
+
+        if((pzHeader->bToOwnMac == TPS_TRUE) &&
+           MIRROR_PORT(dwPortNr))
+    #else
         TPS_GetValueData((USIGN8*)&poRXMailbox->byFrame, byTargetMac, MAC_ADDRESS_SIZE);
         TPS_GetMacAddresses(byTpsInterfaceMac, NULL, NULL);
 
         if((memcmp(byTargetMac, byTpsInterfaceMac, MAC_ADDRESS_SIZE) == 0) &&
-           (dwPortNr == PORT_NR_INTERFACE))
+           MIRROR_PORT(dwPortNr))
+    #endif
         {
             /* Read the package from the mailbox. */
             /* The returned Length contains the CRC of the ethernet frame, don't return it. */
@@ -1683,7 +2171,12 @@ VOID onEthPacketReceived(T_ETHERNET_MAILBOX* poRXMailbox)
             memcpy(byReceivedFrame + MAC_ADDRESS_SIZE, byTpsInterfaceMac, MAC_ADDRESS_SIZE);
 
             /* Send the frame. */
+        #ifdef USE_ETHERNET_TX_QUEUE
+            /* copied, written by TPS_ServiceEthernetTxQueue() in the main loop */
+            TPS_QueueEthernetFrame(byReceivedFrame, dwLength, dwPortNr);
+        #else
             TPS_SendEthernetFrame(byReceivedFrame, dwLength, dwPortNr);
+        #endif
         }
     #endif
 
@@ -1842,3 +2335,373 @@ VOID printHexData(USIGN8* pbyData, USIGN32 dwDataLength)
     }
     printf("\n");
 }
+
+#ifdef APP_DEBUG_COMMANDS
+/*****************************************************************************
+**
+**  FUNCTION NAME:   checkDebugCommand
+**
+**  DESCRIPTION:     Checks without waiting if a command was received by the
+**                   debug UART (USART3).
+**                   'p' prints the profiling table, 'r' clears it.
+**                   'u' receives a firmware image and writes it to the
+**                   TPS-1, then the host restarts with the new firmware.
+**
+**  PARAMETER:       none
+**
+*******************************************************************************
+*/
+VOID checkDebugCommand(VOID)
+{
+    USIGN8 byCommand;
+
+    if(__HAL_UART_GET_FLAG(&huart3, UART_FLAG_RXNE) == RESET)
+    {
+        return;
+    }
+
+    byCommand = (USIGN8)(huart3.Instance->DR & 0xFF);
+
+    switch(byCommand)
+    {
+#ifdef TPS_PROFILING
+    case 'p':
+        TPS_ProfileDump();
+        break;
+    case 'r':
+        TPS_ProfileReset();
+        printf("profiling table cleared\r\n");
+        break;
+#endif
+#if defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM)
+    case 'u':
+        /* The stack of the TPS-1 is stopped during the update, the ARs    */
+        /* are lost: the host starts again and configures the new firmware. */
+        updateFirmwareFromUart();
+        NVIC_SystemReset();
+        break;
+#endif
+    default:
+        break;
+    }
+}
+#endif
+
+#ifdef USE_CONFIG_IMAGE
+/*****************************************************************************
+**
+**  FUNCTION NAME:   loadConfigImage
+**
+**  DESCRIPTION:     Writes the configuration image of the previous start
+**                   from the flash to the TPS-1. configDevice() then only
+**                   builds the handles. Without a valid image (first start,
+**                   new driver version) configDevice() writes the
+**                   configuration as usual.
+**
+**  RETURN:          none
+**
+**  PARAMETER:       none
+**
+*******************************************************************************
+*/
+VOID loadConfigImage(VOID)
+{
+    USIGN32 dwResult;
+
+    if(!APP_CONFIG_IMAGE_IN_FLASH())
+    {
+        printf("Configuration image outside of the flash\r\n");
+        return;
+    }
+
+    dwResult = TPS_LoadConfigImage(APP_CONFIG_IMAGE);
+    if(dwResult != TPS_ACTION_OK)
+    {
+        printf("No configuration image (0x%08lX)\r\n", (unsigned long)dwResult);
+    }
+}
+
+/*****************************************************************************
+**
+**  FUNCTION NAME:   storeConfigImage
+**
+**  DESCRIPTION:     Called after configDevice(). Without a loaded image the
+**                   image is built and written to the flash. If the
+**                   configuration differs from the loaded image, the image
+**                   is erased and the host restarts.
+**
+**  RETURN:          none
+**
+**  PARAMETER:       none
+**
+*******************************************************************************
+*/
+VOID storeConfigImage(VOID)
+{
+    T_CONFIG_IMAGE_STATISTICS zStatistics;
+    USIGN32 dwImageLength = 0;
+    USIGN32 dwResult;
+
+    TPS_GetConfigImageStatistics(&zStatistics);
+    if(zStatistics.byState == CONFIG_IMAGE_REPLAY)
+    {
+        printf("Configuration from image: %lu bytes in %lu bursts, %lu writes saved\r\n",
+               (unsigned long)zStatistics.dwDpramBytes, (unsigned long)zStatistics.dwBursts,
+               (unsigned long)zStatistics.dwWritesSuppressed);
+        return;
+    }
+
+    if(!APP_CONFIG_IMAGE_IN_FLASH())
+    {
+        return;
+    }
+
+    if(zStatistics.byState == CONFIG_IMAGE_MISMATCH)
+    {
+        /* The DPRAM still holds bytes of the old image which configDevice()
+         * does not overwrite. The image is erased before the TPS-1 and the
+         * host start again, the next start writes the configuration without
+         * the image and stores the new one.                                 */
+        dwResult = writeConfigImageToFlash(NULL, 0);
+        printf("Configuration differs from the image, image erased (0x%08lX)\r\n", (unsigned long)dwResult);
+#ifndef TPS_HOST_SIMULATION
+        if(dwResult == HAL_OK)
+        {
+            NVIC_SystemReset();
+        }
+#endif
+        return;
+    }
+
+    dwResult = TPS_BuildConfigImage(g_byConfigImageBuffer, sizeof(g_byConfigImageBuffer), &dwImageLength);
+    if(dwResult == TPS_ACTION_OK)
+    {
+        dwResult = writeConfigImageToFlash(g_byConfigImageBuffer, dwImageLength);
+    }
+    printf("Configuration image: %lu bytes stored (0x%08lX)\r\n",
+           (unsigned long)dwImageLength, (unsigned long)dwResult);
+}
+
+/*****************************************************************************
+**
+**  FUNCTION NAME:   writeConfigImageToFlash
+**
+**  DESCRIPTION:     Erases the flash area of the configuration image
+**                   (CONFIG_IMAGE_FLASH_ADDRESS) and programs the image.
+**                   An interrupted write is detected by the checksum of
+**                   the image. With dwImageLength 0 the area is only
+**                   erased.
+**
+**  RETURN:          TPS_ACTION_OK (HAL_OK) or the status of the HAL flash
+**                   driver
+**
+**  PARAMETER:       pbyImage       the image (NULL if dwImageLength is 0)
+**                   dwImageLength  length of the image
+**
+*******************************************************************************
+*/
+USIGN32 writeConfigImageToFlash(const USIGN8* pbyImage, USIGN32 dwImageLength)
+{
+#ifdef TPS_HOST_SIMULATION
+    memset(g_byConfigImageFlash, 0xFF, sizeof(g_byConfigImageFlash));
+    if(dwImageLength != 0)
+    {
+        memcpy(g_byConfigImageFlash, pbyImage, dwImageLength);
+    }
+    return TPS_ACTION_OK;
+#else
+    FLASH_EraseInitTypeDef zErase;
+    USIGN32 dwPageError = 0;
+    USIGN32 dwOffset;
+    USIGN16 wHalfWord;
+    USIGN32 dwResult = HAL_OK;
+
+    HAL_FLASH_Unlock();
+
+    zErase.TypeErase   = FLASH_TYPEERASE_PAGES;
+    zErase.Banks       = FLASH_BANK_1;
+    zErase.PageAddress = CONFIG_IMAGE_FLASH_ADDRESS;
+    zErase.NbPages     = CONFIG_IMAGE_MAX_SIZE / FLASH_PAGE_SIZE;
+
+    dwResult = HAL_FLASHEx_Erase(&zErase, &dwPageError);
+
+    /* The flash is programmed with half words. */
+    for(dwOffset = 0; (dwOffset < dwImageLength) && (dwResult == HAL_OK); dwOffset += 2)
+    {
+        wHalfWord = pbyImage[dwOffset];
+        wHalfWord |= ((dwOffset + 1) < dwImageLength) ? (pbyImage[dwOffset + 1] << 8) : 0xFF00;
+
+        dwResult = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, CONFIG_IMAGE_FLASH_ADDRESS + dwOffset, wHalfWord);
+    }
+
+    HAL_FLASH_Lock();
+
+    return dwResult;
+#endif
+}
+#endif
+
+#if defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM) && !defined(TPS_HOST_SIMULATION)
+/*****************************************************************************
+**
+**  FUNCTION NAME:   updateFirmwareFromUart
+**
+**  DESCRIPTION:     Example of a streamed firmware update: the image is
+**                   received by the debug UART (USART3), first its length
+**                   (4 bytes, little endian), then the image itself. The
+**                   bytes are received by interrupt into a ring, so none is
+**                   lost while a fragment is written to the TPS-1, and
+**                   passed to TPS_FwUpdatePush() from there. The next
+**                   fragment is received while the TPS-1 programs the
+**                   previous one. The PROFINET stack of the TPS-1 is
+**                   stopped during the update.
+**                   If the length does not arrive within
+**                   FW_UART_LENGTH_TIMEOUT_MS the TPS-1 is not touched, a
+**                   stalled image ends the update after FW_STREAM_TIMEOUT_MS.
+**
+**  RETURN:          result of TPS_FwUpdateService(),
+**                   API_FW_STREAM_SOURCE_TIMEOUT if no length was received
+**
+**  PARAMETER:       none
+**
+*******************************************************************************
+*/
+USIGN32 updateFirmwareFromUart(VOID)
+{
+    T_FW_UPDATE_STATISTICS zStatistics;
+    USIGN32 dwLengthOfImage = 0;
+    USIGN32 dwResult = TPS_ACTION_OK;
+    USIGN32 dwStartMs;
+    USIGN16 wHead;
+    USIGN16 wLength;
+    USIGN8  byIndex = 0;
+
+    g_wFwUartHead = 0;
+    g_wFwUartTail = 0;
+    g_dwFwUartOverruns = 0;
+
+    __HAL_UART_ENABLE_IT(&huart3, UART_IT_RXNE);
+    HAL_NVIC_SetPriority(USART3_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(USART3_IRQn);
+
+    dwStartMs = HAL_GetTick();
+    while((byIndex < sizeof(dwLengthOfImage)) && (dwResult == TPS_ACTION_OK))
+    {
+        if(g_wFwUartTail != g_wFwUartHead)
+        {
+            dwLengthOfImage |= (USIGN32)g_byFwUartRing[g_wFwUartTail] << (8 * byIndex);
+            g_wFwUartTail = (g_wFwUartTail + 1) & (FW_UART_RING_SIZE - 1);
+            byIndex++;
+        }
+        else if((HAL_GetTick() - dwStartMs) >= FW_UART_LENGTH_TIMEOUT_MS)
+        {
+            dwResult = API_FW_STREAM_SOURCE_TIMEOUT;
+        }
+    }
+
+    if(dwResult == TPS_ACTION_OK)
+    {
+        dwResult = TPS_StartFwUpdater();
+    }
+    if(dwResult == TPS_ACTION_OK)
+    {
+        dwResult = TPS_FwUpdateBegin(dwLengthOfImage, HAL_GetTick());
+    }
+    if(dwResult == TPS_ACTION_OK)
+    {
+        dwResult = API_FW_STREAM_BUSY;
+    }
+
+    while(dwResult == API_FW_STREAM_BUSY)
+    {
+        /* The received bytes up to the end of the ring. Bytes not taken
+         * because both fragment buffers are full stay in the ring until the
+         * TPS-1 has taken the next fragment.                                */
+        wHead = g_wFwUartHead;
+        if(wHead != g_wFwUartTail)
+        {
+            wLength = (wHead > g_wFwUartTail) ? (wHead - g_wFwUartTail) : (FW_UART_RING_SIZE - g_wFwUartTail);
+            wLength = (USIGN16)TPS_FwUpdatePush((const USIGN8*)&g_byFwUartRing[g_wFwUartTail], wLength);
+            g_wFwUartTail = (g_wFwUartTail + wLength) & (FW_UART_RING_SIZE - 1);
+        }
+
+        dwResult = TPS_FwUpdateService(HAL_GetTick());
+    }
+
+    HAL_NVIC_DisableIRQ(USART3_IRQn);
+    __HAL_UART_DISABLE_IT(&huart3, UART_IT_RXNE);
+
+    TPS_GetFwUpdateStatistics(&zStatistics);
+    printf("FW update 0x%lX: %lu bytes, %lu fragments, %lu ms, %lu bytes/s, %lu UART overruns\r\n",
+           (unsigned long)dwResult, (unsigned long)zStatistics.dwBytes, (unsigned long)zStatistics.dwFragments,
+           (unsigned long)zStatistics.dwTotalTimeMs, (unsigned long)zStatistics.dwBytesPerSecond,
+           (unsigned long)g_dwFwUartOverruns);
+
+    return dwResult;
+}
+
+/*****************************************************************************
+**
+**  FUNCTION NAME:   onFwUpdateUartIrq
+**
+**  DESCRIPTION:     Called by the USART3 interrupt during
+**                   updateFirmwareFromUart(). Puts the received byte into
+**                   the ring. A byte lost by the UART or by a full ring is
+**                   counted, the missing byte then stalls the update.
+**
+**  PARAMETER:       none
+**
+*******************************************************************************
+*/
+VOID onFwUpdateUartIrq(VOID)
+{
+    USIGN32 dwStatus = huart3.Instance->SR;
+    USIGN16 wNext;
+    USIGN8  byData;
+
+    if((dwStatus & (USART_SR_RXNE | USART_SR_ORE)) == 0)
+    {
+        return;
+    }
+
+    /* Reading DR after SR clears RXNE and ORE. */
+    byData = (USIGN8)(huart3.Instance->DR & 0xFF);
+
+    if((dwStatus & USART_SR_ORE) != 0)
+    {
+        g_dwFwUartOverruns++;
+    }
+
+    wNext = (g_wFwUartHead + 1) & (FW_UART_RING_SIZE - 1);
+    if(wNext == g_wFwUartTail)
+    {
+        g_dwFwUartOverruns++;
+        return;
+    }
+
+    g_byFwUartRing[g_wFwUartHead] = byData;
+    g_wFwUartHead = wNext;
+}
+#endif
+
+#if defined(TPS_EVENT_IRQ_MODE) && !defined(TPS_HOST_SIMULATION)
+/*****************************************************************************
+**
+**  FUNCTION NAME:   HAL_GPIO_EXTI_Callback()
+**
+**  DESCRIPTION:     EXTI callback of the HAL. Forwards the host interrupt of
+**                   the TPS-1 to the driver. The events are dispatched later
+**                   by TPS_DispatchEvents() in StartTPS1().
+**
+**  PARAMETER:       GPIO_Pin  pin that caused the interrupt
+**
+*******************************************************************************
+*/
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if(GPIO_Pin == TPS_HOST_IRQ_Pin)
+    {
+        TPS_EventIrqHandler();
+    }
+}
+#endif
@@ -33,6 +33,7 @@
 /* Application Includes                                                      */
 /*---------------------------------------------------------------------------*/
 #include <TPS_1_API.h>
+#include <stddef.h>
 
 /*---------------------------------------------------------------------------*/
 /* Local defines                                                             */
@@ -56,11 +57,39 @@
 
 #define RECORD_ERROR_INVALID_INDEX             -1
 
+#define SUBSLOT_IO_CACHE_ALL_ARS               0xFF
+
+/* Packet buffers of the TPS communication channel and the DCP requests      */
+#ifdef USE_BUFFER_POOL
+#define API_BUFFER_ALLOC(dwLength)             TPS_BufferPoolAlloc(dwLength)
+#define API_BUFFER_FREE(pbyBuffer)             TPS_BufferPoolFree(pbyBuffer)
+#else
+#define API_BUFFER_ALLOC(dwLength)             malloc(dwLength)
+#define API_BUFFER_FREE(pbyBuffer)             free(pbyBuffer)
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Local functions                                                           */
 /*---------------------------------------------------------------------------*/
 static SLOT*    AppGetSlotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber);
 static SUBSLOT* AppGetSubslotHandle(USIGN32 dwApiNumberApi, USIGN16 wSlotNumber, USIGN16 wSubslotNumber);
+static USIGN16  AppGetSlotNumber(SLOT* pzSlot);
+static USIGN16  AppGetSubslotNumber(SUBSLOT* pzSubslot);
+static USIGN32  AppDiagCheckEventFree(USIGN32 dwInUseError);
+static VOID     AppDiagChanged(USIGN32 dwDiagAddress, USIGN8 byAlarmType);
+#ifdef USE_DIAG_INDEX
+static SUBSLOT* AppDiagIndexFind(USIGN32 dwDiagAddress, USIGN32* pdwEntryIndex);
+static USIGN16  AppDiagIndexFindKey(SUBSLOT* pzSubslot, const DPR_DIAG_ENTRY* pzKey);
+static USIGN32  AppDiagIndexHash(const SUBSLOT* pzSubslot, const DPR_DIAG_ENTRY* pzEntry);
+static VOID     AppDiagIndexInit(SUBSLOT* pzSubslot);
+static VOID     AppDiagIndexLink(SUBSLOT* pzSubslot, USIGN16 wEntry);
+static VOID     AppDiagIndexRelease(SUBSLOT* pzSubslot, USIGN16 wEntry);
+static USIGN32  AppDiagIndexRefreshFlags(SUBSLOT* pzSubslot, USIGN32 dwEntryIndex);
+static USIGN32  AppDiagIndexCollect(SUBSLOT* pzSubslot);
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+static USIGN32  AppDiagIndexClear(SUBSLOT* pzSubslot);
+#endif
+#endif
 static VOID     AppOnConnect(USIGN32 dwARNumber);
 static VOID     AppOnConnect_Done(USIGN32 dwARNumber);
 static VOID     AppOnPRMENDDone(USIGN32 dwARNumber);
@@ -68,7 +97,28 @@ static USIGN32  AppSetEventAppRdy(USIGN32 dwARNumber);
 static VOID     AppOnReadRecord(VOID);
 static USIGN32  AppCreateAlarmMailBox(USIGN32 dwBoxNumber);
 static VOID     AppOnWriteRecord(VOID);
+static USIGN32  AppRecordReqHeaderFetch(USIGN32 dwMailboxNumber, USIGN8 byFlag);
+#ifdef USE_RECORD_REGISTRY
+static BOOL     AppRecordRegistrySearch(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber,
+                                        USIGN16 wIndex, USIGN16* pwPosition);
+static T_RECORD_HANDLER_ENTRY* AppRecordRegistryFind(const RECORD_BOX_INFO* pzRecord, USIGN8 byFlag);
+static BOOL     AppRecordRegistryRead(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                      USIGN8* pbyBuffer, USIGN8** ppbyResponse, SIGN32* pdwLength);
+static BOOL     AppRecordRegistryWrite(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                       USIGN8* pbyData, SIGN32* pdwResult);
+static VOID     AppRecordCacheInvalidate(T_RECORD_HANDLER_ENTRY* pzEntry);
+#endif
 static VOID     AppOnAlarmAck(VOID);
+#ifdef USE_ALARM_QUEUE
+static USIGN32  AppAlarmQueueSend(USIGN8 byMailboxNr, T_ALARM_QUEUE_ENTRY* pzEntry);
+static VOID     AppAlarmQueueOnSent(USIGN8 byMailboxNr);
+static VOID     AppAlarmQueueOnAck(USIGN8 byMailboxNr);
+static VOID     AppAlarmQueueFlush(USIGN32 dwARNumber);
+#endif
+#ifdef DIAGNOSIS_ENABLE
+static USIGN32  AppDiagBuildAlarm(USIGN32 dwDiagAddress, USIGN8 byAlarmType, USIGN8* pbyAlarmData,
+                                  USIGN32* pdwAlarmDataLength, USIGN8* pbyStatus, USIGN16* pwUsi);
+#endif
 static VOID     AppOnDiagAckn(VOID);
 static VOID     AppOnAbort(USIGN32 dwARNumber);
 static VOID     AppOnSetStationName(T_DCP_SET_MODE zMode);
@@ -83,12 +133,98 @@ static USIGN32  APP_AddDevice (USIGN16 wVendorID, USIGN16 wDeviceID, CHAR *pszDe
 #ifdef USE_ETHERNET_INTERFACE
 static VOID     AppOnEthernetReceive(VOID);
 #endif
+#ifdef USE_ETHERNET_RX_FILTER
+static BOOL     AppEthernetRxFilter(VOID);
+#endif
+#ifdef USE_ETHERNET_TX_QUEUE
+static USIGN32  AppEthTxQueueService(USIGN8 byQueue, USIGN32 dwByteBudget);
+static VOID     AppEthTxQueueFlush(VOID);
+#endif
+#ifdef USE_FW_UPDATE_STREAM
+static VOID     AppFwStreamEnd(USIGN32 dwResult);
+#endif
+#ifdef USE_CONFIG_IMAGE
+/* Run encoder of TPS_BuildConfigImage() */
+typedef struct _T_CONFIG_IMAGE_ENCODER
+{
+    USIGN8*  pbyOut;                /* next free byte of the image */
+    USIGN8*  pbyEnd;                /* end of the image buffer */
+    USIGN8*  pbyDataRun;            /* head of the open data run or NULL */
+    USIGN32  dwDataCount;           /* bytes in the open data run */
+    USIGN32  dwZeros;               /* zero bytes not yet encoded */
+} T_CONFIG_IMAGE_ENCODER;
+
+static USIGN32  AppConfigImageChecksum(const USIGN8* pbyData, USIGN32 dwLength);
+static BOOL     AppConfigImageAccess(USIGN32 dwOffset, const USIGN8* pbyData, USIGN8 byFill, USIGN8* pbyRead, USIGN32 dwLength);
+static BOOL     AppConfigImageComplete(VOID);
+static VOID     AppConfigImageEnd(BOOL bMismatch);
+static USIGN32  AppConfigImageFindPending(USIGN32 dwAddress, USIGN32 dwLength);
+static BOOL     AppConfigImageSetPending(USIGN32 dwAddress, USIGN8 byValue, BOOL bEqual);
+static BOOL     AppConfigImagePutData(T_CONFIG_IMAGE_ENCODER* pzEncoder, USIGN8 byValue);
+static BOOL     AppConfigImagePutZeros(T_CONFIG_IMAGE_ENCODER* pzEncoder);
+static VOID     AppConfigImageCloseRun(T_CONFIG_IMAGE_ENCODER* pzEncoder);
+#endif
+#ifdef USE_STARTUP_SERVICE
+static BOOL     AppStartupPollDue(USIGN32 dwNowMs);
+static USIGN32  AppStartupFail(USIGN32 dwResult);
+#endif
+/* Object pool of one handle type, see g_zObjectPool */
+typedef struct _T_OBJECT_POOL
+{
+    USIGN8*                   pbyObjects;   /* first object of the pool */
+    USIGN32                   dwObjectSize; /* sizeof() of the object type */
+    USIGN16*                  pwFree;       /* stack of the indices of the free objects */
+    BOOL*                     pbUsed;       /* TPS_TRUE while the object is allocated */
+    USIGN16                   wFree;        /* entries on pwFree */
+    T_OBJECT_POOL_STATISTICS  zStatistics;  /* wCapacity: number of objects */
+} T_OBJECT_POOL;
+
+#ifdef USE_HANDLE_INDEX
+/* Entry of the handle index, pzSubslot is NULL for the entry of a slot */
+typedef struct _T_HANDLE_INDEX_ENTRY
+{
+    SLOT*     pzSlot;               /* NULL: free entry */
+    SUBSLOT*  pzSubslot;
+    USIGN32   dwApi;
+    USIGN16   wSlotNumber;
+    USIGN16   wSubslotNumber;
+} T_HANDLE_INDEX_ENTRY;
+
+static T_HANDLE_INDEX_ENTRY* AppHandleIndexFind(USIGN32 dwApi, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, BOOL bSubslot);
+static VOID     AppHandleIndexAdd(SLOT* pzSlot, SUBSLOT* pzSubslot, USIGN16 wSubslotNumber);
+#endif
+static VOID     AppObjectPoolReset(T_OBJECT_POOL* pzPool);
+static VOID*    AppObjectPoolAlloc(T_OBJECT_POOL* pzPool);
+static USIGN32  AppObjectPoolFree(T_OBJECT_POOL* pzPool, VOID* pObject);
 static VOID     AppOnTPSMessageReceive(VOID);
 static VOID     AppOnTPSReset( VOID );
 
 static VOID     AppSetLastError(USIGN32 dwErrorCode);
 static USIGN32  AppSetEventRegApp(USIGN32 dwEventBit);
-static USIGN32  AppSetEventRegAppAckn(USIGN32 dwEventBit);
+static USIGN32  AppSetEventRegAppAcknMask(USIGN32 dwEventMask);
+static USIGN32  AppCheckEvents(VOID);
+static USIGN32  AppStartBufferChange(USIGN8 byARNumber, USIGN8 byCrType, USIGN32 dwRegValue);
+
+/* Adapters of the event handlers to the handler table                       */
+static VOID     AppEventReadRecord(USIGN32 dwDummy);
+static VOID     AppEventWriteRecord(USIGN32 dwDummy);
+static VOID     AppEventAlarmAck(USIGN32 dwDummy);
+static VOID     AppEventDiagAckn(USIGN32 dwDummy);
+static VOID     AppEventSetStationName(USIGN32 dwMode);
+static VOID     AppEventSetStationIpAddr(USIGN32 dwMode);
+static VOID     AppEventSetStationDcpSignal(USIGN32 dwDummy);
+static VOID     AppEventResetFactorySettings(USIGN32 dwDummy);
+#ifdef USE_ETHERNET_INTERFACE
+static VOID     AppEventEthernetReceive(USIGN32 dwDummy);
+#endif
+static VOID     AppEventTPSMessageReceive(USIGN32 dwDummy);
+static VOID     AppEventTPSReset(USIGN32 dwDummy);
+static VOID     AppEventTPSLedChanged(USIGN32 dwDummy);
+static VOID     AppEventFSUParameterChange(USIGN32 dwDummy);
+#ifndef TPS_COUNT_TRAILING_ZEROS
+static USIGN32  AppCountTrailingZeros(USIGN32 dwValue);
+#define TPS_COUNT_TRAILING_ZEROS(x)   AppCountTrailingZeros(x)
+#endif
 static USIGN32  AppSetEventOnConnectOK(USIGN32 dwARNumber);
 static SIGN32   AppReadRecordDataObject(T_RECORD_DATA_OBJECT_TYPE zObjectToRead, USIGN32 dwArNumber, USIGN32 dwApiNumber,
                                         USIGN16 wSlotNumber, USIGN16 wSubslotNumber, USIGN8* pbyArrMailboxData);
@@ -114,6 +250,17 @@ static USIGN32 AppRePlugSubmodule(SUBSLOT *pzSubslot);
 static USIGN32 AppReactivateSubmodule(SUBSLOT *pzSubslot);
 USIGN32 App_GetAPDUOffsetForAR(USIGN8 byArNr);
 
+#ifdef USE_SUBSLOT_IO_CACHE
+static T_SUBSLOT_IO_CACHE* AppGetSubslotIoCache(SUBSLOT* pzSubslot);
+static VOID    AppReadSubslotIoDescriptor(SUBSLOT* pzSubslot, T_SUBSLOT_IO_CACHE* pzCache);
+static VOID    AppFillSubslotIoCache(USIGN32 dwARNumber);
+static VOID    AppInvalidateSubslotIoCache(USIGN32 dwARNumber);
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+static USIGN32 AppBuildIoFrameImage(USIGN8 byARNumber);
+static USIGN8* AppGetIoFrameImageAddress(T_SUBSLOT_IO_CACHE* pzCache, USIGN8* pbyIOMemory, USIGN16 wOffset, USIGN16 wLength);
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Global variables.                                                         */
 /*---------------------------------------------------------------------------*/
@@ -141,6 +288,76 @@ static USIGN32 g_dwArEstablished_IOSR  = AR_NOT_IN_OPERATION; /*!< current AR st
     static USIGN32 g_dwUpdaterStartTimeout = 500000; /*!< Timeout after which the update process will report an error */
 #endif
 
+#ifdef USE_FW_UPDATE_STREAM
+/* Streamed firmware update: two fragment buffers, g_byFwStreamHead is       */
+/* written next, the buffer behind the full ones is filled by                */
+/* TPS_FwUpdatePush().                                                       */
+/*---------------------------------------------------------------------------*/
+#define FW_STREAM_IDLE              0
+#define FW_STREAM_TRANSFER          1   /* fragments are written           */
+#define FW_STREAM_FINISH            2   /* waiting for UPD_EVENT_FW_UPDATE_DONE */
+#define FW_STREAM_DONE              3
+#define FW_STREAM_BUFFERS           2
+
+static USIGN8                 g_byFwStreamBuffer[FW_STREAM_BUFFERS][FW_FRAG_LEN];
+static USIGN16                g_wFwStreamLength[FW_STREAM_BUFFERS];
+static USIGN8                 g_byFwStreamHead = 0;
+static USIGN8                 g_byFwStreamFull = 0;
+static USIGN32                g_dwFwStreamFill = 0;
+static USIGN8                 g_byFwStreamState = FW_STREAM_IDLE;
+static USIGN32                g_dwFwStreamImageLength = 0;
+static USIGN32                g_dwFwStreamReceived = 0;
+static USIGN32                g_dwFwStreamProgressMs = 0;
+static USIGN32                g_dwFwStreamResult = TPS_ACTION_OK;
+static USIGN32                g_dwFwStreamStartMs = 0;
+static T_FW_UPDATE_STATISTICS g_zFwStreamStatistics = {0};
+#endif
+
+#ifdef USE_CONFIG_IMAGE
+/* Configuration image: the runs of the image loaded by TPS_LoadConfigImage() */
+/* are compared with the DPRAM accesses of configDevice() until              */
+/* TPS_StartDevice(). g_pbyConfigImageRun starts at DPRAM offset             */
+/* g_dwConfigImageRunStart of the image, it is the run of the last access    */
+/* (the configuration is written mostly ascending).                          */
+/* Some bytes are written with intermediate values (e.g. NumberOfApis). A    */
+/* byte differing from the image is kept in g_zConfigImagePending until it   */
+/* is overwritten with the value of the image.                               */
+/*---------------------------------------------------------------------------*/
+#define CONFIG_IMAGE_READ_CHUNK     128
+#define CONFIG_IMAGE_MAX_DATA_RUN   (MAX_BUFFER_LEN_SPI_DATA - CMD_MEM_LEN)
+#define CONFIG_IMAGE_PENDING_BYTES  16
+
+typedef struct _T_CONFIG_IMAGE_PENDING
+{
+    USIGN32  dwAddress;
+    BOOL     bUsed;
+    USIGN8   byValue;
+} T_CONFIG_IMAGE_PENDING;
+
+static T_CONFIG_IMAGE_HEADER     g_zConfigImageHeader = {0};
+static const USIGN8*             g_pbyConfigImageRuns = NULL;
+static const USIGN8*             g_pbyConfigImageRun = NULL;
+static USIGN32                   g_dwConfigImageRunStart = 0;
+static T_CONFIG_IMAGE_STATISTICS g_zConfigImageStatistics = {0};
+static T_CONFIG_IMAGE_PENDING    g_zConfigImagePending[CONFIG_IMAGE_PENDING_BYTES];
+#endif
+
+#ifdef USE_STARTUP_SERVICE
+/* Startup state machine of TPS_StartupService(). A poll of the TPS-1 is     */
+/* due g_dwStartupPollIntervalMs after the previous one, the interval is     */
+/* doubled after each poll. g_byStartupIrq is set by the host interrupt.     */
+/*---------------------------------------------------------------------------*/
+static USIGN32         (*g_pfnStartupConfigure)(VOID) = NULL;
+static USIGN32         (*g_pfnStartupGetTimeMs)(VOID) = NULL;
+static USIGN32         g_dwStartupBeginMs = 0;
+static USIGN32         g_dwStartupLastPollMs = 0;
+static USIGN32         g_dwStartupPollIntervalMs = 0;
+static T_STARTUP_TIMES g_zStartupTimes = {0};
+#ifdef TPS_EVENT_IRQ_MODE
+static volatile USIGN8 g_byStartupIrq = TPS_FALSE;
+#endif
+#endif
+
 /*---------------------------------------------------------------------------*/
     static API_AR_CTX          g_zApiARContext         = {0};
 static API_DEV_CTX         g_zApiDeviceContext     = {0};
@@ -152,17 +369,169 @@ static T_API_ETHERNET_CTX  g_zApiEthernetContext   = {0};
 static USIGN16 g_wNumberOfDiagEntries = 0; /*!< Number of diagnosis entries available */
 #endif
 
+#ifdef USE_DIAG_INDEX
+/* Diagnosis index: host side copies of the diagnosis buffers, assigned to   */
+/* the subslots by TPS_PlugSubmodule(). The used entries are chained by the  */
+/* hash of subslot, channel number and error type, the free entries of a     */
+/* subslot by its free list.                                                 */
+/*---------------------------------------------------------------------------*/
+#define DIAG_ENTRY_FLAGS_OFFSET   offsetof(DPR_DIAG_ENTRY, byFlags)
+#define DIAG_INDEX_END            0xFFFF
+#define DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex) \
+    (&g_zDiagIndexPool[(pzSubslot)->zDiagIndex.wFirstEntry + (dwEntryIndex)].zEntry)
+
+static T_DIAG_INDEX_ENTRY g_zDiagIndexPool[DIAG_INDEX_SIZE];
+static USIGN16        g_wDiagIndexChain[DIAG_INDEX_HASH_SIZE];
+static USIGN16        g_wDiagIndexUsed = 0;
+
+/* Diagnosis batch: while it is open, APP_EVENT_DIAG_CHANGED is raised by    */
+/* TPS_DiagBatchCommit() only. The changes are kept for the alarms.          */
+/*---------------------------------------------------------------------------*/
+static T_DIAG_BATCH_ENTRY g_zDiagBatch[DIAG_BATCH_SIZE];
+static USIGN16        g_wDiagBatchEntries    = 0;
+static USIGN16        g_wDiagBatchAlarmsSent = 0;
+static BOOL           g_bDiagBatchOpen       = TPS_FALSE;
+#endif
+
 static NRT_APP_CONFIG_HEAD *g_pzNrtConfigHeader = NULL; /*!< Pointer to the NRT area configuration header */
 static ALARM_MB            g_zAlarmMailbox[NR_ALARM_MAILBOXES] = {{0}}; /*!< Alarm mailbox array */
 
+#ifdef USE_ALARM_QUEUE
+/* Alarm queues, one ring per alarm mailbox (index as g_zAlarmMailbox).      */
+/*---------------------------------------------------------------------------*/
+#define ALARM_MAILBOX_NUMBER(dwAr, byPrio)  (USIGN8)(((dwAr) * 2) + (((byPrio) == ALARM_HIGH) ? 1 : 0))
+
+static T_ALARM_QUEUE_ENTRY      g_zAlarmQueue[NR_ALARM_MAILBOXES][ALARM_QUEUE_DEPTH];
+static USIGN8                   g_byAlarmQueueHead[NR_ALARM_MAILBOXES] = {0};
+static T_ALARM_QUEUE_STATISTICS g_zAlarmQueueStatistics[NR_ALARM_MAILBOXES];
+static USIGN32                  g_dwAlarmSentPolls[NR_ALARM_MAILBOXES] = {0};
+static USIGN32                  g_dwEventPolls = 0;   /* reads of the event register */
+#ifdef TPS_PROFILING
+static USIGN32                  g_dwAlarmSentCycles[NR_ALARM_MAILBOXES] = {0};
+#endif
+#endif
+
 /* Transmit Buffer for transferring MailBox data.                            */
 /*---------------------------------------------------------------------------*/
 static USIGN8 g_byTransmitBuffer[SIZE_RECORD_MB0] = {0};
 
+/* Decoded request header of each record mailbox. It is read by the record   */
+/* event and valid until TPS_RecordReadDone() / TPS_RecordWriteDone()        */
+/* (g_byRecordReqFlag = RECORD_FLAG_READ or RECORD_FLAG_WRITE, 0: not read). */
+/*---------------------------------------------------------------------------*/
+static RECORD_BOX_INFO g_zRecordReqHeader[MAX_NUMBER_RECORDS];
+static USIGN8          g_byRecordReqFlag[MAX_NUMBER_RECORDS] = {0};
+
+#ifdef USE_RECORD_REGISTRY
+/* Registered record handlers, sorted by API, slot, subslot and index, and   */
+/* the cache of their read responses.                                        */
+/*---------------------------------------------------------------------------*/
+static T_RECORD_HANDLER_ENTRY       g_zRecordRegistry[RECORD_REGISTRY_SIZE];
+static USIGN16                      g_wRecordRegistryUsed = 0;
+static USIGN8                       g_byRecordCache[RECORD_CACHE_SIZE];
+static USIGN16                      g_wRecordCacheUsed = 0;
+static T_RECORD_REGISTRY_STATISTICS g_zRecordRegistryStatistics = {0};
+#endif
+
+#ifdef USE_BUFFER_POOL
+/* Buffer pool: blocks of BUFFER_POOL_BLOCK_SIZE bytes, 32 bit aligned. Bit  */
+/* n of g_dwBufferPoolUsed is set while block n is in use.                   */
+/*---------------------------------------------------------------------------*/
+#define BUFFER_POOL_BLOCK_WORDS   ((BUFFER_POOL_BLOCK_SIZE + 3) / 4)
+
+static USIGN32                  g_dwBufferPool[BUFFER_POOL_BLOCKS][BUFFER_POOL_BLOCK_WORDS];
+static USIGN32                  g_dwBufferPoolUsed = 0;
+static T_BUFFER_POOL_STATISTICS g_zBufferPoolStatistics = {0};
+#endif
+
 /* Length of Output Data Buffer for AR                                       */
 /*---------------------------------------------------------------------------*/
 static USIGN8* g_pbyApduAddr[MAX_NUMBER_IOAR] = {0};
 
+/* Buffer change of the cyclic IO data. The TPS-1 has one request register, */
+/* so only one buffer change can be pending at a time.                       */
+/*---------------------------------------------------------------------------*/
+#define BUFFER_CHANGE_DIR(byCrType)   (((byCrType) == OUTPUT_USED) ? 1 : 0)
+
+static USIGN8  g_byBufferChangeState    = BUFFER_CHANGE_IDLE;
+static USIGN8  g_byBufferChangeAr       = 0;
+static USIGN8  g_byBufferChangeCrType   = 0;
+static USIGN32 g_dwBufferChangeRegValue = 0;
+static USIGN32 g_dwBufferChangePolls    = 0;
+static T_BUFFER_CHANGE_STATISTICS g_zBufferChangeStatistics[MAX_NUMBER_IOAR][2] = {{{0}}};
+
+/* With the alarm queue the alarm acknowledge handler refills the mailbox, */
+/* so its next acknowledge can arrive while the handler runs.                */
+/*---------------------------------------------------------------------------*/
+#ifdef USE_ALARM_QUEUE
+#define EVENT_ACK_ALARM            EVENT_ACK_BEFORE
+#else
+#define EVENT_ACK_ALARM            EVENT_ACK_AFTER
+#endif
+
+/* Handler table of the TPS events, index is the event bit (enum StackEvents) */
+/*---------------------------------------------------------------------------*/
+static const T_EVENT_HANDLER g_zEventHandler[NUMBER_OF_TPS_EVENTS] =
+{
+    { AppOnConnect_Done,            AR_0,              EVENT_ACK_AFTER  }, /*  0 TPS_EVENT_ONCONNECTDONE_IOAR0    */
+    { AppOnConnect_Done,            AR_1,              EVENT_ACK_AFTER  }, /*  1 TPS_EVENT_ONCONNECTDONE_IOAR1    */
+    { AppOnConnect_Done,            AR_IOSR,           EVENT_ACK_AFTER  }, /*  2 TPS_EVENT_ONCONNECTDONE_IOSAR    */
+    { AppOnPRMENDDone,              AR_0,              EVENT_ACK_AFTER  }, /*  3 TPS_EVENT_ON_PRM_END_DONE_IOAR0  */
+    { AppOnPRMENDDone,              AR_1,              EVENT_ACK_AFTER  }, /*  4 TPS_EVENT_ON_PRM_END_DONE_IOAR1  */
+    { AppOnPRMENDDone,              AR_IOSR,           EVENT_ACK_AFTER  }, /*  5 TPS_EVENT_ON_PRM_END_DONE_IOSAR  */
+    { AppOnAbort,                   AR_0,              EVENT_ACK_AFTER  }, /*  6 TPS_EVENT_ONABORT_IOAR0          */
+    { AppOnAbort,                   AR_1,              EVENT_ACK_AFTER  }, /*  7 TPS_EVENT_ONABORT_IOAR1          */
+    { AppOnAbort,                   AR_IOSR,           EVENT_ACK_AFTER  }, /*  8 TPS_EVENT_ONABORT_IOSAR          */
+    { AppEventReadRecord,           0,                 EVENT_ACK_BEFORE }, /*  9 TPS_EVENT_ONREADRECORD           */
+    { AppEventWriteRecord,          0,                 EVENT_ACK_BEFORE }, /* 10 TPS_EVENT_ONWRITERECORD          */
+    { AppEventAlarmAck,             0,                 EVENT_ACK_ALARM  }, /* 11 TPS_EVENT_ONALARM_ACK_0          */
+    { AppEventDiagAckn,             0,                 EVENT_ACK_AFTER  }, /* 12 TPS_EVENT_ONDIAG_ACK             */
+    { AppOnConnect,                 AR_0,              EVENT_ACK_AFTER  }, /* 13 TPS_EVENT_ONCONNECT_REQ_REC_0    */
+    { AppOnConnect,                 AR_1,              EVENT_ACK_AFTER  }, /* 14 TPS_EVENT_ONCONNECT_REQ_REC_1    */
+    { AppOnConnect,                 AR_IOSR,           EVENT_ACK_AFTER  }, /* 15 TPS_EVENT_ONCONNECT_REQ_REC_2    */
+    { AppEventSetStationName,       DCP_SET_TEMPORARY, EVENT_ACK_AFTER  }, /* 16 TPS_EVENT_ON_SET_DEVNAME_TEMP    */
+    { AppEventSetStationIpAddr,     DCP_SET_PERMANENT, EVENT_ACK_AFTER  }, /* 17 TPS_EVENT_ON_SET_IP_PERM         */
+    { AppEventSetStationIpAddr,     DCP_SET_TEMPORARY, EVENT_ACK_AFTER  }, /* 18 TPS_EVENT_ON_SET_IP_TEMP         */
+    { AppEventSetStationDcpSignal,  0,                 EVENT_ACK_AFTER  }, /* 19 TPS_EVENT_ONDCP_BLINK_START      */
+#ifndef USE_TPS1_TO_SAVE_IM_DATA
+    { AppEventResetFactorySettings, 0,                 EVENT_ACK_AFTER  }, /* 20 TPS_EVENT_ONDCP_RESET_TO_FACTORY */
+#else
+    /* acknowledged by TPS_ResetToFactory_Done()                             */
+    { AppEventResetFactorySettings, 0,                 EVENT_ACK_NONE   }, /* 20 TPS_EVENT_ONDCP_RESET_TO_FACTORY */
+#endif
+    { AppEventAlarmAck,             0,                 EVENT_ACK_ALARM  }, /* 21 TPS_EVENT_ONALARM_ACK_1          */
+    { AppEventTPSReset,             0,                 EVENT_ACK_AFTER  }, /* 22 TPS_EVENT_RESET                  */
+#ifdef USE_ETHERNET_INTERFACE
+    { AppEventEthernetReceive,      0,                 EVENT_ACK_BEFORE }, /* 23 TPS_EVENT_ETH_FRAME_REC          */
+#else
+    { NULL,                         0,                 EVENT_ACK_NONE   }, /* 23 TPS_EVENT_ETH_FRAME_REC          */
+#endif
+    { AppEventTPSMessageReceive,    0,                 EVENT_ACK_BEFORE }, /* 24 TPS_EVENT_TPS_MESSAGE            */
+    { NULL,                         0,                 EVENT_ACK_NONE   }, /* 25 */
+    { NULL,                         0,                 EVENT_ACK_NONE   }, /* 26 */
+    { AppEventTPSLedChanged,        0,                 EVENT_ACK_BEFORE }, /* 27 TPS_EVENT_ON_LED_STATE_CHANGE    */
+    { AppEventSetStationName,       DCP_SET_PERMANENT, EVENT_ACK_AFTER  }, /* 28 TPS_EVENT_ON_SET_DEVNAME_PERM    */
+    { AppEventFSUParameterChange,   0,                 EVENT_ACK_AFTER  }, /* 29 TPS_EVENT_ON_FSUDATA_CHANGE      */
+    { NULL,                         0,                 EVENT_ACK_NONE   }, /* 30 */
+    { NULL,                         0,                 EVENT_ACK_NONE   }  /* 31 */
+};
+
+/* Dispatch order of the events, the first mask is handled first.            */
+/*---------------------------------------------------------------------------*/
+static const USIGN32 g_adwEventPrioMask[] = { TPS_EVENT_PRIO_HIGH_MASK, 0xFFFFFFFF };
+
+#ifdef TPS_EVENT_IRQ_MODE
+/* Set by the host interrupt, cleared by TPS_DispatchEvents().               */
+/*---------------------------------------------------------------------------*/
+static volatile USIGN8 g_byEventIrqPending = TPS_FALSE;
+#endif
+
+#ifdef USE_IO_FRAME_IMAGE
+/* Host side images of the IO frames of each IO-AR.                          */
+/*---------------------------------------------------------------------------*/
+static T_IO_FRAME_IMAGE g_zIoFrameImage[MAX_NUMBER_IOAR] = {{0}};
+#endif
+
 #ifdef USE_TPS_COMMUNICATION_CHANNEL
 /* Variables for the internal communication interface.                       */
 /*---------------------------------------------------------------------------*/
@@ -176,6 +545,44 @@ static T_API_TPS_MSG_CTX   g_oApiTpsMsgContext = {0}; /* The callback function.
 /*---------------------------------------------------------------------------*/
 static T_ETHERNET_MAILBOX* g_poEthernetRXMailbox = NULL; /*!< ethernet mailbox stack --> app */
 static T_ETHERNET_MAILBOX* g_poEthernetTXMailbox = NULL; /*!< ethernet mailbox app --> stack */
+
+/* Frame written in fragments by TPS_SendEthernetFrameFragmented(), one per  */
+/* TX mailbox: 0 ethernet, 1 TPS communication channel (PORT_NR_INTERNAL).   */
+/*---------------------------------------------------------------------------*/
+#define ETH_TX_MAILBOXES            2
+#define ETH_TX_MAILBOX(wPortNr)     (((wPortNr) == PORT_NR_INTERNAL) ? 1 : 0)
+
+static USIGN8*  g_pbyEthTxPendingFrame[ETH_TX_MAILBOXES] = {NULL, NULL};
+static USIGN16  g_wEthTxBytesSent[ETH_TX_MAILBOXES] = {0, 0};
+#endif
+
+#ifdef USE_ETHERNET_TX_QUEUE
+/* TX queues of TPS_QueueEthernetFrame(), ring buffers per TX mailbox. The   */
+/* frames of a queue are kept in one piece in its byte ring, a frame that    */
+/* does not fit behind the last one starts at offset 0.                      */
+/*---------------------------------------------------------------------------*/
+static T_ETH_TX_QUEUE_ENTRY      g_zEthTxQueue[ETH_TX_QUEUES][ETH_TX_QUEUE_DEPTH];
+static USIGN8                    g_byEthTxRing[ETH_TX_QUEUES][ETH_TX_QUEUE_SIZE];
+static USIGN16                   g_wEthTxRingTail[ETH_TX_QUEUES] = {0};
+static USIGN8                    g_byEthTxQueueHead[ETH_TX_QUEUES] = {0};
+static USIGN8                    g_byEthTxQueueCount[ETH_TX_QUEUES] = {0};
+static USIGN8                    g_byEthTxNextQueue = 0;
+static USIGN32                   g_dwEthTxServiceCalls = 0;
+static T_ETH_TX_QUEUE_STATISTICS g_zEthTxQueueStatistics[ETH_TX_QUEUES];
+#endif
+
+#ifdef USE_ETHERNET_RX_FILTER
+/* Ethernet receive filter: the rules, the header of the current frame and   */
+/* the interface MAC of the TPS-1, read once and kept until a TPS-1 reset.   */
+/*---------------------------------------------------------------------------*/
+#define ETH_RX_PEEK_SIZE  (8 + 2 * MAC_ADDRESS_SIZE + ETH_VLAN_TAG_SIZE + 2)
+
+static T_ETH_RX_FILTER_RULE       g_zEthRxFilterRules[ETH_RX_FILTER_RULES];
+static USIGN8                     g_byEthRxFilterRulesUsed = 0;
+static T_ETH_RX_HEADER            g_zEthRxHeader;
+static USIGN8                     g_byEthRxOwnMac[MAC_ADDRESS_SIZE];
+static BOOL                       g_bEthRxOwnMacValid = TPS_FALSE;
+static T_ETH_RX_FILTER_STATISTICS g_zEthRxFilterStatistics = {0};
 #endif
 
 #if defined(USE_TPS_COMMUNICATION_CHANNEL) && !defined(USE_ETHERNET_INTERFACE)
@@ -193,65 +600,50 @@ static T_ETHERNET_MAILBOX* g_poEthernetTXMailbox = NULL; /*!< ethernet mailbox a
 #if USED_NUMBER_SUBSLOT > MAX_NUMBER_SUBSLOT
 #error "Invalid number of subslots!"
 #endif
+#if defined(USE_IO_FRAME_IMAGE) && !defined(USE_SUBSLOT_IO_CACHE)
+#error "The IO frame image needs the subslot IO cache (USE_SUBSLOT_IO_CACHE)!"
+#endif
+#if defined(USE_DIAG_INDEX) && (((DIAG_INDEX_HASH_SIZE & (DIAG_INDEX_HASH_SIZE - 1)) != 0) || (DIAG_INDEX_SIZE >= DIAG_INDEX_END))
+#error "DIAG_INDEX_HASH_SIZE must be a power of two and DIAG_INDEX_SIZE less than 0xFFFF!"
+#endif
+#if defined(USE_HANDLE_INDEX) && ((HANDLE_INDEX_SIZE < 2 * (USED_NUMBER_SLOT + USED_NUMBER_SUBSLOT)) || \
+                                  ((HANDLE_INDEX_SIZE & (HANDLE_INDEX_SIZE - 1)) != 0))
+#error "HANDLE_INDEX_SIZE must be a power of two and at least 2 * (USED_NUMBER_SLOT + USED_NUMBER_SUBSLOT)!"
+#endif
+#if defined(USE_ETHERNET_TX_QUEUE) && ((ETH_TX_QUEUE_SIZE <= MAX_LEN_ETHERNET_FRAME) || (ETH_TX_QUEUE_SIZE > 0xFFFF))
+#error "ETH_TX_QUEUE_SIZE must be larger than MAX_LEN_ETHERNET_FRAME and less than 0x10000!"
+#endif
+#if defined(USE_BUFFER_POOL) && ((BUFFER_POOL_BLOCKS < 1) || (BUFFER_POOL_BLOCKS > 32))
+#error "BUFFER_POOL_BLOCKS must be between 1 and 32!"
+#endif
 
-/* Local malloc function; should be replaced by a library function           */
-/* if necessary.                                                            */
+/* Typed object pools of the API, slot and subslot handles. The indices of */
+/* the free objects of a pool are kept on a stack, so an object is          */
+/* allocated and freed in O(1). Each pool only holds objects of its type.   */
 /*---------------------------------------------------------------------------*/
-#ifdef PRIVATE_MALLOC
-
-static USIGN16     g_wCurrentApi    = 0;
-static USIGN16     g_wCurrentSlot   = 0;
-static USIGN16     g_wCurrentSubslot  = 0;
-
-USIGN32* lib_malloc(USIGN32 dwSize)
-{
-    static API_LIST    zApiList[USED_NUMBER_OF_API]       = {{0}};
-    static SLOT        zSlotList[USED_NUMBER_SLOT]        = {{0}};
-    static SUBSLOT     zSubslotList[USED_NUMBER_SUBSLOT]  = {{0}};
-
-    USIGN32 *pdwRetval = NULL;
-
-    switch(dwSize)
-    {
-        case (sizeof(API_LIST)):
-            if(g_wCurrentApi < USED_NUMBER_OF_API)
-            {
-                pdwRetval = (USIGN32*)&zApiList[g_wCurrentApi];
-                g_wCurrentApi++;
-            }
-            break;
-
-        case (sizeof(SLOT)):
-            if(g_wCurrentSlot < USED_NUMBER_SLOT)
-            {
-                pdwRetval = (USIGN32*)&zSlotList[g_wCurrentSlot];
-                g_wCurrentSlot++;
-            }
-            break;
-
-        case (sizeof(SUBSLOT)):
-            if(g_wCurrentSubslot < USED_NUMBER_SUBSLOT)
-            {
-                pdwRetval = (USIGN32*)&zSubslotList[g_wCurrentSubslot];
-                g_wCurrentSubslot++;
-            }
-            break;
-
-        default:
-            break;
-    }
-
-    return pdwRetval;
-}
-
-VOID lib_reset_malloc(VOID)
-{
-    g_wCurrentApi    = 0;
-    g_wCurrentSlot   = 0;
-    g_wCurrentSubslot  = 0;
-}
-
-#endif /* end of define PRIVATE_MALLOC */
+static API_LIST      g_zApiListObjects[USED_NUMBER_OF_API];
+static SLOT          g_zSlotObjects[USED_NUMBER_SLOT];
+static SUBSLOT       g_zSubslotObjects[USED_NUMBER_SUBSLOT];
+static USIGN16       g_wApiListFree[USED_NUMBER_OF_API];
+static USIGN16       g_wSlotFree[USED_NUMBER_SLOT];
+static USIGN16       g_wSubslotFree[USED_NUMBER_SUBSLOT];
+static BOOL          g_bApiListUsed[USED_NUMBER_OF_API];
+static BOOL          g_bSlotUsed[USED_NUMBER_SLOT];
+static BOOL          g_bSubslotUsed[USED_NUMBER_SUBSLOT];
+
+static T_OBJECT_POOL g_zObjectPool[OBJECT_POOL_NUMBER] =
+{
+    { (USIGN8*)g_zApiListObjects, sizeof(API_LIST), g_wApiListFree, g_bApiListUsed, 0, { USED_NUMBER_OF_API,  0, 0, 0, 0, 0 } },
+    { (USIGN8*)g_zSlotObjects,    sizeof(SLOT),     g_wSlotFree,    g_bSlotUsed,    0, { USED_NUMBER_SLOT,    0, 0, 0, 0, 0 } },
+    { (USIGN8*)g_zSubslotObjects, sizeof(SUBSLOT),  g_wSubslotFree, g_bSubslotUsed, 0, { USED_NUMBER_SUBSLOT, 0, 0, 0, 0, 0 } }
+};
+
+#ifdef USE_HANDLE_INDEX
+/* Hash index (API, slot, subslot number) -> handle with linear probing.    */
+/* Entries are only added, the index is cleared together with the handles. */
+/*---------------------------------------------------------------------------*/
+static T_HANDLE_INDEX_ENTRY g_zHandleIndex[HANDLE_INDEX_SIZE];
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* Functions                                                                 */
@@ -296,6 +688,56 @@ USIGN32 TPS_InitApplicationInterface (VOID)
 #ifdef DIAGNOSIS_ENABLE
      g_wNumberOfDiagEntries = 0;
 #endif
+#ifdef USE_DIAG_INDEX
+     g_wDiagIndexUsed = 0;
+     memset(g_wDiagIndexChain, 0xFF, sizeof(g_wDiagIndexChain));
+     g_wDiagBatchEntries = 0;
+     g_bDiagBatchOpen = TPS_FALSE;
+#endif
+     memset(g_byRecordReqFlag, 0, sizeof(g_byRecordReqFlag));
+#ifdef USE_RECORD_REGISTRY
+     g_wRecordRegistryUsed = 0;
+     g_wRecordCacheUsed = 0;
+     memset(&g_zRecordRegistryStatistics, 0, sizeof(g_zRecordRegistryStatistics));
+#endif
+#ifdef USE_ETHERNET_TX_QUEUE
+     AppEthTxQueueFlush();
+     g_byEthTxNextQueue = 0;
+     g_dwEthTxServiceCalls = 0;
+     memset(g_zEthTxQueueStatistics, 0, sizeof(g_zEthTxQueueStatistics));
+#endif
+     AppObjectPoolReset(&g_zObjectPool[OBJECT_POOL_API_LIST]);
+     AppObjectPoolReset(&g_zObjectPool[OBJECT_POOL_SLOT]);
+     AppObjectPoolReset(&g_zObjectPool[OBJECT_POOL_SUBSLOT]);
+#ifdef USE_HANDLE_INDEX
+     memset(g_zHandleIndex, 0, sizeof(g_zHandleIndex));
+#endif
+#ifdef USE_BUFFER_POOL
+     g_dwBufferPoolUsed = 0;
+     memset(&g_zBufferPoolStatistics, 0, sizeof(g_zBufferPoolStatistics));
+#endif
+#ifdef USE_CONFIG_IMAGE
+     g_pbyConfigImageRuns = NULL;
+     g_pbyConfigImageRun = NULL;
+     g_dwConfigImageRunStart = 0;
+     memset(&g_zConfigImageStatistics, 0, sizeof(g_zConfigImageStatistics));
+     memset(g_zConfigImagePending, 0, sizeof(g_zConfigImagePending));
+     TPS_ConfigImageReplay(TPS_FALSE);
+#endif
+#ifdef USE_ETHERNET_INTERFACE
+     memset(g_pbyEthTxPendingFrame, 0, sizeof(g_pbyEthTxPendingFrame));
+     memset(g_wEthTxBytesSent, 0, sizeof(g_wEthTxBytesSent));
+#endif
+#ifdef USE_ETHERNET_RX_FILTER
+     g_byEthRxFilterRulesUsed = 0;
+     g_bEthRxOwnMacValid = TPS_FALSE;
+     memset(&g_zEthRxHeader, 0, sizeof(g_zEthRxHeader));
+     memset(&g_zEthRxFilterStatistics, 0, sizeof(g_zEthRxFilterStatistics));
+#endif
+#ifdef USE_ALARM_QUEUE
+     memset(g_byAlarmQueueHead, 0, sizeof(g_byAlarmQueueHead));
+     memset(g_zAlarmQueueStatistics, 0, sizeof(g_zAlarmQueueStatistics));
+#endif
 
     /* Init the context management -> api list                               */
     /*-----------------------------------------------------------------------*/
@@ -604,7 +1046,7 @@ API_LIST* TPS_AddAPI(USIGN32 dwApi)
     {
         /* Create the "api_list" structure.                                */
         /*-----------------------------------------------------------------*/
-        g_zApiARContext.api_list = (API_LIST*)(t_malloc(sizeof(API_LIST)));
+        g_zApiARContext.api_list = (API_LIST*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_API_LIST]);
 
         if(g_zApiARContext.api_list == NULL)
         {
@@ -625,7 +1067,7 @@ API_LIST* TPS_AddAPI(USIGN32 dwApi)
         /* Jump to the end of the list!                                    */
         /*-----------------------------------------------------------------*/
         };
-        pzApiList->next = (API_LIST*)(t_malloc(sizeof(API_LIST)));
+        pzApiList->next = (API_LIST*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_API_LIST]);
         pzApiList = pzApiList->next;
     }
 
@@ -683,6 +1125,14 @@ USIGN32 TPS_StartDevice (VOID)
     /*------------------------------------------------------------------------*/
     if(g_byApiState == byCorrectApiState)
     {
+#ifdef USE_CONFIG_IMAGE
+        /* End of the replay: the configuration has to end with the image.   */
+        /*-------------------------------------------------------------------*/
+        if(g_zConfigImageStatistics.byState == CONFIG_IMAGE_REPLAY)
+        {
+            AppConfigImageEnd(TPS_FALSE);
+        }
+#endif
         TPS_SetValue32((USIGN8*)(&g_pzNrtConfigHeader->dwNrtMemSize), 0x00000000);
         AppSetEventRegApp(APP_EVENT_CONFIG_FINISHED);
 
@@ -712,2886 +1162,5010 @@ USIGN32 TPS_StartDevice (VOID)
     return (TPS_ACTION_OK);
 }
 
+#ifdef USE_CONFIG_IMAGE
 /*!
- * \brief       This function adds a new module (slot) to the configuration.
+ * \brief       Checksum of the run records of a configuration image.
  *
- * \param[in]   pzApi handle to the API of this module. The handle is returned by TPS_AddApi()
- * \param[in]   wSlotNumber the slot number to add
- * \param[in]   dwModuleIdentNumber the module ID of the slot
- * \retval      SLOT* a valid slot handle of the new plugged module or NULL in case of an error
- * \note        Do not change this function!
-*/
-SLOT* TPS_PlugModule (API_LIST* pzApi, USIGN16 wSlotNumber, USIGN32 dwModuleIdentNumber)
+ * \param[in]   pbyData run records
+ * \param[in]   dwLength length of the run records
+ * \retval      USIGN32 checksum
+ */
+static USIGN32 AppConfigImageChecksum(const USIGN8* pbyData, USIGN32 dwLength)
 {
-    SLOT*   pzSlot = NULL;
-    USIGN32 dwDataLength = 0;
-    USIGN16 wReturnData  = 0;
+    USIGN32 dwChecksum = 0;
 
-    /* Check the correct state!                                              */
-    /*-----------------------------------------------------------------------*/
-    if((g_byApiState != STATE_API_RDY) && (g_byApiState != STATE_SUBSLOT_RDY) && (g_byApiState != STATE_SLOT_RDY))
+    while(dwLength > 0)
     {
-        AppSetLastError(TPS_ERROR_WRONG_API_STATE);
-        return NULL;
+        dwChecksum = ((dwChecksum << 1) | (dwChecksum >> 31)) + *pbyData;
+        pbyData++;
+        dwLength--;
     }
 
-    /* Check validity of dwModuleIdentNumber                                 */
-    /* ModuleID 0x00 is reserved for autoconfiguration.                      */
-    /*-----------------------------------------------------------------------*/
-    if(dwModuleIdentNumber == AUTOCONF_MODULE)
-    {
-        #ifndef USE_AUTOCONF_MODULE
-            AppSetLastError(PLUGMODULE_INVALID_MODULE_ID);
-            return NULL;
-        #endif
+    return dwChecksum;
+}
 
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugModule() > Configuring slot 0x%X for autoconfiguration.\n", wSlotNumber);
-        #endif
-    }
+/*!
+ * \brief       Walks the loaded image from DPRAM offset dwOffset (relative to
+ *              the start of the image) over dwLength bytes. With pbyRead the
+ *              bytes are copied, otherwise they are compared with pbyData or,
+ *              if pbyData is NULL, with byFill. The range has to be inside
+ *              the image.
+ *
+ * \param[in]   dwOffset offset in the image
+ * \param[in]   pbyData data to compare or NULL
+ * \param[in]   byFill value to compare if pbyData is NULL
+ * \param[out]  pbyRead buffer for the image bytes or NULL
+ * \param[in]   dwLength number of bytes
+ * \retval      BOOL TPS_FALSE if a byte differs from the image
+ */
+static BOOL AppConfigImageAccess(USIGN32 dwOffset, const USIGN8* pbyData, USIGN8 byFill, USIGN8* pbyRead, USIGN32 dwLength)
+{
+    USIGN16 wHead;
+    USIGN32 dwCount;
+    USIGN32 dwPosition;
+    USIGN8  byImage;
 
-    /* Check parameter!                                                      */
+    /* The cached run is behind the access: start again at the first run.    */
     /*-----------------------------------------------------------------------*/
-    if(pzApi == NULL)
+    if(dwOffset < g_dwConfigImageRunStart)
     {
-        AppSetLastError(TPS_ERROR_NULL_POINTER);
-        return NULL;
+        g_pbyConfigImageRun = g_pbyConfigImageRuns;
+        g_dwConfigImageRunStart = 0;
     }
 
-    /* Check if this slot number doesn't exist already.                      */
-    /*-----------------------------------------------------------------------*/
-    pzSlot = AppGetSlotHandle(pzApi->index, wSlotNumber);
-    #ifdef DEBUG_API_PLUG_MODULE
-        printf("DEBUG_API > API: TPS_PlugModule() Checking if a module with the same number exists (Should not happen).\n");
-    #endif
-    if(pzSlot != NULL)
+    while(dwLength > 0)
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugModule() > A module with the same number exists.\n");
-        #endif
-        AppSetLastError(PLUGMODULE_SLOT_ALREADY_EXISTS);
-        return (NULL);
-    }
+        wHead = (USIGN16)(g_pbyConfigImageRun[0] | (g_pbyConfigImageRun[1] << 8));
+        dwCount = wHead & CONFIG_IMAGE_RUN_COUNT;
+
+        if(dwOffset >= (g_dwConfigImageRunStart + dwCount))
+        {
+            /* next run */
+            g_pbyConfigImageRun += CONFIG_IMAGE_RUN_HEAD_SIZE;
+            if((wHead & CONFIG_IMAGE_ZERO_RUN) == 0)
+            {
+                g_pbyConfigImageRun += dwCount;
+            }
+            g_dwConfigImageRunStart += dwCount;
+            continue;
+        }
 
+        for(dwPosition = dwOffset - g_dwConfigImageRunStart; (dwPosition < dwCount) && (dwLength > 0); dwPosition++)
+        {
+            byImage = 0x00;
+            if((wHead & CONFIG_IMAGE_ZERO_RUN) == 0)
+            {
+                byImage = g_pbyConfigImageRun[CONFIG_IMAGE_RUN_HEAD_SIZE + dwPosition];
+            }
 
-    /* Check memory space before adding a slot.                              */
-    /*-----------------------------------------------------------------------*/
-    dwDataLength = sizeof(wSlotNumber) +
-                   sizeof(dwModuleIdentNumber) +
-                   sizeof(USIGN16);
+            if(pbyRead != NULL)
+            {
+                *pbyRead++ = byImage;
+            }
+            else if(byImage != ((pbyData != NULL) ? *pbyData++ : byFill))
+            {
+                return TPS_FALSE;
+            }
+            dwOffset++;
+            dwLength--;
+        }
+    }
 
-    if ( (USIGN32)(g_pbyCurrentPointer + dwDataLength - g_pbyConfigNRTMem) > g_dwConfigNRTMemSize )
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       Checks if the configuration written so far ends with the
+ *              loaded image and all its writes are found in the image.
+ *
+ * \retval      BOOL TPS_TRUE if the configuration equals the image
+ */
+static BOOL AppConfigImageComplete(VOID)
+{
+    if((USIGN32)g_pbyCurrentPointer != (g_zConfigImageHeader.dwStart + g_zConfigImageHeader.dwLength))
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugModule() > Not enough space for data!\n");
-        #endif
-        AppSetLastError(PLUGMODULE_OUT_OF_MEMORY);
-        return (NULL);
+        return TPS_FALSE;
     }
 
-    /* Add the slot to the API_AR_CTX structure (ar context)                 */
-    /*-----------------------------------------------------------------------*/
-    if(pzApi->firstslot == NULL)
+    if(AppConfigImageFindPending(g_zConfigImageHeader.dwStart, g_zConfigImageHeader.dwLength) != CONFIG_IMAGE_PENDING_BYTES)
     {
-        pzApi->firstslot = (SLOT*)(t_malloc(sizeof(SLOT)));
-        pzSlot = pzApi->firstslot;
+        return TPS_FALSE;
     }
-    else
+
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       Ends the replay of the image: the pending bytes are sent,
+ *              all further accesses go to the DPRAM.
+ *
+ * \param[in]   bMismatch TPS_TRUE if an access of the configuration does not
+ *              fit to the image
+ * \retval      VOID
+ */
+static VOID AppConfigImageEnd(BOOL bMismatch)
+{
+    USIGN32 dwIndex;
+
+    g_zConfigImageStatistics.byState = ((bMismatch == TPS_FALSE) && (AppConfigImageComplete() == TPS_TRUE)) ?
+                                       CONFIG_IMAGE_REPLAYED : CONFIG_IMAGE_MISMATCH;
+    TPS_ConfigImageReplay(TPS_FALSE);
+
+    for(dwIndex = 0; dwIndex < CONFIG_IMAGE_PENDING_BYTES; dwIndex++)
     {
-        for(pzSlot = pzApi->firstslot;
-            pzSlot->pNextSlot != NULL;
-            pzSlot = pzSlot->pNextSlot)
+        if(g_zConfigImagePending[dwIndex].bUsed == TPS_TRUE)
         {
-            /* Jump to the end of the list                                   */
-            /*---------------------------------------------------------------*/
-        };
-        pzSlot->pNextSlot = (SLOT*)(t_malloc(sizeof(SLOT)));
-        pzSlot = pzSlot->pNextSlot;
+            TPS_SetValue8((USIGN8*)g_zConfigImagePending[dwIndex].dwAddress, g_zConfigImagePending[dwIndex].byValue);
+            g_zConfigImagePending[dwIndex].bUsed = TPS_FALSE;
+        }
     }
+}
 
-    /* Check the generated slot handle                                      */
-    /*----------------------------------------------------------------------*/
-    if(pzSlot == NULL)
+/*!
+ * \brief       Searches a pending byte in the given range.
+ *
+ * \param[in]   dwAddress DPRAM address
+ * \param[in]   dwLength number of bytes
+ * \retval      USIGN32 index of the pending byte or CONFIG_IMAGE_PENDING_BYTES
+ */
+static USIGN32 AppConfigImageFindPending(USIGN32 dwAddress, USIGN32 dwLength)
+{
+    USIGN32 dwIndex;
+
+    for(dwIndex = 0; dwIndex < CONFIG_IMAGE_PENDING_BYTES; dwIndex++)
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugModule() > Can not allocate Slot_Handle!\n");
-        #endif
-        AppSetLastError(PLUGMODULE_INVALID_SLOT_HANDLE);
-        return (NULL);
+        if((g_zConfigImagePending[dwIndex].bUsed == TPS_TRUE) &&
+           (g_zConfigImagePending[dwIndex].dwAddress >= dwAddress) &&
+           (g_zConfigImagePending[dwIndex].dwAddress < (dwAddress + dwLength)))
+        {
+            break;
+        }
     }
 
-    /* Configure the slot data                                              */
-    /*----------------------------------------------------------------------*/
-    pzSlot->poApi = pzApi;
-    pzSlot->pNextSlot = NULL;
-    pzSlot->pSubslot  = NULL;
-    pzSlot->wProperties = MODULE_NOT_PULLED;
+    return dwIndex;
+}
 
-/*
-      Structure inside the DPRAM :
-      +--------------------------+
-      +    Slot_Number (16)      +
-      +--------------------------+
-      +  ModuleIdent_Number (32) +
-      +--------------------------+
-      +    Number_of_Submodules (16)  +
-      +--------------------------+
-*/
-    /* Set the slot number  .                                                */
-    /*-----------------------------------------------------------------------*/
-    TPS_SetValue16(g_pbyCurrentPointer, wSlotNumber);
-    pzSlot->pt_slot_number = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += sizeof(wSlotNumber);
-
-    /* Set the module ID                                                     */
-    /*-----------------------------------------------------------------------*/
-    TPS_SetValue32(g_pbyCurrentPointer, dwModuleIdentNumber);
-    pzSlot->pt_ident_number = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += sizeof(dwModuleIdentNumber);
-
-    /* Increment g_pwNumberOfSlots (global slot counter)                     */
-    /*-----------------------------------------------------------------------*/
-    TPS_GetValue16((USIGN8*)g_pwNumberOfSlots, &wReturnData);
-    wReturnData++;
-    TPS_SetValue16((USIGN8*)g_pwNumberOfSlots, wReturnData);
+/*!
+ * \brief       Updates the pending byte of a written DPRAM byte: a byte equal
+ *              to the image is not pending any longer, a different one is
+ *              kept.
+ *
+ * \param[in]   dwAddress DPRAM address
+ * \param[in]   byValue written value
+ * \param[in]   bEqual TPS_TRUE if byValue is the value of the image
+ * \retval      BOOL TPS_FALSE if there is no free entry for the byte
+ */
+static BOOL AppConfigImageSetPending(USIGN32 dwAddress, USIGN8 byValue, BOOL bEqual)
+{
+    USIGN32 dwIndex;
+    USIGN32 dwFree = CONFIG_IMAGE_PENDING_BYTES;
 
-    /* initialize number of subslots */
-    TPS_SetValue16(g_pbyCurrentPointer, 0x0000);
-    pzSlot->pt_number_of_subslot = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += sizeof(USIGN16);
+    for(dwIndex = 0; dwIndex < CONFIG_IMAGE_PENDING_BYTES; dwIndex++)
+    {
+        if(g_zConfigImagePending[dwIndex].bUsed != TPS_TRUE)
+        {
+            dwFree = dwIndex;
+        }
+        else if(g_zConfigImagePending[dwIndex].dwAddress == dwAddress)
+        {
+            break;
+        }
+    }
 
-    /* Initialize the "Module State"  (Slot data)                            */
-    /*-----------------------------------------------------------------------*/
-    TPS_SetValue16(g_pbyCurrentPointer, PROPER_MODULE);
-    pzSlot->pt_module_state = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += sizeof(USIGN16);
+    if(bEqual == TPS_TRUE)
+    {
+        if(dwIndex != CONFIG_IMAGE_PENDING_BYTES)
+        {
+            g_zConfigImagePending[dwIndex].bUsed = TPS_FALSE;
+        }
+        return TPS_TRUE;
+    }
 
-    #ifdef DEBUG_API_PLUG_MODULE
-        printf("DEBUG_API > API: TPS_PlugModule() > Module %x plugged!\n",wSlotNumber);
-        TPS_GetValue16((USIGN8*)g_pwNumberOfSlots,&wReturnData);
-        printf("DEBUG_API > API: TPS_PlugModule() > Number of Modules : 0x%X \n", (USIGN32)wReturnData);
-        printf("DEBUG_API > API: TPS_PlugModule() > Current Memory Pointer: 0x%X\n", (USIGN32)g_pbyCurrentPointer);
-    #endif
+    if(dwIndex == CONFIG_IMAGE_PENDING_BYTES)
+    {
+        if(dwFree == CONFIG_IMAGE_PENDING_BYTES)
+        {
+            return TPS_FALSE;
+        }
+        dwIndex = dwFree;
+        g_zConfigImagePending[dwIndex].dwAddress = dwAddress;
+        g_zConfigImagePending[dwIndex].bUsed = TPS_TRUE;
+    }
+    g_zConfigImagePending[dwIndex].byValue = byValue;
 
-    g_byApiState = STATE_SLOT_RDY;
-    return (pzSlot);
+    return TPS_TRUE;
 }
 
 /*!
-* \brief       This function adds a submodule (subslot) to a slot. The
-*              parameter pzSlotHandle points to the associated slot.
-*
-* \param[in]   pzSlotHandle handle of the slot
-* \param[in]   wSubslotNumber the subslot number to add
-* \param[in]   wSubmoduleIdentNumber the submodule ID. Use AUTOCONF_MODULE if this submodule should be later adapted to the expected configuration.
-* \param[in]   wInitParameterSize <b>Legacy:</b> the maximum size of initial parameters that can be received for this subslot
-*              <br>the size is calculated as follows:
-*                  size for Index (2 bytes) + size for the data length (4 bytes) + size of the record data.<br>
-*              <b>New Parameterization Handling:</b> Set this parameter 0. This saves memory in the NRT area and streamlines
-*              the record write handling but might slow down the connect time a bit.<br>
-*               Each Parameter that is sent on connect time triggers a record write event
-*              that calls the registered onRecordWrite callback in your application.
-* \param[in]   wNumberOfChannelDiag maximum number of diagnostic channels that the application can register for this submodule.
-* \param[in]   wSizeOfInputData Size of the cyclic input data of this submodule.
-<br>If wSubmoduleIdentNumber = AUTOCONF_MODULE this value is not used but later defined by the expected configuration.
-* \param[in]   wSizeOfOutputData Size of the cyclic output data of this submodule.
-<br>If wSubmoduleIdentNumber = AUTOCONF_MODULE this value is not used but later defined by the expected configuration.
-* \param[in]   pzIM0Data pointer to the I&M0 data structure for this subslot. Each subslot must have at least I&M0 data.
-* \param[in]   bIM0Carrier flag if this subslot is a I&M carrier (TPS_TRUE) or not (TPS_FALSE).
-*              Slot 0 / subslot 1 (DAP) must be a carrier. Each new carrier should contain different I&M data than the DAP.
-* \retval      SUBSLOT* a valid subslot handle of the new plugged subslot or NULL in case of an error
-*/
-SUBSLOT* TPS_PlugSubmodule(SLOT*       pzSlotHandle,
-                           USIGN16     wSubslotNumber,
-                           USIGN32     dwSubmoduleIdentNumber,
-                           USIGN16     wInitParameterSize,
-                           USIGN16     wNumberOfChannelDiag,
-                           USIGN16     wSizeOfInputData,
-                           USIGN16     wSizeOfOutputData,
-                           T_IM0_DATA* pzIM0Data,
-                           BOOL        bIM0Carrier)
+ * \brief       Writes the head of the open data run of the encoder.
+ *
+ * \param[in]   pzEncoder run encoder
+ * \retval      VOID
+ */
+static VOID AppConfigImageCloseRun(T_CONFIG_IMAGE_ENCODER* pzEncoder)
 {
-    API_LIST* pzApi = NULL;
-    SLOT*     pzTempSlot = NULL;
-    SUBSLOT*  pzSubslot = NULL;
-
-    USIGN32   dwMemSizeSubModule = 0;
-    USIGN32   dwApiNr = 0;
-    USIGN16   wSlotNumber = 0;
-    USIGN16   wNumberOfSubslots = 0;
-    USIGN16*  pwSubslotNumberLocal = NULL;
-    USIGN32   dwReg = 0;
-    BOOL      bApiFound = TPS_FALSE;
-
-    /* Check the correct state!                                            */
-    /*---------------------------------------------------------------------*/
-    if((g_byApiState != STATE_SLOT_RDY) && (g_byApiState != STATE_SUBSLOT_RDY))
+    if(pzEncoder->pbyDataRun != NULL)
     {
-        AppSetLastError(TPS_ERROR_WRONG_API_STATE);
-        return NULL;
+        pzEncoder->pbyDataRun[0] = (USIGN8)(pzEncoder->dwDataCount);
+        pzEncoder->pbyDataRun[1] = (USIGN8)(pzEncoder->dwDataCount >> 8);
+        pzEncoder->pbyDataRun = NULL;
+        pzEncoder->dwDataCount = 0;
     }
+}
 
-    /* Check the for nullpointer!                                          */
-    /*---------------------------------------------------------------------*/
-    if(pzSlotHandle == NULL)
+/*!
+ * \brief       Adds a byte to the open data run of the encoder. A new data
+ *              run is started if there is none or the open one has the
+ *              maximum length of a SPI burst.
+ *
+ * \param[in]   pzEncoder run encoder
+ * \param[in]   byValue the byte
+ * \retval      BOOL TPS_FALSE if the image buffer is full
+ */
+static BOOL AppConfigImagePutData(T_CONFIG_IMAGE_ENCODER* pzEncoder, USIGN8 byValue)
+{
+    if(pzEncoder->dwDataCount == CONFIG_IMAGE_MAX_DATA_RUN)
     {
-        AppSetLastError(TPS_ERROR_NULL_POINTER);
-        return NULL;
+        AppConfigImageCloseRun(pzEncoder);
     }
 
-    /* Check the correct ident number!                                       */
-    /* SubmoduleID 0x00 is reserved for autoconfiguration.                      */
-    /*-----------------------------------------------------------------------*/
-    if(dwSubmoduleIdentNumber == AUTOCONF_MODULE)
+    if(pzEncoder->pbyDataRun == NULL)
     {
-        #ifndef USE_AUTOCONF_MODULE
-            AppSetLastError(PLUG_SUB_INVALID_SUBMODULE_ID);
-            return NULL;
-        #endif
+        if((pzEncoder->pbyOut + CONFIG_IMAGE_RUN_HEAD_SIZE) >= pzEncoder->pbyEnd)
+        {
+            return TPS_FALSE;
+        }
+        pzEncoder->pbyDataRun = pzEncoder->pbyOut;
+        pzEncoder->pbyOut += CONFIG_IMAGE_RUN_HEAD_SIZE;
+    }
 
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubodule() > Configuring subslot 0x%X for autoconfiguration.\n", wSubslotNumber);
-        #endif
+    if(pzEncoder->pbyOut >= pzEncoder->pbyEnd)
+    {
+        return TPS_FALSE;
     }
+    *pzEncoder->pbyOut++ = byValue;
+    pzEncoder->dwDataCount++;
 
-    /* Check if this subslot number doesn't already exists.                   */
-    /*-----------------------------------------------------------------------*/
-    /* Look for the API in which this slot is plugged. */
-    if(g_zApiARContext.api_list != NULL)
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       Encodes the pending zero bytes of the encoder: as zero run if
+ *              there are at least CONFIG_IMAGE_MIN_ZERO_RUN, else as part of
+ *              the data run.
+ *
+ * \param[in]   pzEncoder run encoder
+ * \retval      BOOL TPS_FALSE if the image buffer is full
+ */
+static BOOL AppConfigImagePutZeros(T_CONFIG_IMAGE_ENCODER* pzEncoder)
+{
+    if(pzEncoder->dwZeros >= CONFIG_IMAGE_MIN_ZERO_RUN)
     {
-        for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+        AppConfigImageCloseRun(pzEncoder);
+
+        if((pzEncoder->pbyOut + CONFIG_IMAGE_RUN_HEAD_SIZE) > pzEncoder->pbyEnd)
         {
-            /* Search the API List for the given Slot to find the correct API Number. */
-            for(pzTempSlot = pzApi->firstslot;
-                pzTempSlot != NULL;
-                pzTempSlot = pzTempSlot->pNextSlot)
-            {
-                if(pzTempSlot == pzSlotHandle)
-                {
-                    /* Slot found, store API Number. */
-                    dwApiNr = pzApi->index;
-                    bApiFound = TPS_TRUE;
-                }
-            }
+            return TPS_FALSE;
         }
+        pzEncoder->pbyOut[0] = (USIGN8)(pzEncoder->dwZeros);
+        pzEncoder->pbyOut[1] = (USIGN8)((pzEncoder->dwZeros | CONFIG_IMAGE_ZERO_RUN) >> 8);
+        pzEncoder->pbyOut += CONFIG_IMAGE_RUN_HEAD_SIZE;
+        pzEncoder->dwZeros = 0;
     }
 
-    if(bApiFound == TPS_FALSE)
+    while(pzEncoder->dwZeros > 0)
     {
-        AppSetLastError(PLUG_SUB_SLOT_NOT_FOUND);
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubodule() > Given Slothandle not found in List of API\n");
-        #endif
+        if(AppConfigImagePutData(pzEncoder, 0x00) != TPS_TRUE)
+        {
+            return TPS_FALSE;
+        }
+        pzEncoder->dwZeros--;
+    }
+
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       This function writes a configuration image built by
+ *              TPS_BuildConfigImage() to the NRT area. Instead of the single
+ *              writes of configDevice() the image is written with one SPI
+ *              burst per run. configDevice() has to be called afterwards as
+ *              usual: it builds the API, slot and subslot handles, its DPRAM
+ *              writes equal to the image are not sent and its reads are
+ *              answered from the image. Bytes written in several steps
+ *              (e.g. the number of slots) are kept in host RAM until they are
+ *              equal to the image. If configDevice() differs from the image,
+ *              the kept values are sent and all further accesses go to the
+ *              DPRAM again (CONFIG_IMAGE_MISMATCH), the configuration is then
+ *              the same as without image. The image has to stay valid until
+ *              TPS_StartDevice() (e.g. in flash).
+ *              Call after TPS_InitApplicationInterface(), before configDevice().
+ * \ingroup     allfunctions
+ * \note        To use this function <b>USE_CONFIG_IMAGE</b> in TPS_1_user.h must be defined
+ * \param[in]   pbyImage the configuration image
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_WRONG_API_STATE
+ *              - API_CONFIG_IMAGE_NULL_POINTER
+ *              - API_CONFIG_IMAGE_INVALID : no image or not for this NRT area
+ *              - API_CONFIG_IMAGE_VERSION : image of another driver version
+ *              - API_CONFIG_IMAGE_CHECKSUM
+ *              - Error of TPS_SetValueData() / TPS_MemSet()
+ */
+USIGN32 TPS_LoadConfigImage(const USIGN8* pbyImage)
+{
+    T_CONFIG_IMAGE_HEADER zHeader;
+    const USIGN8* pbyRun = NULL;
+    USIGN8*  pbyStart = NULL;
+    USIGN32  dwAddress = 0;
+    USIGN32  dwCount = 0;
+    USIGN32  dwResult = TPS_ACTION_OK;
+    USIGN16  wHead = 0;
 
-        return NULL;
+    if(g_byApiState != STATE_API_INIT_RDY)
+    {
+        return TPS_ERROR_WRONG_API_STATE;
     }
 
-    TPS_GetValue16((USIGN8*)pzSlotHandle->pt_slot_number, &wSlotNumber);
-    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE) && (pzIM0Data == NULL))
+    if(pbyImage == NULL)
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubmodule() > DAP submodule have no I&M0 Data.\n");
-        #endif
-        AppSetLastError(PLUG_SUB_MISSING_IM0_DATA_FOR_DAP);
-        return NULL;
+        return API_CONFIG_IMAGE_NULL_POINTER;
     }
-    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE) && (pzIM0Data != NULL) && (bIM0Carrier==TPS_FALSE))
+
+    /* The image starts behind the header of the NRT area, at the same       */
+    /* address as the configuration of TPS_AddDevice().                      */
+    /*-----------------------------------------------------------------------*/
+    memcpy(&zHeader, pbyImage, sizeof(zHeader));
+    pbyStart = g_pbyConfigNRTMem + sizeof(NRT_APP_CONFIG_HEAD);
+    DWORD_ALIGN(pbyStart);
+
+    if((zHeader.dwMagic != CONFIG_IMAGE_MAGIC) ||
+       (zHeader.dwStart != (USIGN32)pbyStart) ||
+       (zHeader.dwLength == 0) ||
+       (zHeader.dwLength > (g_dwConfigNRTMemSize - (USIGN32)(pbyStart - g_pbyConfigNRTMem))))
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubmodule() > DAP submodule have I&M0 carrier.\n");
-        #endif
-        AppSetLastError(PLUG_SUB_MISSING_IM0_CARRIER_FOR_DAP);
-        return NULL;
+        return API_CONFIG_IMAGE_INVALID;
     }
 
-
-    if(pzIM0Data == NULL )
+    if(zHeader.dwApiVersion != API_VERSION)
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubmodule() > Every submodule needs I&M0 data.\n");
-        #endif
-        AppSetLastError(PLUG_SUB_MISSING_IM0_DATA);
-        return NULL;
+        return API_CONFIG_IMAGE_VERSION;
     }
-    #ifdef DEBUG_API_PLUG_MODULE
-        printf("DEBUG_API > API: TPS_PlugSubmodule() Checking if a submodule with the same number exists (Should not happen).\n");
-    #endif
-    pzSubslot = AppGetSubslotHandle(dwApiNr, wSlotNumber, wSubslotNumber);
-    if(pzSubslot != NULL)
+
+    pbyRun = pbyImage + sizeof(zHeader);
+    if(AppConfigImageChecksum(pbyRun, zHeader.dwRunSize) != zHeader.dwChecksum)
     {
-        #ifdef DEBUG_API_PLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubmodule() > A module with the same number exists.\n");
-        #endif
-        AppSetLastError(PLUG_SUB_SLOT_ALREADY_EXISTS);
-        return NULL;
+        return API_CONFIG_IMAGE_CHECKSUM;
     }
 
-    /* Check if sufficient memory is available in NRT area for a new subslot  */
-    /*------------------------------------------------------------------------*/
-    dwMemSizeSubModule = wInitParameterSize +
-                         (wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY)) +
-                         74 + /* Data accumulated (without ISOCHRON_PARAM)    */
-                         36;  /* 9x DWORD_ALIGN   (4 Byte max each)           */
-       /* MPr see below  (g_pbyCurrentPointer-g_pbyConfigNRTMem);  * for calc */
+    /* Check the runs before the first write.                                */
+    /*-----------------------------------------------------------------------*/
+    for(dwAddress = 0; (pbyRun + CONFIG_IMAGE_RUN_HEAD_SIZE) <= (pbyImage + sizeof(zHeader) + zHeader.dwRunSize); dwAddress += dwCount)
+    {
+        wHead = (USIGN16)(pbyRun[0] | (pbyRun[1] << 8));
+        dwCount = wHead & CONFIG_IMAGE_RUN_COUNT;
+        pbyRun += CONFIG_IMAGE_RUN_HEAD_SIZE;
 
-    /* Check if there is enough memory available.                           */
-    /*----------------------------------------------------------------------*/
+        if((wHead & CONFIG_IMAGE_ZERO_RUN) == 0)
+        {
+            if(dwCount > CONFIG_IMAGE_MAX_DATA_RUN)
+            {
+                return API_CONFIG_IMAGE_INVALID;
+            }
+            pbyRun += dwCount;
+        }
 
-    if ( (USIGN32)((g_pbyCurrentPointer + dwMemSizeSubModule) - g_pbyConfigNRTMem) > g_dwConfigNRTMemSize )
-    {
-    #ifdef DEBUG_API_SUBPLUG_MODULE
-        printf("DEBUG_API > API: TPS_PlugSubModule() > Not enough space for data!\n");
-    #endif
-         AppSetLastError(PLUG_SUB_OUT_OF_MEMORY);
-         return NULL;
+        if(dwCount == 0)
+        {
+            return API_CONFIG_IMAGE_INVALID;
+        }
     }
 
-    /* Check if the slot handle is not NULL                                 */
-    /*----------------------------------------------------------------------*/
-    if(pzSlotHandle == NULL)
+    if((dwAddress != zHeader.dwLength) || (pbyRun != (pbyImage + sizeof(zHeader) + zHeader.dwRunSize)))
     {
-        #ifdef DEBUG_API_SUBPLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubModule() > Slot Handle not correct!\n");
-        #endif
-        AppSetLastError(PLUG_SUB_INVALID_SLOT_HANDLE);
-        return NULL;
+        return API_CONFIG_IMAGE_INVALID;
     }
 
-    /* Check if the API List is set before!                                 */
-    /*----------------------------------------------------------------------*/
-    if(g_zApiARContext.api_list == NULL)
+    /* Write the runs: a data run with one burst, a zero run by TPS_MemSet() */
+    /*-----------------------------------------------------------------------*/
+    memset(&g_zConfigImageStatistics, 0, sizeof(g_zConfigImageStatistics));
+    pbyRun = pbyImage + sizeof(zHeader);
+
+    for(dwAddress = zHeader.dwStart; dwAddress < (zHeader.dwStart + zHeader.dwLength); dwAddress += dwCount)
     {
-        #ifdef DEBUG_API_SUBPLUG_MODULE
-            printf("DEBUG_API > API: TPS_PlugSubModule() > Insert an API first!\n");
-        #endif
-        AppSetLastError(PLUG_SUB_MISSING_API);
-        return NULL;
-    }
+        wHead = (USIGN16)(pbyRun[0] | (pbyRun[1] << 8));
+        dwCount = wHead & CONFIG_IMAGE_RUN_COUNT;
+        pbyRun += CONFIG_IMAGE_RUN_HEAD_SIZE;
 
-    /* Reserve memory for the subslot and initialize the structure!         */
-    /*----------------------------------------------------------------------*/
-    if(pzSlotHandle->pSubslot == NULL)
-    {
-        pzSlotHandle->pSubslot = (SUBSLOT*)(t_malloc(sizeof(SUBSLOT)));
-        pzSubslot = pzSlotHandle->pSubslot;
-    }
-    else
-    {
-        for(pzSubslot=((SLOT*)pzSlotHandle)->pSubslot ;
-            pzSubslot->poNextSubslot!=0 ;
-            pzSubslot=pzSubslot->poNextSubslot)
+        if((wHead & CONFIG_IMAGE_ZERO_RUN) != 0)
         {
-            /* Iterate to the end of the slot list */
+            dwResult = TPS_MemSet((USIGN8*)dwAddress, 0x00, (USIGN16)dwCount);
+            g_zConfigImageStatistics.dwBursts += (dwCount + CONFIG_IMAGE_MAX_DATA_RUN - 1) / CONFIG_IMAGE_MAX_DATA_RUN;
+        }
+        else
+        {
+            dwResult = TPS_SetValueData((USIGN8*)dwAddress, (USIGN8*)pbyRun, dwCount);
+            g_zConfigImageStatistics.dwBursts++;
+            pbyRun += dwCount;
         }
 
-        pzSubslot->poNextSubslot = (SUBSLOT*)(t_malloc(sizeof(SUBSLOT)));
-        pzSubslot = pzSubslot->poNextSubslot;
+        if(dwResult != TPS_ACTION_OK)
+        {
+            return dwResult;
+        }
     }
 
-    /* Delete the structures when the initialization failed!                */
-    /*----------------------------------------------------------------------*/
-    if(pzSubslot == NULL)
-    {
-        #ifdef DEBUG_API_SUBPLUG_MODULE
-          printf("DEBUG_API > API: TPS_PlugSubModule() > Error. Can not allocate SubSlot_Handle\n");
-        #endif
-        AppSetLastError(PLUG_SUB_INVALID_SUBSLOT_HANDLE);
-        return NULL;
-    }
+    memcpy(&g_zConfigImageHeader, &zHeader, sizeof(zHeader));
+    g_pbyConfigImageRuns = pbyImage + sizeof(zHeader);
+    g_pbyConfigImageRun = g_pbyConfigImageRuns;
+    g_dwConfigImageRunStart = 0;
+    g_zConfigImageStatistics.dwImageSize = sizeof(zHeader) + zHeader.dwRunSize;
+    g_zConfigImageStatistics.dwDpramBytes = zHeader.dwLength;
+    g_zConfigImageStatistics.byState = CONFIG_IMAGE_REPLAY;
+    TPS_ConfigImageReplay(TPS_TRUE);
 
-    pzSubslot->pzSlot = pzSlotHandle;
-    pzSubslot->poNextSubslot = NULL;
+    return TPS_ACTION_OK;
+}
 
-    /* Increment the "Number_of_Subslots"!                                  */
-    /*----------------------------------------------------------------------*/
-    pwSubslotNumberLocal = pzSlotHandle->pt_number_of_subslot;
-    #ifdef DEBUG_API_SUBPLUG_MODULE
-          printf("DEBUG_API > API: TPS_PlugSubModule() > Address Number_of_Subslots : 0x%X\n", (USIGN32)pwSubslotNumberLocal);
-    #endif
-    TPS_GetValue16((USIGN8*)pwSubslotNumberLocal, &wNumberOfSubslots);
-    wNumberOfSubslots++;
-    TPS_SetValue16((USIGN8*)pwSubslotNumberLocal, wNumberOfSubslots);
+/*!
+ * \brief       This function reads the configuration written by configDevice()
+ *              back from the NRT area and stores it as configuration image in
+ *              pbyImage. The image contains the NRT area behind the
+ *              NRT_APP_CONFIG_HEAD (written with single accesses by
+ *              TPS_AddDevice() in any case), zero runs are compressed. It can
+ *              be used by TPS_LoadConfigImage() at the next start if the
+ *              configuration and the driver version are not changed.
+ *              Call after configDevice(), before TPS_StartDevice().
+ * \ingroup     allfunctions
+ * \note        To use this function <b>USE_CONFIG_IMAGE</b> in TPS_1_user.h must be defined
+ * \param[out]  pbyImage buffer for the image
+ * \param[in]   dwImageSize size of pbyImage
+ * \param[out]  pdwImageLength length of the image
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_WRONG_API_STATE
+ *              - API_CONFIG_IMAGE_NULL_POINTER
+ *              - API_CONFIG_IMAGE_TOO_SMALL : pbyImage is too small for the image
+ *              - Error of TPS_GetValueData()
+ */
+USIGN32 TPS_BuildConfigImage(USIGN8* pbyImage, USIGN32 dwImageSize, USIGN32* pdwImageLength)
+{
+    T_CONFIG_IMAGE_HEADER  zHeader;
+    T_CONFIG_IMAGE_ENCODER zEncoder;
+    USIGN8   byChunk[CONFIG_IMAGE_READ_CHUNK];
+    USIGN8*  pbyStart = NULL;
+    USIGN32  dwOffset = 0;
+    USIGN32  dwChunk = 0;
+    USIGN32  dwIndex = 0;
+    USIGN32  dwResult = TPS_ACTION_OK;
+    USIGN8   byCorrectApiState = STATE_SUBSLOT_RDY;
 
-    #ifdef DEBUG_API_SUBPLUG_MODULE
-          printf("DEBUG_API > API: TPS_PlugSubModule() > Number_of_Subslots = 0x%X\n", wNumberOfSubslots);
+    #ifdef USE_TPS_COMMUNICATION_CHANNEL
+        byCorrectApiState = STATE_TPS_CHANNEL_RDY;
     #endif
 
+    if(g_byApiState != byCorrectApiState)
+    {
+        return TPS_ERROR_WRONG_API_STATE;
+    }
 
-    /* Write Subslot_Number into the DPRAM                                  */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSubslotNumber);
-    pzSubslot->pt_subslot_number = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 2;
-
-    /* Set SubModuleIdnet_Number (SubSlot data)                             */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, dwSubmoduleIdentNumber);
-    pzSubslot->pt_ident_number = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
-
-    if(dwSubmoduleIdentNumber == AUTOCONF_MODULE)
+    if((pbyImage == NULL) || (pdwImageLength == NULL))
     {
-        pzSubslot->wAdaptiveIos = 1;
+        return API_CONFIG_IMAGE_NULL_POINTER;
     }
-    else
+
+    if(dwImageSize <= sizeof(zHeader))
     {
-        pzSubslot->wAdaptiveIos = 0;
+        return API_CONFIG_IMAGE_TOO_SMALL;
     }
 
-    /* Set I&M0 data, if available.                                         */
-    /*----------------------------------------------------------------------*/
-    if ( (pzIM0Data != NULL) && (bIM0Carrier == TPS_TRUE))
+    /* The image is read from the DPRAM, not from the loaded image.          */
+    /*-----------------------------------------------------------------------*/
+    if(g_zConfigImageStatistics.byState == CONFIG_IMAGE_REPLAY)
     {
-        TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, IMO_DATA_AVAIL);
-        pzSubslot->poIM0DataAvailable = (USIGN16*)g_pbyCurrentPointer;
+        AppConfigImageEnd(TPS_FALSE);
     }
-    g_pbyCurrentPointer += 2;
 
-    /* Set size of init records (Size_Init_Records).                        */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wInitParameterSize);
-    pzSubslot->pt_size_init_records = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
+    pbyStart = g_pbyConfigNRTMem + sizeof(NRT_APP_CONFIG_HEAD);
+    DWORD_ALIGN(pbyStart);
 
-    /* Set size of init records used.                                       */
-    /*----------------------------------------------------------------------*/
-    pzSubslot->pt_size_init_records_used = (USIGN32*)g_pbyCurrentPointer;
-    TPS_SetValue32((USIGN8*)pzSubslot->pt_size_init_records_used, 0x00000000);
-    g_pbyCurrentPointer += 4;
+    memset(&zHeader, 0, sizeof(zHeader));
+    zHeader.dwMagic = CONFIG_IMAGE_MAGIC;
+    zHeader.dwApiVersion = API_VERSION;
+    zHeader.dwStart = (USIGN32)pbyStart;
+    zHeader.dwLength = (USIGN32)(g_pbyCurrentPointer - pbyStart);
 
-    /* Set init parameter size                                              */
-    /*----------------------------------------------------------------------*/
-    pzSubslot->pt_init_records = g_pbyCurrentPointer;
-    g_pbyCurrentPointer += wInitParameterSize;
+    memset(&zEncoder, 0, sizeof(zEncoder));
+    zEncoder.pbyOut = pbyImage + sizeof(zHeader);
+    zEncoder.pbyEnd = pbyImage + dwImageSize;
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    /* Read the configuration back in chunks and encode it.                  */
+    /*-----------------------------------------------------------------------*/
+    for(dwOffset = 0; dwOffset < zHeader.dwLength; dwOffset += dwChunk)
+    {
+        dwChunk = zHeader.dwLength - dwOffset;
+        if(dwChunk > CONFIG_IMAGE_READ_CHUNK)
+        {
+            dwChunk = CONFIG_IMAGE_READ_CHUNK;
+        }
 
-    /* Set Size_Channel_Diagnosis.                                          */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY));
-    pzSubslot->pt_size_chan_diag = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
+        dwResult = TPS_GetValueData(pbyStart + dwOffset, byChunk, dwChunk);
+        if(dwResult != TPS_ACTION_OK)
+        {
+            return dwResult;
+        }
 
-    /* Set Number_Channel_Diagnosis.                                        */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wNumberOfChannelDiag);
-    pzSubslot->pt_nmbr_chan_diag = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
+        for(dwIndex = 0; dwIndex < dwChunk; dwIndex++)
+        {
+            if(byChunk[dwIndex] == 0x00)
+            {
+                zEncoder.dwZeros++;
+                if(zEncoder.dwZeros < CONFIG_IMAGE_RUN_COUNT)
+                {
+                    continue;
+                }
+            }
 
-    /* Diagnosis buffer                                                     */
-    /*----------------------------------------------------------------------*/
-    pzSubslot->pt_chan_diag = g_pbyCurrentPointer;
-    TPS_GetValue32((USIGN8*)pzSubslot->pt_size_chan_diag, &dwReg);
+            if((AppConfigImagePutZeros(&zEncoder) != TPS_TRUE) ||
+               ((byChunk[dwIndex] != 0x00) && (AppConfigImagePutData(&zEncoder, byChunk[dwIndex]) != TPS_TRUE)))
+            {
+                return API_CONFIG_IMAGE_TOO_SMALL;
+            }
+        }
+    }
 
-    memset(&g_byTransmitBuffer[0], 0x00, dwReg);
-    TPS_SetValueData((USIGN8*)(pzSubslot->pt_chan_diag),
-                     &g_byTransmitBuffer[0],
-                     dwReg);
-    g_pbyCurrentPointer += wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY);
+    if(AppConfigImagePutZeros(&zEncoder) != TPS_TRUE)
+    {
+        return API_CONFIG_IMAGE_TOO_SMALL;
+    }
+    AppConfigImageCloseRun(&zEncoder);
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    zHeader.dwRunSize = (USIGN32)(zEncoder.pbyOut - (pbyImage + sizeof(zHeader)));
+    zHeader.dwChecksum = AppConfigImageChecksum(pbyImage + sizeof(zHeader), zHeader.dwRunSize);
+    memcpy(pbyImage, &zHeader, sizeof(zHeader));
 
-    /*** IO Process data configurations **/
-    pzSubslot->pt_used_in_cr = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 2;
+    *pdwImageLength = sizeof(zHeader) + zHeader.dwRunSize;
 
-    /* Input data size                                                      */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSizeOfInputData);
-    pzSubslot->pt_size_input_data = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 2;
+    return TPS_ACTION_OK;
+}
 
-    /* buffer for input data */
-    pzSubslot->pt_input_data = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
+/*!
+ * \brief       This function returns the state and the statistics of the
+ *              configuration image. After configDevice() byState is
+ *              CONFIG_IMAGE_REPLAY if the whole configuration was found in the
+ *              loaded image. Without a loaded image (CONFIG_IMAGE_NOT_LOADED)
+ *              the image should be built by TPS_BuildConfigImage().
+ *              CONFIG_IMAGE_MISMATCH: the NRT area can still hold bytes of the
+ *              loaded image that configDevice() does not write. The stored
+ *              image has to be dropped and the TPS-1 started again, the
+ *              image is then built from the configuration without it.
+ * \ingroup     allfunctions
+ * \note        To use this function <b>USE_CONFIG_IMAGE</b> in TPS_1_user.h must be defined
+ * \param[out]  pzStatistics the statistics
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - API_CONFIG_IMAGE_NULL_POINTER
+ */
+USIGN32 TPS_GetConfigImageStatistics(T_CONFIG_IMAGE_STATISTICS* pzStatistics)
+{
+    if(pzStatistics == NULL)
+    {
+        return API_CONFIG_IMAGE_NULL_POINTER;
+    }
 
-    /* This data will be written by stack while establishing the connection */
-    pzSubslot->pt_offset_input_data = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    memcpy(pzStatistics, &g_zConfigImageStatistics, sizeof(T_CONFIG_IMAGE_STATISTICS));
 
-    pzSubslot->pt_offset_input_iocs = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    /* A configuration shorter than the image is not found in the image.     */
+    /*-----------------------------------------------------------------------*/
+    if((pzStatistics->byState == CONFIG_IMAGE_REPLAY) && (AppConfigImageComplete() != TPS_TRUE))
+    {
+        pzStatistics->byState = CONFIG_IMAGE_MISMATCH;
+    }
 
-    pzSubslot->pt_input_iocs = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+    return TPS_ACTION_OK;
+}
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+/*!
+ * \brief       Write access of SPI1_Master.c to the DPRAM. While the loaded
+ *              image is replayed, a write of configDevice() equal to the image
+ *              is not sent. Bytes differing from the image are kept as pending
+ *              bytes until they are overwritten. If there are too many, the
+ *              replay ends.
+ *
+ * \param[in]   pbyMemory DPRAM address
+ * \param[in]   pbyData data to write or NULL (TPS_MemSet())
+ * \param[in]   byFill value of TPS_MemSet()
+ * \param[in]   dwLength number of bytes
+ * \retval      BOOL TPS_TRUE if the write is not sent
+ */
+BOOL TPS_ConfigImageWriteFilter(USIGN8* pbyMemory, const USIGN8* pbyData, USIGN8 byFill, USIGN32 dwLength)
+{
+    USIGN32 dwAddress = (USIGN32)pbyMemory;
+    USIGN32 dwStart = g_zConfigImageHeader.dwStart;
+    USIGN32 dwEnd = g_zConfigImageHeader.dwStart + g_zConfigImageHeader.dwLength;
+    USIGN32 dwIndex;
+    USIGN8  byValue;
+    BOOL    bEqual;
 
-    pzSubslot->pt_offset_input_iops = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    if((g_zConfigImageStatistics.byState != CONFIG_IMAGE_REPLAY) ||
+       ((dwAddress + dwLength) <= dwStart) || (dwAddress >= dwEnd))
+    {
+        return TPS_FALSE;
+    }
 
-    pzSubslot->pt_operational_state = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+    /* A write across the border of the image ends the replay.               */
+    /*-----------------------------------------------------------------------*/
+    if((dwAddress < dwStart) || ((dwAddress + dwLength) > dwEnd))
+    {
+        AppConfigImageEnd(TPS_TRUE);
+        return TPS_FALSE;
+    }
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    if((AppConfigImageFindPending(dwAddress, dwLength) != CONFIG_IMAGE_PENDING_BYTES) ||
+       (AppConfigImageAccess(dwAddress - dwStart, pbyData, byFill, NULL, dwLength) != TPS_TRUE))
+    {
+        /* Bytes differing from the image are kept as pending bytes.         */
+        /*-------------------------------------------------------------------*/
+        for(dwIndex = 0; dwIndex < dwLength; dwIndex++)
+        {
+            byValue = (pbyData != NULL) ? pbyData[dwIndex] : byFill;
+            bEqual = AppConfigImageAccess(dwAddress + dwIndex - dwStart, &byValue, 0x00, NULL, 1);
 
-    pzSubslot->pt_offset_input_DataStatus = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+            if(AppConfigImageSetPending(dwAddress + dwIndex, byValue, bEqual) != TPS_TRUE)
+            {
+                AppConfigImageEnd(TPS_TRUE);
+                return TPS_FALSE;
+            }
+        }
+    }
 
-    pzSubslot->pt_input_DataStatus = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    g_zConfigImageStatistics.dwWritesSuppressed++;
+    return TPS_TRUE;
+}
 
-    /* shared input data */
-    pzSubslot->pt_offset_indata_shared = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+/*!
+ * \brief       Read access of SPI1_Master.c to the DPRAM. While the loaded
+ *              image is replayed, a read inside of the image is answered from
+ *              the image and the pending bytes.
+ *
+ * \param[in]   pbyMemory DPRAM address
+ * \param[out]  pbyData buffer for the read bytes
+ * \param[in]   dwLength number of bytes
+ * \retval      BOOL TPS_TRUE if the read was answered from the image
+ */
+BOOL TPS_ConfigImageReadFilter(USIGN8* pbyMemory, USIGN8* pbyData, USIGN32 dwLength)
+{
+    USIGN32 dwAddress = (USIGN32)pbyMemory;
+    USIGN32 dwIndex;
 
-    pzSubslot->pt_offset_input_iocs_shared=(USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    if((g_zConfigImageStatistics.byState != CONFIG_IMAGE_REPLAY) ||
+       (pbyData == NULL) || (dwLength == 0) ||
+       ((dwAddress + dwLength) <= g_zConfigImageHeader.dwStart) ||
+       (dwAddress >= (g_zConfigImageHeader.dwStart + g_zConfigImageHeader.dwLength)))
+    {
+        return TPS_FALSE;
+    }
 
-    pzSubslot->pt_input_iocs_shared = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+    /* A read across the border of the image would miss the pending bytes:   */
+    /* it ends the replay.                                                   */
+    /*-----------------------------------------------------------------------*/
+    if((dwAddress < g_zConfigImageHeader.dwStart) ||
+       ((dwAddress + dwLength) > (g_zConfigImageHeader.dwStart + g_zConfigImageHeader.dwLength)))
+    {
+        AppConfigImageEnd(TPS_TRUE);
+        return TPS_FALSE;
+    }
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    AppConfigImageAccess(dwAddress - g_zConfigImageHeader.dwStart, NULL, 0x00, pbyData, dwLength);
 
-    pzSubslot->pt_offset_input_iops_shared=(USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer,0x0000);
-    g_pbyCurrentPointer+=2;
+    for(dwIndex = 0; dwIndex < CONFIG_IMAGE_PENDING_BYTES; dwIndex++)
+    {
+        if((g_zConfigImagePending[dwIndex].bUsed == TPS_TRUE) &&
+           (g_zConfigImagePending[dwIndex].dwAddress >= dwAddress) &&
+           (g_zConfigImagePending[dwIndex].dwAddress < (dwAddress + dwLength)))
+        {
+            pbyData[g_zConfigImagePending[dwIndex].dwAddress - dwAddress] = g_zConfigImagePending[dwIndex].byValue;
+        }
+    }
+    g_zConfigImageStatistics.dwReadsServed++;
 
-    pzSubslot-> pt_operational_state_shared = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+    return TPS_TRUE;
+}
+#endif
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+/*!
+ * \brief       This function adds a new module (slot) to the configuration.
+ *
+ * \param[in]   pzApi handle to the API of this module. The handle is returned by TPS_AddApi()
+ * \param[in]   wSlotNumber the slot number to add
+ * \param[in]   dwModuleIdentNumber the module ID of the slot
+ * \retval      SLOT* a valid slot handle of the new plugged module or NULL in case of an error
+ * \note        Do not change this function!
+*/
+SLOT* TPS_PlugModule (API_LIST* pzApi, USIGN16 wSlotNumber, USIGN32 dwModuleIdentNumber)
+{
+    SLOT*   pzSlot = NULL;
+    USIGN32 dwDataLength = 0;
+    USIGN16 wReturnData  = 0;
 
-    pzSubslot->pt_offset_input_shared_DataStatus = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    /* Check the correct state!                                              */
+    /*-----------------------------------------------------------------------*/
+    if((g_byApiState != STATE_API_RDY) && (g_byApiState != STATE_SUBSLOT_RDY) && (g_byApiState != STATE_SLOT_RDY))
+    {
+        AppSetLastError(TPS_ERROR_WRONG_API_STATE);
+        return NULL;
+    }
 
-    pzSubslot->pt_wSubslotOwnedByAr = (USIGN16*)g_pbyCurrentPointer;
+    /* Check validity of dwModuleIdentNumber                                 */
+    /* ModuleID 0x00 is reserved for autoconfiguration.                      */
+    /*-----------------------------------------------------------------------*/
+    if(dwModuleIdentNumber == AUTOCONF_MODULE)
+    {
+        #ifndef USE_AUTOCONF_MODULE
+            AppSetLastError(PLUGMODULE_INVALID_MODULE_ID);
+            return NULL;
+        #endif
+
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugModule() > Configuring slot 0x%X for autoconfiguration.\n", wSlotNumber);
+        #endif
+    }
+
+    /* Check parameter!                                                      */
+    /*-----------------------------------------------------------------------*/
+    if(pzApi == NULL)
+    {
+        AppSetLastError(TPS_ERROR_NULL_POINTER);
+        return NULL;
+    }
+
+    /* Check if this slot number doesn't exist already.                      */
+    /*-----------------------------------------------------------------------*/
+    pzSlot = AppGetSlotHandle(pzApi->index, wSlotNumber);
+    #ifdef DEBUG_API_PLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugModule() Checking if a module with the same number exists (Should not happen).\n");
+    #endif
+    if(pzSlot != NULL)
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugModule() > A module with the same number exists.\n");
+        #endif
+        AppSetLastError(PLUGMODULE_SLOT_ALREADY_EXISTS);
+        return (NULL);
+    }
+
+
+    /* Check memory space before adding a slot.                              */
+    /*-----------------------------------------------------------------------*/
+    dwDataLength = sizeof(wSlotNumber) +
+                   sizeof(dwModuleIdentNumber) +
+                   sizeof(USIGN16);
+
+    if ( (USIGN32)(g_pbyCurrentPointer + dwDataLength - g_pbyConfigNRTMem) > g_dwConfigNRTMemSize )
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugModule() > Not enough space for data!\n");
+        #endif
+        AppSetLastError(PLUGMODULE_OUT_OF_MEMORY);
+        return (NULL);
+    }
+
+    /* Add the slot to the API_AR_CTX structure (ar context)                 */
+    /*-----------------------------------------------------------------------*/
+    if(pzApi->firstslot == NULL)
+    {
+        pzApi->firstslot = (SLOT*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_SLOT]);
+        pzSlot = pzApi->firstslot;
+    }
+    else
+    {
+        for(pzSlot = pzApi->firstslot;
+            pzSlot->pNextSlot != NULL;
+            pzSlot = pzSlot->pNextSlot)
+        {
+            /* Jump to the end of the list                                   */
+            /*---------------------------------------------------------------*/
+        };
+        pzSlot->pNextSlot = (SLOT*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_SLOT]);
+        pzSlot = pzSlot->pNextSlot;
+    }
+
+    /* Check the generated slot handle                                      */
+    /*----------------------------------------------------------------------*/
+    if(pzSlot == NULL)
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugModule() > Can not allocate Slot_Handle!\n");
+        #endif
+        AppSetLastError(PLUGMODULE_INVALID_SLOT_HANDLE);
+        return (NULL);
+    }
+
+    /* Configure the slot data                                              */
+    /*----------------------------------------------------------------------*/
+    pzSlot->poApi = pzApi;
+    pzSlot->pNextSlot = NULL;
+    pzSlot->pSubslot  = NULL;
+    pzSlot->wProperties = MODULE_NOT_PULLED;
+
+/*
+      Structure inside the DPRAM :
+      +--------------------------+
+      +    Slot_Number (16)      +
+      +--------------------------+
+      +  ModuleIdent_Number (32) +
+      +--------------------------+
+      +    Number_of_Submodules (16)  +
+      +--------------------------+
+*/
+    /* Set the slot number  .                                                */
+    /*-----------------------------------------------------------------------*/
+    TPS_SetValue16(g_pbyCurrentPointer, wSlotNumber);
+    pzSlot->pt_slot_number = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += sizeof(wSlotNumber);
+#ifdef USE_HANDLE_INDEX
+    pzSlot->wSlotNumber = wSlotNumber;
+    AppHandleIndexAdd(pzSlot, NULL, 0);
+#endif
+
+    /* Set the module ID                                                     */
+    /*-----------------------------------------------------------------------*/
+    TPS_SetValue32(g_pbyCurrentPointer, dwModuleIdentNumber);
+    pzSlot->pt_ident_number = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += sizeof(dwModuleIdentNumber);
+
+    /* Increment g_pwNumberOfSlots (global slot counter)                     */
+    /*-----------------------------------------------------------------------*/
+    TPS_GetValue16((USIGN8*)g_pwNumberOfSlots, &wReturnData);
+    wReturnData++;
+    TPS_SetValue16((USIGN8*)g_pwNumberOfSlots, wReturnData);
+
+    /* initialize number of subslots */
+    TPS_SetValue16(g_pbyCurrentPointer, 0x0000);
+    pzSlot->pt_number_of_subslot = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += sizeof(USIGN16);
+
+    /* Initialize the "Module State"  (Slot data)                            */
+    /*-----------------------------------------------------------------------*/
+    TPS_SetValue16(g_pbyCurrentPointer, PROPER_MODULE);
+    pzSlot->pt_module_state = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += sizeof(USIGN16);
+
+    #ifdef DEBUG_API_PLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugModule() > Module %x plugged!\n",wSlotNumber);
+        TPS_GetValue16((USIGN8*)g_pwNumberOfSlots,&wReturnData);
+        printf("DEBUG_API > API: TPS_PlugModule() > Number of Modules : 0x%X \n", (USIGN32)wReturnData);
+        printf("DEBUG_API > API: TPS_PlugModule() > Current Memory Pointer: 0x%X\n", (USIGN32)g_pbyCurrentPointer);
+    #endif
+
+    g_byApiState = STATE_SLOT_RDY;
+    return (pzSlot);
+}
+
+/*!
+* \brief       This function adds a submodule (subslot) to a slot. The
+*              parameter pzSlotHandle points to the associated slot.
+*
+* \param[in]   pzSlotHandle handle of the slot
+* \param[in]   wSubslotNumber the subslot number to add
+* \param[in]   wSubmoduleIdentNumber the submodule ID. Use AUTOCONF_MODULE if this submodule should be later adapted to the expected configuration.
+* \param[in]   wInitParameterSize <b>Legacy:</b> the maximum size of initial parameters that can be received for this subslot
+*              <br>the size is calculated as follows:
+*                  size for Index (2 bytes) + size for the data length (4 bytes) + size of the record data.<br>
+*              <b>New Parameterization Handling:</b> Set this parameter 0. This saves memory in the NRT area and streamlines
+*              the record write handling but might slow down the connect time a bit.<br>
+*               Each Parameter that is sent on connect time triggers a record write event
+*              that calls the registered onRecordWrite callback in your application.
+* \param[in]   wNumberOfChannelDiag maximum number of diagnostic channels that the application can register for this submodule.
+* \param[in]   wSizeOfInputData Size of the cyclic input data of this submodule.
+<br>If wSubmoduleIdentNumber = AUTOCONF_MODULE this value is not used but later defined by the expected configuration.
+* \param[in]   wSizeOfOutputData Size of the cyclic output data of this submodule.
+<br>If wSubmoduleIdentNumber = AUTOCONF_MODULE this value is not used but later defined by the expected configuration.
+* \param[in]   pzIM0Data pointer to the I&M0 data structure for this subslot. Each subslot must have at least I&M0 data.
+* \param[in]   bIM0Carrier flag if this subslot is a I&M carrier (TPS_TRUE) or not (TPS_FALSE).
+*              Slot 0 / subslot 1 (DAP) must be a carrier. Each new carrier should contain different I&M data than the DAP.
+* \retval      SUBSLOT* a valid subslot handle of the new plugged subslot or NULL in case of an error
+*/
+SUBSLOT* TPS_PlugSubmodule(SLOT*       pzSlotHandle,
+                           USIGN16     wSubslotNumber,
+                           USIGN32     dwSubmoduleIdentNumber,
+                           USIGN16     wInitParameterSize,
+                           USIGN16     wNumberOfChannelDiag,
+                           USIGN16     wSizeOfInputData,
+                           USIGN16     wSizeOfOutputData,
+                           T_IM0_DATA* pzIM0Data,
+                           BOOL        bIM0Carrier)
+{
+    API_LIST* pzApi = NULL;
+    SLOT*     pzTempSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+
+    USIGN32   dwMemSizeSubModule = 0;
+    USIGN32   dwApiNr = 0;
+    USIGN16   wSlotNumber = 0;
+    USIGN16   wNumberOfSubslots = 0;
+    USIGN16*  pwSubslotNumberLocal = NULL;
+    USIGN32   dwReg = 0;
+    BOOL      bApiFound = TPS_FALSE;
+
+    /* Check the correct state!                                            */
+    /*---------------------------------------------------------------------*/
+    if((g_byApiState != STATE_SLOT_RDY) && (g_byApiState != STATE_SUBSLOT_RDY))
+    {
+        AppSetLastError(TPS_ERROR_WRONG_API_STATE);
+        return NULL;
+    }
+
+    /* Check the for nullpointer!                                          */
+    /*---------------------------------------------------------------------*/
+    if(pzSlotHandle == NULL)
+    {
+        AppSetLastError(TPS_ERROR_NULL_POINTER);
+        return NULL;
+    }
+
+    /* Check the correct ident number!                                       */
+    /* SubmoduleID 0x00 is reserved for autoconfiguration.                      */
+    /*-----------------------------------------------------------------------*/
+    if(dwSubmoduleIdentNumber == AUTOCONF_MODULE)
+    {
+        #ifndef USE_AUTOCONF_MODULE
+            AppSetLastError(PLUG_SUB_INVALID_SUBMODULE_ID);
+            return NULL;
+        #endif
+
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubodule() > Configuring subslot 0x%X for autoconfiguration.\n", wSubslotNumber);
+        #endif
+    }
+
+    /* Check if this subslot number doesn't already exists.                   */
+    /*-----------------------------------------------------------------------*/
+    /* Look for the API in which this slot is plugged. */
+    if(g_zApiARContext.api_list != NULL)
+    {
+        for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+        {
+            /* Search the API List for the given Slot to find the correct API Number. */
+            for(pzTempSlot = pzApi->firstslot;
+                pzTempSlot != NULL;
+                pzTempSlot = pzTempSlot->pNextSlot)
+            {
+                if(pzTempSlot == pzSlotHandle)
+                {
+                    /* Slot found, store API Number. */
+                    dwApiNr = pzApi->index;
+                    bApiFound = TPS_TRUE;
+                }
+            }
+        }
+    }
+
+    if(bApiFound == TPS_FALSE)
+    {
+        AppSetLastError(PLUG_SUB_SLOT_NOT_FOUND);
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubodule() > Given Slothandle not found in List of API\n");
+        #endif
+
+        return NULL;
+    }
+
+    wSlotNumber = AppGetSlotNumber(pzSlotHandle);
+    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE) && (pzIM0Data == NULL))
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubmodule() > DAP submodule have no I&M0 Data.\n");
+        #endif
+        AppSetLastError(PLUG_SUB_MISSING_IM0_DATA_FOR_DAP);
+        return NULL;
+    }
+    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE) && (pzIM0Data != NULL) && (bIM0Carrier==TPS_FALSE))
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubmodule() > DAP submodule have I&M0 carrier.\n");
+        #endif
+        AppSetLastError(PLUG_SUB_MISSING_IM0_CARRIER_FOR_DAP);
+        return NULL;
+    }
+
+
+    if(pzIM0Data == NULL )
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubmodule() > Every submodule needs I&M0 data.\n");
+        #endif
+        AppSetLastError(PLUG_SUB_MISSING_IM0_DATA);
+        return NULL;
+    }
+    #ifdef DEBUG_API_PLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugSubmodule() Checking if a submodule with the same number exists (Should not happen).\n");
+    #endif
+    pzSubslot = AppGetSubslotHandle(dwApiNr, wSlotNumber, wSubslotNumber);
+    if(pzSubslot != NULL)
+    {
+        #ifdef DEBUG_API_PLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubmodule() > A module with the same number exists.\n");
+        #endif
+        AppSetLastError(PLUG_SUB_SLOT_ALREADY_EXISTS);
+        return NULL;
+    }
+
+    /* Check if sufficient memory is available in NRT area for a new subslot  */
+    /*------------------------------------------------------------------------*/
+    dwMemSizeSubModule = wInitParameterSize +
+                         (wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY)) +
+                         74 + /* Data accumulated (without ISOCHRON_PARAM)    */
+                         36;  /* 9x DWORD_ALIGN   (4 Byte max each)           */
+       /* MPr see below  (g_pbyCurrentPointer-g_pbyConfigNRTMem);  * for calc */
+
+    /* Check if there is enough memory available.                           */
+    /*----------------------------------------------------------------------*/
+
+    if ( (USIGN32)((g_pbyCurrentPointer + dwMemSizeSubModule) - g_pbyConfigNRTMem) > g_dwConfigNRTMemSize )
+    {
+    #ifdef DEBUG_API_SUBPLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugSubModule() > Not enough space for data!\n");
+    #endif
+         AppSetLastError(PLUG_SUB_OUT_OF_MEMORY);
+         return NULL;
+    }
+
+#ifdef USE_DIAG_INDEX
+    /* Check if the host side copy of the diagnosis buffer fits.           */
+    /*----------------------------------------------------------------------*/
+    if((USIGN32)(g_wDiagIndexUsed + wNumberOfChannelDiag) > DIAG_INDEX_SIZE)
+    {
+    #ifdef DEBUG_API_SUBPLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugSubModule() > DIAG_INDEX_SIZE too small!\n");
+    #endif
+         AppSetLastError(PLUG_SUB_DIAG_INDEX_FULL);
+         return NULL;
+    }
+#endif
+
+    /* Check if the slot handle is not NULL                                 */
+    /*----------------------------------------------------------------------*/
+    if(pzSlotHandle == NULL)
+    {
+        #ifdef DEBUG_API_SUBPLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubModule() > Slot Handle not correct!\n");
+        #endif
+        AppSetLastError(PLUG_SUB_INVALID_SLOT_HANDLE);
+        return NULL;
+    }
+
+    /* Check if the API List is set before!                                 */
+    /*----------------------------------------------------------------------*/
+    if(g_zApiARContext.api_list == NULL)
+    {
+        #ifdef DEBUG_API_SUBPLUG_MODULE
+            printf("DEBUG_API > API: TPS_PlugSubModule() > Insert an API first!\n");
+        #endif
+        AppSetLastError(PLUG_SUB_MISSING_API);
+        return NULL;
+    }
+
+    /* Reserve memory for the subslot and initialize the structure!         */
+    /*----------------------------------------------------------------------*/
+    if(pzSlotHandle->pSubslot == NULL)
+    {
+        pzSlotHandle->pSubslot = (SUBSLOT*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_SUBSLOT]);
+        pzSubslot = pzSlotHandle->pSubslot;
+    }
+    else
+    {
+        for(pzSubslot=((SLOT*)pzSlotHandle)->pSubslot ;
+            pzSubslot->poNextSubslot!=0 ;
+            pzSubslot=pzSubslot->poNextSubslot)
+        {
+            /* Iterate to the end of the slot list */
+        }
+
+        pzSubslot->poNextSubslot = (SUBSLOT*)AppObjectPoolAlloc(&g_zObjectPool[OBJECT_POOL_SUBSLOT]);
+        pzSubslot = pzSubslot->poNextSubslot;
+    }
+
+    /* Delete the structures when the initialization failed!                */
+    /*----------------------------------------------------------------------*/
+    if(pzSubslot == NULL)
+    {
+        #ifdef DEBUG_API_SUBPLUG_MODULE
+          printf("DEBUG_API > API: TPS_PlugSubModule() > Error. Can not allocate SubSlot_Handle\n");
+        #endif
+        AppSetLastError(PLUG_SUB_INVALID_SUBSLOT_HANDLE);
+        return NULL;
+    }
+
+    pzSubslot->pzSlot = pzSlotHandle;
+    pzSubslot->poNextSubslot = NULL;
+#ifdef USE_SUBSLOT_IO_CACHE
+    memset(&pzSubslot->zIoCache, 0, sizeof(T_SUBSLOT_IO_CACHE));
+#endif
+
+    /* Increment the "Number_of_Subslots"!                                  */
+    /*----------------------------------------------------------------------*/
+    pwSubslotNumberLocal = pzSlotHandle->pt_number_of_subslot;
+    #ifdef DEBUG_API_SUBPLUG_MODULE
+          printf("DEBUG_API > API: TPS_PlugSubModule() > Address Number_of_Subslots : 0x%X\n", (USIGN32)pwSubslotNumberLocal);
+    #endif
+    TPS_GetValue16((USIGN8*)pwSubslotNumberLocal, &wNumberOfSubslots);
+    wNumberOfSubslots++;
+    TPS_SetValue16((USIGN8*)pwSubslotNumberLocal, wNumberOfSubslots);
+
+    #ifdef DEBUG_API_SUBPLUG_MODULE
+          printf("DEBUG_API > API: TPS_PlugSubModule() > Number_of_Subslots = 0x%X\n", wNumberOfSubslots);
+    #endif
+
+
+    /* Write Subslot_Number into the DPRAM                                  */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSubslotNumber);
+    pzSubslot->pt_subslot_number = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 2;
+#ifdef USE_HANDLE_INDEX
+    pzSubslot->wSubslotNumber = wSubslotNumber;
+    AppHandleIndexAdd(pzSlotHandle, pzSubslot, wSubslotNumber);
+#endif
+
+    /* Set SubModuleIdnet_Number (SubSlot data)                             */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, dwSubmoduleIdentNumber);
+    pzSubslot->pt_ident_number = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    if(dwSubmoduleIdentNumber == AUTOCONF_MODULE)
+    {
+        pzSubslot->wAdaptiveIos = 1;
+    }
+    else
+    {
+        pzSubslot->wAdaptiveIos = 0;
+    }
+
+    /* Set I&M0 data, if available.                                         */
+    /*----------------------------------------------------------------------*/
+    if ( (pzIM0Data != NULL) && (bIM0Carrier == TPS_TRUE))
+    {
+        TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, IMO_DATA_AVAIL);
+        pzSubslot->poIM0DataAvailable = (USIGN16*)g_pbyCurrentPointer;
+    }
+    g_pbyCurrentPointer += 2;
+
+    /* Set size of init records (Size_Init_Records).                        */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wInitParameterSize);
+    pzSubslot->pt_size_init_records = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    /* Set size of init records used.                                       */
+    /*----------------------------------------------------------------------*/
+    pzSubslot->pt_size_init_records_used = (USIGN32*)g_pbyCurrentPointer;
+    TPS_SetValue32((USIGN8*)pzSubslot->pt_size_init_records_used, 0x00000000);
+    g_pbyCurrentPointer += 4;
+
+    /* Set init parameter size                                              */
+    /*----------------------------------------------------------------------*/
+    pzSubslot->pt_init_records = g_pbyCurrentPointer;
+    g_pbyCurrentPointer += wInitParameterSize;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    /* Set Size_Channel_Diagnosis.                                          */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY));
+    pzSubslot->pt_size_chan_diag = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    /* Set Number_Channel_Diagnosis.                                        */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)g_pbyCurrentPointer, wNumberOfChannelDiag);
+    pzSubslot->pt_nmbr_chan_diag = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    /* Diagnosis buffer                                                     */
+    /*----------------------------------------------------------------------*/
+    pzSubslot->pt_chan_diag = g_pbyCurrentPointer;
+    TPS_GetValue32((USIGN8*)pzSubslot->pt_size_chan_diag, &dwReg);
+
+    memset(&g_byTransmitBuffer[0], 0x00, dwReg);
+    TPS_SetValueData((USIGN8*)(pzSubslot->pt_chan_diag),
+                     &g_byTransmitBuffer[0],
+                     dwReg);
+    g_pbyCurrentPointer += wNumberOfChannelDiag * sizeof(DPR_DIAG_ENTRY);
+
+#ifdef USE_DIAG_INDEX
+    pzSubslot->zDiagIndex.wFirstEntry = g_wDiagIndexUsed;
+    pzSubslot->zDiagIndex.wNumberOfEntries = wNumberOfChannelDiag;
+    AppDiagIndexInit(pzSubslot);
+    g_wDiagIndexUsed += wNumberOfChannelDiag;
+#endif
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    /*** IO Process data configurations **/
+    pzSubslot->pt_used_in_cr = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 2;
+
+    /* Input data size                                                      */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSizeOfInputData);
+    pzSubslot->pt_size_input_data = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 2;
+
+    /* buffer for input data */
+    pzSubslot->pt_input_data = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    /* This data will be written by stack while establishing the connection */
+    pzSubslot->pt_offset_input_data = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_offset_input_iocs = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_input_iocs = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_input_iops = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_operational_state = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_input_DataStatus = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_input_DataStatus = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    /* shared input data */
+    pzSubslot->pt_offset_indata_shared = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_offset_input_iocs_shared=(USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_input_iocs_shared = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_input_iops_shared=(USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer,0x0000);
+    g_pbyCurrentPointer+=2;
+
+    pzSubslot-> pt_operational_state_shared = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_input_shared_DataStatus = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_wSubslotOwnedByAr = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    /* Output data */
+    /* Size_Output_Data (Context Management) */
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSizeOfOutputData);
+    pzSubslot->pt_size_output_data = (USIGN16*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_output_data = (USIGN32*)g_pbyCurrentPointer;
+    g_pbyCurrentPointer += 4;
+
+    pzSubslot->pt_offset_output_data = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_offset_output_iocs = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_output_iocs = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_output_iops = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_output_iops = (USIGN8*)g_pbyCurrentPointer;
+    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
+    g_pbyCurrentPointer += 1;
+
+    DWORD_ALIGN(g_pbyCurrentPointer);
+
+    pzSubslot->pt_offset_output_DataStatus = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_output_DataStatus = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
+    g_pbyCurrentPointer += 2;
+
+    pzSubslot->pt_properties = (USIGN16*)g_pbyCurrentPointer;
     TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
     g_pbyCurrentPointer += 2;
 
-    /* Output data */
-    /* Size_Output_Data (Context Management) */
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, wSizeOfOutputData);
-    pzSubslot->pt_size_output_data = (USIGN16*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 2;
+    /* Add Sync Application parameters only to DAP subslot*/
+    wSlotNumber = AppGetSlotNumber(pzSlotHandle);
+    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE))
+    {
+        pzSubslot->poSyncAppParam = (T_ISOCHRON_PARAMETERS*)g_pbyCurrentPointer;
+        TPS_MemSet(g_pbyCurrentPointer, 0, sizeof(T_ISOCHRON_PARAMETERS));
+        g_pbyCurrentPointer += sizeof(T_ISOCHRON_PARAMETERS);
+        DWORD_ALIGN(g_pbyCurrentPointer);
+    }
+
+    pzSubslot->pt_submodule_state = (USIGN16*)g_pbyCurrentPointer;
+    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, SUBMODULE_OK);
+    g_pbyCurrentPointer += 2;
+
+    #ifdef DEBUG_API_SUBPLUG_MODULE
+        printf("DEBUG_API > API: TPS_PlugSubModule() > Submodule plugged\n");
+        printf("DEBUG_API > API: TPS_PlugSubModule() > Memory used 0x%d\n",
+               (USIGN32)(g_pbyCurrentPointer - g_pbyConfigNRTMem));
+    #endif
+
+    #ifdef DEBUG_API_SUBPLUG_MODULE_PRINT
+        TPS_PrintSlotSubslotConfiguration();
+    #endif
+
+    pzSubslot->poIM0 = pzIM0Data;
+
+    g_byApiState = STATE_SUBSLOT_RDY;
+
+    return pzSubslot;
+}
+
+/*!
+ * \brief       This function resets the device configuration event to the TPS-1
+ *              only if the device isn't connected
+                Call TPS_CleanApiConf() afterwards to initialize the configuration in the application.
+ *
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_AR_STILL_ACTIVE
+ */
+USIGN32 TPS_ResetDeviceConfig(VOID)
+{
+    if ((g_dwArEstablished_0 != AR_NOT_IN_OPERATION)
+        || (g_dwArEstablished_1 != AR_NOT_IN_OPERATION)
+        || (g_dwArEstablished_IOSR != AR_NOT_IN_OPERATION))
+    {
+        return TPS_ERROR_AR_STILL_ACTIVE;
+    }
+    return AppSetEventRegApp(APP_EVENT_RESET_STACK_CONFIG);
+}
+
+/*!
+ * \brief       This function registers the I&M Data for the given Slot.
+ *
+ * \param[in]   pzSubslot handle to the sub slot structure
+ * \param[in]   pzIM0Data pointer to the I&M0 data buffer
+ * \param[in]   pzIM1Data pointer to the I&M1 data buffer or NULL
+ * \param[in]   pzIM2Data pointer to the I&M2 data buffer or NULL
+ * \param[in]   pzIM3Data pointer to the I&M3 data buffer or NULL
+ * \param[in]   pzIM4Data pointer to the I&M4 data buffer or NULL
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - REGISTER_IM_SUBSLOT_NOT_FOUND
+ */
+USIGN32 TPS_RegisterIMDataForSubslot(SUBSLOT* pzSubslot, T_IM0_DATA* pzIM0Data, T_IM1_DATA* pzIM1Data,
+    T_IM2_DATA* pzIM2Data, T_IM3_DATA* pzIM3Data, T_IM4_DATA* pzIM4Data)
+{
+    USIGN32 dwRetval = TPS_ACTION_OK;
+    USIGN32 dwApi = 0x00;
+    USIGN16 wSlotNumber = 0x00;
+    USIGN16 wSubslotNumber = 0x00;
+
+    /* The registration of I&M Data is only allowed on the DAP. */
+    dwRetval = AppGetSlotInfoFromHandle(pzSubslot, &dwApi, &wSlotNumber, &wSubslotNumber);
+    if (dwRetval != TPS_ACTION_OK)
+    {
+        dwRetval = REGISTER_IM_SUBSLOT_NOT_FOUND;
+    }
+
+    /* Set the data. */
+    if ((dwRetval == TPS_ACTION_OK) &&
+        (pzIM0Data != NULL))
+    {
+        pzIM0Data->IM_Supported = IM_NOT_SUPPORTED;
+        pzSubslot->poIM0 = pzIM0Data;
+
+        if (pzIM1Data != NULL)
+        {
+            pzIM0Data->IM_Supported |= IM1_SUPPORTED;
+            pzSubslot->poIM0->p_im1 = pzIM1Data;
+        }
+        else
+        {
+            pzSubslot->poIM0->p_im1 = NULL;
+        }
+
+        if (pzIM2Data != NULL)
+        {
+            pzIM0Data->IM_Supported |= IM2_SUPPORTED;
+            pzSubslot->poIM0->p_im2 = pzIM2Data;
+        }
+        else
+        {
+            pzSubslot->poIM0->p_im2 = NULL;
+        }
+
+        if (pzIM3Data != NULL)
+        {
+            pzIM0Data->IM_Supported |= IM3_SUPPORTED;
+            pzSubslot->poIM0->p_im3 = pzIM3Data;
+        }
+        else
+        {
+            pzSubslot->poIM0->p_im3 = NULL;
+        }
+
+        if (pzIM4Data != NULL)
+        {
+            pzIM0Data->IM_Supported |= IM4_SUPPORTED;
+            pzSubslot->poIM0->p_im4 = pzIM4Data;
+        }
+        else
+        {
+            pzSubslot->poIM0->p_im4 = NULL;
+        }
+    }
+
+    return dwRetval;
+}
+
+/*!
+ * \brief       This function returns the MAC Addresses of the TPS-1.
+ *
+ * \param[out]  pbyInterfaceMac pointer to the buffer in which the interface MAC address will be stored.
+                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
+ * \param[out]  pbyPort1Mac pointer to the buffer in which the MAC address of port 1 will be stored.
+                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
+ * \param[out]  pbyPort2Mac pointer to the buffer in which the MAC address of port 2 will be stored.
+                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
+ * \note        The size for all buffers has to be MAC_ADDRESS_SIZE or NULL
+ * \retval      TPS_ACTION_OK
+ */
+USIGN32 TPS_GetMacAddresses(USIGN8* pbyInterfaceMac, USIGN8* pbyPort1Mac, USIGN8* pbyPort2Mac)
+{
+    if (pbyInterfaceMac != NULL)
+    {
+        TPS_GetValueData(g_pzNrtConfigHeader->byInterfaceMac, pbyInterfaceMac, MAC_ADDRESS_SIZE);
+    }
+
+    if (pbyPort1Mac != NULL)
+    {
+        TPS_GetValueData(g_pzNrtConfigHeader->byPort1Mac, pbyPort1Mac, MAC_ADDRESS_SIZE);
+    }
+
+    if (pbyPort2Mac != NULL)
+    {
+        TPS_GetValueData(g_pzNrtConfigHeader->byPort2Mac, pbyPort2Mac, MAC_ADDRESS_SIZE);
+    }
+
+    return(TPS_ACTION_OK);
+}
+
+/*!
+ * \brief       This function returns the IP configuration of the TPS-1.
+ *
+ * \param[out]  pdwIPAddress pointer in which the IP address will be stored
+ * \param[out]  pdwSubnetMask pointer in which the subnet mask will be stored
+ * \param[out]  pdwGateway pointer in which the default gateway will be stored
+ * \retval      USIGN32 TPS_ACTION_OK
+ */
+USIGN32 TPS_GetIPConfig(USIGN32* pdwIPAddress, USIGN32* pdwSubnetMask, USIGN32* pdwGateway)
+{
+    if (pdwIPAddress != NULL)
+    {
+        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwIPAddress), (USIGN8*)pdwIPAddress, IP_ADDRESS_SIZE);
+    }
+
+    if (pdwSubnetMask != NULL)
+    {
+        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwSubnetMask), (USIGN8*)pdwSubnetMask, IP_ADDRESS_SIZE);
+    }
+
+    if (pdwGateway != NULL)
+    {
+        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwGateway), (USIGN8*)pdwGateway, IP_ADDRESS_SIZE);
+    }
+
+    return(TPS_ACTION_OK);
+}
+
+/*!
+ * \brief       This function writes the actual name of station of the TPS-1 into buffer pbyName.
+ *
+ * \param[out]  pbyName pointer to a buffer in which the name is stored.
+ * \param[in]   dwBufferLength length of the buffer. The length must be at least STATION_NAME_LEN+1
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_NULL_POINTER
+ *              - TPS_ERROR_BUFFER_TOO_SMALL
+ */
+USIGN32 TPS_GetNameOfStation(USIGN8* pbyName, USIGN32 dwBufferLength)
+{
+    if (pbyName == NULL)
+    {
+        return TPS_ERROR_NULL_POINTER;
+    }
+
+    if (dwBufferLength < (STATION_NAME_LEN + 1))
+    {
+        return TPS_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), pbyName, STATION_NAME_LEN);
+    pbyName[STATION_NAME_LEN] = 0;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function writes the serial number of the device into buffer pbySerialnumber.
+                The Serialnumber is set with the TPS Configurator and must also be used in the I&M data of this application.
+ *
+ * \param[out]  pbySerialnumber pointer to a buffer in which the serial number will be stored.
+ * \param[in]   dwSerialLength length of the buffer. The length must be at least IM0_SERIALNUMBER_LEN+1
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_NULL_POINTER
+ *              - TPS_ERROR_BUFFER_TOO_SMALL
+ */
+USIGN32 TPS_GetSerialnumber(USIGN8 *pbySerialnumber, USIGN32 dwSerialLength)
+{
+    if (pbySerialnumber == NULL)
+    {
+        return TPS_ERROR_NULL_POINTER;
+    }
+    if (dwSerialLength < (IM0_SERIALNUMBER_LEN + 1))
+    {
+        return TPS_ERROR_BUFFER_TOO_SMALL;
+    }
+    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->bySerialnumber), pbySerialnumber, IM0_SERIALNUMBER_LEN);
+    pbySerialnumber[IM0_SERIALNUMBER_LEN] = 0;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function returns the order Id of the device.
+                The order ID is initially set with the TPS Configurator but can also be changed with TPS_SetOrderId().
+                The I&M0 data of this application must have the same order ID as returned in this function.
+ *
+ * \param[out]  pbyOrderId pointer to a buffer in which the orderId will be stored.
+ * \param[in]   dwOrderIdLength length of the buffer. The length must be at least IM0_ORDERID_LEN+1
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_NULL_POINTER
+ *              - TPS_ERROR_BUFFER_TOO_SMALL
+ */
+USIGN32 TPS_GetOrderId(USIGN8 *pbyOrderId, USIGN32 dwOrderIdLength)
+{
+    if (pbyOrderId == NULL)
+    {
+        return TPS_ERROR_NULL_POINTER;
+    }
+    if (dwOrderIdLength < (IM0_ORDERID_LEN + 1))
+    {
+        return TPS_ERROR_BUFFER_TOO_SMALL;
+    }
+    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->byOrderId), pbyOrderId, IM0_ORDERID_LEN);
+    pbyOrderId[IM0_ORDERID_LEN] = 0;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function sets the orderId of the device. If you use this
+ *              function the orderId defined with the TPS-Configurator isn't
+ *              valid anymore. Instead this new orderId is used.
+ *
+ * \param[in]   pbyOrderId pointer to a buffer where the new orderId is defined
+ * \param[in]   dwOrderIdLength length of the buffer. The length can be up to IM0_ORDERID_LEN bytes
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_NULL_POINTER
+ *              - TPS_ERROR_BUFFER_TOO_BIG
+ */
+USIGN32 TPS_SetOrderId(USIGN8 *pbyOrderId, USIGN32 dwOrderIdLength)
+{
+    char tempBuf[IM0_ORDERID_LEN] = {0};
+
+    if (pbyOrderId == NULL)
+    {
+        return TPS_ERROR_NULL_POINTER;
+    }
+    if (dwOrderIdLength > IM0_ORDERID_LEN)
+    {
+        return TPS_ERROR_BUFFER_TOO_BIG;
+    }
+    memset(tempBuf, 0x20, IM0_ORDERID_LEN);
+    memcpy(tempBuf, pbyOrderId, dwOrderIdLength);
+    return TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byOrderId), (USIGN8*)tempBuf, IM0_ORDERID_LEN);
+}
+
+#ifndef USE_INT_APP
+/*!
+ * \brief       This function changes the name of station. This is the name of the interface that uniquely defines the device in the network.
+ *
+ * \param[in]   pbyNameBuf pointer to the name of station string buffer
+ * \param[in]   dwLenOfName length of the name of station
+ * \param[in]   byAttr DCP_SET_PROTECTED: The name of station cannot be changed by dcp.set requests, DCP_SET_ALLOWED: The name of station can be changed by dcp.set requests
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_NULL_POINTER
+ *              - TPS_ERROR_WRONG_API_STATE
+ *              - API_DEVICE_NAME_TOO_LONG
+ *              - API_WRONG_PARAMETER
+ */
+USIGN32 TPS_SetNameOfStation(USIGN8* pbyNameBuf, USIGN32 dwLenOfName, USIGN8 byAttr)
+{
+    USIGN8 byAccessMode = 0;
+    USIGN8 byNameOfStationBuff[STATION_NAME_LEN];
+
+    if (g_pzNrtConfigHeader == NULL)
+    {
+        return TPS_ERROR_WRONG_API_STATE;
+    }
+    else if (dwLenOfName > STATION_NAME_LEN)
+    {
+        return API_DEVICE_NAME_TOO_LONG;
+    }
+    else if ((byAttr != DCP_SET_PROTECTED) && (byAttr != DCP_SET_ALLOWED))
+    {
+        return API_WRONG_PARAMETER;
+    }
+    else if (pbyNameBuf == NULL)
+    {
+        return TPS_ERROR_NULL_POINTER;
+    }
+
+    /* get actual value */
+    TPS_GetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), &byAccessMode);
+    byAccessMode = (byAccessMode & 0xFE) | (byAttr & 0x1);
+
+    /* reset name data */
+    memset(&byNameOfStationBuff, 0, STATION_NAME_LEN);
+    TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), (USIGN8*)&byNameOfStationBuff, STATION_NAME_LEN);
+
+    /* write the name of device */
+    TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), pbyNameBuf, dwLenOfName);
+    TPS_SetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), byAccessMode);
+
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function temporarily changes the IP configuration of the device. The new IP configuration is not written into flash, so after a reboot
+ *              the last known IP Address is used. With the parameter DCP_SET_PROTECTED it's also possible to prevent setting of new IP addresses from external
+ *              sources.
+ *              <br><br>If you want to change the IP configuration permanently, please refer to TPS_DcpSetDeviceIP().
+ *
+ * \param[in]   dwIPAddr the IP address
+ * \param[in]   dwSubNetMask the subnet mask
+ * \param[in]   dwGateway the gateway
+ * \param[in]   byAttr DCP_SET_PROTECTED: The IP configuration cannot be changed by dcp.set requests, DCP_SET_ALLOWED: The IP configuration can be changed by dcp.set requests
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_WRONG_API_STATE
+ *              - API_WRONG_ATTR_PARAMETER
+ */
+USIGN32 TPS_SetIPConfig(USIGN32 dwIPAddr, USIGN32 dwSubNetMask, USIGN32 dwGateway, USIGN8 byAttr)
+{
+    USIGN8 byAccessMode = 0;
+
+    if (g_pzNrtConfigHeader == NULL)
+    {
+        return TPS_ERROR_WRONG_API_STATE;
+    }
+    else if ((byAttr != DCP_SET_PROTECTED) && (byAttr != DCP_SET_ALLOWED))
+    {
+        return API_WRONG_ATTR_PARAMETER;
+    }
+
+    TPS_GetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), &byAccessMode);
+    byAccessMode = (byAccessMode & 0xFD) | (byAttr << 1);
+
+    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwIPAddress), dwIPAddr);
+    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwSubnetMask), dwSubNetMask);
+    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwGateway), dwGateway);
+
+    TPS_SetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), byAccessMode);
+
+    return (TPS_ACTION_OK);
+}
+#endif /*USE_INT_APP*/
+
+/*!
+ * \brief       This function deletes all slot/subslot structures.
+                It can be used for cleaning up a previously configured API configuration.
+                Should always be called after TPS_ResetDeviceConfig()
+ *
+ * \retval      TPS_ACTION_OK
+ */
+USIGN32 TPS_CleanApiConf(VOID)
+{
+    API_LIST* pzApi = g_zApiARContext.api_list;
+    API_LIST* pzApiNext = NULL;
+    SLOT* pzSlot = NULL;
+    SLOT* pzSlotNext = NULL;
+    SUBSLOT* pzSubslot = NULL;
+    SUBSLOT* pzSubslotNext = NULL;
+#ifdef USE_RECORD_REGISTRY
+    USIGN16 wEntry = 0;
+#endif
+
+    while (pzApi != NULL)
+    {
+        pzApiNext = pzApi->next;
+
+        pzSlot = pzApi->firstslot;
+
+        while (pzSlot != NULL)
+        {
+            pzSlotNext = pzSlot->pNextSlot;
+
+            pzSubslot = pzSlot->pSubslot;
+
+            while (pzSubslot != NULL)
+            {
+                pzSubslotNext = pzSubslot->poNextSubslot;
+
+                AppFactoryResetForIM1_4();
+
+                AppObjectPoolFree(&g_zObjectPool[OBJECT_POOL_SUBSLOT], pzSubslot);
+                pzSubslot = pzSubslotNext;
+            }
+
+            AppObjectPoolFree(&g_zObjectPool[OBJECT_POOL_SLOT], pzSlot);
+            pzSlot = pzSlotNext;
+        }
+
+        AppObjectPoolFree(&g_zObjectPool[OBJECT_POOL_API_LIST], pzApi);
+        pzApi = pzApiNext;
+
+    }
+
+    g_zApiARContext.api_list = NULL;
+#ifdef USE_HANDLE_INDEX
+    memset(g_zHandleIndex, 0, sizeof(g_zHandleIndex));
+#endif
+    g_byApiState = STATE_INITIAL;
+
+#ifdef DIAGNOSIS_ENABLE
+    g_wNumberOfDiagEntries = 0;
+#endif
+#ifdef USE_DIAG_INDEX
+    g_wDiagIndexUsed = 0;
+    memset(g_wDiagIndexChain, 0xFF, sizeof(g_wDiagIndexChain));
+    g_wDiagBatchEntries = 0;
+    g_bDiagBatchOpen = TPS_FALSE;
+#endif
+    memset(g_byRecordReqFlag, 0, sizeof(g_byRecordReqFlag));
+#ifdef USE_ALARM_QUEUE
+    AppAlarmQueueFlush(AR_0);
+    AppAlarmQueueFlush(AR_1);
+#endif
+#ifdef USE_RECORD_REGISTRY
+    for (wEntry = 0; wEntry < g_wRecordRegistryUsed; wEntry++)
+    {
+        AppRecordCacheInvalidate(&g_zRecordRegistry[wEntry]);
+    }
+#endif
+
+    return TPS_ACTION_OK;
+}
+
+/*!@} Configuration Interface*/
+
+/*! \addtogroup eventCom Event Communication Interface
+ *@{
+ */
+
+/*!
+ * \brief       This function is called from an ISR routine or is used for polling the event register (events from the TPS-1
+ *              to the host CPU. The function checks each possible event from the TPS Stack and calls the previously registered
+                callback functions.
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32 TPS_ACTION_OK
+ */
+USIGN32 TPS_CheckEvents(VOID)
+{
+    USIGN32 dwRetval;
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    dwRetval = AppCheckEvents();
+
+    TPS_PROFILE_LEAVE(TPS_PROFILE_CHECK_EVENTS, dwProfileStart, 0);
+
+    return dwRetval;
+}
+
+/*!
+ * \brief       Reads the event register and calls the handlers of g_zEventHandler (see TPS_CheckEvents()).
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32 TPS_ACTION_OK
+ */
+static USIGN32 AppCheckEvents(VOID)
+{
+    USIGN32 dwEventRegValue = 0;
+    USIGN32 dwPending = 0;
+    USIGN32 dwEventBit = 0;
+    USIGN32 dwAckBefore = 0;
+    USIGN32 dwAckAfter = 0;
+    USIGN32 dwAckGroup = 0;
+    USIGN32 dwPrio = 0;
+    const T_EVENT_HANDLER* pzHandler = NULL;
+
+    TPS_GetValue32(((USIGN8*)EVENT_REGISTER_TPS), &dwEventRegValue);
+#ifdef USE_ALARM_QUEUE
+    g_dwEventPolls++;
+#endif
+
+    /* Drop events without handler and collect the acknowledges.            */
+    /*----------------------------------------------------------------------*/
+    dwPending = dwEventRegValue;
+    while (dwPending != 0)
+    {
+        dwEventBit = TPS_COUNT_TRAILING_ZEROS(dwPending);
+        dwPending &= (dwPending - 1);
+
+        pzHandler = &g_zEventHandler[dwEventBit];
+
+        if (pzHandler->pfnHandler == NULL)
+        {
+            dwEventRegValue &= ~TPS_EVENT_MASK(dwEventBit);
+        }
+        else if (pzHandler->byAckMode == EVENT_ACK_BEFORE)
+        {
+            dwAckBefore |= TPS_EVENT_MASK(dwEventBit);
+        }
+        else if (pzHandler->byAckMode == EVENT_ACK_AFTER)
+        {
+            dwAckAfter |= TPS_EVENT_MASK(dwEventBit);
+        }
+    }
+
+    if (dwEventRegValue == 0)
+    {
+        return TPS_ACTION_OK;
+    }
+
+    /* Events whose mailbox may be reused by the TPS-1 while the handler    */
+    /* runs are acknowledged together before any handler is called.         */
+    /*----------------------------------------------------------------------*/
+    AppSetEventRegAppAcknMask(dwAckBefore);
+
+    /* Call the handlers in priority order, lower event bit first. The      */
+    /* EVENT_ACK_AFTER events of a group are acknowledged with one write    */
+    /* after its handlers, so connect, PrmEnd and abort are not held back   */
+    /* by the handlers of the low priority events.                          */
+    /*----------------------------------------------------------------------*/
+    for (dwPrio = 0; dwPrio < (sizeof(g_adwEventPrioMask) / sizeof(g_adwEventPrioMask[0])); dwPrio++)
+    {
+        dwPending = dwEventRegValue & g_adwEventPrioMask[dwPrio];
+        dwEventRegValue &= ~dwPending;
+        dwAckGroup = dwAckAfter & dwPending;
+
+        while (dwPending != 0)
+        {
+            dwEventBit = TPS_COUNT_TRAILING_ZEROS(dwPending);
+            dwPending &= (dwPending - 1);
+
+            pzHandler = &g_zEventHandler[dwEventBit];
+
+#ifdef DEBUG_API_TEST
+            printf("DEBUG_API > API: Event %lu\r\n", (unsigned long)dwEventBit);
+#endif
+            pzHandler->pfnHandler(pzHandler->dwParam);
+        }
+
+        AppSetEventRegAppAcknMask(dwAckGroup);
+    }
+
+    return TPS_ACTION_OK;
+}
+
+#ifdef TPS_EVENT_IRQ_MODE
+/*!
+ * \brief       Enables the host interrupt for all events of the TPS-1. Call it once after the
+ *              TPS-1 was started. Afterwards call TPS_DispatchEvents() instead of TPS_CheckEvents().
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32 TPS_ACTION_OK
+ */
+USIGN32 TPS_EnableEventIrq(VOID)
+{
+    TPS_SetValue32((USIGN8*)HOST_IRQ_MASK_HIGH, HOST_IRQ_MASK_ALL_ENABLED);
+
+    /* Events that occurred before are handled by the next dispatch.       */
+    g_byEventIrqPending = TPS_TRUE;
+
+    TPS_SetValue32((USIGN8*)HOST_EOI, HOST_EOI_REPEAT_TIME);
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       Must be called by the interrupt service routine of the host interrupt line.
+ *              Only the interrupt is latched, the SPI bus is not accessed in interrupt context
+ *              because it may be in use by the interrupted code.
+ *
+ * \param[in]   VOID
+ * \retval      none
+ */
+VOID TPS_EventIrqHandler(VOID)
+{
+    g_byEventIrqPending = TPS_TRUE;
+#ifdef USE_STARTUP_SERVICE
+    g_byStartupIrq = TPS_TRUE;
+#endif
+}
+
+/*!
+ * \brief       Deferred part of the event handling. If a host interrupt was latched the event
+ *              register is read, the registered callbacks are called (see TPS_CheckEvents())
+ *              and the interrupt is finished with HOST_EOI. Without a pending interrupt the
+ *              function returns without accessing the TPS-1.
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32 TPS_ACTION_OK
+ */
+USIGN32 TPS_DispatchEvents(VOID)
+{
+    if (g_byEventIrqPending == TPS_FALSE)
+    {
+        return TPS_ACTION_OK;
+    }
+
+    /* Clear before reading, an interrupt during the dispatch is kept.      */
+    g_byEventIrqPending = TPS_FALSE;
+
+    TPS_CheckEvents();
+
+    /* End of interrupt. If events are still pending, the TPS-1 raises the */
+    /* interrupt line again after HOST_EOI_REPEAT_TIME.                     */
+    TPS_SetValue32((USIGN8*)HOST_EOI, HOST_EOI_REPEAT_TIME);
+
+    return TPS_ACTION_OK;
+}
+#endif
+
+/*!
+ * \brief       This function delivers the last error code of an API function.
+ *
+ * \retval      the last error code
+ */
+USIGN32 TPS_GetLastError(VOID)
+{
+    return (g_dwLastErrorCode);
+}
+
+/*!
+ * \brief       This function checks if the TPS stack has started correctly after
+ *              reset or power up.
+ *              This function should be called several times until it returns
+ *              TPS_ACTION_OK to wait for the TPS stack to start.
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_STACK_VERSION_FAILED
+ */
+USIGN32 TPS_CheckStackStart(VOID)
+{
+    USIGN32 dwReturn     = TPS_ACTION_OK;
+    USIGN32 dwValue      = 0;   /* Return value for TPS_GetValue32().        */
+
+    /* Set addresses for header!                                             */
+    /*-----------------------------------------------------------------------*/
+    g_pzNrtConfigHeader = (NRT_APP_CONFIG_HEAD*)BASE_ADDRESS_NRT_AREA;
+
+
+    /* Wait for the TPS-1 protocol stack.                                    */
+    /*-----------------------------------------------------------------------*/
+    dwReturn = TPS_GetValue32((USIGN8*)(g_pzNrtConfigHeader), &dwValue);
+    if (dwReturn != TPS_ACTION_OK)
+    {
+        return (dwReturn);
+    }
+
+    /* Check if the stack has started.                                       */
+    /*-----------------------------------------------------------------------*/
+    if ( (dwValue & 0xFFFF0000) == STACK_START_NUMBER)
+    {
+        /* Check for the right stack version                                 */
+        /*-------------------------------------------------------------------*/
+        if ( (dwValue & 0x0000FFFF) == STACK_VERSION_NUMBER )
+        {
+            return (TPS_ACTION_OK);
+        }
+        else
+        {
+            return (TPS_ERROR_STACK_VERSION_FAILED);
+        }
+    }
+#ifdef FW_UPDATE_OVER_HOST
+    else if((dwValue == UPDATER_LIFE_SIGN) || (dwValue == HOST_LIFE_SIGN))
+    {
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: try to reset updater\n");
+#endif
+        TPS_StartFwStack();
+        return TPS_ERROR_STACK_START_FAILED;
+    }
+#endif
+    else
+    {
+        return (TPS_ERROR_STACK_START_FAILED);
+    }
+}
+
+#ifdef USE_STARTUP_SERVICE
+/*!
+ * \brief       Starts the startup state machine instead of the polling loops of
+ *              TPS_CheckStackStart() and TPS_StartDevice(). The startup is advanced by
+ *              TPS_StartupService(). When the TPS-1 stack is up, pfnConfigure() is called.
+ *              It calls TPS_InitApplicationInterface(), adds the device, APIs, modules
+ *              and submodules and registers the callbacks (configureDevice() of the example).
+ *              With TPS_EVENT_IRQ_MODE the host interrupt is enabled (TPS_EnableEventIrq())
+ *              as soon as the stack is up, so it can trigger the polls of TPS_StartDevice().
+ *
+ * \param[in]   pfnConfigure configuration of the device, returns TPS_ACTION_OK or an error
+ * \param[in]   pfnGetTimeMs time source in ms (e.g. HAL_GetTick())
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - TPS_ERROR_WRONG_API_STATE
+ *              - API_STARTUP_NULL_POINTER
+ */
+USIGN32 TPS_StartupBegin(USIGN32 (*pfnConfigure)(VOID), USIGN32 (*pfnGetTimeMs)(VOID))
+{
+    if((pfnConfigure == NULL) || (pfnGetTimeMs == NULL))
+    {
+        return API_STARTUP_NULL_POINTER;
+    }
+
+    if(g_byApiState != STATE_INITIAL)
+    {
+        return TPS_ERROR_WRONG_API_STATE;
+    }
 
-    pzSubslot->pt_output_data = (USIGN32*)g_pbyCurrentPointer;
-    g_pbyCurrentPointer += 4;
+    g_pfnStartupConfigure = pfnConfigure;
+    g_pfnStartupGetTimeMs = pfnGetTimeMs;
+    g_dwStartupBeginMs = pfnGetTimeMs();
+    g_dwStartupLastPollMs = g_dwStartupBeginMs;
+    g_dwStartupPollIntervalMs = 0;
 
-    pzSubslot->pt_offset_output_data = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    g_zStartupTimes.byPhase = STARTUP_WAIT_STACK;
+    g_zStartupTimes.dwStackUpMs = STARTUP_TIME_NONE;
+    g_zStartupTimes.dwConfigWrittenMs = STARTUP_TIME_NONE;
+    g_zStartupTimes.dwStartAckMs = STARTUP_TIME_NONE;
+    g_zStartupTimes.dwFirstArMs = STARTUP_TIME_NONE;
+    g_zStartupTimes.dwStackPolls = 0;
+    g_zStartupTimes.dwStartPolls = 0;
+    g_zStartupTimes.dwResult = TPS_ACTION_OK;
 
-    pzSubslot->pt_offset_output_iocs = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    return TPS_ACTION_OK;
+}
 
-    pzSubslot->pt_output_iocs = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+/*!
+ * \brief       Advances the startup of TPS_StartupBegin(). Call it until it returns
+ *              TPS_ACTION_OK, then once per main loop pass to record the time of the
+ *              first AR (no access to the TPS-1 after the start). The TPS-1 is only
+ *              polled when the backoff interval has elapsed or, with TPS_EVENT_IRQ_MODE,
+ *              the host interrupt was raised. Between the calls the application may sleep
+ *              until the next system tick.
+ *
+ * \param[in]   VOID
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : the device is started
+ *              - API_STARTUP_BUSY : call again
+ *              - API_STARTUP_NOT_STARTED
+ *              - TPS_ERROR_STACK_VERSION_FAILED, TPS_ERROR_WRONG_API_STATE or the error of
+ *                pfnConfigure() : startup failed
+ */
+USIGN32 TPS_StartupService(VOID)
+{
+    USIGN32 dwResult = TPS_ACTION_OK;
+    USIGN32 dwNowMs  = 0;
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    if(g_zStartupTimes.byPhase == STARTUP_IDLE)
+    {
+        return API_STARTUP_NOT_STARTED;
+    }
 
-    pzSubslot->pt_offset_output_iops = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+    if(g_zStartupTimes.byPhase == STARTUP_FAILED)
+    {
+        return g_zStartupTimes.dwResult;
+    }
 
-    pzSubslot->pt_output_iops = (USIGN8*)g_pbyCurrentPointer;
-    TPS_SetValue8((USIGN8*)g_pbyCurrentPointer, 0x00);
-    g_pbyCurrentPointer += 1;
+    dwNowMs = g_pfnStartupGetTimeMs();
 
-    DWORD_ALIGN(g_pbyCurrentPointer);
+    /* Wait for the TPS-1 protocol stack.                                    */
+    /*-----------------------------------------------------------------------*/
+    if(g_zStartupTimes.byPhase == STARTUP_WAIT_STACK)
+    {
+        if(AppStartupPollDue(dwNowMs) == TPS_FALSE)
+        {
+            return API_STARTUP_BUSY;
+        }
 
-    pzSubslot->pt_offset_output_DataStatus = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+        g_zStartupTimes.dwStackPolls++;
+        dwResult = TPS_CheckStackStart();
+        if(dwResult == TPS_ERROR_STACK_VERSION_FAILED)
+        {
+            return AppStartupFail(dwResult);
+        }
+        if(dwResult != TPS_ACTION_OK)
+        {
+            return API_STARTUP_BUSY;
+        }
 
-    pzSubslot->pt_output_DataStatus = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+        g_zStartupTimes.dwStackUpMs = dwNowMs - g_dwStartupBeginMs;
+        g_zStartupTimes.byPhase = STARTUP_CONFIGURE;
 
-    pzSubslot->pt_properties = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, 0x0000);
-    g_pbyCurrentPointer += 2;
+#ifdef TPS_EVENT_IRQ_MODE
+        /* From now on the TPS-1 signals its events by the host interrupt.  */
+        TPS_EnableEventIrq();
+#endif
+    }
 
-    /* Add Sync Application parameters only to DAP subslot*/
-    TPS_GetValue16((USIGN8*)pzSlotHandle->pt_slot_number, &wSlotNumber);
-    if((wSlotNumber == DAP_MODULE) && (wSubslotNumber == DAP_SUBMODULE))
+    /* The configuration is written at once.                                 */
+    /*-----------------------------------------------------------------------*/
+    if(g_zStartupTimes.byPhase == STARTUP_CONFIGURE)
     {
-        pzSubslot->poSyncAppParam = (T_ISOCHRON_PARAMETERS*)g_pbyCurrentPointer;
-        TPS_MemSet(g_pbyCurrentPointer, 0, sizeof(T_ISOCHRON_PARAMETERS));
-        g_pbyCurrentPointer += sizeof(T_ISOCHRON_PARAMETERS);
-        DWORD_ALIGN(g_pbyCurrentPointer);
-    }
+        dwResult = g_pfnStartupConfigure();
+        if(dwResult != TPS_ACTION_OK)
+        {
+            return AppStartupFail(dwResult);
+        }
 
-    pzSubslot->pt_submodule_state = (USIGN16*)g_pbyCurrentPointer;
-    TPS_SetValue16((USIGN8*)g_pbyCurrentPointer, SUBMODULE_OK);
-    g_pbyCurrentPointer += 2;
+        dwNowMs = g_pfnStartupGetTimeMs();
+        g_zStartupTimes.dwConfigWrittenMs = dwNowMs - g_dwStartupBeginMs;
+        g_zStartupTimes.byPhase = STARTUP_WAIT_START;
 
-    #ifdef DEBUG_API_SUBPLUG_MODULE
-        printf("DEBUG_API > API: TPS_PlugSubModule() > Submodule plugged\n");
-        printf("DEBUG_API > API: TPS_PlugSubModule() > Memory used 0x%d\n",
-               (USIGN32)(g_pbyCurrentPointer - g_pbyConfigNRTMem));
-    #endif
+        /* The first call of TPS_StartDevice() follows without delay.       */
+        g_dwStartupPollIntervalMs = 0;
+    }
 
-    #ifdef DEBUG_API_SUBPLUG_MODULE_PRINT
-        TPS_PrintSlotSubslotConfiguration();
-    #endif
+    /* Hand shake of TPS_StartDevice().                                      */
+    /*-----------------------------------------------------------------------*/
+    if(g_zStartupTimes.byPhase == STARTUP_WAIT_START)
+    {
+        if(AppStartupPollDue(dwNowMs) == TPS_FALSE)
+        {
+            return API_STARTUP_BUSY;
+        }
 
-    pzSubslot->poIM0 = pzIM0Data;
+        g_zStartupTimes.dwStartPolls++;
+        dwResult = TPS_StartDevice();
+        if(dwResult == TPS_ERROR_STACK_START_FAILED)
+        {
+            return API_STARTUP_BUSY;
+        }
+        if(dwResult != TPS_ACTION_OK)
+        {
+            return AppStartupFail(dwResult);
+        }
 
-    g_byApiState = STATE_SUBSLOT_RDY;
+        g_zStartupTimes.dwStartAckMs = dwNowMs - g_dwStartupBeginMs;
+        g_zStartupTimes.byPhase = STARTUP_RUNNING;
+    }
 
-    return pzSubslot;
+    /* Time of the first AR, the AR state is kept by the event handlers.     */
+    /*-----------------------------------------------------------------------*/
+    if((g_zStartupTimes.byPhase == STARTUP_RUNNING)
+        && ((g_dwArEstablished_0 != AR_NOT_IN_OPERATION)
+        || (g_dwArEstablished_1 != AR_NOT_IN_OPERATION)
+        || (g_dwArEstablished_IOSR != AR_NOT_IN_OPERATION)))
+    {
+        g_zStartupTimes.dwFirstArMs = dwNowMs - g_dwStartupBeginMs;
+        g_zStartupTimes.byPhase = STARTUP_DONE;
+    }
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function resets the device configuration event to the TPS-1
- *              only if the device isn't connected
-                Call TPS_CleanApiConf() afterwards to initialize the configuration in the application.
+ * \brief       Delivers the current phase and the times of the startup phases.
  *
+ * \param[out]  pzTimes phase, times in ms since TPS_StartupBegin() (STARTUP_TIME_NONE if
+ *              the phase was not reached) and the number of polls
  * \retval      USIGN32
  *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_AR_STILL_ACTIVE
+ *              - API_STARTUP_NULL_POINTER
  */
-USIGN32 TPS_ResetDeviceConfig(VOID)
+USIGN32 TPS_GetStartupTimes(T_STARTUP_TIMES* pzTimes)
 {
-    if ((g_dwArEstablished_0 != AR_NOT_IN_OPERATION)
-        || (g_dwArEstablished_1 != AR_NOT_IN_OPERATION)
-        || (g_dwArEstablished_IOSR != AR_NOT_IN_OPERATION))
+    if(pzTimes == NULL)
     {
-        return TPS_ERROR_AR_STILL_ACTIVE;
+        return API_STARTUP_NULL_POINTER;
     }
-    return AppSetEventRegApp(APP_EVENT_RESET_STACK_CONFIG);
+
+    *pzTimes = g_zStartupTimes;
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function registers the I&M Data for the given Slot.
+ * \brief       Checks if the next poll of the TPS-1 is due. If so, the backoff interval
+ *              is doubled up to STARTUP_POLL_MAX_MS.
  *
- * \param[in]   pzSubslot handle to the sub slot structure
- * \param[in]   pzIM0Data pointer to the I&M0 data buffer
- * \param[in]   pzIM1Data pointer to the I&M1 data buffer or NULL
- * \param[in]   pzIM2Data pointer to the I&M2 data buffer or NULL
- * \param[in]   pzIM3Data pointer to the I&M3 data buffer or NULL
- * \param[in]   pzIM4Data pointer to the I&M4 data buffer or NULL
- * \retval      possible return values:
- *              - TPS_ACTION_OK : success
- *              - REGISTER_IM_SUBSLOT_NOT_FOUND
+ * \param[in]   dwNowMs current time
+ * \retval      BOOL TPS_TRUE if the TPS-1 shall be polled now
  */
-USIGN32 TPS_RegisterIMDataForSubslot(SUBSLOT* pzSubslot, T_IM0_DATA* pzIM0Data, T_IM1_DATA* pzIM1Data,
-    T_IM2_DATA* pzIM2Data, T_IM3_DATA* pzIM3Data, T_IM4_DATA* pzIM4Data)
+static BOOL AppStartupPollDue(USIGN32 dwNowMs)
 {
-    USIGN32 dwRetval = TPS_ACTION_OK;
-    USIGN32 dwApi = 0x00;
-    USIGN16 wSlotNumber = 0x00;
-    USIGN16 wSubslotNumber = 0x00;
+    BOOL bDue = TPS_FALSE;
 
-    /* The registration of I&M Data is only allowed on the DAP. */
-    dwRetval = AppGetSlotInfoFromHandle(pzSubslot, &dwApi, &wSlotNumber, &wSubslotNumber);
-    if (dwRetval != TPS_ACTION_OK)
+#ifdef TPS_EVENT_IRQ_MODE
+    if(g_byStartupIrq == TPS_TRUE)
     {
-        dwRetval = REGISTER_IM_SUBSLOT_NOT_FOUND;
+        g_byStartupIrq = TPS_FALSE;
+        bDue = TPS_TRUE;
     }
+#endif
 
-    /* Set the data. */
-    if ((dwRetval == TPS_ACTION_OK) &&
-        (pzIM0Data != NULL))
+    if((dwNowMs - g_dwStartupLastPollMs) >= g_dwStartupPollIntervalMs)
     {
-        pzIM0Data->IM_Supported = IM_NOT_SUPPORTED;
-        pzSubslot->poIM0 = pzIM0Data;
+        bDue = TPS_TRUE;
+    }
 
-        if (pzIM1Data != NULL)
-        {
-            pzIM0Data->IM_Supported |= IM1_SUPPORTED;
-            pzSubslot->poIM0->p_im1 = pzIM1Data;
-        }
-        else
-        {
-            pzSubslot->poIM0->p_im1 = NULL;
-        }
+    if(bDue == TPS_TRUE)
+    {
+        g_dwStartupLastPollMs = dwNowMs;
 
-        if (pzIM2Data != NULL)
+        if(g_dwStartupPollIntervalMs < STARTUP_POLL_MIN_MS)
         {
-            pzIM0Data->IM_Supported |= IM2_SUPPORTED;
-            pzSubslot->poIM0->p_im2 = pzIM2Data;
+            g_dwStartupPollIntervalMs = STARTUP_POLL_MIN_MS;
         }
-        else
+        else if(g_dwStartupPollIntervalMs < STARTUP_POLL_MAX_MS)
         {
-            pzSubslot->poIM0->p_im2 = NULL;
+            g_dwStartupPollIntervalMs *= 2;
+            if(g_dwStartupPollIntervalMs > STARTUP_POLL_MAX_MS)
+            {
+                g_dwStartupPollIntervalMs = STARTUP_POLL_MAX_MS;
+            }
         }
+    }
 
-        if (pzIM3Data != NULL)
-        {
-            pzIM0Data->IM_Supported |= IM3_SUPPORTED;
-            pzSubslot->poIM0->p_im3 = pzIM3Data;
-        }
-        else
-        {
-            pzSubslot->poIM0->p_im3 = NULL;
-        }
+    return bDue;
+}
+
+/*!
+ * \brief       Ends the startup with an error.
+ *
+ * \param[in]   dwResult error
+ * \retval      USIGN32 dwResult
+ */
+static USIGN32 AppStartupFail(USIGN32 dwResult)
+{
+    g_zStartupTimes.byPhase = STARTUP_FAILED;
+    g_zStartupTimes.dwResult = dwResult;
+
+    return dwResult;
+}
+#endif
+
+/*!
+ * \brief       This function registers all callback functions that process the context management and the record interface.
+ *
+ * \param[in]   which event type ( ONCONNECT_CB, ONCONNECTDONE_CB, ONABORT_CB,
+                ONREADRECORD_CB, ONWRITERECORD_CB, ON_PRM_END_DONE_CB,
+                ONRESET_CB)
+ * \param[in]   pfnFunc pointer to the callback function that shall be linked to the event.
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - REGISTER_FUNCTION_NULL
+ *              - REGISTER_RPC_ERROR
+ */
+USIGN32 TPS_RegisterRpcCallback(USIGN8 which, VOID(*pfnFunc)(USIGN32))
+{
+    if (pfnFunc == NULL)
+    {
+        return REGISTER_FUNCTION_NULL;
+    }
+
+    switch (which)
+    {
+    case ONCONNECT_CB:
+        g_zApiARContext.OnConnect_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnConnect CB function\n");
+#endif
+        break;
+
+    case ONCONNECTDONE_CB:
+        g_zApiARContext.OnConnectDone_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnConnectDone CB function\n");
+#endif
+        break;
+
+    case ONABORT_CB:
+        g_zApiARContext.OnAbort_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnAbort CB function\n");
+#endif
+        break;
+
+    case ONREADRECORD_CB:
+        g_zApiARContext.OnReadRecord_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnReadRecord CB function\n");
+#endif
+        break;
+
+    case ONWRITERECORD_CB:
+        g_zApiARContext.OnWriteRecord_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnWriteRecord CB function\n");
+#endif
+        break;
+
+    case ON_PRM_END_DONE_CB:
+        g_zApiARContext.OnPRMEND_Done_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered On Parameter End Done CB function\n");
+#endif
+        break;
+
+    case ONREAD_CB:
+        g_zApiARContext.OnRead = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnRead CB function\n");
+#endif
+        break;
+
+    case ONWRITE_DONE_CB:
+        g_zApiARContext.OnWriteDone = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnWrite CB function\n");
+#endif
+        break;
 
-        if (pzIM4Data != NULL)
-        {
-            pzIM0Data->IM_Supported |= IM4_SUPPORTED;
-            pzSubslot->poIM0->p_im4 = pzIM4Data;
-        }
-        else
-        {
-            pzSubslot->poIM0->p_im4 = NULL;
-        }
+    case ONRESET_CB:
+    {
+        g_zApiARContext.OnReset_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnReset CB function\n");
+#endif
+        break;
+    }
+    case ONFSUPARAM_CB:
+    {
+        g_zApiARContext.OnFSUParamChange_CB = pfnFunc;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: registered OnFsuParameterChange CB function\n");
+#endif
+        break;
     }
+    default:
+        return(REGISTER_RPC_ERROR);
+    }  /* End of switch */
 
-    return dwRetval;
+    return (TPS_ACTION_OK);
 }
 
 /*!
- * \brief       This function returns the MAC Addresses of the TPS-1.
+ * \brief       This function registers all callback functions that process the alarm interface (ONALARM_CB, ONDIAGN_CB).
  *
- * \param[out]  pbyInterfaceMac pointer to the buffer in which the interface MAC address will be stored.
-                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
- * \param[out]  pbyPort1Mac pointer to the buffer in which the MAC address of port 1 will be stored.
-                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
- * \param[out]  pbyPort2Mac pointer to the buffer in which the MAC address of port 2 will be stored.
-                <b>Buffer must have at least the size MAC_ADDRESS_SIZE
- * \note        The size for all buffers has to be MAC_ADDRESS_SIZE or NULL
- * \retval      TPS_ACTION_OK
+ * \param[in]   byWhich event type (ONALARM_CB or ONDIAG_CB)
+ * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - REGISTER_FUNCTION_NULL
+ *              - REGISTER_ALARM_ERROR
  */
-USIGN32 TPS_GetMacAddresses(USIGN8* pbyInterfaceMac, USIGN8* pbyPort1Mac, USIGN8* pbyPort2Mac)
+USIGN32 TPS_RegisterAlarmDiagCallback(USIGN8 byWhich, VOID(*pfnFunction)(USIGN16, USIGN32))
 {
-    if (pbyInterfaceMac != NULL)
+    if (pfnFunction == NULL)
     {
-        TPS_GetValueData(g_pzNrtConfigHeader->byInterfaceMac, pbyInterfaceMac, MAC_ADDRESS_SIZE);
+        return REGISTER_FUNCTION_NULL;
     }
 
-    if (pbyPort1Mac != NULL)
+    switch (byWhich)
     {
-        TPS_GetValueData(g_pzNrtConfigHeader->byPort1Mac, pbyPort1Mac, MAC_ADDRESS_SIZE);
-    }
+     case ONALARM_CB:
+       {
+          g_zApiARContext.OnAlarm_Ack_CB = pfnFunction;
+#ifdef DEBUG_API_TEST
+          printf("DEBUG_API > API: registered OnAlarm CB function\n");
+#endif
+       }
+       break;
 
-    if (pbyPort2Mac != NULL)
-    {
-        TPS_GetValueData(g_pzNrtConfigHeader->byPort2Mac, pbyPort2Mac, MAC_ADDRESS_SIZE);
+     case ONDIAG_CB:
+       {
+       g_zApiARContext.OnDiag_Ack_CB = pfnFunction;
+#ifdef DEBUG_API_TEST
+       printf("DEBUG_API > API: registered OnDiag CB function\n");
+#endif
+       }
+       break;
+
+     default:
+       return REGISTER_ALARM_ERROR;
     }
 
-    return(TPS_ACTION_OK);
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function returns the IP configuration of the TPS-1.
+* \brief       This function registers the DCP callback functions that have one parameter (Set IP, FactoryReset).
+*
+* \param[in]   byWhich (ONDCP_SET_IP_ADDR_CB or ONDCP_FACT_RESET_CB)
+* \param[in]   pfnFunction callback function pointer
+* \retval      USIGN32
+*              - TPS_ACTION_OK : success
+*              - REGISTER_FUNCTION_NULL
+*              - REGISTER_DCP_ERROR
+*/
+USIGN32 TPS_RegisterDcpCallbackPara(USIGN8 byWhich, VOID(*pfnFunction)(USIGN32))
+{
+   if (pfnFunction == NULL)
+   {
+      return REGISTER_FUNCTION_NULL;
+   }
+
+   switch (byWhich)
+   {
+    case ONDCP_SET_IP_ADDR_CB:
+      {
+         g_zApiDeviceContext.OnSetStationIpAddr_CB = pfnFunction;
+#ifdef DEBUG_API_TEST
+         printf("DEBUG_API > API: registered OnSetStationIpAddr_CB function\n");
+#endif
+      }
+      break;
+    case ONDCP_SET_NAME_CB:
+      {
+         if(g_zApiDeviceContext.OnSetStationName_CB == NULL)
+         {
+            g_zApiDeviceContext.OnSetStationNameTP_CB = pfnFunction;
+         }
+         else
+         {
+#ifdef DEBUG_API_TEST
+            printf("DEBUG_API > API: ERROR by registering of OnSetStationName_CB function\n");
+#endif
+            return (REGISTER_DCP_ERROR);
+         }
+#ifdef DEBUG_API_TEST
+         printf("DEBUG_API > API: registered OnSetStationName_CB function\n");
+#endif
+      }
+      break;
+    case ONDCP_FACT_RESET_CB:
+      {
+         g_zApiDeviceContext.OnResetFactorySettings_CB = pfnFunction;
+#ifdef DEBUG_API_TEST
+         printf("DEBUG_API > API: registered OnResetFactorySettings_CB function\n");
+#endif
+      }
+      break;
+
+    default:
+      return (REGISTER_DCP_ERROR);
+   } /* End of switch */
+
+   return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function registers all callback functions that
+ *              processes the DCP interface (Set Name, Set IO, FactoryReset, Flashing).
  *
- * \param[out]  pdwIPAddress pointer in which the IP address will be stored
- * \param[out]  pdwSubnetMask pointer in which the subnet mask will be stored
- * \param[out]  pdwGateway pointer in which the default gateway will be stored
- * \retval      USIGN32 TPS_ACTION_OK
+ * \param[in]   byWhich event type (ONDCP_SET_NAME_CB or ONDCP_BLINK_CB)
+ * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - REGISTER_FUNCTION_NULL
+ *              - REGISTER_DCP_ERROR
  */
-USIGN32 TPS_GetIPConfig(USIGN32* pdwIPAddress, USIGN32* pdwSubnetMask, USIGN32* pdwGateway)
+USIGN32 TPS_RegisterDcpCallback(USIGN8 byWhich, VOID(*pfnFunction)(VOID))
 {
-    if (pdwIPAddress != NULL)
-    {
-        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwIPAddress), (USIGN8*)pdwIPAddress, IP_ADDRESS_SIZE);
-    }
+   if (pfnFunction == NULL)
+   {
+      return REGISTER_FUNCTION_NULL;
+   }
 
-    if (pdwSubnetMask != NULL)
-    {
-        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwSubnetMask), (USIGN8*)pdwSubnetMask, IP_ADDRESS_SIZE);
-    }
+   switch (byWhich)
+   {
+    case ONDCP_SET_NAME_CB:
+      {
+         if(g_zApiDeviceContext.OnSetStationNameTP_CB == NULL)
+         {
+            g_zApiDeviceContext.OnSetStationName_CB = pfnFunction;
+         }
+         else
+         {
+#ifdef DEBUG_API_TEST
+            printf("DEBUG_API > API: ERROR by registering of OnSetStationName_CB function\n");
+#endif
+            return (REGISTER_DCP_ERROR);
+         }
+#ifdef DEBUG_API_TEST
+         printf("DEBUG_API > API: registered OnSetStationName_CB function\n");
+#endif
+      }
+      break;
 
-    if (pdwGateway != NULL)
-    {
-        TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->dwGateway), (USIGN8*)pdwGateway, IP_ADDRESS_SIZE);
-    }
+    case ONDCP_BLINK_CB:
+      {
+         g_zApiDeviceContext.OnSetStationDcpSignal_CB = pfnFunction;
+#ifdef DEBUG_API_TEST
+         printf("DEBUG_API > API: registered OnSetStationDcpSignal_CB function\n");
+#endif
+      }
+      break;
 
-    return(TPS_ACTION_OK);
+    default:
+      return (REGISTER_DCP_ERROR);
+   } /* End of switch */
+
+   return TPS_ACTION_OK;
 }
 
+#ifdef USE_TPS_COMMUNICATION_CHANNEL
 /*!
- * \brief       This function writes the actual name of station of the TPS-1 into buffer pbyName.
+ * \brief       This function registers a callback function that processes the TPS_EVENT_TPS_MESSAGE event.
+                See TPS_InitTPSComChannel().
  *
- * \param[out]  pbyName pointer to a buffer in which the name is stored.
- * \param[in]   dwBufferLength length of the buffer. The length must be at least STATION_NAME_LEN+1
- * \retval      USIGN32
+ * \note        To use this function <b>USE_TPS_COMMUNICATION_CHANNEL</b> in TPS_1_user.h must be defined.
+ * \param[in]   pfnFunction
+ * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_NULL_POINTER
- *              - TPS_ERROR_BUFFER_TOO_SMALL
+ *              - REGISTER_FUNCTION_NULL
  */
-USIGN32 TPS_GetNameOfStation(USIGN8* pbyName, USIGN32 dwBufferLength)
+USIGN32 TPS_RegisterTPSMessageCallback(void(*pfnFunction)(T_ETHERNET_MAILBOX*))
 {
-    if (pbyName == NULL)
+    if (pfnFunction == NULL)
     {
-        return TPS_ERROR_NULL_POINTER;
+        return REGISTER_FUNCTION_NULL;
     }
 
-    if (dwBufferLength < (STATION_NAME_LEN + 1))
+    g_oApiTpsMsgContext.OnTpsMessageRX_CB = pfnFunction;
+
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > API: registered OnTpsMessageRX_CB function\n");
+#endif
+
+    return (TPS_ACTION_OK);
+}
+#endif
+/*!
+ * \brief       This function registers a callback function that
+ *              processes the TPS_EVENT_ETH_FRAME_REC event.
+ *
+ * \note        To use this function <b>USE_ETHERNET_INTERFACE</b> in TPS_1_user.h must be defined.
+ * \param[in]   pfnFunction callback function pointer
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - REGISTER_FUNCTION_NULL
+ */
+#ifdef USE_ETHERNET_INTERFACE
+USIGN32 TPS_RegisterEthernetReceiveCallback(void(*pfnFunction)(T_ETHERNET_MAILBOX*))
+{
+    if (pfnFunction == NULL)
     {
-        return TPS_ERROR_BUFFER_TOO_SMALL;
+        return REGISTER_FUNCTION_NULL;
     }
 
-    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), pbyName, STATION_NAME_LEN);
-    pbyName[STATION_NAME_LEN] = 0;
+    g_zApiEthernetContext.OnEthernetFrameRX_CB = pfnFunction;
 
-    return TPS_ACTION_OK;
-}
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > API: registered OnEthernetFrameRX_CB function\n");
+#endif
 
+    return (TPS_ACTION_OK);
+}
+#endif
 /*!
- * \brief       This function writes the serial number of the device into buffer pbySerialnumber.
-                The Serialnumber is set with the TPS Configurator and must also be used in the I&M data of this application.
+* \brief        This function registers the callback function that is called when RecordInputDataObjectElement (index 0x8028)
+                RecordOutputDataObjectElement (index 0x8028) for a specific subslot is read.
+                These Record Indexes must contain the actual process data of this subslot.
  *
- * \param[out]  pbySerialnumber pointer to a buffer in which the serial number will be stored.
- * \param[in]   dwSerialLength length of the buffer. The length must be at least IM0_SERIALNUMBER_LEN+1
+ * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
  * \retval      USIGN32
- *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_NULL_POINTER
- *              - TPS_ERROR_BUFFER_TOO_SMALL
+ *               - TPS_ACTION_OK : success
+ *               - REGISTER_FUNCTION_NULL
+ * \note        These correct responses to these record request are mandatory for the PROFINET certification.
  */
-USIGN32 TPS_GetSerialnumber(USIGN8 *pbySerialnumber, USIGN32 dwSerialLength)
+USIGN32 TPS_RegisterRecordDataObjectCallback(USIGN32(*pfnFunction)(T_RECORD_DATA_OBJECT_TYPE zObjectToRead,
+    SUBSLOT* pzSubslot,
+    USIGN8* pbyIocs, USIGN8* pbyIops,
+    USIGN8* pbyData, USIGN16 wDatalength,
+    USIGN16* pwSubstituteActiveFlag))
 {
-    if (pbySerialnumber == NULL)
-    {
-        return TPS_ERROR_NULL_POINTER;
-    }
-    if (dwSerialLength < (IM0_SERIALNUMBER_LEN + 1))
+    if (pfnFunction == NULL)
     {
-        return TPS_ERROR_BUFFER_TOO_SMALL;
+        return REGISTER_FUNCTION_NULL;
     }
-    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->bySerialnumber), pbySerialnumber, IM0_SERIALNUMBER_LEN);
-    pbySerialnumber[IM0_SERIALNUMBER_LEN] = 0;
+
+    g_zApiARContext.OnReadRecordDataObject_CB = pfnFunction;
 
     return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function returns the order Id of the device.
-                The order ID is initially set with the TPS Configurator but can also be changed with TPS_SetOrderId().
-                The I&M0 data of this application must have the same order ID as returned in this function.
+ * \brief       This function forces the TPS stack to reset (SW reset).
  *
- * \param[out]  pbyOrderId pointer to a buffer in which the orderId will be stored.
- * \param[in]   dwOrderIdLength length of the buffer. The length must be at least IM0_ORDERID_LEN+1
- * \retval      USIGN32
- *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_NULL_POINTER
- *              - TPS_ERROR_BUFFER_TOO_SMALL
+ * \retval      VOID
  */
-USIGN32 TPS_GetOrderId(USIGN8 *pbyOrderId, USIGN32 dwOrderIdLength)
+VOID TPS_SoftReset(VOID)
 {
-    if (pbyOrderId == NULL)
-    {
-        return TPS_ERROR_NULL_POINTER;
-    }
-    if (dwOrderIdLength < (IM0_ORDERID_LEN + 1))
-    {
-        return TPS_ERROR_BUFFER_TOO_SMALL;
-    }
-    TPS_GetValueData((USIGN8*)&(g_pzNrtConfigHeader->byOrderId), pbyOrderId, IM0_ORDERID_LEN);
-    pbyOrderId[IM0_ORDERID_LEN] = 0;
-
-    return TPS_ACTION_OK;
+    AppSetEventRegApp(APP_EVENT_RESET_PN_STACK);
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > API: TPS Stack Reset Event was set!\n");
+#endif
 }
 
+/*!@} Event Communication Interface*/
+
+ /*! \addtogroup  iodata Cyclic Data Interface (IO data)
+ *@{
+*/
+
 /*!
- * \brief       This function sets the orderId of the device. If you use this
- *              function the orderId defined with the TPS-Configurator isn't
- *              valid anymore. Instead this new orderId is used.
+ * \brief       This function returns the connection state of an application relation (AR).
  *
- * \param[in]   pbyOrderId pointer to a buffer where the new orderId is defined
- * \param[in]   dwOrderIdLength length of the buffer. The length can be up to IM0_ORDERID_LEN bytes
+ * \param[in]   dwARNumber (AR_0, AR_1, AR_IOSR - number of AR)
  * \retval      USIGN32
- *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_NULL_POINTER
- *              - TPS_ERROR_BUFFER_TOO_BIG
+ *              - AR_ESTABLISHED
+ *              - AR_NOT_IN_OPERATION
  */
-USIGN32 TPS_SetOrderId(USIGN8 *pbyOrderId, USIGN32 dwOrderIdLength)
+USIGN32 TPS_GetArEstablished(USIGN32 dwARNumber)
 {
-    char tempBuf[IM0_ORDERID_LEN] = {0};
+    USIGN32 dwConnectState = TPS_ACTION_OK;
 
-    if (pbyOrderId == NULL)
-    {
-        return TPS_ERROR_NULL_POINTER;
-    }
-    if (dwOrderIdLength > IM0_ORDERID_LEN)
+    switch (dwARNumber)
     {
-        return TPS_ERROR_BUFFER_TOO_BIG;
+    case AR_0:
+        dwConnectState = g_dwArEstablished_0;
+        break;
+    case AR_1:
+        dwConnectState = g_dwArEstablished_1;
+        break;
+    case AR_IOSR:
+        dwConnectState = g_dwArEstablished_IOSR;
+        break;
+    default:
+        dwConnectState = 0xFFFF;
+        break;
     }
-    memset(tempBuf, 0x20, IM0_ORDERID_LEN);
-    memcpy(tempBuf, pbyOrderId, dwOrderIdLength);
-    return TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byOrderId), (USIGN8*)tempBuf, IM0_ORDERID_LEN);
+
+    return(dwConnectState);
 }
 
-#ifndef USE_INT_APP
+
 /*!
- * \brief       This function changes the name of station. This is the name of the interface that uniquely defines the device in the network.
+ * \brief       This function reads the output data out of the cyclic data frame that is stored in the active Output Buffer in the IO-RAM.
+                There are three Output buffers for cyclic frames. The active buffer is changed with TPS_UpdateOutputData().
  *
- * \param[in]   pbyNameBuf pointer to the name of station string buffer
- * \param[in]   dwLenOfName length of the name of station
- * \param[in]   byAttr DCP_SET_PROTECTED: The name of station cannot be changed by dcp.set requests, DCP_SET_ALLOWED: The name of station can be changed by dcp.set requests
- * \retval      possible return values:
- *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_NULL_POINTER
- *              - TPS_ERROR_WRONG_API_STATE
- *              - API_DEVICE_NAME_TOO_LONG
- *              - API_WRONG_PARAMETER
+ * \param[in]   pzSubslot handle to the subslot
+ * \param[in]   pbyData pointer to the data buffer where the output data shall be stored
+ * \param[in]   wDataLength length of the data buffer ( pbyData )
+ * \param[out]  pbyState IOPS of this submodule that is received in the cyclic data frame is written here. The data are only valid if pbyState == IOXS_GOOD.
+ * \retval      USIGN32
+ *              - on success the function will return the length of the data
+ *              - possible errors that can be get with TPS_GetLastError():
+                  API_IODATA_NULL_POINTER, API_IODATA_MODULE_HAS_NO_OUTPUTS, API_IODATA_WRONG_BUFFER_LENGTH
  */
-USIGN32 TPS_SetNameOfStation(USIGN8* pbyNameBuf, USIGN32 dwLenOfName, USIGN8 byAttr)
+USIGN32 TPS_ReadOutputData(SUBSLOT* pzSubslot, USIGN8* pbyData, USIGN16 wDataLength, USIGN8* pbyState)
 {
-    USIGN8 byAccessMode = 0;
-    USIGN8 byNameOfStationBuff[STATION_NAME_LEN];
+    USIGN8* pbyIOMemory = NULL;
+    USIGN16 wOffsetValueData = 0;
+    USIGN16 wSizeOutputData = 0;
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+    USIGN8* pbyImage = NULL;
+#endif
 
-    if (g_pzNrtConfigHeader == NULL)
+    /* Check the pointer                                                    */
+    /*----------------------------------------------------------------------*/
+    if ((pzSubslot == NULL) || (pbyData == NULL))
     {
-        return TPS_ERROR_WRONG_API_STATE;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: TPS_ReadOutputData NULL pointer");
+#endif
+        AppSetLastError(API_IODATA_NULL_POINTER);
+        return 0;
     }
-    else if (dwLenOfName > STATION_NAME_LEN)
+
+    if (wDataLength == 0x00)
     {
-        return API_DEVICE_NAME_TOO_LONG;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: TPS_ReadOutputData no output module.");
+#endif
+        AppSetLastError(API_IODATA_MODULE_HAS_NO_OUTPUTS);
+        return 0;
     }
-    else if ((byAttr != DCP_SET_PROTECTED) && (byAttr != DCP_SET_ALLOWED))
+
+    /* Get size of data                                                     */
+    /*----------------------------------------------------------------------*/
+#ifdef USE_SUBSLOT_IO_CACHE
+    pzCache = AppGetSubslotIoCache(pzSubslot);
+    if (pzCache->bValid != TPS_TRUE)
     {
-        return API_WRONG_PARAMETER;
+        /* Subslot is not used in a CR, take the values out of the DPRAM.   */
+        AppReadSubslotIoDescriptor(pzSubslot, pzCache);
     }
-    else if (pbyNameBuf == NULL)
+    wSizeOutputData = pzCache->wSizeOutputData;
+#else
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_size_output_data),
+        &wSizeOutputData);
+#endif
+
+    /* Check the data length                                                  */
+    /*----------------------------------------------------------------------*/
+    if (wSizeOutputData != wDataLength)
     {
-        return TPS_ERROR_NULL_POINTER;
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: Wrong buffer length. Given: 0x%X, Expected: 0x%X\n",
+            wDataLength, wSizeOutputData);
+#endif
+        AppSetLastError(API_IODATA_WRONG_BUFFER_LENGTH);
+        return 0;
     }
 
-    /* get actual value */
-    TPS_GetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), &byAccessMode);
-    byAccessMode = (byAccessMode & 0xFE) | (byAttr & 0x1);
+#ifdef USE_SUBSLOT_IO_CACHE
+    pbyIOMemory = pzCache->pbyOutputMemory;
+    wOffsetValueData = pzCache->wOffsetOutputData;
+#else
+    /* Get the pointer to the output data!                                  */
+    /*----------------------------------------------------------------------*/
+    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_output_data), &pbyIOMemory);
 
-    /* reset name data */
-    memset(&byNameOfStationBuff, 0, STATION_NAME_LEN);
-    TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), (USIGN8*)&byNameOfStationBuff, STATION_NAME_LEN);
+    /* Get the offset from beginning IO Area to output data!                */
+    /*----------------------------------------------------------------------*/
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_output_data), &wOffsetValueData);
+#endif
 
-    /* write the name of device */
-    TPS_SetValueData((USIGN8*)&(g_pzNrtConfigHeader->byStationName), pbyNameBuf, dwLenOfName);
-    TPS_SetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), byAccessMode);
+#ifdef USE_IO_FRAME_IMAGE
+    /* Take data and IOPS out of the output frame image if available.       */
+    /*----------------------------------------------------------------------*/
+    pbyImage = AppGetIoFrameImageAddress(pzCache, pbyIOMemory, wOffsetValueData, wSizeOutputData + 1);
+    if (pbyImage != NULL)
+    {
+        memcpy(pbyData, pbyImage, wSizeOutputData);
+        *pbyState = pbyImage[wSizeOutputData];
 
+        return wSizeOutputData;
+    }
+#endif
 
-    return TPS_ACTION_OK;
+    /* Add offset to memory pointer!                                        */
+    /*----------------------------------------------------------------------*/
+    pbyIOMemory += wOffsetValueData;
+
+#ifdef DEBUG_API_TEST
+    /* printf("DEBUG_API > API: Address of Output Data (IO-Area): 0x%x\n", (USIGN32)pbyIOMemory);
+    printf("Size Output Data (IO-Area): %d\n",wSizeOutputData); */
+#endif
+
+    /* Get the data out of the DPRAM.                                       */
+    /*----------------------------------------------------------------------*/
+    TPS_GetValueData(pbyIOMemory, pbyData, wSizeOutputData);
+
+    /* Get State Byte from the DPRAM                                        */
+    /*----------------------------------------------------------------------*/
+    TPS_GetValue8((USIGN8*)(pbyIOMemory + wSizeOutputData), pbyState);
+
+    return wSizeOutputData; /* Return size of data!                         */
 }
 
+
 /*!
- * \brief       This function temporarily changes the IP configuration of the device. The new IP configuration is not written into flash, so after a reboot
- *              the last known IP Address is used. With the parameter DCP_SET_PROTECTED it's also possible to prevent setting of new IP addresses from external
- *              sources.
- *              <br><br>If you want to change the IP configuration permanently, please refer to TPS_DcpSetDeviceIP().
+ * \brief       This function initiates a buffer change of the cyclic output data to get the latest output data.
+                The function returns after the buffer was successfully changed or the TPS-1 did not answer
+                within BUFFER_CHANGE_TIMEOUT_POLLS status reads. A pending buffer change that was started
+                with TPS_StartUpdateInputData() or TPS_StartUpdateOutputData() is finished first.
+                There are three output buffers for each AR.
  *
- * \param[in]   dwIPAddr the IP address
- * \param[in]   dwSubNetMask the subnet mask
- * \param[in]   dwGateway the gateway
- * \param[in]   byAttr DCP_SET_PROTECTED: The IP configuration cannot be changed by dcp.set requests, DCP_SET_ALLOWED: The IP configuration can be changed by dcp.set requests
+ * \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_WRONG_API_STATE
- *              - API_WRONG_ATTR_PARAMETER
+ *              - API_WRONG_AR_NUMBER
+ *              - API_BUFFER_CHANGE_TIMEOUT
  */
-USIGN32 TPS_SetIPConfig(USIGN32 dwIPAddr, USIGN32 dwSubNetMask, USIGN32 dwGateway, USIGN8 byAttr)
+USIGN32 TPS_UpdateOutputData(USIGN8 byARNumber)
 {
-    USIGN8 byAccessMode = 0;
+    USIGN32 dwRetval = TPS_ACTION_OK;
+    TPS_PROFILE_ENTER(dwProfileStart);
 
-    if (g_pzNrtConfigHeader == NULL)
-    {
-        return TPS_ERROR_WRONG_API_STATE;
-    }
-    else if ((byAttr != DCP_SET_PROTECTED) && (byAttr != DCP_SET_ALLOWED))
+    while (TPS_PollBufferChange() == BUFFER_CHANGE_PENDING)
     {
-        return API_WRONG_ATTR_PARAMETER;
+        /* wait for the previous buffer change */
     }
 
-    TPS_GetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), &byAccessMode);
-    byAccessMode = (byAccessMode & 0xFD) | (byAttr << 1);
+    dwRetval = TPS_StartUpdateOutputData(byARNumber);
+    if (dwRetval == TPS_ACTION_OK)
+    {
+        while (TPS_PollBufferChange() == BUFFER_CHANGE_PENDING)
+        {
+            /* wait for the acknowledge */
+        }
 
-    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwIPAddress), dwIPAddr);
-    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwSubnetMask), dwSubNetMask);
-    TPS_SetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwGateway), dwGateway);
+        if (g_byBufferChangeState != BUFFER_CHANGE_DONE)
+        {
+            dwRetval = API_BUFFER_CHANGE_TIMEOUT;
+        }
+    }
 
-    TPS_SetValue8((USIGN8*)&(g_pzNrtConfigHeader->byAppConfMode), byAccessMode);
+    TPS_PROFILE_LEAVE(TPS_PROFILE_UPDATE_OUTPUT, dwProfileStart, 0);
 
-    return (TPS_ACTION_OK);
+    return dwRetval;
 }
-#endif /*USE_INT_APP*/
 
 /*!
- * \brief       This function deletes all slot/subslot structures.
-                It can be used for cleaning up a previously configured API configuration.
-                Should always be called after TPS_ResetDeviceConfig()
+ * \brief       This function requests a buffer change of the cyclic output data and returns without
+                waiting for the TPS-1. Use TPS_PollBufferChange() to get the result.
  *
- * \retval      TPS_ACTION_OK
+ * \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
+ * \note        Do not change the register handling of this function!
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_WRONG_AR_NUMBER
+ *              - API_BUFFER_CHANGE_BUSY : another buffer change is still pending
  */
-USIGN32 TPS_CleanApiConf(VOID)
+USIGN32 TPS_StartUpdateOutputData(USIGN8 byARNumber)
 {
-    API_LIST* pzApi = g_zApiARContext.api_list;
-    API_LIST* pzApiNext = NULL;
-    SLOT* pzSlot = NULL;
-    SLOT* pzSlotNext = NULL;
-    SUBSLOT* pzSubslot = NULL;
-    SUBSLOT* pzSubslotNext = NULL;
-
-    while (pzApi != NULL)
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-        pzApiNext = pzApi->next;
-
-        pzSlot = pzApi->firstslot;
+        return API_WRONG_AR_NUMBER;
+    }
 
-        while (pzSlot != NULL)
-        {
-            pzSlotNext = pzSlot->pNextSlot;
+    /* Set register data for buffer change.                                 */
+    /*----------------------------------------------------------------------*/
+    return AppStartBufferChange(byARNumber, OUTPUT_USED, (1 << 6) | (1 << 5) | ((2 * byARNumber) + 2));
+}
 
-            pzSubslot = pzSlot->pSubslot;
+/*!
+ * \brief       This function reads the APDU state from the output data buffer.
+ *
+ * \param[in]   byARNumber the number of the AR
+ * \retval      possible return values:
+ *              - USIGN16 : the APDU state.
+ *                          Use the GET_APDU_STATUS macros to decode the APDU state.
+ *
+ *              - API_WRONG_AR_NUMBER if AR number is not equal AR_0 or AR_1:
+ *               \sa
+ *               - GET_APDU_STATUS_STATE
+ *               - GET_APDU_STATUS_REDUNDANCY
+ *               - GET_APDU_STATUS_DATAVALID
+ *               - GET_APDU_STATUS_PROVIDERSTATE
+ *               - GET_APDU_STATUS_PROBLEMINDICATOR
+ *               - GET_APDU_STATUS_IGNORE
+ */
+USIGN32 TPS_GetAPDUStatusOutCR(USIGN8 byARNumber, APDU_STATUS* ptApduStatus)
+{
+   USIGN16 wReturnValue = 0;
+   USIGN8* pbyIOMemory = NULL;
 
-            while (pzSubslot != NULL)
-            {
-                pzSubslotNext = pzSubslot->poNextSubslot;
+   if ((byARNumber != AR_0) && (byARNumber != AR_1))
+   {
+      return API_WRONG_AR_NUMBER;
+   }
 
-                AppFactoryResetForIM1_4();
+   pbyIOMemory = g_pbyApduAddr[byARNumber];
 
-                pzSubslot->poNextSubslot = NULL;
-                /*free(pzSubslot);*/
-                pzSubslot = pzSubslotNext;
-            }
+   if( pbyIOMemory != NULL )
+   {
+      TPS_GetValueData(pbyIOMemory, (USIGN8*)ptApduStatus, sizeof(APDU_STATUS));
+   }
 
-            pzSlot->pNextSlot = NULL;
-            pzSlot->pSubslot = NULL;
-            /*free(pzSlot);*/
-            pzSlot = pzSlotNext;
-        }
+   return wReturnValue;
+}
 
-        pzApi->firstslot = NULL;
-        pzApi->next = NULL;
-        /*free(pzApi);*/
-        pzApi = pzApiNext;
+/*!
+ * \brief       This function reads the CR dependent length of the IO data.
+ *
+ * \param[in]   byARNumber the number of the AR
+ * \param[in]   byCrType the Type of CR (input / output)
+ * \retval      possible return values:
+ *              - USIGN16 : length of data buffer
+ *               - API_WRONG_AR_NUMBER if AR number is not equal AR_0 or AR_1:
+ */
+USIGN16 TPS_GetIOBufLength(USIGN8 byARNumber, USIGN8 byCrType)
+{
+   USIGN32 dwReturnValue = 0;
+   USIGN8  byShift = (byCrType == OUTPUT_USED)?16:0;
 
-    }
+   if ((byARNumber != AR_0) && (byARNumber != AR_1))
+   {
+      return API_WRONG_AR_NUMBER;
+   }
 
-    lib_reset_malloc();
-    g_zApiARContext.api_list = NULL;
-    g_byApiState = STATE_INITIAL;
+   TPS_GetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwIOBufferLenAr[byARNumber] ), &dwReturnValue);
 
-#ifdef DIAGNOSIS_ENABLE
-    g_wNumberOfDiagEntries = 0;
-#endif
+   return (USIGN16)(dwReturnValue >> byShift);
 
-    return TPS_ACTION_OK;
 }
 
-/*!@} Configuration Interface*/
-
-/*! \addtogroup eventCom Event Communication Interface
- *@{
- */
-
 /*!
- * \brief       This function is called from an ISR routine or is used for polling the event register (events from the TPS-1
- *              to the host CPU. The function checks each possible event from the TPS Stack and calls the previously registered
-                callback functions.
- *
- * \param[in]   VOID
- * \retval      USIGN32 TPS_ACTION_OK
- */
-USIGN32 TPS_CheckEvents(VOID)
+* \brief       This function writes the input data and the IOPS in the active cyclic data frame in the IO RAM for one subslot.
+               There are three Input buffers for cyclic frames. The active buffer is changed with TPS_UpdateInputData().
+               This function as well as TPS_SetOutputIocs() must be called for each configured subslot before changing the
+               buffer with TPS_UpdateInputData() to create valid cyclic data for the application relation.
+*
+* \param[in]   pzSubslot handle to the sub slot structure
+* \param[in]   pbyData pointer to the input data buffer
+* \param[in]   wDataLength length of the input data
+* \param[in]   byState state of the input data (e.g. IOXS_GOOD)
+* \retval      returns the actual size of the input data or 0 on error
+* \note        In the error case use TPS_GetLastError() to retrieve the error code.
+*              Possible return values:\n
+*              - API_IODATA_NULL_POINTER
+*              - API_IODATA_NOT_USED_IN_CR
+*              - API_IODATA_WRONG_BUFFER_LENGTH
+*              - API_IODATA_INPUT_FRAME_BUFFER
+*/
+USIGN32 TPS_WriteInputData(SUBSLOT *pzSubslot, USIGN8 *pbyData, USIGN16 wDataLength, USIGN8 byState)
 {
-    USIGN32 dwEventRegValue = 0;
-
-    TPS_GetValue32(((USIGN8*)EVENT_REGISTER_TPS), &dwEventRegValue);
+    USIGN8*  pbyIOMemory = NULL;
+    USIGN16  wOffsetInputData = 0x0;
+    USIGN16  wOffsetInputIops = 0x0;
+    USIGN16  wSizeInputData = 0x0;
+    USIGN16  wUsedInCr = 0x0;
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+    USIGN16 wSubslotProperties = 0x0;
+#endif
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+    USIGN8*  pbyImage = NULL;
+#endif
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECTDONE_IOAR0)) != 0)
+    /* Check the pointers */ /* Allow (pbyData == NULL) if data length is zero */
+    if ((pzSubslot == NULL) ||
+        ((pbyData == NULL) && (wDataLength > 0)))
     {
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnConnectDone Event 0\r\n");
+        printf("DEBUG_API > API: TPS_WriteInputData NULL pointer\n");
 #endif
-        AppOnConnect_Done(AR_0);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECTDONE_IOAR0);
+        AppSetLastError(API_IODATA_NULL_POINTER);
+        return 0;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECTDONE_IOAR1)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnConnectDone Event 1\r\n");
+    /* check if this subslot is used in a CR */
+#ifdef USE_SUBSLOT_IO_CACHE
+    pzCache = AppGetSubslotIoCache(pzSubslot);
+    wUsedInCr = pzCache->wUsedInCr;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
 #endif
-        AppOnConnect_Done(AR_1);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECTDONE_IOAR1);
-    }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECTDONE_IOSAR)) != 0)
+    if ((wUsedInCr & INPUT_USED) == SUBSLOT_NOT_USED)
     {
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnConnectDone Event IOSAR\r\n");
+        printf("DEBUG_API > API: TPS_WriteInputData Subslot is not used in a CR\n");
 #endif
-        AppOnConnect_Done(AR_IOSR);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECTDONE_IOSAR);
+
+        AppSetLastError(API_IODATA_NOT_USED_IN_CR);
+        return 0;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_PRM_END_DONE_IOAR0)) != 0)
+    /* If the Submodule is pulled, only bad is allowed. */
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+#ifdef USE_SUBSLOT_IO_CACHE
+    wSubslotProperties = pzCache->wProperties;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubslotProperties);
+#endif
+    if ((wSubslotProperties & SUBMODULE_PROPERTIES_MASK) == SUBMODULE_PULLED)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnPRMENDDone Event 0\r\n");
+#ifdef DEBUG_API_AUTOCONF
+        printf("DEBUG_API > API: TPS_WriteInputData() > Error: Module is pulled, forcing IOPS BAD_BY_SUBSLOT.\n");
 #endif
-        AppOnPRMENDDone(AR_0);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_PRM_END_DONE_IOAR0);
+        byState = IOXS_BAD_BY_SUBSLOT;
     }
+#endif
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_PRM_END_DONE_IOAR1)) != 0)
+    if (byState == IOXS_GOOD)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnPRMENDDone Event 1\r\n");
+        /* overwrite IOPS in case of wrong submodule                  */
+#ifdef USE_SUBSLOT_IO_CACHE
+        byState = pzCache->byOperationalState;
+#else
+        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
 #endif
-        AppOnPRMENDDone(AR_1);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_PRM_END_DONE_IOAR1);
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_PRM_END_DONE_IOSAR)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: AppOnPRMENDDone Event IOSAR\r\n");
+    /* Get size of input data                                               */
+    /*----------------------------------------------------------------------*/
+#ifdef USE_SUBSLOT_IO_CACHE
+    wSizeInputData = pzCache->wSizeInputData;
+#else
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_size_input_data), &wSizeInputData);
 #endif
-        AppOnPRMENDDone(AR_IOSR);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_PRM_END_DONE_IOSAR);
-    }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONABORT_IOAR0)) != 0)
+    /* Check the data length                                                */
+    /*----------------------------------------------------------------------*/
+    if (wSizeInputData != wDataLength)
     {
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnAbort Event 0\r\n");
+        printf("DEBUG_API > API: Wrong buffer length. Given: 0x%X, Expected: 0x%X\n",
+            wDataLength, wSizeInputData);
 #endif
-        AppOnAbort(AR_0);
-        AppSetEventRegAppAckn(TPS_EVENT_ONABORT_IOAR0);
+        AppSetLastError(API_IODATA_WRONG_BUFFER_LENGTH);
+        return 0;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONABORT_IOAR1)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnAbort Event 1\r\n");
+#ifdef USE_SUBSLOT_IO_CACHE
+    pbyIOMemory = pzCache->pbyInputMemory;
+    wOffsetInputData = pzCache->wOffsetInputData;
+    wOffsetInputIops = pzCache->wOffsetInputIops;
+#else
+    /* Get the start address of the input data area.                          */
+    /*------------------------------------------------------------------------*/
+    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
+
+    /* Get the offset of the input data and iops                              */
+    /*------------------------------------------------------------------------*/
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_data), &wOffsetInputData);
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iops), &wOffsetInputIops);
 #endif
-        AppOnAbort(AR_1);
-        AppSetEventRegAppAckn(TPS_EVENT_ONABORT_IOAR1);
-    }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONABORT_IOSAR)) != 0)
+    /* Check if wDatalength equals the data length in the input frame         */
+    /*------------------------------------------------------------------------*/
+    if (wDataLength == (wOffsetInputIops - wOffsetInputData))
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnAbort Event IOSAR\r\n");
+#ifdef USE_IO_FRAME_IMAGE
+        /* Stage data and IOPS in the input frame image if available. */
+        pbyImage = AppGetIoFrameImageAddress(pzCache, pbyIOMemory, wOffsetInputData, wSizeInputData + 1);
+        if (pbyImage != NULL)
+        {
+            memcpy(pbyImage, pbyData, wSizeInputData);
+            pbyImage[wSizeInputData] = byState;
+
+            return wSizeInputData;
+        }
 #endif
-        AppOnAbort(AR_IOSR);
-        AppSetEventRegAppAckn(TPS_EVENT_ONABORT_IOSAR);
+        /* Write the data into the DPRAM. */
+        TPS_SetValueData((pbyIOMemory + wOffsetInputData), pbyData, wSizeInputData);
+        /* write iops into the input area. */
+        TPS_SetValue8((USIGN8*)(pbyIOMemory + wOffsetInputIops), byState);
     }
-
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONREADRECORD)) != 0)
+    else
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnReadRecord Event\r\n");
-#endif
-        AppSetEventRegAppAckn(TPS_EVENT_ONREADRECORD);
-        AppOnReadRecord();
+        /* Length of data in the connect request differs from the real        */
+        /* configuration. Write iops of this submodule bad and return an error*/
+        TPS_SetValue8((USIGN8*)(pbyIOMemory + wOffsetInputIops), IOXS_BAD_BY_SUBSLOT);
+        AppSetLastError(API_IODATA_INPUT_FRAME_BUFFER);
+        wSizeInputData = 0;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONWRITERECORD)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnWriteRecord Event\r\n");
-#endif
 
-        AppSetEventRegAppAckn(TPS_EVENT_ONWRITERECORD);
-        AppOnWriteRecord();
-    }
+    return wSizeInputData;
+}
+
+/*!
+* \brief       This function initiates a buffer change of the cyclic input data to send the latest input in the cyclic input data.
+               These data will be sent until the next buffer change is initiated.
+               The function returns after the buffer was successfully changed or the TPS-1 did not answer
+               within BUFFER_CHANGE_TIMEOUT_POLLS status reads. A pending buffer change is finished first.
+               There are three input buffers for each AR. Call this function only if all input data and IOCS were written into the
+               active input buffer.
+*
+* \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
+* \retval      possible return values:
+*              - TPS_ACTION_OK : success
+*              - API_WRONG_AR_NUMBER
+*              - API_BUFFER_CHANGE_TIMEOUT
+*/
+USIGN32 TPS_UpdateInputData(USIGN8 byARNumber)
+{
+    USIGN32 dwRetval = TPS_ACTION_OK;
+    TPS_PROFILE_ENTER(dwProfileStart);
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONALARM_ACK_0)) != 0)
+    while (TPS_PollBufferChange() == BUFFER_CHANGE_PENDING)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnAlarmAck_0 Event\r\n");
-#endif
-        AppOnAlarmAck();
-        AppSetEventRegAppAckn(TPS_EVENT_ONALARM_ACK_0);
+        /* wait for the previous buffer change */
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONDIAG_ACK)) != 0)
+    dwRetval = TPS_StartUpdateInputData(byARNumber);
+    if (dwRetval == TPS_ACTION_OK)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnDiagAck Event\r\n");
-#endif
-        AppOnDiagAckn();
-        AppSetEventRegAppAckn(TPS_EVENT_ONDIAG_ACK);
-    }
+        while (TPS_PollBufferChange() == BUFFER_CHANGE_PENDING)
+        {
+            /* wait for the acknowledge */
+        }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECT_REQ_REC_0)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnConnect_0 Event\r\n");
-#endif
-        AppOnConnect(AR_0);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECT_REQ_REC_0);
+        if (g_byBufferChangeState != BUFFER_CHANGE_DONE)
+        {
+            dwRetval = API_BUFFER_CHANGE_TIMEOUT;
+        }
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECT_REQ_REC_1)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnConnect_1 Event\r\n");
-#endif
-        AppOnConnect(AR_1);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECT_REQ_REC_1);
-    }
+    TPS_PROFILE_LEAVE(TPS_PROFILE_UPDATE_INPUT, dwProfileStart, 0);
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONCONNECT_REQ_REC_2)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnConnect_2 Event\r\n");
-#endif
-        AppOnConnect(AR_IOSR);
-        AppSetEventRegAppAckn(TPS_EVENT_ONCONNECT_REQ_REC_2);
-    }
+    return dwRetval;
+}
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_SET_DEVNAME_TEMP)) != 0)
+/*!
+* \brief       This function requests a buffer change of the cyclic input data and returns without
+               waiting for the TPS-1. Use TPS_PollBufferChange() to get the result. The input buffer
+               must not be written until the buffer change is done.
+*
+* \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
+* \note        Do not change the register handling of this function!
+* \retval      possible return values:
+*              - TPS_ACTION_OK : success
+*              - API_WRONG_AR_NUMBER
+*              - API_BUFFER_CHANGE_BUSY : another buffer change is still pending
+*/
+USIGN32 TPS_StartUpdateInputData(USIGN8 byARNumber)
+{
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationName Event\r\n");
-#endif
-        AppOnSetStationName(DCP_SET_TEMPORARY);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_SET_DEVNAME_TEMP);
+        return API_WRONG_AR_NUMBER;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_SET_IP_PERM)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationIpAddr permanent Event\r\n");
-#endif
-        AppOnSetStationIpAddr(DCP_SET_PERMANENT);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_SET_IP_PERM);
-    }
+    /* Set register data for buffer change.                                 */
+    /*----------------------------------------------------------------------*/
+    return AppStartBufferChange(byARNumber, INPUT_USED, (2 << 6) | (1 << 5) | (2 * byARNumber + 1));
+}
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_SET_IP_TEMP)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationIpAddr temporary Event\r\n");
-#endif
-        AppOnSetStationIpAddr(DCP_SET_TEMPORARY);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_SET_IP_TEMP);
-    }
+/*!
+* \brief       This function checks the state of the last requested buffer change. While the buffer
+               change is pending each call reads the acknowledge of the TPS-1 once. When the buffer
+               change is finished the statistics are updated and the callback registered with
+               TPS_RegisterBufferChangeCallback() is called.
+*
+* \retval      BUFFER_CHANGE_IDLE, BUFFER_CHANGE_PENDING, BUFFER_CHANGE_DONE or BUFFER_CHANGE_TIMEOUT
+*/
+USIGN8 TPS_PollBufferChange(VOID)
+{
+    USIGN32 dwReturnValue = 0;
+    T_BUFFER_CHANGE_STATISTICS* pzStatistics = NULL;
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONDCP_BLINK_START)) != 0)
+    if (g_byBufferChangeState != BUFFER_CHANGE_PENDING)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationDcpSignal start Event\r\n");
-#endif
-        AppOnSetStationDcpSignal();
-        AppSetEventRegAppAckn(TPS_EVENT_ONDCP_BLINK_START);
+        return g_byBufferChangeState;
     }
 
-    if ((dwEventRegValue & (0x1 <<TPS_EVENT_ONDCP_RESET_TO_FACTORY)) != 0)
+    TPS_GetValue32((USIGN8*)(BASE_ADDRESS_DPRAM + 4), &dwReturnValue);
+    g_dwBufferChangePolls++;
+
+    if ((dwReturnValue & g_dwBufferChangeRegValue) == (g_dwBufferChangeRegValue ^ (1 << 5)))
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStation factory settings Event\r\n");
-#endif
-        AppOnResetFactorySettings();
-#ifndef USE_TPS1_TO_SAVE_IM_DATA
-        AppSetEventRegAppAckn(TPS_EVENT_ONDCP_RESET_TO_FACTORY);
-#endif
+        g_byBufferChangeState = BUFFER_CHANGE_DONE;
     }
-
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ONALARM_ACK_1)) != 0)
+    else if (g_dwBufferChangePolls >= BUFFER_CHANGE_TIMEOUT_POLLS)
     {
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnAlarmAck_1 Event\r\n");
+        printf("DEBUG_API > API: Buffer change 0x%X timed out\n", g_dwBufferChangeRegValue);
 #endif
-        AppOnAlarmAck();
-        AppSetEventRegAppAckn(TPS_EVENT_ONALARM_ACK_1);
+        g_byBufferChangeState = BUFFER_CHANGE_TIMEOUT;
     }
-
-#ifdef USE_ETHERNET_INTERFACE
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ETH_FRAME_REC)) != 0)
+    else
     {
-#ifdef DEBUG_API_ETH_FRAME
-        printf("DEBUG_API > API: OnReceiveEthFrame Event\r\n");
-#endif
-        AppSetEventRegAppAckn(TPS_EVENT_ETH_FRAME_REC);
-        AppOnEthernetReceive();
+        return BUFFER_CHANGE_PENDING;
     }
-#endif
-
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_TPS_MESSAGE)) != 0)
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnTPSMessageReceive Event\r\n");
-#endif
-        AppSetEventRegAppAckn(TPS_EVENT_TPS_MESSAGE);
 
-        AppOnTPSMessageReceive();
-    }
+    /* Update the statistics.                                               */
+    /*----------------------------------------------------------------------*/
+    pzStatistics = &g_zBufferChangeStatistics[g_byBufferChangeAr][BUFFER_CHANGE_DIR(g_byBufferChangeCrType)];
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_RESET)) != 0)
+    if (g_byBufferChangeState == BUFFER_CHANGE_DONE)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnTPSReset Event\r\n");
-#endif
-        AppOnTPSReset();
-
-        AppSetEventRegAppAckn(TPS_EVENT_RESET);
+        pzStatistics->dwChanges++;
     }
-
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_LED_STATE_CHANGE)) != 0)
+    else
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnLedStatechange Event\r\n");
-#endif
-
-
-        AppSetEventRegAppAckn(TPS_EVENT_ON_LED_STATE_CHANGE);
-        AppOnTPSLedChanged();
+        pzStatistics->dwTimeouts++;
     }
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_SET_DEVNAME_PERM)) != 0)
+
+    pzStatistics->dwLastPolls = g_dwBufferChangePolls;
+    pzStatistics->dwTotalPolls += g_dwBufferChangePolls;
+    if (g_dwBufferChangePolls > pzStatistics->dwMaxPolls)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationName Event\r\n");
-#endif
-        AppOnSetStationName(DCP_SET_PERMANENT);
-        AppSetEventRegAppAckn(TPS_EVENT_ON_SET_DEVNAME_PERM);
+        pzStatistics->dwMaxPolls = g_dwBufferChangePolls;
     }
 
-    if ((dwEventRegValue & (0x1 << TPS_EVENT_ON_FSUDATA_CHANGE)) != 0)
+    if (g_zApiARContext.OnBufferChange_CB != NULL)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: OnSetStationName Event\r\n");
-#endif
-
-        AppOnFSUParameterChange();
-
-        AppSetEventRegAppAckn(TPS_EVENT_ON_FSUDATA_CHANGE);
+        g_zApiARContext.OnBufferChange_CB(g_byBufferChangeAr, g_byBufferChangeCrType, g_byBufferChangeState);
     }
 
-
-    return TPS_ACTION_OK;
+    return g_byBufferChangeState;
 }
 
 /*!
- * \brief       This function delivers the last error code of an API function.
+ * \brief       This function registers the callback function that is called when a buffer change
+ *              is finished (BUFFER_CHANGE_DONE or BUFFER_CHANGE_TIMEOUT). The callback is called by
+ *              TPS_PollBufferChange().
  *
- * \retval      the last error code
+ * \param[in]   pfnFunction callback with the AR number, INPUT_USED or OUTPUT_USED and the state
+ * \retval      USIGN32
+ *               - TPS_ACTION_OK : success
+ *               - REGISTER_FUNCTION_NULL
  */
-USIGN32 TPS_GetLastError(VOID)
+USIGN32 TPS_RegisterBufferChangeCallback(VOID (*pfnFunction)(USIGN8 byARNumber, USIGN8 byCrType, USIGN8 byState))
 {
-    return (g_dwLastErrorCode);
+    if (pfnFunction == NULL)
+    {
+        return REGISTER_FUNCTION_NULL;
+    }
+
+    g_zApiARContext.OnBufferChange_CB = pfnFunction;
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function checks if the TPS stack has started correctly after
- *              reset or power up.
- *              This function should be called several times until it returns
- *              TPS_ACTION_OK to wait for the TPS stack to start.
+ * \brief       This function returns the buffer change statistics of an AR.
  *
- * \param[in]   VOID
- * \retval      USIGN32
+ * \param[in]   byARNumber AR_0 or AR_1
+ * \param[in]   byCrType INPUT_USED or OUTPUT_USED
+ * \param[out]  pzStatistics the statistics are copied to this structure
+ * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - TPS_ERROR_STACK_VERSION_FAILED
+ *              - API_WRONG_AR_NUMBER
+ *              - API_IODATA_NULL_POINTER
  */
-USIGN32 TPS_CheckStackStart(VOID)
+USIGN32 TPS_GetBufferChangeStatistics(USIGN8 byARNumber, USIGN8 byCrType, T_BUFFER_CHANGE_STATISTICS* pzStatistics)
 {
-    USIGN32 dwReturn     = TPS_ACTION_OK;
-    USIGN32 dwValue      = 0;   /* Return value for TPS_GetValue32().        */
-
-    /* Set addresses for header!                                             */
-    /*-----------------------------------------------------------------------*/
-    g_pzNrtConfigHeader = (NRT_APP_CONFIG_HEAD*)BASE_ADDRESS_NRT_AREA;
-
-
-    /* Wait for the TPS-1 protocol stack.                                    */
-    /*-----------------------------------------------------------------------*/
-    dwReturn = TPS_GetValue32((USIGN8*)(g_pzNrtConfigHeader), &dwValue);
-    if (dwReturn != TPS_ACTION_OK)
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-        return (dwReturn);
+        return API_WRONG_AR_NUMBER;
     }
 
-    /* Check if the stack has started.                                       */
-    /*-----------------------------------------------------------------------*/
-    if ( (dwValue & 0xFFFF0000) == STACK_START_NUMBER)
-    {
-        /* Check for the right stack version                                 */
-        /*-------------------------------------------------------------------*/
-        if ( (dwValue & 0x0000FFFF) == STACK_VERSION_NUMBER )
-        {
-            return (TPS_ACTION_OK);
-        }
-        else
-        {
-            return (TPS_ERROR_STACK_VERSION_FAILED);
-        }
-    }
-#ifdef FW_UPDATE_OVER_HOST
-    else if((dwValue == UPDATER_LIFE_SIGN) || (dwValue == HOST_LIFE_SIGN))
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: try to reset updater\n");
-#endif
-        TPS_StartFwStack();
-        return TPS_ERROR_STACK_START_FAILED;
-    }
-#endif
-    else
+    if (pzStatistics == NULL)
     {
-        return (TPS_ERROR_STACK_START_FAILED);
+        return API_IODATA_NULL_POINTER;
     }
+
+    *pzStatistics = g_zBufferChangeStatistics[byARNumber][BUFFER_CHANGE_DIR(byCrType)];
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function registers all callback functions that process the context management and the record interface.
- *
- * \param[in]   which event type ( ONCONNECT_CB, ONCONNECTDONE_CB, ONABORT_CB,
-                ONREADRECORD_CB, ONWRITERECORD_CB, ON_PRM_END_DONE_CB,
-                ONRESET_CB)
- * \param[in]   pfnFunc pointer to the callback function that shall be linked to the event.
- * \retval      USIGN32
+ * \brief      The function writes the IOCS (consumer state) of one submodule into the input buffer.
+               Usually this is the same as the IOPS (provider state) that is set with TPS_WriteInputData() or TPS_SetInputIops().
+ * \ingroup    allfunctions
+ * \param[in]  pzSubslot handle to the sub slot structure
+ * \param[in]  byState consumer state (IOCS) of this subslot
+               IOXS_BAD_BY_SUBSLOT, IOXS_BAD_BY_SLOT, IOXS_BAD_BY_DEVICE, IOXS_BAD_BY_CONTROLLER, IOXS_GOOD
+ * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - REGISTER_FUNCTION_NULL
- *              - REGISTER_RPC_ERROR
+ *              - SET_IOCS_NULL_POINTER
+ *              - API_IODATA_NOT_USED_IN_CR
  */
-USIGN32 TPS_RegisterRpcCallback(USIGN8 which, VOID(*pfnFunc)(USIGN32))
+USIGN32 TPS_SetOutputIocs(SUBSLOT *pzSubslot, USIGN8 byState)
 {
-    if (pfnFunc == NULL)
+    USIGN8*  pbyIOMemory = NULL;
+    USIGN16  wOffsetIocs = 0x0;
+    USIGN16  wUsedInCr = 0x0;
+
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+    USIGN16 wSubSlotProperties = 0x00;
+#endif
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+    USIGN8*  pbyImage = NULL;
+#endif
+
+    if (pzSubslot == NULL)
     {
-        return REGISTER_FUNCTION_NULL;
+        return SET_IOCS_NULL_POINTER;
     }
 
-    switch (which)
-    {
-    case ONCONNECT_CB:
-        g_zApiARContext.OnConnect_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnConnect CB function\n");
+    /* check if this subslot is used in a CR */
+#ifdef USE_SUBSLOT_IO_CACHE
+    pzCache = AppGetSubslotIoCache(pzSubslot);
+    wUsedInCr = pzCache->wUsedInCr;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
 #endif
-        break;
 
-    case ONCONNECTDONE_CB:
-        g_zApiARContext.OnConnectDone_CB = pfnFunc;
+    if ((wUsedInCr & OUTPUT_USED) == SUBSLOT_NOT_USED)
+    {
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnConnectDone CB function\n");
+        printf("DEBUG_API: TPS_SetOutputIocs > Subslot is not used in a CR or has no output data\n");
 #endif
-        break;
 
-    case ONABORT_CB:
-        g_zApiARContext.OnAbort_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnAbort CB function\n");
-#endif
-        break;
+        return API_IODATA_NOT_USED_IN_CR;
+    }
 
-    case ONREADRECORD_CB:
-        g_zApiARContext.OnReadRecord_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnReadRecord CB function\n");
+    /* If the Submodule is pulled, only bad is allowed. */
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+#ifdef USE_SUBSLOT_IO_CACHE
+    wSubSlotProperties = pzCache->wProperties;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubSlotProperties);
 #endif
-        break;
-
-    case ONWRITERECORD_CB:
-        g_zApiARContext.OnWriteRecord_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnWriteRecord CB function\n");
+    if ((wSubSlotProperties & SUBMODULE_PROPERTIES_MASK) != SUBMODULE_NOT_PULLED)
+    {
+#ifdef DEBUG_API_AUTOCONF
+        printf("DEBUG_API > API: TPS_SetOutputIocs() > Module is pulled, forcing IOCS BAD_BY_SUBSLOT.\n");
 #endif
-        break;
-
-    case ON_PRM_END_DONE_CB:
-        g_zApiARContext.OnPRMEND_Done_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered On Parameter End Done CB function\n");
+        byState = IOXS_BAD_BY_SUBSLOT;
+    }
 #endif
-        break;
 
-    case ONREAD_CB:
-        g_zApiARContext.OnRead = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnRead CB function\n");
+    if (byState == IOXS_GOOD)
+    {
+        /* overwrite IOPS in case of wrong submodule                  */
+#ifdef USE_SUBSLOT_IO_CACHE
+        byState = pzCache->byOperationalState;
+#else
+        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
 #endif
-        break;
+    }
+
+#ifdef USE_SUBSLOT_IO_CACHE
+    pbyIOMemory = pzCache->pbyInputMemory;
+    wOffsetIocs = pzCache->wOffsetInputIocs;
+#else
+    /* Get the pointer to the Input buffer.*/
+    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
 
-    case ONWRITE_DONE_CB:
-        g_zApiARContext.OnWriteDone = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnWrite CB function\n");
+    /* Get the offset of the IOCS. */
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iocs), &wOffsetIocs);
 #endif
-        break;
 
-    case ONRESET_CB:
+#ifdef USE_IO_FRAME_IMAGE
+    pbyImage = AppGetIoFrameImageAddress(pzCache, pbyIOMemory, wOffsetIocs, 1);
+    if (pbyImage != NULL)
     {
-        g_zApiARContext.OnReset_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnReset CB function\n");
-#endif
-        break;
+        *pbyImage = byState;
+
+        return TPS_ACTION_OK;
     }
-    case ONFSUPARAM_CB:
-    {
-        g_zApiARContext.OnFSUParamChange_CB = pfnFunc;
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: registered OnFsuParameterChange CB function\n");
 #endif
-        break;
-    }
-    default:
-        return(REGISTER_RPC_ERROR);
-    }  /* End of switch */
 
-    return (TPS_ACTION_OK);
+    /* Set the IOCS. */
+    TPS_SetValue8(pbyIOMemory + wOffsetIocs, byState);
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function registers all callback functions that process the alarm interface (ONALARM_CB, ONDIAGN_CB).
+ * \brief       This function sets the IOPS of an input submodule.
+                Can be used to overwrite the IOPS that was already written with TPS_WriteInputData() without
+                changing the data.
  *
- * \param[in]   byWhich event type (ONALARM_CB or ONDIAG_CB)
- * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
- * \retval      USIGN32
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   byState provider state (IOPS) of the input data
+                IOXS_BAD_BY_SUBSLOT, IOXS_BAD_BY_SLOT, IOXS_BAD_BY_DEVICE, IOXS_BAD_BY_CONTROLLER, IOXS_GOOD
+ * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - REGISTER_FUNCTION_NULL
- *              - REGISTER_ALARM_ERROR
+ *              - SET_IOCS_NULL_POINTER
+ *              - API_IODATA_NOT_USED_IN_CR
  */
-USIGN32 TPS_RegisterAlarmDiagCallback(USIGN8 byWhich, VOID(*pfnFunction)(USIGN16, USIGN32))
+USIGN32 TPS_SetInputIops(SUBSLOT *pzSubslot, USIGN8 byState)
 {
-    if (pfnFunction == NULL)
+    USIGN8*  pbyIOMemory = NULL;
+    USIGN16  wOffsetIops = 0x0;
+    USIGN16  wUsedInCr = 0x0;
+
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+    USIGN16 wSubSlotProperties = 0x00;
+#endif
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+    USIGN8*  pbyImage = NULL;
+#endif
+
+    if (pzSubslot == NULL)
     {
-        return REGISTER_FUNCTION_NULL;
+        return SET_IOCS_NULL_POINTER;
     }
 
-    switch (byWhich)
-    {
-     case ONALARM_CB:
-       {
-          g_zApiARContext.OnAlarm_Ack_CB = pfnFunction;
-#ifdef DEBUG_API_TEST
-          printf("DEBUG_API > API: registered OnAlarm CB function\n");
+    /* check if this subslot is used in a CR and has an IOPS */
+#ifdef USE_SUBSLOT_IO_CACHE
+    pzCache = AppGetSubslotIoCache(pzSubslot);
+    wUsedInCr = pzCache->wUsedInCr;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
 #endif
-       }
-       break;
 
-     case ONDIAG_CB:
-       {
-       g_zApiARContext.OnDiag_Ack_CB = pfnFunction;
+    if ((wUsedInCr & INPUT_USED) == SUBSLOT_NOT_USED)
+    {
 #ifdef DEBUG_API_TEST
-       printf("DEBUG_API > API: registered OnDiag CB function\n");
+        printf("DEBUG_API > API: TPS_SetInputIops() > Subslot not used or no input\n");
 #endif
-       }
-       break;
 
-     default:
-       return REGISTER_ALARM_ERROR;
+        return API_IODATA_NOT_USED_IN_CR;
     }
 
-    return TPS_ACTION_OK;
-}
 
-/*!
-* \brief       This function registers the DCP callback functions that have one parameter (Set IP, FactoryReset).
-*
-* \param[in]   byWhich (ONDCP_SET_IP_ADDR_CB or ONDCP_FACT_RESET_CB)
-* \param[in]   pfnFunction callback function pointer
-* \retval      USIGN32
-*              - TPS_ACTION_OK : success
-*              - REGISTER_FUNCTION_NULL
-*              - REGISTER_DCP_ERROR
-*/
-USIGN32 TPS_RegisterDcpCallbackPara(USIGN8 byWhich, VOID(*pfnFunction)(USIGN32))
-{
-   if (pfnFunction == NULL)
-   {
-      return REGISTER_FUNCTION_NULL;
-   }
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+    /* If the Submodule is pulled, IOPS bad is forced. */
 
-   switch (byWhich)
-   {
-    case ONDCP_SET_IP_ADDR_CB:
-      {
-         g_zApiDeviceContext.OnSetStationIpAddr_CB = pfnFunction;
-#ifdef DEBUG_API_TEST
-         printf("DEBUG_API > API: registered OnSetStationIpAddr_CB function\n");
+#ifdef USE_SUBSLOT_IO_CACHE
+    wSubSlotProperties = pzCache->wProperties;
+#else
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubSlotProperties);
 #endif
-      }
-      break;
-    case ONDCP_SET_NAME_CB:
-      {
-         if(g_zApiDeviceContext.OnSetStationName_CB == NULL)
-         {
-            g_zApiDeviceContext.OnSetStationNameTP_CB = pfnFunction;
-         }
-         else
-         {
-#ifdef DEBUG_API_TEST
-            printf("DEBUG_API > API: ERROR by registering of OnSetStationName_CB function\n");
+    if ((wSubSlotProperties & SUBMODULE_PROPERTIES_MASK) != SUBMODULE_NOT_PULLED)
+    {
+#ifdef DEBUG_API_AUTOCONF
+        printf("DEBUG_API > TPS_SetInputIops() > Module is pulled, forcing IOPS BAD.\n");
 #endif
-            return (REGISTER_DCP_ERROR);
-         }
-#ifdef DEBUG_API_TEST
-         printf("DEBUG_API > API: registered OnSetStationName_CB function\n");
+
+        byState = IOXS_BAD_BY_SUBSLOT;
+    }
 #endif
-      }
-      break;
-    case ONDCP_FACT_RESET_CB:
-      {
-         g_zApiDeviceContext.OnResetFactorySettings_CB = pfnFunction;
-#ifdef DEBUG_API_TEST
-         printf("DEBUG_API > API: registered OnResetFactorySettings_CB function\n");
+
+    if (byState == IOXS_GOOD)
+    {
+        /* If Module Diff was created IOPS bad is forced */
+#ifdef USE_SUBSLOT_IO_CACHE
+        byState = pzCache->byOperationalState;
+#else
+        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
 #endif
-      }
-      break;
+    }
 
-    default:
-      return (REGISTER_DCP_ERROR);
-   } /* End of switch */
+#ifdef DEBUG_API_AUTOCONF
+    printf("DEBUG_API > TPS_SetInputIops() > IOPS: 0x%02X\n", byState);
+#endif
+    /** Write the IOPS into the frame buffer **/
+#ifdef USE_SUBSLOT_IO_CACHE
+    pbyIOMemory = pzCache->pbyInputMemory;
+    wOffsetIops = pzCache->wOffsetInputIops;
+#else
+    /* Get the pointer to the Input buffer.*/
+    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
 
-   return TPS_ACTION_OK;
+    /* Get the offset of the IOCS. */
+    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iops), &wOffsetIops);
+#endif
+
+#ifdef USE_IO_FRAME_IMAGE
+    pbyImage = AppGetIoFrameImageAddress(pzCache, pbyIOMemory, wOffsetIops, 1);
+    if (pbyImage != NULL)
+    {
+        *pbyImage = byState;
+
+        return TPS_ACTION_OK;
+    }
+#endif
+
+    /* Write the IOPS. */
+    TPS_SetValue8(pbyIOMemory + wOffsetIops, byState);
+
+    return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function registers all callback functions that
- *              processes the DCP interface (Set Name, Set IO, FactoryReset, Flashing).
+ * \brief       This function returns the IO configuration of a subslot.
+                The values are taken from the host side IO descriptor cache if USE_SUBSLOT_IO_CACHE
+                is active, otherwise they are read from the DPRAM.
  *
- * \param[in]   byWhich event type (ONDCP_SET_NAME_CB or ONDCP_BLINK_CB)
- * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
- * \retval      USIGN32
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[out]  pwUsedInCr content of pt_used_in_cr (INPUT_USED, OUTPUT_USED, SUBSLOT_FOR_AR)
+ * \param[out]  pwSizeInputData size of the input data of this subslot
+ * \param[out]  pwSizeOutputData size of the output data of this subslot
+ * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - REGISTER_FUNCTION_NULL
- *              - REGISTER_DCP_ERROR
+ *              - API_IODATA_NULL_POINTER
  */
-USIGN32 TPS_RegisterDcpCallback(USIGN8 byWhich, VOID(*pfnFunction)(VOID))
+USIGN32 TPS_GetSubslotIoInfo(SUBSLOT* pzSubslot, USIGN16* pwUsedInCr, USIGN16* pwSizeInputData, USIGN16* pwSizeOutputData)
 {
-   if (pfnFunction == NULL)
-   {
-      return REGISTER_FUNCTION_NULL;
-   }
-
-   switch (byWhich)
-   {
-    case ONDCP_SET_NAME_CB:
-      {
-         if(g_zApiDeviceContext.OnSetStationNameTP_CB == NULL)
-         {
-            g_zApiDeviceContext.OnSetStationName_CB = pfnFunction;
-         }
-         else
-         {
-#ifdef DEBUG_API_TEST
-            printf("DEBUG_API > API: ERROR by registering of OnSetStationName_CB function\n");
+#ifdef USE_SUBSLOT_IO_CACHE
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
 #endif
-            return (REGISTER_DCP_ERROR);
-         }
-#ifdef DEBUG_API_TEST
-         printf("DEBUG_API > API: registered OnSetStationName_CB function\n");
-#endif
-      }
-      break;
 
-    case ONDCP_BLINK_CB:
-      {
-         g_zApiDeviceContext.OnSetStationDcpSignal_CB = pfnFunction;
-#ifdef DEBUG_API_TEST
-         printf("DEBUG_API > API: registered OnSetStationDcpSignal_CB function\n");
+    if((pzSubslot == NULL) || (pwUsedInCr == NULL) ||
+       (pwSizeInputData == NULL) || (pwSizeOutputData == NULL))
+    {
+        return API_IODATA_NULL_POINTER;
+    }
+
+#ifdef USE_SUBSLOT_IO_CACHE
+    pzCache = AppGetSubslotIoCache(pzSubslot);
+
+    if(pzCache->bValid == TPS_TRUE)
+    {
+        *pwUsedInCr       = pzCache->wUsedInCr;
+        *pwSizeInputData  = pzCache->wSizeInputData;
+        *pwSizeOutputData = pzCache->wSizeOutputData;
+
+        return TPS_ACTION_OK;
+    }
 #endif
-      }
-      break;
 
-    default:
-      return (REGISTER_DCP_ERROR);
-   } /* End of switch */
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, pwUsedInCr);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_size_input_data, pwSizeInputData);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_size_output_data, pwSizeOutputData);
 
-   return TPS_ACTION_OK;
+    return TPS_ACTION_OK;
 }
 
-#ifdef USE_TPS_COMMUNICATION_CHANNEL
+#ifdef USE_IO_FRAME_IMAGE
 /*!
- * \brief       This function registers a callback function that processes the TPS_EVENT_TPS_MESSAGE event.
-                See TPS_InitTPSComChannel().
+ * \brief       This function copies the whole output frame of an AR into the output frame image
+                with one SPI transfer. Call it after TPS_UpdateOutputData(). Afterwards
+                TPS_ReadOutputData() reads the data out of the image without accessing the TPS-1.
  *
- * \note        To use this function <b>USE_TPS_COMMUNICATION_CHANNEL</b> in TPS_1_user.h must be defined.
- * \param[in]   pfnFunction
+ * \param[in]   byARNumber the AR (AR_0 or AR_1)
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - REGISTER_FUNCTION_NULL
+ *              - API_WRONG_AR_NUMBER
+ *              - API_IODATA_FRAME_IMAGE_LAYOUT
  */
-USIGN32 TPS_RegisterTPSMessageCallback(void(*pfnFunction)(T_ETHERNET_MAILBOX*))
+USIGN32 TPS_ReadOutputFrame(USIGN8 byARNumber)
 {
-    if (pfnFunction == NULL)
+    T_IO_FRAME_IMAGE* pzImage = NULL;
+    USIGN32 dwRetval = TPS_ACTION_OK;
+
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-        return REGISTER_FUNCTION_NULL;
+        return API_WRONG_AR_NUMBER;
     }
 
-    g_oApiTpsMsgContext.OnTpsMessageRX_CB = pfnFunction;
+    pzImage = &g_zIoFrameImage[byARNumber];
+
+    if (pzImage->bValid != TPS_TRUE)
+    {
+        dwRetval = AppBuildIoFrameImage(byARNumber);
+        if (dwRetval != TPS_ACTION_OK)
+        {
+            return dwRetval;
+        }
+    }
 
-#ifdef DEBUG_API_TEST
-    printf("DEBUG_API > API: registered OnTpsMessageRX_CB function\n");
-#endif
+    if (pzImage->wOutputLength > 0)
+    {
+        TPS_GetValueData(pzImage->pbyOutputMemory, pzImage->byOutput, pzImage->wOutputLength);
+    }
 
-    return (TPS_ACTION_OK);
+    return TPS_ACTION_OK;
 }
-#endif
+
 /*!
- * \brief       This function registers a callback function that
- *              processes the TPS_EVENT_ETH_FRAME_REC event.
+ * \brief       This function copies the staged input frame image (data, IOPS and IOCS) of an AR
+                into the active input buffer with one SPI transfer. Call it after all subslots were
+                written with TPS_WriteInputData() and TPS_SetOutputIocs() and before TPS_UpdateInputData().
  *
- * \note        To use this function <b>USE_ETHERNET_INTERFACE</b> in TPS_1_user.h must be defined.
- * \param[in]   pfnFunction callback function pointer
+ * \param[in]   byARNumber the AR (AR_0 or AR_1)
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - REGISTER_FUNCTION_NULL
+ *              - API_WRONG_AR_NUMBER
+ *              - API_IODATA_FRAME_IMAGE_LAYOUT
  */
-#ifdef USE_ETHERNET_INTERFACE
-USIGN32 TPS_RegisterEthernetReceiveCallback(void(*pfnFunction)(T_ETHERNET_MAILBOX*))
+USIGN32 TPS_WriteInputFrame(USIGN8 byARNumber)
 {
-    if (pfnFunction == NULL)
+    T_IO_FRAME_IMAGE* pzImage = NULL;
+    USIGN32 dwRetval = TPS_ACTION_OK;
+
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-        return REGISTER_FUNCTION_NULL;
+        return API_WRONG_AR_NUMBER;
     }
 
-    g_zApiEthernetContext.OnEthernetFrameRX_CB = pfnFunction;
+    pzImage = &g_zIoFrameImage[byARNumber];
 
-#ifdef DEBUG_API_TEST
-    printf("DEBUG_API > API: registered OnEthernetFrameRX_CB function\n");
-#endif
+    if (pzImage->bValid != TPS_TRUE)
+    {
+        /* The image is read out of the input buffer while it is build, */
+        /* data that were written directly into the DPRAM are kept.     */
+        dwRetval = AppBuildIoFrameImage(byARNumber);
+        if (dwRetval != TPS_ACTION_OK)
+        {
+            return dwRetval;
+        }
+    }
 
-    return (TPS_ACTION_OK);
+    if (pzImage->wInputLength > 0)
+    {
+        TPS_SetValueData(pzImage->pbyInputMemory, pzImage->byInput, pzImage->wInputLength);
+    }
+
+    return TPS_ACTION_OK;
 }
-#endif
+
 /*!
-* \brief        This function registers the callback function that is called when RecordInputDataObjectElement (index 0x8028)
-                RecordOutputDataObjectElement (index 0x8028) for a specific subslot is read.
-                These Record Indexes must contain the actual process data of this subslot.
+ * \brief       Returns the output frame image of an AR. Index the image with the output offsets
+                of the subslots. The content is updated by TPS_ReadOutputFrame().
  *
- * \param[in]   pfnFunction pointer to the callback function that shall be linked to the event.
- * \retval      USIGN32
- *               - TPS_ACTION_OK : success
- *               - REGISTER_FUNCTION_NULL
- * \note        These correct responses to these record request are mandatory for the PROFINET certification.
+ * \param[in]   byARNumber the AR (AR_0 or AR_1)
+ * \param[out]  pwLength used length of the image
+ * \retval      pointer to the image or NULL if no valid image exists
  */
-USIGN32 TPS_RegisterRecordDataObjectCallback(USIGN32(*pfnFunction)(T_RECORD_DATA_OBJECT_TYPE zObjectToRead,
-    SUBSLOT* pzSubslot,
-    USIGN8* pbyIocs, USIGN8* pbyIops,
-    USIGN8* pbyData, USIGN16 wDatalength,
-    USIGN16* pwSubstituteActiveFlag))
+USIGN8* TPS_GetOutputFrameImage(USIGN8 byARNumber, USIGN16* pwLength)
 {
-    if (pfnFunction == NULL)
+    if (((byARNumber != AR_0) && (byARNumber != AR_1)) ||
+        (g_zIoFrameImage[byARNumber].bValid != TPS_TRUE))
     {
-        return REGISTER_FUNCTION_NULL;
+        return NULL;
     }
 
-    g_zApiARContext.OnReadRecordDataObject_CB = pfnFunction;
+    if (pwLength != NULL)
+    {
+        *pwLength = g_zIoFrameImage[byARNumber].wOutputLength;
+    }
 
-    return TPS_ACTION_OK;
+    return g_zIoFrameImage[byARNumber].byOutput;
 }
 
 /*!
- * \brief       This function forces the TPS stack to reset (SW reset).
+ * \brief       Returns the input frame image of an AR. Index the image with the input offsets
+                of the subslots. The content is sent by TPS_WriteInputFrame().
  *
- * \retval      VOID
+ * \param[in]   byARNumber the AR (AR_0 or AR_1)
+ * \param[out]  pwLength used length of the image
+ * \retval      pointer to the image or NULL if no valid image exists
  */
-VOID TPS_SoftReset(VOID)
+USIGN8* TPS_GetInputFrameImage(USIGN8 byARNumber, USIGN16* pwLength)
 {
-    AppSetEventRegApp(APP_EVENT_RESET_PN_STACK);
-#ifdef DEBUG_API_TEST
-    printf("DEBUG_API > API: TPS Stack Reset Event was set!\n");
-#endif
+    if (((byARNumber != AR_0) && (byARNumber != AR_1)) ||
+        (g_zIoFrameImage[byARNumber].bValid != TPS_TRUE))
+    {
+        return NULL;
+    }
+
+    if (pwLength != NULL)
+    {
+        *pwLength = g_zIoFrameImage[byARNumber].wInputLength;
+    }
+
+    return g_zIoFrameImage[byARNumber].byInput;
 }
+#endif
 
-/*!@} Event Communication Interface*/
+/*!@} Cyclic Data Interface (IO data)*/
 
- /*! \addtogroup  iodata Cyclic Data Interface (IO data)
+/*! \addtogroup  recordhandling Record and Alarm Interface
  *@{
 */
 
 /*!
- * \brief       This function returns the connection state of an application relation (AR).
+ * \brief       This function copies the data of the given record mailbox into the data buffer.
+                Use this function in your OnRecordWrite callback (ONWRITERECORD_CB) function to get the
+                the data out of the record write request.
  *
- * \param[in]   dwARNumber (AR_0, AR_1, AR_IOSR - number of AR)
- * \retval      USIGN32
- *              - AR_ESTABLISHED
- *              - AR_NOT_IN_OPERATION
+ * \param[in]   byMBNumber number of the record mailbox
+ * \param[in]   pbyData pointer to the data buffer to transfer
+ * \param[in]   dwLength length of the data to send
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_READ_MB_INVALID_MAILBOX
+ *              - API_READ_MB_WRONG_FLAG
+ *              - API_READ_MB_BUFFER_TOO_SMALL
+ *              - the error of TPS_GetValueData() reading the request header
  */
-USIGN32 TPS_GetArEstablished(USIGN32 dwARNumber)
+USIGN32 TPS_ReadMailboxData(USIGN8 byMBNumber, USIGN8* pbyData, USIGN32 dwLength)
 {
-    USIGN32 dwConnectState = TPS_ACTION_OK;
+    USIGN32  dwReturnCode = TPS_ACTION_OK;
+    USIGN8   byFlags = 0;
+    USIGN32  dwRecordDataLength = 0;
 
-    switch (dwARNumber)
+    if (byMBNumber >= MAX_NUMBER_RECORDS)
     {
-    case AR_0:
-        dwConnectState = g_dwArEstablished_0;
-        break;
-    case AR_1:
-        dwConnectState = g_dwArEstablished_1;
-        break;
-    case AR_IOSR:
-        dwConnectState = g_dwArEstablished_IOSR;
-        break;
-    default:
-        dwConnectState = 0xFFFF;
-        break;
+        return API_READ_MB_INVALID_MAILBOX;
     }
 
-    return(dwConnectState);
+    /* Read Mailbox Flags.                                                   */
+    /*-----------------------------------------------------------------------*/
+    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
+
+    /* Check if flag is correct!                                             */
+    /*-----------------------------------------------------------------------*/
+    if (byFlags != RECORD_FLAG_WRITE)
+    {
+        /* Error                                                           */
+        /*-----------------------------------------------------------------*/
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Record Read Mailbox Error -> Wrong flag!\n");
+#endif
+
+        return(API_READ_MB_WRONG_FLAG);
+    }
+
+    if (g_byRecordReqFlag[byMBNumber] != byFlags)
+    {
+        dwReturnCode = AppRecordReqHeaderFetch(byMBNumber, byFlags);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
+    }
+    dwRecordDataLength = g_zRecordReqHeader[byMBNumber].dwRecordDataLen;
+
+    /* Check data length (buffer to small?)                                  */
+    /*-----------------------------------------------------------------------*/
+    if (dwLength < dwRecordDataLength)
+    {
+        /* Error                                                             */
+        /*-------------------------------------------------------------------*/
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Record Read Error -> Buffer too small!\n");
+#endif
+        return(API_READ_MB_BUFFER_TOO_SMALL);
+    }
+
+    dwReturnCode = TPS_GetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data, pbyData, dwRecordDataLength);
+
+    return (dwReturnCode);
 }
 
 
 /*!
- * \brief       This function reads the output data out of the cyclic data frame that is stored in the active Output Buffer in the IO-RAM.
-                There are three Output buffers for cyclic frames. The active buffer is changed with TPS_UpdateOutputData().
+ * \brief       This function sets the event bit "APP_EVENT_RECORD_DONE" and informs the TPS-1 that the received
+                record write request was completely handled so that the record mailbox is freed to receive a new request.
+ *              Use this function in your OnRecordWrite callback function after reading the data out of the mailbox
+                or to refuse the request with an error code.
  *
- * \param[in]   pzSubslot handle to the subslot
- * \param[in]   pbyData pointer to the data buffer where the output data shall be stored
- * \param[in]   wDataLength length of the data buffer ( pbyData )
- * \param[out]  pbyState IOPS of this submodule that is received in the cyclic data frame is written here. The data are only valid if pbyState == IOXS_GOOD.
- * \retval      USIGN32
- *              - on success the function will return the length of the data
- *              - possible errors that can be get with TPS_GetLastError():
-                  API_IODATA_NULL_POINTER, API_IODATA_MODULE_HAS_NO_OUTPUTS, API_IODATA_WRONG_BUFFER_LENGTH
+ * \param[in]   dwMailboxNumber
+ * \param[in]   wErrorCode1 record error code 1
+ * \param[in]   wErrorCode2 record error code 2
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_RECORD_READ_ERRORCODE2_INVALID
+ *              - API_READ_MB_WRONG_FLAG
  */
-USIGN32 TPS_ReadOutputData(SUBSLOT* pzSubslot, USIGN8* pbyData, USIGN16 wDataLength, USIGN8* pbyState)
+USIGN32 TPS_RecordWriteDone(USIGN32 dwMailboxNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2)
 {
-    USIGN8* pbyIOMemory = NULL;
-    USIGN16 wOffsetValueData = 0;
-    USIGN16 wSizeOutputData = 0;
+    USIGN8 byFlags = 0;
 
-    /* Check the pointer                                                    */
-    /*----------------------------------------------------------------------*/
-    if ((pzSubslot == NULL) || (pbyData == NULL))
+    if (wErrorCode2 != 0x00)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: TPS_ReadOutputData NULL pointer");
-#endif
-        AppSetLastError(API_IODATA_NULL_POINTER);
-        return 0;
+        return API_RECORD_WRITE_ERRORCODE2_INVALID;
     }
 
-    if (wDataLength == 0x00)
+    /* Read the mailbox flag!                                                 */
+    /*------------------------------------------------------------------------*/
+    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
+    if (byFlags == RECORD_FLAG_WRITE)
+    {
+        byFlags |= RECORD_FLAG_DONE;
+
+        /* Set done so that the application can not change anything          */
+        /* in the mailbox. Now the stack has the exclusive right.            */
+        /*-------------------------------------------------------------------*/
+        TPS_SetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, byFlags);
+    }
+    else
     {
+        /* Error                                                             */
+        /*-------------------------------------------------------------------*/
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: TPS_ReadOutputData no output module.");
+        printf("DEBUG_API > Record Write Done Error -> Wrong flag!\n");
 #endif
-        AppSetLastError(API_IODATA_MODULE_HAS_NO_OUTPUTS);
-        return 0;
+        return(API_RECORD_WRITE_WRONG_FLAG);
     }
 
-    /* Get size of data                                                     */
+    /* Set ErrorCode1 in mailbox                                               */
+    /*------------------------------------------------------------------------*/
+    if (wErrorCode1 != 0)
+    {
+        TPS_SetValue16(g_zApiARContext.record_mb[dwMailboxNumber].pt_errorcode1, wErrorCode1);
+    }
+
+    /* Set the record data_len to zero                                      */
     /*----------------------------------------------------------------------*/
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_size_output_data),
-        &wSizeOutputData);
+    TPS_SetValue32(g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + RECORD_REQ_BLOCK_OFFSET + RECORD_REQ_DATA_LEN,
+                   0);
+    g_byRecordReqFlag[dwMailboxNumber] = 0;
+
+    AppSetEventRegApp(APP_EVENT_RECORD_DONE);
+
+#ifdef DEBUG_API_TEST
+    /* Get the read flag                                                */
+    /*------------------------------------------------------------------*/
+    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
+    printf("DEBUG_API > Record Write Done set. 0x%x\n", byFlags);
+#endif
+
+    return (TPS_ACTION_OK);
+}
+
+
+/*!
+ * \brief       This function copies the data out of the given data buffer into the record mailbox.
+                Use this function in your OnRecordRead callback (ONREADRECORD_CB) function answer the
+                to write the requested data into the mailbox.
+ *
+ * \param[in]   byMBNumber number of record mailbox
+ * \param[in]   pbyData pointer to a data buffer
+ * \param[in]   dwLength length of the data buffer
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_WRITE_MB_INVALID_MAILBOX
+ *              - API_READ_MB_WRONG_FLAG
+ *              - API_WRITE_MB_TOO_MUCH_DATA
+ *              - the error of TPS_GetValueData() reading the request header
+ */
+USIGN32 TPS_WriteMailboxData(USIGN8 byMBNumber, USIGN8 *pbyData, USIGN32 dwLength)
+{
+    USIGN32 dwReturnCode = TPS_ACTION_OK;
+    USIGN8  byFlags = 0;
+    USIGN32 dwRecordDataLength = 0;
+
+    if (byMBNumber >= MAX_NUMBER_RECORDS)
+    {
+        return API_WRITE_MB_INVALID_MAILBOX;
+    }
 
-    /* Check the data length                                                  */
-    /*----------------------------------------------------------------------*/
-    if (wSizeOutputData != wDataLength)
+    /* Read mailbox flag.                                                    */
+    /*-----------------------------------------------------------------------*/
+    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
+
+    /* Check if RECORD_FLAG_READ is set                                      */
+    /*-----------------------------------------------------------------------*/
+    if (byFlags != RECORD_FLAG_READ)
     {
+        /* Error                                                             */
+        /*-------------------------------------------------------------------*/
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: Wrong buffer length. Given: 0x%X, Expected: 0x%X\n",
-            wDataLength, wSizeOutputData);
+        printf("DEBUG_API > Record Write Mailbox Error -> Wrong flag!\n");
 #endif
-        AppSetLastError(API_IODATA_WRONG_BUFFER_LENGTH);
-        return 0;
+        return API_WRITE_MB_WRONG_FLAG;
     }
 
-    /* Get the pointer to the output data!                                  */
-    /*----------------------------------------------------------------------*/
-    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_output_data), &pbyIOMemory);
-
-    /* Get the offset from beginning IO Area to output data!                */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_output_data), &wOffsetValueData);
-    /* Add offset to memory pointer!                                        */
-    /*----------------------------------------------------------------------*/
-    pbyIOMemory += wOffsetValueData;
+    if (g_byRecordReqFlag[byMBNumber] != byFlags)
+    {
+        dwReturnCode = AppRecordReqHeaderFetch(byMBNumber, byFlags);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
+    }
+    dwRecordDataLength = g_zRecordReqHeader[byMBNumber].dwRecordDataLen;
 
-#ifdef DEBUG_API_TEST
-    /* printf("DEBUG_API > API: Address of Output Data (IO-Area): 0x%x\n", (USIGN32)pbyIOMemory);
-    printf("Size Output Data (IO-Area): %d\n",wSizeOutputData); */
-#endif
+    /* Check if data fits into requested record data length                  */
+    /*-----------------------------------------------------------------------*/
+    if (dwLength > dwRecordDataLength)
+    {
+        return API_WRITE_MB_TOO_MUCH_DATA;
+    }
 
-    /* Get the data out of the DPRAM.                                       */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValueData(pbyIOMemory, pbyData, wSizeOutputData);
+    /* Copy data from buffer into record mailbox                             */
+    /*-----------------------------------------------------------------------*/
+    TPS_SetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data, pbyData, dwLength);
 
-    /* Get State Byte from the DPRAM                                        */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue8((USIGN8*)(pbyIOMemory + wSizeOutputData), pbyState);
+    TPS_SetValue32(g_zApiARContext.record_mb[byMBNumber].pt_req_header + RECORD_REQ_BLOCK_OFFSET + RECORD_REQ_DATA_LEN,
+                   TPS_htonl(dwLength));
+    g_zRecordReqHeader[byMBNumber].dwRecordDataLen = dwLength;
 
-    return wSizeOutputData; /* Return size of data!                         */
+    return (TPS_ACTION_OK);
 }
 
 
 /*!
- * \brief       This function initiates a buffer change of the cyclic output data to get the latest output data.
-                The function returns after the buffer was successfully changed.
-                There are three output buffers for each AR.
+ * \brief       This function passes the data of a record write request to the application in chunks.
+ *              Use it in your OnRecordWrite callback (ONWRITERECORD_CB) function instead of TPS_ReadMailboxData()
+ *              to parse a record without a buffer for the whole record. Each chunk is read with one SPI transfer
+ *              and given to pfnConsume with its offset in the record; the last chunk may be shorter.
  *
- * \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
- * \note        Do not change this function!
+ * \param[in]   byMBNumber number of record mailbox
+ * \param[in]   pbyChunk buffer for one chunk
+ * \param[in]   dwChunkSize size of pbyChunk
+ * \param[in]   pfnConsume called for every chunk, a negative return value stops the transfer
+ * \param[in]   pParam passed to pfnConsume
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - API_WRONG_AR_NUMBER
+ *              - API_READ_MB_INVALID_MAILBOX
+ *              - API_READ_MB_WRONG_FLAG
+ *              - API_READ_MB_NULL_POINTER
+ *              - API_READ_MB_STREAM_ABORTED
+ *              - API_READ_MB_RECORD_TOO_LONG : the record is longer than the data area of the mailbox
+ *              - see TPS_GetValueData()
  */
-USIGN32 TPS_UpdateOutputData(USIGN8 byARNumber)
+USIGN32 TPS_ReadMailboxDataStream(USIGN8 byMBNumber, USIGN8* pbyChunk, USIGN32 dwChunkSize,
+                                  T_RECORD_STREAM_HANDLER pfnConsume, VOID* pParam)
 {
-    USIGN32 dwRegValue = 0;
-    USIGN32 dwReturnValue = 0;
+    USIGN32 dwReturnCode = TPS_ACTION_OK;
+    USIGN8  byFlags = 0;
+    USIGN32 dwRecordDataLength = 0;
+    USIGN32 dwOffset = 0;
+    USIGN32 dwLength = 0;
 
-    if ((byARNumber != AR_0) && (byARNumber != AR_1))
+    if (byMBNumber >= MAX_NUMBER_RECORDS)
     {
-        return API_WRONG_AR_NUMBER;
+        return API_READ_MB_INVALID_MAILBOX;
     }
 
-    /* Set register data for buffer change.                                 */
-    /*----------------------------------------------------------------------*/
-    dwRegValue = (1 << 6) | (1 << 5) | ((2 * byARNumber) + 2);
+    if ((pbyChunk == NULL) || (dwChunkSize == 0) || (pfnConsume == NULL))
+    {
+        return API_READ_MB_NULL_POINTER;
+    }
 
-    /* Initate the buffer change!                                           */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)BASE_ADDRESS_DPRAM, dwRegValue);
+    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
+    if (byFlags != RECORD_FLAG_WRITE)
+    {
+        return API_READ_MB_WRONG_FLAG;
+    }
 
-    /* Wait for the acknowledge!                                            */
-    /*----------------------------------------------------------------------*/
-    do
+    if (g_byRecordReqFlag[byMBNumber] != byFlags)
     {
-        TPS_GetValue32((USIGN8*)(BASE_ADDRESS_DPRAM + 4), &dwReturnValue);
-    } while ((dwReturnValue & dwRegValue) != (dwRegValue ^ (1 << 5)));
+        dwReturnCode = AppRecordReqHeaderFetch(byMBNumber, byFlags);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
+    }
+    dwRecordDataLength = g_zRecordReqHeader[byMBNumber].dwRecordDataLen;
 
-    return TPS_ACTION_OK;
-}
+    /* Beyond the data area of the mailbox is the next mailbox.              */
+    /*-----------------------------------------------------------------------*/
+    if (dwRecordDataLength > g_zApiARContext.record_mb[byMBNumber].dwSizeRecordMailbox)
+    {
+        return API_READ_MB_RECORD_TOO_LONG;
+    }
 
-/*!
- * \brief       This function reads the APDU state from the output data buffer.
- *
- * \param[in]   byARNumber the number of the AR
- * \retval      possible return values:
- *              - USIGN16 : the APDU state.
- *                          Use the GET_APDU_STATUS macros to decode the APDU state.
- *
- *              - API_WRONG_AR_NUMBER if AR number is not equal AR_0 or AR_1:
- *               \sa
- *               - GET_APDU_STATUS_STATE
- *               - GET_APDU_STATUS_REDUNDANCY
- *               - GET_APDU_STATUS_DATAVALID
- *               - GET_APDU_STATUS_PROVIDERSTATE
- *               - GET_APDU_STATUS_PROBLEMINDICATOR
- *               - GET_APDU_STATUS_IGNORE
- */
-USIGN32 TPS_GetAPDUStatusOutCR(USIGN8 byARNumber, APDU_STATUS* ptApduStatus)
-{
-   USIGN16 wReturnValue = 0;
-   USIGN8* pbyIOMemory = NULL;
+    while (dwOffset < dwRecordDataLength)
+    {
+        dwLength = dwRecordDataLength - dwOffset;
+        if (dwLength > dwChunkSize)
+        {
+            dwLength = dwChunkSize;
+        }
 
-   if ((byARNumber != AR_0) && (byARNumber != AR_1))
-   {
-      return API_WRONG_AR_NUMBER;
-   }
+        dwReturnCode = TPS_GetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data + dwOffset, pbyChunk, dwLength);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
 
-   pbyIOMemory = g_pbyApduAddr[byARNumber];
+        if (pfnConsume(byMBNumber, dwOffset, pbyChunk, dwLength, pParam) < 0)
+        {
+            return API_READ_MB_STREAM_ABORTED;
+        }
 
-   if( pbyIOMemory != NULL )
-   {
-      TPS_GetValueData(pbyIOMemory, (USIGN8*)ptApduStatus, sizeof(APDU_STATUS));
-   }
+        dwOffset += dwLength;
+    }
 
-   return wReturnValue;
+    return TPS_ACTION_OK;
 }
 
+
 /*!
- * \brief       This function reads the CR dependent length of the IO data.
+ * \brief       This function writes the response of a record read request in chunks.
+ *              Use it in your OnReadRecord callback (ONREADRECORD_CB) function instead of TPS_WriteMailboxData()
+ *              to produce a record without a buffer for the whole record. pfnProduce fills pbyChunk with the data
+ *              at the given offset. Each chunk is written with one SPI transfer. The record ends with the first
+ *              chunk shorter than requested or when the length requested by the IO controller or the size
+ *              of the mailbox is reached. Then the response length is set like TPS_WriteMailboxData() does.
  *
- * \param[in]   byARNumber the number of the AR
- * \param[in]   byCrType the Type of CR (input / output)
+ * \param[in]   byMBNumber number of record mailbox
+ * \param[in]   pbyChunk buffer for one chunk
+ * \param[in]   dwChunkSize size of pbyChunk
+ * \param[in]   pfnProduce called for every chunk, a negative return value stops the transfer
+ * \param[in]   pParam passed to pfnProduce
  * \retval      possible return values:
- *              - USIGN16 : length of data buffer
- *               - API_WRONG_AR_NUMBER if AR number is not equal AR_0 or AR_1:
+ *              - TPS_ACTION_OK : success
+ *              - API_WRITE_MB_INVALID_MAILBOX
+ *              - API_WRITE_MB_WRONG_FLAG
+ *              - API_WRITE_MB_NULL_POINTER
+ *              - API_WRITE_MB_STREAM_ABORTED : the response length was not set
+ *              - see TPS_SetValueData()
+ *              - the error of TPS_GetValueData() reading the request header
  */
-USIGN16 TPS_GetIOBufLength(USIGN8 byARNumber, USIGN8 byCrType)
-{
-   USIGN32 dwReturnValue = 0;
-   USIGN8  byShift = (byCrType == OUTPUT_USED)?16:0;
-
-   if ((byARNumber != AR_0) && (byARNumber != AR_1))
-   {
-      return API_WRONG_AR_NUMBER;
-   }
-
-   TPS_GetValue32((USIGN8*)&(g_pzNrtConfigHeader->dwIOBufferLenAr[byARNumber] ), &dwReturnValue);
-
-   return (USIGN16)(dwReturnValue >> byShift);
-
-}
-
-/*!
-* \brief       This function writes the input data and the IOPS in the active cyclic data frame in the IO RAM for one subslot.
-               There are three Input buffers for cyclic frames. The active buffer is changed with TPS_UpdateInputData().
-               This function as well as TPS_SetOutputIocs() must be called for each configured subslot before changing the
-               buffer with TPS_UpdateInputData() to create valid cyclic data for the application relation.
-*
-* \param[in]   pzSubslot handle to the sub slot structure
-* \param[in]   pbyData pointer to the input data buffer
-* \param[in]   wDataLength length of the input data
-* \param[in]   byState state of the input data (e.g. IOXS_GOOD)
-* \retval      returns the actual size of the input data or 0 on error
-* \note        In the error case use TPS_GetLastError() to retrieve the error code.
-*              Possible return values:\n
-*              - API_IODATA_NULL_POINTER
-*              - API_IODATA_NOT_USED_IN_CR
-*              - API_IODATA_WRONG_BUFFER_LENGTH
-*              - API_IODATA_INPUT_FRAME_BUFFER
-*/
-USIGN32 TPS_WriteInputData(SUBSLOT *pzSubslot, USIGN8 *pbyData, USIGN16 wDataLength, USIGN8 byState)
+USIGN32 TPS_WriteMailboxDataStream(USIGN8 byMBNumber, USIGN8* pbyChunk, USIGN32 dwChunkSize,
+                                   T_RECORD_STREAM_HANDLER pfnProduce, VOID* pParam)
 {
-    USIGN8*  pbyIOMemory = NULL;
-    USIGN16  wOffsetInputData = 0x0;
-    USIGN16  wOffsetInputIops = 0x0;
-    USIGN16  wSizeInputData = 0x0;
-    USIGN16  wUsedInCr = 0x0;
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    USIGN16 wSubslotProperties = 0x0;
-#endif
-
-    /* Check the pointers */ /* Allow (pbyData == NULL) if data length is zero */
-    if ((pzSubslot == NULL) ||
-        ((pbyData == NULL) && (wDataLength > 0)))
-    {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: TPS_WriteInputData NULL pointer\n");
-#endif
-        AppSetLastError(API_IODATA_NULL_POINTER);
-        return 0;
-    }
-
-    /* check if this subslot is used in a CR */
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
+    USIGN32 dwReturnCode = TPS_ACTION_OK;
+    USIGN8  byFlags = 0;
+    USIGN32 dwRecordDataLength = 0;
+    USIGN32 dwOffset = 0;
+    USIGN32 dwLength = 0;
+    SIGN32  dwProduced = 0;
 
-    if ((wUsedInCr & INPUT_USED) == SUBSLOT_NOT_USED)
+    if (byMBNumber >= MAX_NUMBER_RECORDS)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: TPS_WriteInputData Subslot is not used in a CR\n");
-#endif
-
-        AppSetLastError(API_IODATA_NOT_USED_IN_CR);
-        return 0;
+        return API_WRITE_MB_INVALID_MAILBOX;
     }
 
-    /* If the Submodule is pulled, only bad is allowed. */
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubslotProperties);
-    if ((wSubslotProperties & SUBMODULE_PROPERTIES_MASK) == SUBMODULE_PULLED)
+    if ((pbyChunk == NULL) || (dwChunkSize == 0) || (pfnProduce == NULL))
     {
-#ifdef DEBUG_API_AUTOCONF
-        printf("DEBUG_API > API: TPS_WriteInputData() > Error: Module is pulled, forcing IOPS BAD_BY_SUBSLOT.\n");
-#endif
-        byState = IOXS_BAD_BY_SUBSLOT;
+        return API_WRITE_MB_NULL_POINTER;
     }
-#endif
 
-    if (byState == IOXS_GOOD)
+    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
+    if (byFlags != RECORD_FLAG_READ)
     {
-        /* overwrite IOPS in case of wrong submodule                  */
-        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
+        return API_WRITE_MB_WRONG_FLAG;
     }
 
-    /* Get size of input data                                               */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_size_input_data), &wSizeInputData);
-
-    /* Check the data length                                                */
-    /*----------------------------------------------------------------------*/
-    if (wSizeInputData != wDataLength)
+    if (g_byRecordReqFlag[byMBNumber] != byFlags)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: Wrong buffer length. Given: 0x%X, Expected: 0x%X\n",
-            wDataLength, wSizeInputData);
-#endif
-        AppSetLastError(API_IODATA_WRONG_BUFFER_LENGTH);
-        return 0;
+        dwReturnCode = AppRecordReqHeaderFetch(byMBNumber, byFlags);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
     }
+    dwRecordDataLength = g_zRecordReqHeader[byMBNumber].dwRecordDataLen;
 
-    /* Get the start address of the input data area.                          */
-    /*------------------------------------------------------------------------*/
-    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
-
-    /* Get the offset of the input data and iops                              */
-    /*------------------------------------------------------------------------*/
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_data), &wOffsetInputData);
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iops), &wOffsetInputIops);
-
-    /* Check if wDatalength equals the data length in the input frame         */
-    /*------------------------------------------------------------------------*/
-    if (wDataLength == (wOffsetInputIops - wOffsetInputData))
-    {
-        /* Write the data into the DPRAM. */
-        TPS_SetValueData((pbyIOMemory + wOffsetInputData), pbyData, wSizeInputData);
-        /* write iops into the input area. */
-        TPS_SetValue8((USIGN8*)(pbyIOMemory + wOffsetInputIops), byState);
-    }
-    else
+    /* The response must fit into the data area of the mailbox.              */
+    /*-----------------------------------------------------------------------*/
+    if (dwRecordDataLength > g_zApiARContext.record_mb[byMBNumber].dwSizeRecordMailbox)
     {
-        /* Length of data in the connect request differs from the real        */
-        /* configuration. Write iops of this submodule bad and return an error*/
-        TPS_SetValue8((USIGN8*)(pbyIOMemory + wOffsetInputIops), IOXS_BAD_BY_SUBSLOT);
-        AppSetLastError(API_IODATA_INPUT_FRAME_BUFFER);
-        wSizeInputData = 0;
+        dwRecordDataLength = g_zApiARContext.record_mb[byMBNumber].dwSizeRecordMailbox;
     }
 
+    while (dwOffset < dwRecordDataLength)
+    {
+        dwLength = dwRecordDataLength - dwOffset;
+        if (dwLength > dwChunkSize)
+        {
+            dwLength = dwChunkSize;
+        }
 
-    return wSizeInputData;
-}
+        dwProduced = pfnProduce(byMBNumber, dwOffset, pbyChunk, dwLength, pParam);
+        if (dwProduced < 0)
+        {
+            return API_WRITE_MB_STREAM_ABORTED;
+        }
 
-/*!
-* \brief       This function initiates a buffer change of the cyclic input data to send the latest input in the cyclic input data.
-               These data will be sent until the next buffer change is initiated.
-               The function returns after the buffer was successfully changed.
-               There are three input buffers for each AR. Call this function only if all input data and IOCS were written into the
-               active input buffer.
-*
-* \param[in]   byARNumber the AR which will be updated (AR_0 or AR_1)
-* \note        Do not change this function!
-* \retval      possible return values:
-*              - TPS_ACTION_OK : success
-*              - API_WRONG_AR_NUMBER
-*/
-USIGN32 TPS_UpdateInputData(USIGN8 byARNumber)
-{
-    USIGN32 dwRegValue = 0;
-    USIGN32 dwReturnValue = 0;
+        if ((USIGN32)dwProduced > dwLength)
+        {
+            dwProduced = (SIGN32)dwLength;
+        }
 
-    if ((byARNumber != AR_0) && (byARNumber != AR_1))
-    {
-        return API_WRONG_AR_NUMBER;
-    }
+        if (dwProduced > 0)
+        {
+            dwReturnCode = TPS_SetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data + dwOffset,
+                                            pbyChunk, (USIGN32)dwProduced);
+            if (dwReturnCode != TPS_ACTION_OK)
+            {
+                return dwReturnCode;
+            }
+        }
 
-    /* Set register data for buffer change.                                 */
-    /*----------------------------------------------------------------------*/
-    dwRegValue = (2 << 6) | (1 << 5) | (2 * byARNumber + 1);
+        dwOffset += (USIGN32)dwProduced;
 
-    /* Initiate the buffer change!                                           */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((USIGN8*)BASE_ADDRESS_DPRAM, dwRegValue);
+        if ((USIGN32)dwProduced < dwLength)
+        {
+            break;
+        }
+    }
 
-    /* Wait for the acknowledge!                                            */
-    /*----------------------------------------------------------------------*/
-    do
-    {
-        TPS_GetValue32((USIGN8*)(BASE_ADDRESS_DPRAM + 4), &dwReturnValue);
-    } while ((dwReturnValue & dwRegValue) != (dwRegValue ^ (1 << 5)));
+    TPS_SetValue32(g_zApiARContext.record_mb[byMBNumber].pt_req_header + RECORD_REQ_BLOCK_OFFSET + RECORD_REQ_DATA_LEN,
+                   TPS_htonl(dwOffset));
+    g_zRecordReqHeader[byMBNumber].dwRecordDataLen = dwOffset;
 
     return TPS_ACTION_OK;
 }
 
+
 /*!
- * \brief      The function writes the IOCS (consumer state) of one submodule into the input buffer.
-               Usually this is the same as the IOPS (provider state) that is set with TPS_WriteInputData() or TPS_SetInputIops().
- * \ingroup    allfunctions
- * \param[in]  pzSubslot handle to the sub slot structure
- * \param[in]  byState consumer state (IOCS) of this subslot
-               IOXS_BAD_BY_SUBSLOT, IOXS_BAD_BY_SLOT, IOXS_BAD_BY_DEVICE, IOXS_BAD_BY_CONTROLLER, IOXS_GOOD
+ * \brief       This function sets the event bit "APP_EVENT_RECORD_DONE" and informs the TPS-1 that the received
+                record read request was completely handled so that the record mailbox is freed to receive a new request.
+ *              The function also writes the error code into the mailbox.
+ *              Use this function at the end of your OnRecordRead callback function after writing the requested data into the mailbox
+                or to refuse the request with an error code.
+ *
+ * \param[in]   dwMailboxNumber number of the record mailbox
+ * \param[in]   wErrorCode1 record error code 1
+ * \param[in]   wErrorCode2 record error code 2. <b>NOT SUPPORTED</b> not supported in this version. Must be 0.
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - SET_IOCS_NULL_POINTER
- *              - API_IODATA_NOT_USED_IN_CR
+ *              - API_RECORD_READ_ERRORCODE2_INVALID
+ *              - API_READ_MB_WRONG_FLAG
  */
-USIGN32 TPS_SetOutputIocs(SUBSLOT *pzSubslot, USIGN8 byState)
+USIGN32 TPS_RecordReadDone(USIGN32 dwMailboxNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2)
 {
-    USIGN8*  pbyIOMemory = NULL;
-    USIGN16  wOffsetIocs = 0x0;
-    USIGN16  wUsedInCr = 0x0;
+    USIGN8 byFlags = 0;
 
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    USIGN16 wSubSlotProperties = 0x00;
-#endif
+    if (wErrorCode2 != 0x00)
+    {
+        return API_RECORD_READ_ERRORCODE2_INVALID;
+    }
 
-    if (pzSubslot == NULL)
+    if (dwMailboxNumber >= MAX_NUMBER_RECORDS)
     {
-        return SET_IOCS_NULL_POINTER;
+        return API_RECORD_READ_INVALID_MAILBOX;
     }
 
-    /* check if this subslot is used in a CR */
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
+    g_byRecordReqFlag[dwMailboxNumber] = 0;
 
-    if ((wUsedInCr & OUTPUT_USED) == SUBSLOT_NOT_USED)
+    /* Read the record flags!                                                */
+    /*-----------------------------------------------------------------------*/
+    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
+    if (byFlags == RECORD_FLAG_READ)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API: TPS_SetOutputIocs > Subslot is not used in a CR or has no output data\n");
-#endif
+        /* Add done flag. The stack can then work on the data                */
+        /*-------------------------------------------------------------------*/
+        byFlags |= RECORD_FLAG_DONE;
 
-        return API_IODATA_NOT_USED_IN_CR;
+        /* Write the flag into the DPRAM.                                    */
+        /*-------------------------------------------------------------------*/
+        TPS_SetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, byFlags);
     }
-
-    /* If the Submodule is pulled, only bad is allowed. */
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubSlotProperties);
-    if ((wSubSlotProperties & SUBMODULE_PROPERTIES_MASK) != SUBMODULE_NOT_PULLED)
+    else
     {
-#ifdef DEBUG_API_AUTOCONF
-        printf("DEBUG_API > API: TPS_SetOutputIocs() > Module is pulled, forcing IOCS BAD_BY_SUBSLOT.\n");
+        /* Error case                                                         */
+        /*--------------------------------------------------------------------*/
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Record Read Done Error -> Wrong flag!\n");
 #endif
-        byState = IOXS_BAD_BY_SUBSLOT;
+
+        return(API_RECORD_READ_WRONG_FLAG);
     }
-#endif
 
-    if (byState == IOXS_GOOD)
+    /* Set ErrorCode1 in mailbox.                                              */
+    /*------------------------------------------------------------------------*/
+    if (wErrorCode1 != 0)
     {
-        /* overwrite IOPS in case of wrong submodule                  */
-        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
+        TPS_SetValue16(g_zApiARContext.record_mb[dwMailboxNumber].pt_errorcode1, wErrorCode1);
     }
 
-    /* Get the pointer to the Input buffer.*/
-    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
-
-    /* Get the offset of the IOCS. */
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iocs), &wOffsetIocs);
+    AppSetEventRegApp(APP_EVENT_RECORD_DONE);
 
-    /* Set the IOCS. */
-    TPS_SetValue8(pbyIOMemory + wOffsetIocs, byState);
+#ifdef DEBUG_API_TEST
+    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
+    printf("DEBUG_API > Record Read Done set. 0x%x\n", byFlags);
+#endif
 
     return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function sets the IOPS of an input submodule.
-                Can be used to overwrite the IOPS that was already written with TPS_WriteInputData() without
-                changing the data.
+ * \brief       This function delivers the state of the mailbox. It should be called at the beginning of your record read/write callback
+                functions to get the details of the request. Inside the callbacks the header was already read by the
+                record event, so no SPI access is needed until TPS_RecordReadDone() / TPS_RecordWriteDone().
  *
- * \param[in]   pzSubslot handle to the subslot structure
- * \param[in]   byState provider state (IOPS) of the input data
-                IOXS_BAD_BY_SUBSLOT, IOXS_BAD_BY_SLOT, IOXS_BAD_BY_DEVICE, IOXS_BAD_BY_CONTROLLER, IOXS_GOOD
+ * \param[in]   dwMailboxNumber number of the record mailbox
+ * \param[out]  pzMailBoxInfo pointer to the mail box info structure
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - SET_IOCS_NULL_POINTER
- *              - API_IODATA_NOT_USED_IN_CR
+ *              - API_RECORD_MAILBOXINFO_INVALID_MAILBOX
+ *              - API_RECORD_MAILBOXINFO_WRONG_FLAG
+ *              - the error of TPS_GetValueData() reading the request header
  */
-USIGN32 TPS_SetInputIops(SUBSLOT *pzSubslot, USIGN8 byState)
+USIGN32 TPS_GetMailboxInfo(USIGN32 dwMailboxNumber, RECORD_BOX_INFO *pzMailBoxInfo)
 {
-    USIGN8*  pbyIOMemory = NULL;
-    USIGN16  wOffsetIops = 0x0;
-    USIGN16  wUsedInCr = 0x0;
-
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    USIGN16 wSubSlotProperties = 0x00;
-#endif
+    USIGN8  byFlagBuff = 0;
+    USIGN32 dwReturnCode = TPS_ACTION_OK;
 
-    if (pzSubslot == NULL)
+    if (dwMailboxNumber >= MAX_NUMBER_RECORDS)
     {
-        return SET_IOCS_NULL_POINTER;
+        return API_RECORD_MAILBOXINFO_INVALID_MAILBOX;
     }
 
-    /* check if this subslot is used in a CR and has an IOPS */
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &wUsedInCr);
-
-    if ((wUsedInCr & INPUT_USED) == SUBSLOT_NOT_USED)
+    /* The record event already read the header of the pending request.     */
+    /*----------------------------------------------------------------------*/
+    if (g_byRecordReqFlag[dwMailboxNumber] == 0)
     {
+        /* Read the pt_flags.                                               */
+        /*------------------------------------------------------------------*/
+        TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlagBuff);
+
+        if ((byFlagBuff != RECORD_FLAG_READ) && (byFlagBuff != RECORD_FLAG_WRITE))
+        {
+            /* invalid flag                                                  */
+            /*---------------------------------------------------------------*/
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > API: TPS_SetInputIops() > Subslot not used or no input\n");
+            printf("DEBUG_API > Mailbox Info Error -> Wrong flag!\n");
 #endif
+            return(API_RECORD_MAILBOXINFO_WRONG_FLAG);
+        }
 
-        return API_IODATA_NOT_USED_IN_CR;
+        dwReturnCode = AppRecordReqHeaderFetch(dwMailboxNumber, byFlagBuff);
+        if (dwReturnCode != TPS_ACTION_OK)
+        {
+            return dwReturnCode;
+        }
     }
 
+#ifdef DEBUG_API_TEST
+    if (g_byRecordReqFlag[dwMailboxNumber] == RECORD_FLAG_READ)
+    {
+        printf("DEBUG_API > Read Record Request in Mailbox\n");
+    }
+    else
+    {
+        printf("DEBUG_API > Write Record Request in Mailbox\n");
+    }
+#endif
 
-#ifdef PLUG_RETURN_SUBMODULE_ENABLE
-    /* If the Submodule is pulled, IOPS bad is forced. */
+    *pzMailBoxInfo = g_zRecordReqHeader[dwMailboxNumber];
 
-    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &wSubSlotProperties);
-    if ((wSubSlotProperties & SUBMODULE_PROPERTIES_MASK) != SUBMODULE_NOT_PULLED)
+    return (TPS_ACTION_OK);
+}
+
+/*!
+ * \brief       This function decodes the record request header (RW_RECORD_REQ_BLOCK from
+                seq_number to record_data_len, network byte order) of a record mailbox.
+ *
+ * \param[in]   pbyHeader RECORD_REQ_HEADER_LEN bytes of the header
+ * \param[out]  pzMailBoxInfo the decoded header
+ * \retval      none
+ */
+VOID TPS_RecordReqHeaderDecode(const USIGN8* pbyHeader, RECORD_BOX_INFO* pzMailBoxInfo)
+{
+    USIGN16 wValue = 0;
+    USIGN32 dwValue = 0;
+
+    memcpy(&wValue, pbyHeader + RECORD_REQ_SEQ_NUMBER, sizeof(wValue));
+    pzMailBoxInfo->wSeqNumber = TPS_htons(wValue);
+    memcpy(&dwValue, pbyHeader + RECORD_REQ_API, sizeof(dwValue));
+    pzMailBoxInfo->dwAPINumber = TPS_htonl(dwValue);
+    memcpy(&wValue, pbyHeader + RECORD_REQ_SLOT_NUMBER, sizeof(wValue));
+    pzMailBoxInfo->wSlotNumber = TPS_htons(wValue);
+    memcpy(&wValue, pbyHeader + RECORD_REQ_SUBSLOT_NUMBER, sizeof(wValue));
+    pzMailBoxInfo->wSubSlotNumber = TPS_htons(wValue);
+    memcpy(&wValue, pbyHeader + RECORD_REQ_INDEX, sizeof(wValue));
+    pzMailBoxInfo->wIndex = TPS_htons(wValue);
+    memcpy(&dwValue, pbyHeader + RECORD_REQ_DATA_LEN, sizeof(dwValue));
+    pzMailBoxInfo->dwRecordDataLen = TPS_htonl(dwValue);
+}
+
+/*!
+ * \brief       This function encodes a record request header, the counterpart of
+                TPS_RecordReqHeaderDecode(). The ar_uuid is not changed, the padding is set to 0.
+ *
+ * \param[in]   pzMailBoxInfo the header
+ * \param[out]  pbyHeader RECORD_REQ_HEADER_LEN bytes of the header
+ * \retval      none
+ */
+VOID TPS_RecordReqHeaderEncode(const RECORD_BOX_INFO* pzMailBoxInfo, USIGN8* pbyHeader)
+{
+    USIGN16 wValue = 0;
+    USIGN32 dwValue = 0;
+
+    wValue = TPS_htons(pzMailBoxInfo->wSeqNumber);
+    memcpy(pbyHeader + RECORD_REQ_SEQ_NUMBER, &wValue, sizeof(wValue));
+    dwValue = TPS_htonl(pzMailBoxInfo->dwAPINumber);
+    memcpy(pbyHeader + RECORD_REQ_API, &dwValue, sizeof(dwValue));
+    wValue = TPS_htons(pzMailBoxInfo->wSlotNumber);
+    memcpy(pbyHeader + RECORD_REQ_SLOT_NUMBER, &wValue, sizeof(wValue));
+    wValue = TPS_htons(pzMailBoxInfo->wSubSlotNumber);
+    memcpy(pbyHeader + RECORD_REQ_SUBSLOT_NUMBER, &wValue, sizeof(wValue));
+    wValue = 0;
+    memcpy(pbyHeader + RECORD_REQ_PADDING, &wValue, sizeof(wValue));
+    wValue = TPS_htons(pzMailBoxInfo->wIndex);
+    memcpy(pbyHeader + RECORD_REQ_INDEX, &wValue, sizeof(wValue));
+    dwValue = TPS_htonl(pzMailBoxInfo->dwRecordDataLen);
+    memcpy(pbyHeader + RECORD_REQ_DATA_LEN, &dwValue, sizeof(dwValue));
+}
+
+/*!
+ * \brief       This function initiates an alarm notification to a PLC
+ *
+ * \param[in]   dwARNumber the AR number
+ * \param[in]   dwAPINumber the API number
+ * \param[in]   wSlotNumber the slot number
+ * \param[in]   wSubslotNumber the subslot number
+ * \param[in]   byAlarmPrio the alarm priority (ALARM_HIGH or ALARM_LOW)
+ * \param[in]   byAlarmType the alarm type
+ *              (PULL_ALARM, PLUG_ALARM, UPDATE_ALARM, PROCESS_ALARM, DIAGNOSIS_DISAPPEARS_ALARM, DIAGNOSIS_ALARM)
+ * \param[in]   dwDataLength length of the alarm data
+ * \param[in]   pbyAlarmData pointer to the buffer containing the alarm data
+ * \param[in]   wUsi the user structure identifier that describes the structure of the alarm data
+                (User defined between 0x0000 and 0x7FFF)
+ * \param[in]   specific handle to identify the corresponding alarm acknowledge. Should be unique for each sent alarm.
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_ALARM_WRONG_AR_NUMBER
+ *              - API_ALARM_PRIO_UNKNOWN
+ *              - API_ALARM_DATA_TOO_LONG
+ *              - API_ALARM_SUBSLOT_NOT_FOUND
+ *              - API_ALARM_SUBSLOT_NOT_USED_BY_AR
+ */
+USIGN32 TPS_SendAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
+    USIGN16 wSubslotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
+    USIGN32 dwDataLength, USIGN8* pbyAlarmData, USIGN16 wUsi, USIGN16 wUserHandle)
+{
+    USIGN8   byMailboxNr = 0;
+    SUBSLOT* pzSubslot = NULL;
+    SLOT*    pzSlot = NULL;
+    USIGN8   byFlagBuff = 0;
+    USIGN16  wOwnedByAr = 0;
+    BOOL     bSubslotUsedInAr = TPS_FALSE;
+    USIGN32  dwReturnValue = TPS_ACTION_OK;
+
+#ifdef DEBUG_API_TEST
+    /* Variables for the debug output!                                    */
+    /*--------------------------------------------------------------------*/
+    USIGN32 dwSizeAlarmMB = 0;
+    USIGN32 dwAPINr = 0;
+    USIGN16 wAlarmDataLen = 0;
+    USIGN8  byAlTyp = 0;
+#endif
+
+    if ((dwARNumber != AR_0) && (dwARNumber != AR_1))
     {
-#ifdef DEBUG_API_AUTOCONF
-        printf("DEBUG_API > TPS_SetInputIops() > Module is pulled, forcing IOPS BAD.\n");
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Invalid AR number\n");
 #endif
 
-        byState = IOXS_BAD_BY_SUBSLOT;
+        return API_ALARM_WRONG_AR_NUMBER;
     }
-#endif
 
-    if (byState == IOXS_GOOD)
+    if ((byAlarmPrio != ALARM_HIGH) && (byAlarmPrio != ALARM_LOW))
     {
-        /* If Module Diff was created IOPS bad is forced */
-        TPS_GetValue8((USIGN8*)(pzSubslot->pt_operational_state), &byState);
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Invalid alarm prio\n");
+#endif
+
+        return API_ALARM_PRIO_UNKNOWN;
     }
 
-#ifdef DEBUG_API_AUTOCONF
-    printf("DEBUG_API > TPS_SetInputIops() > IOPS: 0x%02X\n", byState);
+    if (dwDataLength > (SIZE_ALARM_MB - 32))
+    {
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Alarm data too long(%d bytes). Longer than %d bytes\n", dwDataLength, (SIZE_ALARM_MB - 32));
 #endif
-    /** Write the IOPS into the frame buffer **/
-    /* Get the pointer to the Input buffer.*/
-    TPS_GetIOAddress((USIGN8*)(pzSubslot->pt_input_data), &pbyIOMemory);
-
-    /* Get the offset of the IOCS. */
-    TPS_GetValue16((USIGN8*)(pzSubslot->pt_offset_input_iops), &wOffsetIops);
 
-    /* Write the IOPS. */
-    TPS_SetValue8(pbyIOMemory + wOffsetIops, byState);
+        return API_ALARM_DATA_TOO_LONG;
+    }
 
-    return TPS_ACTION_OK;
-}
+    if (wSubslotNumber != 0)
+    {
+        /* Check if the submodule is used in the given AR.                    */
+        pzSubslot = AppGetSubslotHandle(dwAPINumber, wSlotNumber, wSubslotNumber);
 
-/*!@} Cyclic Data Interface (IO data)*/
+        if (pzSubslot == NULL)
+        {
+            dwReturnValue = API_ALARM_SUBSLOT_NOT_FOUND;
+        }
+        else
+        {
+            TPS_GetValue16((USIGN8*)(pzSubslot->pt_wSubslotOwnedByAr), &wOwnedByAr);
+            if ((wOwnedByAr & OWNED_BY_AR(dwARNumber)) != SUBSLOT_NOT_USED)
+            {
+                bSubslotUsedInAr = TPS_TRUE;
+            }
+        }
+    }
+    else
+    {
+        /* SubslotNumber = 0 -> module representative                         */
+        /* Check if a submodule of this module is used in the given AR.       */
+        pzSlot = AppGetSlotHandle(dwAPINumber, wSlotNumber);
 
-/*! \addtogroup  recordhandling Record and Alarm Interface
- *@{
-*/
+        if (pzSlot == NULL)
+        {
+            dwReturnValue = API_ALARM_SLOT_NOT_FOUND;
+        }
+        else
+        {
+            for (pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                TPS_GetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, &wOwnedByAr);
 
-/*!
- * \brief       This function copies the data of the given record mailbox into the data buffer.
-                Use this function in your OnRecordWrite callback (ONWRITERECORD_CB) function to get the
-                the data out of the record write request.
- *
- * \param[in]   byMBNumber number of the record mailbox
- * \param[in]   pbyData pointer to the data buffer to transfer
- * \param[in]   dwLength length of the data to send
- * \retval      possible return values:
- *              - TPS_ACTION_OK : success
- *              - API_READ_MB_INVALID_MAILBOX
- *              - API_READ_MB_WRONG_FLAG
- *              - API_READ_MB_BUFFER_TOO_SMALL
- */
-USIGN32 TPS_ReadMailboxData(USIGN8 byMBNumber, USIGN8* pbyData, USIGN32 dwLength)
-{
-    USIGN32  dwReturnCode = TPS_ACTION_OK;
-    USIGN8   byFlags = 0;
-    USIGN32  dwRecordDataLength = 0;
+                if ((wOwnedByAr & OWNED_BY_AR(dwARNumber)) != SUBSLOT_NOT_USED)
+                {
+                    bSubslotUsedInAr = TPS_TRUE;
+                    break;
+                }
+            }
+        }
+    }
 
-    if (byMBNumber >= MAX_NUMBER_RECORDS)
+    /* If the subslot is used, select the correct mailbox and send the alarm. */
+    if ((dwReturnValue == TPS_ACTION_OK) && (bSubslotUsedInAr == TPS_TRUE))
     {
-        return API_READ_MB_INVALID_MAILBOX;
+        if ((byAlarmPrio == ALARM_HIGH) && (dwARNumber == AR_0))
+        {
+            byMailboxNr = 1;
+        }
+        else if ((byAlarmPrio == ALARM_LOW) && (dwARNumber == AR_0))
+        {
+            byMailboxNr = 0;
+        }
+        else if ((byAlarmPrio == ALARM_HIGH) && (dwARNumber == AR_1))
+        {
+            byMailboxNr = 3;
+        }
+        else if ((byAlarmPrio == ALARM_LOW) && (dwARNumber == AR_1))
+        {
+            byMailboxNr = 2;
+        }
+    }
+    else if (dwReturnValue == TPS_ACTION_OK)
+    {
+        /* slot was found but not owned by this AR */
+        dwReturnValue = API_ALARM_SUBSLOT_NOT_USED_BY_AR;
     }
 
-    TPS_GetValue32((g_zApiARContext.record_mb[byMBNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4 + 2 + 2 + 2 + 2), &dwRecordDataLength);
 
-    /* Read Mailbox Flags.                                                   */
-    /*-----------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
+    if (dwReturnValue == TPS_ACTION_OK)
+    {
+        /* Get the Mailbox Flag.                                              */
+        /*--------------------------------------------------------------------*/
+        TPS_GetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, &byFlagBuff);
+        if (byFlagBuff != UNUSED_FLAG) /* Check if unused! */
+        {
+            /* Return error code                                              */
+            /*----------------------------------------------------------------*/
+            dwReturnValue = API_ALARM_MAILBOX_IN_USE;
+        }
+    }
 
-    /* Check if flag is correct!                                             */
-    /*-----------------------------------------------------------------------*/
-    if (byFlags != RECORD_FLAG_WRITE)
+    if (dwReturnValue == TPS_ACTION_OK)
     {
-        /* Error                                                           */
-        /*-----------------------------------------------------------------*/
+        TPS_SetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, ACTIVE_FLAG);
+        TPS_SetValue32(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_api)), dwAPINumber);
+        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_slot_nr)), wSlotNumber);
+        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_subslot_nr)), wSubslotNumber);
+        TPS_SetValue8(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_alarm_typ)), byAlarmType);
+        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_usi)), TPS_htons(wUsi));
+        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_usr_hdl)), wUserHandle);
+        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_data_length)), (USIGN16)dwDataLength);
+        TPS_SetValueData(g_zAlarmMailbox[byMailboxNr].pt_data, pbyAlarmData, dwDataLength);
+
 #ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Record Read Mailbox Error -> Wrong flag!\n");
+        /* Debug Info for the processed alarm mailbox.                    */
+        /*----------------------------------------------------------------*/
+        dwSizeAlarmMB = g_zAlarmMailbox[byMailboxNr].size_alarm_mailbox;
+        TPS_GetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, &byFlagBuff);
+        TPS_GetValue32(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_api)), &dwAPINumber);
+        TPS_GetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_data_length)), &wAlarmDataLen);
+        TPS_GetValue8(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_alarm_typ)), &byAlTyp);
+        printf("*g_zAlarmMailbox[byMailbox_nr].size_alarm_mailbox=%d\n", dwSizeAlarmMB);
+        printf("*g_zAlarmMailbox[byMailbox_nr].pt_flags=0x%x\n", byFlagBuff);
+        printf("*g_zAlarmMailbox[byMailbox_nr].pt_api=0x%x\n", dwAPINr);
+        printf("*g_zAlarmMailbox[byMailbox_nr].pt_data_length=0x%x\n", wAlarmDataLen);
+        printf("*g_zAlarmMailbox[byMailbox_nr].pt_alarm_typ=0x%x\n", byAlTyp);
 #endif
 
-        return(API_READ_MB_WRONG_FLAG);
-    }
-
+        /* Set the alarm request bit for the processed AR                     */
+        /*--------------------------------------------------------------------*/
+        AppSetEventAlarmReq(dwARNumber);
 
-    /* Check data length (buffer to small?)                                  */
-    /*-----------------------------------------------------------------------*/
-    if (dwLength < TPS_htonl(dwRecordDataLength))
-    {
-        /* Error                                                             */
-        /*-------------------------------------------------------------------*/
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Record Read Error -> Buffer too small!\n");
+#ifdef USE_ALARM_QUEUE
+        AppAlarmQueueOnSent(byMailboxNr);
 #endif
-        return(API_READ_MB_BUFFER_TOO_SMALL);
     }
 
-    dwReturnCode = TPS_GetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data, pbyData, TPS_htonl(dwRecordDataLength));
-
-    return (dwReturnCode);
+    return dwReturnValue;
 }
 
-
+#ifdef USE_ALARM_QUEUE
 /*!
- * \brief       This function sets the event bit "APP_EVENT_RECORD_DONE" and informs the TPS-1 that the received
-                record write request was completely handled so that the record mailbox is freed to receive a new request.
- *              Use this function in your OnRecordWrite callback function after reading the data out of the mailbox
-                or to refuse the request with an error code.
+ * \brief       This function sends an alarm notification like TPS_SendAlarm(). If the
+ *              alarm mailbox of the AR and priority is busy, the alarm is queued and
+ *              sent after the acknowledge of the pending alarms. The acknowledge is
+ *              reported by the OnAlarm_Ack_CB callback as for TPS_SendAlarm(). A queued
+ *              alarm that cannot be sent is reported with the response ALARM_QUEUE_DROPPED.
  *
- * \param[in]   dwMailboxNumber
- * \param[in]   wErrorCode1 record error code 1
- * \param[in]   wErrorCode2 record error code 2
+ * \param[in]   dwARNumber the AR number
+ * \param[in]   dwAPINumber the API number
+ * \param[in]   wSlotNumber the slot number
+ * \param[in]   wSubslotNumber the subslot number
+ * \param[in]   byAlarmPrio the alarm priority (ALARM_HIGH or ALARM_LOW)
+ * \param[in]   byAlarmType the alarm type, see TPS_SendAlarm()
+ * \param[in]   dwDataLength length of the alarm data (up to ALARM_QUEUE_DATA_SIZE)
+ * \param[in]   pbyAlarmData pointer to the buffer containing the alarm data, copied by the queue
+ * \param[in]   wUsi the user structure identifier of the alarm data
+ * \param[in]   wUserHandle handle to identify the corresponding alarm acknowledge
  * \retval      possible return values:
- *              - TPS_ACTION_OK : success
- *              - API_RECORD_READ_ERRORCODE2_INVALID
- *              - API_READ_MB_WRONG_FLAG
+ *              - TPS_ACTION_OK : the alarm was sent or queued
+ *              - API_ALARM_QUEUE_COALESCED : the queue is full and an identical alarm is queued.
+ *                No acknowledge is reported for wUserHandle.
+ *              - API_ALARM_QUEUE_FULL
+ *              - API_ALARM_QUEUE_DATA_TOO_LONG
+ *              - API_ALARM_WRONG_AR_NUMBER
+ *              - API_ALARM_PRIO_UNKNOWN
+ *              or any Error from TPS_SendAlarm()
  */
-USIGN32 TPS_RecordWriteDone(USIGN32 dwMailboxNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2)
+USIGN32 TPS_QueueAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
+    USIGN16 wSubslotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
+    USIGN32 dwDataLength, USIGN8* pbyAlarmData, USIGN16 wUsi, USIGN16 wUserHandle)
 {
-    USIGN8 byFlags = 0;
+    T_ALARM_QUEUE_ENTRY       zEntry;
+    T_ALARM_QUEUE_ENTRY*      pzQueued = NULL;
+    T_ALARM_QUEUE_STATISTICS* pzStatistics = NULL;
+    USIGN8   byMailboxNr = 0;
+    USIGN16  wIndex = 0;
+    USIGN32  dwReturnValue = TPS_ACTION_OK;
 
-    if (wErrorCode2 != 0x00)
+    if ((dwARNumber != AR_0) && (dwARNumber != AR_1))
     {
-        return API_RECORD_WRITE_ERRORCODE2_INVALID;
+        return API_ALARM_WRONG_AR_NUMBER;
     }
 
-    /* Read the mailbox flag!                                                 */
-    /*------------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
-    if (byFlags == RECORD_FLAG_WRITE)
+    if ((byAlarmPrio != ALARM_HIGH) && (byAlarmPrio != ALARM_LOW))
     {
-        byFlags |= RECORD_FLAG_DONE;
+        return API_ALARM_PRIO_UNKNOWN;
+    }
 
-        /* Set done so that the application can not change anything          */
-        /* in the mailbox. Now the stack has the exclusive right.            */
-        /*-------------------------------------------------------------------*/
-        TPS_SetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, byFlags);
+    if (dwDataLength > ALARM_QUEUE_DATA_SIZE)
+    {
+        return API_ALARM_QUEUE_DATA_TOO_LONG;
     }
-    else
+
+    byMailboxNr = ALARM_MAILBOX_NUMBER(dwARNumber, byAlarmPrio);
+    pzStatistics = &g_zAlarmQueueStatistics[byMailboxNr];
+
+    memset(&zEntry, 0, sizeof(zEntry));
+    zEntry.dwAPINumber    = dwAPINumber;
+    zEntry.wSlotNumber    = wSlotNumber;
+    zEntry.wSubslotNumber = wSubslotNumber;
+    zEntry.wUsi           = wUsi;
+    zEntry.wUserHandle    = wUserHandle;
+    zEntry.wDataLength    = (USIGN16)dwDataLength;
+    zEntry.byAlarmType    = byAlarmType;
+    if (dwDataLength > 0)
     {
-        /* Error                                                             */
-        /*-------------------------------------------------------------------*/
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Record Write Done Error -> Wrong flag!\n");
-#endif
-        return(API_RECORD_WRITE_WRONG_FLAG);
+        memcpy(zEntry.byData, pbyAlarmData, dwDataLength);
     }
 
-    /* Set ErrorCode1 in mailbox                                               */
+    /* Nothing queued: try the mailbox first, queue only if it is busy.       */
     /*------------------------------------------------------------------------*/
-    if (wErrorCode1 != 0)
+    if (pzStatistics->wDepth == 0)
     {
-        TPS_SetValue16(g_zApiARContext.record_mb[dwMailboxNumber].pt_errorcode1, wErrorCode1);
+        dwReturnValue = AppAlarmQueueSend(byMailboxNr, &zEntry);
+        if (dwReturnValue != API_ALARM_MAILBOX_IN_USE)
+        {
+            return dwReturnValue;
+        }
     }
 
-    /* Set the record data_len to zero                                      */
-    /*----------------------------------------------------------------------*/
-    TPS_SetValue32((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header+sizeof(ETH_HEADER)+
-                       sizeof(UDP_IP_HEADER)+
-                       sizeof(RPC_HEADER)+sizeof(ARGS_REQ)+sizeof(BLOCK_HEADER)+2+sizeof(UUID_TAG)+4+2+2+2+2),
-                       0);
+    if (pzStatistics->wDepth >= ALARM_QUEUE_DEPTH)
+    {
+        /* Merge the alarm into an identical queued one (except the handle). */
+        for (wIndex = 0; wIndex < pzStatistics->wDepth; wIndex++)
+        {
+            pzQueued = &g_zAlarmQueue[byMailboxNr][(g_byAlarmQueueHead[byMailboxNr] + wIndex) % ALARM_QUEUE_DEPTH];
+            zEntry.wUserHandle = pzQueued->wUserHandle;
 
-    AppSetEventRegApp(APP_EVENT_RECORD_DONE);
+            if (memcmp(pzQueued, &zEntry, sizeof(zEntry)) == 0)
+            {
+                pzStatistics->dwCoalesced++;
+                return API_ALARM_QUEUE_COALESCED;
+            }
+        }
 
-#ifdef DEBUG_API_TEST
-    /* Get the read flag                                                */
-    /*------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
-    printf("DEBUG_API > Record Write Done set. 0x%x\n", byFlags);
-#endif
+        pzStatistics->dwOverflows++;
+        return API_ALARM_QUEUE_FULL;
+    }
+
+    memcpy(&g_zAlarmQueue[byMailboxNr][(g_byAlarmQueueHead[byMailboxNr] + pzStatistics->wDepth) % ALARM_QUEUE_DEPTH],
+           &zEntry, sizeof(zEntry));
+    pzStatistics->wDepth++;
+    pzStatistics->dwQueued++;
+    if (pzStatistics->wDepth > pzStatistics->wMaxDepth)
+    {
+        pzStatistics->wMaxDepth = pzStatistics->wDepth;
+    }
 
-    return (TPS_ACTION_OK);
+    return TPS_ACTION_OK;
 }
 
-
 /*!
- * \brief       This function copies the data out of the given data buffer into the record mailbox.
-                Use this function in your OnRecordRead callback (ONREADRECORD_CB) function answer the
-                to write the requested data into the mailbox.
+ * \brief       This function returns the statistics of the alarm queue of an AR and priority.
  *
- * \param[in]   byMBNumber number of record mailbox
- * \param[in]   pbyData pointer to a data buffer
- * \param[in]   dwLength length of the data buffer
+ * \param[in]   byARNumber AR_0 or AR_1
+ * \param[in]   byAlarmPrio ALARM_HIGH or ALARM_LOW
+ * \param[out]  pzStatistics the statistics are copied to this structure
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - API_WRITE_MB_INVALID_MAILBOX
- *              - API_READ_MB_WRONG_FLAG
- *              - API_WRITE_MB_TOO_MUCH_DATA
+ *              - API_ALARM_WRONG_AR_NUMBER
+ *              - API_ALARM_PRIO_UNKNOWN
+ *              - API_ALARM_QUEUE_NULL_POINTER
  */
-USIGN32 TPS_WriteMailboxData(USIGN8 byMBNumber, USIGN8 *pbyData, USIGN32 dwLength)
+USIGN32 TPS_GetAlarmQueueStatistics(USIGN8 byARNumber, USIGN8 byAlarmPrio, T_ALARM_QUEUE_STATISTICS* pzStatistics)
 {
-    USIGN8  byFlags = 0;
-    USIGN32 dwRecordDataLength = 0;
-
-    if (byMBNumber >= MAX_NUMBER_RECORDS)
+    if ((byARNumber != AR_0) && (byARNumber != AR_1))
     {
-        return API_WRITE_MB_INVALID_MAILBOX;
+        return API_ALARM_WRONG_AR_NUMBER;
     }
 
-    TPS_GetValue32((g_zApiARContext.record_mb[byMBNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) +
-        sizeof(BLOCK_HEADER) + 2 +
-        sizeof(UUID_TAG) + 4 + 2 + 2 + 2 + 2), &dwRecordDataLength);
-
-    /* Read mailbox flag.                                                    */
-    /*-----------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[byMBNumber].pt_flags, &byFlags);
-
-    /* Check if RECORD_FLAG_READ is set                                      */
-    /*-----------------------------------------------------------------------*/
-    if (byFlags != RECORD_FLAG_READ)
+    if ((byAlarmPrio != ALARM_HIGH) && (byAlarmPrio != ALARM_LOW))
     {
-        /* Error                                                             */
-        /*-------------------------------------------------------------------*/
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Record Write Mailbox Error -> Wrong flag!\n");
-#endif
-        return API_WRITE_MB_WRONG_FLAG;
+        return API_ALARM_PRIO_UNKNOWN;
     }
 
-    /* Check if data fits into requested record data length                  */
-    /*-----------------------------------------------------------------------*/
-    if (dwLength > TPS_htonl(dwRecordDataLength))
+    if (pzStatistics == NULL)
     {
-        return API_WRITE_MB_TOO_MUCH_DATA;
+        return API_ALARM_QUEUE_NULL_POINTER;
     }
 
-    /* Copy data from buffer into record mailbox                             */
-    /*-----------------------------------------------------------------------*/
-    TPS_SetValueData(g_zApiARContext.record_mb[byMBNumber].pt_data, pbyData, dwLength);
-
-    TPS_SetValue32((g_zApiARContext.record_mb[byMBNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) +
-        sizeof(BLOCK_HEADER) + 2 +
-        sizeof(UUID_TAG) + 4 + 2 + 2 + 2 + 2), TPS_htonl(dwLength));
+    *pzStatistics = g_zAlarmQueueStatistics[ALARM_MAILBOX_NUMBER(byARNumber, byAlarmPrio)];
 
-    return (TPS_ACTION_OK);
+    return TPS_ACTION_OK;
 }
+#endif
 
-
+#ifdef USE_RECORD_REGISTRY
 /*!
- * \brief       This function sets the event bit "APP_EVENT_RECORD_DONE" and informs the TPS-1 that the received
-                record read request was completely handled so that the record mailbox is freed to receive a new request.
- *              The function also writes the error code into the mailbox.
- *              Use this function at the end of your OnRecordRead callback function after writing the requested data into the mailbox
-                or to refuse the request with an error code.
+ * \brief       This function registers the handlers of a record. Read and write requests for the record
+ *              are answered by the driver with these handlers, the OnReadRecord / OnWriteRecord callbacks
+ *              are not called for it. RECORD_REGISTRY_ANY as slot or subslot number registers the handlers
+ *              for all slots or subslots without an own registration.
+ *              If wCacheSize is not 0, the response of the read handler is kept in host RAM and the
+ *              following read requests are answered from this copy. The copy is discarded when the record
+ *              is written or by TPS_InvalidateRecordCache(). Only records with a fixed slot and subslot
+ *              number can be cached.
  *
- * \param[in]   dwMailboxNumber number of the record mailbox
- * \param[in]   wErrorCode1 record error code 1
- * \param[in]   wErrorCode2 record error code 2. <b>NOT SUPPORTED</b> not supported in this version. Must be 0.
+ * \param[in]   dwAPINumber API of the record
+ * \param[in]   wSlotNumber slot of the record or RECORD_REGISTRY_ANY
+ * \param[in]   wSubslotNumber subslot of the record or RECORD_REGISTRY_ANY
+ * \param[in]   wIndex record index
+ * \param[in]   pfnRead read handler or NULL
+ * \param[in]   pfnWrite write handler or NULL
+ * \param[in]   wCacheSize maximum length of the cached read response, 0: not cached
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - API_RECORD_READ_ERRORCODE2_INVALID
- *              - API_READ_MB_WRONG_FLAG
+ *              - API_RECORD_REGISTRY_NULL_POINTER
+ *              - API_RECORD_REGISTRY_INVALID_PARAM
+ *              - API_RECORD_REGISTRY_EXISTS
+ *              - API_RECORD_REGISTRY_FULL
+ *              - API_RECORD_REGISTRY_CACHE_FULL
  */
-USIGN32 TPS_RecordReadDone(USIGN32 dwMailboxNumber, USIGN16 wErrorCode1, USIGN16 wErrorCode2)
+USIGN32 TPS_RegisterRecordHandler(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, USIGN16 wIndex,
+                                  T_RECORD_HANDLER pfnRead, T_RECORD_HANDLER pfnWrite, USIGN16 wCacheSize)
 {
-    USIGN8 byFlags = 0;
+    T_RECORD_HANDLER_ENTRY* pzEntry = NULL;
+    USIGN16 wPosition = 0;
 
-    if (wErrorCode2 != 0x00)
+    if ((pfnRead == NULL) && (pfnWrite == NULL))
     {
-        return API_RECORD_READ_ERRORCODE2_INVALID;
+        return API_RECORD_REGISTRY_NULL_POINTER;
     }
 
-    if (dwMailboxNumber >= MAX_NUMBER_RECORDS)
+    if ((wCacheSize != 0) &&
+        ((pfnRead == NULL) || (wSlotNumber == RECORD_REGISTRY_ANY) || (wSubslotNumber == RECORD_REGISTRY_ANY)))
     {
-        return API_RECORD_READ_INVALID_MAILBOX;
+        return API_RECORD_REGISTRY_INVALID_PARAM;
     }
 
-    /* Read the record flags!                                                */
-    /*-----------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
-    if (byFlags == RECORD_FLAG_READ)
+    if (AppRecordRegistrySearch(dwAPINumber, wSlotNumber, wSubslotNumber, wIndex, &wPosition) == TPS_TRUE)
     {
-        /* Add done flag. The stack can then work on the data                */
-        /*-------------------------------------------------------------------*/
-        byFlags |= RECORD_FLAG_DONE;
-
-        /* Write the flag into the DPRAM.                                    */
-        /*-------------------------------------------------------------------*/
-        TPS_SetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, byFlags);
+        return API_RECORD_REGISTRY_EXISTS;
     }
-    else
-    {
-        /* Error case                                                         */
-        /*--------------------------------------------------------------------*/
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Record Read Done Error -> Wrong flag!\n");
-#endif
 
-        return(API_RECORD_READ_WRONG_FLAG);
+    if (g_wRecordRegistryUsed >= RECORD_REGISTRY_SIZE)
+    {
+        return API_RECORD_REGISTRY_FULL;
     }
 
-    /* Set ErrorCode1 in mailbox.                                              */
-    /*------------------------------------------------------------------------*/
-    if (wErrorCode1 != 0)
+    if (wCacheSize > (RECORD_CACHE_SIZE - g_wRecordCacheUsed))
     {
-        TPS_SetValue16(g_zApiARContext.record_mb[dwMailboxNumber].pt_errorcode1, wErrorCode1);
+        return API_RECORD_REGISTRY_CACHE_FULL;
     }
 
-    AppSetEventRegApp(APP_EVENT_RECORD_DONE);
-
-#ifdef DEBUG_API_TEST
-    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlags);
-    printf("DEBUG_API > Record Read Done set. 0x%x\n", byFlags);
-#endif
+    /* Keep the table sorted.                                                */
+    /*-----------------------------------------------------------------------*/
+    memmove(&g_zRecordRegistry[wPosition + 1], &g_zRecordRegistry[wPosition],
+            (g_wRecordRegistryUsed - wPosition) * sizeof(T_RECORD_HANDLER_ENTRY));
+    g_wRecordRegistryUsed++;
+
+    pzEntry = &g_zRecordRegistry[wPosition];
+    pzEntry->dwAPINumber    = dwAPINumber;
+    pzEntry->wSlotNumber    = wSlotNumber;
+    pzEntry->wSubslotNumber = wSubslotNumber;
+    pzEntry->wIndex         = wIndex;
+    pzEntry->wCacheOffset   = g_wRecordCacheUsed;
+    pzEntry->wCacheSize     = wCacheSize;
+    pzEntry->wCacheLength   = 0;
+    pzEntry->bCacheValid    = TPS_FALSE;
+    pzEntry->pfnRead        = pfnRead;
+    pzEntry->pfnWrite       = pfnWrite;
+
+    g_wRecordCacheUsed += wCacheSize;
 
     return TPS_ACTION_OK;
 }
 
 /*!
- * \brief       This function delivers the state of the mailbox. It should be called at the beginning of your record read/write callback
-                functions to get the details of the request.
+ * \brief       This function discards cached read responses, e.g. if the application has changed the data
+ *              of a record. RECORD_REGISTRY_ANY as slot, subslot or index selects all records of the API
+ *              with any number.
  *
- * \param[in]   dwMailboxNumber number of the record mailbox
- * \param[out]  pzMailBoxInfo pointer to the mail box info structure
+ * \param[in]   dwAPINumber API of the record
+ * \param[in]   wSlotNumber slot of the record or RECORD_REGISTRY_ANY
+ * \param[in]   wSubslotNumber subslot of the record or RECORD_REGISTRY_ANY
+ * \param[in]   wIndex record index or RECORD_REGISTRY_ANY
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - API_RECORD_MAILBOXINFO_INVALID_MAILBOX
- *              - API_RECORD_MAILBOXINFO_WRONG_FLAG
+ *              - API_RECORD_REGISTRY_NOT_FOUND : no registered record selected
  */
-USIGN32 TPS_GetMailboxInfo(USIGN32 dwMailboxNumber, RECORD_BOX_INFO *pzMailBoxInfo)
+USIGN32 TPS_InvalidateRecordCache(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, USIGN16 wIndex)
 {
-    USIGN8  byFlagBuff = 0;
-    USIGN16 wSeqNrBuff = 0;
-    USIGN32 dwApiBuff = 0;
-    USIGN16 wSlotNrBuff = 0;
-    USIGN16 wSubslotNrBuff = 0;
-    USIGN16 wPaddingBuff = 0;
-    USIGN16 wIndexBuff = 0;
-    USIGN32 dwRecordDataLenBuff = 0;
+    T_RECORD_HANDLER_ENTRY* pzEntry = NULL;
+    USIGN16 wEntry = 0;
+    USIGN32 dwReturnCode = API_RECORD_REGISTRY_NOT_FOUND;
 
-    if (dwMailboxNumber >= MAX_NUMBER_RECORDS)
+    for (wEntry = 0; wEntry < g_wRecordRegistryUsed; wEntry++)
     {
-        return API_RECORD_MAILBOXINFO_INVALID_MAILBOX;
+        pzEntry = &g_zRecordRegistry[wEntry];
+
+        if ((pzEntry->dwAPINumber == dwAPINumber) &&
+            ((wSlotNumber == RECORD_REGISTRY_ANY) || (pzEntry->wSlotNumber == wSlotNumber)) &&
+            ((wSubslotNumber == RECORD_REGISTRY_ANY) || (pzEntry->wSubslotNumber == wSubslotNumber)) &&
+            ((wIndex == RECORD_REGISTRY_ANY) || (pzEntry->wIndex == wIndex)))
+        {
+            AppRecordCacheInvalidate(pzEntry);
+            dwReturnCode = TPS_ACTION_OK;
+        }
     }
 
+    return dwReturnCode;
+}
 
-    /* Get the seq_number.                                                 */
-    /*---------------------------------------------------------------------*/
-    TPS_GetValue16((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER)),
-        &wSeqNrBuff);
+/*!
+ * \brief       This function returns the statistics of the record registry.
+ *
+ * \param[out]  pzStatistics the statistics are copied to this structure
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_RECORD_REGISTRY_NULL_POINTER
+ */
+USIGN32 TPS_GetRecordRegistryStatistics(T_RECORD_REGISTRY_STATISTICS* pzStatistics)
+{
+    if (pzStatistics == NULL)
+    {
+        return API_RECORD_REGISTRY_NULL_POINTER;
+    }
 
-    /* ar_uuid not yet implemented. */
+    *pzStatistics = g_zRecordRegistryStatistics;
 
-    /* Get the API number.                                                  */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue32((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG)),
-        &dwApiBuff);
-    /* Get the slot number.                                                 */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4),
-        &wSlotNrBuff);
-    /* Get the subslot number.                                              */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4 + 2),
-        &wSubslotNrBuff);
-    /* Get the padding.                                                     */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4 + 2 + 2),
-        &wPaddingBuff);
-    /* Get the index.                                                       */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue16((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4 + 2 + 2 + 2),
-        &wIndexBuff);
-    /* Get the record data_len.                                             */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue32((g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + sizeof(ETH_HEADER) +
-        sizeof(UDP_IP_HEADER) +
-        sizeof(RPC_HEADER) + sizeof(ARGS_REQ) + sizeof(BLOCK_HEADER) + 2 + sizeof(UUID_TAG) + 4 + 2 + 2 + 2 + 2),
-        &dwRecordDataLenBuff);
+    return TPS_ACTION_OK;
+}
+#endif
+/*!@} Record and Alarm Interface*/
 
-    /* The targetaruuid_padding is not yet implemented. */
+/*! \addtogroup objectpool Object Pools
+ *@{
+ */
 
-    /* Read the pt_flags.                                                   */
-    /*----------------------------------------------------------------------*/
-    TPS_GetValue8(g_zApiARContext.record_mb[dwMailboxNumber].pt_flags, &byFlagBuff);
+/*!
+ * \brief       Fills the stack of the free objects of a pool with all objects, the first
+ *              object is allocated first. The statistics are cleared.
+ *
+ * \param[in]   pzPool object pool
+ * \retval      none
+ */
+static VOID AppObjectPoolReset(T_OBJECT_POOL* pzPool)
+{
+    USIGN16 wCapacity = pzPool->zStatistics.wCapacity;
+    USIGN16 wIndex    = 0;
 
-    if (byFlagBuff == RECORD_FLAG_READ)
+    for (wIndex = 0; wIndex < wCapacity; wIndex++)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Read Record Request in Mailbox\n");
-#endif
+        pzPool->pwFree[wIndex] = wCapacity - 1 - wIndex;
+        pzPool->pbUsed[wIndex] = TPS_FALSE;
     }
-    else if (byFlagBuff == RECORD_FLAG_WRITE)
+    pzPool->wFree = wCapacity;
+
+    memset(&pzPool->zStatistics, 0, sizeof(pzPool->zStatistics));
+    pzPool->zStatistics.wCapacity = wCapacity;
+}
+
+/*!
+ * \brief       Takes an object of a pool. The object is cleared.
+ *
+ * \param[in]   pzPool object pool
+ * \retval      pointer to the object, NULL if all objects are in use
+ */
+static VOID* AppObjectPoolAlloc(T_OBJECT_POOL* pzPool)
+{
+    USIGN8* pbyObject = NULL;
+    USIGN16 wIndex    = 0;
+
+    if (pzPool->wFree == 0)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Write Record Request in Mailbox\n");
-#endif
+        pzPool->zStatistics.dwFailures++;
+        return NULL;
     }
-    else
+
+    pzPool->wFree--;
+    wIndex = pzPool->pwFree[pzPool->wFree];
+    pzPool->pbUsed[wIndex] = TPS_TRUE;
+
+    pbyObject = pzPool->pbyObjects + (wIndex * pzPool->dwObjectSize);
+    memset(pbyObject, 0x00, pzPool->dwObjectSize);
+
+    pzPool->zStatistics.dwAllocs++;
+    pzPool->zStatistics.wInUse++;
+    if (pzPool->zStatistics.wInUse > pzPool->zStatistics.wMaxInUse)
     {
-        /* invalid flag                                                      */
-        /*-------------------------------------------------------------------*/
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Mailbox Info Error -> Wrong flag!\n");
-#endif
-        return(API_RECORD_MAILBOXINFO_WRONG_FLAG);
+        pzPool->zStatistics.wMaxInUse = pzPool->zStatistics.wInUse;
     }
 
-    pzMailBoxInfo->dwAPINumber = TPS_htonl(dwApiBuff);
-    pzMailBoxInfo->wSlotNumber = TPS_htons(wSlotNrBuff);
-    pzMailBoxInfo->wSubSlotNumber = TPS_htons(wSubslotNrBuff);
-    pzMailBoxInfo->wIndex = TPS_htons(wIndexBuff);
-    pzMailBoxInfo->dwRecordDataLen = TPS_htonl(dwRecordDataLenBuff);
-
-    return (TPS_ACTION_OK);
+    return pbyObject;
 }
 
 /*!
- * \brief       This function initiates an alarm notification to a PLC
+ * \brief       Gives an object back to its pool.
  *
- * \param[in]   dwARNumber the AR number
- * \param[in]   dwAPINumber the API number
- * \param[in]   wSlotNumber the slot number
- * \param[in]   wSubslotNumber the subslot number
- * \param[in]   byAlarmPrio the alarm priority (ALARM_HIGH or ALARM_LOW)
- * \param[in]   byAlarmType the alarm type
- *              (PULL_ALARM, PLUG_ALARM, UPDATE_ALARM, PROCESS_ALARM, DIAGNOSIS_DISAPPEARS_ALARM, DIAGNOSIS_ALARM)
- * \param[in]   dwDataLength length of the alarm data
- * \param[in]   pbyAlarmData pointer to the buffer containing the alarm data
- * \param[in]   wUsi the user structure identifier that describes the structure of the alarm data
-                (User defined between 0x0000 and 0x7FFF)
- * \param[in]   specific handle to identify the corresponding alarm acknowledge. Should be unique for each sent alarm.
+ * \param[in]   pzPool object pool
+ * \param[in]   pObject object returned by AppObjectPoolAlloc() of this pool
  * \retval      possible return values:
  *              - TPS_ACTION_OK : success
- *              - API_ALARM_WRONG_AR_NUMBER
- *              - API_ALARM_PRIO_UNKNOWN
- *              - API_ALARM_DATA_TOO_LONG
- *              - API_ALARM_SUBSLOT_NOT_FOUND
- *              - API_ALARM_SUBSLOT_NOT_USED_BY_AR
+ *              - API_OBJECT_POOL_INVALID_OBJECT : not an object of the pool or not in use
  */
-USIGN32 TPS_SendAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber,
-    USIGN16 wSubslotNumber, USIGN8 byAlarmPrio, USIGN8 byAlarmType,
-    USIGN32 dwDataLength, USIGN8* pbyAlarmData, USIGN16 wUsi, USIGN16 wUserHandle)
+static USIGN32 AppObjectPoolFree(T_OBJECT_POOL* pzPool, VOID* pObject)
 {
-    USIGN8   byMailboxNr = 0;
-    SUBSLOT* pzSubslot = NULL;
-    SLOT*    pzSlot = NULL;
-    USIGN8   byFlagBuff = 0;
-    USIGN16  wOwnedByAr = 0;
-    BOOL     bSubslotUsedInAr = TPS_FALSE;
-    USIGN32  dwReturnValue = TPS_ACTION_OK;
-
-#ifdef DEBUG_API_TEST
-    /* Variables for the debug output!                                    */
-    /*--------------------------------------------------------------------*/
-    USIGN32 dwSizeAlarmMB = 0;
-    USIGN32 dwAPINr = 0;
-    USIGN16 wAlarmDataLen = 0;
-    USIGN8  byAlTyp = 0;
-#endif
+    USIGN8* pbyObject = (USIGN8*)pObject;
+    USIGN32 dwOffset  = 0;
+    USIGN32 dwIndex   = 0;
 
-    if ((dwARNumber != AR_0) && (dwARNumber != AR_1))
+    if (pbyObject < pzPool->pbyObjects)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Invalid AR number\n");
-#endif
-
-        return API_ALARM_WRONG_AR_NUMBER;
+        return API_OBJECT_POOL_INVALID_OBJECT;
     }
 
-    if ((byAlarmPrio != ALARM_HIGH) && (byAlarmPrio != ALARM_LOW))
+    dwOffset = (USIGN32)(pbyObject - pzPool->pbyObjects);
+    if ((dwOffset % pzPool->dwObjectSize) != 0)
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Invalid alarm prio\n");
-#endif
-
-        return API_ALARM_PRIO_UNKNOWN;
+        return API_OBJECT_POOL_INVALID_OBJECT;
     }
 
-    if (dwDataLength > (SIZE_ALARM_MB - 32))
+    dwIndex = dwOffset / pzPool->dwObjectSize;
+    if ((dwIndex >= pzPool->zStatistics.wCapacity) || (pzPool->pbUsed[dwIndex] == TPS_FALSE))
     {
-#ifdef DEBUG_API_TEST
-        printf("DEBUG_API > Alarm data too long(%d bytes). Longer than %d bytes\n", dwDataLength, (SIZE_ALARM_MB - 32));
-#endif
-
-        return API_ALARM_DATA_TOO_LONG;
+        return API_OBJECT_POOL_INVALID_OBJECT;
     }
 
-    if (wSubslotNumber != 0)
+    pzPool->pbUsed[dwIndex] = TPS_FALSE;
+    pzPool->pwFree[pzPool->wFree] = (USIGN16)dwIndex;
+    pzPool->wFree++;
+
+    pzPool->zStatistics.dwFrees++;
+    pzPool->zStatistics.wInUse--;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function returns the statistics of an object pool of the API, slot or
+ *              subslot handles.
+ *
+ * \param[in]   byPool OBJECT_POOL_API_LIST, OBJECT_POOL_SLOT or OBJECT_POOL_SUBSLOT
+ * \param[out]  pzStatistics the statistics are copied to this structure
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_OBJECT_POOL_INVALID_POOL
+ *              - API_OBJECT_POOL_NULL_POINTER
+ */
+USIGN32 TPS_GetObjectPoolStatistics(USIGN8 byPool, T_OBJECT_POOL_STATISTICS* pzStatistics)
+{
+    if (byPool >= OBJECT_POOL_NUMBER)
     {
-        /* Check if the submodule is used in the given AR.                    */
-        pzSubslot = AppGetSubslotHandle(dwAPINumber, wSlotNumber, wSubslotNumber);
+        return API_OBJECT_POOL_INVALID_POOL;
+    }
 
-        if (pzSubslot == NULL)
-        {
-            dwReturnValue = API_ALARM_SUBSLOT_NOT_FOUND;
-        }
-        else
-        {
-            TPS_GetValue16((USIGN8*)(pzSubslot->pt_wSubslotOwnedByAr), &wOwnedByAr);
-            if ((wOwnedByAr & OWNED_BY_AR(dwARNumber)) != SUBSLOT_NOT_USED)
-            {
-                bSubslotUsedInAr = TPS_TRUE;
-            }
-        }
+    if (pzStatistics == NULL)
+    {
+        return API_OBJECT_POOL_NULL_POINTER;
     }
-    else
+
+    *pzStatistics = g_zObjectPool[byPool].zStatistics;
+
+    return TPS_ACTION_OK;
+}
+/*!@} Object Pools*/
+
+#ifdef USE_BUFFER_POOL
+/*! \addtogroup bufferpool Buffer Pool
+ *@{
+ */
+
+/*!
+ * \brief       This function takes a block of the buffer pool. It replaces malloc() for packet and
+ *              record buffers which are freed again before the caller returns. The block is not cleared.
+ *
+ * \param[in]   dwLength needed length, maximum BUFFER_POOL_BLOCK_SIZE
+ * \retval      pointer to the block, NULL if no block is free or dwLength is too long
+ */
+USIGN8* TPS_BufferPoolAlloc(USIGN32 dwLength)
+{
+    USIGN32 dwBlock = 0;
+
+    if (dwLength > g_zBufferPoolStatistics.dwMaxLength)
     {
-        /* SubslotNumber = 0 -> module representative                         */
-        /* Check if a submodule of this module is used in the given AR.       */
-        pzSlot = AppGetSlotHandle(dwAPINumber, wSlotNumber);
+        g_zBufferPoolStatistics.dwMaxLength = dwLength;
+    }
 
-        if (pzSlot == NULL)
-        {
-            dwReturnValue = API_ALARM_SLOT_NOT_FOUND;
-        }
-        else
+    if (dwLength <= BUFFER_POOL_BLOCK_SIZE)
+    {
+        for (dwBlock = 0; dwBlock < BUFFER_POOL_BLOCKS; dwBlock++)
         {
-            for (pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            if ((g_dwBufferPoolUsed & (1UL << dwBlock)) == 0)
             {
-                TPS_GetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, &wOwnedByAr);
+                g_dwBufferPoolUsed |= (1UL << dwBlock);
 
-                if ((wOwnedByAr & OWNED_BY_AR(dwARNumber)) != SUBSLOT_NOT_USED)
+                g_zBufferPoolStatistics.dwAllocs++;
+                g_zBufferPoolStatistics.wInUse++;
+                if (g_zBufferPoolStatistics.wInUse > g_zBufferPoolStatistics.wMaxInUse)
                 {
-                    bSubslotUsedInAr = TPS_TRUE;
-                    break;
+                    g_zBufferPoolStatistics.wMaxInUse = g_zBufferPoolStatistics.wInUse;
                 }
+
+                return (USIGN8*)g_dwBufferPool[dwBlock];
             }
         }
     }
 
-    /* If the subslot is used, select the correct mailbox and send the alarm. */
-    if ((dwReturnValue == TPS_ACTION_OK) && (bSubslotUsedInAr == TPS_TRUE))
-    {
-        if ((byAlarmPrio == ALARM_HIGH) && (dwARNumber == AR_0))
-        {
-            byMailboxNr = 1;
-        }
-        else if ((byAlarmPrio == ALARM_LOW) && (dwARNumber == AR_0))
-        {
-            byMailboxNr = 0;
-        }
-        else if ((byAlarmPrio == ALARM_HIGH) && (dwARNumber == AR_1))
-        {
-            byMailboxNr = 3;
-        }
-        else if ((byAlarmPrio == ALARM_LOW) && (dwARNumber == AR_1))
-        {
-            byMailboxNr = 2;
-        }
-    }
-    else if (dwReturnValue == TPS_ACTION_OK)
-    {
-        /* slot was found but not owned by this AR */
-        dwReturnValue = API_ALARM_SUBSLOT_NOT_USED_BY_AR;
-    }
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > Buffer pool: no block for %lu bytes\n", (unsigned long)dwLength);
+#endif
+    g_zBufferPoolStatistics.dwFailures++;
 
+    return NULL;
+}
 
-    if (dwReturnValue == TPS_ACTION_OK)
+/*!
+ * \brief       This function gives a block back to the buffer pool.
+ *
+ * \param[in]   pbyBuffer block returned by TPS_BufferPoolAlloc()
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_BUFFER_POOL_INVALID_BUFFER : pbyBuffer is NULL, not a block of the pool or not in use
+ */
+USIGN32 TPS_BufferPoolFree(USIGN8* pbyBuffer)
+{
+    USIGN32 dwBlock = 0;
+
+    for (dwBlock = 0; dwBlock < BUFFER_POOL_BLOCKS; dwBlock++)
     {
-        /* Get the Mailbox Flag.                                              */
-        /*--------------------------------------------------------------------*/
-        TPS_GetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, &byFlagBuff);
-        if (byFlagBuff != UNUSED_FLAG) /* Check if unused! */
+        if (pbyBuffer == (USIGN8*)g_dwBufferPool[dwBlock])
         {
-            /* Return error code                                              */
-            /*----------------------------------------------------------------*/
-            dwReturnValue = API_ALARM_MAILBOX_IN_USE;
+            if ((g_dwBufferPoolUsed & (1UL << dwBlock)) == 0)
+            {
+                break;
+            }
+
+            g_dwBufferPoolUsed &= ~(1UL << dwBlock);
+            g_zBufferPoolStatistics.wInUse--;
+
+            return TPS_ACTION_OK;
         }
     }
 
-    if (dwReturnValue == TPS_ACTION_OK)
-    {
-        TPS_SetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, ACTIVE_FLAG);
-        TPS_SetValue32(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_api)), dwAPINumber);
-        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_slot_nr)), wSlotNumber);
-        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_subslot_nr)), wSubslotNumber);
-        TPS_SetValue8(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_alarm_typ)), byAlarmType);
-        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_usi)), TPS_htons(wUsi));
-        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_usr_hdl)), wUserHandle);
-        TPS_SetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_data_length)), (USIGN16)dwDataLength);
-        TPS_SetValueData(g_zAlarmMailbox[byMailboxNr].pt_data, pbyAlarmData, dwDataLength);
-
-#ifdef DEBUG_API_TEST
-        /* Debug Info for the processed alarm mailbox.                    */
-        /*----------------------------------------------------------------*/
-        dwSizeAlarmMB = g_zAlarmMailbox[byMailboxNr].size_alarm_mailbox;
-        TPS_GetValue8(g_zAlarmMailbox[byMailboxNr].pt_flags, &byFlagBuff);
-        TPS_GetValue32(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_api)), &dwAPINumber);
-        TPS_GetValue16(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_data_length)), &wAlarmDataLen);
-        TPS_GetValue8(((USIGN8*)(g_zAlarmMailbox[byMailboxNr].pt_alarm_typ)), &byAlTyp);
-        printf("*g_zAlarmMailbox[byMailbox_nr].size_alarm_mailbox=%d\n", dwSizeAlarmMB);
-        printf("*g_zAlarmMailbox[byMailbox_nr].pt_flags=0x%x\n", byFlagBuff);
-        printf("*g_zAlarmMailbox[byMailbox_nr].pt_api=0x%x\n", dwAPINr);
-        printf("*g_zAlarmMailbox[byMailbox_nr].pt_data_length=0x%x\n", wAlarmDataLen);
-        printf("*g_zAlarmMailbox[byMailbox_nr].pt_alarm_typ=0x%x\n", byAlTyp);
-#endif
+    return API_BUFFER_POOL_INVALID_BUFFER;
+}
 
-        /* Set the alarm request bit for the processed AR                     */
-        /*--------------------------------------------------------------------*/
-        AppSetEventAlarmReq(dwARNumber);
+/*!
+ * \brief       This function returns the statistics of the buffer pool.
+ *
+ * \param[out]  pzStatistics the statistics are copied to this structure
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_BUFFER_POOL_NULL_POINTER
+ */
+USIGN32 TPS_GetBufferPoolStatistics(T_BUFFER_POOL_STATISTICS* pzStatistics)
+{
+    if (pzStatistics == NULL)
+    {
+        return API_BUFFER_POOL_NULL_POINTER;
     }
 
-    return dwReturnValue;
+    *pzStatistics = g_zBufferPoolStatistics;
+
+    return TPS_ACTION_OK;
 }
-/*!@} Record and Alarm Interface*/
+/*!@} Buffer Pool*/
+#endif
 
 /*! \addtogroup ledhandling LED Interface
  *@{
@@ -4019,45 +6593,318 @@ while(dwTryTimer < MAX_WAIT_CYCLES)
        TPS_StartFwStack();
     }
 
-    return dwErrorCode;
+    return dwErrorCode;
+
+}
+/*!
+ * \brief      This function starts the downloaded firmware image and leaves the updater mode
+ *
+ * \note       To use this function <b>FW_UPDATE_OVER_HOST</b> in TPS_1_user.h must be defined
+ * \param[in]  void
+ * \retval      USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - ERR_UPDATER_APP_NOT_STARTED
+ */
+USIGN32 TPS_StartFwStack(void)
+{
+    DPR_HOST_HEADER *pzDprHeader = (DPR_HOST_HEADER*)BASE_ADDRESS_NRT_AREA;
+    USIGN32 dwEventHost = 0;
+    USIGN32 dwHostSign = 0;
+    USIGN32 dwError = TPS_ACTION_OK;
+
+    TPS_GetValue32((USIGN8*)&(pzDprHeader->dwHostSign), &dwHostSign);
+
+    if((dwHostSign != UPDATER_LIFE_SIGN) && (dwHostSign != HOST_LIFE_SIGN))
+    {
+        dwError = ERR_UPDATER_APP_NOT_STARTED;
+    }
+    else
+    {
+        /* Write identifier to NRT AREA                                      */
+        /*-------------------------------------------------------------------*/
+        TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostSign), HOST_LIFE_SIGN);
+
+        /* Start the stack firmware again.                                   */
+        /*-------------------------------------------------------------------*/
+        dwEventHost |= (0x1 << APP_EVENT_START_FW);
+        TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostEvent), dwEventHost);
+    }
+
+    return dwError;
+}
+
+#ifdef USE_FW_UPDATE_STREAM
+/*!
+ * \brief      Ends the streamed update and starts the TPS-1 stack again, as
+ *             TPS_WriteFWImageToFlash() does in all cases.
+ *
+ * \param[in]  dwResult result reported by TPS_FwUpdateService() from now on
+ * \retval     VOID
+ */
+static VOID AppFwStreamEnd(USIGN32 dwResult)
+{
+    g_dwFwStreamResult = dwResult;
+    g_byFwStreamState = FW_STREAM_DONE;
+
+    #ifdef DEBUG_API_TEST
+        printf("\n%lu Bytes transfered to TPS, result 0x%lX\n",
+               (unsigned long)g_zFwStreamStatistics.dwBytes, (unsigned long)dwResult);
+    #endif
+
+    /* Change the execution from TPS Updater to TPS Stack                    */
+    /*-----------------------------------------------------------------------*/
+    TPS_StartFwStack();
+}
+
+/*!
+ * \brief      This function starts a streamed firmware update. TPS_StartFwUpdater()
+ *             must have been called before. The image is passed in pieces of
+ *             any length by TPS_FwUpdatePush() and written to the TPS-1 by
+ *             TPS_FwUpdateService(), so it never has to be in host memory.
+ * \ingroup    allfunctions
+ * \note       To use this function <b>USE_FW_UPDATE_STREAM</b> in TPS_1_user.h must be defined
+ * \param[in]  dwLengthOfImage the length of the firmware image
+ * \param[in]  dwTimeMs current time in milliseconds (e.g. HAL_GetTick()), used for the timeout and the statistics
+ * \retval     USIGN32
+ *              - TPS_ACTION_OK : success
+ *              - API_FW_STREAM_INVALID_PARAM : dwLengthOfImage is 0
+ *              - API_FW_STREAM_BUSY : an update is still running
+ */
+USIGN32 TPS_FwUpdateBegin(USIGN32 dwLengthOfImage, USIGN32 dwTimeMs)
+{
+    DPR_HOST_HEADER *pzDprHeader = (DPR_HOST_HEADER*)BASE_ADDRESS_NRT_AREA;
+
+    if(dwLengthOfImage == 0)
+    {
+        return API_FW_STREAM_INVALID_PARAM;
+    }
+
+    if((g_byFwStreamState == FW_STREAM_TRANSFER) || (g_byFwStreamState == FW_STREAM_FINISH))
+    {
+        return API_FW_STREAM_BUSY;
+    }
+
+    g_byFwStreamHead = 0;
+    g_byFwStreamFull = 0;
+    g_dwFwStreamFill = 0;
+    g_dwFwStreamImageLength = dwLengthOfImage;
+    g_dwFwStreamReceived = 0;
+    g_dwFwStreamProgressMs = dwTimeMs;
+    g_dwFwStreamResult = TPS_ACTION_OK;
+    g_dwFwStreamStartMs = dwTimeMs;
+    memset(&g_zFwStreamStatistics, 0, sizeof(g_zFwStreamStatistics));
+
+    /* Set event for starting the update process!                            */
+    /*-----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostSign), HOST_LIFE_SIGN);
+    TPS_SetValue32((USIGN8*)&(pzDprHeader->dwErrorCode), TPS_ACTION_OK);
+    TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostEvent), (0x1 << APP_EVENT_START_FW_UPDATE));
+
+    g_byFwStreamState = FW_STREAM_TRANSFER;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief      This function takes the next bytes of the firmware image into the
+ *             fragment buffers. It never blocks: if both buffers are full,
+ *             fewer bytes than dwLength are taken and the rest has to be
+ *             passed again after the next TPS_FwUpdateService().
+ * \ingroup    allfunctions
+ * \note       To use this function <b>USE_FW_UPDATE_STREAM</b> in TPS_1_user.h must be defined
+ * \param[in]  pbyData next bytes of the image
+ * \param[in]  dwLength number of bytes in pbyData
+ * \retval     USIGN32 number of bytes taken
+ */
+USIGN32 TPS_FwUpdatePush(const USIGN8* pbyData, USIGN32 dwLength)
+{
+    USIGN32 dwTaken = 0;
+    USIGN32 dwCopy;
+    USIGN8  byBuffer;
+
+    if((pbyData == NULL) || (g_byFwStreamState != FW_STREAM_TRANSFER))
+    {
+        return 0;
+    }
+
+    while((dwTaken < dwLength) &&
+          (g_byFwStreamFull < FW_STREAM_BUFFERS) &&
+          (g_dwFwStreamReceived < g_dwFwStreamImageLength))
+    {
+        byBuffer = (g_byFwStreamHead + g_byFwStreamFull) % FW_STREAM_BUFFERS;
+
+        dwCopy = FW_FRAG_LEN - g_dwFwStreamFill;
+        if(dwCopy > (dwLength - dwTaken))
+        {
+            dwCopy = dwLength - dwTaken;
+        }
+        if(dwCopy > (g_dwFwStreamImageLength - g_dwFwStreamReceived))
+        {
+            dwCopy = g_dwFwStreamImageLength - g_dwFwStreamReceived;
+        }
+
+        memcpy(&g_byFwStreamBuffer[byBuffer][g_dwFwStreamFill], pbyData + dwTaken, dwCopy);
+        g_dwFwStreamFill += dwCopy;
+        g_dwFwStreamReceived += dwCopy;
+        dwTaken += dwCopy;
+
+        /* A fragment is complete with FW_FRAG_LEN bytes or the image end.   */
+        /*-------------------------------------------------------------------*/
+        if((g_dwFwStreamFill == FW_FRAG_LEN) || (g_dwFwStreamReceived == g_dwFwStreamImageLength))
+        {
+            g_wFwStreamLength[byBuffer] = (USIGN16)g_dwFwStreamFill;
+            g_dwFwStreamFill = 0;
+            g_byFwStreamFull++;
+        }
+    }
+
+    return dwTaken;
+}
+
+/*!
+ * \brief      This function drives the streamed firmware update and has to be
+ *             called cyclically until it returns something else than
+ *             API_FW_STREAM_BUSY. Each call reads the mailbox flag of the
+ *             updater once and, if the TPS-1 has taken the previous fragment,
+ *             writes the next full fragment. After the last fragment it waits
+ *             for UPD_EVENT_FW_UPDATE_DONE and starts the TPS-1 stack. The update
+ *             ends if no fragment was written for FW_STREAM_TIMEOUT_MS.
+ * \ingroup    allfunctions
+ * \note       To use this function <b>USE_FW_UPDATE_STREAM</b> in TPS_1_user.h must be defined
+ * \param[in]  dwTimeMs current time in milliseconds (e.g. HAL_GetTick()), used for the timeout and the statistics
+ * \retval     USIGN32
+ *              - API_FW_STREAM_BUSY : the update is running
+ *              - TPS_ACTION_OK : the update was successful
+ *              - API_FW_STREAM_UPDATER_ERROR : the updater reported an error
+ *              - API_FW_STREAM_TIMEOUT : the updater did not take a fragment or finish within FW_STREAM_TIMEOUT_MS
+ *              - API_FW_STREAM_SOURCE_TIMEOUT : TPS_FwUpdatePush() did not deliver a fragment within FW_STREAM_TIMEOUT_MS
+ *              - API_FW_STREAM_NOT_STARTED : TPS_FwUpdateBegin() was not called
+ */
+USIGN32 TPS_FwUpdateService(USIGN32 dwTimeMs)
+{
+    DPR_HOST_HEADER *pzDprHeader = (DPR_HOST_HEADER*)BASE_ADDRESS_NRT_AREA;
+    USIGN32 dwStatus[2];
+    USIGN32 dwMbxFlag;
+    USIGN16 wFragLen;
+
+    switch(g_byFwStreamState)
+    {
+    case FW_STREAM_IDLE:
+        return API_FW_STREAM_NOT_STARTED;
+
+    case FW_STREAM_DONE:
+        return g_dwFwStreamResult;
+
+    case FW_STREAM_TRANSFER:
+        if(g_byFwStreamFull == 0)
+        {
+            /* The source has not delivered the next fragment yet. */
+            g_zFwStreamStatistics.dwSourceStalls++;
+            if((dwTimeMs - g_dwFwStreamProgressMs) >= FW_STREAM_TIMEOUT_MS)
+            {
+                AppFwStreamEnd(API_FW_STREAM_SOURCE_TIMEOUT);
+            }
+            break;
+        }
+
+        /* dwErrorCode and the mailbox flag are adjacent: one SPI read.      */
+        /*-------------------------------------------------------------------*/
+        TPS_GetValueData((USIGN8*)&(pzDprHeader->dwErrorCode), (USIGN8*)dwStatus, sizeof(dwStatus));
+
+        if((dwStatus[0] & 0xFFFFFFFE) != 0)
+        {
+            AppFwStreamEnd(API_FW_STREAM_UPDATER_ERROR);
+            break;
+        }
+
+        if(dwStatus[1] != 0)
+        {
+            /* The TPS-1 still programs the previous fragment. */
+            g_zFwStreamStatistics.dwMailboxBusy++;
+            if((dwTimeMs - g_dwFwStreamProgressMs) >= FW_STREAM_TIMEOUT_MS)
+            {
+                AppFwStreamEnd(API_FW_STREAM_TIMEOUT);
+            }
+            break;
+        }
+
+        g_dwFwStreamProgressMs = dwTimeMs;
+        wFragLen = g_wFwStreamLength[g_byFwStreamHead];
+
+        /* Write data and length into the mailbox.                           */
+        /*-------------------------------------------------------------------*/
+        TPS_SetValueData((USIGN8*)&(pzDprHeader->pbFwStartAddr.bData),
+                         g_byFwStreamBuffer[g_byFwStreamHead], wFragLen);
+        TPS_SetValue32((USIGN8*)&(pzDprHeader->pbFwStartAddr.dwFragLen), wFragLen);
+
+        g_zFwStreamStatistics.dwBytes += wFragLen;
+        g_zFwStreamStatistics.dwFragments++;
+        g_byFwStreamHead = (g_byFwStreamHead + 1) % FW_STREAM_BUFFERS;
+        g_byFwStreamFull--;
+
+        /* Set mailbox state to busy, 2: last fragment                       */
+        /*-------------------------------------------------------------------*/
+        dwMbxFlag = (g_zFwStreamStatistics.dwBytes == g_dwFwStreamImageLength) ? 2 : 1;
+        TPS_SetValue32((USIGN8*)&(pzDprHeader->pbFwStartAddr.dwFlag), dwMbxFlag);
+
+        if(dwMbxFlag == 2)
+        {
+            g_byFwStreamState = FW_STREAM_FINISH;
+        }
+        break;
+
+    case FW_STREAM_FINISH:
+        /* dwUpdaterEvent and dwErrorCode are adjacent: one SPI read.        */
+        /*-------------------------------------------------------------------*/
+        TPS_GetValueData((USIGN8*)&(pzDprHeader->dwUpdaterEvent), (USIGN8*)dwStatus, sizeof(dwStatus));
+
+        if(dwStatus[0] & (0x1 << UPD_EVENT_FW_UPDATE_DONE))
+        {
+            AppFwStreamEnd(((dwStatus[1] & 0xFFFFFFFE) == 0) ? TPS_ACTION_OK : API_FW_STREAM_UPDATER_ERROR);
+        }
+        else if((dwTimeMs - g_dwFwStreamProgressMs) >= FW_STREAM_TIMEOUT_MS)
+        {
+            AppFwStreamEnd(API_FW_STREAM_TIMEOUT);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    g_zFwStreamStatistics.dwTotalTimeMs = dwTimeMs - g_dwFwStreamStartMs;
 
+    return (g_byFwStreamState == FW_STREAM_DONE) ? g_dwFwStreamResult : API_FW_STREAM_BUSY;
 }
+
 /*!
- * \brief      This function starts the downloaded firmware image and leaves the updater mode
- *
- * \note       To use this function <b>FW_UPDATE_OVER_HOST</b> in TPS_1_user.h must be defined
- * \param[in]  void
- * \retval      USIGN32
+ * \brief      This function returns the statistics of the streamed firmware
+ *             update. The time is updated by each TPS_FwUpdateService() call.
+ * \ingroup    allfunctions
+ * \note       To use this function <b>USE_FW_UPDATE_STREAM</b> in TPS_1_user.h must be defined
+ * \param[out] pzStatistics pointer to the statistics
+ * \retval     USIGN32
  *              - TPS_ACTION_OK : success
- *              - ERR_UPDATER_APP_NOT_STARTED
+ *              - API_FW_STREAM_INVALID_PARAM : pzStatistics is NULL
  */
-USIGN32 TPS_StartFwStack(void)
+USIGN32 TPS_GetFwUpdateStatistics(T_FW_UPDATE_STATISTICS* pzStatistics)
 {
-    DPR_HOST_HEADER *pzDprHeader = (DPR_HOST_HEADER*)BASE_ADDRESS_NRT_AREA;
-    USIGN32 dwEventHost = 0;
-    USIGN32 dwHostSign = 0;
-    USIGN32 dwError = TPS_ACTION_OK;
-
-    TPS_GetValue32((USIGN8*)&(pzDprHeader->dwHostSign), &dwHostSign);
-
-    if((dwHostSign != UPDATER_LIFE_SIGN) && (dwHostSign != HOST_LIFE_SIGN))
+    if(pzStatistics == NULL)
     {
-        dwError = ERR_UPDATER_APP_NOT_STARTED;
+        return API_FW_STREAM_INVALID_PARAM;
     }
-    else
-    {
-        /* Write identifier to NRT AREA                                      */
-        /*-------------------------------------------------------------------*/
-        TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostSign), HOST_LIFE_SIGN);
 
-        /* Start the stack firmware again.                                   */
-        /*-------------------------------------------------------------------*/
-        dwEventHost |= (0x1 << APP_EVENT_START_FW);
-        TPS_SetValue32((USIGN8*)&(pzDprHeader->dwHostEvent), dwEventHost);
+    *pzStatistics = g_zFwStreamStatistics;
+
+    if(pzStatistics->dwTotalTimeMs != 0)
+    {
+        pzStatistics->dwBytesPerSecond = (USIGN32)(((USIGN64)pzStatistics->dwBytes * 1000) /
+                                                   pzStatistics->dwTotalTimeMs);
     }
 
-    return dwError;
+    return TPS_ACTION_OK;
 }
+#endif
 
 /******************************************************************************
   END of FUNCTIONS FOR TPS FIRMWARE UPDATE OVER HOST-IF
@@ -4256,6 +7103,9 @@ USIGN32 TPS_GetSubmoduleConfiguration(SUBSLOT* poSubslot, USIGN32* pdwSubmoduleI
 USIGN32 TPS_SetModuleState(SLOT* pzSlot, T_MODULE_STATE zModuleState, USIGN32 dwModuleIdentNumber)
 {
     USIGN32 dwRetval = TPS_ACTION_OK;
+#ifdef USE_SUBSLOT_IO_CACHE
+    SUBSLOT* pzSubslot = NULL;
+#endif
 
     /* Check the API State. */
     if(g_byApiState != STATE_DEVICE_STARTED)
@@ -4283,6 +7133,13 @@ USIGN32 TPS_SetModuleState(SLOT* pzSlot, T_MODULE_STATE zModuleState, USIGN32 dw
     }
 #endif
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+    {
+        pzSubslot->zIoCache.bValid = TPS_FALSE;
+    }
+#endif
+
     /* Set the new state. */
     switch(zModuleState)
     {
@@ -4382,6 +7239,11 @@ USIGN32 TPS_SetSubmoduleState(SUBSLOT* pzSubslot, T_MODULE_STATE zSubmoduleState
     }
 #endif
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    /* The operational state is part of the cached IO descriptor. */
+    pzSubslot->zIoCache.bValid = TPS_FALSE;
+#endif
+
     /* Set the new state. */
     switch(zSubmoduleState)
     {
@@ -4473,7 +7335,7 @@ USIGN32 TPS_PullModule(USIGN32 dwApi, USIGN16 wSlotNumber)
         /* Now pull all submodules of this slot. */
         for (poSubslot = poSlot->pSubslot; poSubslot != NULL; poSubslot = poSubslot->poNextSubslot)
         {
-            TPS_GetValue16((USIGN8*)poSubslot->pt_subslot_number, &wSubslotNumber);
+            wSubslotNumber = AppGetSubslotNumber(poSubslot);
             dwRetval = TPS_PullSubmodule(dwApi, wSlotNumber, wSubslotNumber);
             if ((dwRetval != TPS_ACTION_OK) &&
                 (dwRetval != PULL_SUB_MODULE_ALREADY_REMOVED))
@@ -4891,7 +7753,7 @@ USIGN32 TPS_RecordWriteReqToStack(USIGN16 wSlotNr, USIGN16 wSubslotNr,
     USIGN32 dwDataLenShort = (dwDataLength & 0xFFFF);
 
     /* Create frame*/
-    pbyPacket = malloc(dwDataLenShort + sizeof(RW_RECORD_REQ_BLOCK)
+    pbyPacket = API_BUFFER_ALLOC(dwDataLenShort + sizeof(RW_RECORD_REQ_BLOCK)
         + sizeof(BLOCK_HEADER) + sizeof(ARGS_REQ));
 
     pbyWriteRecord = pbyPacket + sizeof(BLOCK_HEADER);
@@ -4949,7 +7811,7 @@ USIGN32 TPS_RecordWriteReqToStack(USIGN16 wSlotNr, USIGN16 wSubslotNr,
         }
 #endif
 
-        free(pbyPacket);
+        API_BUFFER_FREE(pbyPacket);
     }
     else
     {
@@ -4985,7 +7847,7 @@ USIGN32 TPS_RecordReadReqToStack(USIGN16 wSlotNr, USIGN16 wSubslotNr,
     USIGN32 dwValue = 0;
 
     /* Create frame*/
-    pbyPacket = malloc(sizeof(RW_RECORD_REQ_BLOCK) + sizeof(BLOCK_HEADER) + sizeof(ARGS_REQ));
+    pbyPacket = API_BUFFER_ALLOC(sizeof(RW_RECORD_REQ_BLOCK) + sizeof(BLOCK_HEADER) + sizeof(ARGS_REQ));
 
     pbyReadRecord = pbyPacket + sizeof(BLOCK_HEADER);
     pzBlockHeader = (BLOCK_HEADER*)pbyPacket;
@@ -5040,7 +7902,7 @@ USIGN32 TPS_RecordReadReqToStack(USIGN16 wSlotNr, USIGN16 wSubslotNr,
         }
 #endif
 
-        free(pbyPacket);
+        API_BUFFER_FREE(pbyPacket);
     }
     else
     {
@@ -5082,11 +7944,12 @@ USIGN32 TPS_WriteConfigBlockToFlash(USIGN8* pbyConfigurationData, USIGN16 wDataL
     }
 
     /* Allocate the needed memory. */
-    pbyEthernetPacket = calloc(ETHERNET_HEADER_SIZE + IP_HEADER_SIZE + UDP_HEADER_SIZE + wDataLength + ETHERNET_CRC_SIZE, 1);
+    pbyEthernetPacket = API_BUFFER_ALLOC(ETHERNET_HEADER_SIZE + IP_HEADER_SIZE + UDP_HEADER_SIZE + wDataLength + ETHERNET_CRC_SIZE);
     if (pbyEthernetPacket == NULL)
     {
         return API_CONFIG_OUT_OF_MEMORY;
     }
+    memset(pbyEthernetPacket, 0, ETHERNET_HEADER_SIZE + IP_HEADER_SIZE + UDP_HEADER_SIZE + wDataLength + ETHERNET_CRC_SIZE);
 
     pbyCurrentPosition = pbyEthernetPacket;
 
@@ -5136,7 +7999,7 @@ USIGN32 TPS_WriteConfigBlockToFlash(USIGN8* pbyConfigurationData, USIGN16 wDataL
             PORT_NR_INTERNAL);
     }
 
-    free(pbyEthernetPacket);
+    API_BUFFER_FREE(pbyEthernetPacket);
 
     return dwRetval;
 }
@@ -5175,7 +8038,7 @@ USIGN32 TPS_DcpSetDeviceName(USIGN8* pbyDeviceName, USIGN16 wNameLength, USIGN16
 
         wLenOfSendBuffer = sizeof(byEthHeader) + sizeof(DCP_SET_HEADER) + sizeof(DCP_BLOCK)*2 + wNameLength + wNameLength%2/*padding*/;
 
-    pbySendBuffer = malloc(wLenOfSendBuffer);
+    pbySendBuffer = API_BUFFER_ALLOC(wLenOfSendBuffer);
 
     if(pbySendBuffer != 0)
     {
@@ -5214,7 +8077,7 @@ USIGN32 TPS_DcpSetDeviceName(USIGN8* pbyDeviceName, USIGN16 wNameLength, USIGN16
 
        dwReturnValue = TPS_SendEthernetFrame( pbySendBuffer, wLenOfSendBuffer, PORT_NR_INTERNAL );
 
-           free(pbySendBuffer);
+           API_BUFFER_FREE(pbySendBuffer);
 
     }
     else
@@ -5258,10 +8121,11 @@ USIGN32 TPS_DcpSetDeviceIP(USIGN32 dwIPAddr, USIGN32 dwSubnetMask, USIGN32 dwGat
 
    static USIGN32 dwXidCounter = 0;
 
-   pbySendBuffer = malloc(MIN_LEN_ETHERNET_FRAME);
+   pbySendBuffer = API_BUFFER_ALLOC(MIN_LEN_ETHERNET_FRAME);
 
    if(pbySendBuffer != 0)
    {
+       memset(pbySendBuffer, 0, MIN_LEN_ETHERNET_FRAME);
        pdyActualPosition = pbySendBuffer;
 
        /*Eth-Header*/
@@ -5297,7 +8161,7 @@ USIGN32 TPS_DcpSetDeviceIP(USIGN32 dwIPAddr, USIGN32 dwSubnetMask, USIGN32 dwGat
 
        dwReturnValue = TPS_SendEthernetFrame( pbySendBuffer, MIN_LEN_ETHERNET_FRAME, PORT_NR_INTERNAL );
 
-       free(pbySendBuffer);
+       API_BUFFER_FREE(pbySendBuffer);
 
    }
    else
@@ -5326,10 +8190,11 @@ USIGN32 TPS_DcpSetResetToFactory(USIGN16 wBlockQualifier)
 
    static USIGN32 dwXidCounter = 0;
 
-   pbySendBuffer = malloc(MIN_LEN_ETHERNET_FRAME);
+   pbySendBuffer = API_BUFFER_ALLOC(MIN_LEN_ETHERNET_FRAME);
 
    if(pbySendBuffer != 0)
    {
+       memset(pbySendBuffer, 0, MIN_LEN_ETHERNET_FRAME);
        pdyActualPosition = pbySendBuffer;
 
        /*Eth-Header*/
@@ -5362,7 +8227,7 @@ USIGN32 TPS_DcpSetResetToFactory(USIGN16 wBlockQualifier)
 
        dwReturnValue = TPS_SendEthernetFrame( pbySendBuffer, MIN_LEN_ETHERNET_FRAME, PORT_NR_INTERNAL );
 
-       free(pbySendBuffer);
+       API_BUFFER_FREE(pbySendBuffer);
 
    }
    else
@@ -5451,12 +8316,178 @@ static VOID AppOnEthernetReceive(VOID)
 
     if ((g_zApiEthernetContext.OnEthernetFrameRX_CB != NULL) && (g_poEthernetRXMailbox != NULL))
     {
+#ifdef USE_ETHERNET_RX_FILTER
+        if (AppEthernetRxFilter() == TPS_TRUE)
+        {
+            g_zEthRxFilterStatistics.dwAccepted++;
+            g_zApiEthernetContext.OnEthernetFrameRX_CB(g_poEthernetRXMailbox);
+        }
+        else
+        {
+            g_zEthRxFilterStatistics.dwDropped++;
+        }
+#else
         g_zApiEthernetContext.OnEthernetFrameRX_CB(g_poEthernetRXMailbox);
+#endif
     }
 
     TPS_SetValue32((USIGN8*)&g_poEthernetRXMailbox->dwMailboxState, ETH_MBX_EMPTY);
 }
 
+#ifdef USE_ETHERNET_RX_FILTER
+/*!
+ * \brief       Reads the header of the frame in the ethernet RX mailbox with one
+ *              SPI read and checks it against the filter rules. The header is
+ *              kept for TPS_GetEthernetRxHeader().
+ *
+ * \note        To use this function <b>USE_ETHERNET_RX_FILTER</b> in TPS_1_user.h must be defined.
+ * \retval      TPS_TRUE the frame is accepted (or no rule is set)
+ * \retval      TPS_FALSE no rule accepts the frame
+ */
+static BOOL AppEthernetRxFilter(VOID)
+{
+    USIGN8  byPeek[ETH_RX_PEEK_SIZE];
+    USIGN8* pbyFrame = &byPeek[8];
+    USIGN16 wVlanId;
+    USIGN8  byRule;
+    T_ETH_RX_FILTER_RULE* pzRule;
+
+    /* dwLength, dwPortnumber and the first bytes of byFrame are contiguous. */
+    TPS_GetValueData((USIGN8*)&g_poEthernetRXMailbox->dwLength, byPeek, ETH_RX_PEEK_SIZE);
+
+    memcpy(&g_zEthRxHeader.dwLength, &byPeek[0], sizeof(USIGN32));
+    memcpy(&g_zEthRxHeader.dwPortNumber, &byPeek[4], sizeof(USIGN32));
+    memcpy(g_zEthRxHeader.byDstMac, &pbyFrame[0], MAC_ADDRESS_SIZE);
+    memcpy(g_zEthRxHeader.bySrcMac, &pbyFrame[MAC_ADDRESS_SIZE], MAC_ADDRESS_SIZE);
+
+    /* The frame data is in network byte order. */
+    g_zEthRxHeader.wEtherType = (USIGN16)((pbyFrame[12] << 8) | pbyFrame[13]);
+    g_zEthRxHeader.wVlanTci = 0;
+    g_zEthRxHeader.wPayloadOffset = 2 * MAC_ADDRESS_SIZE + 2;
+
+    if (g_zEthRxHeader.wEtherType == ETH_VLAN_TPID)
+    {
+        g_zEthRxHeader.wVlanTci = (USIGN16)((pbyFrame[14] << 8) | pbyFrame[15]);
+        g_zEthRxHeader.wEtherType = (USIGN16)((pbyFrame[16] << 8) | pbyFrame[17]);
+        g_zEthRxHeader.wPayloadOffset += ETH_VLAN_TAG_SIZE;
+    }
+
+    if (g_bEthRxOwnMacValid == TPS_FALSE)
+    {
+        TPS_GetMacAddresses(g_byEthRxOwnMac, NULL, NULL);
+        g_bEthRxOwnMacValid = TPS_TRUE;
+    }
+
+    g_zEthRxHeader.bToOwnMac = (memcmp(g_zEthRxHeader.byDstMac, g_byEthRxOwnMac, MAC_ADDRESS_SIZE) == 0) ? TPS_TRUE : TPS_FALSE;
+    g_zEthRxHeader.byRule = ETH_RX_NO_RULE;
+
+    if (g_byEthRxFilterRulesUsed == 0)
+    {
+        return TPS_TRUE;
+    }
+
+    wVlanId = g_zEthRxHeader.wVlanTci & 0x0FFF;
+
+    for (byRule = 0; byRule < g_byEthRxFilterRulesUsed; byRule++)
+    {
+        pzRule = &g_zEthRxFilterRules[byRule];
+
+        if (((pzRule->byMatch & ETH_RX_MATCH_ETHERTYPE) && (pzRule->wEtherType != g_zEthRxHeader.wEtherType)) ||
+            ((pzRule->byMatch & ETH_RX_MATCH_DST_MAC) && (memcmp(pzRule->byDstMac, g_zEthRxHeader.byDstMac, MAC_ADDRESS_SIZE) != 0)) ||
+            ((pzRule->byMatch & ETH_RX_MATCH_OWN_MAC) && (g_zEthRxHeader.bToOwnMac == TPS_FALSE)) ||
+            ((pzRule->byMatch & ETH_RX_MATCH_VLAN) && (pzRule->wVlanId != wVlanId)) ||
+            ((pzRule->byMatch & ETH_RX_MATCH_PORT) && (pzRule->dwPortNumber != g_zEthRxHeader.dwPortNumber)))
+        {
+            continue;
+        }
+
+        g_zEthRxHeader.byRule = byRule;
+        return TPS_TRUE;
+    }
+
+    return TPS_FALSE;
+}
+
+/*!
+ * \brief       Adds a rule to the ethernet receive filter. A received frame is
+ *              passed to the callback of TPS_RegisterEthernetReceiveCallback()
+ *              if at least one rule accepts it. Without rules every frame is
+ *              passed. The rules are kept until TPS_ClearEthernetRxFilter() or
+ *              TPS_InitApplicationInterface().
+ *
+ * \param[in]   pzRule rule, the fields to compare are selected by byMatch
+ * \note        To use this function <b>USE_ETHERNET_RX_FILTER</b> in TPS_1_user.h must be defined.
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK
+ *              - ETH_RX_FILTER_NULL_POINTER
+ *              - ETH_RX_FILTER_FULL : more than ETH_RX_FILTER_RULES rules
+ */
+USIGN32 TPS_AddEthernetRxFilterRule(const T_ETH_RX_FILTER_RULE* pzRule)
+{
+    if (pzRule == NULL)
+    {
+        return ETH_RX_FILTER_NULL_POINTER;
+    }
+
+    if (g_byEthRxFilterRulesUsed >= ETH_RX_FILTER_RULES)
+    {
+        return ETH_RX_FILTER_FULL;
+    }
+
+    g_zEthRxFilterRules[g_byEthRxFilterRulesUsed++] = *pzRule;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       Removes all rules of the ethernet receive filter, every frame is
+ *              passed to the receive callback again.
+ *
+ * \note        To use this function <b>USE_ETHERNET_RX_FILTER</b> in TPS_1_user.h must be defined.
+ * \retval      none
+ */
+VOID TPS_ClearEthernetRxFilter(VOID)
+{
+    g_byEthRxFilterRulesUsed = 0;
+}
+
+/*!
+ * \brief       Returns the header of the received frame as read by the receive
+ *              filter. Only valid inside the receive callback, so the callback
+ *              does not have to read the length, the port or the MAC addresses
+ *              from the mailbox again.
+ *
+ * \note        To use this function <b>USE_ETHERNET_RX_FILTER</b> in TPS_1_user.h must be defined.
+ * \retval      pointer to the header
+ */
+const T_ETH_RX_HEADER* TPS_GetEthernetRxHeader(VOID)
+{
+    return &g_zEthRxHeader;
+}
+
+/*!
+ * \brief       Returns the number of accepted and dropped frames of the ethernet
+ *              receive filter.
+ *
+ * \param[out]  pzStatistics pointer to the statistics
+ * \note        To use this function <b>USE_ETHERNET_RX_FILTER</b> in TPS_1_user.h must be defined.
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK
+ *              - ETH_RX_FILTER_NULL_POINTER
+ */
+USIGN32 TPS_GetEthernetRxFilterStatistics(T_ETH_RX_FILTER_STATISTICS* pzStatistics)
+{
+    if (pzStatistics == NULL)
+    {
+        return ETH_RX_FILTER_NULL_POINTER;
+    }
+
+    *pzStatistics = g_zEthRxFilterStatistics;
+
+    return TPS_ACTION_OK;
+}
+#endif
+
 /*!
 * \brief       This function sends an Ethernet packet through the TPS-1 Ethernet interface.
 *
@@ -5515,10 +8546,8 @@ USIGN32 TPS_SendEthernetFrameFragmented(USIGN8* pbyPacket, USIGN16 wLength, USIG
     USIGN32 dwMailboxState = ETH_MBX_EMPTY;
     USIGN8  byEventBitNr = 0;
     T_ETHERNET_MAILBOX* pzMailBox = NULL;
-
-    static USIGN8 byWriteSessionPending = 0;
-    static USIGN8* pbyLastFramAddr = NULL;
-    static USIGN16 wByteNumberSent = 0;
+    USIGN8  byTxMailbox;
+    USIGN16 wByteNumberSent;
 
 #ifdef DEBUG_API_ETH_FRAME
     /* Debug-Print of the TPS_SendEthernetFrame() function. */
@@ -5560,59 +8589,302 @@ USIGN32 TPS_SendEthernetFrameFragmented(USIGN8* pbyPacket, USIGN16 wLength, USIG
         pzMailBox = g_poEthernetTXMailbox;
     }
 
-    if(pbyLastFramAddr != pbyPacket)
+    /* A different frame for the same mailbox cancels the pending one. */
+    byTxMailbox = ETH_TX_MAILBOX(wPortNr);
+    if(g_pbyEthTxPendingFrame[byTxMailbox] != pbyPacket)
+    {
+       g_pbyEthTxPendingFrame[byTxMailbox] = NULL;
+    }
+
+    wByteNumberSent = g_wEthTxBytesSent[byTxMailbox];
+
+    if(g_pbyEthTxPendingFrame[byTxMailbox] == NULL)
+    {
+       TPS_GetValue32((USIGN8*)&pzMailBox->dwMailboxState, &dwMailboxState);
+
+       if (((dwEventRegister & (0x01 << byEventBitNr)) == (0x01 << byEventBitNr)) ||
+           (pzMailBox == NULL) ||
+           (dwMailboxState != ETH_MBX_EMPTY))
+       {
+#ifdef DEBUG_API_ETH_FRAME
+           printf("DEBUG_API > Can not send the frame at the moment. The stack is still accessing the data.\n");
+#endif
+
+           return(ETH_FRAME_CAN_NOT_BE_SEND);
+       }
+
+       g_pbyEthTxPendingFrame[byTxMailbox] = pbyPacket;
+       wByteNumberSent = 0;
+
+       TPS_SetValue32((USIGN8*)&pzMailBox->dwLength, wLength);
+       TPS_SetValue32((USIGN8*)&pzMailBox->dwPortnumber, wPortNr);
+    }
+
+    if(wMaxFragLen >= wLength)
+    {
+       TPS_SetValueData((USIGN8*)&pzMailBox->byFrame, pbyPacket, wLength);
+       wByteNumberSent = wLength;
+    }
+    else if((wLength - wByteNumberSent) < wMaxFragLen)
+    {
+       TPS_SetValueData(((USIGN8*)&pzMailBox->byFrame) + wByteNumberSent, pbyPacket + wByteNumberSent, (wLength - wByteNumberSent));
+       wByteNumberSent = wLength;
+    }
+    else
+    {
+       TPS_SetValueData(((USIGN8*)&pzMailBox->byFrame) + wByteNumberSent, pbyPacket + wByteNumberSent, wMaxFragLen);
+       wByteNumberSent += wMaxFragLen;
+    }
+
+    g_wEthTxBytesSent[byTxMailbox] = wByteNumberSent;
+
+    if(wByteNumberSent == wLength)
+    {
+        AppSetEventRegApp(byEventBitNr);
+        g_pbyEthTxPendingFrame[byTxMailbox] = NULL;
+    }
+
+    return wByteNumberSent;
+}
+
+#ifdef USE_ETHERNET_TX_QUEUE
+/*!
+* \brief       Copies an Ethernet frame into the TX queue of its mailbox. The frame
+*              is written to the TPS-1 by TPS_ServiceEthernetTxQueue(), so the
+*              caller can reuse pbyPacket immediately. Frames of one queue are
+*              sent in order.
+*
+* \param[in]   pbyPacket pointer to the complete frame buffer to send
+* \param[in]   wLength data length of the Ethernet frame minus Frame Check Sequence (FCS)
+* \param[in]   wPortNr Ethernet port number to use (PORT_ANY, PORT_NR_1, PORT_NR_2, PORT_NR_1_2 or PORT_NR_INTERNAL)
+* \note        To use this function <b>USE_ETHERNET_TX_QUEUE</b> in TPS_1_user.h must be defined.
+* \retval      possible return values:
+*              - TPS_ACTION_OK
+*              - ETH_TX_QUEUE_INVALID_PARAM : pbyPacket is NULL or wLength is 0
+*              - ETH_SEND_FRAME_TOO_LONG
+*              - ETH_INVALID_PORT
+*              - ETH_TX_QUEUE_FULL : ETH_TX_QUEUE_DEPTH frames are queued or the ring of the queue is full.
+*/
+USIGN32 TPS_QueueEthernetFrame(USIGN8* pbyPacket, USIGN16 wLength, USIGN16 wPortNr)
+{
+    USIGN8  byQueue = ETH_TX_MAILBOX(wPortNr);
+    T_ETH_TX_QUEUE_ENTRY* pzEntry;
+    USIGN16 wHead;
+    USIGN16 wOffset;
+
+    if ((pbyPacket == NULL) || (wLength == 0))
+    {
+        return ETH_TX_QUEUE_INVALID_PARAM;
+    }
+
+    if (wLength > MAX_LEN_ETHERNET_FRAME)
+    {
+        return ETH_SEND_FRAME_TOO_LONG;
+    }
+
+    if ((wPortNr!=PORT_ANY) && (wPortNr != PORT_NR_1) && (wPortNr != PORT_NR_2) && (wPortNr != PORT_NR_1_2) && (wPortNr != PORT_NR_INTERNAL))
+    {
+        return ETH_INVALID_PORT;
+    }
+
+#ifndef USE_TPS_COMMUNICATION_CHANNEL
+    if (wPortNr == PORT_NR_INTERNAL)
+    {
+        return ETH_INVALID_PORT;
+    }
+#endif
+
+    if (g_byEthTxQueueCount[byQueue] >= ETH_TX_QUEUE_DEPTH)
+    {
+        return ETH_TX_QUEUE_FULL;
+    }
+
+    /* Space in the ring: behind the last frame, else in front of the first  */
+    /* one. The tail never reaches the head, so tail == head means empty.    */
+    /*-----------------------------------------------------------------------*/
+    wHead = (g_byEthTxQueueCount[byQueue] > 0) ? g_zEthTxQueue[byQueue][g_byEthTxQueueHead[byQueue]].wOffset : 0;
+    if (g_byEthTxQueueCount[byQueue] == 0)
+    {
+        g_wEthTxRingTail[byQueue] = 0;
+    }
+
+    if (g_wEthTxRingTail[byQueue] >= wHead)
+    {
+        if (wLength <= (ETH_TX_QUEUE_SIZE - g_wEthTxRingTail[byQueue]))
+        {
+            wOffset = g_wEthTxRingTail[byQueue];
+        }
+        else if (wLength < wHead)
+        {
+            wOffset = 0;
+        }
+        else
+        {
+            return ETH_TX_QUEUE_FULL;
+        }
+    }
+    else if ((g_wEthTxRingTail[byQueue] + wLength) < wHead)
+    {
+        wOffset = g_wEthTxRingTail[byQueue];
+    }
+    else
+    {
+        return ETH_TX_QUEUE_FULL;
+    }
+
+    memcpy(&g_byEthTxRing[byQueue][wOffset], pbyPacket, wLength);
+    g_wEthTxRingTail[byQueue] = wOffset + wLength;
+
+    pzEntry = &g_zEthTxQueue[byQueue][(g_byEthTxQueueHead[byQueue] + g_byEthTxQueueCount[byQueue]) % ETH_TX_QUEUE_DEPTH];
+    pzEntry->wOffset = wOffset;
+    pzEntry->wLength = wLength;
+    pzEntry->wPortNr = wPortNr;
+    pzEntry->wBytesSent = 0;
+    pzEntry->dwQueuedAt = g_dwEthTxServiceCalls;
+    g_byEthTxQueueCount[byQueue]++;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+* \brief       Writes queued frames to the TPS-1, at most dwByteBudget frame bytes
+*              per call. A frame larger than the remaining budget is written in
+*              fragments over several calls, the queues take turns. Call it once
+*              per cycle between the IO data updates, so the NRT traffic never
+*              delays TPS_UpdateOutputData() / TPS_UpdateInputData() by more
+*              than the SPI time of dwByteBudget bytes. The waits in the
+*              statistics (dwMaxWait) are counted in calls of this function,
+*              not in time.
+*
+* \param[in]   dwByteBudget maximum number of frame bytes to write
+* \note        To use this function <b>USE_ETHERNET_TX_QUEUE</b> in TPS_1_user.h must be defined.
+* \retval      number of frame bytes written
+*/
+USIGN32 TPS_ServiceEthernetTxQueue(USIGN32 dwByteBudget)
+{
+    USIGN32 dwBytesWritten = 0;
+    USIGN8  byTurn;
+
+    g_dwEthTxServiceCalls++;
+
+    for (byTurn = 0; byTurn < ETH_TX_QUEUES; byTurn++)
+    {
+        dwBytesWritten += AppEthTxQueueService((g_byEthTxNextQueue + byTurn) % ETH_TX_QUEUES,
+                                               dwByteBudget - dwBytesWritten);
+    }
+
+    g_byEthTxNextQueue = (g_byEthTxNextQueue + 1) % ETH_TX_QUEUES;
+
+    return dwBytesWritten;
+}
+
+/*!
+* \brief       Returns the statistics of a TX queue.
+*
+* \param[in]   byQueue ETH_TX_QUEUE_ETHERNET or ETH_TX_QUEUE_INTERNAL
+* \param[out]  pzStatistics pointer to the statistics
+* \note        To use this function <b>USE_ETHERNET_TX_QUEUE</b> in TPS_1_user.h must be defined.
+* \retval      possible return values:
+*              - TPS_ACTION_OK
+*              - ETH_TX_QUEUE_INVALID
+*/
+USIGN32 TPS_GetEthernetTxQueueStatistics(USIGN8 byQueue, T_ETH_TX_QUEUE_STATISTICS* pzStatistics)
+{
+    if ((byQueue >= ETH_TX_QUEUES) || (pzStatistics == NULL))
+    {
+        return ETH_TX_QUEUE_INVALID;
+    }
+
+    *pzStatistics = g_zEthTxQueueStatistics[byQueue];
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+* \brief       Writes fragments of the frames of one TX queue until the budget is
+*              used, the queue is empty or the TX mailbox is busy.
+*
+* \param[in]   byQueue ETH_TX_QUEUE_ETHERNET or ETH_TX_QUEUE_INTERNAL
+* \param[in]   dwByteBudget maximum number of frame bytes to write
+* \retval      number of frame bytes written
+*/
+static USIGN32 AppEthTxQueueService(USIGN8 byQueue, USIGN32 dwByteBudget)
+{
+    T_ETH_TX_QUEUE_STATISTICS* pzStatistics = &g_zEthTxQueueStatistics[byQueue];
+    T_ETH_TX_QUEUE_ENTRY* pzEntry;
+    USIGN32 dwBytesWritten = 0;
+    USIGN32 dwFragment;
+    USIGN32 dwResult;
+    USIGN32 dwWait;
+
+    while ((g_byEthTxQueueCount[byQueue] > 0) && (dwBytesWritten < dwByteBudget))
     {
-       byWriteSessionPending = 0;
-    }
+        pzEntry = &g_zEthTxQueue[byQueue][g_byEthTxQueueHead[byQueue]];
 
-    if(!byWriteSessionPending)
-    {
-       TPS_GetValue32((USIGN8*)&pzMailBox->dwMailboxState, &dwMailboxState);
+        dwFragment = pzEntry->wLength - pzEntry->wBytesSent;
+        if (dwFragment > (dwByteBudget - dwBytesWritten))
+        {
+            dwFragment = dwByteBudget - dwBytesWritten;
+        }
 
-       if (((dwEventRegister & (0x01 << byEventBitNr)) == (0x01 << byEventBitNr)) ||
-           (pzMailBox == NULL) ||
-           (dwMailboxState != ETH_MBX_EMPTY))
-       {
-#ifdef DEBUG_API_ETH_FRAME
-           printf("DEBUG_API > Can not send the frame at the moment. The stack is still accessing the data.\n");
-#endif
+        dwResult = TPS_SendEthernetFrameFragmented(&g_byEthTxRing[byQueue][pzEntry->wOffset], pzEntry->wLength,
+                                                   pzEntry->wPortNr, (USIGN16)dwFragment);
 
-           return(ETH_FRAME_CAN_NOT_BE_SEND);
-       }
+        if (dwResult == ETH_FRAME_CAN_NOT_BE_SEND)
+        {
+            /* The TPS-1 still processes the previous frame, try again next call. */
+            pzStatistics->dwRetries++;
+            break;
+        }
 
-       byWriteSessionPending = 1;
-       pbyLastFramAddr = pbyPacket;
-       wByteNumberSent = 0;
+        if (dwResult > pzEntry->wLength)
+        {
+            /* Checked by TPS_QueueEthernetFrame(), not expected: drop the frame. */
+            dwResult = pzEntry->wLength;
+        }
+        else
+        {
+            /* If an application call of TPS_SendEthernetFrame() cancelled the */
+            /* frame, it was started again at offset 0.                        */
+            dwFragment = (dwResult > pzEntry->wBytesSent) ? (dwResult - pzEntry->wBytesSent) : dwResult;
+            dwBytesWritten += dwFragment;
+            pzStatistics->dwBytes += dwFragment;
+            pzStatistics->dwFragments++;
+        }
 
-       TPS_SetValue32((USIGN8*)&pzMailBox->dwLength, wLength);
-       TPS_SetValue32((USIGN8*)&pzMailBox->dwPortnumber, wPortNr);
-    }
+        pzEntry->wBytesSent = (USIGN16)dwResult;
 
-    if(wMaxFragLen >= wLength)
-    {
-       TPS_SetValueData((USIGN8*)&pzMailBox->byFrame, pbyPacket, wLength);
-       wByteNumberSent = wLength;
-    }
-    else if((wLength - wByteNumberSent) < wMaxFragLen)
-    {
-       TPS_SetValueData(((USIGN8*)&pzMailBox->byFrame) + wByteNumberSent, pbyPacket + wByteNumberSent, (wLength - wByteNumberSent));
-       wByteNumberSent = wLength;
-    }
-    else
-    {
-       TPS_SetValueData(((USIGN8*)&pzMailBox->byFrame) + wByteNumberSent, pbyPacket + wByteNumberSent, wMaxFragLen);
-       wByteNumberSent += wMaxFragLen;
-    }
+        if (pzEntry->wBytesSent == pzEntry->wLength)
+        {
+            dwWait = g_dwEthTxServiceCalls - pzEntry->dwQueuedAt;
+            if (dwWait > pzStatistics->dwMaxWait)
+            {
+                pzStatistics->dwMaxWait = dwWait;
+            }
+            pzStatistics->dwFrames++;
 
-    if(wByteNumberSent == wLength)
-    {
-        AppSetEventRegApp(byEventBitNr);
-        byWriteSessionPending = 0;
-        pbyLastFramAddr = NULL;
+            g_byEthTxQueueHead[byQueue] = (g_byEthTxQueueHead[byQueue] + 1) % ETH_TX_QUEUE_DEPTH;
+            g_byEthTxQueueCount[byQueue]--;
+        }
     }
 
-    return wByteNumberSent;
+    return dwBytesWritten;
+}
+
+/*!
+* \brief       Drops all queued frames, e.g. after a reset of the TPS-1.
+*
+* \retval      none
+*/
+static VOID AppEthTxQueueFlush(VOID)
+{
+    memset(g_byEthTxQueueHead, 0, sizeof(g_byEthTxQueueHead));
+    memset(g_byEthTxQueueCount, 0, sizeof(g_byEthTxQueueCount));
+    memset(g_wEthTxRingTail, 0, sizeof(g_wEthTxRingTail));
+
+    memset(g_pbyEthTxPendingFrame, 0, sizeof(g_pbyEthTxPendingFrame));
 }
+#endif
 
 
 /*!@} Ethernet_Interface Ethernet Interface*/
@@ -5643,17 +8915,110 @@ USIGN32 TPS_SendEthernetFrameFragmented(USIGN8* pbyPacket, USIGN16 wLength, USIG
 */
 USIGN32 TPS_SendDiagAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubSlotNumber, USIGN8 byAlarmPrio,
     USIGN8 byAlarmType, USIGN32 dwDiagAddress, USIGN16 wUserHandle)
+{
+    USIGN8  byStatus = DIAGNOSIS_ALARM;
+    USIGN16 wUsi = USI_EXT_CHANNEL_DIAGNOSIS;
+    USIGN32 dwAlarmDataLength = 0;
+    USIGN8  byAlarmData[sizeof(DPR_DIAG_ENTRY)];
+    USIGN32 dwErrorCode = 0;
+
+    dwErrorCode = AppDiagBuildAlarm(dwDiagAddress, byAlarmType, byAlarmData, &dwAlarmDataLength, &byStatus, &wUsi);
+
+    if (dwErrorCode == TPS_ACTION_OK)
+    {
+        dwErrorCode = TPS_SendAlarm(dwARNumber, dwAPINumber, wSlotNumber, wSubSlotNumber,
+                                    byAlarmPrio, byStatus, dwAlarmDataLength,
+                                    byAlarmData, wUsi, wUserHandle);
+    }
+
+    return dwErrorCode;
+}
+
+#ifdef USE_ALARM_QUEUE
+/*!
+* \brief       This function sends a diagnosis alarm notification like TPS_SendDiagAlarm(), but
+               queues it if the alarm mailbox is busy (see TPS_QueueAlarm()). The alarm data is
+               taken from the diagnosis entry now, so the entry may be changed or removed
+               while the alarm is queued.
+*
+* \param[in]   dwArNumber AR_0 or AR_1
+* \param[in]   dwAPINumber API number
+* \param[in]   wSlotNumber slot number
+* \param[in]   wSubSlotNumber subslot number
+* \param[in]   byAlarmPrio priority of the alarm notification (should be ALARM_LOW)
+* \param[in]   byAlarmType specifies if this diagnosis APPEARS or DISAPPEARS
+* \param[in]   dwDiagAdress pointer the diagnosis entry created by TPS_DiagChannelAdd()
+* \param[in]   wUserHandle specific handle to identify the corresponding alarm acknowledge.
+* \retval      possible return values:
+*              - TPS_ACTION_OK : the alarm was sent or queued
+*              - API_DIAG_PROP_WRONG_PARAMETER
+*              or any Error from TPS_QueueAlarm()
+*/
+USIGN32 TPS_QueueDiagAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubSlotNumber, USIGN8 byAlarmPrio,
+    USIGN8 byAlarmType, USIGN32 dwDiagAddress, USIGN16 wUserHandle)
+{
+    USIGN8  byStatus = DIAGNOSIS_ALARM;
+    USIGN16 wUsi = USI_EXT_CHANNEL_DIAGNOSIS;
+    USIGN32 dwAlarmDataLength = 0;
+    USIGN8  byAlarmData[sizeof(DPR_DIAG_ENTRY)];
+    USIGN32 dwErrorCode = 0;
+
+    dwErrorCode = AppDiagBuildAlarm(dwDiagAddress, byAlarmType, byAlarmData, &dwAlarmDataLength, &byStatus, &wUsi);
+
+    if (dwErrorCode == TPS_ACTION_OK)
+    {
+        dwErrorCode = TPS_QueueAlarm(dwARNumber, dwAPINumber, wSlotNumber, wSubSlotNumber,
+                                     byAlarmPrio, byStatus, dwAlarmDataLength,
+                                     byAlarmData, wUsi, wUserHandle);
+    }
+
+    return dwErrorCode;
+}
+#endif
+
+/*!
+* \brief       Builds the alarm data of a diagnosis alarm from a diagnosis entry.
+*
+* \param[in]   dwDiagAdress pointer the diagnosis entry created by TPS_DiagChannelAdd()
+* \param[in]   byAlarmType specifies if this diagnosis APPEARS or DISAPPEARS
+* \param[out]  pbyAlarmData alarm data, sizeof(DPR_DIAG_ENTRY) bytes
+* \param[out]  pdwAlarmDataLength length of the alarm data
+* \param[out]  pbyStatus alarm type (DIAGNOSIS_ALARM or DIAGNOSIS_DISAPPEARS_ALARM)
+* \param[out]  pwUsi user structure identifier of the alarm data
+* \retval      possible return values:
+*              - TPS_ACTION_OK : success
+*              - API_DIAG_PROP_WRONG_PARAMETER
+*/
+static USIGN32 AppDiagBuildAlarm(USIGN32 dwDiagAddress, USIGN8 byAlarmType, USIGN8* pbyAlarmData,
+    USIGN32* pdwAlarmDataLength, USIGN8* pbyStatus, USIGN16* pwUsi)
 {
     USIGN8  byStatus = DIAGNOSIS_ALARM;
     USIGN16 wUsi = USI_EXT_CHANNEL_DIAGNOSIS;
     USIGN32 dwAlarmDataLength = sizeof(DPR_DIAG_ENTRY) - 1;
     DPR_DIAG_ENTRY zDiagData = { 0 };
     USIGN32 dwAlarmData[2];
+#ifdef USE_DIAG_INDEX
+    SUBSLOT* pzSubslot;
+    USIGN32 dwEntryIndex = 0;
+#endif
 
     USIGN32 dwErrorCode = 0;
 
+#ifdef USE_DIAG_INDEX
+    /* Take the entry from the host side copy. */
+    pzSubslot = AppDiagIndexFind(dwDiagAddress, &dwEntryIndex);
+    if (pzSubslot != NULL)
+    {
+        zDiagData = *DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+    }
+    else
+    {
+        dwErrorCode = API_DIAG_PROP_WRONG_PARAMETER;
+    }
+#else
     /* Read the entry from the TPS-1 NRT Area. */
     dwErrorCode = TPS_GetValueData((USIGN8*)dwDiagAddress, (USIGN8*)&zDiagData, sizeof(DPR_DIAG_ENTRY));
+#endif
 
     if (dwErrorCode == TPS_ACTION_OK)
     {
@@ -5681,11 +9046,13 @@ USIGN32 TPS_SendDiagAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlot
             dwAlarmDataLength = (USIGN32)(TPS_htons(zDiagData.wExtchannelErrortype));
             dwAlarmData[0] = TPS_htonl(zDiagData.dwExtchannelAddval);
             dwAlarmData[1] = TPS_htonl(zDiagData.dwQualifiedChannelQualifier); 
-                        
-            dwErrorCode = TPS_SendAlarm(dwARNumber, dwAPINumber, wSlotNumber, wSubSlotNumber,
-                                        byAlarmPrio, byStatus, dwAlarmDataLength,
-                                        (USIGN8*)&dwAlarmData, TPS_htons(zDiagData.wChannelNumber), wUserHandle);
-            
+            if (dwAlarmDataLength > sizeof(dwAlarmData))
+            {
+                dwAlarmDataLength = sizeof(dwAlarmData);
+            }
+
+            memcpy(pbyAlarmData, dwAlarmData, dwAlarmDataLength);
+            wUsi = TPS_htons(zDiagData.wChannelNumber);
         }
         else
         {
@@ -5705,12 +9072,13 @@ USIGN32 TPS_SendDiagAlarm(USIGN32 dwARNumber, USIGN32 dwAPINumber, USIGN16 wSlot
               dwAlarmDataLength -= 10;
            }
 
-           dwErrorCode = TPS_SendAlarm(dwARNumber, dwAPINumber, wSlotNumber, wSubSlotNumber,
-                                       byAlarmPrio, byStatus, dwAlarmDataLength,
-                                       (USIGN8*)&zDiagData, wUsi, wUserHandle);
+           memcpy(pbyAlarmData, &zDiagData, dwAlarmDataLength);
         }
-    }
 
+        *pdwAlarmDataLength = dwAlarmDataLength;
+        *pbyStatus = byStatus;
+        *pwUsi = wUsi;
+    }
 
     return dwErrorCode;
 }
@@ -5910,7 +9278,10 @@ USIGN32 TPS_DiagChannelRemove(USIGN32 dwDiagAddress)
 {
     DPR_DIAG_ENTRY zDiagEntry = { 0 };
     USIGN32 dwErrorCode = 0;
-    USIGN32 dwEventRegister = 0;
+#ifdef USE_DIAG_INDEX
+    SUBSLOT* pzSubslot;
+    USIGN32 dwEntryIndex = 0;
+#endif
 
 #ifdef DEBUG_API_TEST
     printf("TPS_DiagChannelRemove -> Started \n");
@@ -5922,14 +9293,26 @@ USIGN32 TPS_DiagChannelRemove(USIGN32 dwDiagAddress)
     }
 
     /* Check if Event is free */
-    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP, &dwEventRegister);
-    if ( (dwEventRegister & (0x01 << APP_EVENT_DIAG_CHANGED)) == (0x01 << APP_EVENT_DIAG_CHANGED) )
+    dwErrorCode = AppDiagCheckEventFree(API_DIAG_REMOVE_EVENT_IN_USE);
+    if (dwErrorCode != TPS_ACTION_OK)
+    {
+        return dwErrorCode;
+    }
+
+#ifdef USE_DIAG_INDEX
+    /* Take the entry from the host side copy */
+    pzSubslot = AppDiagIndexFind(dwDiagAddress, &dwEntryIndex);
+    if (pzSubslot == NULL)
     {
-        return API_DIAG_REMOVE_EVENT_IN_USE;
+        return API_DIAG_REMOVE_WRONG_PARAMETER;
     }
 
+    dwErrorCode = AppDiagIndexRefreshFlags(pzSubslot, dwEntryIndex);
+    zDiagEntry = *DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+#else
     /* Read one entry from the TPS-1 diag buffer */
     dwErrorCode = TPS_GetValueData((USIGN8*)dwDiagAddress, (USIGN8*)&zDiagEntry, sizeof(DPR_DIAG_ENTRY));
+#endif
     if (dwErrorCode != TPS_ACTION_OK)
     {
         return API_DIAG_REMOVE_WRONG_RESULT;
@@ -5941,18 +9324,29 @@ USIGN32 TPS_DiagChannelRemove(USIGN32 dwDiagAddress)
         /* OK: mark the diag entry as "disappeared" */
         zDiagEntry.byFlags = DISAPPEAR_FLAG; /* disappear and changed */
 
+#ifdef USE_DIAG_INDEX
+        /* Only the flags change, the rest of the entry is already there */
+        dwErrorCode = TPS_SetValue8((USIGN8*)dwDiagAddress + DIAG_ENTRY_FLAGS_OFFSET, DISAPPEAR_FLAG);
+#else
         /* Send the new diag entry to the TPS-1 */
         dwErrorCode = TPS_SetValueData((USIGN8*)dwDiagAddress, (USIGN8*)&zDiagEntry, sizeof(DPR_DIAG_ENTRY));
+#endif
         if (dwErrorCode != TPS_ACTION_OK)
         {
             return API_DIAG_REMOVE_WRONG_RESULT;
         }
+#ifdef USE_DIAG_INDEX
+        /* The entry is free after the acknowledge of the TPS-1 */
+        DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex)->byFlags = DISAPPEAR_FLAG;
+        pzSubslot->zDiagIndex.wPendingDisappear++;
+#endif
 #ifdef DIAGNOSIS_ENABLE
         /* decrease global counter of diagnosis entries */
         g_wNumberOfDiagEntries--;
 #endif 
 
-        AppSetEventRegApp(APP_EVENT_DIAG_CHANGED);
+        /* The disappear alarm belongs to TPS_DiagSetChangeState() */
+        AppDiagChanged(dwDiagAddress, DIAG_BATCH_NO_ALARM);
 
         return TPS_ACTION_OK;
     }
@@ -5987,7 +9381,11 @@ USIGN32 TPS_DiagSetChangeState(USIGN32 dwDiagAddress, USIGN8 byNewMaintenanceSta
 
     USIGN16 wChannelProperties = 0;
     USIGN32 dwErrorCode = TPS_ACTION_OK;
-    USIGN32 dwEventRegister;
+    USIGN32 dwEventState;
+#ifdef USE_DIAG_INDEX
+    SUBSLOT* pzSubslot = NULL;
+    USIGN32 dwEntryIndex = 0;
+#endif
 
 
 #ifdef DEBUG_API_TEST
@@ -6002,22 +9400,40 @@ USIGN32 TPS_DiagSetChangeState(USIGN32 dwDiagAddress, USIGN8 byNewMaintenanceSta
     }
 
     /* Check if Event is free */
-    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP, &dwEventRegister);
-    if ( (dwEventRegister & (0x01 << APP_EVENT_DIAG_CHANGED)) == (0x01 << APP_EVENT_DIAG_CHANGED) )
+    dwEventState = AppDiagCheckEventFree(API_DIAG_CHANGE_EVENT_IN_USE);
+    if (dwEventState != TPS_ACTION_OK)
     {
-        dwErrorCode = API_DIAG_CHANGE_EVENT_IN_USE;
+        dwErrorCode = dwEventState;
     }
 
     if (dwErrorCode == TPS_ACTION_OK)
     {
         pzDiagEntry = &zDiagEntry;
 
+#ifdef USE_DIAG_INDEX
+        /* Take the entry from the host side copy */
+        pzSubslot = AppDiagIndexFind(dwDiagAddress, &dwEntryIndex);
+        if (pzSubslot == NULL)
+        {
+            dwErrorCode = API_DIAG_CHANGE_WRONG_PARAMETER;
+        }
+        else
+        {
+            dwErrorCode = AppDiagIndexRefreshFlags(pzSubslot, dwEntryIndex);
+            *pzDiagEntry = *DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+            if (TPS_ACTION_OK != dwErrorCode)
+            {
+                dwErrorCode = API_DIAG_CHANGE_WRONG_RESULT;
+            }
+        }
+#else
         /* Read the entry from the TPS-1 diag buffer */
         dwErrorCode = TPS_GetValueData((USIGN8*)dwDiagAddress, (USIGN8*)pzDiagEntry, sizeof(DPR_DIAG_ENTRY));
         if (TPS_ACTION_OK != dwErrorCode)
         {
             dwErrorCode = API_DIAG_CHANGE_WRONG_RESULT;
         }
+#endif
     }
 
     if (dwErrorCode == TPS_ACTION_OK)
@@ -6068,6 +9484,12 @@ USIGN32 TPS_DiagSetChangeState(USIGN32 dwDiagAddress, USIGN8 byNewMaintenanceSta
             {
                 dwErrorCode = API_DIAG_CHANGE_WRONG_RESULT;
             }
+#ifdef USE_DIAG_INDEX
+            else
+            {
+                *DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex) = *pzDiagEntry;
+            }
+#endif
         }
         else
         {
@@ -6081,12 +9503,140 @@ USIGN32 TPS_DiagSetChangeState(USIGN32 dwDiagAddress, USIGN8 byNewMaintenanceSta
 
     if (dwErrorCode == TPS_ACTION_OK)
     {
-        AppSetEventRegApp(APP_EVENT_DIAG_CHANGED);
+        AppDiagChanged(dwDiagAddress, byNewSpecifier);
     }
 
     return dwErrorCode;
 }
 
+#ifdef USE_DIAG_INDEX
+/*!
+ * \brief       This function opens a diagnosis batch. Until TPS_DiagBatchCommit() the functions
+ *              TPS_DiagChannelAdd(), TPS_DiagChannelQualifiedAdd(), TPS_DiagManufactorSpecdAdd(),
+ *              TPS_DiagSetChangeState() and TPS_DiagChannelRemove() write their entries without raising
+ *              APP_EVENT_DIAG_CHANGED, so they do not wait for each other. Up to DIAG_BATCH_SIZE changes
+ *              of any subslots can be done in one batch. An entry added in a batch can be changed or removed
+ *              only after the TPS-1 has acknowledged it, i.e. in a later batch.
+ *
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_DIAG_BATCH_ALREADY_OPEN
+ *              - API_DIAG_BATCH_EVENT_IN_USE : the TPS-1 has not yet processed the previous change, try again later
+ */
+USIGN32 TPS_DiagBatchBegin(VOID)
+{
+    USIGN32 dwErrorCode;
+
+    if (g_bDiagBatchOpen == TPS_TRUE)
+    {
+        return API_DIAG_BATCH_ALREADY_OPEN;
+    }
+
+    /* The entries are written while the batch is open, so the TPS-1 must be
+     * done with the previous change. */
+    dwErrorCode = AppDiagCheckEventFree(API_DIAG_BATCH_EVENT_IN_USE);
+    if (dwErrorCode != TPS_ACTION_OK)
+    {
+        return dwErrorCode;
+    }
+
+    g_wDiagBatchEntries = 0;
+    g_wDiagBatchAlarmsSent = 0;
+    g_bDiagBatchOpen = TPS_TRUE;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function closes the diagnosis batch and signals all its changes to the TPS-1 with
+ *              a single APP_EVENT_DIAG_CHANGED. The alarms of the changes can be sent afterwards by
+ *              TPS_DiagBatchSendAlarms().
+ *
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : success
+ *              - API_DIAG_BATCH_NOT_OPEN
+ */
+USIGN32 TPS_DiagBatchCommit(VOID)
+{
+    if (g_bDiagBatchOpen == TPS_FALSE)
+    {
+        return API_DIAG_BATCH_NOT_OPEN;
+    }
+
+    g_bDiagBatchOpen = TPS_FALSE;
+
+    if (g_wDiagBatchEntries != 0)
+    {
+        AppSetEventRegApp(APP_EVENT_DIAG_CHANGED);
+    }
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function sends the diagnosis alarms of the last committed batch in the order of the changes:
+ *              an appears alarm for each added entry and an alarm of the new specifier for each
+ *              TPS_DiagSetChangeState(). Removed entries have no alarm. Subslots that are not used by the AR
+ *              are skipped. The alarm mailbox takes one alarm until the PLC acknowledges it, so the function
+ *              stops at the first error and continues with that alarm when it is called again.
+ *
+ * \param[in]   dwARNumber AR_0 or AR_1
+ * \param[in]   byAlarmPrio priority of the alarm notifications (should be ALARM_LOW)
+ * \param[in]   wUserHandle handle of the first change of the batch, the following changes use wUserHandle + 1, ...
+ * \retval      possible return values:
+ *              - TPS_ACTION_OK : all alarms are sent
+ *              - API_DIAG_BATCH_STILL_OPEN
+ *              - API_DIAG_PROP_WRONG_PARAMETER
+ *              or any Error from TPS_SendDiagAlarm()
+ */
+USIGN32 TPS_DiagBatchSendAlarms(USIGN32 dwARNumber, USIGN8 byAlarmPrio, USIGN16 wUserHandle)
+{
+    T_DIAG_BATCH_ENTRY* pzChange;
+    SUBSLOT* pzSubslot;
+    USIGN32  dwEntryIndex = 0;
+    USIGN32  dwApiNumber = 0;
+    USIGN16  wSlotNumber = 0;
+    USIGN16  wSubslotNumber = 0;
+    USIGN32  dwErrorCode = TPS_ACTION_OK;
+
+    if (g_bDiagBatchOpen == TPS_TRUE)
+    {
+        return API_DIAG_BATCH_STILL_OPEN;
+    }
+
+    for (; g_wDiagBatchAlarmsSent < g_wDiagBatchEntries; g_wDiagBatchAlarmsSent++)
+    {
+        pzChange = &g_zDiagBatch[g_wDiagBatchAlarmsSent];
+
+        if (pzChange->byAlarmType == DIAG_BATCH_NO_ALARM)
+        {
+            continue;
+        }
+
+        pzSubslot = AppDiagIndexFind(pzChange->dwDiagAddress, &dwEntryIndex);
+        if (pzSubslot == NULL)
+        {
+            return API_DIAG_PROP_WRONG_PARAMETER;
+        }
+
+        dwErrorCode = AppGetSlotInfoFromHandle(pzSubslot, &dwApiNumber, &wSlotNumber, &wSubslotNumber);
+        if (dwErrorCode == TPS_ACTION_OK)
+        {
+            dwErrorCode = TPS_SendDiagAlarm(dwARNumber, dwApiNumber, wSlotNumber, wSubslotNumber, byAlarmPrio,
+                                            pzChange->byAlarmType, pzChange->dwDiagAddress,
+                                            (USIGN16)(wUserHandle + g_wDiagBatchAlarmsSent));
+        }
+
+        if ((dwErrorCode != TPS_ACTION_OK) && (dwErrorCode != API_ALARM_SUBSLOT_NOT_USED_BY_AR))
+        {
+            return dwErrorCode;
+        }
+    }
+
+    return TPS_ACTION_OK;
+}
+#endif /* USE_DIAG_INDEX */
+
 /*!@} Diagnose Diagnosis Interface*/
 
 #endif /* DIAGNOSIS_ENABLE */
@@ -6119,11 +9669,14 @@ USIGN32 TPS_DiagSetChangeState(USIGN32 dwDiagAddress, USIGN8 byNewMaintenanceSta
 USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelProperties, USIGN16 wChannelErrortype, USIGN16 wExtchannelErrortype, USIGN32 dwExtchannelAddval, USIGN32 dwQualifiedChannelQualifier)
 {
     DPR_DIAG_ENTRY zDiagEntry = { 0 };
-    DPR_DIAG_ENTRY* pzDiagEntry = NULL;
     USIGN32 dwErrorCode = TPS_ACTION_OK;
-    USIGN32 dwSize = 0;
     USIGN32 dwDiagEntryIndex  = 0;
-    USIGN32 dwEventRegister   = 0;
+#ifdef USE_DIAG_INDEX
+    USIGN16 wEntry = DIAG_INDEX_END;
+#else
+    DPR_DIAG_ENTRY* pzDiagEntry = NULL;
+    USIGN32 dwSize = 0;
+#endif
 
 #ifdef DEBUG_API_TEST
     printf("TPS_DiagChannelAdd -> Started \n");
@@ -6136,13 +9689,59 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
     }
 
     /* Check if Event is free */
-    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP, &dwEventRegister);
-    if ( (dwEventRegister & (0x01 << APP_EVENT_DIAG_CHANGED)) == (0x01 << APP_EVENT_DIAG_CHANGED) )
+    dwErrorCode = AppDiagCheckEventFree(API_DIAG_ADD_EVENT_IN_USE);
+    if (dwErrorCode != TPS_ACTION_OK)
     {
-         AppSetLastError(API_DIAG_ADD_EVENT_IN_USE);
+         AppSetLastError(dwErrorCode);
          return 0x00;
     }
 
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > search for matching diag entry\n");
+#endif
+
+#ifdef USE_DIAG_INDEX
+    /* The new entry, also the key for the search */
+    zDiagEntry.wChannelNumber = TPS_htons(wChannelNumber);
+    zDiagEntry.wChannelProperties = TPS_htons(wChannelProperties);
+    zDiagEntry.wChannelErrortype = TPS_htons(wChannelErrortype);
+    zDiagEntry.wExtchannelErrortype = TPS_htons(wExtchannelErrortype);
+    zDiagEntry.dwExtchannelAddval = TPS_htonl(dwExtchannelAddval);
+    zDiagEntry.dwQualifiedChannelQualifier = TPS_htonl(dwQualifiedChannelQualifier);
+    zDiagEntry.byFlags = APPEAR_FLAG;
+
+    wEntry = AppDiagIndexFindKey(pzSubslot, &zDiagEntry);
+    if ((wEntry != DIAG_INDEX_END) && (g_zDiagIndexPool[wEntry].zEntry.byFlags == DISAPPEAR_FLAG))
+    {
+        /* A removed entry with the same key is free after the acknowledge
+         * of the TPS-1, only its flags are read. */
+        dwErrorCode = AppDiagIndexRefreshFlags(pzSubslot, wEntry - pzSubslot->zDiagIndex.wFirstEntry);
+        if (dwErrorCode != TPS_ACTION_OK)
+        {
+            AppSetLastError(API_DIAG_ADD_MEM_ACCESS_ERROR);
+            return 0x00;
+        }
+        wEntry = AppDiagIndexFindKey(pzSubslot, &zDiagEntry);
+    }
+
+    if (wEntry != DIAG_INDEX_END)
+    {
+        if (g_zDiagIndexPool[wEntry].zEntry.wChannelProperties == zDiagEntry.wChannelProperties)
+        {
+#ifdef DEBUG_API_TEST
+            printf("DEBUG_API > ERROR: entry already exists..(?) \n");
+#endif
+            AppSetLastError(API_DIAG_ADD_ENTRY_ALREADY_EXISTS);
+            return 0x00;
+        }
+
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > entry exists but differs..\n");
+#endif
+        AppSetLastError(API_DIAG_EXISTS_BUT_DIFFERS);
+        return 0x00;
+    }
+#else
     /* Get the size of the diag buffer */
     dwErrorCode = TPS_GetValue32((USIGN8*)pzSubslot->pt_size_chan_diag, &dwSize);
     if (dwErrorCode != TPS_ACTION_OK)
@@ -6151,10 +9750,6 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
         return 0x00;
     }
 
-#ifdef DEBUG_API_TEST
-    printf("DEBUG_API > search for matching diag entry\n");
-#endif
-
     pzDiagEntry = &zDiagEntry; /*set the diag-pointer to the local diag-buffer*/
 
     /* Analyse each existing entry, one after another */
@@ -6204,6 +9799,7 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
             return NULL;
         }
     }
+#endif
 
 #ifdef DIAGNOSIS_ENABLE
     /* Stack supports a maximum of MAX_NUMBER_DIAG diag entries only */
@@ -6219,6 +9815,47 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
     printf("DEBUG_API > looking for free diag slot..\n");
 #endif
 
+#ifdef USE_DIAG_INDEX
+    if (pzSubslot->zDiagIndex.wFreeList == DIAG_INDEX_END)
+    {
+        /* Take back the removed entries the TPS-1 has acknowledged */
+        dwErrorCode = AppDiagIndexCollect(pzSubslot);
+        if (dwErrorCode != TPS_ACTION_OK)
+        {
+            AppSetLastError(API_DIAG_ADD_MEM_ACCESS_ERROR);
+            return 0x00;
+        }
+    }
+
+    wEntry = pzSubslot->zDiagIndex.wFreeList;
+    if (wEntry != DIAG_INDEX_END)
+    {
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > found free diag slot\nadding...\n");
+#endif
+        dwDiagEntryIndex = wEntry - pzSubslot->zDiagIndex.wFirstEntry;
+
+        /* send the new diag entry to the TPS-1, the index follows on success */
+        dwErrorCode = TPS_SetValueData((USIGN8*)pzSubslot->pt_chan_diag + (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY)), (USIGN8*)&zDiagEntry, sizeof(DPR_DIAG_ENTRY));
+        if (dwErrorCode != TPS_ACTION_OK)
+        {
+            AppSetLastError(API_DIAG_ADD_MEM_ACCESS_ERROR);
+            return 0x00;
+        }
+
+        pzSubslot->zDiagIndex.wFreeList = g_zDiagIndexPool[wEntry].wNext;
+        g_zDiagIndexPool[wEntry].zEntry = zDiagEntry;
+        AppDiagIndexLink(pzSubslot, wEntry);
+
+#ifdef DIAGNOSIS_ENABLE
+        /* increase global counter of diagnosis entries */
+        g_wNumberOfDiagEntries++;
+#endif
+        AppDiagChanged((USIGN32)(pzSubslot->pt_chan_diag + (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY))), APPEARS);
+
+        return (USIGN32)(pzSubslot->pt_chan_diag + (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY)));
+    }
+#else
     /* Analyze each existing entry, one after another */
     for (dwDiagEntryIndex = 0; (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY)) < dwSize; dwDiagEntryIndex++)
     {
@@ -6264,11 +9901,12 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
             /* increase global counter of diagnosis entries */
             g_wNumberOfDiagEntries++;
 #endif 
-            AppSetEventRegApp(APP_EVENT_DIAG_CHANGED);
+            AppDiagChanged((USIGN32)(pzSubslot->pt_chan_diag + (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY))), APPEARS);
 
             return (USIGN32)(pzSubslot->pt_chan_diag + (dwDiagEntryIndex * sizeof(DPR_DIAG_ENTRY)));
         }
     }
+#endif
 
 #ifdef DEBUG_API_TEST
     printf("DEBUG_API > no free diag slot\n");
@@ -6279,21 +9917,439 @@ USIGN32 AppDiagAdd(SUBSLOT* pzSubslot, USIGN16 wChannelNumber, USIGN16 wChannelP
 }
 
 /*!
- * \brief       This function sets an event bit in the application event acknowledge register (high -> 0x24)
- *              to acknowledge an event from the TPS stack.
+ * \brief       This function checks if a diagnosis entry may be changed now. Outside of a batch the TPS-1
+ *              must have processed the previous change (APP_EVENT_DIAG_CHANGED cleared). Within a batch
+ *              the event is not raised, only the number of changes is limited.
  *
- * \param[in]   dwEventBit
+ * \param[in]   dwInUseError error code of the caller for a set event
+ * \retval      TPS_ACTION_OK, dwInUseError or API_DIAG_BATCH_FULL
+*/
+static USIGN32 AppDiagCheckEventFree(USIGN32 dwInUseError)
+{
+    USIGN32 dwEventRegister = 0;
+
+#ifdef USE_DIAG_INDEX
+    if (g_bDiagBatchOpen == TPS_TRUE)
+    {
+        return (g_wDiagBatchEntries < DIAG_BATCH_SIZE) ? TPS_ACTION_OK : API_DIAG_BATCH_FULL;
+    }
+#endif
+
+    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP, &dwEventRegister);
+    if ( (dwEventRegister & (0x01 << APP_EVENT_DIAG_CHANGED)) == (0x01 << APP_EVENT_DIAG_CHANGED) )
+    {
+        return dwInUseError;
+    }
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       This function signals a changed diagnosis entry to the TPS-1. Within a batch the change and
+ *              its alarm type are recorded and the event is raised by TPS_DiagBatchCommit().
+ *
+ * \param[in]   dwDiagAddress address of the changed entry
+ * \param[in]   byAlarmType alarm for TPS_DiagBatchSendAlarms() (APPEARS, DISAPPEARS, ... or DIAG_BATCH_NO_ALARM)
+ * \retval      VOID
+*/
+static VOID AppDiagChanged(USIGN32 dwDiagAddress, USIGN8 byAlarmType)
+{
+#ifdef USE_DIAG_INDEX
+    if (g_bDiagBatchOpen == TPS_TRUE)
+    {
+        /* Space was checked by AppDiagCheckEventFree() */
+        g_zDiagBatch[g_wDiagBatchEntries].dwDiagAddress = dwDiagAddress;
+        g_zDiagBatch[g_wDiagBatchEntries].byAlarmType = byAlarmType;
+        g_wDiagBatchEntries++;
+        return;
+    }
+#endif
+
+    AppSetEventRegApp(APP_EVENT_DIAG_CHANGED);
+}
+
+#ifdef USE_DIAG_INDEX
+/*!
+ * \brief       This function returns the subslot and the index of a diagnosis entry in the host side copy.
+ *              The diagnosis buffers of all subslots are searched in host RAM, no SPI access is done.
+ *
+ * \param[in]   dwDiagAddress address of the diagnosis entry created by TPS_DiagChannelAdd()
+ * \param[out]  pdwEntryIndex index of the entry in the diagnosis buffer of the subslot
+ * \retval      Pointer to the subslot or NULL if the address is not a diagnosis entry.
+*/
+static SUBSLOT* AppDiagIndexFind(USIGN32 dwDiagAddress, USIGN32* pdwEntryIndex)
+{
+    API_LIST* pzApi;
+    SLOT*     pzSlot;
+    SUBSLOT*  pzSubslot;
+    USIGN32   dwOffset;
+
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        for(pzSlot = pzApi->firstslot; pzSlot != NULL; pzSlot = pzSlot->pNextSlot)
+        {
+            for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                dwOffset = dwDiagAddress - (USIGN32)pzSubslot->pt_chan_diag;
+
+                if((dwDiagAddress >= (USIGN32)pzSubslot->pt_chan_diag) &&
+                   (dwOffset < (pzSubslot->zDiagIndex.wNumberOfEntries * sizeof(DPR_DIAG_ENTRY))) &&
+                   ((dwOffset % sizeof(DPR_DIAG_ENTRY)) == 0))
+                {
+                    *pdwEntryIndex = dwOffset / sizeof(DPR_DIAG_ENTRY);
+                    return pzSubslot;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief       This function searches the used diagnosis entry of a subslot with the channel number, error type
+ *              and extended error type of pzKey. Only the key chain of the hash is walked.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   pzKey entry with the key values (network byte order)
+ * \retval      pool index of the entry or DIAG_INDEX_END if the subslot has no such entry
+*/
+static USIGN16 AppDiagIndexFindKey(SUBSLOT* pzSubslot, const DPR_DIAG_ENTRY* pzKey)
+{
+    T_SUBSLOT_DIAG_INDEX* pzIndex = &pzSubslot->zDiagIndex;
+    DPR_DIAG_ENTRY* pzEntry;
+    USIGN16 wEntry;
+
+    for(wEntry = g_wDiagIndexChain[AppDiagIndexHash(pzSubslot, pzKey)]; wEntry != DIAG_INDEX_END;
+        wEntry = g_zDiagIndexPool[wEntry].wNext)
+    {
+        pzEntry = &g_zDiagIndexPool[wEntry].zEntry;
+
+        if((wEntry >= pzIndex->wFirstEntry) &&
+           (wEntry < pzIndex->wFirstEntry + pzIndex->wNumberOfEntries) &&
+           (pzEntry->wChannelNumber == pzKey->wChannelNumber) &&
+           (pzEntry->wChannelErrortype == pzKey->wChannelErrortype) &&
+           (pzEntry->wExtchannelErrortype == pzKey->wExtchannelErrortype))
+        {
+            return wEntry;
+        }
+    }
+
+    return DIAG_INDEX_END;
+}
+
+/*!
+ * \brief       This function returns the key chain of a diagnosis entry: the hash of the subslot,
+ *              the channel number and the error type.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   pzEntry diagnosis entry
+ * \retval      index in g_wDiagIndexChain
+*/
+static USIGN32 AppDiagIndexHash(const SUBSLOT* pzSubslot, const DPR_DIAG_ENTRY* pzEntry)
+{
+    USIGN32 dwHash;
+
+    dwHash = ((USIGN32)pzSubslot->zDiagIndex.wFirstEntry * 31 + pzEntry->wChannelNumber) * 31 + pzEntry->wChannelErrortype;
+    dwHash *= 0x9E3779B1;
+    dwHash ^= dwHash >> 16;
+
+    return dwHash & (DIAG_INDEX_HASH_SIZE - 1);
+}
+
+/*!
+ * \brief       This function clears the diagnosis index of a subslot and puts all its entries
+ *              on the free list. wFirstEntry and wNumberOfEntries must be set, the entries must
+ *              not be linked into a key chain.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \retval      none
+*/
+static VOID AppDiagIndexInit(SUBSLOT* pzSubslot)
+{
+    T_SUBSLOT_DIAG_INDEX* pzIndex = &pzSubslot->zDiagIndex;
+    USIGN16 wEntry;
+
+    pzIndex->wFreeList = DIAG_INDEX_END;
+    pzIndex->wPendingDisappear = 0;
+
+    /* The lowest entries are used first, as without the index */
+    for(wEntry = pzIndex->wFirstEntry + pzIndex->wNumberOfEntries; wEntry > pzIndex->wFirstEntry; wEntry--)
+    {
+        memset(&g_zDiagIndexPool[wEntry - 1].zEntry, 0x00, sizeof(DPR_DIAG_ENTRY));
+        g_zDiagIndexPool[wEntry - 1].wNext = pzIndex->wFreeList;
+        pzIndex->wFreeList = wEntry - 1;
+    }
+}
+
+/*!
+ * \brief       This function links a used diagnosis entry into its key chain.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   wEntry pool index of the entry
+ * \retval      none
+*/
+static VOID AppDiagIndexLink(SUBSLOT* pzSubslot, USIGN16 wEntry)
+{
+    USIGN32 dwChain = AppDiagIndexHash(pzSubslot, &g_zDiagIndexPool[wEntry].zEntry);
+
+    g_zDiagIndexPool[wEntry].wNext = g_wDiagIndexChain[dwChain];
+    g_wDiagIndexChain[dwChain] = wEntry;
+}
+
+/*!
+ * \brief       This function takes a diagnosis entry out of its key chain and puts it on the
+ *              free list of the subslot.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   wEntry pool index of the entry
+ * \retval      none
+*/
+static VOID AppDiagIndexRelease(SUBSLOT* pzSubslot, USIGN16 wEntry)
+{
+    USIGN16* pwLink = &g_wDiagIndexChain[AppDiagIndexHash(pzSubslot, &g_zDiagIndexPool[wEntry].zEntry)];
+
+    while((*pwLink != DIAG_INDEX_END) && (*pwLink != wEntry))
+    {
+        pwLink = &g_zDiagIndexPool[*pwLink].wNext;
+    }
+
+    if(*pwLink == wEntry)
+    {
+        *pwLink = g_zDiagIndexPool[wEntry].wNext;
+    }
+
+    g_zDiagIndexPool[wEntry].wNext = pzSubslot->zDiagIndex.wFreeList;
+    pzSubslot->zDiagIndex.wFreeList = wEntry;
+}
+
+/*!
+ * \brief       This function updates the flags of a diagnosis entry in the host side copy.
+ *              Only the TPS-1 changes the flags of a written entry: APPEAR_FLAG to APPEAR_ACK_FLAG and
+ *              DISAPPEAR_FLAG to DISAPPEAR_ACK_FLAG. So the flags byte is read only while one of these
+ *              acknowledges is outstanding. An acknowledged disappear frees the entry.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[in]   dwEntryIndex index of the entry in the diagnosis buffer of the subslot
+ * \retval      TPS_ACTION_OK or the error of TPS_GetValue8()
+*/
+static USIGN32 AppDiagIndexRefreshFlags(SUBSLOT* pzSubslot, USIGN32 dwEntryIndex)
+{
+    DPR_DIAG_ENTRY* pzDiagEntry = DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+    USIGN8 byFlags = EMPTY_ENTRY;
+    USIGN32 dwErrorCode = TPS_ACTION_OK;
+
+    if((pzDiagEntry->byFlags == APPEAR_FLAG) || (pzDiagEntry->byFlags == DISAPPEAR_FLAG))
+    {
+        dwErrorCode = TPS_GetValue8(pzSubslot->pt_chan_diag + (dwEntryIndex * sizeof(DPR_DIAG_ENTRY)) + DIAG_ENTRY_FLAGS_OFFSET,
+                                    &byFlags);
+        if((dwErrorCode == TPS_ACTION_OK) && (byFlags != pzDiagEntry->byFlags))
+        {
+            if((pzDiagEntry->byFlags == DISAPPEAR_FLAG) &&
+               ((byFlags == DISAPPEAR_ACK_FLAG) || (byFlags == EMPTY_ENTRY)))
+            {
+                pzSubslot->zDiagIndex.wPendingDisappear--;
+                AppDiagIndexRelease(pzSubslot, (USIGN16)(pzSubslot->zDiagIndex.wFirstEntry + dwEntryIndex));
+            }
+            pzDiagEntry->byFlags = byFlags;
+        }
+    }
+
+    return dwErrorCode;
+}
+
+/*!
+ * \brief       This function reads the flags of the removed entries of a subslot that are not yet
+ *              acknowledged and frees the acknowledged ones. Called when the free list is empty.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \retval      TPS_ACTION_OK or the error of TPS_GetValue8()
+*/
+static USIGN32 AppDiagIndexCollect(SUBSLOT* pzSubslot)
+{
+    USIGN32 dwEntryIndex;
+    USIGN32 dwErrorCode = TPS_ACTION_OK;
+
+    for(dwEntryIndex = 0; (dwEntryIndex < pzSubslot->zDiagIndex.wNumberOfEntries) &&
+                          (pzSubslot->zDiagIndex.wPendingDisappear != 0); dwEntryIndex++)
+    {
+        if(DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex)->byFlags == DISAPPEAR_FLAG)
+        {
+            dwErrorCode = AppDiagIndexRefreshFlags(pzSubslot, dwEntryIndex);
+            if(dwErrorCode != TPS_ACTION_OK)
+            {
+                break;
+            }
+        }
+    }
+
+    return dwErrorCode;
+}
+
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+/*!
+ * \brief       This function removes the diagnosis of a pulled subslot: the diagnosis buffer in the
+ *              TPS-1 is cleared and all entries of the index are freed. The change is signalled like
+ *              TPS_DiagChannelRemove(), within an open batch it is one change of the batch (without alarm).
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \retval      TPS_ACTION_OK, API_DIAG_REMOVE_EVENT_IN_USE, API_DIAG_BATCH_FULL (diagnosis kept)
+ *              or the error of TPS_MemSet()
+*/
+static USIGN32 AppDiagIndexClear(SUBSLOT* pzSubslot)
+{
+    T_SUBSLOT_DIAG_INDEX* pzIndex = &pzSubslot->zDiagIndex;
+    DPR_DIAG_ENTRY* pzDiagEntry;
+    USIGN32 dwEntryIndex;
+    USIGN16 wUsed = 0;
+    USIGN16 wAppeared = 0;
+    USIGN32 dwErrorCode = TPS_ACTION_OK;
+
+    for(dwEntryIndex = 0; dwEntryIndex < pzIndex->wNumberOfEntries; dwEntryIndex++)
+    {
+        pzDiagEntry = DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+
+        if((pzDiagEntry->byFlags != EMPTY_ENTRY) && (pzDiagEntry->byFlags != DISAPPEAR_ACK_FLAG))
+        {
+            wUsed++;
+        }
+        if((pzDiagEntry->byFlags == APPEAR_FLAG) || (pzDiagEntry->byFlags == APPEAR_ACK_FLAG))
+        {
+            wAppeared++;
+        }
+    }
+
+    if(wUsed == 0)
+    {
+        return TPS_ACTION_OK;
+    }
+
+    dwErrorCode = AppDiagCheckEventFree(API_DIAG_REMOVE_EVENT_IN_USE);
+    if(dwErrorCode != TPS_ACTION_OK)
+    {
+        return dwErrorCode;
+    }
+
+    dwErrorCode = TPS_MemSet(pzSubslot->pt_chan_diag, EMPTY_ENTRY, (USIGN16)(pzIndex->wNumberOfEntries * sizeof(DPR_DIAG_ENTRY)));
+    if(dwErrorCode != TPS_ACTION_OK)
+    {
+        return dwErrorCode;
+    }
+
+    /* Take the used entries out of their key chains, then free all */
+    for(dwEntryIndex = 0; dwEntryIndex < pzIndex->wNumberOfEntries; dwEntryIndex++)
+    {
+        pzDiagEntry = DIAG_INDEX_ENTRY(pzSubslot, dwEntryIndex);
+
+        if((pzDiagEntry->byFlags != EMPTY_ENTRY) && (pzDiagEntry->byFlags != DISAPPEAR_ACK_FLAG))
+        {
+            AppDiagIndexRelease(pzSubslot, (USIGN16)(pzIndex->wFirstEntry + dwEntryIndex));
+        }
+    }
+    AppDiagIndexInit(pzSubslot);
+
+    g_wNumberOfDiagEntries -= wAppeared;
+    AppDiagChanged((USIGN32)pzSubslot->pt_chan_diag, DIAG_BATCH_NO_ALARM);
+
+    return TPS_ACTION_OK;
+}
+#endif
+#endif /* USE_DIAG_INDEX */
+
+/*!
+ * \brief       This function acknowledges several events from the TPS stack with one
+ *              access to the application event acknowledge register.
+ *
+ * \param[in]   dwEventMask one bit per event (TPS_EVENT_MASK()), 0 does nothing
  * \retval      TPS_ACTION_OK
  */
-USIGN32 AppSetEventRegAppAckn(USIGN32 dwEventBit)
+static USIGN32 AppSetEventRegAppAcknMask(USIGN32 dwEventMask)
 {
     USIGN32 dwReg;
 
-    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP_ACKN, &dwReg);
-    dwReg ^= ((USIGN32)0x00000001 << dwEventBit);
-    TPS_SetValue32((USIGN8*)EVENT_REGISTER_APP_ACKN, dwReg);
+    if (dwEventMask == 0)
+    {
+        return(TPS_ACTION_OK);
+    }
+
+    TPS_GetValue32((USIGN8*)EVENT_REGISTER_APP_ACKN, &dwReg);
+    dwReg ^= dwEventMask;
+    TPS_SetValue32((USIGN8*)EVENT_REGISTER_APP_ACKN, dwReg);
+
+    return(TPS_ACTION_OK);
+}
+
+#ifndef TPS_COUNT_TRAILING_ZEROS
+/*!
+ * \brief       Portable count of the trailing zero bits of a value != 0.
+ *
+ * \param[in]   dwValue value != 0
+ * \retval      index of the lowest set bit
+ */
+static USIGN32 AppCountTrailingZeros(USIGN32 dwValue)
+{
+    static const USIGN8 byDeBruijnBitPos[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return byDeBruijnBitPos[((dwValue & (0 - dwValue)) * 0x077CB531U) >> 27];
+}
+#endif
+
+/*!
+ * \brief       Adapters of the event handlers without parameter to the
+ *              event handler table (g_zEventHandler).
+ *
+ * \param[in]   dwDummy / dwMode parameter of the table entry
+ * \retval      none
+ */
+static VOID AppEventDiagAckn(USIGN32 dwDummy)             { AppOnDiagAckn(); }
+static VOID AppEventSetStationName(USIGN32 dwMode)        { AppOnSetStationName((T_DCP_SET_MODE)dwMode); }
+static VOID AppEventSetStationIpAddr(USIGN32 dwMode)      { AppOnSetStationIpAddr((T_DCP_SET_MODE)dwMode); }
+static VOID AppEventSetStationDcpSignal(USIGN32 dwDummy)  { AppOnSetStationDcpSignal(); }
+static VOID AppEventResetFactorySettings(USIGN32 dwDummy) { AppOnResetFactorySettings(); }
+#ifdef USE_ETHERNET_INTERFACE
+static VOID AppEventEthernetReceive(USIGN32 dwDummy)      { AppOnEthernetReceive(); }
+#endif
+static VOID AppEventTPSMessageReceive(USIGN32 dwDummy)    { AppOnTPSMessageReceive(); }
+static VOID AppEventTPSReset(USIGN32 dwDummy)             { AppOnTPSReset(); }
+static VOID AppEventTPSLedChanged(USIGN32 dwDummy)        { AppOnTPSLedChanged(); }
+static VOID AppEventFSUParameterChange(USIGN32 dwDummy)   { AppOnFSUParameterChange(); }
+
+/*!
+ * \brief       Adapters of the record and alarm handlers. The handling including the
+ *              application callback is measured by the profiling (TPS_PROFILING).
+ *
+ * \param[in]   dwDummy parameter of the table entry
+ * \retval      none
+ */
+static VOID AppEventReadRecord(USIGN32 dwDummy)
+{
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    AppOnReadRecord();
+
+    TPS_PROFILE_LEAVE(TPS_PROFILE_READ_RECORD, dwProfileStart, 0);
+}
+
+static VOID AppEventWriteRecord(USIGN32 dwDummy)
+{
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    AppOnWriteRecord();
+
+    TPS_PROFILE_LEAVE(TPS_PROFILE_WRITE_RECORD, dwProfileStart, 0);
+}
+
+static VOID AppEventAlarmAck(USIGN32 dwDummy)
+{
+    TPS_PROFILE_ENTER(dwProfileStart);
+
+    AppOnAlarmAck();
 
-    return(TPS_ACTION_OK);
+    TPS_PROFILE_LEAVE(TPS_PROFILE_ALARM_ACK, dwProfileStart, 0);
 }
 
 
@@ -6374,6 +10430,12 @@ static VOID AppOnConnect(USIGN32 dwARNumber)
           printf("DEBUG_API > API: Connection request Received.\nCalling CB-Function.\n");
     #endif
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    /* The new AR may change the IO descriptors of its subslots and of the  */
+    /* subslots shared with the other AR.                                   */
+    AppInvalidateSubslotIoCache(SUBSLOT_IO_CACHE_ALL_ARS);
+#endif
+
     if(g_zApiARContext.OnConnect_CB != NULL)
     {
         g_zApiARContext.OnConnect_CB(dwARNumber);
@@ -6424,6 +10486,10 @@ static VOID AppOnConnect_Done(USIGN32 dwARNumber)
 
     AppSetArEstablished(dwARNumber, AR_ESTABLISH);
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    AppFillSubslotIoCache(dwARNumber);
+#endif
+
     if(g_zApiARContext.OnConnectDone_CB != NULL)
     {
         g_zApiARContext.OnConnectDone_CB(dwARNumber);
@@ -6438,6 +10504,16 @@ static VOID AppOnConnect_Done(USIGN32 dwARNumber)
 */
 static VOID AppOnPRMENDDone(USIGN32 dwARNumber)
 {
+#ifdef USE_SUBSLOT_IO_CACHE
+    AppFillSubslotIoCache(dwARNumber);
+#endif
+#ifdef USE_IO_FRAME_IMAGE
+    if(dwARNumber < MAX_NUMBER_IOAR)
+    {
+        AppBuildIoFrameImage((USIGN8)dwARNumber);
+    }
+#endif
+
     if(g_zApiARContext.OnPRMEND_Done_CB != NULL)
     {
         g_zApiARContext.OnPRMEND_Done_CB(dwARNumber);
@@ -6489,6 +10565,14 @@ static VOID AppOnAbort(USIGN32 dwARNumber)
 {
     AppSetArEstablished(dwARNumber, AR_NOT_IN_OPERATION);
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    /* The entries of a remaining AR are read again on their next access.   */
+    AppInvalidateSubslotIoCache(SUBSLOT_IO_CACHE_ALL_ARS);
+#endif
+#ifdef USE_ALARM_QUEUE
+    AppAlarmQueueFlush(dwARNumber);
+#endif
+
     /* Call the registered callback function.                               */
     /*----------------------------------------------------------------------*/
     if(g_zApiARContext.OnAbort_CB != NULL)
@@ -6510,6 +10594,7 @@ static VOID AppOnReadRecord()
     USIGN32 dwARNumber = 0;
     RECORD_BOX_INFO mailBoxInfo = {0};
     USIGN8 byArrMailboxData[SIZE_RECORD_MB0] = {0};
+    USIGN8* pbyResponse = NULL;
     SIGN32 dwDataLength = 0;
     USIGN16 wErrorCode1 = 0;
     USIGN16 wErrorCode2 = 0;
@@ -6524,12 +10609,20 @@ static VOID AppOnReadRecord()
         
         wErrorCode1 = 0;
         wErrorCode2 = 0;
+        dwDataLength = 0;
+        bRecordHandled = TPS_FALSE;
+        pbyResponse = byArrMailboxData;
         /* Get the mailbox flag                                            */
         /*******************************************************************/
         TPS_GetValue8(g_zApiARContext.record_mb[dwARNumber].pt_flags, &byFlagBuff);
 
         if(byFlagBuff == RECORD_FLAG_READ)
         {
+            /* Without the header the request cannot be answered. */
+            if(AppRecordReqHeaderFetch(dwARNumber, byFlagBuff) != TPS_ACTION_OK)
+            {
+                continue;
+            }
             TPS_GetMailboxInfo(dwARNumber, &mailBoxInfo);
 
             #ifdef DEBUG_API_TEST
@@ -6563,6 +10656,13 @@ static VOID AppOnReadRecord()
                     break;
 
                 default:
+#ifdef USE_RECORD_REGISTRY
+                    if (AppRecordRegistryRead(dwARNumber, &mailBoxInfo, byArrMailboxData,
+                                              &pbyResponse, &dwDataLength) == TPS_TRUE)
+                    {
+                        break;
+                    }
+#endif
                     /* Not handled by the driver, route it to the application. */
                     if (g_zApiARContext.OnReadRecord_CB != NULL)
                     {
@@ -6581,8 +10681,16 @@ static VOID AppOnReadRecord()
                     wErrorCode2 = 0x00;
                     dwDataLength = 0;
                 }
+#ifdef USE_RECORD_REGISTRY
+                else if(dwDataLength == RECORD_HANDLER_ACCESS_ERROR)
+                {
+                    wErrorCode1 = 0xA0; /* PNIORW-ErrorClass: Application, ErrorCode: Read Error */
+                    wErrorCode2 = 0x00;
+                    dwDataLength = 0;
+                }
+#endif
 
-                TPS_WriteMailboxData(dwARNumber, byArrMailboxData, dwDataLength);
+                TPS_WriteMailboxData(dwARNumber, pbyResponse, dwDataLength);
                 TPS_RecordReadDone(dwARNumber, wErrorCode1, wErrorCode2);
             }
         }
@@ -6617,6 +10725,16 @@ static VOID AppOnWriteRecord()
 
         if(byFlagBuff == RECORD_FLAG_WRITE)
         {
+            wErrorCode1 = 0x00;
+            wErrorCode2 = 0x00;
+            dwDataLength = 0;
+            bRecordHandled = TPS_FALSE;
+
+            /* Without the header the request cannot be answered. */
+            if(AppRecordReqHeaderFetch(dwIndex, byFlagBuff) != TPS_ACTION_OK)
+            {
+                continue;
+            }
             TPS_GetMailboxInfo(dwIndex, &mailBoxInfo);
             TPS_ReadMailboxData(dwIndex, (USIGN8*) (&byArrMailboxData), mailBoxInfo.dwRecordDataLen);
 
@@ -6651,6 +10769,12 @@ static VOID AppOnWriteRecord()
 #endif
 
                 default:
+#ifdef USE_RECORD_REGISTRY
+                    if(AppRecordRegistryWrite(dwIndex, &mailBoxInfo, byArrMailboxData, &dwDataLength) == TPS_TRUE)
+                    {
+                        break;
+                    }
+#endif
                     if(g_zApiARContext.OnWriteRecord_CB != NULL)
                     {
                         g_zApiARContext.OnWriteRecord_CB(dwIndex);
@@ -6668,6 +10792,14 @@ static VOID AppOnWriteRecord()
                     wErrorCode2 = 0x00;
                     dwDataLength = 0;
                 }
+#ifdef USE_RECORD_REGISTRY
+                else if(dwDataLength == RECORD_HANDLER_ACCESS_ERROR)
+                {
+                    wErrorCode1 = 0xA1; /* PNIORW-ErrorClass: Application, ErrorCode: Write Error */
+                    wErrorCode2 = 0x00;
+                    dwDataLength = 0;
+                }
+#endif
 
                 TPS_RecordWriteDone(dwIndex, wErrorCode1, wErrorCode2);
             }
@@ -6676,6 +10808,263 @@ static VOID AppOnWriteRecord()
 }
 
 
+/*!
+ * \brief       Reads the request header of a record mailbox with one SPI burst and
+ *              keeps it decoded until the request is done. After an error the
+ *              mailbox keeps no header, the next access reads it again.
+ *
+ * \param[in]   dwMailboxNumber number of the record mailbox
+ * \param[in]   byFlag RECORD_FLAG_READ or RECORD_FLAG_WRITE, read from the mailbox
+ * \retval      see TPS_GetValueData()
+*/
+static USIGN32 AppRecordReqHeaderFetch(USIGN32 dwMailboxNumber, USIGN8 byFlag)
+{
+    USIGN8  byHeader[RECORD_REQ_HEADER_LEN];
+    USIGN32 dwReturnCode = TPS_ACTION_OK;
+
+    dwReturnCode = TPS_GetValueData(g_zApiARContext.record_mb[dwMailboxNumber].pt_req_header + RECORD_REQ_BLOCK_OFFSET,
+                                    byHeader, RECORD_REQ_HEADER_LEN);
+    if (dwReturnCode == TPS_ACTION_OK)
+    {
+        TPS_RecordReqHeaderDecode(byHeader, &g_zRecordReqHeader[dwMailboxNumber]);
+        g_byRecordReqFlag[dwMailboxNumber] = byFlag;
+    }
+    else
+    {
+        g_byRecordReqFlag[dwMailboxNumber] = 0;
+    }
+
+    return dwReturnCode;
+}
+
+#ifdef USE_RECORD_REGISTRY
+/*!
+ * \brief       Binary search of a record in the registry.
+ *
+ * \param[in]   dwAPINumber, wSlotNumber, wSubslotNumber, wIndex the record
+ * \param[out]  pwPosition position of the record or where it has to be inserted
+ * \retval      TPS_TRUE if the record is registered
+*/
+static BOOL AppRecordRegistrySearch(USIGN32 dwAPINumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber,
+                                    USIGN16 wIndex, USIGN16* pwPosition)
+{
+    T_RECORD_HANDLER_ENTRY* pzEntry = NULL;
+    USIGN16 wLow = 0;
+    USIGN16 wHigh = g_wRecordRegistryUsed;
+    USIGN16 wMiddle = 0;
+    SIGN32  dwCompare = 0;
+
+    while (wLow < wHigh)
+    {
+        wMiddle = (USIGN16)((wLow + wHigh) / 2);
+        pzEntry = &g_zRecordRegistry[wMiddle];
+
+        if (pzEntry->dwAPINumber != dwAPINumber)
+        {
+            dwCompare = (pzEntry->dwAPINumber < dwAPINumber) ? -1 : 1;
+        }
+        else if (pzEntry->wSlotNumber != wSlotNumber)
+        {
+            dwCompare = (SIGN32)pzEntry->wSlotNumber - (SIGN32)wSlotNumber;
+        }
+        else if (pzEntry->wSubslotNumber != wSubslotNumber)
+        {
+            dwCompare = (SIGN32)pzEntry->wSubslotNumber - (SIGN32)wSubslotNumber;
+        }
+        else
+        {
+            dwCompare = (SIGN32)pzEntry->wIndex - (SIGN32)wIndex;
+        }
+
+        if (dwCompare == 0)
+        {
+            *pwPosition = wMiddle;
+            return TPS_TRUE;
+        }
+
+        if (dwCompare < 0)
+        {
+            wLow = wMiddle + 1;
+        }
+        else
+        {
+            wHigh = wMiddle;
+        }
+    }
+
+    *pwPosition = wLow;
+    return TPS_FALSE;
+}
+
+/*!
+ * \brief       Finds the handler of a record request. A registration of the subslot is used
+ *              before one for all subslots of the slot and one for all slots.
+ *
+ * \param[in]   pzRecord header of the request
+ * \param[in]   byFlag RECORD_FLAG_READ or RECORD_FLAG_WRITE
+ * \retval      the registry entry or NULL
+*/
+static T_RECORD_HANDLER_ENTRY* AppRecordRegistryFind(const RECORD_BOX_INFO* pzRecord, USIGN8 byFlag)
+{
+    T_RECORD_HANDLER_ENTRY* pzEntry = NULL;
+    USIGN16 wSlot[3];
+    USIGN16 wSubslot[3];
+    USIGN16 wPosition = 0;
+    USIGN16 wTry = 0;
+
+    wSlot[0] = pzRecord->wSlotNumber;           wSubslot[0] = pzRecord->wSubSlotNumber;
+    wSlot[1] = pzRecord->wSlotNumber;           wSubslot[1] = RECORD_REGISTRY_ANY;
+    wSlot[2] = RECORD_REGISTRY_ANY;             wSubslot[2] = RECORD_REGISTRY_ANY;
+
+    for (wTry = 0; wTry < 3; wTry++)
+    {
+        if (AppRecordRegistrySearch(pzRecord->dwAPINumber, wSlot[wTry], wSubslot[wTry],
+                                    pzRecord->wIndex, &wPosition) == TPS_TRUE)
+        {
+            pzEntry = &g_zRecordRegistry[wPosition];
+
+            if (((byFlag == RECORD_FLAG_READ) && (pzEntry->pfnRead != NULL)) ||
+                ((byFlag == RECORD_FLAG_WRITE) && (pzEntry->pfnWrite != NULL)))
+            {
+                return pzEntry;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief       Answers a read request with a registered handler. A cached response is used
+ *              directly, otherwise the handler writes the response to pbyBuffer.
+ *
+ * \param[in]   dwMailboxNumber number of the record mailbox
+ * \param[in]   pzRecord header of the request
+ * \param[in]   pbyBuffer buffer of SIZE_RECORD_MB0 bytes for the response of the handler
+ * \param[out]  ppbyResponse the response (pbyBuffer or the cache)
+ * \param[out]  pdwLength length of the response or RECORD_ERROR_INVALID_INDEX / RECORD_HANDLER_ACCESS_ERROR
+ * \retval      TPS_TRUE if the record is registered
+*/
+static BOOL AppRecordRegistryRead(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                  USIGN8* pbyBuffer, USIGN8** ppbyResponse, SIGN32* pdwLength)
+{
+    T_RECORD_HANDLER_ENTRY* pzEntry = AppRecordRegistryFind(pzRecord, RECORD_FLAG_READ);
+    SIGN32 dwLength = 0;
+
+    if (pzEntry == NULL)
+    {
+        return TPS_FALSE;
+    }
+
+    g_zRecordRegistryStatistics.dwReads++;
+
+    if (pzEntry->bCacheValid == TPS_TRUE)
+    {
+        g_zRecordRegistryStatistics.dwCacheHits++;
+        *ppbyResponse = &g_byRecordCache[pzEntry->wCacheOffset];
+        dwLength = pzEntry->wCacheLength;
+    }
+    else
+    {
+        dwLength = pzEntry->pfnRead(dwMailboxNumber, pzRecord, pbyBuffer, SIZE_RECORD_MB0);
+
+        if (dwLength < 0)
+        {
+            *pdwLength = (dwLength == RECORD_HANDLER_INVALID_INDEX) ? RECORD_ERROR_INVALID_INDEX
+                                                                    : RECORD_HANDLER_ACCESS_ERROR;
+            return TPS_TRUE;
+        }
+
+        if (dwLength > SIZE_RECORD_MB0)
+        {
+            dwLength = SIZE_RECORD_MB0;
+        }
+
+        if ((pzEntry->wCacheSize != 0) && (dwLength <= pzEntry->wCacheSize))
+        {
+            memcpy(&g_byRecordCache[pzEntry->wCacheOffset], pbyBuffer, dwLength);
+            pzEntry->wCacheLength = (USIGN16)dwLength;
+            pzEntry->bCacheValid = TPS_TRUE;
+        }
+
+        *ppbyResponse = pbyBuffer;
+    }
+
+    /* The IO controller may request less than the whole record.             */
+    /*-----------------------------------------------------------------------*/
+    if ((USIGN32)dwLength > pzRecord->dwRecordDataLen)
+    {
+        dwLength = (SIGN32)pzRecord->dwRecordDataLen;
+    }
+
+    *pdwLength = dwLength;
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       Passes a write request to a registered handler and discards the cached
+ *              response of the record.
+ *
+ * \param[in]   dwMailboxNumber number of the record mailbox
+ * \param[in]   pzRecord header of the request
+ * \param[in]   pbyData the record data read from the mailbox
+ * \param[out]  pdwResult 0 or RECORD_ERROR_INVALID_INDEX / RECORD_HANDLER_ACCESS_ERROR
+ * \retval      TPS_TRUE if the record is registered
+*/
+static BOOL AppRecordRegistryWrite(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                   USIGN8* pbyData, SIGN32* pdwResult)
+{
+    T_RECORD_HANDLER_ENTRY* pzEntry = AppRecordRegistryFind(pzRecord, RECORD_FLAG_WRITE);
+    SIGN32 dwResult = 0;
+    USIGN16 wPosition = 0;
+
+    if (pzEntry == NULL)
+    {
+        return TPS_FALSE;
+    }
+
+    g_zRecordRegistryStatistics.dwWrites++;
+
+    dwResult = pzEntry->pfnWrite(dwMailboxNumber, pzRecord, pbyData, pzRecord->dwRecordDataLen);
+
+    /* Only a registration of the subslot can have a cached response.        */
+    /*-----------------------------------------------------------------------*/
+    if (AppRecordRegistrySearch(pzRecord->dwAPINumber, pzRecord->wSlotNumber, pzRecord->wSubSlotNumber,
+                                pzRecord->wIndex, &wPosition) == TPS_TRUE)
+    {
+        AppRecordCacheInvalidate(&g_zRecordRegistry[wPosition]);
+    }
+
+    if (dwResult >= 0)
+    {
+        *pdwResult = 0;
+    }
+    else
+    {
+        *pdwResult = (dwResult == RECORD_HANDLER_INVALID_INDEX) ? RECORD_ERROR_INVALID_INDEX
+                                                                : RECORD_HANDLER_ACCESS_ERROR;
+    }
+
+    return TPS_TRUE;
+}
+
+/*!
+ * \brief       Discards the cached read response of a registered record.
+ *
+ * \param[in]   pzEntry the registry entry
+ * \retval      none
+*/
+static VOID AppRecordCacheInvalidate(T_RECORD_HANDLER_ENTRY* pzEntry)
+{
+    if (pzEntry->bCacheValid == TPS_TRUE)
+    {
+        pzEntry->bCacheValid = TPS_FALSE;
+        g_zRecordRegistryStatistics.dwInvalidations++;
+    }
+}
+#endif
+
+
 /*!
  * \brief       Acknowledge of an alarm message sent to the contoller.
  *
@@ -6714,6 +11103,10 @@ static VOID AppOnAlarmAck(VOID)
                      }
 
                      TPS_SetValue8(g_zAlarmMailbox[(dwIndexJ*2) + dwIndexI].pt_flags, UNUSED_FLAG);
+
+#ifdef USE_ALARM_QUEUE
+                     AppAlarmQueueOnAck((USIGN8)((dwIndexJ*2) + dwIndexI));
+#endif
                      break;
 
                 default:
@@ -6724,6 +11117,140 @@ static VOID AppOnAlarmAck(VOID)
 }
 
 
+#ifdef USE_ALARM_QUEUE
+/*!
+ * \brief       Writes a queued alarm to its alarm mailbox.
+ *
+ * \param[in]   byMailboxNr alarm mailbox, gives the AR and the priority
+ * \param[in]   pzEntry the alarm
+ * \retval      see TPS_SendAlarm()
+*/
+static USIGN32 AppAlarmQueueSend(USIGN8 byMailboxNr, T_ALARM_QUEUE_ENTRY* pzEntry)
+{
+    return TPS_SendAlarm(byMailboxNr / 2, pzEntry->dwAPINumber, pzEntry->wSlotNumber, pzEntry->wSubslotNumber,
+                         ((byMailboxNr % 2) != 0) ? ALARM_HIGH : ALARM_LOW, pzEntry->byAlarmType,
+                         pzEntry->wDataLength, pzEntry->byData, pzEntry->wUsi, pzEntry->wUserHandle);
+}
+
+
+/*!
+ * \brief       Counts an alarm written to an alarm mailbox and starts the
+ *              acknowledge latency measurement.
+ *
+ * \param[in]   byMailboxNr alarm mailbox
+ * \retval      none
+*/
+static VOID AppAlarmQueueOnSent(USIGN8 byMailboxNr)
+{
+    g_zAlarmQueueStatistics[byMailboxNr].dwSent++;
+    g_dwAlarmSentPolls[byMailboxNr] = g_dwEventPolls;
+
+#ifdef TPS_PROFILING
+    g_dwAlarmSentCycles[byMailboxNr] = TPS_ProfileGetCycles();
+#endif
+}
+
+
+/*!
+ * \brief       The alarm mailbox was acknowledged and is free again. Sends the
+ *              next queued alarm. Alarms that cannot be sent any more (e.g. the
+ *              subslot was pulled) are discarded and reported to the application.
+ *
+ * \param[in]   byMailboxNr alarm mailbox
+ * \retval      none
+*/
+static VOID AppAlarmQueueOnAck(USIGN8 byMailboxNr)
+{
+    T_ALARM_QUEUE_STATISTICS* pzStatistics = &g_zAlarmQueueStatistics[byMailboxNr];
+    T_ALARM_QUEUE_ENTRY*      pzEntry = NULL;
+    USIGN32 dwReturnValue = TPS_ACTION_OK;
+
+    pzStatistics->dwAcks++;
+
+    pzStatistics->dwLastAckPolls = g_dwEventPolls - g_dwAlarmSentPolls[byMailboxNr];
+    if (pzStatistics->dwLastAckPolls > pzStatistics->dwMaxAckPolls)
+    {
+        pzStatistics->dwMaxAckPolls = pzStatistics->dwLastAckPolls;
+    }
+
+#ifdef TPS_PROFILING
+    pzStatistics->dwLastAckCycles = TPS_ProfileGetCycles() - g_dwAlarmSentCycles[byMailboxNr];
+    pzStatistics->qwTotalAckCycles += pzStatistics->dwLastAckCycles;
+    if (pzStatistics->dwLastAckCycles > pzStatistics->dwMaxAckCycles)
+    {
+        pzStatistics->dwMaxAckCycles = pzStatistics->dwLastAckCycles;
+    }
+#endif
+
+    while (pzStatistics->wDepth > 0)
+    {
+        pzEntry = &g_zAlarmQueue[byMailboxNr][g_byAlarmQueueHead[byMailboxNr]];
+
+        dwReturnValue = AppAlarmQueueSend(byMailboxNr, pzEntry);
+        if (dwReturnValue == API_ALARM_MAILBOX_IN_USE)
+        {
+            break;
+        }
+
+        g_byAlarmQueueHead[byMailboxNr] = (USIGN8)((g_byAlarmQueueHead[byMailboxNr] + 1) % ALARM_QUEUE_DEPTH);
+        pzStatistics->wDepth--;
+
+        if (dwReturnValue == TPS_ACTION_OK)
+        {
+            break;
+        }
+
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > Queued alarm 0x%lx discarded: 0x%lx\n", (unsigned long)pzEntry->wUserHandle, (unsigned long)dwReturnValue);
+#endif
+        pzStatistics->dwDropped++;
+        if (g_zApiARContext.OnAlarm_Ack_CB != NULL)
+        {
+            g_zApiARContext.OnAlarm_Ack_CB(pzEntry->wUserHandle, ALARM_QUEUE_DROPPED);
+        }
+    }
+}
+
+
+/*!
+ * \brief       Discards the queued alarms of an AR (abort of the AR, reset).
+ *              Each alarm is reported to the application with ALARM_QUEUE_DROPPED.
+ *
+ * \param[in]   dwARNumber AR_0 or AR_1
+ * \retval      none
+*/
+static VOID AppAlarmQueueFlush(USIGN32 dwARNumber)
+{
+    T_ALARM_QUEUE_STATISTICS* pzStatistics = NULL;
+    T_ALARM_QUEUE_ENTRY*      pzEntry = NULL;
+    USIGN8 byMailboxNr = 0;
+
+    if (dwARNumber >= MAX_NUMBER_IOAR)
+    {
+        return;
+    }
+
+    for (byMailboxNr = (USIGN8)(dwARNumber * 2); byMailboxNr < (USIGN8)((dwARNumber * 2) + 2); byMailboxNr++)
+    {
+        pzStatistics = &g_zAlarmQueueStatistics[byMailboxNr];
+
+        while (pzStatistics->wDepth > 0)
+        {
+            pzEntry = &g_zAlarmQueue[byMailboxNr][g_byAlarmQueueHead[byMailboxNr]];
+            g_byAlarmQueueHead[byMailboxNr] = (USIGN8)((g_byAlarmQueueHead[byMailboxNr] + 1) % ALARM_QUEUE_DEPTH);
+            pzStatistics->wDepth--;
+            pzStatistics->dwDropped++;
+
+            if (g_zApiARContext.OnAlarm_Ack_CB != NULL)
+            {
+                g_zApiARContext.OnAlarm_Ack_CB(pzEntry->wUserHandle, ALARM_QUEUE_DROPPED);
+            }
+        }
+    }
+}
+#endif
+
+
 /*!
  * \brief       Acknowledge of an diag message send to the contoller.
  *
@@ -6785,6 +11312,20 @@ static VOID AppOnTPSReset( VOID )
     printf("APP: TPS_EVENT_RESET was received\n");
 #endif
 
+#ifdef USE_SUBSLOT_IO_CACHE
+    AppInvalidateSubslotIoCache(SUBSLOT_IO_CACHE_ALL_ARS);
+#endif
+#ifdef USE_ALARM_QUEUE
+    AppAlarmQueueFlush(AR_0);
+    AppAlarmQueueFlush(AR_1);
+#endif
+#ifdef USE_ETHERNET_RX_FILTER
+    g_bEthRxOwnMacValid = TPS_FALSE;
+#endif
+#ifdef USE_ETHERNET_TX_QUEUE
+    AppEthTxQueueFlush();
+#endif
+
     if(g_zApiARContext.OnReset_CB != NULL)
     {
         g_zApiARContext.OnReset_CB(0);
@@ -6889,7 +11430,7 @@ static VOID AppOnResetFactorySettings(VOID)
 */
 VOID TPS_ResetToFactory_Done(VOID)
 {
-   AppSetEventRegAppAckn(TPS_EVENT_ONDCP_RESET_TO_FACTORY);
+   AppSetEventRegAppAcknMask(TPS_EVENT_MASK(TPS_EVENT_ONDCP_RESET_TO_FACTORY));
 }
 #endif
 /*!
@@ -6954,9 +11495,9 @@ static USIGN32 AppGetSlotInfoFromHandle(SUBSLOT* poSubslot,
     /* Read API. */
     *pdwApiNumber = poSubslot->pzSlot->poApi->index;
     /* Read Slotnumber. */
-    TPS_GetValue16((USIGN8*)poSubslot->pzSlot->pt_slot_number, pwSlotNumber);
+    *pwSlotNumber = AppGetSlotNumber(poSubslot->pzSlot);
     /* Read Subslotnumber. */
-    TPS_GetValue16((USIGN8*)poSubslot->pt_subslot_number, pwSubslotNumber);
+    *pwSubslotNumber = AppGetSubslotNumber(poSubslot);
 
     return TPS_ACTION_OK;
 }
@@ -6972,6 +11513,27 @@ static USIGN32 AppGetSlotInfoFromHandle(SUBSLOT* poSubslot,
 static SLOT* AppGetSlotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber)
 {
     API_LIST *pzApi = NULL;
+#ifdef USE_HANDLE_INDEX
+    T_HANDLE_INDEX_ENTRY* pzEntry = NULL;
+    USIGN32  dwErrorCode = GET_HANDLE_API_NOT_FOUND;
+
+    pzEntry = AppHandleIndexFind(dwApiNumber, wSlotNumber, 0, TPS_FALSE);
+    if(pzEntry->pzSlot != NULL)
+    {
+        AppSetLastError(TPS_ACTION_OK);
+        return pzEntry->pzSlot;
+    }
+
+    /* Error code: slot or API not found.                                   */
+    /*----------------------------------------------------------------------*/
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        if(pzApi->index == dwApiNumber)
+        {
+            dwErrorCode = GET_HANDLE_SLOT_NOT_FOUND;
+        }
+    }
+#else
     SLOT     *pzSlot = NULL;
     USIGN32  dwErrorCode = GET_HANDLE_SLOT_NOT_FOUND;
     USIGN16  wReturnValue = 0;
@@ -7003,6 +11565,7 @@ static SLOT* AppGetSlotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber)
             dwErrorCode = GET_HANDLE_API_NOT_FOUND;
         }
     } /* End of first for-loop: Iterate over API. */
+#endif
 
     AppSetLastError(dwErrorCode);
 
@@ -7026,6 +11589,19 @@ static SLOT* AppGetSlotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber)
 */
 static SUBSLOT* AppGetSubslotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber, USIGN16 wSubslotNumber)
 {
+#ifdef USE_HANDLE_INDEX
+    T_HANDLE_INDEX_ENTRY* pzEntry = NULL;
+
+    pzEntry = AppHandleIndexFind(dwApiNumber, wSlotNumber, wSubslotNumber, TPS_TRUE);
+    if(pzEntry->pzSlot != NULL)
+    {
+        AppSetLastError(TPS_ACTION_OK);
+        return pzEntry->pzSubslot;
+    }
+
+    AppSetLastError(GET_HANDLE_SUBSLOT_NOT_FOUND);
+    return NULL;
+#else
     SLOT     *pzSlot = NULL;
     SUBSLOT  *pzSubslot = NULL;
     USIGN32  dwErrorCode = GET_HANDLE_SUBSLOT_NOT_FOUND;
@@ -7057,8 +11633,117 @@ static SUBSLOT* AppGetSubslotHandle(USIGN32 dwApiNumber, USIGN16 wSlotNumber, US
     }
 
     return pzSubslot;
+#endif
+}
+
+/*!
+ * \brief       This function returns the number of a slot.
+ *
+ * \param[in]   pzSlot slot handle
+ * \retval      slot number
+*/
+static USIGN16 AppGetSlotNumber(SLOT* pzSlot)
+{
+#ifdef USE_HANDLE_INDEX
+    return pzSlot->wSlotNumber;
+#else
+    USIGN16 wSlotNumber = 0;
+
+    TPS_GetValue16((USIGN8*)pzSlot->pt_slot_number, &wSlotNumber);
+
+    return wSlotNumber;
+#endif
+}
+
+/*!
+ * \brief       This function returns the number of a subslot.
+ *
+ * \param[in]   pzSubslot subslot handle
+ * \retval      subslot number
+*/
+static USIGN16 AppGetSubslotNumber(SUBSLOT* pzSubslot)
+{
+#ifdef USE_HANDLE_INDEX
+    return pzSubslot->wSubslotNumber;
+#else
+    USIGN16 wSubslotNumber = 0;
+
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_subslot_number, &wSubslotNumber);
+
+    return wSubslotNumber;
+#endif
+}
+
+#ifdef USE_HANDLE_INDEX
+/*!
+ * \brief       This function searches the handle index. The search starts at the hash of
+ *              the numbers and ends at the matching or at the first free entry. The index
+ *              has at least twice as many entries as handles, so a free entry exists.
+ *
+ * \param[in]   dwApi           API number
+ * \param[in]   wSlotNumber     slot number
+ * \param[in]   wSubslotNumber  subslot number, ignored for a slot
+ * \param[in]   bSubslot        TPS_TRUE: entry of a subslot, TPS_FALSE: entry of a slot
+ * \retval      matching entry or free entry (pzSlot NULL)
+*/
+static T_HANDLE_INDEX_ENTRY* AppHandleIndexFind(USIGN32 dwApi, USIGN16 wSlotNumber, USIGN16 wSubslotNumber, BOOL bSubslot)
+{
+    T_HANDLE_INDEX_ENTRY* pzEntry = NULL;
+    USIGN32 dwHash = 0;
+
+    if(bSubslot == TPS_FALSE)
+    {
+        wSubslotNumber = 0;
+    }
+
+    dwHash = (dwApi * 31 + wSlotNumber) * 31 + wSubslotNumber + bSubslot;
+    dwHash *= 0x9E3779B1;
+    dwHash ^= dwHash >> 16;
+
+    for(;;)
+    {
+        pzEntry = &g_zHandleIndex[dwHash & (HANDLE_INDEX_SIZE - 1)];
+
+        if(pzEntry->pzSlot == NULL)
+        {
+            return pzEntry;
+        }
+
+        if((pzEntry->dwApi == dwApi) &&
+           (pzEntry->wSlotNumber == wSlotNumber) &&
+           (pzEntry->wSubslotNumber == wSubslotNumber) &&
+           ((pzEntry->pzSubslot != NULL) == (bSubslot == TPS_TRUE)))
+        {
+            return pzEntry;
+        }
+
+        dwHash++;
+    }
 }
 
+/*!
+ * \brief       This function adds a slot or subslot handle to the handle index.
+ *
+ * \param[in]   pzSlot          slot handle with poApi and wSlotNumber set
+ * \param[in]   pzSubslot       subslot handle or NULL for the slot
+ * \param[in]   wSubslotNumber  subslot number
+ * \retval      none
+*/
+static VOID AppHandleIndexAdd(SLOT* pzSlot, SUBSLOT* pzSubslot, USIGN16 wSubslotNumber)
+{
+    T_HANDLE_INDEX_ENTRY* pzEntry = NULL;
+
+    pzEntry = AppHandleIndexFind(pzSlot->poApi->index, pzSlot->wSlotNumber, wSubslotNumber,
+                                 (pzSubslot != NULL) ? TPS_TRUE : TPS_FALSE);
+
+    pzEntry->pzSlot         = pzSlot;
+    pzEntry->pzSubslot      = pzSubslot;
+    pzEntry->dwApi          = pzSlot->poApi->index;
+    pzEntry->wSlotNumber    = pzSlot->wSlotNumber;
+    pzEntry->wSubslotNumber = (pzSubslot != NULL) ? wSubslotNumber : 0;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* APPLICATION EVENTS                                                        */
 /*---------------------------------------------------------------------------*/
@@ -7936,6 +12621,13 @@ USIGN32 AppPullSubModule(SUBSLOT* pzSubslot, USIGN8 bySubmoduleIOXS)
             /* Mark Module as pulled. */
             wSubslotProperties = (wSubslotProperties & ~SUBMODULE_PROPERTIES_MASK) | SUBMODULE_PULLED;
             TPS_SetValue16((USIGN8*)pzSubslot->pt_properties, wSubslotProperties);
+#ifdef USE_SUBSLOT_IO_CACHE
+            pzSubslot->zIoCache.bValid = TPS_FALSE;
+#endif
+#ifdef USE_DIAG_INDEX
+            /* The diagnosis of the submodule is gone with it. */
+            AppDiagIndexClear(pzSubslot);
+#endif
         }
         else
         {
@@ -7974,6 +12666,9 @@ USIGN32 AppRePlugSubmodule(SUBSLOT *pzSubslot)
             /* Mark the Module 'Replugged'.                                   */
             wSubslotProperties = (wSubslotProperties & ~SUBMODULE_PROPERTIES_MASK) | SUBMODULE_REPLUGGED;
             TPS_SetValue16((USIGN8*)pzSubslot->pt_properties, wSubslotProperties);
+#ifdef USE_SUBSLOT_IO_CACHE
+            pzSubslot->zIoCache.bValid = TPS_FALSE;
+#endif
 
             /* Set the Module State MODULE_OK. Can be overwritten in PrmEnd. */
             TPS_SetSubmoduleState(pzSubslot, MODULE_OK, 0x00);
@@ -8017,6 +12712,9 @@ USIGN32 AppReactivateSubmodule(SUBSLOT *pzSubslot)
         {
             wSubslotProperties = (wSubslotProperties & ~SUBMODULE_PROPERTIES_MASK) | SUBMODULE_NOT_PULLED;
             TPS_SetValue16((USIGN8*)pzSubslot->pt_properties, wSubslotProperties);
+#ifdef USE_SUBSLOT_IO_CACHE
+            pzSubslot->zIoCache.bValid = TPS_FALSE;
+#endif
         }
         else
         {
@@ -8048,6 +12746,354 @@ USIGN32 App_GetAPDUOffsetForAR(USIGN8 byArNr)
    return 0;
 }
 
+/*!
+ * \brief       Writes a buffer change request into the request register of the TPS-1.
+ *
+ * \param[in]   byARNumber AR_0 or AR_1
+ * \param[in]   byCrType INPUT_USED or OUTPUT_USED
+ * \param[in]   dwRegValue value of the request register
+ * \retval      TPS_ACTION_OK or API_BUFFER_CHANGE_BUSY
+*/
+static USIGN32 AppStartBufferChange(USIGN8 byARNumber, USIGN8 byCrType, USIGN32 dwRegValue)
+{
+    if (g_byBufferChangeState == BUFFER_CHANGE_PENDING)
+    {
+        return API_BUFFER_CHANGE_BUSY;
+    }
+
+    g_byBufferChangeAr       = byARNumber;
+    g_byBufferChangeCrType   = byCrType;
+    g_dwBufferChangeRegValue = dwRegValue;
+    g_dwBufferChangePolls    = 0;
+    g_byBufferChangeState    = BUFFER_CHANGE_PENDING;
+
+    /* Initiate the buffer change!                                          */
+    /*----------------------------------------------------------------------*/
+    TPS_SetValue32((USIGN8*)BASE_ADDRESS_DPRAM, dwRegValue);
+
+    return TPS_ACTION_OK;
+}
+
+#ifdef USE_SUBSLOT_IO_CACHE
+/*!
+ * \brief       Reads the complete IO descriptor of a subslot out of the DPRAM.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \param[out]  pzCache the cache entry to fill
+ * \retval      none
+*/
+static VOID AppReadSubslotIoDescriptor(SUBSLOT* pzSubslot, T_SUBSLOT_IO_CACHE* pzCache)
+{
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &pzCache->wUsedInCr);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_properties, &pzCache->wProperties);
+    TPS_GetValue8((USIGN8*)pzSubslot->pt_operational_state, &pzCache->byOperationalState);
+
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_size_input_data, &pzCache->wSizeInputData);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_offset_input_data, &pzCache->wOffsetInputData);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_offset_input_iops, &pzCache->wOffsetInputIops);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_offset_input_iocs, &pzCache->wOffsetInputIocs);
+    TPS_GetIOAddress((USIGN8*)pzSubslot->pt_input_data, &pzCache->pbyInputMemory);
+
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_size_output_data, &pzCache->wSizeOutputData);
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_offset_output_data, &pzCache->wOffsetOutputData);
+    TPS_GetIOAddress((USIGN8*)pzSubslot->pt_output_data, &pzCache->pbyOutputMemory);
+}
+
+/*!
+ * \brief       Returns the IO descriptor cache entry of a subslot. An invalid entry is
+ *              refreshed from the DPRAM. Only subslots used in a CR are marked valid,
+ *              otherwise only wUsedInCr of the returned entry is up to date.
+ *
+ * \param[in]   pzSubslot handle to the subslot structure
+ * \retval      pointer to the cache entry of the subslot
+*/
+static T_SUBSLOT_IO_CACHE* AppGetSubslotIoCache(SUBSLOT* pzSubslot)
+{
+    T_SUBSLOT_IO_CACHE* pzCache = &pzSubslot->zIoCache;
+
+    if(pzCache->bValid == TPS_TRUE)
+    {
+        return pzCache;
+    }
+
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_used_in_cr, &pzCache->wUsedInCr);
+
+    if((pzCache->wUsedInCr & INPUT_OUTPUT_USED) != SUBSLOT_NOT_USED)
+    {
+        AppReadSubslotIoDescriptor(pzSubslot, pzCache);
+        pzCache->bValid = TPS_TRUE;
+    }
+
+    return pzCache;
+}
+
+/*!
+ * \brief       Fills the IO descriptor cache of all subslots after an AR has been
+ *              established. Subslots that are already valid are not read again.
+ *
+ * \param[in]   dwARNumber (AR_0, AR_1, AR_IOSR - number of application relation
+ * \retval      none
+*/
+static VOID AppFillSubslotIoCache(USIGN32 dwARNumber)
+{
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        for(pzSlot = pzApi->firstslot; pzSlot != NULL; pzSlot = pzSlot->pNextSlot)
+        {
+            for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                AppGetSubslotIoCache(pzSubslot);
+            }
+        }
+    }
+
+#ifdef DEBUG_API_TEST
+    printf("DEBUG_API > API: IO descriptor cache filled for AR %lu\n", (unsigned long)dwARNumber);
+#endif
+}
+
+/*!
+ * \brief       Invalidates the IO descriptor cache of all subslots used by an AR.
+ *              Entries without an AR assignment are invalidated as well.
+ *
+ * \param[in]   dwARNumber AR_0, AR_1, AR_IOSR or SUBSLOT_IO_CACHE_ALL_ARS
+ * \retval      none
+*/
+static VOID AppInvalidateSubslotIoCache(USIGN32 dwARNumber)
+{
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+    USIGN16   wArMask = USED_IN_ANY_AR;
+
+    if(dwARNumber != SUBSLOT_IO_CACHE_ALL_ARS)
+    {
+        wArMask = SUBSLOT_FOR_AR(dwARNumber);
+    }
+
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        for(pzSlot = pzApi->firstslot; pzSlot != NULL; pzSlot = pzSlot->pNextSlot)
+        {
+            for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                if((dwARNumber == SUBSLOT_IO_CACHE_ALL_ARS) ||
+                   ((pzSubslot->zIoCache.wUsedInCr & wArMask) != 0) ||
+                   ((pzSubslot->zIoCache.wUsedInCr & USED_IN_ANY_AR) == 0))
+                {
+                    pzSubslot->zIoCache.bValid = TPS_FALSE;
+                }
+            }
+        }
+    }
+
+#ifdef USE_IO_FRAME_IMAGE
+    /* The frame layout is built out of the cache entries.                  */
+    if (dwARNumber == SUBSLOT_IO_CACHE_ALL_ARS)
+    {
+        g_zIoFrameImage[AR_0].bValid = TPS_FALSE;
+        g_zIoFrameImage[AR_1].bValid = TPS_FALSE;
+    }
+    else if (dwARNumber < MAX_NUMBER_IOAR)
+    {
+        g_zIoFrameImage[dwARNumber].bValid = TPS_FALSE;
+    }
+#endif
+}
+#endif
+
+#ifdef USE_IO_FRAME_IMAGE
+/*!
+ * \brief       Calculates the layout of the IO frame images of an AR out of the subslot IO cache
+ *              and reads the current content of the subslot elements (input data, IOPS and IOCS)
+ *              out of the input buffer into the input image. Bytes between the elements are
+ *              zero, TPS_WriteInputFrame() does not copy stale buffer content back.
+ *
+ * \param[in]   byARNumber AR_0 or AR_1
+ * \retval      TPS_ACTION_OK or API_IODATA_FRAME_IMAGE_LAYOUT if the frame buffers of the
+ *              subslots differ or the frame is longer than IO_FRAME_IMAGE_SIZE
+*/
+static USIGN32 AppBuildIoFrameImage(USIGN8 byARNumber)
+{
+    T_IO_FRAME_IMAGE*   pzImage = &g_zIoFrameImage[byARNumber];
+    T_SUBSLOT_IO_CACHE* pzCache = NULL;
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+    USIGN32   dwInputEnd = 0;
+    USIGN32   dwOutputEnd = 0;
+
+    pzImage->bValid = TPS_FALSE;
+    pzImage->pbyInputMemory = NULL;
+    pzImage->pbyOutputMemory = NULL;
+    pzImage->wInputLength = 0;
+    pzImage->wOutputLength = 0;
+
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        for(pzSlot = pzApi->firstslot; pzSlot != NULL; pzSlot = pzSlot->pNextSlot)
+        {
+            for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                pzCache = AppGetSubslotIoCache(pzSubslot);
+
+                if((pzCache->bValid != TPS_TRUE) ||
+                   ((pzCache->wUsedInCr & SUBSLOT_FOR_AR(byARNumber)) == 0))
+                {
+                    continue;
+                }
+
+                /* All subslots of an AR have to use the same frame buffers. */
+                if(pzImage->pbyInputMemory == NULL)
+                {
+                    pzImage->pbyInputMemory = pzCache->pbyInputMemory;
+                }
+                if(pzCache->pbyInputMemory != pzImage->pbyInputMemory)
+                {
+                    return API_IODATA_FRAME_IMAGE_LAYOUT;
+                }
+
+                if((pzCache->wUsedInCr & INPUT_USED) != SUBSLOT_NOT_USED)
+                {
+                    /* input data followed by the IOPS */
+                    if((USIGN32)pzCache->wOffsetInputIops + 1 > dwInputEnd)
+                    {
+                        dwInputEnd = (USIGN32)pzCache->wOffsetInputIops + 1;
+                    }
+                }
+
+                if((pzCache->wUsedInCr & OUTPUT_USED) != SUBSLOT_NOT_USED)
+                {
+                    /* IOCS of the output data is sent in the input frame */
+                    if((USIGN32)pzCache->wOffsetInputIocs + 1 > dwInputEnd)
+                    {
+                        dwInputEnd = (USIGN32)pzCache->wOffsetInputIocs + 1;
+                    }
+
+                    if(pzImage->pbyOutputMemory == NULL)
+                    {
+                        pzImage->pbyOutputMemory = pzCache->pbyOutputMemory;
+                    }
+                    if(pzCache->pbyOutputMemory != pzImage->pbyOutputMemory)
+                    {
+                        return API_IODATA_FRAME_IMAGE_LAYOUT;
+                    }
+
+                    /* output data followed by the IOPS */
+                    if((USIGN32)pzCache->wOffsetOutputData + pzCache->wSizeOutputData + 1 > dwOutputEnd)
+                    {
+                        dwOutputEnd = (USIGN32)pzCache->wOffsetOutputData + pzCache->wSizeOutputData + 1;
+                    }
+                }
+            }
+        }
+    }
+
+    if((dwInputEnd > IO_FRAME_IMAGE_SIZE) || (dwOutputEnd > IO_FRAME_IMAGE_SIZE))
+    {
+#ifdef DEBUG_API_TEST
+        printf("DEBUG_API > API: IO frame of AR %lu too long for the frame image (in: %lu, out: %lu)\n",
+            (unsigned long)byARNumber, (unsigned long)dwInputEnd, (unsigned long)dwOutputEnd);
+#endif
+        return API_IODATA_FRAME_IMAGE_LAYOUT;
+    }
+
+    pzImage->wInputLength = (USIGN16)dwInputEnd;
+    pzImage->wOutputLength = (USIGN16)dwOutputEnd;
+
+    /* Start with the current content of the subslot elements, data that    */
+    /* were written directly into the input buffer are kept.                */
+    memset(pzImage->byInput, 0x00, IO_FRAME_IMAGE_SIZE);
+
+    for(pzApi = g_zApiARContext.api_list; pzApi != NULL; pzApi = pzApi->next)
+    {
+        for(pzSlot = pzApi->firstslot; pzSlot != NULL; pzSlot = pzSlot->pNextSlot)
+        {
+            for(pzSubslot = pzSlot->pSubslot; pzSubslot != NULL; pzSubslot = pzSubslot->poNextSubslot)
+            {
+                pzCache = &pzSubslot->zIoCache;
+
+                if((pzCache->bValid != TPS_TRUE) ||
+                   ((pzCache->wUsedInCr & SUBSLOT_FOR_AR(byARNumber)) == 0))
+                {
+                    continue;
+                }
+
+                if((pzCache->wUsedInCr & INPUT_USED) != SUBSLOT_NOT_USED)
+                {
+                    if(pzCache->wSizeInputData > 0)
+                    {
+                        TPS_GetValueData(pzImage->pbyInputMemory + pzCache->wOffsetInputData,
+                                         &pzImage->byInput[pzCache->wOffsetInputData], pzCache->wSizeInputData);
+                    }
+                    TPS_GetValue8(pzImage->pbyInputMemory + pzCache->wOffsetInputIops,
+                                  &pzImage->byInput[pzCache->wOffsetInputIops]);
+                }
+
+                if((pzCache->wUsedInCr & OUTPUT_USED) != SUBSLOT_NOT_USED)
+                {
+                    TPS_GetValue8(pzImage->pbyInputMemory + pzCache->wOffsetInputIocs,
+                                  &pzImage->byInput[pzCache->wOffsetInputIocs]);
+                }
+            }
+        }
+    }
+
+    pzImage->bValid = TPS_TRUE;
+
+    return TPS_ACTION_OK;
+}
+
+/*!
+ * \brief       Returns the address of a subslot IO element inside a frame image.
+ *
+ * \param[in]   pzCache cache entry of the subslot
+ * \param[in]   pbyIOMemory frame buffer of the element (input or output buffer in the IO RAM)
+ * \param[in]   wOffset offset of the element in the frame buffer
+ * \param[in]   wLength length of the element
+ * \retval      address in the frame image or NULL if the element is not covered by a valid image
+*/
+static USIGN8* AppGetIoFrameImageAddress(T_SUBSLOT_IO_CACHE* pzCache, USIGN8* pbyIOMemory, USIGN16 wOffset, USIGN16 wLength)
+{
+    T_IO_FRAME_IMAGE* pzImage = NULL;
+    USIGN8 byArNr = 0;
+
+    if(pzCache->bValid != TPS_TRUE)
+    {
+        return NULL;
+    }
+
+    for(byArNr = 0; byArNr < MAX_NUMBER_IOAR; byArNr++)
+    {
+        pzImage = &g_zIoFrameImage[byArNr];
+
+        if((pzImage->bValid != TPS_TRUE) ||
+           ((pzCache->wUsedInCr & SUBSLOT_FOR_AR(byArNr)) == 0))
+        {
+            continue;
+        }
+
+        if((pbyIOMemory == pzImage->pbyInputMemory) &&
+           ((USIGN32)wOffset + wLength <= pzImage->wInputLength))
+        {
+            return &pzImage->byInput[wOffset];
+        }
+
+        if((pbyIOMemory == pzImage->pbyOutputMemory) &&
+           ((USIGN32)wOffset + wLength <= pzImage->wOutputLength))
+        {
+            return &pzImage->byOutput[wOffset];
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 #ifdef USE_FS_APP
 /*!
  * \brief       This function returns the startup mode
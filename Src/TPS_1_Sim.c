@@ -0,0 +1,909 @@
+/*
++-----------------------------------------------------------------------------+
+| ****************************** TPS_1_Sim.c *******************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Host model of the TPS-1 DPRAM behind SPI1_Master.c.                         |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_1_Sim.c
+ *  \brief host model of the TPS-1 DPRAM behind SPI1_Master.c
+ *
+ *  With TPS_HOST_SIMULATION the driver runs on a PC. SPI1_Master.c passes
+ *  every SPI byte to TPS_SimSpiByte(), which decodes the commands and reads
+ *  or writes a byte array in place of the DPRAM. With SPI_DMA_TRANSFER the
+ *  DMA transfers go through the DMA model TPS_SimDmaTransfer(). The model reacts to the
+ *  event registers, the IO buffer change handshake and the record and alarm
+ *  mailboxes like the TPS-1 firmware, and counts the SPI commands and bytes.
+ *  A replay (T_TPS_SIM_STEP) raises the events of a PLC, e.g. connect,
+ *  PrmEnd and record requests, always in the same order.
+ *
+ *  The model is not part of the IAR/Keil projects. Build on the PC with:
+ *
+ *  gcc -m32 -DTPS_HOST_SIMULATION -IInc -o tps_sim Src/TPS_1_API.c
+ *      Src/TPSDriver.c Src/AssetMgm.c Src/SPI1_Master.c Src/TPS_Profile.c
+ *      Src/TPS_Benchmark.c Src/TPS_1_Sim.c Src/TPS_1_SimMain.c
+ *
+ *  The DPRAM addresses are handled as pointers by the driver and some DPRAM
+ *  structures contain pointers, so -m32 gives the layout of the target.
+ */
+
+/*===========================================================================*/
+/* Includes                                                                  */
+/*===========================================================================*/
+#include <TPS_1_API.h>
+#include <TPS_1_Sim.h>
+#include <stddef.h>
+
+#ifdef TPS_HOST_SIMULATION
+
+#define SIM_BUFFER_CHANGE_BIT      (1 << 5)
+#define SIM_NUMBER_ALARM_MB        (MAX_NUMBER_IOAR * 2)
+
+/* The DPRAM and the state of the model                                      */
+/*---------------------------------------------------------------------------*/
+static USIGN8  g_bySimDpram[TPS_SIM_DPRAM_SIZE];
+
+static T_TPS_SIM_COUNTERS g_zSimCounters;
+static USIGN32 g_dwSimCycles = 0;
+
+static USIGN32 g_dwSimRecordMailbox[TPS_SIM_NUMBER_RECORD_MB];
+static USIGN32 g_dwSimAlarmMailbox[SIM_NUMBER_ALARM_MB];
+
+/* SPI slave: the command being received and its data                      */
+/*---------------------------------------------------------------------------*/
+static USIGN8  g_bySimCommand[CMD_MEM_LEN];
+static USIGN32 g_dwSimCommandPos = 0;
+static USIGN32 g_dwSimHeaderLength = 0;
+static USIGN32 g_dwSimDataLength = 0;
+static USIGN8  g_bySimData[MAX_LEN_ETHERNET_FRAME];
+
+static USIGN8* g_pbySimTrace = NULL;
+static USIGN32 g_dwSimTraceSize = 0;
+static USIGN32 g_dwSimTraceLength = 0;
+
+static USIGN32 g_dwSimBufferChangeRequest = 0;
+static USIGN32 g_dwSimBufferChangeReads = 0;
+static USIGN32 g_dwSimBufferChangeLatency = TPS_SIM_BUFFER_CHANGE_LATENCY;
+
+/* Delayed start of the stack and confirmation of the configuration, see    */
+/* TPS_SimSetStartupTimes(). A due time of 0 is not pending.                 */
+/*---------------------------------------------------------------------------*/
+static USIGN32 g_dwSimStackUpCycles = 0;
+static USIGN32 g_dwSimStartAckMs = 0;
+static USIGN32 g_dwSimStartAckCycles = 0;
+
+/* Replay                                                                    */
+/*---------------------------------------------------------------------------*/
+static const T_TPS_SIM_STEP* g_pzSimSteps = NULL;
+static USIGN32 g_dwSimNumberOfSteps = 0;
+static USIGN32 g_dwSimStep = 0;
+static USIGN32 g_dwSimLoops = 0;
+static T_TPS_SIM_COUNTERS g_zSimStepStart;
+
+static USIGN32 locSimGet32(USIGN32 dwAddress);
+static VOID    locSimSet32(USIGN32 dwAddress, USIGN32 dwValue);
+static BOOL    locSimAccessed(USIGN32 dwAddress, USIGN32 dwLength, USIGN32 dwRegister);
+static VOID    locSimRead(USIGN32 dwAddress, USIGN8* pbyData, USIGN32 dwLength);
+static VOID    locSimWrite(USIGN32 dwAddress, const USIGN8* pbyData, USIGN32 dwLength);
+static VOID    locSimOnAppEvents(USIGN32 dwToggled);
+static VOID    locSimOnAlarmSendReq(USIGN32 dwAr);
+static VOID    locSimOnRecordDone(VOID);
+static VOID    locSimPutNetwork(USIGN8* pbyDest, USIGN32 dwValue, USIGN32 dwBytes);
+static VOID    locSimPrintCounters(const CHAR* pszName, const T_TPS_SIM_COUNTERS* pzStart);
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimInit()
+**
+** DESCRIPTION:   Clears the DPRAM and starts the modelled TPS-1: the stack
+**                start number is written into the NRT area, so the next
+**                TPS_CheckStackStart() is successful. The record and alarm
+**                mailboxes are at the addresses APP_AddDevice() uses.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     const T_TPS_SIM_STEP* pzSteps (replay, NULL: none)
+**                USIGN32               dwNumberOfSteps
+**
+*******************************************************************************
+*/
+VOID TPS_SimInit(const T_TPS_SIM_STEP* pzSteps, USIGN32 dwNumberOfSteps)
+{
+    USIGN32 dwAddress;
+    USIGN32 dwAr;
+
+    memset(g_bySimDpram, 0x00, sizeof(g_bySimDpram));
+
+    locSimSet32(BASE_ADDRESS_NRT_AREA, STACK_START_NUMBER | STACK_VERSION_NUMBER);
+    locSimSet32(BASE_ADDRESS_NRT_AREA + offsetof(NRT_APP_CONFIG_HEAD, dwNrtMemSize), BASE_NRT_AREA_SIZE);
+
+    /* All host interrupts are masked after reset.                          */
+    locSimSet32(HOST_IRQ_MASK_HIGH, 0xFFFFFFFF);
+
+    /* Same layout as APP_AddDevice(): header, DWORD_ALIGN(), number of     */
+    /* IO-ARs, then per IO-AR a record mailbox and two alarm mailboxes,     */
+    /* then the mailboxes of the supervisor and the implicit AR.            */
+    /*----------------------------------------------------------------------*/
+    dwAddress = BASE_ADDRESS_NRT_AREA + sizeof(NRT_APP_CONFIG_HEAD);
+    dwAddress += (4 - (dwAddress % 4));
+    dwAddress += 2;
+
+    for (dwAr = 0; dwAr < MAX_NUMBER_IOAR; dwAr++)
+    {
+        g_dwSimRecordMailbox[dwAr] = dwAddress;
+        dwAddress += TPS_SIM_RECORD_MB_DATA + SIZE_RECORD_MB0;
+
+        g_dwSimAlarmMailbox[2 * dwAr] = dwAddress;
+        dwAddress += SIZE_ALARM_MB + 4;
+        g_dwSimAlarmMailbox[(2 * dwAr) + 1] = dwAddress;
+        dwAddress += SIZE_ALARM_MB + 4;
+    }
+
+    g_dwSimRecordMailbox[SUPERVISOR_MB_NUM] = dwAddress;
+    dwAddress += TPS_SIM_RECORD_MB_DATA + SIZE_RECORD_MB2;
+    g_dwSimRecordMailbox[IMPLICITE_MB_NUM] = dwAddress;
+
+    g_dwSimBufferChangeRequest = 0;
+    g_dwSimBufferChangeReads = 0;
+    g_dwSimCommandPos = 0;
+
+    g_dwSimStackUpCycles = 0;
+    g_dwSimStartAckMs = 0;
+    g_dwSimStartAckCycles = 0;
+
+    g_pzSimSteps = pzSteps;
+    g_dwSimNumberOfSteps = (pzSteps != NULL) ? dwNumberOfSteps : 0;
+    g_dwSimStep = 0;
+    g_dwSimLoops = 0;
+
+    TPS_SimResetCounters();
+
+#ifdef TPS_PROFILING
+    TPS_ProfileSetCycleSource(TPS_SimGetCycles);
+#endif
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimSpiByte()
+**
+** DESCRIPTION:   The SPI slave of the modelled TPS-1: takes one byte sent
+**                by the host (MOSI) and returns the byte of the TPS-1
+**                (MISO). The bytes of a command may come in any number of
+**                transfers and chip select frames. With the last header
+**                byte a read is executed on the modelled DPRAM, with the
+**                last data byte a write. An invalid command is ignored and
+**                the next byte starts a new command.
+**
+** Return_Type:   USIGN8
+**
+** PARAMETER:     USIGN8 byMosi
+**
+*******************************************************************************
+*/
+USIGN8 TPS_SimSpiByte(USIGN8 byMosi)
+{
+    USIGN8  byMiso = 0x00;
+    USIGN32 dwAddress;
+
+    if (g_pbySimTrace != NULL)
+    {
+        if (g_dwSimTraceLength < g_dwSimTraceSize)
+        {
+            g_pbySimTrace[g_dwSimTraceLength] = byMosi;
+        }
+        g_dwSimTraceLength++;
+    }
+
+    g_zSimCounters.dwBytes++;
+    g_dwSimCycles += TPS_SIM_CYCLES_PER_SPI_BYTE;
+
+    /* Command header: direct access (1, 2 or 4 bytes, length in the        */
+    /* command) with 3 bytes, block access with CMD_MEM_LEN bytes.          */
+    /*----------------------------------------------------------------------*/
+    if (g_dwSimCommandPos == 0)
+    {
+        g_dwSimHeaderLength = ((byMosi & 0x3F) == 0x00) ? CMD_MEM_LEN : 3;
+        g_dwSimDataLength = byMosi & 0x3F;
+    }
+
+    if (g_dwSimCommandPos < g_dwSimHeaderLength)
+    {
+        g_bySimCommand[g_dwSimCommandPos++] = byMosi;
+
+        if (g_dwSimCommandPos == g_dwSimHeaderLength)
+        {
+            dwAddress = g_bySimCommand[1] | ((USIGN32)g_bySimCommand[2] << 8);
+            if (g_dwSimHeaderLength == CMD_MEM_LEN)
+            {
+                g_dwSimDataLength = g_bySimCommand[3] | ((USIGN32)g_bySimCommand[4] << 8);
+            }
+
+            if ((g_dwSimDataLength == 0) || (g_dwSimDataLength > sizeof(g_bySimData)))
+            {
+                g_dwSimCommandPos = 0;
+                return (byMiso);
+            }
+
+            switch (g_bySimCommand[0] & 0xC0)
+            {
+            case 0x40:
+                g_zSimCounters.dwWriteCommands++;
+                g_zSimCounters.dwPayloadBytes += g_dwSimDataLength;
+                break;
+            case 0x80:
+                g_zSimCounters.dwReadCommands++;
+                g_zSimCounters.dwPayloadBytes += g_dwSimDataLength;
+                locSimRead(dwAddress, g_bySimData, g_dwSimDataLength);
+                break;
+            default:
+                g_dwSimCommandPos = 0;
+                break;
+            }
+        }
+        return (byMiso);
+    }
+
+    /* Data                                                                 */
+    /*----------------------------------------------------------------------*/
+    if ((g_bySimCommand[0] & 0xC0) == 0x80)
+    {
+        byMiso = g_bySimData[g_dwSimCommandPos - g_dwSimHeaderLength];
+    }
+    else
+    {
+        g_bySimData[g_dwSimCommandPos - g_dwSimHeaderLength] = byMosi;
+    }
+    g_dwSimCommandPos++;
+
+    if (g_dwSimCommandPos == (g_dwSimHeaderLength + g_dwSimDataLength))
+    {
+        if ((g_bySimCommand[0] & 0xC0) == 0x40)
+        {
+            dwAddress = g_bySimCommand[1] | ((USIGN32)g_bySimCommand[2] << 8);
+            locSimWrite(dwAddress, g_bySimData, g_dwSimDataLength);
+        }
+        g_dwSimCommandPos = 0;
+    }
+
+    return (byMiso);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimDmaTransfer()
+**
+** DESCRIPTION:   DMA controller of the model for locSPI_DmaTransfer(): the
+**                TX channel sends dwLength bytes from pbyTxSource, which is
+**                only incremented with bTxIncrement (MINC), the RX channel
+**                stores the received bytes in pbyRxData if it is not NULL.
+**                The transfer is complete when the function returns.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     const USIGN8* pbyTxSource
+**                BOOL          bTxIncrement
+**                USIGN8*       pbyRxData
+**                USIGN32       dwLength
+**
+*******************************************************************************
+*/
+VOID TPS_SimDmaTransfer(const USIGN8* pbyTxSource, BOOL bTxIncrement, USIGN8* pbyRxData, USIGN32 dwLength)
+{
+    USIGN32 idx;
+    USIGN8  byMiso;
+
+    g_zSimCounters.dwDmaTransfers++;
+
+    for (idx = 0; idx < dwLength; idx++)
+    {
+        byMiso = TPS_SimSpiByte(pbyTxSource[(bTxIncrement == TPS_TRUE) ? idx : 0]);
+        if (pbyRxData != NULL)
+        {
+            pbyRxData[idx] = byMiso;
+        }
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimTraceStart() / TPS_SimTraceStop()
+**
+** DESCRIPTION:   Records the bytes sent by the host (MOSI) into pbyTrace.
+**                TPS_SimTraceStop() ends the recording and returns the
+**                number of bytes sent, which may be more than dwSize.
+**
+*******************************************************************************
+*/
+VOID TPS_SimTraceStart(USIGN8* pbyTrace, USIGN32 dwSize)
+{
+    g_pbySimTrace = pbyTrace;
+    g_dwSimTraceSize = dwSize;
+    g_dwSimTraceLength = 0;
+}
+
+USIGN32 TPS_SimTraceStop(VOID)
+{
+    g_pbySimTrace = NULL;
+
+    return g_dwSimTraceLength;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimRaiseEvent()
+**
+** DESCRIPTION:   Sets an event of the TPS-1 (TPS_EVENT_ONCONNECTDONE_IOAR0,
+**                ...) in EVENT_REGISTER_TPS. With TPS_EVENT_IRQ_MODE the host
+**                interrupt is signalled if the event is not masked.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwEventBit
+**
+*******************************************************************************
+*/
+VOID TPS_SimRaiseEvent(USIGN32 dwEventBit)
+{
+    locSimSet32(EVENT_REGISTER_TPS, locSimGet32(EVENT_REGISTER_TPS) | TPS_EVENT_MASK(dwEventBit));
+    g_zSimCounters.dwEventsRaised++;
+
+#ifdef TPS_EVENT_IRQ_MODE
+    if ((locSimGet32(HOST_IRQ_MASK_HIGH) & TPS_EVENT_MASK(dwEventBit)) == 0)
+    {
+        TPS_EventIrqHandler();
+    }
+#endif
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimWriteMem() / TPS_SimReadMem()
+**
+** DESCRIPTION:   Access to the modelled DPRAM from the TPS-1 side. No SPI
+**                command is counted and the registers do not react.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_SimWriteMem(USIGN32 dwAddress, const USIGN8* pbyData, USIGN32 dwLength)
+{
+    if ((dwAddress < TPS_SIM_DPRAM_SIZE) && (dwLength <= (TPS_SIM_DPRAM_SIZE - dwAddress)))
+    {
+        memcpy(&g_bySimDpram[dwAddress], pbyData, dwLength);
+    }
+}
+
+VOID TPS_SimReadMem(USIGN32 dwAddress, USIGN8* pbyData, USIGN32 dwLength)
+{
+    if ((dwAddress < TPS_SIM_DPRAM_SIZE) && (dwLength <= (TPS_SIM_DPRAM_SIZE - dwAddress)))
+    {
+        memcpy(pbyData, &g_bySimDpram[dwAddress], dwLength);
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimGetRecordMailbox() / TPS_SimGetAlarmMailbox()
+**
+** DESCRIPTION:   Return the DPRAM address of a record mailbox (0 .. 3) or an
+**                alarm mailbox (2 * AR + 0: low, 2 * AR + 1: high priority).
+**                The address is the size field at the start of the mailbox.
+**
+** Return_Type:   USIGN32 (0: invalid mailbox)
+**
+*******************************************************************************
+*/
+USIGN32 TPS_SimGetRecordMailbox(USIGN8 byMailbox)
+{
+    return (byMailbox < TPS_SIM_NUMBER_RECORD_MB) ? g_dwSimRecordMailbox[byMailbox] : 0;
+}
+
+USIGN32 TPS_SimGetAlarmMailbox(USIGN8 byMailbox)
+{
+    return (byMailbox < SIM_NUMBER_ALARM_MB) ? g_dwSimAlarmMailbox[byMailbox] : 0;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimSetBufferChangeLatency()
+**
+** DESCRIPTION:   Sets the number of status reads that return "pending"
+**                after an IO buffer change was requested.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwPolls
+**
+*******************************************************************************
+*/
+VOID TPS_SimSetBufferChangeLatency(USIGN32 dwPolls)
+{
+    g_dwSimBufferChangeLatency = dwPolls;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimSetStartupTimes()
+**
+** DESCRIPTION:   Delays the startup of the modelled TPS-1 until the next
+**                TPS_SimInit(): the stack start number is written
+**                dwStackUpMs after this call, the configuration is
+**                confirmed dwStartAckMs after APP_EVENT_CONFIG_FINISHED.
+**                Both are seen by the first read of the host after that
+**                time (model clock). 0 means at once.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwStackUpMs
+**                USIGN32 dwStartAckMs
+**
+*******************************************************************************
+*/
+VOID TPS_SimSetStartupTimes(USIGN32 dwStackUpMs, USIGN32 dwStartAckMs)
+{
+    g_dwSimStackUpCycles = 0;
+    if (dwStackUpMs != 0)
+    {
+        locSimSet32(BASE_ADDRESS_NRT_AREA, 0x00000000);
+        g_dwSimStackUpCycles = g_dwSimCycles + (dwStackUpMs * TPS_SIM_CYCLES_PER_MS);
+    }
+    g_dwSimStartAckMs = dwStartAckMs;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimGetCounters() / TPS_SimResetCounters()
+**
+** DESCRIPTION:   Copy or clear the SPI counters of the model.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_SimGetCounters(T_TPS_SIM_COUNTERS* pzCounters)
+{
+    if (pzCounters != NULL)
+    {
+        *pzCounters = g_zSimCounters;
+    }
+}
+
+VOID TPS_SimResetCounters(VOID)
+{
+    memset(&g_zSimCounters, 0x00, sizeof(g_zSimCounters));
+    memset(&g_zSimStepStart, 0x00, sizeof(g_zSimStepStart));
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimGetCycles()
+**
+** DESCRIPTION:   Returns the model clock. It advances with every SPI byte
+**                and with TPS_SimDelay(), so the profiling table shows the
+**                SPI time of the target.
+**
+** Return_Type:   USIGN32
+**
+*******************************************************************************
+*/
+USIGN32 TPS_SimGetCycles(VOID)
+{
+    return g_dwSimCycles;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimDelay()
+**
+** DESCRIPTION:   Replaces HAL_Delay(). Only the model clock is advanced.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwMilliseconds
+**
+*******************************************************************************
+*/
+VOID TPS_SimDelay(USIGN32 dwMilliseconds)
+{
+    g_dwSimCycles += dwMilliseconds * TPS_SIM_CYCLES_PER_MS;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimRead()
+**
+** DESCRIPTION:   Read of the host. The status of a requested IO buffer
+**                change becomes "done" after g_dwSimBufferChangeLatency
+**                reads. The delayed stack start and start confirmation of
+**                TPS_SimSetStartupTimes() are written when they are due.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+static VOID locSimRead(USIGN32 dwAddress, USIGN8* pbyData, USIGN32 dwLength)
+{
+    if ((g_dwSimStackUpCycles != 0) && (g_dwSimCycles >= g_dwSimStackUpCycles))
+    {
+        locSimSet32(BASE_ADDRESS_NRT_AREA, STACK_START_NUMBER | STACK_VERSION_NUMBER);
+        g_dwSimStackUpCycles = 0;
+    }
+
+    if ((g_dwSimStartAckCycles != 0) && (g_dwSimCycles >= g_dwSimStartAckCycles))
+    {
+        locSimSet32(BASE_ADDRESS_NRT_AREA + offsetof(NRT_APP_CONFIG_HEAD, dwNrtMemSize), BASE_NRT_AREA_SIZE);
+        g_dwSimStartAckCycles = 0;
+    }
+
+    if ((g_dwSimBufferChangeRequest != 0) && locSimAccessed(dwAddress, dwLength, BASE_ADDRESS_DPRAM + 4))
+    {
+        if (g_dwSimBufferChangeReads >= g_dwSimBufferChangeLatency)
+        {
+            locSimSet32(BASE_ADDRESS_DPRAM + 4, g_dwSimBufferChangeRequest ^ SIM_BUFFER_CHANGE_BIT);
+            g_dwSimBufferChangeRequest = 0;
+        }
+        g_dwSimBufferChangeReads++;
+    }
+
+    TPS_SimReadMem(dwAddress, pbyData, dwLength);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimWrite()
+**
+** DESCRIPTION:   Write of the host. The firmware side of the registers:
+**                toggled bits of EVENT_REGISTER_APP are executed, toggled
+**                bits of EVENT_REGISTER_APP_ACKN clear the TPS events, a
+**                write to BASE_ADDRESS_DPRAM requests an IO buffer change,
+**                HOST_EOI raises the interrupt again if events are pending.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+static VOID locSimWrite(USIGN32 dwAddress, const USIGN8* pbyData, USIGN32 dwLength)
+{
+    USIGN32 dwAppEvents = locSimGet32(EVENT_REGISTER_APP);
+    USIGN32 dwAckn = locSimGet32(EVENT_REGISTER_APP_ACKN);
+
+    TPS_SimWriteMem(dwAddress, pbyData, dwLength);
+
+    if (locSimAccessed(dwAddress, dwLength, EVENT_REGISTER_APP_ACKN))
+    {
+        dwAckn ^= locSimGet32(EVENT_REGISTER_APP_ACKN);
+        locSimSet32(EVENT_REGISTER_TPS, locSimGet32(EVENT_REGISTER_TPS) & ~dwAckn);
+    }
+
+    if (locSimAccessed(dwAddress, dwLength, EVENT_REGISTER_APP))
+    {
+        locSimOnAppEvents(dwAppEvents ^ locSimGet32(EVENT_REGISTER_APP));
+    }
+
+    if (locSimAccessed(dwAddress, dwLength, BASE_ADDRESS_DPRAM))
+    {
+        /* The status keeps the request bit until the change is done.       */
+        g_dwSimBufferChangeRequest = locSimGet32(BASE_ADDRESS_DPRAM);
+        g_dwSimBufferChangeReads = 0;
+        locSimSet32(BASE_ADDRESS_DPRAM + 4, g_dwSimBufferChangeRequest);
+        g_zSimCounters.dwBufferChanges++;
+    }
+
+#ifdef TPS_EVENT_IRQ_MODE
+    if (locSimAccessed(dwAddress, dwLength, HOST_EOI) &&
+        ((locSimGet32(EVENT_REGISTER_TPS) & ~locSimGet32(HOST_IRQ_MASK_HIGH)) != 0))
+    {
+        TPS_EventIrqHandler();
+    }
+#endif
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimOnAppEvents()
+**
+** DESCRIPTION:   Firmware reaction to the events of the host.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwToggled (toggled bits of EVENT_REGISTER_APP)
+**
+*******************************************************************************
+*/
+static VOID locSimOnAppEvents(USIGN32 dwToggled)
+{
+    USIGN32 dwEventBit;
+
+    while (dwToggled != 0)
+    {
+        dwEventBit = TPS_COUNT_TRAILING_ZEROS(dwToggled);
+        dwToggled &= (dwToggled - 1);
+
+        g_zSimCounters.dwAppEvents++;
+
+        switch (dwEventBit)
+        {
+        case APP_EVENT_CONFIG_FINISHED:
+            /* Confirm the device configuration, see TPS_StartDevice().     */
+            if (g_dwSimStartAckMs != 0)
+            {
+                g_dwSimStartAckCycles = g_dwSimCycles + (g_dwSimStartAckMs * TPS_SIM_CYCLES_PER_MS);
+            }
+            else
+            {
+                locSimSet32(BASE_ADDRESS_NRT_AREA + offsetof(NRT_APP_CONFIG_HEAD, dwNrtMemSize), BASE_NRT_AREA_SIZE);
+            }
+            break;
+        case APP_EVENT_ALARM_SEND_REQ_AR0:
+            locSimOnAlarmSendReq(AR_0);
+            break;
+        case APP_EVENT_ALARM_SEND_REQ_AR1:
+            locSimOnAlarmSendReq(AR_1);
+            break;
+        case APP_EVENT_RECORD_DONE:
+            locSimOnRecordDone();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimOnAlarmSendReq()
+**
+** DESCRIPTION:   The PLC acknowledges every active alarm of the AR at once.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 dwAr
+**
+*******************************************************************************
+*/
+static VOID locSimOnAlarmSendReq(USIGN32 dwAr)
+{
+    static const USIGN32 dwAckEvent[2] = { TPS_EVENT_ONALARM_ACK_0, TPS_EVENT_ONALARM_ACK_1 };
+    USIGN32 dwPrio;
+    USIGN32 dwFlags;
+
+    for (dwPrio = 0; dwPrio < 2; dwPrio++)
+    {
+        dwFlags = g_dwSimAlarmMailbox[(2 * dwAr) + dwPrio] + offsetof(ALARM_MB, pt_flags);
+
+        if (g_bySimDpram[dwFlags] == ACTIVE_FLAG)
+        {
+            g_bySimDpram[dwFlags] = ACK_FLAG;
+            g_zSimCounters.dwAlarmsAcked++;
+            TPS_SimRaiseEvent(dwAckEvent[dwPrio]);
+        }
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimOnRecordDone()
+**
+** DESCRIPTION:   The response of every finished record request is sent,
+**                the mailbox is free again.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+static VOID locSimOnRecordDone(VOID)
+{
+    USIGN32 dwMailbox;
+    USIGN32 dwFlags;
+
+    for (dwMailbox = 0; dwMailbox < TPS_SIM_NUMBER_RECORD_MB; dwMailbox++)
+    {
+        dwFlags = g_dwSimRecordMailbox[dwMailbox] + TPS_SIM_RECORD_MB_FLAGS;
+
+        if ((g_bySimDpram[dwFlags] & RECORD_FLAG_DONE) != 0)
+        {
+            g_bySimDpram[dwFlags] = 0x00;
+            g_zSimCounters.dwRecordsDone++;
+        }
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimRecordRequest()
+**
+** DESCRIPTION:   Writes a record request of the PLC into a record mailbox
+**                and raises TPS_EVENT_ONREADRECORD or TPS_EVENT_ONWRITERECORD.
+**                The numbers in the request header are big endian. Used by
+**                TPS_SIM_STEP_RECORD_REQ and by the host tests.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     const T_TPS_SIM_RECORD_REQ* pzRequest
+**
+*******************************************************************************
+*/
+VOID TPS_SimRecordRequest(const T_TPS_SIM_RECORD_REQ* pzRequest)
+{
+    USIGN32         dwMailbox;
+    USIGN8          byHeader[RECORD_REQ_HEADER_LEN];
+
+    if ((pzRequest == NULL) || (pzRequest->byMailbox >= TPS_SIM_NUMBER_RECORD_MB))
+    {
+        return;
+    }
+
+    dwMailbox = g_dwSimRecordMailbox[pzRequest->byMailbox];
+
+    /* The header as the PLC sends it, independent of the codec of the      */
+    /* driver: the fields in network byte order, the ar_uuid is zero.       */
+    memset(byHeader, 0, sizeof(byHeader));
+    locSimPutNetwork(&byHeader[RECORD_REQ_SEQ_NUMBER], g_zSimCounters.dwEventsRaised + 1, 2);
+    locSimPutNetwork(&byHeader[RECORD_REQ_API], pzRequest->dwApi, 4);
+    locSimPutNetwork(&byHeader[RECORD_REQ_SLOT_NUMBER], pzRequest->wSlot, 2);
+    locSimPutNetwork(&byHeader[RECORD_REQ_SUBSLOT_NUMBER], pzRequest->wSubslot, 2);
+    locSimPutNetwork(&byHeader[RECORD_REQ_INDEX], pzRequest->wIndex, 2);
+    locSimPutNetwork(&byHeader[RECORD_REQ_DATA_LEN], pzRequest->dwDataLength, 4);
+    TPS_SimWriteMem(dwMailbox + TPS_SIM_RECORD_MB_REQ_HEADER + RECORD_REQ_BLOCK_OFFSET, byHeader, RECORD_REQ_HEADER_LEN);
+
+    if ((pzRequest->pbyData != NULL) && (pzRequest->dwDataLength <= SIZE_RECORD_MB0))
+    {
+        TPS_SimWriteMem(dwMailbox + TPS_SIM_RECORD_MB_DATA, pzRequest->pbyData, pzRequest->dwDataLength);
+    }
+
+    locSimSet32(dwMailbox + TPS_SIM_RECORD_MB_ERRORCODE1, 0);
+    g_bySimDpram[dwMailbox + TPS_SIM_RECORD_MB_FLAGS] = pzRequest->byFlag;
+
+    TPS_SimRaiseEvent((pzRequest->byFlag == RECORD_FLAG_WRITE) ? TPS_EVENT_ONWRITERECORD : TPS_EVENT_ONREADRECORD);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_SimIdle()
+**
+** DESCRIPTION:   Must be called once per pass of the main loop. Executes the
+**                next replay step if the driver has acknowledged the events
+**                of the previous step and the delay has passed. The SPI
+**                traffic since the previous step is printed.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_SimIdle(VOID)
+{
+    const T_TPS_SIM_STEP* pzStep;
+
+    g_dwSimLoops++;
+
+    if ((g_dwSimStep >= g_dwSimNumberOfSteps) || (locSimGet32(EVENT_REGISTER_TPS) != 0))
+    {
+        return;
+    }
+
+    pzStep = &g_pzSimSteps[g_dwSimStep];
+
+    if (g_dwSimLoops < pzStep->dwDelayLoops)
+    {
+        return;
+    }
+
+    /* Traffic of the driver for the previous step (or the startup).        */
+    /*----------------------------------------------------------------------*/
+    locSimPrintCounters((g_dwSimStep == 0) ? (const CHAR*)"startup" : g_pzSimSteps[g_dwSimStep - 1].pszName,
+                        &g_zSimStepStart);
+    g_zSimStepStart = g_zSimCounters;
+    g_dwSimStep++;
+    g_dwSimLoops = 0;
+
+    switch (pzStep->byAction)
+    {
+    case TPS_SIM_STEP_RAISE_EVENT:
+        TPS_SimRaiseEvent(pzStep->dwParam);
+        break;
+    case TPS_SIM_STEP_WRITE_MEM:
+        TPS_SimWriteMem(pzStep->dwParam, pzStep->pbyData, pzStep->wLength);
+        break;
+    case TPS_SIM_STEP_RECORD_REQ:
+        TPS_SimRecordRequest((const T_TPS_SIM_RECORD_REQ*)pzStep->pbyData);
+        break;
+    case TPS_SIM_STEP_CALL:
+        if (pzStep->pfnCall != NULL)
+        {
+            pzStep->pfnCall(pzStep->dwParam);
+        }
+        break;
+    case TPS_SIM_STEP_STOP:
+    default:
+        locSimPrintCounters((const CHAR*)"total", NULL);
+#ifdef TPS_PROFILING
+        TPS_ProfileDump();
+#endif
+        exit(0);
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimPrintCounters()
+**
+** DESCRIPTION:   Prints the SPI traffic since pzStart (NULL: since reset).
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+static VOID locSimPrintCounters(const CHAR* pszName, const T_TPS_SIM_COUNTERS* pzStart)
+{
+    T_TPS_SIM_COUNTERS zStart;
+
+    if (pzStart != NULL)
+    {
+        zStart = *pzStart;
+    }
+    else
+    {
+        memset(&zStart, 0x00, sizeof(zStart));
+    }
+
+    printf("SIM %-20s read %6lu write %6lu bytes %8lu payload %8lu buffer changes %5lu\r\n",
+        (pszName != NULL) ? (const char*)pszName : "",
+        (unsigned long)(g_zSimCounters.dwReadCommands - zStart.dwReadCommands),
+        (unsigned long)(g_zSimCounters.dwWriteCommands - zStart.dwWriteCommands),
+        (unsigned long)(g_zSimCounters.dwBytes - zStart.dwBytes),
+        (unsigned long)(g_zSimCounters.dwPayloadBytes - zStart.dwPayloadBytes),
+        (unsigned long)(g_zSimCounters.dwBufferChanges - zStart.dwBufferChanges));
+
+    if (pzStart == NULL)
+    {
+        printf("SIM events %lu, app events %lu, records %lu, alarms %lu\r\n",
+            (unsigned long)g_zSimCounters.dwEventsRaised, (unsigned long)g_zSimCounters.dwAppEvents,
+            (unsigned long)g_zSimCounters.dwRecordsDone, (unsigned long)g_zSimCounters.dwAlarmsAcked);
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimAccessed()
+**
+** DESCRIPTION:   TPS_TRUE if the access overlaps the 32 bit register.
+**
+** Return_Type:   BOOL
+**
+*******************************************************************************
+*/
+static BOOL locSimAccessed(USIGN32 dwAddress, USIGN32 dwLength, USIGN32 dwRegister)
+{
+    return (BOOL)((dwAddress < (dwRegister + 4)) && ((dwAddress + dwLength) > dwRegister));
+}
+
+static VOID locSimPutNetwork(USIGN8* pbyDest, USIGN32 dwValue, USIGN32 dwBytes)
+{
+    while (dwBytes > 0)
+    {
+        dwBytes--;
+        pbyDest[dwBytes] = (USIGN8)dwValue;
+        dwValue >>= 8;
+    }
+}
+
+static USIGN32 locSimGet32(USIGN32 dwAddress)
+{
+    USIGN32 dwValue = 0;
+
+    TPS_SimReadMem(dwAddress, (USIGN8*)&dwValue, 4);
+
+    return dwValue;
+}
+
+static VOID locSimSet32(USIGN32 dwAddress, USIGN32 dwValue)
+{
+    TPS_SimWriteMem(dwAddress, (USIGN8*)&dwValue, 4);
+}
+
+#endif /* TPS_HOST_SIMULATION */
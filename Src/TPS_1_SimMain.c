@@ -0,0 +1,85 @@
+/*
++-----------------------------------------------------------------------------+
+| **************************** TPS_1_SimMain.c *****************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| main() of the host simulation, replaces main.c.                             |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_1_SimMain.c
+ *  \brief main() of the host simulation, replaces main.c
+ *
+ *  Runs the example application StartTPS1() (TPSDriver.c) against the TPS-1
+ *  model with a fixed replay: connect of AR 0, PrmEnd, cyclic data, an I&M0
+ *  record read, the alarm button and the abort of the AR. The SPI traffic of
+ *  every step is printed. See TPS_1_Sim.c for the build command.
+ */
+
+/*===========================================================================*/
+/* Includes                                                                  */
+/*===========================================================================*/
+#include <TPS_1_API.h>
+#include <TPS_1_Sim.h>
+#include "main.h"
+
+#ifdef TPS_HOST_SIMULATION
+
+/* Main loop passes with cyclic data exchange between two steps             */
+/*---------------------------------------------------------------------------*/
+#define SIM_CYCLIC_LOOPS      50
+
+/* The external switch of the board, see checkSendAlarmButton().            */
+/*---------------------------------------------------------------------------*/
+USIGN8 g_byDoContinue = 0;
+
+static VOID locSimPressButton(USIGN32 dwDummy);
+#ifdef USE_ALARM_QUEUE
+extern VOID simQueueAlarms(USIGN32 dwARNumber);
+#endif
+
+static const T_TPS_SIM_RECORD_REQ g_zSimReadIM0 =
+{
+    AR_0, RECORD_FLAG_READ, 0x00000000, 0x0000, 0x0001, RECORD_INDEX_IM0, SIZE_RECORD_MB0, NULL
+};
+
+static const T_TPS_SIM_STEP g_zSimReplay[] =
+{
+    /* delay                action                    parameter                           data                     len  call               name */
+    { 0,                    TPS_SIM_STEP_RAISE_EVENT, TPS_EVENT_ONCONNECT_REQ_REC_0,      NULL,                    0,   NULL,              (const CHAR*)"connect req AR0" },
+    { 0,                    TPS_SIM_STEP_RAISE_EVENT, TPS_EVENT_ONCONNECTDONE_IOAR0,      NULL,                    0,   NULL,              (const CHAR*)"connect done AR0" },
+    { 0,                    TPS_SIM_STEP_RAISE_EVENT, TPS_EVENT_ON_PRM_END_DONE_IOAR0,    NULL,                    0,   NULL,              (const CHAR*)"PrmEnd AR0" },
+    { SIM_CYCLIC_LOOPS,     TPS_SIM_STEP_RECORD_REQ,  0,                                  (const USIGN8*)&g_zSimReadIM0, 0, NULL,           (const CHAR*)"read I&M0" },
+#ifdef USE_ALARM_QUEUE
+    { SIM_CYCLIC_LOOPS,     TPS_SIM_STEP_CALL,        AR_0,                               NULL,                    0,   simQueueAlarms,    (const CHAR*)"queue alarms" },
+#endif
+    { SIM_CYCLIC_LOOPS,     TPS_SIM_STEP_CALL,        0,                                  NULL,                    0,   locSimPressButton, (const CHAR*)"button" },
+    { SIM_CYCLIC_LOOPS,     TPS_SIM_STEP_RAISE_EVENT, TPS_EVENT_ONABORT_IOAR0,            NULL,                    0,   NULL,              (const CHAR*)"abort AR0" },
+    { SIM_CYCLIC_LOOPS,     TPS_SIM_STEP_STOP,        0,                                  NULL,                    0,   NULL,              (const CHAR*)"stop" }
+};
+
+/*****************************************************************************
+**
+** FUNCTION NAME: main()
+**
+** DESCRIPTION:   Starts the TPS-1 model with the replay and the example
+**                application. The program ends with the last replay step.
+**
+** Return_Type:   int
+**
+*******************************************************************************
+*/
+int main(void)
+{
+    TPS_SimInit(g_zSimReplay, sizeof(g_zSimReplay) / sizeof(g_zSimReplay[0]));
+
+    return StartTPS1();
+}
+
+static VOID locSimPressButton(USIGN32 dwDummy)
+{
+    g_byDoContinue = 1;
+}
+
+#endif /* TPS_HOST_SIMULATION */
@@ -0,0 +1,1789 @@
+/*
++-----------------------------------------------------------------------------+
+| **************************** TPS_1_SimTest.c *****************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Host tests of the driver against the TPS-1 model of TPS_1_Sim.c.           |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_1_SimTest.c
+ *  \brief host tests of the driver, main() of the test build
+ *
+ *  Every test starts with a cleared TPS-1 model (TPS_SimInit()) and checks
+ *  the driver through its API. The test build takes the driver without the
+ *  example application:
+ *
+ *  gcc -DTPS_HOST_SIMULATION -IInc -o tps_test Src/TPS_1_API.c
+ *      Src/SPI1_Master.c Src/TPS_Profile.c Src/TPS_1_Sim.c
+ *      Src/TPS_1_SimTest.c
+ *
+ *  Each test prints one line "TEST <name> ok" or "TEST <name> FAILED" after
+ *  its failed checks. The exit code is the number of failed tests. Build it
+ *  again with SPI_DMA_TRANSFER in TPS_1_user.h to test the DMA transport.
+ *  Tests of optional features are only built if the feature is active in
+ *  TPS_1_user.h (e.g. TPS_PROFILING, DIAGNOSIS_ENABLE for the diagnosis index).
+ */
+
+/*===========================================================================*/
+/* Includes                                                                  */
+/*===========================================================================*/
+#include <TPS_1_API.h>
+#include <TPS_1_Sim.h>
+#include <stddef.h>
+
+#ifdef TPS_HOST_SIMULATION
+
+/* Checks of a test: a failed check is printed, the test goes on.            */
+/*---------------------------------------------------------------------------*/
+#define SIM_TEST_CHECK(bCondition)  locSimTestCheck((bCondition) ? TPS_TRUE : TPS_FALSE, (const CHAR*)#bCondition, __LINE__)
+
+/* SPI stream test: DPRAM area and lengths                                   */
+/*---------------------------------------------------------------------------*/
+#define SIM_TEST_SPI_AREA           ((USIGN8*)(BASE_ADDRESS_NRT_AREA + 0x4000))
+#define SIM_TEST_SPI_DATA_LEN       300
+#define SIM_TEST_SPI_FILL_LEN       100
+#define SIM_TEST_SPI_RAW_LEN        20
+#define SIM_TEST_SPI_READ_LEN       (SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN + SIM_TEST_SPI_RAW_LEN + 2)
+#define SIM_TEST_SPI_TRACE_SIZE     2048
+
+typedef struct _T_SIM_TEST
+{
+    const CHAR*    pszName;
+    VOID           (*pfnTest)(VOID);
+}T_SIM_TEST;
+
+static USIGN32 g_dwSimTestFailedChecks = 0;
+
+static VOID    locSimTestCheck(BOOL bOk, const CHAR* pszCondition, USIGN32 dwLine);
+static VOID    locSimTestSpiRun(USIGN8 byFraming, USIGN8* pbyTrace, USIGN32* pdwTraceLength,
+                                USIGN8* pbyRead, T_TPS_SIM_COUNTERS* pzCounters);
+static VOID    locSimTestSpiStream(VOID);
+static VOID    locSimTestRecordHeader(VOID);
+static VOID    locSimTestRecordStream(VOID);
+static VOID    locSimTestRecordRequest(USIGN8 byFlag, USIGN32 dwDataLength);
+static SIGN32  locSimTestRecordChunk(USIGN8 byMBNumber, USIGN32 dwOffset, USIGN8* pbyChunk,
+                                     USIGN32 dwLength, VOID* pParam);
+#ifdef USE_RECORD_REGISTRY
+#define SIM_TEST_RECORD_INDEX       0x1000
+#define SIM_TEST_RECORD_HANDLERS    5       /* tags 0 .. 4 of the handlers */
+
+static VOID    locSimTestRecordRegistry(VOID);
+static USIGN8  locSimTestRegistryRequest(USIGN8 byFlag, USIGN16 wSlot, USIGN16 wSubslot, USIGN16 wIndex);
+static SIGN32  locSimTestRecordReadSubslot(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                           USIGN8* pbyData, USIGN32 dwLength);
+static SIGN32  locSimTestRecordReadSlot(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                        USIGN8* pbyData, USIGN32 dwLength);
+static SIGN32  locSimTestRecordReadAny(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                       USIGN8* pbyData, USIGN32 dwLength);
+static SIGN32  locSimTestRecordReadEmpty(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                         USIGN8* pbyData, USIGN32 dwLength);
+static SIGN32  locSimTestRecordWrite(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                     USIGN8* pbyData, USIGN32 dwLength);
+
+static USIGN32 g_dwSimTestRecordCalls[SIM_TEST_RECORD_HANDLERS];
+#endif
+#ifdef TPS_PROFILING
+static USIGN32 locSimTestGetCycles(VOID);
+static VOID    locSimTestProfile(VOID);
+static VOID    locSimTestProfileSpi(VOID);
+
+static USIGN32 g_dwSimTestCycles = 0;
+#endif
+static SUBSLOT* locSimTestConfigure(USIGN16 wNumberOfChannelDiag);
+static SUBSLOT* locSimTestConfigDevice(USIGN16 wNumberOfChannelDiag);
+static VOID    locSimTestObjectPool(VOID);
+#ifdef USE_HANDLE_INDEX
+static VOID    locSimTestHandleIndex(VOID);
+#endif
+
+static T_IM0_DATA g_zSimTestIM0;
+#ifdef USE_DIAG_INDEX
+static VOID    locSimTestDiagAck(SUBSLOT* pzSubslot, USIGN16 wNumberOfEntries);
+static VOID    locSimTestDiagIndex(VOID);
+#endif
+#ifdef USE_BUFFER_POOL
+#define SIM_TEST_POOL_ROUNDS        10000
+
+static VOID    locSimTestBufferPool(VOID);
+#endif
+#if defined(USE_ETHERNET_INTERFACE) && defined(USE_ETHERNET_TX_QUEUE)
+static VOID    locSimTestEthTxQueue(VOID);
+static VOID    locSimTestEthTxAck(VOID);
+#endif
+#ifdef USE_STARTUP_SERVICE
+#define SIM_TEST_STACK_UP_MS        30
+#define SIM_TEST_START_ACK_MS       5
+#define SIM_TEST_STARTUP_LIMIT_MS   1000
+
+static VOID    locSimTestStartup(VOID);
+static USIGN32 locSimTestStartupConfigure(VOID);
+static USIGN32 locSimTestGetTimeMs(VOID);
+#endif
+#ifdef USE_CONFIG_IMAGE
+static VOID    locSimTestConfigImage(VOID);
+static VOID    locSimTestConfigImageStart(const USIGN8* pbyImage, USIGN16 wNumberOfChannelDiag);
+
+static USIGN8  g_bySimTestImage[2][CONFIG_IMAGE_MAX_SIZE];
+static USIGN8  g_bySimTestDpram[3][BASE_NRT_AREA_SIZE];
+#endif
+#if defined(USE_ALARM_QUEUE) || defined(USE_DIAG_INDEX)
+#define SIM_TEST_ALARM_ACKS         16
+
+static VOID    locSimTestOnAlarmAck(USIGN16 wUserHandle, USIGN32 dwResponse);
+
+static USIGN16 g_wSimTestAlarmHandle[SIM_TEST_ALARM_ACKS];
+static USIGN32 g_dwSimTestAlarmResponse[SIM_TEST_ALARM_ACKS];
+static USIGN32 g_dwSimTestAlarmAcks = 0;
+#endif
+#ifdef USE_ALARM_QUEUE
+static VOID    locSimTestAlarmQueue(VOID);
+#endif
+
+static const T_SIM_TEST g_zSimTests[] =
+{
+    { (const CHAR*)"spi stream",                locSimTestSpiStream },
+    { (const CHAR*)"record header",             locSimTestRecordHeader },
+    { (const CHAR*)"record stream length",      locSimTestRecordStream },
+#ifdef USE_RECORD_REGISTRY
+    { (const CHAR*)"record registry",           locSimTestRecordRegistry },
+#endif
+    { (const CHAR*)"object pool",               locSimTestObjectPool },
+#ifdef USE_HANDLE_INDEX
+    { (const CHAR*)"handle index",              locSimTestHandleIndex },
+#endif
+#ifdef TPS_PROFILING
+    { (const CHAR*)"profile statistics",        locSimTestProfile },
+    { (const CHAR*)"profile spi",               locSimTestProfileSpi },
+#endif
+#ifdef USE_DIAG_INDEX
+    { (const CHAR*)"diag index",                locSimTestDiagIndex },
+#endif
+#ifdef USE_BUFFER_POOL
+    { (const CHAR*)"buffer pool",               locSimTestBufferPool },
+#endif
+#if defined(USE_ETHERNET_INTERFACE) && defined(USE_ETHERNET_TX_QUEUE)
+    { (const CHAR*)"ethernet tx queue",         locSimTestEthTxQueue },
+#endif
+#ifdef USE_CONFIG_IMAGE
+    { (const CHAR*)"config image",              locSimTestConfigImage },
+#endif
+#ifdef USE_STARTUP_SERVICE
+    { (const CHAR*)"startup service",           locSimTestStartup },
+#endif
+#ifdef USE_ALARM_QUEUE
+    { (const CHAR*)"alarm queue",               locSimTestAlarmQueue },
+#endif
+};
+
+/*****************************************************************************
+**
+** FUNCTION NAME: main()
+**
+** DESCRIPTION:   Runs all tests, each against a cleared TPS-1 model.
+**
+** Return_Type:   int (number of failed tests)
+**
+*******************************************************************************
+*/
+int main(void)
+{
+    USIGN32 dwTest;
+    USIGN32 dwFailedTests = 0;
+    USIGN32 dwNumberOfTests = sizeof(g_zSimTests) / sizeof(g_zSimTests[0]);
+
+    for (dwTest = 0; dwTest < dwNumberOfTests; dwTest++)
+    {
+        TPS_SimInit(NULL, 0);
+        g_dwSimTestFailedChecks = 0;
+
+        g_zSimTests[dwTest].pfnTest();
+
+        if (g_dwSimTestFailedChecks != 0)
+        {
+            dwFailedTests++;
+        }
+        printf("TEST %-28s %s\r\n", (const char*)g_zSimTests[dwTest].pszName,
+            (g_dwSimTestFailedChecks == 0) ? "ok" : "FAILED");
+    }
+
+    printf("TEST %lu of %lu failed\r\n", (unsigned long)dwFailedTests, (unsigned long)dwNumberOfTests);
+
+    return (int)dwFailedTests;
+}
+
+static VOID locSimTestCheck(BOOL bOk, const CHAR* pszCondition, USIGN32 dwLine)
+{
+    if (bOk != TPS_TRUE)
+    {
+        printf("  line %lu: %s\r\n", (unsigned long)dwLine, (const char*)pszCondition);
+        g_dwSimTestFailedChecks++;
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestSpiStream()
+**
+** DESCRIPTION:   The same accesses are done with per byte framing (always
+**                polled) and with burst framing, which takes the DMA path
+**                for transfers of SPI_DMA_MIN_TRANSFER_LEN bytes and more
+**                if SPI_DMA_TRANSFER is set. Both must send the same bytes
+**                to the TPS-1 and read the same data: block write from the
+**                caller's buffer, fill (TPS_MemSet()), block read, direct
+**                accesses and whole command buffers (TPS_SPI_WriteData(),
+**                TPS_SPI_ReadData() in place).
+**
+*******************************************************************************
+*/
+static VOID locSimTestSpiStream(VOID)
+{
+    static USIGN8 byTracePolled[SIM_TEST_SPI_TRACE_SIZE];
+    static USIGN8 byTraceBurst[SIM_TEST_SPI_TRACE_SIZE];
+    USIGN8  byReadPolled[SIM_TEST_SPI_READ_LEN];
+    USIGN8  byReadBurst[SIM_TEST_SPI_READ_LEN];
+    USIGN32 dwLengthPolled;
+    USIGN32 dwLengthBurst;
+    USIGN32 idx;
+    T_TPS_SIM_COUNTERS zPolled;
+    T_TPS_SIM_COUNTERS zBurst;
+
+    locSimTestSpiRun(SPI_FRAMING_PER_BYTE, byTracePolled, &dwLengthPolled, byReadPolled, &zPolled);
+    locSimTestSpiRun(SPI_FRAMING_BURST, byTraceBurst, &dwLengthBurst, byReadBurst, &zBurst);
+
+    SIM_TEST_CHECK(dwLengthPolled <= SIM_TEST_SPI_TRACE_SIZE);
+    SIM_TEST_CHECK(dwLengthPolled == dwLengthBurst);
+    SIM_TEST_CHECK(memcmp(byTracePolled, byTraceBurst, dwLengthPolled) == 0);
+    SIM_TEST_CHECK(memcmp(byReadPolled, byReadBurst, sizeof(byReadPolled)) == 0);
+    SIM_TEST_CHECK(zPolled.dwReadCommands == zBurst.dwReadCommands);
+    SIM_TEST_CHECK(zPolled.dwWriteCommands == zBurst.dwWriteCommands);
+
+    /* The data read back is the data written.                              */
+    /*----------------------------------------------------------------------*/
+    for (idx = 0; idx < SIM_TEST_SPI_DATA_LEN; idx++)
+    {
+        SIM_TEST_CHECK(byReadBurst[idx] == (USIGN8)((idx * 7) + 3));
+    }
+    for (; idx < (SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN); idx++)
+    {
+        SIM_TEST_CHECK(byReadBurst[idx] == 0xA5);
+    }
+    for (; idx < (SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN + SIM_TEST_SPI_RAW_LEN); idx++)
+    {
+        SIM_TEST_CHECK(byReadBurst[idx] == (USIGN8)(0xC0 + idx));
+    }
+    SIM_TEST_CHECK((byReadBurst[idx] == 0x34) && (byReadBurst[idx + 1] == 0x12));
+
+    SIM_TEST_CHECK(zPolled.dwDmaTransfers == 0);
+#ifdef SPI_DMA_TRANSFER
+    SIM_TEST_CHECK(zBurst.dwDmaTransfers == 5);
+#else
+    SIM_TEST_CHECK(zBurst.dwDmaTransfers == 0);
+#endif
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordHeader()
+**
+** DESCRIPTION:   The record request header codec against a fixed header as
+**                the PLC sends it (network byte order, ar_uuid skipped):
+**                seq 0x1234, API 0x00000001, slot 0x0002, subslot 0x8001,
+**                index 0xAFF0, 0x00000100 data bytes.
+**
+*******************************************************************************
+*/
+static VOID locSimTestRecordHeader(VOID)
+{
+    static const USIGN8 byHeader[RECORD_REQ_HEADER_LEN] =
+    {
+        0x12, 0x34,                                     /* seq_number         */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ar_uuid            */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x01,                         /* api                */
+        0x00, 0x02,                                     /* slot_number        */
+        0x80, 0x01,                                     /* subslot_number     */
+        0x00, 0x00,                                     /* padding            */
+        0xAF, 0xF0,                                     /* index              */
+        0x00, 0x00, 0x01, 0x00                          /* record_data_length */
+    };
+    USIGN8          byEncoded[RECORD_REQ_HEADER_LEN];
+    RECORD_BOX_INFO zInfo;
+
+    memset(&zInfo, 0, sizeof(zInfo));
+    TPS_RecordReqHeaderDecode(byHeader, &zInfo);
+
+    SIM_TEST_CHECK(zInfo.wSeqNumber == 0x1234);
+    SIM_TEST_CHECK(zInfo.dwAPINumber == 0x00000001);
+    SIM_TEST_CHECK(zInfo.wSlotNumber == 0x0002);
+    SIM_TEST_CHECK(zInfo.wSubSlotNumber == 0x8001);
+    SIM_TEST_CHECK(zInfo.wIndex == 0xAFF0);
+    SIM_TEST_CHECK(zInfo.dwRecordDataLen == 0x00000100);
+
+    /* The encoder leaves the ar_uuid alone.                                 */
+    memset(byEncoded, 0, sizeof(byEncoded));
+    TPS_RecordReqHeaderEncode(&zInfo, byEncoded);
+
+    SIM_TEST_CHECK(memcmp(byEncoded, byHeader, sizeof(byHeader)) == 0);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordStream()
+**
+** DESCRIPTION:   The streams stay inside the data area of the mailbox
+**                (SIZE_RECORD_MB0 bytes): a write request with a longer
+**                record is refused before the first chunk, the response to
+**                a longer read request is cut at the mailbox size.
+**
+*******************************************************************************
+*/
+static VOID locSimTestRecordStream(VOID)
+{
+    USIGN8  byChunk[100];
+    USIGN8  byLength[4];
+    USIGN32 dwBytes = 0;
+
+    SIM_TEST_CHECK(locSimTestConfigure(0) != NULL);
+
+    locSimTestRecordRequest(RECORD_FLAG_WRITE, SIZE_RECORD_MB0 + 1);
+    SIM_TEST_CHECK(TPS_ReadMailboxDataStream(0, byChunk, sizeof(byChunk), &locSimTestRecordChunk, &dwBytes)
+                   == API_READ_MB_RECORD_TOO_LONG);
+    SIM_TEST_CHECK(dwBytes == 0);
+    SIM_TEST_CHECK(TPS_RecordWriteDone(0, 0xB1, 0) == TPS_ACTION_OK);
+
+    locSimTestRecordRequest(RECORD_FLAG_WRITE, SIZE_RECORD_MB0);
+    SIM_TEST_CHECK(TPS_ReadMailboxDataStream(0, byChunk, sizeof(byChunk), &locSimTestRecordChunk, &dwBytes)
+                   == TPS_ACTION_OK);
+    SIM_TEST_CHECK(dwBytes == SIZE_RECORD_MB0);
+    SIM_TEST_CHECK(TPS_RecordWriteDone(0, 0, 0) == TPS_ACTION_OK);
+
+    dwBytes = 0;
+    locSimTestRecordRequest(RECORD_FLAG_READ, 2 * SIZE_RECORD_MB0);
+    SIM_TEST_CHECK(TPS_WriteMailboxDataStream(0, byChunk, sizeof(byChunk), &locSimTestRecordChunk, &dwBytes)
+                   == TPS_ACTION_OK);
+    SIM_TEST_CHECK(dwBytes == SIZE_RECORD_MB0);
+
+    /* The response length in the header, big endian.                        */
+    TPS_SimReadMem(TPS_SimGetRecordMailbox(0) + TPS_SIM_RECORD_MB_REQ_HEADER + RECORD_REQ_BLOCK_OFFSET +
+                   RECORD_REQ_DATA_LEN, byLength, sizeof(byLength));
+    SIM_TEST_CHECK((byLength[0] == 0x00) && (byLength[1] == 0x00) &&
+                   (byLength[2] == (USIGN8)(SIZE_RECORD_MB0 >> 8)) && (byLength[3] == (USIGN8)SIZE_RECORD_MB0));
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordRequest()
+**
+** DESCRIPTION:   Acts as the TPS-1: puts a record request with the given
+**                flag and data length into record mailbox 0.
+**
+*******************************************************************************
+*/
+static VOID locSimTestRecordRequest(USIGN8 byFlag, USIGN32 dwDataLength)
+{
+    USIGN32 dwMailbox = TPS_SimGetRecordMailbox(0);
+    USIGN8  byHeader[RECORD_REQ_HEADER_LEN];
+
+    memset(byHeader, 0, sizeof(byHeader));
+    byHeader[RECORD_REQ_DATA_LEN]     = (USIGN8)(dwDataLength >> 24);
+    byHeader[RECORD_REQ_DATA_LEN + 1] = (USIGN8)(dwDataLength >> 16);
+    byHeader[RECORD_REQ_DATA_LEN + 2] = (USIGN8)(dwDataLength >> 8);
+    byHeader[RECORD_REQ_DATA_LEN + 3] = (USIGN8)dwDataLength;
+
+    TPS_SimWriteMem(dwMailbox + TPS_SIM_RECORD_MB_REQ_HEADER + RECORD_REQ_BLOCK_OFFSET, byHeader, sizeof(byHeader));
+    TPS_SimWriteMem(dwMailbox + TPS_SIM_RECORD_MB_FLAGS, &byFlag, 1);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordChunk()
+**
+** DESCRIPTION:   Consumes or produces whole chunks, counts the bytes in
+**                *pParam.
+**
+*******************************************************************************
+*/
+static SIGN32 locSimTestRecordChunk(USIGN8 byMBNumber, USIGN32 dwOffset, USIGN8* pbyChunk,
+                                    USIGN32 dwLength, VOID* pParam)
+{
+    memset(pbyChunk, (USIGN8)dwOffset, dwLength);
+    *(USIGN32*)pParam += dwLength;
+
+    return (SIGN32)dwLength;
+}
+
+#ifdef USE_RECORD_REGISTRY
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordRegistry()
+**
+** DESCRIPTION:   Record requests of the model answered by registered
+**                handlers: the registrations are kept sorted, a request
+**                takes the handler of its subslot, then the one of all
+**                subslots of the slot, then the one of all slots. A cached
+**                response is used until the record is written or
+**                TPS_InvalidateRecordCache() is called, the response of a
+**                handler without cache is never kept (also an empty one).
+**
+*******************************************************************************
+*/
+static VOID locSimTestRecordRegistry(VOID)
+{
+    T_RECORD_REGISTRY_STATISTICS zStatistics;
+
+    SIM_TEST_CHECK(locSimTestConfigure(0) != NULL);
+    memset(g_dwSimTestRecordCalls, 0, sizeof(g_dwSimTestRecordCalls));
+
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX, NULL, NULL, 0) == API_RECORD_REGISTRY_NULL_POINTER);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, RECORD_REGISTRY_ANY, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSlot, NULL, 8) == API_RECORD_REGISTRY_INVALID_PARAM);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSubslot, NULL, RECORD_CACHE_SIZE + 1) == API_RECORD_REGISTRY_CACHE_FULL);
+
+    /* Registered out of order, each one is found again by the binary      */
+    /* search of the sorted table.                                          */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, RECORD_REGISTRY_ANY, RECORD_REGISTRY_ANY, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadAny, NULL, 0) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX + 1,
+                                             locSimTestRecordReadEmpty, NULL, 0) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSubslot, locSimTestRecordWrite, 8) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, RECORD_REGISTRY_ANY, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSlot, NULL, 0) == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, RECORD_REGISTRY_ANY, RECORD_REGISTRY_ANY, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadAny, NULL, 0) == API_RECORD_REGISTRY_EXISTS);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX + 1,
+                                             locSimTestRecordReadEmpty, NULL, 0) == API_RECORD_REGISTRY_EXISTS);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, 1, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSubslot, NULL, 0) == API_RECORD_REGISTRY_EXISTS);
+    SIM_TEST_CHECK(TPS_RegisterRecordHandler(0, 1, RECORD_REGISTRY_ANY, SIM_TEST_RECORD_INDEX,
+                                             locSimTestRecordReadSlot, NULL, 0) == API_RECORD_REGISTRY_EXISTS);
+
+    /* Fallback: subslot, all subslots of the slot, all slots.              */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX) == 0);
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 2, SIM_TEST_RECORD_INDEX) == 1);
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 2, 1, SIM_TEST_RECORD_INDEX) == 2);
+    SIM_TEST_CHECK((g_dwSimTestRecordCalls[0] == 1) && (g_dwSimTestRecordCalls[1] == 1) && (g_dwSimTestRecordCalls[2] == 1));
+
+    /* The cached response is used without the handler.                    */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX) == 0);
+    SIM_TEST_CHECK(g_dwSimTestRecordCalls[0] == 1);
+
+    /* A write of the record discards the cached response.                  */
+    /*----------------------------------------------------------------------*/
+    locSimTestRegistryRequest(RECORD_FLAG_WRITE, 1, 1, SIM_TEST_RECORD_INDEX);
+    SIM_TEST_CHECK(g_dwSimTestRecordCalls[4] == 1);
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX) == 0);
+    SIM_TEST_CHECK(g_dwSimTestRecordCalls[0] == 2);
+
+    /* So does TPS_InvalidateRecordCache().                                  */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_InvalidateRecordCache(0, 5, RECORD_REGISTRY_ANY, RECORD_REGISTRY_ANY) == API_RECORD_REGISTRY_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_InvalidateRecordCache(0, 1, 1, SIM_TEST_RECORD_INDEX) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX) == 0);
+    SIM_TEST_CHECK(locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX) == 0);
+    SIM_TEST_CHECK(g_dwSimTestRecordCalls[0] == 3);
+
+    /* The empty response of a handler without cache is not kept.           */
+    /*----------------------------------------------------------------------*/
+    locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX + 1);
+    locSimTestRegistryRequest(RECORD_FLAG_READ, 1, 1, SIM_TEST_RECORD_INDEX + 1);
+    SIM_TEST_CHECK(g_dwSimTestRecordCalls[3] == 2);
+
+    SIM_TEST_CHECK(TPS_GetRecordRegistryStatistics(NULL) == API_RECORD_REGISTRY_NULL_POINTER);
+    SIM_TEST_CHECK(TPS_GetRecordRegistryStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.dwReads == 9) && (zStatistics.dwCacheHits == 2));
+    SIM_TEST_CHECK((zStatistics.dwWrites == 1) && (zStatistics.dwInvalidations == 2));
+
+    TPS_CleanApiConf();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRegistryRequest()
+**
+** DESCRIPTION:   Acts as the PLC: sends a record request for API 0 to
+**                record mailbox 0 and lets the driver answer it.
+**
+** Return_Type:   USIGN8 (first byte of the read response: tag of the
+**                handler, 0xFF without response)
+**
+*******************************************************************************
+*/
+static USIGN8 locSimTestRegistryRequest(USIGN8 byFlag, USIGN16 wSlot, USIGN16 wSubslot, USIGN16 wIndex)
+{
+    static const USIGN8  byData[2] = { 0x12, 0x34 };
+    T_TPS_SIM_RECORD_REQ zRequest;
+    USIGN8               byTag = 0xFF;
+
+    memset(&zRequest, 0, sizeof(zRequest));
+    zRequest.byMailbox    = 0;
+    zRequest.byFlag       = byFlag;
+    zRequest.wSlot        = wSlot;
+    zRequest.wSubslot     = wSubslot;
+    zRequest.wIndex       = wIndex;
+    zRequest.dwDataLength = sizeof(byData);
+    zRequest.pbyData      = (byFlag == RECORD_FLAG_WRITE) ? byData : NULL;
+
+    TPS_SimWriteMem(TPS_SimGetRecordMailbox(0) + TPS_SIM_RECORD_MB_DATA, &byTag, 1);
+    TPS_SimRecordRequest(&zRequest);
+    TPS_CheckEvents();
+
+    TPS_SimReadMem(TPS_SimGetRecordMailbox(0) + TPS_SIM_RECORD_MB_DATA, &byTag, 1);
+
+    return byTag;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestRecordReadSubslot() / ...Slot() / ...Any() /
+**                ...Empty() / locSimTestRecordWrite()
+**
+** DESCRIPTION:   Handlers of the registry test. They count their calls, a
+**                read handler answers with its tag (0 .. 3) and the count.
+**
+*******************************************************************************
+*/
+static SIGN32 locSimTestRecordReadSubslot(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                          USIGN8* pbyData, USIGN32 dwLength)
+{
+    (VOID)dwMailboxNumber;
+    (VOID)pzRecord;
+    (VOID)dwLength;
+
+    g_dwSimTestRecordCalls[0]++;
+    pbyData[0] = 0;
+    pbyData[1] = (USIGN8)g_dwSimTestRecordCalls[0];
+    return 2;
+}
+
+static SIGN32 locSimTestRecordReadSlot(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                       USIGN8* pbyData, USIGN32 dwLength)
+{
+    (VOID)dwMailboxNumber;
+    (VOID)pzRecord;
+    (VOID)dwLength;
+
+    g_dwSimTestRecordCalls[1]++;
+    pbyData[0] = 1;
+    pbyData[1] = (USIGN8)g_dwSimTestRecordCalls[1];
+    return 2;
+}
+
+static SIGN32 locSimTestRecordReadAny(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                      USIGN8* pbyData, USIGN32 dwLength)
+{
+    (VOID)dwMailboxNumber;
+    (VOID)pzRecord;
+    (VOID)dwLength;
+
+    g_dwSimTestRecordCalls[2]++;
+    pbyData[0] = 2;
+    pbyData[1] = (USIGN8)g_dwSimTestRecordCalls[2];
+    return 2;
+}
+
+static SIGN32 locSimTestRecordReadEmpty(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                        USIGN8* pbyData, USIGN32 dwLength)
+{
+    (VOID)dwMailboxNumber;
+    (VOID)pzRecord;
+    (VOID)pbyData;
+    (VOID)dwLength;
+
+    g_dwSimTestRecordCalls[3]++;
+    return 0;
+}
+
+static SIGN32 locSimTestRecordWrite(USIGN32 dwMailboxNumber, const RECORD_BOX_INFO* pzRecord,
+                                    USIGN8* pbyData, USIGN32 dwLength)
+{
+    (VOID)dwMailboxNumber;
+    (VOID)pzRecord;
+
+    g_dwSimTestRecordCalls[4]++;
+    return ((dwLength == 2) && (pbyData[0] == 0x12) && (pbyData[1] == 0x34)) ? 0 : RECORD_HANDLER_ACCESS_ERROR;
+}
+#endif /* USE_RECORD_REGISTRY */
+
+static VOID locSimTestSpiRun(USIGN8 byFraming, USIGN8* pbyTrace, USIGN32* pdwTraceLength,
+                             USIGN8* pbyRead, T_TPS_SIM_COUNTERS* pzCounters)
+{
+    USIGN8  byData[SIM_TEST_SPI_DATA_LEN];
+    USIGN8  byCommand[CMD_MEM_LEN + SIM_TEST_SPI_RAW_LEN];
+    USIGN8* pbyRaw = SIM_TEST_SPI_AREA + SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN;
+    USIGN8  bySaveFraming = TPS_SPI_GetFraming();
+    USIGN16 wValue = 0;
+    USIGN32 idx;
+
+    TPS_SimInit(NULL, 0);
+    TPS_SPI_SetFraming(byFraming);
+
+    for (idx = 0; idx < SIM_TEST_SPI_DATA_LEN; idx++)
+    {
+        byData[idx] = (USIGN8)((idx * 7) + 3);
+    }
+
+    TPS_SimTraceStart(pbyTrace, SIM_TEST_SPI_TRACE_SIZE);
+
+    SIM_TEST_CHECK(TPS_SetValueData(SIM_TEST_SPI_AREA, byData, SIM_TEST_SPI_DATA_LEN) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_MemSet(SIM_TEST_SPI_AREA + SIM_TEST_SPI_DATA_LEN, 0xA5, SIM_TEST_SPI_FILL_LEN) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_SetValue16(pbyRaw + SIM_TEST_SPI_RAW_LEN, 0x1234) == TPS_ACTION_OK);
+
+    /* Whole command buffer: write MEM, the TPS-1 answer is discarded.      */
+    /*----------------------------------------------------------------------*/
+    byCommand[0] = 0x40;
+    byCommand[1] = (USIGN8)((USIGN32)(size_t)pbyRaw & 0xFF);
+    byCommand[2] = (USIGN8)(((USIGN32)(size_t)pbyRaw >> 8) & 0xFF);
+    byCommand[3] = SIM_TEST_SPI_RAW_LEN;
+    byCommand[4] = 0x00;
+    for (idx = 0; idx < SIM_TEST_SPI_RAW_LEN; idx++)
+    {
+        byCommand[CMD_MEM_LEN + idx] = (USIGN8)(0xC0 + SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN + idx);
+    }
+    SIM_TEST_CHECK(TPS_SPI_WriteData(byCommand, sizeof(byCommand)) == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_GetValueData(SIM_TEST_SPI_AREA, pbyRead, SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN) == TPS_ACTION_OK);
+
+    /* Whole command buffer: read MEM, the data overwrites the buffer.      */
+    /*----------------------------------------------------------------------*/
+    byCommand[0] = 0x80;
+    memset(&byCommand[CMD_MEM_LEN], 0x00, SIM_TEST_SPI_RAW_LEN);
+    SIM_TEST_CHECK(TPS_SPI_ReadData(byCommand, sizeof(byCommand)) == TPS_ACTION_OK);
+    memcpy(&pbyRead[SIM_TEST_SPI_DATA_LEN + SIM_TEST_SPI_FILL_LEN], &byCommand[CMD_MEM_LEN], SIM_TEST_SPI_RAW_LEN);
+
+    SIM_TEST_CHECK(TPS_GetValue16(pbyRaw + SIM_TEST_SPI_RAW_LEN, &wValue) == TPS_ACTION_OK);
+    memcpy(&pbyRead[SIM_TEST_SPI_READ_LEN - 2], &wValue, 2);
+
+    *pdwTraceLength = TPS_SimTraceStop();
+    TPS_SimGetCounters(pzCounters);
+
+    TPS_SPI_SetFraming(bySaveFraming);
+}
+
+#ifdef TPS_PROFILING
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestProfile()
+**
+** DESCRIPTION:   Feeds measurements with known durations into the profiling
+**                table over a fake cycle source: count, min, max, mean and
+**                bytes of a point, a wrap of the 32 bit counter during a
+**                measurement, invalid points and the reset.
+**
+*******************************************************************************
+*/
+static VOID locSimTestProfile(VOID)
+{
+    T_TPS_PROFILE_ENTRY zEntry;
+    USIGN32 dwStart;
+
+    TPS_ProfileSetCycleSource(locSimTestGetCycles);
+    TPS_ProfileInit();
+
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, &zEntry) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zEntry.dwCount == 0);
+    SIM_TEST_CHECK(TPS_ProfileGetMeanCycles(&zEntry) == 0);
+
+    /* 100, 300 and 50 cycles                                               */
+    /*----------------------------------------------------------------------*/
+    g_dwSimTestCycles = 1000;
+    dwStart = TPS_ProfileGetCycles();
+    g_dwSimTestCycles += 100;
+    TPS_ProfileAdd(TPS_PROFILE_SPI_READ, dwStart, 8);
+
+    dwStart = TPS_ProfileGetCycles();
+    g_dwSimTestCycles += 300;
+    TPS_ProfileAdd(TPS_PROFILE_SPI_READ, dwStart, 16);
+
+    dwStart = TPS_ProfileGetCycles();
+    g_dwSimTestCycles += 50;
+    TPS_ProfileAdd(TPS_PROFILE_SPI_READ, dwStart, 0);
+
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, &zEntry) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zEntry.dwCount == 3);
+    SIM_TEST_CHECK(zEntry.dwMinCycles == 50);
+    SIM_TEST_CHECK(zEntry.dwMaxCycles == 300);
+    SIM_TEST_CHECK(zEntry.qwTotalCycles == 450);
+    SIM_TEST_CHECK(zEntry.dwTotalBytes == 24);
+    SIM_TEST_CHECK(TPS_ProfileGetMeanCycles(&zEntry) == 150);
+
+    /* The counter wraps during the measurement: 0x20 cycles.               */
+    /*----------------------------------------------------------------------*/
+    g_dwSimTestCycles = 0xFFFFFFF0;
+    dwStart = TPS_ProfileGetCycles();
+    g_dwSimTestCycles += 0x20;
+    TPS_ProfileAdd(TPS_PROFILE_ALARM_ACK, dwStart, 0);
+
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_ALARM_ACK, &zEntry) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zEntry.dwCount == 1);
+    SIM_TEST_CHECK(zEntry.dwMinCycles == 0x20);
+    SIM_TEST_CHECK(zEntry.dwMaxCycles == 0x20);
+
+    /* Invalid points are ignored and rejected, the other points untouched. */
+    /*----------------------------------------------------------------------*/
+    TPS_ProfileAdd(TPS_PROFILE_NUMBER_OF_POINTS, dwStart, 0);
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_NUMBER_OF_POINTS, &zEntry) == API_WRONG_PARAMETER);
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, NULL) == API_WRONG_PARAMETER);
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_WRITE, &zEntry) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zEntry.dwCount == 0);
+
+    TPS_ProfileReset();
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, &zEntry) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zEntry.dwCount == 0) && (zEntry.qwTotalCycles == 0) && (zEntry.dwTotalBytes == 0));
+    SIM_TEST_CHECK((zEntry.dwMinCycles == 0xFFFFFFFF) && (zEntry.dwMaxCycles == 0));
+
+    TPS_ProfileSetCycleSource(TPS_SimGetCycles);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestProfileSpi()
+**
+** DESCRIPTION:   The SPI accessors feed the read and write points with the
+**                clock of the TPS-1 model, which advances with every SPI
+**                byte.
+**
+*******************************************************************************
+*/
+static VOID locSimTestProfileSpi(VOID)
+{
+    USIGN8  byData[SIM_TEST_SPI_DATA_LEN];
+    T_TPS_PROFILE_ENTRY zRead;
+    T_TPS_PROFILE_ENTRY zWrite;
+
+    memset(byData, 0x5A, sizeof(byData));
+    TPS_ProfileInit();
+
+    SIM_TEST_CHECK(TPS_SetValueData(SIM_TEST_SPI_AREA, byData, SIM_TEST_SPI_DATA_LEN) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_GetValueData(SIM_TEST_SPI_AREA, byData, SIM_TEST_SPI_DATA_LEN) == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, &zRead) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_ProfileGetEntry(TPS_PROFILE_SPI_WRITE, &zWrite) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zRead.dwCount == 1);
+    SIM_TEST_CHECK(zWrite.dwCount == 1);
+    SIM_TEST_CHECK(zRead.dwTotalBytes == SIM_TEST_SPI_DATA_LEN + CMD_MEM_LEN);
+    SIM_TEST_CHECK(zWrite.dwTotalBytes == SIM_TEST_SPI_DATA_LEN + CMD_MEM_LEN);
+    SIM_TEST_CHECK(zRead.dwMinCycles >= (SIM_TEST_SPI_DATA_LEN + CMD_MEM_LEN) * TPS_SIM_CYCLES_PER_SPI_BYTE);
+    SIM_TEST_CHECK(zWrite.dwMinCycles >= (SIM_TEST_SPI_DATA_LEN + CMD_MEM_LEN) * TPS_SIM_CYCLES_PER_SPI_BYTE);
+}
+
+static USIGN32 locSimTestGetCycles(VOID)
+{
+    return g_dwSimTestCycles;
+}
+#endif /* TPS_PROFILING */
+
+#ifdef USE_DIAG_INDEX
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestDiagIndex()
+**
+** DESCRIPTION:   Diagnosis entries of one subslot through the host side
+**                index: a batch writes its entries without reading the
+**                buffer, the key is checked, a removed entry is reused after
+**                the acknowledge of the TPS-1 (also when the subslot is
+**                full), the alarms of a batch are sent in the order of its
+**                changes and a pull frees all entries (within a batch also
+**                without raising the event before the commit).
+**
+*******************************************************************************
+*/
+static VOID locSimTestDiagIndex(VOID)
+{
+    T_TPS_SIM_COUNTERS zCounters;
+    USIGN32 dwDiagAddress[4];
+    USIGN32 dwAddress;
+    USIGN32 dwEvents = 0;
+    USIGN16 wChannel;
+    USIGN16 wProperties = 0;
+    USIGN16 wOtherProperties = 0;
+    USIGN16 wOwner = 0;
+    USIGN8  byFlags = EMPTY_ENTRY;
+    SUBSLOT* pzSubslot = locSimTestConfigure(4);
+
+    SIM_TEST_CHECK(pzSubslot != NULL);
+    if (pzSubslot == NULL)
+    {
+        return;
+    }
+
+    SIM_TEST_CHECK(TPS_DiagSetChannelProperties(&wProperties, 0, 0, MAINTENANCE_DIAGNOSIS, APPEARS, DIAG_DIRECTION_INPUT) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagSetChannelProperties(&wOtherProperties, 0, 0, MAINTENANCE_REQUIRED, APPEARS, DIAG_DIRECTION_INPUT) == TPS_ACTION_OK);
+
+    /* A full batch: no read of the diagnosis buffer, one write per entry.  */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_DiagBatchBegin() == TPS_ACTION_OK);
+    TPS_SimResetCounters();
+    for (wChannel = 0; wChannel < 4; wChannel++)
+    {
+        dwDiagAddress[wChannel] = TPS_DiagChannelAdd(pzSubslot, wChannel, wProperties, 0x0010, 0, 0);
+        SIM_TEST_CHECK(dwDiagAddress[wChannel] == (USIGN32)(size_t)(pzSubslot->pt_chan_diag + (wChannel * sizeof(DPR_DIAG_ENTRY))));
+    }
+    TPS_SimGetCounters(&zCounters);
+    SIM_TEST_CHECK(zCounters.dwReadCommands == 0);
+    SIM_TEST_CHECK(zCounters.dwWriteCommands == 4);
+
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 4, wProperties, 0x0010, 0, 0) == 0);
+    SIM_TEST_CHECK(TPS_GetLastError() == API_DIAG_ADD_DIAG_LIST_FULL);
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 1, wProperties, 0x0010, 0, 0) == 0);
+    SIM_TEST_CHECK(TPS_GetLastError() == API_DIAG_ADD_ENTRY_ALREADY_EXISTS);
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 1, wOtherProperties, 0x0010, 0, 0) == 0);
+    SIM_TEST_CHECK(TPS_GetLastError() == API_DIAG_EXISTS_BUT_DIFFERS);
+    SIM_TEST_CHECK(TPS_DiagBatchCommit() == TPS_ACTION_OK);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    /* A removed entry is taken again after its acknowledge: only the flags */
+    /* of the removed entry and the event register (check, set) are read.   */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_DiagChannelRemove(dwDiagAddress[1]) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 1, wProperties, 0x0010, 0, 0) == 0);
+    SIM_TEST_CHECK(TPS_GetLastError() == API_DIAG_ADD_EVENT_IN_USE);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    TPS_SimResetCounters();
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 1, wProperties, 0x0010, 0, 0) == dwDiagAddress[1]);
+    TPS_SimGetCounters(&zCounters);
+    SIM_TEST_CHECK(zCounters.dwReadCommands == 3);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    /* The subslot is full: the removed entry of another key is collected.  */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_DiagChannelRemove(dwDiagAddress[2]) == TPS_ACTION_OK);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    TPS_SimResetCounters();
+    SIM_TEST_CHECK(TPS_DiagChannelAdd(pzSubslot, 7, wProperties, 0x0010, 0, 0) == dwDiagAddress[2]);
+    TPS_SimGetCounters(&zCounters);
+    SIM_TEST_CHECK(zCounters.dwReadCommands == 3);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    /* The alarms of a batch in the order of its changes: the removed entry */
+    /* has none, the mailbox takes one alarm until its acknowledge.         */
+    /*----------------------------------------------------------------------*/
+    TPS_GetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, &wOwner);
+    SIM_TEST_CHECK(TPS_SetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, OWNED_BY_AR(AR_0)) == TPS_ACTION_OK);
+    g_dwSimTestAlarmAcks = 0;
+    SIM_TEST_CHECK(TPS_RegisterAlarmDiagCallback(ONALARM_CB, locSimTestOnAlarmAck) == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_DiagBatchBegin() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagChannelRemove(dwDiagAddress[3]) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagSetChangeState(dwDiagAddress[0], MAINTENANCE_DIAGNOSIS, DISAPPEARS) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagSetChangeState(dwDiagAddress[1], MAINTENANCE_REQUIRED, APPEARS) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_DiagBatchSendAlarms(AR_0, ALARM_LOW, 0x0400) == API_DIAG_BATCH_STILL_OPEN);
+    SIM_TEST_CHECK(TPS_DiagBatchCommit() == TPS_ACTION_OK);
+    locSimTestDiagAck(pzSubslot, 4);
+
+    SIM_TEST_CHECK(TPS_DiagBatchSendAlarms(AR_0, ALARM_LOW, 0x0400) == API_ALARM_MAILBOX_IN_USE);
+    SIM_TEST_CHECK(g_dwSimTestAlarmAcks == 0);
+    TPS_CheckEvents();
+    SIM_TEST_CHECK(TPS_DiagBatchSendAlarms(AR_0, ALARM_LOW, 0x0400) == TPS_ACTION_OK);
+    TPS_CheckEvents();
+    SIM_TEST_CHECK(TPS_DiagBatchSendAlarms(AR_0, ALARM_LOW, 0x0400) == TPS_ACTION_OK);
+    TPS_CheckEvents();
+
+    SIM_TEST_CHECK(g_dwSimTestAlarmAcks == 2);
+    SIM_TEST_CHECK((g_wSimTestAlarmHandle[0] == 0x0401) && (g_dwSimTestAlarmResponse[0] == ACK_FLAG));
+    SIM_TEST_CHECK((g_wSimTestAlarmHandle[1] == 0x0402) && (g_dwSimTestAlarmResponse[1] == ACK_FLAG));
+
+    SIM_TEST_CHECK(TPS_SetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, wOwner) == TPS_ACTION_OK);
+
+#ifdef PLUG_RETURN_SUBMODULE_ENABLE
+    /* A pull clears the diagnosis buffer and frees all entries. Within a   */
+    /* batch the event waits for the commit.                                */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_DiagBatchBegin() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_PullSubmodule(API_0, 1, 1) == TPS_ACTION_OK);
+    TPS_SimReadMem(EVENT_REGISTER_APP, (USIGN8*)&dwEvents, 4);
+    SIM_TEST_CHECK((dwEvents & (0x01UL << APP_EVENT_DIAG_CHANGED)) == 0);
+    SIM_TEST_CHECK(TPS_DiagBatchCommit() == TPS_ACTION_OK);
+    TPS_SimReadMem(EVENT_REGISTER_APP, (USIGN8*)&dwEvents, 4);
+    SIM_TEST_CHECK((dwEvents & (0x01UL << APP_EVENT_DIAG_CHANGED)) != 0);
+    for (wChannel = 0; wChannel < 4; wChannel++)
+    {
+        TPS_SimReadMem(dwDiagAddress[wChannel] + offsetof(DPR_DIAG_ENTRY, byFlags), &byFlags, 1);
+        SIM_TEST_CHECK(byFlags == EMPTY_ENTRY);
+    }
+    locSimTestDiagAck(pzSubslot, 4);
+    SIM_TEST_CHECK(TPS_DiagChannelRemove(dwDiagAddress[0]) == API_DIAG_REMOVE_NO_ACK);
+
+    SIM_TEST_CHECK(TPS_DiagBatchBegin() == TPS_ACTION_OK);
+    for (wChannel = 0; wChannel < 4; wChannel++)
+    {
+        dwAddress = TPS_DiagChannelAdd(pzSubslot, wChannel, wProperties, 0x0010, 0, 0);
+        SIM_TEST_CHECK(dwAddress == dwDiagAddress[wChannel]);
+    }
+    SIM_TEST_CHECK(TPS_DiagBatchCommit() == TPS_ACTION_OK);
+#else
+    (VOID)dwAddress;
+    (VOID)dwEvents;
+    (VOID)byFlags;
+#endif
+
+    TPS_CleanApiConf();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestDiagAck()
+**
+** DESCRIPTION:   Acts as the TPS-1 on APP_EVENT_DIAG_CHANGED: acknowledges
+**                the appeared and disappeared entries of the subslot and
+**                clears the event.
+**
+*******************************************************************************
+*/
+static VOID locSimTestDiagAck(SUBSLOT* pzSubslot, USIGN16 wNumberOfEntries)
+{
+    USIGN32 dwFlags;
+    USIGN32 dwEvents = 0;
+    USIGN16 wEntry;
+    USIGN8  byFlags = EMPTY_ENTRY;
+
+    for (wEntry = 0; wEntry < wNumberOfEntries; wEntry++)
+    {
+        dwFlags = (USIGN32)(size_t)(pzSubslot->pt_chan_diag + (wEntry * sizeof(DPR_DIAG_ENTRY))) + offsetof(DPR_DIAG_ENTRY, byFlags);
+
+        TPS_SimReadMem(dwFlags, &byFlags, 1);
+        if ((byFlags == APPEAR_FLAG) || (byFlags == DISAPPEAR_FLAG))
+        {
+            byFlags = (USIGN8)(byFlags << 1);
+            TPS_SimWriteMem(dwFlags, &byFlags, 1);
+        }
+    }
+
+    TPS_SimReadMem(EVENT_REGISTER_APP, (USIGN8*)&dwEvents, 4);
+    dwEvents &= ~(0x01UL << APP_EVENT_DIAG_CHANGED);
+    TPS_SimWriteMem(EVENT_REGISTER_APP, (const USIGN8*)&dwEvents, 4);
+}
+#endif /* USE_DIAG_INDEX */
+
+#ifdef USE_BUFFER_POOL
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestBufferPool()
+**
+** DESCRIPTION:   Takes all blocks, checks that they are aligned and do not
+**                overlap, that the pool is then exhausted and that invalid
+**                and double frees are refused. Then SIM_TEST_POOL_ROUNDS
+**                pseudo random allocs and frees of random length, each
+**                block filled with its own pattern which must still be
+**                there when the block is freed.
+**
+*******************************************************************************
+*/
+static VOID locSimTestBufferPool(VOID)
+{
+    USIGN8*                  pbyBlock[BUFFER_POOL_BLOCKS];
+    USIGN32                  dwLength[BUFFER_POOL_BLOCKS];
+    USIGN8                   byForeign[4];
+    USIGN32                  dwBlock;
+    USIGN32                  dwOther;
+    USIGN32                  dwRound;
+    USIGN32                  dwByte;
+    USIGN32                  dwRandom = 0x12345678;
+    USIGN32                  dwAllocs = 0;
+    USIGN32                  dwBadBytes = 0;
+    T_BUFFER_POOL_STATISTICS zStatistics;
+
+    TPS_CleanApiConf();
+
+    for (dwBlock = 0; dwBlock < BUFFER_POOL_BLOCKS; dwBlock++)
+    {
+        pbyBlock[dwBlock] = TPS_BufferPoolAlloc(BUFFER_POOL_BLOCK_SIZE);
+        SIM_TEST_CHECK(pbyBlock[dwBlock] != NULL);
+        SIM_TEST_CHECK(((size_t)pbyBlock[dwBlock] & 3) == 0);
+
+        for (dwOther = 0; dwOther < dwBlock; dwOther++)
+        {
+            SIM_TEST_CHECK((pbyBlock[dwBlock] + BUFFER_POOL_BLOCK_SIZE <= pbyBlock[dwOther]) ||
+                           (pbyBlock[dwOther] + BUFFER_POOL_BLOCK_SIZE <= pbyBlock[dwBlock]));
+        }
+    }
+
+    SIM_TEST_CHECK(TPS_BufferPoolAlloc(1) == NULL);
+
+    SIM_TEST_CHECK(TPS_BufferPoolFree(NULL) == API_BUFFER_POOL_INVALID_BUFFER);
+    SIM_TEST_CHECK(TPS_BufferPoolFree(byForeign) == API_BUFFER_POOL_INVALID_BUFFER);
+    SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[0] + 1) == API_BUFFER_POOL_INVALID_BUFFER);
+    SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[0]) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[0]) == API_BUFFER_POOL_INVALID_BUFFER);
+
+    /* Too long for a block, even with a free block.                         */
+    SIM_TEST_CHECK(TPS_BufferPoolAlloc(BUFFER_POOL_BLOCK_SIZE + 1) == NULL);
+
+    for (dwBlock = 1; dwBlock < BUFFER_POOL_BLOCKS; dwBlock++)
+    {
+        SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[dwBlock]) == TPS_ACTION_OK);
+    }
+
+    SIM_TEST_CHECK(TPS_GetBufferPoolStatistics(NULL) == API_BUFFER_POOL_NULL_POINTER);
+    SIM_TEST_CHECK(TPS_GetBufferPoolStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.dwAllocs == BUFFER_POOL_BLOCKS);
+    SIM_TEST_CHECK(zStatistics.dwFailures == 2);
+    SIM_TEST_CHECK(zStatistics.dwMaxLength == BUFFER_POOL_BLOCK_SIZE + 1);
+    SIM_TEST_CHECK(zStatistics.wInUse == 0);
+    SIM_TEST_CHECK(zStatistics.wMaxInUse == BUFFER_POOL_BLOCKS);
+
+    /* Hammer: slot n of the shadow table is free if pbyBlock[n] is NULL.    */
+    /*-----------------------------------------------------------------------*/
+    memset(pbyBlock, 0, sizeof(pbyBlock));
+
+    for (dwRound = 0; dwRound < SIM_TEST_POOL_ROUNDS; dwRound++)
+    {
+        dwRandom = dwRandom * 1103515245 + 12345;
+        dwBlock = (dwRandom >> 16) % BUFFER_POOL_BLOCKS;
+
+        if (pbyBlock[dwBlock] == NULL)
+        {
+            dwLength[dwBlock] = 1 + ((dwRandom >> 4) % BUFFER_POOL_BLOCK_SIZE);
+            pbyBlock[dwBlock] = TPS_BufferPoolAlloc(dwLength[dwBlock]);
+            SIM_TEST_CHECK(pbyBlock[dwBlock] != NULL);
+            if (pbyBlock[dwBlock] != NULL)
+            {
+                memset(pbyBlock[dwBlock], (USIGN8)(dwBlock + dwRound), dwLength[dwBlock]);
+                pbyBlock[dwBlock][0] = (USIGN8)dwBlock;
+                dwAllocs++;
+            }
+        }
+        else
+        {
+            for (dwByte = 1; dwByte < dwLength[dwBlock]; dwByte++)
+            {
+                if (pbyBlock[dwBlock][dwByte] != pbyBlock[dwBlock][1])
+                {
+                    dwBadBytes++;
+                }
+            }
+            SIM_TEST_CHECK(pbyBlock[dwBlock][0] == (USIGN8)dwBlock);
+            SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[dwBlock]) == TPS_ACTION_OK);
+            pbyBlock[dwBlock] = NULL;
+        }
+    }
+
+    SIM_TEST_CHECK(dwBadBytes == 0);
+
+    for (dwBlock = 0; dwBlock < BUFFER_POOL_BLOCKS; dwBlock++)
+    {
+        if (pbyBlock[dwBlock] != NULL)
+        {
+            SIM_TEST_CHECK(TPS_BufferPoolFree(pbyBlock[dwBlock]) == TPS_ACTION_OK);
+        }
+    }
+
+    SIM_TEST_CHECK(TPS_GetBufferPoolStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.dwAllocs == BUFFER_POOL_BLOCKS + dwAllocs);
+    SIM_TEST_CHECK(zStatistics.dwFailures == 2);
+    SIM_TEST_CHECK(zStatistics.wInUse == 0);
+}
+#endif
+
+#if defined(USE_ETHERNET_INTERFACE) && defined(USE_ETHERNET_TX_QUEUE)
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestEthTxQueue()
+**
+** DESCRIPTION:   Parameter checks of TPS_QueueEthernetFrame(), then the ring
+**                of the ethernet queue (ETH_TX_QUEUE_SIZE bytes): a frame
+**                that does not fit behind the last one starts at offset 0
+**                once the frames there are sent, the depth limits the
+**                number of small frames.
+**
+*******************************************************************************
+*/
+static VOID locSimTestEthTxQueue(VOID)
+{
+    static USIGN8             byFrame[MAX_LEN_ETHERNET_FRAME + 1];
+    T_ETH_TX_QUEUE_STATISTICS zStatistics;
+    USIGN32                   dwFrame;
+
+    memset(byFrame, 0x5A, sizeof(byFrame));
+
+    SIM_TEST_CHECK(locSimTestConfigure(0) != NULL);
+    SIM_TEST_CHECK(TPS_InitEthernetChannel() == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(NULL, 60, PORT_ANY) == ETH_TX_QUEUE_INVALID_PARAM);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 0, PORT_ANY) == ETH_TX_QUEUE_INVALID_PARAM);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, MAX_LEN_ETHERNET_FRAME + 1, PORT_ANY) == ETH_SEND_FRAME_TOO_LONG);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 60, 0x10) == ETH_INVALID_PORT);
+
+    /* 1000 + 500 bytes at the start of the ring, 600 do not fit.            */
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 1000, PORT_ANY) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 600, PORT_ANY) == ETH_TX_QUEUE_FULL);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 500, PORT_ANY) == TPS_ACTION_OK);
+
+    /* The second frame waits until the TPS-1 has taken the first one.       */
+    SIM_TEST_CHECK(TPS_ServiceEthernetTxQueue(ETH_TX_QUEUE_SIZE) == 1000);
+    SIM_TEST_CHECK(TPS_ServiceEthernetTxQueue(ETH_TX_QUEUE_SIZE) == 0);
+
+    /* In front of the 500 bytes at offset 1000.                             */
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 600, PORT_ANY) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 400, PORT_ANY) == ETH_TX_QUEUE_FULL);
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 399, PORT_ANY) == TPS_ACTION_OK);
+
+    locSimTestEthTxAck();
+    SIM_TEST_CHECK(TPS_ServiceEthernetTxQueue(ETH_TX_QUEUE_SIZE) == 500);
+    locSimTestEthTxAck();
+    SIM_TEST_CHECK(TPS_ServiceEthernetTxQueue(ETH_TX_QUEUE_SIZE) == 600);
+    locSimTestEthTxAck();
+    SIM_TEST_CHECK(TPS_ServiceEthernetTxQueue(ETH_TX_QUEUE_SIZE) == 399);
+    locSimTestEthTxAck();
+
+    /* Empty: the ring starts again at offset 0, the depth limits.           */
+    for (dwFrame = 0; dwFrame < ETH_TX_QUEUE_DEPTH; dwFrame++)
+    {
+        SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 60, PORT_ANY) == TPS_ACTION_OK);
+    }
+    SIM_TEST_CHECK(TPS_QueueEthernetFrame(byFrame, 60, PORT_ANY) == ETH_TX_QUEUE_FULL);
+
+    SIM_TEST_CHECK(TPS_GetEthernetTxQueueStatistics(ETH_TX_QUEUE_ETHERNET, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.dwFrames == 4);
+    SIM_TEST_CHECK(zStatistics.dwBytes == 1000 + 500 + 600 + 399);
+    SIM_TEST_CHECK(zStatistics.dwRetries == 4);
+    SIM_TEST_CHECK(zStatistics.dwMaxWait == 3);
+
+    TPS_CleanApiConf();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestEthTxAck()
+**
+** DESCRIPTION:   Acts as the TPS-1: the frame of the ethernet TX mailbox is
+**                sent, APP_EVENT_ETH_FRAME_SEND is cleared.
+**
+*******************************************************************************
+*/
+static VOID locSimTestEthTxAck(VOID)
+{
+    USIGN32 dwEvents = 0;
+
+    TPS_SimReadMem(EVENT_REGISTER_APP, (USIGN8*)&dwEvents, 4);
+    dwEvents &= ~(0x01UL << APP_EVENT_ETH_FRAME_SEND);
+    TPS_SimWriteMem(EVENT_REGISTER_APP, (const USIGN8*)&dwEvents, 4);
+}
+#endif
+
+#ifdef USE_ALARM_QUEUE
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestAlarmQueue()
+**
+** DESCRIPTION:   Alarms of one AR through the alarm queue against the
+**                alarm acknowledges of the model: the queue of a busy
+**                mailbox, the full queue, the separate high priority lane,
+**                the order of the acknowledges and the abort of the AR.
+**
+*******************************************************************************
+*/
+static VOID locSimTestAlarmQueue(VOID)
+{
+    T_ALARM_QUEUE_STATISTICS zStatistics;
+    USIGN8  byData[ALARM_QUEUE_DATA_SIZE + 1];
+    USIGN32 dwAck;
+    USIGN32 dwPolls;
+    USIGN16 wAlarm;
+    USIGN16 wNextLow = 0x0100;
+    SUBSLOT* pzSubslot = locSimTestConfigure(0);
+
+    SIM_TEST_CHECK(pzSubslot != NULL);
+    if (pzSubslot == NULL)
+    {
+        return;
+    }
+
+    memset(byData, 0, sizeof(byData));
+    g_dwSimTestAlarmAcks = 0;
+    SIM_TEST_CHECK(TPS_RegisterAlarmDiagCallback(ONALARM_CB, locSimTestOnAlarmAck) == TPS_ACTION_OK);
+
+    /* Not queued while no AR owns the subslot, then it owns it as after   */
+    /* its connect request.                                                 */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, 0x00FF) == API_ALARM_SUBSLOT_NOT_USED_BY_AR);
+    SIM_TEST_CHECK(TPS_SetValue16((USIGN8*)pzSubslot->pt_wSubslotOwnedByAr, OWNED_BY_AR(AR_0)) == TPS_ACTION_OK);
+
+    /* The first alarm goes to the mailbox, the next ones wait.            */
+    /*----------------------------------------------------------------------*/
+    for (wAlarm = 0; wAlarm <= ALARM_QUEUE_DEPTH; wAlarm++)
+    {
+        byData[0] = (USIGN8)wAlarm;
+        SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, (USIGN16)(0x0100 + wAlarm)) == TPS_ACTION_OK);
+    }
+
+    byData[0] = ALARM_QUEUE_DEPTH;
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, 0x01FF) == API_ALARM_QUEUE_COALESCED);
+    byData[0] = 0x55;
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, 0x01FF) == API_ALARM_QUEUE_FULL);
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, sizeof(byData), byData, 0x0001, 0x01FF) == API_ALARM_QUEUE_DATA_TOO_LONG);
+
+    /* The high priority lane does not wait behind the low priority one.   */
+    /*----------------------------------------------------------------------*/
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_HIGH, PROCESS_ALARM, 4, byData, 0x0001, 0x0200) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_GetAlarmQueueStatistics(AR_0, ALARM_HIGH, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.dwSent == 1) && (zStatistics.dwQueued == 0));
+
+    SIM_TEST_CHECK(TPS_GetAlarmQueueStatistics(AR_0, ALARM_LOW, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.dwSent == 1) && (zStatistics.dwQueued == ALARM_QUEUE_DEPTH));
+    SIM_TEST_CHECK((zStatistics.wDepth == ALARM_QUEUE_DEPTH) && (zStatistics.wMaxDepth == ALARM_QUEUE_DEPTH));
+    SIM_TEST_CHECK((zStatistics.dwCoalesced == 1) && (zStatistics.dwOverflows == 1));
+
+    /* Each acknowledge of the model sends the next queued alarm.          */
+    /*----------------------------------------------------------------------*/
+    for (dwPolls = 0; (dwPolls < 20) && (g_dwSimTestAlarmAcks < ALARM_QUEUE_DEPTH + 2); dwPolls++)
+    {
+        TPS_CheckEvents();
+    }
+
+    SIM_TEST_CHECK(g_dwSimTestAlarmAcks == ALARM_QUEUE_DEPTH + 2);
+    for (dwAck = 0; (dwAck < g_dwSimTestAlarmAcks) && (dwAck < SIM_TEST_ALARM_ACKS); dwAck++)
+    {
+        SIM_TEST_CHECK(g_dwSimTestAlarmResponse[dwAck] == ACK_FLAG);
+        if (g_wSimTestAlarmHandle[dwAck] != 0x0200)
+        {
+            SIM_TEST_CHECK(g_wSimTestAlarmHandle[dwAck] == wNextLow);
+            wNextLow++;
+        }
+    }
+
+    SIM_TEST_CHECK(TPS_GetAlarmQueueStatistics(AR_0, ALARM_LOW, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.dwSent == ALARM_QUEUE_DEPTH + 1) && (zStatistics.dwAcks == ALARM_QUEUE_DEPTH + 1));
+    SIM_TEST_CHECK((zStatistics.wDepth == 0) && (zStatistics.dwDropped == 0));
+
+    /* The model acknowledges at once: each alarm waits one event check.   */
+    SIM_TEST_CHECK((zStatistics.dwLastAckPolls == 1) && (zStatistics.dwMaxAckPolls == 1));
+
+    /* The abort of the AR discards the queued alarm.                      */
+    /*----------------------------------------------------------------------*/
+    g_dwSimTestAlarmAcks = 0;
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, 0x0300) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_QueueAlarm(AR_0, 0, 1, 1, ALARM_LOW, PROCESS_ALARM, 4, byData, 0x0001, 0x0301) == TPS_ACTION_OK);
+    TPS_SimRaiseEvent(TPS_EVENT_ONABORT_IOAR0);
+    TPS_CheckEvents();
+
+    SIM_TEST_CHECK(TPS_GetAlarmQueueStatistics(AR_0, ALARM_LOW, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.wDepth == 0) && (zStatistics.dwDropped == 1));
+    SIM_TEST_CHECK((g_dwSimTestAlarmAcks >= 1) && (g_wSimTestAlarmHandle[0] == 0x0301) &&
+                   (g_dwSimTestAlarmResponse[0] == ALARM_QUEUE_DROPPED));
+
+    TPS_CleanApiConf();
+}
+#endif /* USE_ALARM_QUEUE */
+
+#if defined(USE_ALARM_QUEUE) || defined(USE_DIAG_INDEX)
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestOnAlarmAck()
+**
+** DESCRIPTION:   Alarm acknowledge callback: records the handles and the
+**                responses in the order of the acknowledges.
+**
+*******************************************************************************
+*/
+static VOID locSimTestOnAlarmAck(USIGN16 wUserHandle, USIGN32 dwResponse)
+{
+    if (g_dwSimTestAlarmAcks < SIM_TEST_ALARM_ACKS)
+    {
+        g_wSimTestAlarmHandle[g_dwSimTestAlarmAcks] = wUserHandle;
+        g_dwSimTestAlarmResponse[g_dwSimTestAlarmAcks] = dwResponse;
+    }
+    g_dwSimTestAlarmAcks++;
+}
+#endif
+
+#ifdef USE_STARTUP_SERVICE
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestStartup()
+**
+** DESCRIPTION:   Startup state machine against a TPS-1 model whose stack
+**                is up after 30 ms and which confirms the configuration
+**                5 ms after APP_EVENT_CONFIG_FINISHED. With the backoff of
+**                1, 2, 4, 8, 8, ... ms the stack is polled at 0, 1, 3, 7,
+**                15, 23 and 31 ms, TPS_StartDevice() 0, 1, 3 and 7 ms after
+**                the configuration.
+**
+*******************************************************************************
+*/
+static VOID locSimTestStartup(VOID)
+{
+    T_STARTUP_TIMES zTimes;
+    USIGN32         dwResult = TPS_ACTION_OK;
+    USIGN32         dwWaitMs = 0;
+#ifdef TPS_EVENT_IRQ_MODE
+    USIGN32         dwIrqMask = 0;
+#endif
+
+    TPS_CleanApiConf();
+    TPS_SimSetStartupTimes(SIM_TEST_STACK_UP_MS, SIM_TEST_START_ACK_MS);
+
+    SIM_TEST_CHECK(TPS_StartupService() == API_STARTUP_NOT_STARTED);
+    SIM_TEST_CHECK(TPS_StartupBegin(NULL, locSimTestGetTimeMs) == API_STARTUP_NULL_POINTER);
+    SIM_TEST_CHECK(TPS_StartupBegin(locSimTestStartupConfigure, locSimTestGetTimeMs) == TPS_ACTION_OK);
+
+    while (((dwResult = TPS_StartupService()) == API_STARTUP_BUSY) && (dwWaitMs < SIM_TEST_STARTUP_LIMIT_MS))
+    {
+        TPS_SimDelay(1);
+        dwWaitMs++;
+    }
+    SIM_TEST_CHECK(dwResult == TPS_ACTION_OK);
+
+    SIM_TEST_CHECK(TPS_GetStartupTimes(&zTimes) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zTimes.byPhase == STARTUP_RUNNING);
+    SIM_TEST_CHECK(zTimes.dwStackPolls == 7);
+    SIM_TEST_CHECK(zTimes.dwStartPolls == 4);
+    SIM_TEST_CHECK(zTimes.dwStackUpMs == 31);
+    SIM_TEST_CHECK((zTimes.dwStartAckMs - zTimes.dwConfigWrittenMs) == 7);
+    SIM_TEST_CHECK(zTimes.dwFirstArMs == STARTUP_TIME_NONE);
+
+#ifdef TPS_EVENT_IRQ_MODE
+    /* The host interrupt is enabled when the stack is up.                   */
+    TPS_SimReadMem(HOST_IRQ_MASK_HIGH, (USIGN8*)&dwIrqMask, sizeof(dwIrqMask));
+    SIM_TEST_CHECK(dwIrqMask == HOST_IRQ_MASK_ALL_ENABLED);
+#endif
+
+    TPS_CleanApiConf();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestStartupConfigure()
+**
+** DESCRIPTION:   Configuration callback of the startup state machine.
+**
+** Return_Type:   USIGN32 (TPS_ACTION_OK or TPS_GetLastError())
+**
+*******************************************************************************
+*/
+static USIGN32 locSimTestStartupConfigure(VOID)
+{
+    return (locSimTestConfigure(0) != NULL) ? TPS_ACTION_OK : TPS_GetLastError();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestGetTimeMs()
+**
+** DESCRIPTION:   Time source of the startup state machine: model clock.
+**
+** Return_Type:   USIGN32 (ms)
+**
+*******************************************************************************
+*/
+static USIGN32 locSimTestGetTimeMs(VOID)
+{
+    return TPS_SimGetCycles() / TPS_SIM_CYCLES_PER_MS;
+}
+#endif /* USE_STARTUP_SERVICE */
+
+#ifdef USE_CONFIG_IMAGE
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestConfigImage()
+**
+** DESCRIPTION:   Stores the image of a configuration, restarts the TPS-1
+**                model and replays the image: the DPRAM is the same as
+**                after the first start, with fewer SPI writes, and the
+**                image built again is the same. A changed configuration
+**                with the old image ends with a mismatch. As the example
+**                application, the image is then erased and the next start
+**                gives the DPRAM of the changed configuration.
+**
+*******************************************************************************
+*/
+static VOID locSimTestConfigImage(VOID)
+{
+    T_CONFIG_IMAGE_STATISTICS zStatistics;
+    T_TPS_SIM_COUNTERS        zFirstStart;
+    T_TPS_SIM_COUNTERS        zReplay;
+    USIGN32                   dwImageLength[2] = {0, 0};
+
+    /* DPRAM of the changed configuration (2 diagnosis entries).             */
+    SIM_TEST_CHECK(locSimTestConfigure(2) != NULL);
+    TPS_SimReadMem(BASE_ADDRESS_NRT_AREA, g_bySimTestDpram[0], BASE_NRT_AREA_SIZE);
+
+    /* First start: no image, the image is built and stored.                 */
+    TPS_SimInit(NULL, 0);
+    SIM_TEST_CHECK(TPS_LoadConfigImage(g_bySimTestImage[0]) == TPS_ERROR_WRONG_API_STATE);
+    SIM_TEST_CHECK(locSimTestConfigure(0) != NULL);
+    TPS_SimGetCounters(&zFirstStart);
+    SIM_TEST_CHECK(TPS_BuildConfigImage(g_bySimTestImage[0], CONFIG_IMAGE_MAX_SIZE, &dwImageLength[0]) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(dwImageLength[0] != 0);
+    if (dwImageLength[0] == 0)
+    {
+        /* Without an image the replay checks below have no data.            */
+        TPS_CleanApiConf();
+        return;
+    }
+    TPS_SimReadMem(BASE_ADDRESS_NRT_AREA, g_bySimTestDpram[1], BASE_NRT_AREA_SIZE);
+
+    /* Restart with the image.                                               */
+    locSimTestConfigImageStart(g_bySimTestImage[0], 0);
+    TPS_SimGetCounters(&zReplay);
+    SIM_TEST_CHECK(TPS_GetConfigImageStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.byState == CONFIG_IMAGE_REPLAY);
+    SIM_TEST_CHECK(zStatistics.dwDpramBytes != 0);
+    SIM_TEST_CHECK(zStatistics.dwWritesSuppressed != 0);
+    SIM_TEST_CHECK(zReplay.dwWriteCommands < zFirstStart.dwWriteCommands);
+
+    SIM_TEST_CHECK(TPS_BuildConfigImage(g_bySimTestImage[1], CONFIG_IMAGE_MAX_SIZE, &dwImageLength[1]) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_GetConfigImageStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.byState == CONFIG_IMAGE_REPLAYED);
+    SIM_TEST_CHECK(dwImageLength[1] == dwImageLength[0]);
+    SIM_TEST_CHECK(memcmp(g_bySimTestImage[1], g_bySimTestImage[0], dwImageLength[0]) == 0);
+    TPS_SimReadMem(BASE_ADDRESS_NRT_AREA, g_bySimTestDpram[2], BASE_NRT_AREA_SIZE);
+    SIM_TEST_CHECK(memcmp(g_bySimTestDpram[2], g_bySimTestDpram[1], BASE_NRT_AREA_SIZE) == 0);
+
+    /* Restart with the image and a changed configuration, then with the    */
+    /* erased image.                                                         */
+    locSimTestConfigImageStart(g_bySimTestImage[0], 2);
+    SIM_TEST_CHECK(TPS_GetConfigImageStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.byState == CONFIG_IMAGE_MISMATCH);
+
+    memset(g_bySimTestImage[1], 0xFF, CONFIG_IMAGE_MAX_SIZE);
+    TPS_SimInit(NULL, 0);
+    TPS_CleanApiConf();
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_LoadConfigImage(g_bySimTestImage[1]) == API_CONFIG_IMAGE_INVALID);
+    SIM_TEST_CHECK(locSimTestConfigDevice(2) != NULL);
+    SIM_TEST_CHECK(TPS_GetConfigImageStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.byState == CONFIG_IMAGE_NOT_LOADED);
+    TPS_SimReadMem(BASE_ADDRESS_NRT_AREA, g_bySimTestDpram[2], BASE_NRT_AREA_SIZE);
+    SIM_TEST_CHECK(memcmp(g_bySimTestDpram[2], g_bySimTestDpram[0], BASE_NRT_AREA_SIZE) == 0);
+
+    /* A damaged image is not written.                                       */
+    TPS_SimInit(NULL, 0);
+    TPS_CleanApiConf();
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    g_bySimTestImage[0][dwImageLength[0] - 1] ^= 0x01;
+    SIM_TEST_CHECK(TPS_LoadConfigImage(g_bySimTestImage[0]) == API_CONFIG_IMAGE_CHECKSUM);
+    SIM_TEST_CHECK(TPS_GetConfigImageStatistics(&zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(zStatistics.byState == CONFIG_IMAGE_NOT_LOADED);
+
+    TPS_CleanApiConf();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestConfigImageStart()
+**
+** DESCRIPTION:   Restart of the host and the TPS-1 model, the device is
+**                configured with the loaded image.
+**
+** PARAMETER:     const USIGN8* pbyImage (stored image)
+**                USIGN16 wNumberOfChannelDiag (see locSimTestConfigure())
+**
+*******************************************************************************
+*/
+static VOID locSimTestConfigImageStart(const USIGN8* pbyImage, USIGN16 wNumberOfChannelDiag)
+{
+    TPS_SimInit(NULL, 0);
+    TPS_CleanApiConf();
+
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_LoadConfigImage(pbyImage) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(locSimTestConfigDevice(wNumberOfChannelDiag) != NULL);
+}
+#endif /* USE_CONFIG_IMAGE */
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestConfigure()
+**
+** DESCRIPTION:   Configures a device with the DAP and one submodule in
+**                slot 1 / subslot 1 with 1 byte input and output data.
+**
+** Return_Type:   SUBSLOT* (subslot 1 of slot 1 or NULL on an error)
+**
+** PARAMETER:     USIGN16 wNumberOfChannelDiag (diagnosis entries of the
+**                submodule)
+**
+*******************************************************************************
+*/
+static SUBSLOT* locSimTestConfigure(USIGN16 wNumberOfChannelDiag)
+{
+    TPS_CleanApiConf();
+
+    if (TPS_InitApplicationInterface() != TPS_ACTION_OK)
+    {
+        return NULL;
+    }
+
+    return locSimTestConfigDevice(wNumberOfChannelDiag);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestConfigDevice()
+**
+** DESCRIPTION:   The configDevice() of the tests, called after
+**                TPS_InitApplicationInterface(), see locSimTestConfigure().
+**
+** Return_Type:   SUBSLOT* (subslot 1 of slot 1 or NULL on an error)
+**
+** PARAMETER:     USIGN16 wNumberOfChannelDiag (diagnosis entries of the
+**                submodule)
+**
+*******************************************************************************
+*/
+static SUBSLOT* locSimTestConfigDevice(USIGN16 wNumberOfChannelDiag)
+{
+    T_DEVICE_SOFTWARE_VERSION zSoftwareVersion = {0};
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+
+    if (TPS_AddDevice(0x0001, 0x0001, (CHAR*)"TPS-1", &zSoftwareVersion) == TPS_ACTION_OK)
+    {
+        pzApi = TPS_AddAPI(API_0);
+    }
+    if (pzApi != NULL)
+    {
+        pzSlot = TPS_PlugModule(pzApi, DAP_MODULE, 0x00000001);
+    }
+    if (pzSlot != NULL)
+    {
+        pzSubslot = TPS_PlugSubmodule(pzSlot, DAP_SUBMODULE, 0x01, 0, 0, 0, 0, &g_zSimTestIM0, TPS_TRUE);
+    }
+    if (pzSubslot != NULL)
+    {
+        pzSlot = TPS_PlugModule(pzApi, 1, 0x00000010);
+        pzSubslot = NULL;
+    }
+    if (pzSlot != NULL)
+    {
+        pzSubslot = TPS_PlugSubmodule(pzSlot, 1, 0x11, 0, wNumberOfChannelDiag, 1, 1, &g_zSimTestIM0, TPS_FALSE);
+    }
+
+#ifdef USE_TPS_COMMUNICATION_CHANNEL
+    /* As TPSDriver.c, the channel leads to STATE_TPS_CHANNEL_RDY.           */
+    if ((pzSubslot != NULL) && (TPS_InitTPSComChannel() != TPS_ACTION_OK))
+    {
+        pzSubslot = NULL;
+    }
+#endif
+
+    return pzSubslot;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestObjectPool()
+**
+** DESCRIPTION:   Object pools of the API, slot and subslot handles: all
+**                objects are allocated, the next request of each pool
+**                fails and is counted, TPS_CleanApiConf() gives all objects
+**                back and the pools serve the next configuration again.
+**                Each API but the last gets one slot, each slot but the
+**                last one subslot.
+**
+*******************************************************************************
+*/
+static VOID locSimTestObjectPool(VOID)
+{
+    T_DEVICE_SOFTWARE_VERSION zSoftwareVersion = {0};
+    T_OBJECT_POOL_STATISTICS  zStatistics;
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot = NULL;
+    USIGN16   wApi = 0;
+    USIGN16   wSlot = 0;
+    USIGN16   wSubslot = 0;
+    USIGN16   wSlotsOfApi = 0;
+    USIGN16   wSubslotsOfSlot = 0;
+    USIGN16   wSubslotNumber = 0;
+    USIGN8    byPool = 0;
+    USIGN16   wCapacity[OBJECT_POOL_NUMBER] = { USED_NUMBER_OF_API, USED_NUMBER_SLOT, USED_NUMBER_SUBSLOT };
+
+    SIM_TEST_CHECK(USED_NUMBER_SLOT >= USED_NUMBER_OF_API);
+    SIM_TEST_CHECK(USED_NUMBER_SUBSLOT >= USED_NUMBER_SLOT);
+
+    SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(OBJECT_POOL_NUMBER, &zStatistics) == API_OBJECT_POOL_INVALID_POOL);
+    SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(OBJECT_POOL_SLOT, NULL) == API_OBJECT_POOL_NULL_POINTER);
+
+    TPS_CleanApiConf();
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_AddDevice(0x0001, 0x0001, (CHAR*)"TPS-1", &zSoftwareVersion) == TPS_ACTION_OK);
+
+    /* Allocation of all objects.                                            */
+    for (wApi = 0; wApi < USED_NUMBER_OF_API; wApi++)
+    {
+        pzApi = TPS_AddAPI(wApi);
+        SIM_TEST_CHECK(pzApi != NULL);
+        if (pzApi == NULL)
+        {
+            return;
+        }
+
+        wSlotsOfApi = (wApi < (USED_NUMBER_OF_API - 1)) ? 1 : (USED_NUMBER_SLOT - wSlot);
+        for (; wSlotsOfApi > 0; wSlotsOfApi--, wSlot++)
+        {
+            pzSlot = TPS_PlugModule(pzApi, wSlot, (wSlot == 0) ? DAP_MODULE : (0x00000010 + wSlot));
+            SIM_TEST_CHECK(pzSlot != NULL);
+            if (pzSlot == NULL)
+            {
+                return;
+            }
+
+            wSubslotsOfSlot = (wSlot < (USED_NUMBER_SLOT - 1)) ? 1 : (USED_NUMBER_SUBSLOT - wSubslot);
+            for (wSubslotNumber = 1; wSubslotNumber <= wSubslotsOfSlot; wSubslotNumber++, wSubslot++)
+            {
+                if (wSlot == 0)
+                {
+                    pzSubslot = TPS_PlugSubmodule(pzSlot, wSubslotNumber, DAP_SUBMODULE, 0, 0, 0, 0, &g_zSimTestIM0, TPS_TRUE);
+                }
+                else
+                {
+                    pzSubslot = TPS_PlugSubmodule(pzSlot, wSubslotNumber, 0x11, 0, 0, 1, 1, &g_zSimTestIM0, TPS_FALSE);
+                }
+                SIM_TEST_CHECK(pzSubslot != NULL);
+                if (pzSubslot == NULL)
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    /* Exhaustion: the next object of each pool is refused.                  */
+    SIM_TEST_CHECK(TPS_PlugSubmodule(pzSlot, wSubslotNumber, 0x11, 0, 0, 1, 1, &g_zSimTestIM0, TPS_FALSE) == NULL);
+    SIM_TEST_CHECK(TPS_GetLastError() == PLUG_SUB_INVALID_SUBSLOT_HANDLE);
+    SIM_TEST_CHECK(TPS_PlugModule(pzApi, wSlot, 0x00000010 + wSlot) == NULL);
+    SIM_TEST_CHECK(TPS_GetLastError() == PLUGMODULE_INVALID_SLOT_HANDLE);
+    SIM_TEST_CHECK(TPS_AddAPI(wApi) == NULL);
+    SIM_TEST_CHECK(TPS_GetLastError() == ADD_API_OUT_OF_MEMORY);
+
+    for (byPool = 0; byPool < OBJECT_POOL_NUMBER; byPool++)
+    {
+        SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(byPool, &zStatistics) == TPS_ACTION_OK);
+        SIM_TEST_CHECK(zStatistics.wCapacity == wCapacity[byPool]);
+        SIM_TEST_CHECK(zStatistics.wInUse == wCapacity[byPool]);
+        SIM_TEST_CHECK(zStatistics.wMaxInUse == wCapacity[byPool]);
+        SIM_TEST_CHECK(zStatistics.dwAllocs == wCapacity[byPool]);
+        SIM_TEST_CHECK(zStatistics.dwFrees == 0);
+        SIM_TEST_CHECK(zStatistics.dwFailures == 1);
+    }
+
+    /* Free: all objects are back, the high water mark is kept.              */
+    TPS_CleanApiConf();
+
+    for (byPool = 0; byPool < OBJECT_POOL_NUMBER; byPool++)
+    {
+        SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(byPool, &zStatistics) == TPS_ACTION_OK);
+        SIM_TEST_CHECK(zStatistics.wInUse == 0);
+        SIM_TEST_CHECK(zStatistics.wMaxInUse == wCapacity[byPool]);
+        SIM_TEST_CHECK(zStatistics.dwFrees == wCapacity[byPool]);
+    }
+
+    /* The freed objects serve the next configuration.                       */
+    SIM_TEST_CHECK(locSimTestConfigure(0) != NULL);
+    SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(OBJECT_POOL_SLOT, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.wInUse == 2) && (zStatistics.dwFailures == 0));
+    SIM_TEST_CHECK(TPS_GetObjectPoolStatistics(OBJECT_POOL_SUBSLOT, &zStatistics) == TPS_ACTION_OK);
+    SIM_TEST_CHECK((zStatistics.wInUse == 2) && (zStatistics.dwFailures == 0));
+
+    TPS_CleanApiConf();
+}
+
+#ifdef USE_HANDLE_INDEX
+/*****************************************************************************
+**
+** FUNCTION NAME: locSimTestHandleIndex()
+**
+** DESCRIPTION:   Handle index of the slots and subslots: the lookups of the
+**                API functions by numbers find the plugged handles and tell
+**                a missing slot from a missing API without an SPI read.
+**                Slot 2 has the subslots 1 and 2, the alarm of the module
+**                representative reads the owner of each subslot of the
+**                slot found. TPS_CleanApiConf() clears the index.
+**
+*******************************************************************************
+*/
+static VOID locSimTestHandleIndex(VOID)
+{
+    T_DEVICE_SOFTWARE_VERSION zSoftwareVersion = {0};
+    T_TPS_SIM_COUNTERS        zCounters;
+    API_LIST* pzApi = NULL;
+    SLOT*     pzSlot = NULL;
+    SUBSLOT*  pzSubslot[2] = {NULL, NULL};
+
+    TPS_CleanApiConf();
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_AddDevice(0x0001, 0x0001, (CHAR*)"TPS-1", &zSoftwareVersion) == TPS_ACTION_OK);
+    pzApi = TPS_AddAPI(API_0);
+    SIM_TEST_CHECK(pzApi != NULL);
+    if (pzApi == NULL)
+    {
+        return;
+    }
+
+    pzSlot = TPS_PlugModule(pzApi, DAP_MODULE, 0x00000001);
+    SIM_TEST_CHECK(pzSlot != NULL);
+    SIM_TEST_CHECK(TPS_PlugSubmodule(pzSlot, DAP_SUBMODULE, 0x01, 0, 0, 0, 0, &g_zSimTestIM0, TPS_TRUE) != NULL);
+    pzSlot = TPS_PlugModule(pzApi, 2, 0x00000020);
+    SIM_TEST_CHECK(pzSlot != NULL);
+    if (pzSlot == NULL)
+    {
+        return;
+    }
+    pzSubslot[0] = TPS_PlugSubmodule(pzSlot, 1, 0x21, 0, 0, 1, 1, &g_zSimTestIM0, TPS_FALSE);
+    pzSubslot[1] = TPS_PlugSubmodule(pzSlot, 2, 0x22, 0, 0, 1, 1, &g_zSimTestIM0, TPS_FALSE);
+    SIM_TEST_CHECK((pzSubslot[0] != NULL) && (pzSubslot[1] != NULL));
+    if ((pzSubslot[0] == NULL) || (pzSubslot[1] == NULL))
+    {
+        return;
+    }
+
+    /* Found and missing handles without an SPI read.                        */
+    TPS_SimResetCounters();
+    SIM_TEST_CHECK(TPS_PlugModule(pzApi, 2, 0x00000020) == NULL);
+    SIM_TEST_CHECK(TPS_GetLastError() == PLUGMODULE_SLOT_ALREADY_EXISTS);
+    SIM_TEST_CHECK(TPS_PlugSubmodule(pzSlot, 2, 0x22, 0, 0, 1, 1, &g_zSimTestIM0, TPS_FALSE) == NULL);
+    SIM_TEST_CHECK(TPS_GetLastError() == PLUG_SUB_SLOT_ALREADY_EXISTS);
+    SIM_TEST_CHECK(TPS_ReactivateSubmodule(API_0, 2, 3) == GET_HANDLE_SUBSLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_ReactivateSubmodule(API_0, 1, 1) == GET_HANDLE_SUBSLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, API_0, 1, 0, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == API_ALARM_SLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_GetLastError() == GET_HANDLE_SLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, 7, 2, 0, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == API_ALARM_SLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_GetLastError() == GET_HANDLE_API_NOT_FOUND);
+    TPS_SimGetCounters(&zCounters);
+    SIM_TEST_CHECK(zCounters.dwReadCommands == 0);
+
+    /* The slot found is slot 2: one owner read per subslot.                 */
+    TPS_SimResetCounters();
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, API_0, 2, 0, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == API_ALARM_SUBSLOT_NOT_USED_BY_AR);
+    TPS_SimGetCounters(&zCounters);
+    SIM_TEST_CHECK(zCounters.dwReadCommands == 2);
+
+    /* The subslot found is the owned subslot 2 / 2, not 2 / 1.              */
+    SIM_TEST_CHECK(TPS_SetValue16((USIGN8*)pzSubslot[1]->pt_wSubslotOwnedByAr, OWNED_BY_AR(AR_0)) == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, API_0, 2, 1, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == API_ALARM_SUBSLOT_NOT_USED_BY_AR);
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, API_0, 2, 2, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == TPS_ACTION_OK);
+
+    /* The index is empty after TPS_CleanApiConf(), the slots can be         */
+    /* plugged again.                                                        */
+    TPS_CleanApiConf();
+    SIM_TEST_CHECK(TPS_SendAlarm(AR_0, API_0, 2, 0, ALARM_LOW, PROCESS_ALARM, 0, NULL, 0, 0) == API_ALARM_SLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_GetLastError() == GET_HANDLE_API_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_ReactivateSubmodule(API_0, 2, 2) == GET_HANDLE_SUBSLOT_NOT_FOUND);
+    SIM_TEST_CHECK(TPS_InitApplicationInterface() == TPS_ACTION_OK);
+    SIM_TEST_CHECK(TPS_AddDevice(0x0001, 0x0001, (CHAR*)"TPS-1", &zSoftwareVersion) == TPS_ACTION_OK);
+    pzApi = TPS_AddAPI(API_0);
+    SIM_TEST_CHECK(pzApi != NULL);
+    if (pzApi == NULL)
+    {
+        return;
+    }
+    SIM_TEST_CHECK(TPS_PlugModule(pzApi, DAP_MODULE, 0x00000001) != NULL);
+    SIM_TEST_CHECK(TPS_PlugModule(pzApi, 2, 0x00000020) != NULL);
+
+    TPS_CleanApiConf();
+}
+#endif
+
+#endif /* TPS_HOST_SIMULATION */
@@ -0,0 +1,253 @@
+/*
++-----------------------------------------------------------------------------+
+| ***************************** TPS_Benchmark.c ****************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Micro-benchmark of the TPS_* DPRAM accessors.                               |
++-----------------------------------------------------------------------------+
+*/
+
+
+/*! \file TPS_Benchmark.c
+ *  \brief micro-benchmark of the TPS_* DPRAM accessors of SPI1_Master.c
+ *
+ *  Every accessor is called TPS_BENCHMARK_RUNS times per data size and
+ *  address alignment on a scratch area of the NRT area. The SPI commands and
+ *  bytes are taken from the SPI read/write points of the profiling table
+ *  (TPS_Profile.c), the cycles from its cycle source: the DWT counter on the
+ *  target, the model clock in the host simulation (TPS_1_Sim.c). The host
+ *  simulation additionally prints the CPU time of the PC per call, which
+ *  shows the work done around the SPI transfer, e.g. buffer clearing.
+ */
+
+/*===========================================================================*/
+/* Includes                                                                  */
+/*===========================================================================*/
+#include <TPS_1_API.h>
+
+#ifdef TPS_ACCESSOR_BENCHMARK
+
+#ifndef TPS_PROFILING
+#error "The accessor benchmark needs the profiling (TPS_PROFILING)!"
+#endif
+
+#ifdef TPS_HOST_SIMULATION
+#include <time.h>
+#endif
+
+/* Measured accessors                                                        */
+/*---------------------------------------------------------------------------*/
+#define BENCH_SET_VALUE_8       0
+#define BENCH_SET_VALUE_16      1
+#define BENCH_SET_VALUE_32      2
+#define BENCH_GET_VALUE_8       3
+#define BENCH_GET_VALUE_16      4
+#define BENCH_GET_VALUE_32      5
+#define BENCH_GET_IO_ADDRESS    6
+#define BENCH_SET_VALUE_DATA    7
+#define BENCH_GET_VALUE_DATA    8
+#define BENCH_MEM_SET           9
+
+typedef struct _T_BENCH_ACCESSOR
+{
+    const char*     pszName;
+    USIGN8          byAccessor;         /* BENCH_SET_VALUE_8, ...             */
+    const USIGN16*  pwLength;           /* measured data sizes                */
+    USIGN8          byNumberOfLengths;
+    USIGN8          byNumberOfOffsets;  /* alignments 0 .. n-1 are measured   */
+}T_BENCH_ACCESSOR;
+
+static const USIGN16 g_wBenchLength1[]    = { 1 };
+static const USIGN16 g_wBenchLength2[]    = { 2 };
+static const USIGN16 g_wBenchLength4[]    = { 4 };
+static const USIGN16 g_wBenchDataLength[] = { 1, 4, 16, 64, 256, 1024, MAX_LEN_ETHERNET_FRAME };
+static const USIGN16 g_wBenchMemSetLength[] = { 1, 16, 64 };
+
+#define BENCH_LENGTHS(awLength)   (awLength), (USIGN8)(sizeof(awLength) / sizeof((awLength)[0]))
+
+static const T_BENCH_ACCESSOR g_zBenchAccessor[] =
+{
+    { "SetValue8",    BENCH_SET_VALUE_8,    BENCH_LENGTHS(g_wBenchLength1),      4 },
+    { "SetValue16",   BENCH_SET_VALUE_16,   BENCH_LENGTHS(g_wBenchLength2),      4 },
+    { "SetValue32",   BENCH_SET_VALUE_32,   BENCH_LENGTHS(g_wBenchLength4),      4 },
+    { "GetValue8",    BENCH_GET_VALUE_8,    BENCH_LENGTHS(g_wBenchLength1),      4 },
+    { "GetValue16",   BENCH_GET_VALUE_16,   BENCH_LENGTHS(g_wBenchLength2),      4 },
+    { "GetValue32",   BENCH_GET_VALUE_32,   BENCH_LENGTHS(g_wBenchLength4),      4 },
+    { "GetIOAddress", BENCH_GET_IO_ADDRESS, BENCH_LENGTHS(g_wBenchLength4),      4 },
+    { "SetValueData", BENCH_SET_VALUE_DATA, BENCH_LENGTHS(g_wBenchDataLength),   2 },
+    { "GetValueData", BENCH_GET_VALUE_DATA, BENCH_LENGTHS(g_wBenchDataLength),   2 },
+    { "MemSet",       BENCH_MEM_SET,        BENCH_LENGTHS(g_wBenchMemSetLength), 1 }
+};
+
+static USIGN8 g_byBenchBuffer[MAX_LEN_ETHERNET_FRAME];
+
+static USIGN32 locBenchCall(USIGN8 byAccessor, USIGN8* pbyAddress, USIGN16 wLength);
+#ifdef TPS_HOST_SIMULATION
+static USIGN32 locBenchHostNanoseconds(VOID);
+#endif
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_AccessorBenchmark()
+**
+** DESCRIPTION:   Measures all TPS_* accessors and prints one line per data
+**                size and alignment over the debug UART: SPI commands, SPI
+**                bytes and cycles per call and the cycles per payload byte.
+**                A call that needs more commands or bytes than the payload
+**                plus the command header shows up in the first columns, a
+**                call that does more work around the transfer in the cycles.
+**                The profiling table is cleared afterwards.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_AccessorBenchmark(VOID)
+{
+    T_TPS_PROFILE_ENTRY zRead;
+    T_TPS_PROFILE_ENTRY zWrite;
+    const T_BENCH_ACCESSOR* pzAccessor;
+    USIGN32 dwAccessorIdx;
+    USIGN32 dwLenIdx;
+    USIGN32 dwOffset;
+    USIGN32 dwRun;
+    USIGN32 dwResult;
+    USIGN32 dwStart;
+    USIGN32 dwCycles;
+    USIGN16 wLength;
+#ifdef TPS_HOST_SIMULATION
+    USIGN32 dwHostStart;
+    USIGN32 dwHostTime;
+#endif
+
+    for (dwRun = 0; dwRun < sizeof(g_byBenchBuffer); dwRun++)
+    {
+        g_byBenchBuffer[dwRun] = (USIGN8)dwRun;
+    }
+
+    printf("accessor     size off   cmd/call bytes/call cycles/call cycles/byte");
+#ifdef TPS_HOST_SIMULATION
+    printf("  host ns/call");
+#endif
+    printf("\r\n");
+
+    for (dwAccessorIdx = 0; dwAccessorIdx < (sizeof(g_zBenchAccessor) / sizeof(g_zBenchAccessor[0])); dwAccessorIdx++)
+    {
+        pzAccessor = &g_zBenchAccessor[dwAccessorIdx];
+
+        for (dwLenIdx = 0; dwLenIdx < pzAccessor->byNumberOfLengths; dwLenIdx++)
+        {
+            wLength = pzAccessor->pwLength[dwLenIdx];
+
+            for (dwOffset = 0; dwOffset < pzAccessor->byNumberOfOffsets; dwOffset++)
+            {
+                dwResult = TPS_ACTION_OK;
+
+                TPS_ProfileReset();
+#ifdef TPS_HOST_SIMULATION
+                dwHostStart = locBenchHostNanoseconds();
+#endif
+                dwStart = TPS_ProfileGetCycles();
+                for (dwRun = 0; dwRun < TPS_BENCHMARK_RUNS; dwRun++)
+                {
+                    dwResult |= locBenchCall(pzAccessor->byAccessor,
+                                             (USIGN8*)(TPS_BENCHMARK_AREA + dwOffset), wLength);
+                }
+                dwCycles = TPS_ProfileGetCycles() - dwStart;
+#ifdef TPS_HOST_SIMULATION
+                dwHostTime = locBenchHostNanoseconds() - dwHostStart;
+#endif
+
+                TPS_ProfileGetEntry(TPS_PROFILE_SPI_READ, &zRead);
+                TPS_ProfileGetEntry(TPS_PROFILE_SPI_WRITE, &zWrite);
+
+                printf("%-12s %4lu  +%lu %10lu %10lu %11lu %11lu",
+                       pzAccessor->pszName, (unsigned long)wLength, (unsigned long)dwOffset,
+                       (unsigned long)((zRead.dwCount + zWrite.dwCount) / TPS_BENCHMARK_RUNS),
+                       (unsigned long)((zRead.dwTotalBytes + zWrite.dwTotalBytes) / TPS_BENCHMARK_RUNS),
+                       (unsigned long)(dwCycles / TPS_BENCHMARK_RUNS),
+                       (unsigned long)(dwCycles / (TPS_BENCHMARK_RUNS * wLength)));
+#ifdef TPS_HOST_SIMULATION
+                printf(" %13lu", (unsigned long)(dwHostTime / TPS_BENCHMARK_RUNS));
+#endif
+                if (dwResult != TPS_ACTION_OK)
+                {
+                    printf("  failed");
+                }
+                printf("\r\n");
+            }
+        }
+    }
+
+    TPS_ProfileReset();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: locBenchCall()
+**
+** DESCRIPTION:   One call of the measured accessor. The 8/16/32 bit and the
+**                IO address accessors ignore wLength.
+**
+** Return_Type:   USIGN32 - result of the accessor
+**
+*******************************************************************************
+*/
+static USIGN32 locBenchCall(USIGN8 byAccessor, USIGN8* pbyAddress, USIGN16 wLength)
+{
+    USIGN8  byValue;
+    USIGN16 wValue;
+    USIGN32 dwValue;
+    USIGN8* pbyIOAddress;
+
+    switch (byAccessor)
+    {
+        case BENCH_SET_VALUE_8:
+            return TPS_SetValue8(pbyAddress, 0x5A);
+        case BENCH_SET_VALUE_16:
+            return TPS_SetValue16(pbyAddress, 0x5AA5);
+        case BENCH_SET_VALUE_32:
+            return TPS_SetValue32(pbyAddress, 0x5AA5C33C);
+        case BENCH_GET_VALUE_8:
+            return TPS_GetValue8(pbyAddress, &byValue);
+        case BENCH_GET_VALUE_16:
+            return TPS_GetValue16(pbyAddress, &wValue);
+        case BENCH_GET_VALUE_32:
+            return TPS_GetValue32(pbyAddress, &dwValue);
+        case BENCH_GET_IO_ADDRESS:
+            return TPS_GetIOAddress(pbyAddress, &pbyIOAddress);
+        case BENCH_SET_VALUE_DATA:
+            return TPS_SetValueData(pbyAddress, g_byBenchBuffer, wLength);
+        case BENCH_GET_VALUE_DATA:
+            return TPS_GetValueData(pbyAddress, g_byBenchBuffer, wLength);
+        case BENCH_MEM_SET:
+            return TPS_MemSet(pbyAddress, 0x00, wLength);
+        default:
+            return SPI_INTERFACE_PARAM_FAULT;
+    }
+}
+
+#ifdef TPS_HOST_SIMULATION
+/*****************************************************************************
+**
+** FUNCTION NAME: locBenchHostNanoseconds()
+**
+** DESCRIPTION:   Monotonic time of the PC, wraps after about 4 seconds. Only
+**                differences are used.
+**
+** Return_Type:   USIGN32 - nanoseconds
+**
+*******************************************************************************
+*/
+static USIGN32 locBenchHostNanoseconds(VOID)
+{
+    struct timespec zTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &zTime);
+
+    return (USIGN32)((USIGN32)zTime.tv_sec * 1000000000u + (USIGN32)zTime.tv_nsec);
+}
+#endif /* TPS_HOST_SIMULATION */
+
+#endif /* TPS_ACCESSOR_BENCHMARK */
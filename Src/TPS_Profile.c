@@ -0,0 +1,296 @@
+/*
++-----------------------------------------------------------------------------+
+| ***************************** TPS_Profile.c ******************************  |
++-----------------------------------------------------------------------------+
+| Description:                                                                |
++-----------------------------------------------------------------------------+
+| Cycle counter profiling of the SPI/DPRAM access and the event handling.     |
++-----------------------------------------------------------------------------+
+*/
+
+/*! \file TPS_Profile.c
+ *  \brief cycle counter profiling of the SPI/DPRAM access and the event handling
+ *
+ *  On the target the cycles are taken from the DWT cycle counter of the
+ *  Cortex-M3. With TPS_PROFILE_HOST_BUILD the file does not depend on the
+ *  HAL and the cycle source is set by TPS_ProfileSetCycleSource(), so the
+ *  table can be compiled and checked on a PC.
+ */
+
+/*===========================================================================*/
+/* Includes                                                                  */
+/*===========================================================================*/
+#include <TPS_1_API.h>
+
+#ifdef TPS_PROFILING
+
+#ifndef TPS_PROFILE_HOST_BUILD
+#include "stm32f1xx_hal.h"
+#endif
+
+#define PROFILE_CALIBRATION_RUNS  8
+
+/* Statistics of all measuring points. No heap is used.                      */
+/*---------------------------------------------------------------------------*/
+static T_TPS_PROFILE_ENTRY g_zProfileTable[TPS_PROFILE_NUMBER_OF_POINTS];
+
+/* Cycles of an empty TPS_PROFILE_ENTER()/TPS_PROFILE_LEAVE() pair. They are */
+/* subtracted from every measurement.                                        */
+/*---------------------------------------------------------------------------*/
+static USIGN32 g_dwProfileOverhead = 0;
+
+static const char* const g_pszProfilePointName[TPS_PROFILE_NUMBER_OF_POINTS] =
+{
+    "SPI read",
+    "SPI write",
+    "check events",
+    "update input",
+    "update output",
+    "read record",
+    "write record",
+    "alarm ack"
+};
+
+#ifdef TPS_PROFILE_HOST_BUILD
+static USIGN32 locProfileNoCycles(VOID);
+
+static USIGN32 (*g_pfnProfileGetCycles)(VOID) = locProfileNoCycles;
+#endif
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileInit()
+**
+** DESCRIPTION:   Starts the DWT cycle counter, measures the overhead of the
+**                profiling itself and clears the table. Must be called once
+**                before the first measurement.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_ProfileInit(VOID)
+{
+#ifndef TPS_PROFILE_HOST_BUILD
+    USIGN32 dwRun;
+    USIGN32 dwStart;
+    USIGN32 dwCycles;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    g_dwProfileOverhead = 0xFFFFFFFF;
+    for (dwRun = 0; dwRun < PROFILE_CALIBRATION_RUNS; dwRun++)
+    {
+        dwStart = TPS_ProfileGetCycles();
+        dwCycles = TPS_ProfileGetCycles() - dwStart;
+
+        if (dwCycles < g_dwProfileOverhead)
+        {
+            g_dwProfileOverhead = dwCycles;
+        }
+    }
+#else
+    /* The fake cycle source of the host build has no overhead.             */
+    g_dwProfileOverhead = 0;
+#endif
+
+    TPS_ProfileReset();
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileReset()
+**
+** DESCRIPTION:   Clears the statistics of all measuring points.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_ProfileReset(VOID)
+{
+    USIGN32 dwPoint;
+
+    memset(g_zProfileTable, 0x00, sizeof(g_zProfileTable));
+
+    for (dwPoint = 0; dwPoint < TPS_PROFILE_NUMBER_OF_POINTS; dwPoint++)
+    {
+        g_zProfileTable[dwPoint].dwMinCycles = 0xFFFFFFFF;
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileGetCycles()
+**
+** DESCRIPTION:   Returns the current value of the cycle counter.
+**
+** Return_Type:   USIGN32
+**
+*******************************************************************************
+*/
+USIGN32 TPS_ProfileGetCycles(VOID)
+{
+#ifndef TPS_PROFILE_HOST_BUILD
+    return DWT->CYCCNT;
+#else
+    return g_pfnProfileGetCycles();
+#endif
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileAdd()
+**
+** DESCRIPTION:   Adds one call to the statistics of a measuring point. The
+**                duration is the difference between now and dwStartCycles.
+**                A wrap of the 32 bit counter between start and end is
+**                handled by the unsigned subtraction.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN8  byPoint       (TPS_PROFILE_SPI_READ, ...)
+**                USIGN32 dwStartCycles (TPS_ProfileGetCycles() at the start)
+**                USIGN32 dwBytes       transferred bytes of this call
+**
+*******************************************************************************
+*/
+VOID TPS_ProfileAdd(USIGN8 byPoint, USIGN32 dwStartCycles, USIGN32 dwBytes)
+{
+    USIGN32 dwCycles = TPS_ProfileGetCycles() - dwStartCycles;
+    T_TPS_PROFILE_ENTRY* pzEntry;
+
+    if (byPoint >= TPS_PROFILE_NUMBER_OF_POINTS)
+    {
+        return;
+    }
+
+    dwCycles = (dwCycles > g_dwProfileOverhead) ? (dwCycles - g_dwProfileOverhead) : 0;
+
+    pzEntry = &g_zProfileTable[byPoint];
+    pzEntry->dwCount++;
+    pzEntry->dwTotalBytes += dwBytes;
+    pzEntry->qwTotalCycles += dwCycles;
+
+    if (dwCycles < pzEntry->dwMinCycles)
+    {
+        pzEntry->dwMinCycles = dwCycles;
+    }
+    if (dwCycles > pzEntry->dwMaxCycles)
+    {
+        pzEntry->dwMaxCycles = dwCycles;
+    }
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileGetEntry()
+**
+** DESCRIPTION:   Copies the statistics of a measuring point.
+**
+** RETURN:        TPS_ACTION_OK
+**                ErrorCode        API_WRONG_PARAMETER
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     USIGN8               byPoint (TPS_PROFILE_SPI_READ, ...)
+**                T_TPS_PROFILE_ENTRY* pzEntry
+**
+*******************************************************************************
+*/
+USIGN32 TPS_ProfileGetEntry(USIGN8 byPoint, T_TPS_PROFILE_ENTRY* pzEntry)
+{
+    if ((byPoint >= TPS_PROFILE_NUMBER_OF_POINTS) || (pzEntry == NULL))
+    {
+        return API_WRONG_PARAMETER;
+    }
+
+    *pzEntry = g_zProfileTable[byPoint];
+
+    return TPS_ACTION_OK;
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileGetMeanCycles()
+**
+** DESCRIPTION:   Returns the mean duration of the calls of an entry or 0 if
+**                the entry has no calls.
+**
+** Return_Type:   USIGN32
+**
+** PARAMETER:     const T_TPS_PROFILE_ENTRY* pzEntry
+**
+*******************************************************************************
+*/
+USIGN32 TPS_ProfileGetMeanCycles(const T_TPS_PROFILE_ENTRY* pzEntry)
+{
+    if ((pzEntry == NULL) || (pzEntry->dwCount == 0))
+    {
+        return 0;
+    }
+
+    return (USIGN32)(pzEntry->qwTotalCycles / pzEntry->dwCount);
+}
+
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileDump()
+**
+** DESCRIPTION:   Prints the table over the debug UART (USART3, see fputc()
+**                in main.c). Points without calls are skipped.
+**
+** Return_Type:   VOID
+**
+*******************************************************************************
+*/
+VOID TPS_ProfileDump(VOID)
+{
+    USIGN32 dwPoint;
+    const T_TPS_PROFILE_ENTRY* pzEntry;
+
+    printf("point          count      min cyc    max cyc    mean cyc   bytes\r\n");
+
+    for (dwPoint = 0; dwPoint < TPS_PROFILE_NUMBER_OF_POINTS; dwPoint++)
+    {
+        pzEntry = &g_zProfileTable[dwPoint];
+
+        if (pzEntry->dwCount == 0)
+        {
+            continue;
+        }
+
+        printf("%-14s %-10lu %-10lu %-10lu %-10lu %lu\r\n",
+            g_pszProfilePointName[dwPoint], (unsigned long)pzEntry->dwCount,
+            (unsigned long)pzEntry->dwMinCycles, (unsigned long)pzEntry->dwMaxCycles,
+            (unsigned long)TPS_ProfileGetMeanCycles(pzEntry), (unsigned long)pzEntry->dwTotalBytes);
+    }
+}
+
+#ifdef TPS_PROFILE_HOST_BUILD
+/*****************************************************************************
+**
+** FUNCTION NAME: TPS_ProfileSetCycleSource()
+**
+** DESCRIPTION:   Host build only. Sets the function that replaces the DWT
+**                cycle counter, e.g. a counter advanced by a test.
+**
+** Return_Type:   VOID
+**
+** PARAMETER:     USIGN32 (*pfnGetCycles)(VOID)  NULL: counter stays at 0
+**
+*******************************************************************************
+*/
+VOID TPS_ProfileSetCycleSource(USIGN32 (*pfnGetCycles)(VOID))
+{
+    g_pfnProfileGetCycles = (pfnGetCycles != NULL) ? pfnGetCycles : locProfileNoCycles;
+}
+
+static USIGN32 locProfileNoCycles(VOID)
+{
+    return 0;
+}
+#endif /* TPS_PROFILE_HOST_BUILD */
+
+#endif /* TPS_PROFILING */
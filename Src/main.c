@@ -41,6 +41,7 @@
 #include "stm32f1xx_hal.h"
 
 /* USER CODE BEGIN Includes */
+#include <TPS_1_API.h>
 
 /* USER CODE END Includes */
 
@@ -96,6 +97,20 @@ void TPS1_GPIO_Init()
   HAL_Delay(5);
   HAL_GPIO_WritePin(HOST_RESET_GPIO_Port,HOST_RESET_Pin,GPIO_PIN_RESET);
   __HAL_SPI_ENABLE(&hspi1);
+#ifdef TPS_EVENT_IRQ_MODE
+  {
+    GPIO_InitTypeDef GPIO_InitStruct;
+
+    /* TPS-1 host interrupt: falling edge on EXTI */
+    GPIO_InitStruct.Pin = TPS_HOST_IRQ_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(TPS_HOST_IRQ_GPIO_Port, &GPIO_InitStruct);
+
+    HAL_NVIC_SetPriority(TPS_HOST_IRQ_EXTI_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(TPS_HOST_IRQ_EXTI_IRQn);
+  }
+#endif
 }
 /* USER CODE END 0 */
 
@@ -133,6 +148,9 @@ int main(void)
   /* USER CODE BEGIN 2 */
   printf("STM32 TPS1 driver init\r\n");
   TPS1_GPIO_Init();
+#ifdef SPI_DMA_TRANSFER
+  TPS_SPI_InitDma();
+#endif
   StartTPS1();
   /* USER CODE END 2 */
 
@@ -36,7 +36,8 @@
 #include "stm32f1xx_it.h"
 
 /* USER CODE BEGIN 0 */
-
+#include <TPS_1_user.h>
+#include "main.h"
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
@@ -192,6 +193,47 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+#ifdef SPI_DMA_TRANSFER
+extern DMA_HandleTypeDef hdma_spi1_rx;
+extern DMA_HandleTypeDef hdma_spi1_tx;
+
+/**
+* @brief This function handles DMA1 channel2 global interrupt (SPI1_RX).
+*/
+void DMA1_Channel2_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_rx);
+}
+
+/**
+* @brief This function handles DMA1 channel3 global interrupt (SPI1_TX).
+*/
+void DMA1_Channel3_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_tx);
+}
+#endif
 
+#ifdef TPS_EVENT_IRQ_MODE
+/**
+* @brief This function handles EXTI line0 interrupt (TPS-1 host interrupt).
+*/
+void EXTI0_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(TPS_HOST_IRQ_Pin);
+}
+#endif
+
+#if defined(FW_UPDATE_OVER_HOST) && defined(USE_FW_UPDATE_STREAM)
+extern void onFwUpdateUartIrq(void);
+
+/**
+* @brief This function handles USART3 global interrupt (streamed firmware update).
+*/
+void USART3_IRQHandler(void)
+{
+  onFwUpdateUartIrq();
+}
+#endif
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/